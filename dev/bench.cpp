@@ -0,0 +1,270 @@
+// bench.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// micro benchmarks for ncutil hot functions, usage: nchat_bench [filter]
+
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "emojiutil.h"
+#include "objectpool.h"
+#include "protocol.h"
+#include "protocolutil.h"
+#include "strutil.h"
+#include "tgmarkdown.h"
+
+// @note: all allocations in the process are counted, benchmarks run single-threaded
+static uint64_t s_AllocCount = 0;
+static volatile size_t s_Sink = 0;
+static const int64_t s_MinTimeNs = 200 * 1000 * 1000;
+
+void* operator new(size_t p_Size)
+{
+  ++s_AllocCount;
+  void* ptr = malloc((p_Size > 0) ? p_Size : 1);
+  if (ptr == NULL) throw std::bad_alloc();
+
+  return ptr;
+}
+
+// @note: not inlined, as gcc otherwise flags free() of operator new memory in inlined make_shared
+__attribute__((noinline)) void operator delete(void* p_Ptr) noexcept
+{
+  free(p_Ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* p_Ptr, size_t) noexcept
+{
+  free(p_Ptr);
+}
+
+static std::string Repeat(const std::string& p_Str, size_t p_Size)
+{
+  std::string str;
+  while (str.size() < p_Size)
+  {
+    str += p_Str;
+  }
+
+  return str;
+}
+
+static const std::string& GetEnglishText()
+{
+  static const std::string str =
+    "Hey, are we still on for lunch tomorrow? I was thinking we could try the new place "
+    "down by the harbour, they apparently have really good fish and chips. Let me know "
+    "if 12 works for you, otherwise I'm free after 13 as well.";
+  return str;
+}
+
+static const std::string& GetMultilingualText()
+{
+  static const std::string str =
+    "Hej! Hur mår du? Vi ses på fredag. "
+    "Привет, как дела? Увидимся в пятницу. "
+    "你好，你最近怎么样？我们星期五见。"
+    "こんにちは、お元気ですか？金曜日に会いましょう。"
+    "مرحبا، كيف حالك؟ نراك يوم الجمعة. "
+    "नमस्ते, आप कैसे हैं? शुक्रवार को मिलते हैं। "
+    "Γεια σου, τι κάνεις; Τα λέμε την Παρασκευή. ";
+  return str;
+}
+
+static const std::string& GetEmojiShortcodeText()
+{
+  static const std::string str =
+    "great news :tada: :tada: congrats :+1: :smile: see you :wave: time: 12:30 "
+    ":heart: :joy: :fire: not an emoji :nonexistent_code: :rocket: ";
+  return str;
+}
+
+static const std::string& GetEmojiText()
+{
+  static const std::string str = EmojiUtil::Emojize(Repeat(GetEmojiShortcodeText(), 1024), false);
+  return str;
+}
+
+static const std::string& GetLongPaste()
+{
+  static const std::string str =
+    Repeat(GetEnglishText() + "\n" + GetMultilingualText() + "\n\n" +
+           "    indented code line with\ttabs and a link https://example.com/a/b?c=d\n" +
+           "> quoted reply text from an earlier message\n", 64 * 1024);
+  return str;
+}
+
+static const std::string& GetUrlText()
+{
+  static const std::string str =
+    Repeat("check https://github.com/pyr0hax/nchat and http://example.com/path?q=1&r=2, "
+           "or www.example.org (not a link) and https://example.net/x.html. ", 4096);
+  return str;
+}
+
+// typical formatted chat message, entity offsets are in utf-16 code units
+static void GetFormattedMessage(std::string& p_Text, std::vector<TgMarkdown::Entity>& p_Entities)
+{
+  p_Text = "Release notes: the new build fixes crashes on startup, see the changelog for details. "
+    "Run make install and restart \xf0\x9f\x9a\x80 before reporting issues, thanks!";
+  p_Entities.resize(5);
+  p_Entities[0].offset = 0;
+  p_Entities[0].length = 13;
+  p_Entities[0].type = TgMarkdown::EntityBold;
+  p_Entities[1].offset = 35;
+  p_Entities[1].length = 7;
+  p_Entities[1].type = TgMarkdown::EntityItalic;
+  p_Entities[2].offset = 63;
+  p_Entities[2].length = 9;
+  p_Entities[2].type = TgMarkdown::EntityTextUrl;
+  p_Entities[2].arg = "https://github.com/pyr0hax/nchat/releases";
+  p_Entities[3].offset = 63;
+  p_Entities[3].length = 9;
+  p_Entities[3].type = TgMarkdown::EntityBold;
+  p_Entities[4].offset = 90;
+  p_Entities[4].length = 12;
+  p_Entities[4].type = TgMarkdown::EntityCode;
+}
+
+template<typename TFunc>
+static void Bench(const std::string& p_Filter, const std::string& p_Name, TFunc p_Func)
+{
+  if (!p_Filter.empty() && (p_Name.find(p_Filter) == std::string::npos)) return;
+
+  p_Func(); // warm up lazily initialized tables
+
+  uint64_t iterations = 0;
+  uint64_t batch = 1;
+  const uint64_t allocCountStart = s_AllocCount;
+  const auto timeStart = std::chrono::steady_clock::now();
+  int64_t elapsedNs = 0;
+  do
+  {
+    for (uint64_t i = 0; i < batch; ++i)
+    {
+      p_Func();
+    }
+
+    iterations += batch;
+    batch *= 2;
+    elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                     timeStart).count();
+  }
+  while (elapsedNs < s_MinTimeNs);
+
+  const double nsPerOp = static_cast<double>(elapsedNs) / iterations;
+  const double allocsPerOp = static_cast<double>(s_AllocCount - allocCountStart) / iterations;
+  printf("%-36s %14.1f ns/op %12.1f allocs/op\n", p_Name.c_str(), nsPerOp, allocsPerOp);
+}
+
+int main(int argc, char* argv[])
+{
+  setlocale(LC_ALL, "");
+  if (MB_CUR_MAX == 1)
+  {
+    setlocale(LC_ALL, "C.UTF-8");
+  }
+
+  const std::string filter = (argc > 1) ? argv[1] : "";
+
+  const std::vector<std::pair<std::string, std::string>> corpora =
+  {
+    { "english", GetEnglishText() },
+    { "multilingual", GetMultilingualText() },
+    { "emoji", GetEmojiText() },
+    { "longpaste", GetLongPaste() },
+  };
+
+  for (const auto& corpus : corpora)
+  {
+    const std::string& str = corpus.second;
+    const std::wstring wstr = StrUtil::ToWString(str);
+    const std::string suffix = "/" + corpus.first;
+
+    // *INDENT-OFF*
+    Bench(filter, "ToWString" + suffix, [&]() { s_Sink += StrUtil::ToWString(str).size(); });
+    Bench(filter, "ToString" + suffix, [&]() { s_Sink += StrUtil::ToString(wstr).size(); });
+    Bench(filter, "WStringWidth" + suffix, [&]() { s_Sink += StrUtil::WStringWidth(wstr); });
+    Bench(filter, "WordWrap" + suffix, [&]()
+    {
+      s_Sink += StrUtil::WordWrap(wstr, 80, false, false, false, 2).size();
+    });
+    Bench(filter, "Textize" + suffix, [&]() { s_Sink += EmojiUtil::Textize(str).size(); });
+    // *INDENT-ON*
+  }
+
+  const std::string shortcodes = Repeat(GetEmojiShortcodeText(), 16 * 1024);
+  const std::string urlText = GetUrlText();
+  FileInfo fileInfo;
+  fileInfo.fileStatus = FileStatusDownloaded;
+  fileInfo.fileId = "AgACAgQAAxkBAAIBa2Zk3Xh9b2aE1c8TqL0QeJxZ4vNrAAKxwDEbQ2WQUq1";
+  fileInfo.filePath = "/home/user/.local/share/nchat/tgchat/downloads/photo_2024-05-12_18-21-07.jpg";
+  fileInfo.fileType = "image/jpeg";
+  const std::string fileInfoHex = ProtocolUtil::FileInfoToHex(fileInfo);
+  std::string formattedText;
+  std::vector<TgMarkdown::Entity> formattedEntities;
+  GetFormattedMessage(formattedText, formattedEntities);
+  const std::vector<TgMarkdown::Entity> noEntities;
+  const int64_t id = -1001234567890123;
+  const std::string idHex = StrUtil::NumToHex(id);
+  const std::string profileId = "Telegram_+4670"; // short enough to not allocate
+
+  // *INDENT-OFF*
+  Bench(filter, "Emojize/shortcodes", [&]() { s_Sink += EmojiUtil::Emojize(shortcodes, false).size(); });
+  Bench(filter, "Emojize/plain", [&]() { s_Sink += EmojiUtil::Emojize(GetLongPaste(), false).size(); });
+  Bench(filter, "ExtractUrlsFromStr/urls", [&]() { s_Sink += StrUtil::ExtractUrlsFromStr(urlText).size(); });
+  Bench(filter, "EscapeRawUrls/urls", [&]() { s_Sink += StrUtil::EscapeRawUrls(urlText).size(); });
+  Bench(filter, "EscapeRawUrls/longpaste", [&]() { s_Sink += StrUtil::EscapeRawUrls(GetLongPaste()).size(); });
+  Bench(filter, "FileInfoToHex", [&]() { s_Sink += ProtocolUtil::FileInfoToHex(fileInfo).size(); });
+  Bench(filter, "FileInfoFromHex", [&]() { s_Sink += ProtocolUtil::FileInfoFromHex(fileInfoHex).filePath.size(); });
+  Bench(filter, "MarkdownRender/plain", [&]()
+  {
+    std::string markdown;
+    TgMarkdown::Render(formattedText, noEntities, 2, markdown);
+    s_Sink += markdown.size();
+  });
+  Bench(filter, "MarkdownRender/entities", [&]()
+  {
+    std::string markdown;
+    TgMarkdown::Render(formattedText, formattedEntities, 2, markdown);
+    s_Sink += markdown.size();
+  });
+  Bench(filter, "NumToHex", [&]() { s_Sink += StrUtil::NumToHex(id).size(); });
+  Bench(filter, "NumFromHex", [&]() { s_Sink += StrUtil::NumFromHex<int64_t>(idHex); });
+  Bench(filter, "TypingNotify/make_shared", [&]()
+  {
+    std::shared_ptr<ReceiveTypingNotify> notify = std::make_shared<ReceiveTypingNotify>(profileId);
+    notify->isTyping = true;
+    s_Sink += notify.use_count();
+  });
+  Bench(filter, "TypingNotify/pooled", [&]()
+  {
+    std::shared_ptr<ReceiveTypingNotify> notify = ObjectPool::MakeShared<ReceiveTypingNotify>(profileId);
+    notify->isTyping = true;
+    s_Sink += notify.use_count();
+  });
+  Bench(filter, "StatusNotify/make_shared", [&]()
+  {
+    std::shared_ptr<ReceiveStatusNotify> notify = std::make_shared<ReceiveStatusNotify>(profileId);
+    notify->isOnline = true;
+    s_Sink += notify.use_count();
+  });
+  Bench(filter, "StatusNotify/pooled", [&]()
+  {
+    std::shared_ptr<ReceiveStatusNotify> notify = ObjectPool::MakeShared<ReceiveStatusNotify>(profileId);
+    notify->isOnline = true;
+    s_Sink += notify.use_count();
+  });
+  // *INDENT-ON*
+
+  return 0;
+}
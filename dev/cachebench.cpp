@@ -0,0 +1,291 @@
+// cachebench.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// message cache load generator and latency benchmark, see Usage() for options
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "appconfig.h"
+#include "fileutil.h"
+#include "messagecache.h"
+#include "timeutil.h"
+
+static const std::string s_ProfileId = "Bench_cachebench";
+
+struct Options
+{
+  int chats = 50;
+  int messages = 2000;
+  int batch = 100;
+  int writers = 2;
+  int reads = 5000;
+  int limit = 25;
+  bool wal = false;
+  std::string dir = "/tmp/nchat-cachebench";
+  std::string exportFormat = "txt";
+};
+
+static int64_t GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t GetFileSize(const std::string& p_Path)
+{
+  struct stat st;
+  return (stat(p_Path.c_str(), &st) == 0) ? static_cast<int64_t>(st.st_size) : -1;
+}
+
+static std::string GetChatId(int p_Chat)
+{
+  return "chat" + std::to_string(p_Chat);
+}
+
+static std::string GetMsgId(int p_Chat, int64_t p_Msg)
+{
+  // fixed width for id ordering to match time ordering within a chat
+  char buf[32];
+  snprintf(buf, sizeof(buf), "msg%05d_%09lld", p_Chat, static_cast<long long>(p_Msg));
+  return buf;
+}
+
+static ChatMessage MakeMessage(int p_Chat, int64_t p_Msg, std::mt19937& p_Rng)
+{
+  static const std::vector<std::string> words =
+  {
+    "hey", "lunch", "tomorrow", "meeting", "https://example.com/a/b", "thanks", "ok", "see", "you",
+    "project", "update", "Привет", "你好", "😀", "👍", "later", "call", "photo", "weekend", "sure",
+  };
+
+  ChatMessage chatMessage;
+  chatMessage.id = GetMsgId(p_Chat, p_Msg);
+  chatMessage.senderId = ((p_Msg % 3) == 0) ? "self" : ("user" + std::to_string(p_Chat));
+  chatMessage.isOutgoing = ((p_Msg % 3) == 0);
+  chatMessage.isRead = true;
+  chatMessage.timeSent = 1700000000000 + (p_Msg * 1000);
+  const int wordCount = 1 + (p_Rng() % 40);
+  for (int i = 0; i < wordCount; ++i)
+  {
+    chatMessage.text += (i > 0 ? " " : "") + words[p_Rng() % words.size()];
+  }
+
+  return chatMessage;
+}
+
+static void PrintLatencies(const std::string& p_Name, std::vector<int64_t>& p_LatenciesNs)
+{
+  if (p_LatenciesNs.empty())
+  {
+    printf("%-22s no samples\n", p_Name.c_str());
+    return;
+  }
+
+  std::sort(p_LatenciesNs.begin(), p_LatenciesNs.end());
+  auto Percentile = [&](double p_Pct) -> double
+  {
+    const size_t idx = std::min(p_LatenciesNs.size() - 1, static_cast<size_t>(p_Pct * p_LatenciesNs.size()));
+    return p_LatenciesNs[idx] / 1000.0;
+  };
+
+  printf("%-22s n %7zu  p50 %9.1f us  p99 %9.1f us  max %9.1f us\n", p_Name.c_str(), p_LatenciesNs.size(),
+         Percentile(0.50), Percentile(0.99), p_LatenciesNs.back() / 1000.0);
+}
+
+static void Usage()
+{
+  printf("usage: nchat_cachebench [OPTION...]\n"
+         "    -c <N>     number of chats (default 50)\n"
+         "    -m <N>     messages per chat (default 2000)\n"
+         "    -b <N>     messages per AddMessages batch (default 100)\n"
+         "    -w <N>     concurrent writer threads during reads (default 2)\n"
+         "    -r <N>     number of read operations (default 5000)\n"
+         "    -l <N>     FetchMessagesFrom limit (default 25)\n"
+         "    -W         enable sqlite write-ahead logging\n"
+         "    -d <DIR>   working dir, removed on start (default /tmp/nchat-cachebench)\n"
+         "    -f <FMT>   export format (default txt)\n"
+         "    -h         show this help\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1) < argc;
+    if ((arg == "-c") && hasValue) options.chats = std::max(1, atoi(argv[++i]));
+    else if ((arg == "-m") && hasValue) options.messages = std::max(1, atoi(argv[++i]));
+    else if ((arg == "-b") && hasValue) options.batch = std::max(1, atoi(argv[++i]));
+    else if ((arg == "-w") && hasValue) options.writers = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-r") && hasValue) options.reads = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-l") && hasValue) options.limit = std::max(1, atoi(argv[++i]));
+    else if (arg == "-W") options.wal = true;
+    else if ((arg == "-d") && hasValue) options.dir = argv[++i];
+    else if ((arg == "-f") && hasValue) options.exportFormat = argv[++i];
+    else
+    {
+      Usage();
+      return (arg == "-h") ? 0 : 1;
+    }
+  }
+
+  if (!MessageCache::IsExportFormat(options.exportFormat))
+  {
+    printf("unsupported export format %s\n", options.exportFormat.c_str());
+    return 1;
+  }
+
+  FileUtil::RmDir(options.dir);
+  FileUtil::MkDir(options.dir);
+  FileUtil::SetApplicationDir(options.dir);
+  AppConfig::Init();
+  AppConfig::SetBool("cache_wal_enabled", options.wal);
+  MessageCache::Init();
+
+  std::atomic<int64_t> notifyCount(0);
+  // *INDENT-OFF*
+  MessageCache::SetMessageHandler([&](std::shared_ptr<ServiceMessage>)
+  {
+    ++notifyCount;
+  });
+  // *INDENT-ON*
+
+  MessageCache::AddProfile(s_ProfileId, true, 0, false);
+
+  printf("chats %d messages %d batch %d writers %d reads %d wal %d\n", options.chats, options.messages,
+         options.batch, options.writers, options.reads, AppConfig::GetBool("cache_wal_enabled"));
+
+  // bulk insert, newest batch first like history fetches from the services
+  std::mt19937 rng(1);
+  const int64_t insertStartNs = GetTimeNs();
+  for (int chat = 0; chat < options.chats; ++chat)
+  {
+    std::string fromMsgId;
+    for (int64_t msg = options.messages - 1; msg >= 0; msg -= options.batch)
+    {
+      std::vector<ChatMessage> chatMessages;
+      for (int64_t i = msg; (i > (msg - options.batch)) && (i >= 0); --i)
+      {
+        chatMessages.push_back(MakeMessage(chat, i, rng));
+      }
+
+      const std::string nextFromMsgId = chatMessages.back().id;
+      MessageCache::AddMessages(s_ProfileId, GetChatId(chat), fromMsgId, chatMessages);
+      fromMsgId = nextFromMsgId;
+    }
+  }
+
+  // writes are asynchronous, wait for the last one to be visible
+  const std::string lastChatId = GetChatId(options.chats - 1);
+  const std::string lastMsgId = GetMsgId(options.chats - 1, 0);
+  while (!MessageCache::FetchOneMessage(s_ProfileId, lastChatId, lastMsgId, true))
+  {
+    TimeUtil::Sleep(0.001);
+  }
+
+  const double insertSec = (GetTimeNs() - insertStartNs) / 1e9;
+  const int64_t totalMessages = static_cast<int64_t>(options.chats) * options.messages;
+  printf("%-22s %lld msgs in %.2f s, %.0f msgs/s\n", "AddMessages", static_cast<long long>(totalMessages),
+         insertSec, totalMessages / std::max(insertSec, 1e-9));
+
+  // re-adding the newest message marks each chat as in sync, which cached fetches require
+  for (int chat = 0; chat < options.chats; ++chat)
+  {
+    std::vector<ChatMessage> chatMessages(1, MakeMessage(chat, options.messages - 1, rng));
+    MessageCache::AddMessages(s_ProfileId, GetChatId(chat), "", chatMessages);
+  }
+
+  // fetches under concurrent writers appending new messages
+  std::atomic<bool> running(true);
+  std::atomic<int64_t> writeCount(0);
+  std::vector<std::thread> writers;
+  for (int w = 0; w < options.writers; ++w)
+  {
+    // *INDENT-OFF*
+    writers.emplace_back([&, w]()
+    {
+      std::mt19937 writerRng(100 + w);
+      int64_t msg = options.messages + (static_cast<int64_t>(w + 1) * 10000000);
+      while (running)
+      {
+        const int chat = writerRng() % options.chats;
+        std::vector<ChatMessage> chatMessages(1, MakeMessage(chat, msg++, writerRng));
+        MessageCache::AddMessages(s_ProfileId, GetChatId(chat), "", chatMessages);
+        ++writeCount;
+        TimeUtil::Sleep(0.001);
+      }
+    });
+    // *INDENT-ON*
+  }
+
+  int64_t memoryHitsStart = 0;
+  int64_t memoryMissesStart = 0;
+  MessageCache::GetMemoryStats(memoryHitsStart, memoryMissesStart);
+
+  std::vector<int64_t> fetchFromNs;
+  std::vector<int64_t> fetchOneNs;
+  fetchFromNs.reserve(options.reads);
+  fetchOneNs.reserve(options.reads);
+  const int64_t readStartNs = GetTimeNs();
+  for (int i = 0; i < options.reads; ++i)
+  {
+    const int chat = rng() % options.chats;
+    const std::string chatId = GetChatId(chat);
+    const std::string msgId = GetMsgId(chat, rng() % options.messages);
+
+    // mix of latest page and random history pages
+    const std::string fromMsgId = ((i % 4) == 0) ? "" : msgId;
+    int64_t startNs = GetTimeNs();
+    MessageCache::FetchMessagesFrom(s_ProfileId, chatId, fromMsgId, options.limit, true);
+    fetchFromNs.push_back(GetTimeNs() - startNs);
+
+    startNs = GetTimeNs();
+    MessageCache::FetchOneMessage(s_ProfileId, chatId, msgId, true);
+    fetchOneNs.push_back(GetTimeNs() - startNs);
+  }
+
+  const double readSec = (GetTimeNs() - readStartNs) / 1e9;
+  running = false;
+  for (auto& writer : writers)
+  {
+    writer.join();
+  }
+
+  int64_t memoryHits = 0;
+  int64_t memoryMisses = 0;
+  MessageCache::GetMemoryStats(memoryHits, memoryMisses);
+
+  PrintLatencies("FetchMessagesFrom", fetchFromNs);
+  PrintLatencies("FetchOneMessage", fetchOneNs);
+  printf("%-22s %lld writes in %.2f s, memory hits %lld misses %lld\n", "concurrent",
+         static_cast<long long>(writeCount.load()), readSec, static_cast<long long>(memoryHits - memoryHitsStart),
+         static_cast<long long>(memoryMisses - memoryMissesStart));
+
+  const std::string exportDir = options.dir + "/export";
+  const int64_t exportStartNs = GetTimeNs();
+  MessageCache::Export(exportDir, options.exportFormat, false);
+  printf("%-22s %s in %.2f s\n", "Export", options.exportFormat.c_str(), (GetTimeNs() - exportStartNs) / 1e9);
+
+  MessageCache::Cleanup();
+  AppConfig::Cleanup();
+  printf("db size %lld bytes, notifications %lld\n",
+         static_cast<long long>(GetFileSize(options.dir + "/history/" + s_ProfileId + "/db.sqlite")),
+         static_cast<long long>(notifyCount.load()));
+
+  return 0;
+}
@@ -0,0 +1,436 @@
+// cachetest.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// message cache regression checks, usage: nchat_cachetest [filter]
+//
+// each check runs against its own profile in a scratch dir, through the public cache api, reading the
+// profile db directly only where storage itself is checked. exits non-zero if any check fails.
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "appconfig.h"
+#include "backgroundexecutor.h"
+#include "fileutil.h"
+#include "messagecache.h"
+#include "strutil.h"
+#include "timeutil.h"
+
+static const std::string s_Dir = "/tmp/nchat-cachetest";
+static const double s_WaitSec = 5.0;
+static const double s_ArchiveWaitSec = 30.0; // archival starts once a profile has been idle for a while
+static const int64_t s_Now = TimeUtil::GetCurrentTimeMSec(); // messages sent before now - 1 day are archived
+
+static std::mutex s_Mutex;
+static std::map<std::pair<std::string, std::string>, std::vector<ChatMessage>> s_Fetched; // by profile and chat
+static std::vector<std::pair<std::string, ChatMessage>> s_Searched;
+
+#define CHECK(p_Cond) \
+  do \
+  { \
+    if (!(p_Cond)) \
+    { \
+      printf("  %s:%d check failed: %s\n", __FILE__, __LINE__, #p_Cond); \
+      return false; \
+    } \
+  } while (0)
+
+class CacheTest
+{
+public:
+  static int Run(const std::string& p_Filter);
+
+private:
+  static bool TestDeletedChatKeyNotReused();
+  static bool TestFetchQueuedWrites();
+  static bool TestArchivedMessages();
+  static bool TestQuotedTextByRef();
+
+  static ChatMessage MakeMessage(const std::string& p_Id, int64_t p_TimeSent, const std::string& p_Text);
+  static void AddProfile(const std::string& p_ProfileId);
+  static bool WaitMessage(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId);
+  static std::vector<ChatMessage> Fetch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                        const std::string& p_FromMsgId = "");
+  static bool WaitFetch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                        const std::function<bool(const std::vector<ChatMessage>&)>& p_Cond);
+  static std::vector<std::pair<std::string, ChatMessage>> Search(const std::string& p_ProfileId,
+                                                                 const std::string& p_Query);
+  static const ChatMessage* Find(const std::vector<ChatMessage>& p_ChatMessages, const std::string& p_MsgId);
+  static int GetQuotedTextIsNull(const std::string& p_ProfileId, const std::string& p_MsgId);
+};
+
+ChatMessage CacheTest::MakeMessage(const std::string& p_Id, int64_t p_TimeSent, const std::string& p_Text)
+{
+  ChatMessage chatMessage;
+  chatMessage.id = p_Id;
+  chatMessage.senderId = "user";
+  chatMessage.text = p_Text;
+  chatMessage.timeSent = p_TimeSent;
+  chatMessage.isRead = true;
+  return chatMessage;
+}
+
+void CacheTest::AddProfile(const std::string& p_ProfileId)
+{
+  // without sync check, so cached history is served without first being confirmed by a protocol
+  MessageCache::AddProfile(p_ProfileId, false /*p_CheckSync*/, 0, false /*p_IsSetup*/);
+}
+
+bool CacheTest::WaitMessage(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId)
+{
+  // writes are asynchronous, a message is committed once it can be fetched
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  while (!MessageCache::FetchOneMessage(p_ProfileId, p_ChatId, p_MsgId, true /*p_Sync*/))
+  {
+    if (TimeUtil::GetCurrentTimeMSec() > endTime) return false;
+
+    TimeUtil::Sleep(0.001);
+  }
+
+  return true;
+}
+
+std::vector<ChatMessage> CacheTest::Fetch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                          const std::string& p_FromMsgId)
+{
+  const std::pair<std::string, std::string> key(p_ProfileId, p_ChatId);
+  {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    s_Fetched.erase(key);
+  }
+
+  if (!MessageCache::FetchMessagesFrom(p_ProfileId, p_ChatId, p_FromMsgId, 100, true /*p_Sync*/)) return {};
+
+  // served async while the chat has queued writes
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(s_Mutex);
+      auto it = s_Fetched.find(key);
+      if ((it != s_Fetched.end()) || (TimeUtil::GetCurrentTimeMSec() > endTime))
+      {
+        return (it != s_Fetched.end()) ? it->second : std::vector<ChatMessage>();
+      }
+    }
+
+    TimeUtil::Sleep(0.001);
+  }
+}
+
+bool CacheTest::WaitFetch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                          const std::function<bool(const std::vector<ChatMessage>&)>& p_Cond)
+{
+  // writes are asynchronous, fetch until their effect is visible
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  while (!p_Cond(Fetch(p_ProfileId, p_ChatId)))
+  {
+    if (TimeUtil::GetCurrentTimeMSec() > endTime) return false;
+
+    TimeUtil::Sleep(0.01);
+  }
+
+  return true;
+}
+
+std::vector<std::pair<std::string, ChatMessage>> CacheTest::Search(const std::string& p_ProfileId,
+                                                                   const std::string& p_Query)
+{
+  {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    s_Searched.clear();
+  }
+
+  MessageCache::Search(p_ProfileId, p_Query, 100, true /*p_Sync*/);
+
+  std::unique_lock<std::mutex> lock(s_Mutex);
+  return s_Searched;
+}
+
+const ChatMessage* CacheTest::Find(const std::vector<ChatMessage>& p_ChatMessages, const std::string& p_MsgId)
+{
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    if (chatMessage.id == p_MsgId) return &chatMessage;
+  }
+
+  return nullptr;
+}
+
+int CacheTest::GetQuotedTextIsNull(const std::string& p_ProfileId, const std::string& p_MsgId)
+{
+  // returns 1 if the quoted text is stored by reference, 0 if stored as a copy, -1 on error
+  const std::string dbPath = s_Dir + "/history/" + p_ProfileId + "/db.sqlite";
+  sqlite3* db = nullptr;
+  int isNull = -1;
+  if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK)
+  {
+    sqlite3_busy_timeout(db, static_cast<int>(s_WaitSec * 1000));
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT quotedText IS NULL FROM messages WHERE id = ?;", -1, &stmt,
+                           nullptr) == SQLITE_OK)
+    {
+      sqlite3_bind_text(stmt, 1, p_MsgId.c_str(), -1, SQLITE_TRANSIENT);
+      if (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        isNull = sqlite3_column_int(stmt, 0);
+      }
+    }
+
+    sqlite3_finalize(stmt);
+  }
+
+  sqlite3_close(db);
+  return isNull;
+}
+
+// a chat created after deleting the newest chat must not inherit its key, or the background
+// purge of the deleted chat would remove the messages of the new chat
+bool CacheTest::TestDeletedChatKeyNotReused()
+{
+  const std::string profileId = "Test_chatkey";
+  AddProfile(profileId);
+
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("a1", s_Now + 1000, "a one"),
+                                                      MakeMessage("a2", s_Now + 2000, "a two") });
+  MessageCache::AddMessages(profileId, "chatB", "", { MakeMessage("b1", s_Now + 1000, "b one"),
+                                                      MakeMessage("b2", s_Now + 2000, "b two") });
+  CHECK(WaitMessage(profileId, "chatB", "b2"));
+
+  MessageCache::DeleteChat(profileId, "chatB");
+  MessageCache::AddMessages(profileId, "chatC", "", { MakeMessage("c1", s_Now + 3000, "c one"),
+                                                      MakeMessage("c2", s_Now + 4000, "c two") });
+  CHECK(WaitMessage(profileId, "chatC", "c2"));
+  CHECK(Fetch(profileId, "chatC").size() == 2);
+
+  // purge runs in batches on worker idle, wait for the deleted chat to be gone from fetches
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  while (!Fetch(profileId, "chatB").empty() && (TimeUtil::GetCurrentTimeMSec() < endTime))
+  {
+    TimeUtil::Sleep(0.01);
+  }
+
+  TimeUtil::Sleep(0.5);
+  CHECK(Fetch(profileId, "chatB").empty());
+  CHECK(Fetch(profileId, "chatA").size() == 2);
+  CHECK(Fetch(profileId, "chatC").size() == 2);
+  return true;
+}
+
+// a sync fetch of a chat with queued writes is served async, once the writes are committed,
+// rather than blocking the caller or returning a page without them
+bool CacheTest::TestFetchQueuedWrites()
+{
+  const std::string profileId = "Test_queuedwrites";
+  AddProfile(profileId);
+
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("a1", s_Now + 1000, "a one"),
+                                                      MakeMessage("a2", s_Now + 2000, "a two") });
+  CHECK(MessageCache::FetchMessagesFrom(profileId, "chatA", "", 100, true /*p_Sync*/));
+
+  const std::pair<std::string, std::string> key(profileId, "chatA");
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  size_t count = 0;
+  while ((count < 2) && (TimeUtil::GetCurrentTimeMSec() < endTime))
+  {
+    TimeUtil::Sleep(0.001);
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    count = s_Fetched[key].size();
+  }
+
+  CHECK(count == 2);
+  CHECK(MessageCache::HasProfile(profileId));
+  CHECK(!MessageCache::HasProfile("Test_unknown"));
+  return true;
+}
+
+// archived messages are paged, searched, deleted, edited and updated as cached ones
+bool CacheTest::TestArchivedMessages()
+{
+  const std::string profileId = "Test_archive";
+  AddProfile(profileId);
+
+  const int64_t oldTime = s_Now - (30LL * 24 * 3600 * 1000);
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("a1", oldTime + 1000, "first old"),
+                                                      MakeMessage("a2", oldTime + 2000, "second alpha"),
+                                                      MakeMessage("a3", oldTime + 3000, "third old"),
+                                                      MakeMessage("a4", s_Now, "fourth new") });
+  CHECK(WaitMessage(profileId, "chatA", "a4"));
+
+  // archive is written before the moved messages are removed from db in one transaction
+  const std::string archivePath = s_Dir + "/history/" + profileId + "/archive/" + StrUtil::StrToHex("chatA") + ".arc";
+  const int64_t endTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_ArchiveWaitSec * 1000);
+  while (!FileUtil::Exists(archivePath) && (TimeUtil::GetCurrentTimeMSec() < endTime))
+  {
+    TimeUtil::Sleep(0.1);
+  }
+
+  CHECK(FileUtil::Exists(archivePath));
+  TimeUtil::Sleep(0.5);
+
+  // quoted messages are resolved through the archive index, and decoded by the async fetch
+  {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    s_Fetched.erase(std::make_pair(profileId, "chatA"));
+  }
+
+  std::vector<std::string> missingMsgIds;
+  CHECK(MessageCache::FetchMessages(profileId, "chatA", { "a1", "ax" }, missingMsgIds));
+  CHECK((missingMsgIds.size() == 1) && (missingMsgIds.front() == "ax"));
+  const int64_t fetchEndTime = TimeUtil::GetCurrentTimeMSec() + static_cast<int64_t>(s_WaitSec * 1000);
+  bool fetched = false;
+  while (!fetched && (TimeUtil::GetCurrentTimeMSec() < fetchEndTime))
+  {
+    TimeUtil::Sleep(0.001);
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    const ChatMessage* chatMessage = Find(s_Fetched[std::make_pair(profileId, "chatA")], "a1");
+    fetched = chatMessage && (chatMessage->text == "first old");
+  }
+
+  CHECK(fetched);
+
+  std::vector<ChatMessage> chatMessages = Fetch(profileId, "chatA");
+  CHECK(chatMessages.size() == 4);
+  chatMessages = Fetch(profileId, "chatA", "a3");
+  CHECK((chatMessages.size() == 2) && Find(chatMessages, "a2") && Find(chatMessages, "a1"));
+
+  std::vector<std::pair<std::string, ChatMessage>> searched = Search(profileId, "alpha");
+  CHECK((searched.size() == 1) && (searched.front().first == "chatA") && (searched.front().second.id == "a2"));
+
+  MessageCache::DeleteOneMessage(profileId, "chatA", "a2");
+  // *INDENT-OFF*
+  CHECK(WaitFetch(profileId, "chatA", [](const std::vector<ChatMessage>& p_ChatMessages)
+  {
+    return (p_ChatMessages.size() == 3) && !Find(p_ChatMessages, "a2");
+  }));
+  CHECK(Search(profileId, "alpha").empty());
+
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("a3", oldTime + 3000, "third edited") });
+  CHECK(WaitFetch(profileId, "chatA", [](const std::vector<ChatMessage>& p_ChatMessages)
+  {
+    const ChatMessage* chatMessage = Find(p_ChatMessages, "a3");
+    return (p_ChatMessages.size() == 3) && chatMessage && (chatMessage->text == "third edited");
+  }));
+  searched = Search(profileId, "third");
+  CHECK((searched.size() == 1) && (searched.front().second.text == "third edited"));
+
+  MessageCache::UpdateMessageIsRead(profileId, "chatA", "a1", false);
+  CHECK(WaitFetch(profileId, "chatA", [](const std::vector<ChatMessage>& p_ChatMessages)
+  {
+    const ChatMessage* chatMessage = Find(p_ChatMessages, "a1");
+    return (p_ChatMessages.size() == 3) && chatMessage && !chatMessage->isRead;
+  }));
+  // *INDENT-ON*
+  return true;
+}
+
+// with compressed texts, a reply quoting a cached message stores its quoted text by reference. a
+// redelivered quoted message must keep the reference, and an edited one must not change the quote
+bool CacheTest::TestQuotedTextByRef()
+{
+  const std::string profileId = "Test_quoteref";
+  AddProfile(profileId);
+
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("q1", s_Now + 1000, "quoted text") });
+  CHECK(WaitMessage(profileId, "chatA", "q1"));
+  ChatMessage reply = MakeMessage("r1", s_Now + 2000, "reply");
+  reply.quotedId = "q1";
+  reply.quotedText = "quoted text";
+  reply.quotedSender = "user";
+  MessageCache::AddMessages(profileId, "chatA", "", { reply });
+  CHECK(WaitMessage(profileId, "chatA", "r1"));
+  CHECK(GetQuotedTextIsNull(profileId, "r1") == 1);
+
+  // writes of a chat are committed in order, so a later message marks the redelivery done
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("q1", s_Now + 1000, "quoted text") });
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("m1", s_Now + 3000, "marker one") });
+  CHECK(WaitMessage(profileId, "chatA", "m1"));
+  CHECK(GetQuotedTextIsNull(profileId, "r1") == 1);
+
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("q1", s_Now + 1000, "quoted edited") });
+  MessageCache::AddMessages(profileId, "chatA", "", { MakeMessage("m2", s_Now + 4000, "marker two") });
+  CHECK(WaitMessage(profileId, "chatA", "m2"));
+  CHECK(GetQuotedTextIsNull(profileId, "r1") == 0);
+  // *INDENT-OFF*
+  CHECK(WaitFetch(profileId, "chatA", [](const std::vector<ChatMessage>& p_ChatMessages)
+  {
+    const ChatMessage* quoted = Find(p_ChatMessages, "q1");
+    const ChatMessage* chatMessage = Find(p_ChatMessages, "r1");
+    return quoted && (quoted->text == "quoted edited") && chatMessage && (chatMessage->quotedText == "quoted text");
+  }));
+  // *INDENT-ON*
+  return true;
+}
+
+int CacheTest::Run(const std::string& p_Filter)
+{
+  FileUtil::RmDir(s_Dir);
+  FileUtil::MkDir(s_Dir);
+  FileUtil::SetApplicationDir(s_Dir);
+  FileUtil::WriteFile(s_Dir + "/app.conf", "cache_archive_age_days=1\ncache_compress_text=1\n");
+  AppConfig::Init();
+  BackgroundExecutor::Init();
+  MessageCache::Init();
+
+  // *INDENT-OFF*
+  MessageCache::SetMessageHandler([](std::shared_ptr<ServiceMessage> p_ServiceMessage)
+  {
+    if (p_ServiceMessage->GetMessageType() == SearchMessagesNotifyType)
+    {
+      std::shared_ptr<SearchMessagesNotify> searchMessagesNotify =
+        std::static_pointer_cast<SearchMessagesNotify>(p_ServiceMessage);
+      std::unique_lock<std::mutex> lock(s_Mutex);
+      s_Searched = searchMessagesNotify->chatMessages;
+      return;
+    }
+
+    if (p_ServiceMessage->GetMessageType() != NewMessagesNotifyType) return;
+
+    std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::static_pointer_cast<NewMessagesNotify>(p_ServiceMessage);
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    std::vector<ChatMessage>& chatMessages = s_Fetched[std::make_pair(newMessagesNotify->profileId,
+                                                                      newMessagesNotify->chatId)];
+    chatMessages.insert(chatMessages.end(), newMessagesNotify->chatMessages.begin(),
+                        newMessagesNotify->chatMessages.end());
+  });
+  // *INDENT-ON*
+
+  const std::vector<std::pair<std::string, std::function<bool()>>> tests =
+  {
+    { "DeletedChatKeyNotReused", TestDeletedChatKeyNotReused },
+    { "FetchQueuedWrites", TestFetchQueuedWrites },
+    { "ArchivedMessages", TestArchivedMessages },
+    { "QuotedTextByRef", TestQuotedTextByRef },
+  };
+
+  int failCount = 0;
+  for (const auto& test : tests)
+  {
+    if (!p_Filter.empty() && (test.first.find(p_Filter) == std::string::npos)) continue;
+
+    const bool passed = test.second();
+    printf("%-36s %s\n", test.first.c_str(), passed ? "ok" : "FAILED");
+    failCount += passed ? 0 : 1;
+  }
+
+  MessageCache::Cleanup();
+  BackgroundExecutor::Cleanup();
+  AppConfig::Cleanup();
+  return (failCount > 0) ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string filter = (argc > 1) ? argv[1] : "";
+  return CacheTest::Run(filter);
+}
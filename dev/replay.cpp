@@ -0,0 +1,376 @@
+// replay.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// headless replay of recorded service messages through message cache and ui model, see Usage() for options
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ncurses.h>
+
+#include "appconfig.h"
+#include "emojilist.h"
+#include "fileutil.h"
+#include "log.h"
+#include "messagecache.h"
+#include "messagerecorder.h"
+#include "timeutil.h"
+#include "uicolorconfig.h"
+#include "uiconfig.h"
+#include "uikeyconfig.h"
+#include "uimodel.h"
+
+static const int64_t s_DrainTimeoutNs = 60LL * 1000 * 1000 * 1000;
+
+struct Options
+{
+  std::string path;
+  std::string generatePath;
+  int repeat = 1;
+  bool render = false;
+  bool verbose = false;
+  int chats = 20;
+  int messages = 500;
+  std::string dir = "/tmp/nchat-replay";
+};
+
+// stand-in for a chat service, requests from the ui model are dropped
+class ReplayProtocol : public Protocol
+{
+public:
+  explicit ReplayProtocol(const std::string& p_ProfileId)
+    : m_ProfileId(p_ProfileId)
+  {
+  }
+
+  std::string GetProfileId() const { return m_ProfileId; }
+  std::string GetProfileDisplayName() const { return m_ProfileId; }
+  bool HasFeature(ProtocolFeature /*p_ProtocolFeature*/) const { return false; }
+
+  bool SetupProfile(const std::string& /*p_ProfilesDir*/, std::string& /*p_ProfileId*/) { return false; }
+  bool LoadProfile(const std::string& /*p_ProfilesDir*/, const std::string& /*p_ProfileId*/) { return true; }
+  bool CloseProfile() { return true; }
+
+  bool Login() { return true; }
+  bool Logout() { return true; }
+
+  void SendRequest(std::shared_ptr<RequestMessage> /*p_Request*/) { }
+  void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& /*p_MessageHandler*/) { }
+
+private:
+  std::string m_ProfileId;
+};
+
+static int64_t GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PrintLatencies(const std::string& p_Name, std::vector<int64_t>& p_LatenciesNs)
+{
+  if (p_LatenciesNs.empty())
+  {
+    printf("%-22s no samples\n", p_Name.c_str());
+    return;
+  }
+
+  std::sort(p_LatenciesNs.begin(), p_LatenciesNs.end());
+  auto Percentile = [&](double p_Pct) -> double
+  {
+    const size_t idx = std::min(p_LatenciesNs.size() - 1, static_cast<size_t>(p_Pct * p_LatenciesNs.size()));
+    return p_LatenciesNs[idx] / 1000.0;
+  };
+
+  printf("%-22s n %7zu  p50 %9.1f us  p99 %9.1f us  max %9.1f us\n", p_Name.c_str(), p_LatenciesNs.size(),
+         Percentile(0.50), Percentile(0.99), p_LatenciesNs.back() / 1000.0);
+}
+
+static bool Generate(const Options& p_Options)
+{
+  // synthetic recording with contacts, chats and a stream of incoming messages
+  if (!MessageRecorder::Open(p_Options.generatePath)) return false;
+
+  static const std::string profileId = "Replay_synthetic";
+  std::shared_ptr<NewContactsNotify> newContactsNotify = std::make_shared<NewContactsNotify>(profileId);
+  std::shared_ptr<NewChatsNotify> newChatsNotify = std::make_shared<NewChatsNotify>(profileId);
+  newChatsNotify->success = true;
+  for (int chat = 0; chat < p_Options.chats; ++chat)
+  {
+    ContactInfo contactInfo;
+    contactInfo.id = "chat" + std::to_string(chat);
+    contactInfo.name = "Contact " + std::to_string(chat);
+    newContactsNotify->contactInfos.push_back(contactInfo);
+
+    ChatInfo chatInfo;
+    chatInfo.id = contactInfo.id;
+    chatInfo.lastMessageTime = 1700000000000;
+    newChatsNotify->chatInfos.push_back(chatInfo);
+  }
+
+  MessageRecorder::Write(newContactsNotify);
+  MessageRecorder::Write(newChatsNotify);
+
+  for (int msg = 0; msg < p_Options.messages; ++msg)
+  {
+    const std::string chatId = "chat" + std::to_string(msg % p_Options.chats);
+    const std::string msgId = "msg" + std::to_string(1000000 + msg);
+    if ((msg % 10) == 0)
+    {
+      std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify = std::make_shared<ReceiveTypingNotify>(profileId);
+      receiveTypingNotify->chatId = chatId;
+      receiveTypingNotify->userId = chatId;
+      receiveTypingNotify->isTyping = true;
+      MessageRecorder::Write(receiveTypingNotify);
+    }
+
+    ChatMessage chatMessage;
+    chatMessage.id = msgId;
+    chatMessage.senderId = chatId;
+    chatMessage.text = "message " + std::to_string(msg) + " lorem ipsum dolor sit amet 👍";
+    chatMessage.timeSent = 1700000000000 + (msg * 1000);
+    std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(profileId);
+    newMessagesNotify->success = true;
+    newMessagesNotify->chatId = chatId;
+    newMessagesNotify->chatMessages.push_back(chatMessage);
+    newMessagesNotify->sequence = true;
+    MessageRecorder::Write(newMessagesNotify);
+
+    if ((msg % 4) == 0)
+    {
+      std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
+        std::make_shared<NewMessageStatusNotify>(profileId);
+      newMessageStatusNotify->chatId = chatId;
+      newMessageStatusNotify->msgId = msgId;
+      newMessageStatusNotify->isRead = true;
+      MessageRecorder::Write(newMessageStatusNotify);
+    }
+  }
+
+  MessageRecorder::Close();
+  return true;
+}
+
+static void Usage()
+{
+  printf("usage: nchat_replay [OPTION...] <FILE>\n"
+         "    -n <N>     number of times to replay recording (default 1)\n"
+         "    -r         render ui to off-screen terminal after each event\n"
+         "    -g <FILE>  generate synthetic recording to file and exit\n"
+         "    -c <N>     number of chats to generate (default 20)\n"
+         "    -m <N>     number of messages to generate (default 500)\n"
+         "    -d <DIR>   working dir, removed on start (default /tmp/nchat-replay)\n"
+         "    -v         enable debug logging to log.txt in working dir\n"
+         "    -h         show this help\n"
+         "recordings are created by nchat --record <FILE>\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1) < argc;
+    if ((arg == "-n") && hasValue) options.repeat = std::max(1, atoi(argv[++i]));
+    else if (arg == "-r") options.render = true;
+    else if (arg == "-v") options.verbose = true;
+    else if ((arg == "-g") && hasValue) options.generatePath = argv[++i];
+    else if ((arg == "-c") && hasValue) options.chats = std::max(1, atoi(argv[++i]));
+    else if ((arg == "-m") && hasValue) options.messages = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-d") && hasValue) options.dir = argv[++i];
+    else if ((arg[0] != '-') && options.path.empty()) options.path = arg;
+    else
+    {
+      Usage();
+      return (arg == "-h") ? 0 : 1;
+    }
+  }
+
+  if (!options.generatePath.empty())
+  {
+    if (!Generate(options))
+    {
+      printf("failed to write %s\n", options.generatePath.c_str());
+      return 1;
+    }
+
+    printf("generated %s\n", options.generatePath.c_str());
+    return 0;
+  }
+
+  if (options.path.empty())
+  {
+    Usage();
+    return 1;
+  }
+
+  std::vector<MessageRecorder::Record> records;
+  if (!MessageRecorder::Load(options.path, records))
+  {
+    printf("failed to load %s\n", options.path.c_str());
+    return 1;
+  }
+
+  // profiles and newest cached message, for waiting on cache writes after replay
+  std::map<std::string, int64_t> profileIds;
+  std::string lastProfileId;
+  std::string lastChatId;
+  std::string lastMsgId;
+  size_t eventCount = 0;
+  for (const auto& record : records)
+  {
+    std::shared_ptr<ServiceMessage> serviceMessage = MessageRecorder::Decode(record.data);
+    if (!serviceMessage) continue;
+
+    ++eventCount;
+    ++profileIds[serviceMessage->profileId];
+    if (serviceMessage->GetMessageType() == NewMessagesNotifyType)
+    {
+      std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+        std::static_pointer_cast<NewMessagesNotify>(serviceMessage);
+      if (newMessagesNotify->success && !newMessagesNotify->cached && newMessagesNotify->sequence &&
+          !newMessagesNotify->chatMessages.empty())
+      {
+        lastProfileId = newMessagesNotify->profileId;
+        lastChatId = newMessagesNotify->chatId;
+        lastMsgId = newMessagesNotify->chatMessages.back().id;
+      }
+    }
+  }
+
+  FileUtil::RmDir(options.dir);
+  FileUtil::MkDir(options.dir);
+  FileUtil::SetApplicationDir(options.dir);
+  Log::SetVerboseLevel(options.verbose ? Log::DEBUG_LEVEL : Log::INFO_LEVEL);
+  Log::Init(options.dir + "/log.txt");
+  AppConfig::Init();
+  MessageCache::Init();
+  // draw every frame, no notifications
+  FileUtil::WriteFile(options.dir + "/ui.conf",
+                      "max_frame_rate=0\n"
+                      "desktop_notify_active=0\n"
+                      "desktop_notify_inactive=0\n"
+                      "terminal_bell_active=0\n"
+                      "terminal_bell_inactive=0\n");
+  UiConfig::Init();
+
+  // off-screen terminal of fixed size
+  setenv("LINES", "50", 0);
+  setenv("COLUMNS", "160", 0);
+  setlocale(LC_ALL, "");
+  const char* term = getenv("TERM");
+  FILE* outFile = fopen("/dev/null", "w");
+  FILE* inFile = fopen("/dev/null", "r");
+  SCREEN* screen = newterm((term != nullptr) ? term : "xterm", outFile, inFile);
+  if (screen == nullptr)
+  {
+    printf("failed to create terminal\n");
+    return 1;
+  }
+
+  EmojiList::Init();
+  UiKeyConfig::Init();
+  UiColorConfig::Init();
+
+  std::shared_ptr<UiModel> model = std::make_shared<UiModel>();
+  for (const auto& profileId : profileIds)
+  {
+    model->AddProtocol(std::make_shared<ReplayProtocol>(profileId.first));
+    MessageCache::AddProfile(profileId.first, true, 0, false);
+  }
+
+  // @note: cache results are not forwarded, the recording already holds those received by the ui
+  // *INDENT-OFF*
+  MessageCache::SetMessageHandler([](std::shared_ptr<ServiceMessage>)
+  {
+  });
+  // *INDENT-ON*
+
+  model->Init();
+
+  printf("events %zu (of %zu records) profiles %zu repeat %d render %d\n", eventCount, records.size(),
+         profileIds.size(), options.repeat, options.render);
+
+  std::vector<int64_t> eventNs;
+  eventNs.reserve(eventCount * options.repeat);
+  int64_t replayNs = 0;
+  for (int i = 0; i < options.repeat; ++i)
+  {
+    // decode each pass up front, as the ui model takes ownership of message contents
+    std::vector<std::shared_ptr<ServiceMessage>> serviceMessages;
+    serviceMessages.reserve(eventCount);
+    for (const auto& record : records)
+    {
+      std::shared_ptr<ServiceMessage> serviceMessage = MessageRecorder::Decode(record.data);
+      if (!serviceMessage) continue;
+
+      serviceMessages.push_back(serviceMessage);
+    }
+
+    const int64_t passStartNs = GetTimeNs();
+    for (auto& serviceMessage : serviceMessages)
+    {
+      const int64_t startNs = GetTimeNs();
+      MessageCache::AddFromServiceMessage(serviceMessage->profileId, serviceMessage);
+      model->MessageHandler(serviceMessage);
+      if (options.render)
+      {
+        model->Process();
+      }
+      else
+      {
+        model->ProcessServiceMessages();
+      }
+
+      eventNs.push_back(GetTimeNs() - startNs);
+    }
+
+    replayNs += GetTimeNs() - passStartNs;
+  }
+
+  const double replaySec = replayNs / 1e9;
+  PrintLatencies("event", eventNs);
+  printf("%-22s %zu events in %.2f s, %.0f events/s\n", "replay", eventNs.size(), replaySec,
+         eventNs.size() / std::max(replaySec, 1e-9));
+
+  // cache writes are asynchronous, wait for the last one to be visible
+  if (!lastMsgId.empty())
+  {
+    const int64_t drainStartNs = GetTimeNs();
+    while (!MessageCache::FetchOneMessage(lastProfileId, lastChatId, lastMsgId, true) &&
+           ((GetTimeNs() - drainStartNs) < s_DrainTimeoutNs))
+    {
+      TimeUtil::Sleep(0.001);
+    }
+
+    printf("%-22s %.2f s\n", "cache drain", (GetTimeNs() - drainStartNs) / 1e9);
+  }
+
+  model->Cleanup();
+  model.reset();
+  UiColorConfig::Cleanup();
+  UiKeyConfig::Cleanup();
+  EmojiList::Cleanup();
+  endwin();
+  delscreen(screen);
+  fclose(inFile);
+  fclose(outFile);
+  MessageCache::Cleanup();
+  UiConfig::Cleanup();
+  AppConfig::Cleanup();
+  Log::Cleanup();
+
+  return 0;
+}
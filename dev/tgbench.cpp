@@ -0,0 +1,333 @@
+// tgbench.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// telegram message conversion benchmarks, usage: nchat_tgbench [filter]
+//
+// replays an anonymized corpus of tdlib message objects, modelled after a typical mix of chat
+// traffic, through the conversion functions used when messages are received. tgchat.cpp is
+// compiled into the benchmark to reach its private conversion functions.
+
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "tgchat.cpp"
+
+// @note: all allocations in the process are counted, benchmarks run single-threaded
+static uint64_t s_AllocCount = 0;
+static volatile size_t s_Sink = 0;
+static const int64_t s_MinTimeNs = 500 * 1000 * 1000;
+static const int s_BatchSize = 1024;
+static const int64_t s_ChatId = -1001000000001;
+static const int64_t s_SelfUserId = 1000001;
+
+void* operator new(size_t p_Size)
+{
+  ++s_AllocCount;
+  void* ptr = malloc((p_Size > 0) ? p_Size : 1);
+  if (ptr == NULL) throw std::bad_alloc();
+
+  return ptr;
+}
+
+// @note: not inlined, as gcc otherwise flags free() of operator new memory in inlined make_shared
+__attribute__((noinline)) void operator delete(void* p_Ptr) noexcept
+{
+  free(p_Ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* p_Ptr, size_t) noexcept
+{
+  free(p_Ptr);
+}
+
+// anonymized corpus, texts keep length and script of typical messages but no content
+static const std::string& GetShortText()
+{
+  static const std::string str = "Aaaa, aaa aa aaaaa? Aa aaaa.";
+  return str;
+}
+
+static const std::string& GetLongText()
+{
+  static const std::string str =
+    "Aaaaaaaa aaa aaaaa aaaaaa aaaaa aaa aaaa aaaaa, aaa aaaaaaa aa aaaa aaa aaaaaaa aaa aaaa aaaaa "
+    "aaaa aaaaaa aaaaaa. Aaa aa aaaa aa aaaa aaa aaaaaaaaa, aaaaaaaaa aaa aaaaa aaaa aaaa.";
+  return str;
+}
+
+static const std::string& GetCyrillicText()
+{
+  static const std::string str = "Аааа, ааа ааааа? Ааааааа аа ааааааа, аааа аааааа.";
+  return str;
+}
+
+class TgChatBench
+{
+public:
+  static void Run(const std::string& p_Filter);
+
+private:
+  typedef td::td_api::object_ptr<td::td_api::message> MessagePtr;
+  typedef td::td_api::object_ptr<td::td_api::formattedText> FormattedTextPtr;
+
+  static FormattedTextPtr MakeFormattedText(const std::string& p_Text, bool p_Entities);
+  static td::td_api::object_ptr<td::td_api::file> MakeFile(int32_t p_Id, const std::string& p_LocalPath);
+  static MessagePtr MakeMessage(int p_Index);
+
+  template<typename TItem, typename TMake, typename TConvert>
+  static void Bench(const std::string& p_Filter, const std::string& p_Name, TMake p_Make, TConvert p_Convert);
+};
+
+TgChatBench::FormattedTextPtr TgChatBench::MakeFormattedText(const std::string& p_Text, bool p_Entities)
+{
+  FormattedTextPtr formattedText = td::td_api::make_object<td::td_api::formattedText>();
+  formattedText->text_ = p_Text;
+  if (p_Entities && (p_Text.size() >= 40))
+  {
+    // bold lead, italic word and a text url, offsets are in utf-16 code units of the ascii text
+    auto bold = td::td_api::make_object<td::td_api::textEntity>();
+    bold->offset_ = 0;
+    bold->length_ = 8;
+    bold->type_ = td::td_api::make_object<td::td_api::textEntityTypeBold>();
+    formattedText->entities_.push_back(std::move(bold));
+
+    auto italic = td::td_api::make_object<td::td_api::textEntity>();
+    italic->offset_ = 12;
+    italic->length_ = 6;
+    italic->type_ = td::td_api::make_object<td::td_api::textEntityTypeItalic>();
+    formattedText->entities_.push_back(std::move(italic));
+
+    auto textUrl = td::td_api::make_object<td::td_api::textEntity>();
+    textUrl->offset_ = 24;
+    textUrl->length_ = 10;
+    auto textUrlType = td::td_api::make_object<td::td_api::textEntityTypeTextUrl>();
+    textUrlType->url_ = "https://example.com/aaaa/bbbb";
+    textUrl->type_ = std::move(textUrlType);
+    formattedText->entities_.push_back(std::move(textUrl));
+  }
+
+  return formattedText;
+}
+
+td::td_api::object_ptr<td::td_api::file> TgChatBench::MakeFile(int32_t p_Id, const std::string& p_LocalPath)
+{
+  auto file = td::td_api::make_object<td::td_api::file>();
+  file->id_ = p_Id;
+  file->size_ = 245760;
+  file->local_ = td::td_api::make_object<td::td_api::localFile>();
+  file->local_->path_ = p_LocalPath;
+  file->remote_ = td::td_api::make_object<td::td_api::remoteFile>();
+  file->remote_->id_ = "AgACAgQAAxkBAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA";
+  return file;
+}
+
+TgChatBench::MessagePtr TgChatBench::MakeMessage(int p_Index)
+{
+  MessagePtr message = td::td_api::make_object<td::td_api::message>();
+  message->id_ = (int64_t)(1000 + (p_Index % s_BatchSize)) << 20;
+  message->chat_id_ = s_ChatId;
+  message->date_ = 1700000000 + p_Index;
+
+  const int kind = p_Index % 10;
+  const bool isOutgoing = (kind == 1) || (kind == 6);
+  message->is_outgoing_ = isOutgoing;
+  if (kind == 9)
+  {
+    auto senderChat = td::td_api::make_object<td::td_api::messageSenderChat>();
+    senderChat->chat_id_ = s_ChatId;
+    message->sender_id_ = std::move(senderChat);
+  }
+  else
+  {
+    auto senderUser = td::td_api::make_object<td::td_api::messageSenderUser>();
+    senderUser->user_id_ = isOutgoing ? s_SelfUserId : (2000000 + (p_Index % 7));
+    message->sender_id_ = std::move(senderUser);
+  }
+
+  switch (kind)
+  {
+    case 0:
+    case 1:
+    case 2:
+    {
+      auto messageText = td::td_api::make_object<td::td_api::messageText>();
+      messageText->text_ = MakeFormattedText((kind == 2) ? GetCyrillicText() : GetShortText(), false);
+      message->content_ = std::move(messageText);
+      break;
+    }
+
+    case 3:
+    case 9:
+    {
+      auto messageText = td::td_api::make_object<td::td_api::messageText>();
+      messageText->text_ = MakeFormattedText(GetLongText(), true);
+      message->content_ = std::move(messageText);
+      break;
+    }
+
+    case 4:
+    {
+      auto messageText = td::td_api::make_object<td::td_api::messageText>();
+      messageText->text_ = MakeFormattedText(GetShortText(), false);
+      message->content_ = std::move(messageText);
+      auto replyTo = td::td_api::make_object<td::td_api::messageReplyToMessage>();
+      replyTo->chat_id_ = s_ChatId;
+      replyTo->message_id_ = message->id_ - (1 << 20);
+      message->reply_to_ = std::move(replyTo);
+      break;
+    }
+
+    case 5:
+    case 6:
+    {
+      // photo not yet downloaded, with minithumbnail stored as preview
+      auto photo = td::td_api::make_object<td::td_api::photo>();
+      photo->minithumbnail_ = td::td_api::make_object<td::td_api::minithumbnail>();
+      photo->minithumbnail_->width_ = 40;
+      photo->minithumbnail_->height_ = 30;
+      photo->minithumbnail_->data_ = std::string(600, '\x55');
+      for (int size = 0; size < 3; ++size)
+      {
+        auto photoSize = td::td_api::make_object<td::td_api::photoSize>();
+        photoSize->type_ = (size == 0) ? "s" : ((size == 1) ? "m" : "x");
+        photoSize->photo_ = MakeFile(100 + size, "");
+        photoSize->width_ = 320 * (size + 1);
+        photoSize->height_ = 240 * (size + 1);
+        photo->sizes_.push_back(std::move(photoSize));
+      }
+
+      auto messagePhoto = td::td_api::make_object<td::td_api::messagePhoto>();
+      messagePhoto->photo_ = std::move(photo);
+      messagePhoto->caption_ = MakeFormattedText((kind == 5) ? GetShortText() : "", false);
+      message->content_ = std::move(messagePhoto);
+      break;
+    }
+
+    case 7:
+    {
+      auto document = td::td_api::make_object<td::td_api::document>();
+      document->file_name_ = "aaaaaaaa_aaaa.pdf";
+      document->mime_type_ = "application/pdf";
+      document->document_ = MakeFile(200, "/home/aaaa/.local/share/nchat/tgchat/documents/aaaaaaaa_aaaa.pdf");
+      auto messageDocument = td::td_api::make_object<td::td_api::messageDocument>();
+      messageDocument->document_ = std::move(document);
+      messageDocument->caption_ = MakeFormattedText("", false);
+      message->content_ = std::move(messageDocument);
+      break;
+    }
+
+    default:
+    {
+      auto messageAnimatedEmoji = td::td_api::make_object<td::td_api::messageAnimatedEmoji>();
+      messageAnimatedEmoji->emoji_ = "\xf0\x9f\x91\x8d";
+      message->content_ = std::move(messageAnimatedEmoji);
+      break;
+    }
+  }
+
+  return message;
+}
+
+// conversion moves data out of the td objects, so items are created in untimed batches
+template<typename TItem, typename TMake, typename TConvert>
+void TgChatBench::Bench(const std::string& p_Filter, const std::string& p_Name, TMake p_Make, TConvert p_Convert)
+{
+  if (!p_Filter.empty() && (p_Name.find(p_Filter) == std::string::npos)) return;
+
+  uint64_t count = 0;
+  uint64_t allocCount = 0;
+  int64_t elapsedNs = 0;
+  int index = 0;
+  bool warmup = true; // first batch initializes lazily created tables and caches
+  while (elapsedNs < s_MinTimeNs)
+  {
+    std::vector<TItem> items;
+    items.reserve(s_BatchSize);
+    for (int i = 0; i < s_BatchSize; ++i)
+    {
+      items.push_back(p_Make(index++));
+    }
+
+    const uint64_t allocCountStart = s_AllocCount;
+    const auto timeStart = std::chrono::steady_clock::now();
+    for (auto& item : items)
+    {
+      p_Convert(item);
+    }
+
+    const auto timeEnd = std::chrono::steady_clock::now();
+    if (warmup)
+    {
+      warmup = false;
+      continue;
+    }
+
+    allocCount += s_AllocCount - allocCountStart;
+    elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+    count += items.size();
+  }
+
+  const double msgsPerSec = (static_cast<double>(count) * 1000000000.0) / elapsedNs;
+  const double allocsPerMsg = static_cast<double>(allocCount) / count;
+  printf("%-36s %14.0f msgs/s %12.1f allocs/msg\n", p_Name.c_str(), msgsPerSec, allocsPerMsg);
+}
+
+void TgChatBench::Run(const std::string& p_Filter)
+{
+  TgChat::Impl impl;
+  impl.m_SelfUserId = s_SelfUserId;
+  impl.m_LastReadInboxMessage[s_ChatId] = (int64_t)(1000 + (s_BatchSize / 2)) << 20;
+  impl.m_LastReadOutboxMessage[s_ChatId] = (int64_t)(1000 + (s_BatchSize / 2)) << 20;
+
+  // @note: markdown settings are read once per process, messages without entities take the plain path
+  impl.m_Config.Set("markdown_enabled", "1");
+  impl.m_Config.Set("markdown_version", "2");
+
+  // *INDENT-OFF*
+  Bench<MessagePtr>(p_Filter, "TdMessageConvert", &TgChatBench::MakeMessage, [&](MessagePtr& p_Message)
+  {
+    ChatMessage chatMessage;
+    impl.TdMessageConvert(*p_Message, chatMessage);
+    s_Sink += chatMessage.text.size() + chatMessage.fileInfo.size();
+  });
+  Bench<MessagePtr>(p_Filter, "TdMessageContentConvert", &TgChatBench::MakeMessage, [&](MessagePtr& p_Message)
+  {
+    std::string text;
+    std::string fileInfo;
+    impl.TdMessageContentConvert(*p_Message->content_, 0, text, fileInfo);
+    s_Sink += text.size() + fileInfo.size();
+  });
+  Bench<FormattedTextPtr>(p_Filter, "GetText/plain", [](int) { return MakeFormattedText(GetLongText(), false); },
+                          [&](FormattedTextPtr& p_FormattedText)
+  {
+    s_Sink += impl.GetText(std::move(p_FormattedText)).size();
+  });
+  Bench<FormattedTextPtr>(p_Filter, "GetText/entities", [](int) { return MakeFormattedText(GetLongText(), true); },
+                          [&](FormattedTextPtr& p_FormattedText)
+  {
+    s_Sink += impl.GetText(std::move(p_FormattedText)).size();
+  });
+  // *INDENT-ON*
+}
+
+int main(int argc, char* argv[])
+{
+  setlocale(LC_ALL, "");
+  if (MB_CUR_MAX == 1)
+  {
+    setlocale(LC_ALL, "C.UTF-8");
+  }
+
+  const std::string filter = (argc > 1) ? argv[1] : "";
+  TgChatBench::Run(filter);
+  return 0;
+}
@@ -24,6 +24,10 @@ Ui::~Ui()
 {
 }
 
+void Ui::InitScreen()
+{
+}
+
 void Ui::Init()
 {
 }
@@ -445,6 +449,13 @@ void Ui::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
       }
       break;
 
+    case ReadOutboxNotifyType:
+      {
+        std::shared_ptr<ReadOutboxNotify> readOutboxNotify = std::static_pointer_cast<ReadOutboxNotify>(p_ServiceMessage);
+        std::cout << "Read outbox from " << readOutboxNotify->chatId << " up to msg " << readOutboxNotify->msgId << "\n";
+      }
+      break;
+
     case ConnectNotifyType:
       {
         std::shared_ptr<ConnectNotify> connectNotify = std::static_pointer_cast<ConnectNotify>(p_ServiceMessage);
@@ -25,6 +25,7 @@ public:
   Ui();
   virtual ~Ui();
 
+  void InitScreen();
   void Init();
   void Cleanup();
 
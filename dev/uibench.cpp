@@ -0,0 +1,308 @@
+// uibench.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// scripted input latency benchmark of the ui model on top of duchat load mode, see Usage() for options
+
+#include <algorithm>
+#include <atomic>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ncurses.h>
+
+#include "appconfig.h"
+#include "duchat.h"
+#include "emojilist.h"
+#include "fileutil.h"
+#include "log.h"
+#include "messagecache.h"
+#include "perfstats.h"
+#include "timeutil.h"
+#include "uicolorconfig.h"
+#include "uiconfig.h"
+#include "uikeyconfig.h"
+#include "uimodel.h"
+
+static const std::string s_ProfileId = "Dummy_uibench";
+static const int64_t s_ActionTimeoutUs = 10 * 1000 * 1000;
+static const int64_t s_LoadTimeoutUs = 30 * 1000 * 1000;
+
+struct Options
+{
+  int chats = 50;
+  int history = 1000;
+  int incomingRate = 10;
+  int typing = 500;
+  int switches = 100;
+  int pages = 100;
+  int frameRate = 60;
+  int pauseMs = 50;
+  bool verbose = false;
+  std::string dir = "/tmp/nchat-uibench";
+};
+
+static void PrintLatencies(const std::string& p_Name, std::vector<int64_t>& p_LatenciesUs)
+{
+  if (p_LatenciesUs.empty())
+  {
+    printf("%-22s no samples\n", p_Name.c_str());
+    return;
+  }
+
+  std::sort(p_LatenciesUs.begin(), p_LatenciesUs.end());
+  auto Percentile = [&](double p_Pct) -> double
+  {
+    const size_t idx = std::min(p_LatenciesUs.size() - 1, static_cast<size_t>(p_Pct * p_LatenciesUs.size()));
+    return p_LatenciesUs[idx] / 1000.0;
+  };
+
+  printf("%-22s n %7zu  p50 %9.2f ms  p99 %9.2f ms  max %9.2f ms\n", p_Name.c_str(), p_LatenciesUs.size(),
+         Percentile(0.50), Percentile(0.99), p_LatenciesUs.back() / 1000.0);
+}
+
+static int s_Timeouts = 0;
+static std::atomic<bool> s_Wakeup{ false }; // set on service messages, like the ui wakeup pipe
+
+// one iteration of the ui loop, Process() is run when Ui::Run() would be woken up, by a service
+// message or a due ui task, with the wait emulated by polling
+static void ProcessUi(UiModel& p_Model)
+{
+  if ((p_Model.GetKeyTimeout() == 0) || s_Wakeup.exchange(false))
+  {
+    p_Model.Process();
+  }
+  else
+  {
+    TimeUtil::Sleep(0.0001);
+  }
+}
+
+// returns input latency of the key action as recorded by the model once painted, or -1 if the key
+// started no measured action (e.g. page up at start of history) or timed out
+static int64_t PerformKey(UiModel& p_Model, int p_Key, PerfStats::Stat p_Stat, int p_PauseMs)
+{
+  // user think time before the key, otherwise each key would wait for the frame interval to pass
+  const int64_t pauseStartUs = PerfStats::GetTimeUSec();
+  while ((PerfStats::GetTimeUSec() - pauseStartUs) < (p_PauseMs * 1000))
+  {
+    ProcessUi(p_Model);
+  }
+
+  const int64_t startUs = PerfStats::GetTimeUSec();
+  p_Model.KeyHandler((wint_t)p_Key);
+  if (!p_Model.GetInputLatencyPending()) return -1;
+
+  p_Model.Process();
+  while (p_Model.GetInputLatencyPending())
+  {
+    if ((PerfStats::GetTimeUSec() - startUs) >= s_ActionTimeoutUs)
+    {
+      ++s_Timeouts;
+      return -1;
+    }
+
+    ProcessUi(p_Model);
+  }
+
+  return PerfStats::Get(p_Stat);
+}
+
+static void Usage()
+{
+  printf("usage: nchat_uibench [OPTION...]\n"
+         "    -c <N>     number of chats (default 50)\n"
+         "    -l <N>     messages of history per chat (default 1000)\n"
+         "    -i <N>     incoming messages per second (default 10)\n"
+         "    -t <N>     number of typed keys (default 500)\n"
+         "    -s <N>     number of chat switches (default 100)\n"
+         "    -p <N>     number of page ups (default 100)\n"
+         "    -f <N>     max frame rate, 0 to draw every frame (default 60)\n"
+         "    -k <MS>    pause before each key (default 50)\n"
+         "    -d <DIR>   working dir, removed on start (default /tmp/nchat-uibench)\n"
+         "    -v         enable debug logging to log.txt in working dir\n"
+         "    -h         show this help\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1) < argc;
+    if ((arg == "-c") && hasValue) options.chats = std::max(1, atoi(argv[++i]));
+    else if ((arg == "-l") && hasValue) options.history = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-i") && hasValue) options.incomingRate = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-t") && hasValue) options.typing = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-s") && hasValue) options.switches = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-p") && hasValue) options.pages = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-f") && hasValue) options.frameRate = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-k") && hasValue) options.pauseMs = std::max(0, atoi(argv[++i]));
+    else if ((arg == "-d") && hasValue) options.dir = argv[++i];
+    else if (arg == "-v") options.verbose = true;
+    else
+    {
+      Usage();
+      return (arg == "-h") ? 0 : 1;
+    }
+  }
+
+  FileUtil::RmDir(options.dir);
+  FileUtil::MkDir(options.dir);
+  FileUtil::SetApplicationDir(options.dir);
+  Log::SetVerboseLevel(options.verbose ? Log::DEBUG_LEVEL : Log::INFO_LEVEL);
+  Log::Init(options.dir + "/log.txt");
+  AppConfig::Init();
+  MessageCache::Init();
+  FileUtil::WriteFile(options.dir + "/ui.conf",
+                      "max_frame_rate=" + std::to_string(options.frameRate) + "\n"
+                      "desktop_notify_active=0\n"
+                      "desktop_notify_inactive=0\n"
+                      "terminal_bell_active=0\n"
+                      "terminal_bell_inactive=0\n");
+  UiConfig::Init();
+
+  // duchat load mode profile, no attachments as downloads are not part of the scenario
+  const std::string profilesDir = options.dir + "/profiles";
+  FileUtil::MkDir(profilesDir);
+  FileUtil::MkDir(profilesDir + "/" + s_ProfileId);
+  FileUtil::WriteFile(profilesDir + "/" + s_ProfileId + "/dummy.conf",
+                      "load_attachment_percent=0\n"
+                      "load_chats=" + std::to_string(options.chats) + "\n"
+                      "load_history=" + std::to_string(options.history) + "\n"
+                      "load_incoming_rate=" + std::to_string(options.incomingRate) + "\n");
+
+  // off-screen terminal of fixed size
+  setenv("LINES", "50", 0);
+  setenv("COLUMNS", "160", 0);
+  setlocale(LC_ALL, "");
+  const char* term = getenv("TERM");
+  FILE* outFile = fopen("/dev/null", "w");
+  FILE* inFile = fopen("/dev/null", "r");
+  SCREEN* screen = newterm((term != nullptr) ? term : "xterm", outFile, inFile);
+  if (screen == nullptr)
+  {
+    printf("failed to create terminal\n");
+    return 1;
+  }
+
+  EmojiList::Init();
+  UiKeyConfig::Init();
+  UiColorConfig::Init();
+
+  std::shared_ptr<UiModel> model = std::make_shared<UiModel>();
+  std::shared_ptr<DuChat> duChat = std::make_shared<DuChat>();
+  duChat->LoadProfile(profilesDir, s_ProfileId);
+  model->AddProtocol(duChat);
+
+  // *INDENT-OFF*
+  UiModel* uiModel = model.get();
+  const std::function<void(std::shared_ptr<ServiceMessage>)> messageHandler =
+    [uiModel](std::shared_ptr<ServiceMessage> p_ServiceMessage)
+  {
+    uiModel->MessageHandler(p_ServiceMessage);
+    s_Wakeup = true;
+  };
+  // *INDENT-ON*
+  MessageCache::SetMessageHandler(messageHandler);
+  duChat->SetMessageHandler(messageHandler);
+
+  model->Init();
+  duChat->Login();
+
+  // wait for chat list, the first chat switch then also sets the current chat
+  const int64_t loadStartUs = PerfStats::GetTimeUSec();
+  while ((model->GetChatVec().size() < (size_t)options.chats) &&
+         ((PerfStats::GetTimeUSec() - loadStartUs) < s_LoadTimeoutUs))
+  {
+    model->Process();
+    TimeUtil::Sleep(0.001);
+  }
+
+  printf("chats %zu history %d incoming %d/s frame rate %d pause %d ms\n", model->GetChatVec().size(),
+         options.history, options.incomingRate, options.frameRate, options.pauseMs);
+
+  const int keyNextChat = UiKeyConfig::GetKey("next_chat");
+  const int keyPrevPage = UiKeyConfig::GetKey("prev_page");
+  const int keyEnd = UiKeyConfig::GetKey("end");
+  const int keyBackspace = UiKeyConfig::GetKey("backspace");
+  // *INDENT-OFF*
+  auto AddSample = [](std::vector<int64_t>& p_Samples, int64_t p_LatencyUs)
+  {
+    if (p_LatencyUs < 0) return;
+
+    p_Samples.push_back(p_LatencyUs);
+  };
+  // *INDENT-ON*
+
+  // chat switch, each to a chat not visited since start until all have been
+  std::vector<int64_t> switchUs;
+  for (int i = 0; i < options.switches; ++i)
+  {
+    AddSample(switchUs, PerformKey(*model, keyNextChat, PerfStats::StatInputChatSwitchUs, options.pauseMs));
+  }
+
+  // typing in current chat, a line of text then erased, so the entry stays within one screen
+  static const std::string text = "the quick brown fox jumps over the lazy dog ";
+  std::vector<int64_t> typingUs;
+  for (int i = 0; i < options.typing; ++i)
+  {
+    const bool erase = ((i / (int)text.size()) % 2) == 1;
+    const int key = erase ? keyBackspace : (int)text.at(i % text.size());
+    AddSample(typingUs, PerformKey(*model, key, PerfStats::StatInputTypingUs, options.pauseMs));
+  }
+
+  // page up into history, returning to newest and the next chat every ten pages
+  std::vector<int64_t> pageUpUs;
+  for (int i = 0; i < options.pages; ++i)
+  {
+    if ((i > 0) && ((i % 10) == 0))
+    {
+      PerformKey(*model, keyEnd, PerfStats::StatInputPageUpUs, options.pauseMs);
+      PerformKey(*model, keyNextChat, PerfStats::StatInputChatSwitchUs, options.pauseMs);
+    }
+
+    AddSample(pageUpUs, PerformKey(*model, keyPrevPage, PerfStats::StatInputPageUpUs, options.pauseMs));
+  }
+
+  PrintLatencies("typing", typingUs);
+  PrintLatencies("chat switch", switchUs);
+  PrintLatencies("page up", pageUpUs);
+  if (s_Timeouts > 0)
+  {
+    printf("%-22s %d\n", "timeouts", s_Timeouts);
+  }
+
+  duChat->Logout();
+  // *INDENT-OFF*
+  MessageCache::SetMessageHandler([](std::shared_ptr<ServiceMessage>)
+  {
+  });
+  // *INDENT-ON*
+  model->Cleanup();
+  model.reset();
+  duChat->CloseProfile();
+  duChat.reset();
+  UiColorConfig::Cleanup();
+  UiKeyConfig::Cleanup();
+  EmojiList::Cleanup();
+  endwin();
+  delscreen(screen);
+  fclose(inFile);
+  fclose(outFile);
+  MessageCache::Cleanup();
+  UiConfig::Cleanup();
+  AppConfig::Cleanup();
+  Log::Cleanup();
+
+  return 0;
+}
@@ -0,0 +1,287 @@
+// wmbench.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+// whatsapp message conversion benchmarks, usage: nchat_wmbench [filter]
+//
+// replays an anonymized corpus of message payloads, modelled after a typical mix of chat traffic,
+// through the cgo callbacks used when messages are received, both per message and packed in
+// history sync batches. wmchat.cpp is compiled into the benchmark to reach its notify queue.
+
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "wmchat.cpp"
+
+// @note: all allocations in the process are counted, benchmarks run single-threaded
+static uint64_t s_AllocCount = 0;
+static const int64_t s_MinTimeNs = 500 * 1000 * 1000;
+static const int s_ConnId = 0;
+static const int s_CorpusSize = 1000;
+static const int s_PackedBatchSize = 100;
+
+void* operator new(size_t p_Size)
+{
+  ++s_AllocCount;
+  void* ptr = malloc((p_Size > 0) ? p_Size : 1);
+  if (ptr == NULL) throw std::bad_alloc();
+
+  return ptr;
+}
+
+// @note: not inlined, as gcc otherwise flags free() of operator new memory in inlined make_shared
+__attribute__((noinline)) void operator delete(void* p_Ptr) noexcept
+{
+  free(p_Ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* p_Ptr, size_t) noexcept
+{
+  free(p_Ptr);
+}
+
+class WmChatBench
+{
+public:
+  static void Run(const std::string& p_Filter);
+
+private:
+  struct Payload
+  {
+    std::string msgId;
+    std::string senderId;
+    std::string text;
+    int fromMe = 0;
+    std::string quotedId;
+    std::string fileId;
+    std::string filePath;
+    int fileStatus = 0;
+    int timeSent = 0;
+    int isRead = 0;
+  };
+
+  struct PackedBatch
+  {
+    std::string buf;
+    int count = 0;
+  };
+
+  static std::vector<Payload> MakeCorpus();
+  static PackedBatch Pack(const std::vector<Payload>& p_Payloads, size_t p_Begin, size_t p_End);
+  static void AppendInt(std::string& p_Buf, int p_Value);
+  static void AppendString(std::string& p_Buf, const std::string& p_Value);
+  static WmString ToWmString(const std::string& p_Str);
+
+  template<typename TFunc>
+  static void Bench(const std::string& p_Filter, const std::string& p_Name, WmChat& p_WmChat, TFunc p_Func);
+};
+
+// anonymized corpus, texts keep length and script of typical messages but no content
+std::vector<WmChatBench::Payload> WmChatBench::MakeCorpus()
+{
+  static const std::string shortText = "Aaaa, aaa aa aaaaa? Aa aaaa.";
+  static const std::string longText =
+    "Aaaaaaaa aaa aaaaa aaaaaa aaaaa aaa aaaa aaaaa, aaa aaaaaaa aa aaaa aaa aaaaaaa aaa aaaa aaaaa "
+    "aaaa aaaaaa aaaaaa. Aaa aa aaaa aa aaaa aaa aaaaaaaaa, aaaaaaaaa aaa aaaaa aaaa aaaa.";
+  static const std::string cyrillicText = "Аааа, ааа ааааа? Ааааааа аа ааааааа, аааа аааааа.";
+
+  std::vector<Payload> payloads;
+  for (int i = 0; i < s_CorpusSize; ++i)
+  {
+    const int kind = i % 10;
+    Payload payload;
+    payload.msgId = "3EB0" + StrUtil::NumToHex((int64_t)(0x10000000000 + i));
+    payload.fromMe = ((kind == 1) || (kind == 6)) ? 1 : 0;
+    payload.senderId = payload.fromMe ? "46700000000@s.whatsapp.net"
+                                      : ("4670000000" + std::to_string(1 + (i % 7)) + "@s.whatsapp.net");
+    payload.timeSent = 1700000000 + i;
+    payload.isRead = (i < (s_CorpusSize / 2)) ? 1 : 0;
+    switch (kind)
+    {
+      case 2:
+        payload.text = cyrillicText;
+        break;
+
+      case 3:
+      case 9:
+        payload.text = longText;
+        break;
+
+      case 4:
+        payload.text = shortText;
+        payload.quotedId = "3EB0" + StrUtil::NumToHex((int64_t)(0x10000000000 + i - 1));
+        break;
+
+      case 5:
+      case 6:
+      case 7:
+        // attachment, file id holds media keys and urls needed for download
+        payload.text = (kind == 5) ? shortText : "";
+        payload.fileId = "url=https://mmg.whatsapp.net/v/t62.7118-24/00000000_0000000000000000_000000000000000000_n"
+          ".enc?ccb=11-4&oh=01_AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA&oe=00000000&_nc_sid=000000;"
+          "mime_type=image/jpeg;file_length=245760;media_key=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=;"
+          "file_sha256=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=;file_enc_sha256=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+          "AAAAAAA=;direct_path=/v/t62.7118-24/00000000_0000000000000000_000000000000000000_n.enc";
+        payload.filePath = (kind == 7) ? "/home/aaaa/.local/share/nchat/wmchat/aaaaaaaa_aaaa.pdf" : "[Photo]";
+        payload.fileStatus = (kind == 7) ? FileStatusDownloaded : FileStatusNotDownloaded;
+        break;
+
+      default:
+        payload.text = shortText;
+        break;
+    }
+
+    payloads.push_back(std::move(payload));
+  }
+
+  return payloads;
+}
+
+// packed little-endian fields, keep in sync with PackedBatch in gowm.go
+void WmChatBench::AppendInt(std::string& p_Buf, int p_Value)
+{
+  const uint32_t value = (uint32_t)(int32_t)p_Value;
+  p_Buf.push_back((char)(value & 0xff));
+  p_Buf.push_back((char)((value >> 8) & 0xff));
+  p_Buf.push_back((char)((value >> 16) & 0xff));
+  p_Buf.push_back((char)((value >> 24) & 0xff));
+}
+
+void WmChatBench::AppendString(std::string& p_Buf, const std::string& p_Value)
+{
+  AppendInt(p_Buf, (int)p_Value.size());
+  p_Buf += p_Value;
+}
+
+WmChatBench::PackedBatch WmChatBench::Pack(const std::vector<Payload>& p_Payloads, size_t p_Begin, size_t p_End)
+{
+  PackedBatch batch;
+  for (size_t i = p_Begin; i < p_End; ++i)
+  {
+    const Payload& payload = p_Payloads.at(i);
+    AppendString(batch.buf, payload.msgId);
+    AppendString(batch.buf, payload.senderId);
+    AppendString(batch.buf, payload.text);
+    AppendInt(batch.buf, payload.fromMe);
+    AppendString(batch.buf, payload.quotedId);
+    AppendString(batch.buf, payload.fileId);
+    AppendString(batch.buf, payload.filePath);
+    AppendInt(batch.buf, payload.fileStatus);
+    AppendInt(batch.buf, payload.timeSent);
+    AppendInt(batch.buf, payload.isRead);
+    ++batch.count;
+  }
+
+  return batch;
+}
+
+WmString WmChatBench::ToWmString(const std::string& p_Str)
+{
+  WmString str;
+  str.p = p_Str.c_str();
+  str.n = (ptrdiff_t)p_Str.size();
+  return str;
+}
+
+// func performs one pass over the corpus and returns the number of messages, notifies queued by
+// it are released untimed, as they are otherwise consumed by the notify thread
+template<typename TFunc>
+void WmChatBench::Bench(const std::string& p_Filter, const std::string& p_Name, WmChat& p_WmChat, TFunc p_Func)
+{
+  if (!p_Filter.empty() && (p_Name.find(p_Filter) == std::string::npos)) return;
+
+  uint64_t count = 0;
+  uint64_t allocCount = 0;
+  int64_t elapsedNs = 0;
+  bool warmup = true; // first pass initializes lazily created tables and caches
+  while (elapsedNs < s_MinTimeNs)
+  {
+    const uint64_t allocCountStart = s_AllocCount;
+    const auto timeStart = std::chrono::steady_clock::now();
+    const int messages = p_Func();
+    const auto timeEnd = std::chrono::steady_clock::now();
+    const uint64_t allocCountEnd = s_AllocCount;
+
+    {
+      std::unique_lock<std::mutex> lock(p_WmChat.m_NotifyMutex);
+      p_WmChat.m_NotifyQueue.clear();
+    }
+
+    if (warmup)
+    {
+      warmup = false;
+      continue;
+    }
+
+    allocCount += allocCountEnd - allocCountStart;
+    elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+    count += messages;
+  }
+
+  const double msgsPerSec = (static_cast<double>(count) * 1000000000.0) / elapsedNs;
+  const double allocsPerMsg = static_cast<double>(allocCount) / count;
+  printf("%-36s %14.0f msgs/s %12.1f allocs/msg\n", p_Name.c_str(), msgsPerSec, allocsPerMsg);
+}
+
+void WmChatBench::Run(const std::string& p_Filter)
+{
+  const std::vector<Payload> payloads = MakeCorpus();
+  std::vector<PackedBatch> batches;
+  for (size_t begin = 0; begin < payloads.size(); begin += s_PackedBatchSize)
+  {
+    batches.push_back(Pack(payloads, begin, std::min(begin + s_PackedBatchSize, payloads.size())));
+  }
+
+  const std::string chatId = "120363000000000001@g.us";
+  WmChat wmChat;
+  WmChat::AddInstance(s_ConnId, &wmChat);
+
+  // *INDENT-OFF*
+  Bench(p_Filter, "WmNewMessagesNotify", wmChat, [&]()
+  {
+    for (const auto& payload : payloads)
+    {
+      WmNewMessagesNotify(s_ConnId, ToWmString(chatId), ToWmString(payload.msgId), ToWmString(payload.senderId),
+                          ToWmString(payload.text), payload.fromMe, ToWmString(payload.quotedId),
+                          ToWmString(payload.fileId), ToWmString(payload.filePath), payload.fileStatus,
+                          payload.timeSent, payload.isRead);
+    }
+
+    return (int)payloads.size();
+  });
+  Bench(p_Filter, "WmNewMessagesBatchNotify", wmChat, [&]()
+  {
+    int count = 0;
+    for (auto& batch : batches)
+    {
+      WmNewMessagesBatchNotify(s_ConnId, ToWmString(chatId), &batch.buf[0], (int)batch.buf.size(), batch.count);
+      count += batch.count;
+    }
+
+    return count;
+  });
+  // *INDENT-ON*
+
+  WmChat::RemoveInstance(s_ConnId);
+}
+
+int main(int argc, char* argv[])
+{
+  setlocale(LC_ALL, "");
+  if (MB_CUR_MAX == 1)
+  {
+    setlocale(LC_ALL, "C.UTF-8");
+  }
+
+  const std::string filter = (argc > 1) ? argv[1] : "";
+  WmChatBench::Run(filter);
+  return 0;
+}
@@ -7,12 +7,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+class RequestHandle;
 class RequestMessage;
 class ServiceMessage;
 
@@ -24,6 +28,7 @@ enum ProtocolFeature
   FeatureTypingTimeout = (1 << 1),
   FeatureEditMessagesWithinTwoDays = (1 << 2),
   FeatureEditMessagesWithinFifteenMins = (1 << 3),
+  FeatureServerSearch = (1 << 4),
 };
 
 class Protocol
@@ -50,6 +55,46 @@ public:
 
   virtual void SendRequest(std::shared_ptr<RequestMessage> p_Request) = 0;
   virtual void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler) = 0;
+
+  // sends a request with a completion and cancel handle. replies stay on the notify stream, carrying
+  // the request id if the protocol echoes it. a cancelled request is skipped if not yet performed.
+  std::shared_ptr<RequestHandle> SendAsyncRequest(std::shared_ptr<RequestMessage> p_Request);
+};
+
+// Tracked request handle, shared by sender and protocol
+class RequestHandle
+{
+public:
+  RequestHandle()
+    : m_RequestId(NextRequestId())
+    , m_SendTime(std::chrono::steady_clock::now())
+  {
+  }
+
+  int64_t GetRequestId() const { return m_RequestId; }
+  int64_t GetElapsedUSec() const
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 m_SendTime).count();
+  }
+
+  void Cancel() { m_Cancelled = true; }
+  bool IsCancelled() const { return m_Cancelled; }
+  void Complete() { m_Completed = true; }
+  bool IsCompleted() const { return m_Completed; }
+
+private:
+  static int64_t NextRequestId()
+  {
+    static std::atomic<int64_t> s_NextRequestId(1);
+    return s_NextRequestId++;
+  }
+
+private:
+  const int64_t m_RequestId;
+  const std::chrono::steady_clock::time_point m_SendTime;
+  std::atomic<bool> m_Cancelled{ false };
+  std::atomic<bool> m_Completed{ false };
 };
 
 // Request and notify message types
@@ -92,8 +137,18 @@ enum MessageType
   ReceiveStatusNotifyType,
   NewMessageStatusNotifyType,
   NewMessageFileNotifyType,
+  NewMessageFileProgressNotifyType,
   DeleteChatNotifyType,
   UpdateMuteNotifyType,
+  SearchMessagesNotifyType,
+  // types below are appended to keep values of recorded service messages stable
+  MarkMessagesReadRequestType,
+  MarkMessagesReadNotifyType,
+  DeleteMessagesNotifyType,
+  SearchMessagesRequestType,
+  ReadOutboxNotifyType,
+  ReconnectRequestType,
+  ChatUnreadNotifyType,
 };
 
 struct ContactInfo
@@ -113,6 +168,15 @@ struct ChatInfo
   int64_t lastMessageTime = -1;
 };
 
+struct ChatUnreadInfo
+{
+  std::string id;
+  int64_t lastMessageTime = -1;
+  int32_t unreadCount = 0; // incoming unread messages, capped
+  bool isUnread = false; // newest message is incoming and unread
+  bool hasUnreadMention = false;
+};
+
 enum FileStatus
 {
   FileStatusNone = -1,
@@ -141,9 +205,10 @@ struct ChatMessage
   std::string fileInfo;
   std::string link; // tgchat sponsored msg only, not db cached
   int64_t timeSent = -1;
+  int64_t sequence = 0; // orders messages with equal timeSent, higher is newer
   bool isOutgoing = true;
   bool isRead = false;
-  bool hasMention = false; // tgchat only, not db cached
+  bool hasMention = false; // tgchat only, db cached for unread counts only
 };
 
 enum DownloadFileAction
@@ -153,12 +218,23 @@ enum DownloadFileAction
   DownloadFileActionSave = 2,
 };
 
+enum DownloadFilePriority
+{
+  DownloadFilePriorityPrefetch = 0,
+  DownloadFilePriorityVisible = 1,
+  DownloadFilePriorityUser = 2,
+  DownloadFilePriorityCount,
+};
+
 // Request messages
 class RequestMessage
 {
 public:
   virtual ~RequestMessage() { }
   virtual MessageType GetMessageType() const { return RequestMessageType; }
+  bool IsCancelled() const { return handle && handle->IsCancelled(); }
+  int64_t requestId = 0; // echoed in replies, 0 if untracked
+  std::shared_ptr<RequestHandle> handle; // set by sender for tracked requests, never sent over the core link
 };
 
 class GetContactsRequest : public RequestMessage
@@ -224,6 +300,15 @@ public:
   std::string msgId;
 };
 
+class MarkMessagesReadRequest : public RequestMessage
+{
+public:
+  virtual MessageType GetMessageType() const { return MarkMessagesReadRequestType; }
+  std::string chatId;
+  std::string msgId; // newest message read, older messages in chat are implied read
+  std::vector<std::string> msgIds; // unread messages up to and including msgId
+};
+
 class DeleteMessageRequest : public RequestMessage
 {
 public:
@@ -292,6 +377,7 @@ public:
   std::string msgId;
   std::string fileId;
   DownloadFileAction downloadFileAction = DownloadFileActionNone;
+  DownloadFilePriority downloadFilePriority = DownloadFilePriorityUser;
 };
 
 class DeferDownloadFileRequest : public RequestMessage
@@ -303,6 +389,7 @@ public:
   std::string fileId;
   std::string downloadId;
   DownloadFileAction downloadFileAction = DownloadFileActionNone;
+  DownloadFilePriority downloadFilePriority = DownloadFilePriorityUser;
 };
 
 class SetCurrentChatRequest : public RequestMessage
@@ -319,6 +406,21 @@ public:
   std::string chatId;
 };
 
+class SearchMessagesRequest : public RequestMessage
+{
+public:
+  virtual MessageType GetMessageType() const { return SearchMessagesRequestType; }
+  std::string query;
+  int limit = 0; // total over all result pages
+};
+
+// drops and reopens connections, e.g. after system resume when they are likely stale
+class ReconnectRequest : public RequestMessage
+{
+public:
+  virtual MessageType GetMessageType() const { return ReconnectRequestType; }
+};
+
 // Service messages
 class ServiceMessage
 {
@@ -328,6 +430,7 @@ public:
   virtual ~ServiceMessage() { }
   virtual MessageType GetMessageType() const { return ServiceMessageType; }
   std::string profileId;
+  int64_t requestId = 0; // id of request replied to, 0 if unsolicited or not echoed by protocol
 };
 
 class NewContactsNotify : public ServiceMessage
@@ -361,6 +464,7 @@ public:
   std::string fromMsgId;
   bool cached = false;
   bool sequence = false;
+  bool more = false; // further chunks of the same reply follow, newest messages are sent first
 };
 
 class SendMessageNotify : public ServiceMessage
@@ -394,6 +498,18 @@ public:
   std::string msgId;
 };
 
+class MarkMessagesReadNotify : public ServiceMessage
+{
+public:
+  explicit MarkMessagesReadNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return MarkMessagesReadNotifyType; }
+  bool success;
+  std::string chatId;
+  std::string msgId;
+  std::vector<std::string> msgIds;
+};
+
 class DeleteMessageNotify : public ServiceMessage
 {
 public:
@@ -405,6 +521,18 @@ public:
   std::string msgId;
 };
 
+// deletion of multiple messages in a chat, reported as one event
+class DeleteMessagesNotify : public ServiceMessage
+{
+public:
+  explicit DeleteMessagesNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return DeleteMessagesNotifyType; }
+  bool success;
+  std::string chatId;
+  std::vector<std::string> msgIds;
+};
+
 class SendTypingNotify : public ServiceMessage
 {
 public:
@@ -477,6 +605,17 @@ public:
   bool isRead = false;
 };
 
+// outgoing messages up to and including msgId (by time sent) have been read by the recipient
+class ReadOutboxNotify : public ServiceMessage
+{
+public:
+  explicit ReadOutboxNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return ReadOutboxNotifyType; }
+  std::string chatId;
+  std::string msgId;
+};
+
 class NewMessageFileNotify : public ServiceMessage
 {
 public:
@@ -489,6 +628,18 @@ public:
   DownloadFileAction downloadFileAction;
 };
 
+class NewMessageFileProgressNotify : public ServiceMessage
+{
+public:
+  explicit NewMessageFileProgressNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return NewMessageFileProgressNotifyType; }
+  std::string chatId;
+  std::string msgId;
+  int64_t downloadedBytes = 0;
+  int64_t totalBytes = -1; // -1 if unknown
+};
+
 class DeleteChatNotify : public ServiceMessage
 {
 public:
@@ -509,3 +660,33 @@ public:
   std::string chatId;
   bool isMuted;
 };
+
+class SearchMessagesNotify : public ServiceMessage
+{
+public:
+  explicit SearchMessagesNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return SearchMessagesNotifyType; }
+  bool success;
+  std::string query;
+  std::vector<std::pair<std::string, ChatMessage>> chatMessages; // chat id and message, best match first
+  bool isServer = false; // server result page, follows earlier pages of same query
+};
+
+class ChatUnreadNotify : public ServiceMessage
+{
+public:
+  explicit ChatUnreadNotify(const std::string& p_ProfileId) :
+    ServiceMessage(p_ProfileId) { }
+  virtual MessageType GetMessageType() const { return ChatUnreadNotifyType; }
+  std::vector<ChatUnreadInfo> chatUnreadInfos;
+};
+
+inline std::shared_ptr<RequestHandle> Protocol::SendAsyncRequest(std::shared_ptr<RequestMessage> p_Request)
+{
+  std::shared_ptr<RequestHandle> handle = std::make_shared<RequestHandle>();
+  p_Request->requestId = handle->GetRequestId();
+  p_Request->handle = handle;
+  SendRequest(p_Request);
+  return handle;
+}
@@ -10,12 +10,19 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <unordered_set>
 
 #include <sys/stat.h>
 
+#include "fileutil.h"
 #include "log.h"
+#include "messagecache.h"
+#include "objectpool.h"
+#include "protocolutil.h"
 #include "status.h"
 #include "strutil.h"
+#include "threadregistry.h"
+#include "timeutil.h"
 
 extern "C" DuChat* CreateDuChat()
 {
@@ -58,23 +65,51 @@ bool DuChat::SetupProfile(const std::string& p_ProfilesDir, std::string& p_Profi
   mkdir(profileDir.c_str(), 0777);
 
   p_ProfileId = m_ProfileId;
+  m_ProfileDir = profileDir;
+  Init();
 
   return true;
 }
 
 bool DuChat::LoadProfile(const std::string& p_ProfilesDir, const std::string& p_ProfileId)
 {
-  (void)p_ProfilesDir;
   m_ProfileId = p_ProfileId;
+  m_ProfileDir = p_ProfilesDir + "/" + p_ProfileId;
+  Init();
+
+  if (m_LoadMode)
+  {
+    MessageCache::AddProfile(m_ProfileId, false, 0, false);
+  }
+
   return true;
 }
 
 bool DuChat::CloseProfile()
 {
+  m_Config.Save();
   m_ProfileId = "";
+  m_ProfileDir = "";
   return true;
 }
 
+void DuChat::Init()
+{
+  const std::map<std::string, std::string> defaultConfig =
+  {
+    { "load_attachment_percent", "10" },
+    { "load_chats", "0" },
+    { "load_churn_rate", "5" },
+    { "load_group_chats", "2" },
+    { "load_group_members", "200" },
+    { "load_history", "1000" },
+    { "load_incoming_rate", "10" },
+  };
+  const std::string configPath(m_ProfileDir + std::string("/dummy.conf"));
+  m_Config = Config(configPath, defaultConfig);
+  m_LoadMode = (StrUtil::ToInteger(m_Config.Get("load_chats")) > 0);
+}
+
 bool DuChat::Login()
 {
   Status::Set(Status::FlagOnline);
@@ -89,7 +124,7 @@ bool DuChat::Login()
     connectNotify->success = true;
 
     std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-      std::make_shared<DeferNotifyRequest>();
+      ObjectPool::MakeShared<DeferNotifyRequest>();
     deferNotifyRequest->serviceMessage = connectNotify;
     SendRequest(deferNotifyRequest);
   }
@@ -116,15 +151,29 @@ bool DuChat::Logout()
 
 void DuChat::Process()
 {
+  ThreadRegistry::Register("du-request");
+
   while (m_Running)
   {
     std::shared_ptr<RequestMessage> requestMessage;
 
     {
       std::unique_lock<std::mutex> lock(m_ProcessMutex);
-      while (m_RequestsQueue.empty() && m_Running)
+      if (m_LoadMode && !m_LoadChats.empty())
+      {
+        // wake up for requests and for the next due synthetic event
+        const std::chrono::steady_clock::time_point loadTime = std::min(m_LoadMessageTime, m_LoadChurnTime);
+        while (m_RequestsQueue.empty() && m_Running && (std::chrono::steady_clock::now() < loadTime))
+        {
+          m_ProcessCondVar.wait_until(lock, loadTime);
+        }
+      }
+      else
       {
-        m_ProcessCondVar.wait(lock);
+        while (m_RequestsQueue.empty() && m_Running)
+        {
+          m_ProcessCondVar.wait(lock);
+        }
       }
 
       if (!m_Running)
@@ -132,11 +181,21 @@ void DuChat::Process()
         break;
       }
 
-      requestMessage = m_RequestsQueue.front();
-      m_RequestsQueue.pop_front();
+      if (!m_RequestsQueue.empty())
+      {
+        requestMessage = m_RequestsQueue.front();
+        m_RequestsQueue.pop_front();
+      }
     }
 
-    PerformRequest(requestMessage);
+    if (requestMessage)
+    {
+      PerformRequest(requestMessage);
+    }
+    else
+    {
+      PerformLoadEvents();
+    }
   }
 }
 
@@ -157,14 +216,24 @@ void DuChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 {
   if (!m_MessageHandler) return;
 
+  if (p_RequestMessage->IsCancelled())
+  {
+    LOG_DEBUG("skip cancelled request %d", p_RequestMessage->GetMessageType());
+    return;
+  }
+
+  if (m_LoadMode)
+  {
+    PerformLoadRequest(p_RequestMessage);
+    return;
+  }
+
   static std::map<std::string, std::vector<ChatMessage>> s_Messages;
 
   switch (p_RequestMessage->GetMessageType())
   {
     case GetChatsRequestType:
       {
-        std::shared_ptr<GetChatsRequest> getChatsRequest =
-          std::static_pointer_cast<GetChatsRequest>(p_RequestMessage);
         std::shared_ptr<NewChatsNotify> newChatsNotify =
           std::make_shared<NewChatsNotify>(m_ProfileId);
         std::shared_ptr<NewContactsNotify> newContactsNotify =
@@ -339,38 +408,36 @@ void DuChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 
     case GetMessagesRequestType:
       {
-        std::shared_ptr<GetMessagesRequest> getMessagesRequest =
-          std::static_pointer_cast<GetMessagesRequest>(p_RequestMessage);
+        const GetMessagesRequest& getMessagesRequest = static_cast<const GetMessagesRequest&>(*p_RequestMessage);
         std::shared_ptr<NewMessagesNotify> newMessagesNotify =
           std::make_shared<NewMessagesNotify>(m_ProfileId);
         newMessagesNotify->success = true;
-        newMessagesNotify->chatId = getMessagesRequest->chatId;
+        newMessagesNotify->requestId = getMessagesRequest.requestId;
+        newMessagesNotify->chatId = getMessagesRequest.chatId;
         newMessagesNotify->cached = false;
         newMessagesNotify->sequence = true;
 
-        newMessagesNotify->chatMessages = s_Messages[getMessagesRequest->chatId];
+        newMessagesNotify->chatMessages = s_Messages[getMessagesRequest.chatId];
         m_MessageHandler(newMessagesNotify);
       }
       break;
 
     case SendMessageRequestType:
       {
-        std::shared_ptr<SendMessageRequest> sendMessageRequest =
-          std::static_pointer_cast<SendMessageRequest>(p_RequestMessage);
+        const SendMessageRequest& sendMessageRequest = static_cast<const SendMessageRequest&>(*p_RequestMessage);
         std::shared_ptr<SendMessageNotify> sendMessageNotify =
           std::make_shared<SendMessageNotify>(m_ProfileId);
         sendMessageNotify->success = true;
-        sendMessageNotify->chatId = sendMessageRequest->chatId;
-        sendMessageNotify->chatMessage = sendMessageRequest->chatMessage;
+        sendMessageNotify->chatId = sendMessageRequest.chatId;
+        sendMessageNotify->chatMessage = sendMessageRequest.chatMessage;
         m_MessageHandler(sendMessageNotify);
       }
       break;
 
     case DeferNotifyRequestType:
       {
-        std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-          std::static_pointer_cast<DeferNotifyRequest>(p_RequestMessage);
-        m_MessageHandler(deferNotifyRequest->serviceMessage);
+        const DeferNotifyRequest& deferNotifyRequest = static_cast<const DeferNotifyRequest&>(*p_RequestMessage);
+        m_MessageHandler(deferNotifyRequest.serviceMessage);
       }
       break;
 
@@ -379,3 +446,461 @@ void DuChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
       break;
   }
 }
+
+void DuChat::PerformLoadRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  switch (p_RequestMessage->GetMessageType())
+  {
+    case GetContactsRequestType:
+      {
+        InitLoad();
+        std::shared_ptr<NewContactsNotify> newContactsNotify =
+          std::make_shared<NewContactsNotify>(m_ProfileId);
+        newContactsNotify->contactInfos = m_LoadContacts;
+        CallMessageHandler(newContactsNotify);
+      }
+      break;
+
+    case GetChatsRequestType:
+      {
+        InitLoad();
+        std::shared_ptr<NewChatsNotify> newChatsNotify =
+          std::make_shared<NewChatsNotify>(m_ProfileId);
+        newChatsNotify->success = true;
+        for (const auto& loadChat : m_LoadChats)
+        {
+          ChatInfo chatInfo;
+          chatInfo.id = loadChat.id;
+          chatInfo.lastMessageTime = loadChat.messages.empty() ? 0 : loadChat.messages.front().timeSent;
+          chatInfo.isUnread = !loadChat.messages.empty() && !loadChat.messages.front().isRead;
+          newChatsNotify->chatInfos.push_back(chatInfo);
+        }
+
+        std::shared_ptr<NewContactsNotify> newContactsNotify =
+          std::make_shared<NewContactsNotify>(m_ProfileId);
+        newContactsNotify->contactInfos = m_LoadContacts;
+
+        CallMessageHandler(newChatsNotify);
+        CallMessageHandler(newContactsNotify);
+      }
+      break;
+
+    case GetMessageRequestType:
+      {
+        const GetMessageRequest& getMessageRequest = static_cast<const GetMessageRequest&>(*p_RequestMessage);
+        auto chatIt = m_LoadChatIndex.find(getMessageRequest.chatId);
+        if (chatIt == m_LoadChatIndex.end()) break;
+
+        const std::vector<ChatMessage>& messages = m_LoadChats[chatIt->second].messages;
+        // *INDENT-OFF*
+        auto msgIt = std::find_if(messages.begin(), messages.end(), [&](const ChatMessage& p_ChatMessage)
+        {
+          return p_ChatMessage.id == getMessageRequest.msgId;
+        });
+        // *INDENT-ON*
+        if (msgIt == messages.end()) break;
+
+        std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+          std::make_shared<NewMessagesNotify>(m_ProfileId);
+        newMessagesNotify->success = true;
+        newMessagesNotify->chatId = getMessageRequest.chatId;
+        newMessagesNotify->chatMessages.push_back(*msgIt);
+        newMessagesNotify->cached = false;
+        newMessagesNotify->sequence = false;
+        CallMessageHandler(newMessagesNotify);
+      }
+      break;
+
+    case GetMessagesRequestType:
+      {
+        const GetMessagesRequest& getMessagesRequest = static_cast<const GetMessagesRequest&>(*p_RequestMessage);
+        auto chatIt = m_LoadChatIndex.find(getMessagesRequest.chatId);
+        if (chatIt == m_LoadChatIndex.end()) break;
+
+        // page of messages older than fromMsgId, or newest if not set
+        const std::vector<ChatMessage>& messages = m_LoadChats[chatIt->second].messages;
+        auto fromIt = messages.begin();
+        if (!getMessagesRequest.fromMsgId.empty())
+        {
+          // *INDENT-OFF*
+          fromIt = std::find_if(messages.begin(), messages.end(), [&](const ChatMessage& p_ChatMessage)
+          {
+            return p_ChatMessage.id == getMessagesRequest.fromMsgId;
+          });
+          // *INDENT-ON*
+          if (fromIt != messages.end())
+          {
+            ++fromIt;
+          }
+        }
+
+        const size_t limit = (size_t)std::max(getMessagesRequest.limit, 1);
+        const auto toIt = fromIt + std::min(limit, (size_t)std::distance(fromIt, messages.end()));
+
+        std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+          std::make_shared<NewMessagesNotify>(m_ProfileId);
+        newMessagesNotify->success = true;
+        newMessagesNotify->requestId = getMessagesRequest.requestId;
+        newMessagesNotify->chatId = getMessagesRequest.chatId;
+        newMessagesNotify->fromMsgId = getMessagesRequest.fromMsgId;
+        newMessagesNotify->chatMessages.assign(fromIt, toIt);
+        newMessagesNotify->cached = false;
+        newMessagesNotify->sequence = true;
+        for (const auto& chunk : ProtocolUtil::SplitMessagesNotify(newMessagesNotify))
+        {
+          CallMessageHandler(chunk);
+        }
+      }
+      break;
+
+    case SendMessageRequestType:
+      {
+        const SendMessageRequest& sendMessageRequest = static_cast<const SendMessageRequest&>(*p_RequestMessage);
+        auto chatIt = m_LoadChatIndex.find(sendMessageRequest.chatId);
+
+        std::shared_ptr<SendMessageNotify> sendMessageNotify =
+          std::make_shared<SendMessageNotify>(m_ProfileId);
+        sendMessageNotify->success = (chatIt != m_LoadChatIndex.end());
+        sendMessageNotify->chatId = sendMessageRequest.chatId;
+        sendMessageNotify->chatMessage = sendMessageRequest.chatMessage;
+        CallMessageHandler(sendMessageNotify);
+        if (!sendMessageNotify->success) break;
+
+        LoadChat& loadChat = m_LoadChats[chatIt->second];
+        ChatMessage chatMessage = sendMessageRequest.chatMessage;
+        chatMessage.id = loadChat.id + "_" + std::to_string(m_LoadMsgCount++);
+        chatMessage.senderId = m_LoadContacts.front().id;
+        chatMessage.timeSent = TimeUtil::GetCurrentTimeMSec();
+        chatMessage.isOutgoing = true;
+        chatMessage.isRead = true;
+        loadChat.messages.insert(loadChat.messages.begin(), chatMessage);
+
+        std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+          std::make_shared<NewMessagesNotify>(m_ProfileId);
+        newMessagesNotify->success = true;
+        newMessagesNotify->chatId = loadChat.id;
+        newMessagesNotify->chatMessages.push_back(chatMessage);
+        newMessagesNotify->cached = false;
+        newMessagesNotify->sequence = true;
+        CallMessageHandler(newMessagesNotify);
+      }
+      break;
+
+    case MarkMessageReadRequestType:
+      {
+        const MarkMessageReadRequest& markMessageReadRequest =
+          static_cast<const MarkMessageReadRequest&>(*p_RequestMessage);
+        auto chatIt = m_LoadChatIndex.find(markMessageReadRequest.chatId);
+        if (chatIt != m_LoadChatIndex.end())
+        {
+          for (auto& chatMessage : m_LoadChats[chatIt->second].messages)
+          {
+            if (chatMessage.id == markMessageReadRequest.msgId)
+            {
+              chatMessage.isRead = true;
+              break;
+            }
+          }
+        }
+
+        std::shared_ptr<MarkMessageReadNotify> markMessageReadNotify =
+          std::make_shared<MarkMessageReadNotify>(m_ProfileId);
+        markMessageReadNotify->success = (chatIt != m_LoadChatIndex.end());
+        markMessageReadNotify->chatId = markMessageReadRequest.chatId;
+        markMessageReadNotify->msgId = markMessageReadRequest.msgId;
+        CallMessageHandler(markMessageReadNotify);
+      }
+      break;
+
+    case MarkMessagesReadRequestType:
+      {
+        const MarkMessagesReadRequest& markMessagesReadRequest =
+          static_cast<const MarkMessagesReadRequest&>(*p_RequestMessage);
+        auto chatIt = m_LoadChatIndex.find(markMessagesReadRequest.chatId);
+        if (chatIt != m_LoadChatIndex.end())
+        {
+          const std::unordered_set<std::string> msgIds(markMessagesReadRequest.msgIds.begin(),
+                                                       markMessagesReadRequest.msgIds.end());
+          for (auto& chatMessage : m_LoadChats[chatIt->second].messages)
+          {
+            if (msgIds.count(chatMessage.id))
+            {
+              chatMessage.isRead = true;
+            }
+          }
+        }
+
+        std::shared_ptr<MarkMessagesReadNotify> markMessagesReadNotify =
+          std::make_shared<MarkMessagesReadNotify>(m_ProfileId);
+        markMessagesReadNotify->success = (chatIt != m_LoadChatIndex.end());
+        markMessagesReadNotify->chatId = markMessagesReadRequest.chatId;
+        markMessagesReadNotify->msgId = markMessagesReadRequest.msgId;
+        markMessagesReadNotify->msgIds = markMessagesReadRequest.msgIds;
+        CallMessageHandler(markMessagesReadNotify);
+      }
+      break;
+
+    case GetStatusRequestType:
+      {
+        const GetStatusRequest& getStatusRequest = static_cast<const GetStatusRequest&>(*p_RequestMessage);
+        std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify =
+          ObjectPool::MakeShared<ReceiveStatusNotify>(m_ProfileId);
+        receiveStatusNotify->userId = getStatusRequest.userId;
+        receiveStatusNotify->isOnline = (m_LoadOnline.count(getStatusRequest.userId) > 0);
+        CallMessageHandler(receiveStatusNotify);
+      }
+      break;
+
+    case DownloadFileRequestType:
+      {
+        const DownloadFileRequest& downloadFileRequest = static_cast<const DownloadFileRequest&>(*p_RequestMessage);
+
+        // small placeholder file, with a progress update halfway
+        static const int64_t fileSize = 4096;
+        std::shared_ptr<NewMessageFileProgressNotify> newMessageFileProgressNotify =
+          std::make_shared<NewMessageFileProgressNotify>(m_ProfileId);
+        newMessageFileProgressNotify->chatId = downloadFileRequest.chatId;
+        newMessageFileProgressNotify->msgId = downloadFileRequest.msgId;
+        newMessageFileProgressNotify->downloadedBytes = fileSize / 2;
+        newMessageFileProgressNotify->totalBytes = fileSize;
+        CallMessageHandler(newMessageFileProgressNotify);
+
+        const std::string filesDir = m_ProfileDir + "/files";
+        FileUtil::MkDir(filesDir);
+        FileInfo fileInfo;
+        fileInfo.fileId = downloadFileRequest.fileId;
+        fileInfo.filePath = filesDir + "/" + downloadFileRequest.fileId + ".jpg";
+        fileInfo.fileType = "image/jpeg";
+        fileInfo.fileStatus = FileStatusDownloaded;
+        FileUtil::WriteFile(fileInfo.filePath, std::string(fileSize, '\0'));
+
+        std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
+          std::make_shared<NewMessageFileNotify>(m_ProfileId);
+        newMessageFileNotify->chatId = downloadFileRequest.chatId;
+        newMessageFileNotify->msgId = downloadFileRequest.msgId;
+        newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+        newMessageFileNotify->downloadFileAction = downloadFileRequest.downloadFileAction;
+        CallMessageHandler(newMessageFileNotify);
+      }
+      break;
+
+    case DeferNotifyRequestType:
+      {
+        const DeferNotifyRequest& deferNotifyRequest = static_cast<const DeferNotifyRequest&>(*p_RequestMessage);
+        CallMessageHandler(deferNotifyRequest.serviceMessage);
+      }
+      break;
+
+    default:
+      LOG_DEBUG("unknown request message %d", p_RequestMessage->GetMessageType());
+      break;
+  }
+}
+
+void DuChat::InitLoad()
+{
+  if (!m_LoadChats.empty()) return;
+
+  const int chatCount = std::max(1, (int)StrUtil::ToInteger(m_Config.Get("load_chats")));
+  const int groupCount = std::min(chatCount, (int)StrUtil::ToInteger(m_Config.Get("load_group_chats")));
+  const int memberCount = std::max(1, (int)StrUtil::ToInteger(m_Config.Get("load_group_members")));
+  const int historyCount = std::max(0, (int)StrUtil::ToInteger(m_Config.Get("load_history")));
+  LOG_INFO("load chats %d groups %d members %d history %d", chatCount, groupCount, memberCount, historyCount);
+
+  // fixed seed, so history is identical across runs
+  m_LoadRng.seed(1);
+  m_LoadMsgCount = 0;
+
+  ContactInfo selfInfo;
+  selfInfo.id = "load_self";
+  selfInfo.name = "Self";
+  selfInfo.isSelf = true;
+  m_LoadContacts.push_back(selfInfo);
+
+  // group members, shared between all groups
+  std::vector<std::string> memberIds;
+  for (int i = 0; i < ((groupCount > 0) ? memberCount : 0); ++i)
+  {
+    ContactInfo contactInfo;
+    contactInfo.id = "load_user_" + std::to_string(i);
+    contactInfo.name = "User " + std::to_string(i);
+    m_LoadContacts.push_back(contactInfo);
+    memberIds.push_back(contactInfo.id);
+  }
+
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  for (int i = 0; i < chatCount; ++i)
+  {
+    LoadChat loadChat;
+    const bool isGroup = (i < groupCount);
+    loadChat.id = (isGroup ? "load_group_" : "load_chat_") + std::to_string(i);
+
+    ContactInfo contactInfo;
+    contactInfo.id = loadChat.id;
+    contactInfo.name = (isGroup ? "Group " : "Chat ") + std::to_string(i);
+    m_LoadContacts.push_back(contactInfo);
+
+    loadChat.memberIds = isGroup ? memberIds : std::vector<std::string>({ loadChat.id });
+    loadChat.memberIds.push_back(selfInfo.id);
+
+    // history spaced one minute apart, chats staggered by one second, generated oldest first
+    for (int j = historyCount - 1; j >= 0; --j)
+    {
+      const int64_t timeSent = nowTime - (((int64_t)j * 60 + i) * 1000);
+      loadChat.messages.push_back(MakeLoadMessage(loadChat, timeSent));
+      loadChat.messages.back().isRead = true;
+    }
+
+    std::reverse(loadChat.messages.begin(), loadChat.messages.end());
+
+    m_LoadChatIndex[loadChat.id] = m_LoadChats.size();
+    m_LoadChats.push_back(std::move(loadChat));
+  }
+
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  m_LoadMessageTime = now;
+  m_LoadChurnTime = now;
+}
+
+void DuChat::PerformLoadEvents()
+{
+  // events at configured rates, at most one second of backlog is caught up
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto Advance = [&](std::chrono::steady_clock::time_point& p_Time, const std::string& p_Param)
+  {
+    const int64_t rate = StrUtil::ToInteger(m_Config.Get(p_Param));
+    if (rate <= 0)
+    {
+      p_Time = now + std::chrono::hours(1);
+      return false;
+    }
+
+    if (p_Time > now) return false;
+
+    p_Time = std::max(p_Time, now - std::chrono::seconds(1)) + std::chrono::microseconds(1000000 / rate);
+    return true;
+  };
+
+  while (Advance(m_LoadMessageTime, "load_incoming_rate"))
+  {
+    ReceiveLoadMessage();
+  }
+
+  while (Advance(m_LoadChurnTime, "load_churn_rate"))
+  {
+    ReceiveLoadChurn();
+  }
+}
+
+void DuChat::ReceiveLoadMessage()
+{
+  LoadChat& loadChat = m_LoadChats[m_LoadRng() % m_LoadChats.size()];
+  ChatMessage chatMessage = MakeLoadMessage(loadChat, TimeUtil::GetCurrentTimeMSec());
+  loadChat.messages.insert(loadChat.messages.begin(), chatMessage);
+
+  // sender stops typing when its message arrives
+  if (m_LoadTyping.erase(std::make_pair(loadChat.id, chatMessage.senderId)) > 0)
+  {
+    std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify = ObjectPool::MakeShared<ReceiveTypingNotify>(m_ProfileId);
+    receiveTypingNotify->chatId = loadChat.id;
+    receiveTypingNotify->userId = chatMessage.senderId;
+    receiveTypingNotify->isTyping = false;
+    CallMessageHandler(receiveTypingNotify);
+  }
+
+  std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(m_ProfileId);
+  newMessagesNotify->success = true;
+  newMessagesNotify->chatId = loadChat.id;
+  newMessagesNotify->chatMessages.push_back(chatMessage);
+  newMessagesNotify->cached = false;
+  newMessagesNotify->sequence = true;
+  CallMessageHandler(newMessagesNotify);
+}
+
+void DuChat::ReceiveLoadChurn()
+{
+  const LoadChat& loadChat = m_LoadChats[m_LoadRng() % m_LoadChats.size()];
+  const std::string& userId = loadChat.memberIds[m_LoadRng() % (loadChat.memberIds.size() - 1)];
+
+  // alternate between typing and presence changes
+  if ((m_LoadRng() % 2) == 0)
+  {
+    const std::pair<std::string, std::string> typingKey = std::make_pair(loadChat.id, userId);
+    const bool isTyping = (m_LoadTyping.count(typingKey) == 0);
+    if (isTyping)
+    {
+      m_LoadTyping.insert(typingKey);
+    }
+    else
+    {
+      m_LoadTyping.erase(typingKey);
+    }
+
+    std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify = ObjectPool::MakeShared<ReceiveTypingNotify>(m_ProfileId);
+    receiveTypingNotify->chatId = loadChat.id;
+    receiveTypingNotify->userId = userId;
+    receiveTypingNotify->isTyping = isTyping;
+    CallMessageHandler(receiveTypingNotify);
+  }
+  else
+  {
+    const bool isOnline = (m_LoadOnline.count(userId) == 0);
+    if (isOnline)
+    {
+      m_LoadOnline.insert(userId);
+    }
+    else
+    {
+      m_LoadOnline.erase(userId);
+    }
+
+    std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify = ObjectPool::MakeShared<ReceiveStatusNotify>(m_ProfileId);
+    receiveStatusNotify->userId = userId;
+    receiveStatusNotify->isOnline = isOnline;
+    receiveStatusNotify->timeSeen = isOnline ? -1 : TimeUtil::GetCurrentTimeMSec();
+    CallMessageHandler(receiveStatusNotify);
+  }
+}
+
+ChatMessage DuChat::MakeLoadMessage(const LoadChat& p_LoadChat, int64_t p_TimeSent)
+{
+  static const std::vector<std::string> words =
+  {
+    "hey", "lunch", "tomorrow", "meeting", "https://example.com/a/b", "thanks", "ok", "see", "you",
+    "project", "update", "Привет", "你好", "😀", "👍", "later", "call", "photo", "weekend", "sure",
+  };
+
+  // last member is self
+  const size_t senderIndex = m_LoadRng() % p_LoadChat.memberIds.size();
+  ChatMessage chatMessage;
+  chatMessage.id = p_LoadChat.id + "_" + std::to_string(m_LoadMsgCount++);
+  chatMessage.senderId = p_LoadChat.memberIds[senderIndex];
+  chatMessage.isOutgoing = (senderIndex == (p_LoadChat.memberIds.size() - 1));
+  chatMessage.isRead = chatMessage.isOutgoing;
+  chatMessage.timeSent = p_TimeSent;
+
+  const int wordCount = 1 + (m_LoadRng() % 40);
+  for (int i = 0; i < wordCount; ++i)
+  {
+    chatMessage.text += (i > 0 ? " " : "") + words[m_LoadRng() % words.size()];
+  }
+
+  const int attachmentPercent = StrUtil::ToInteger(m_Config.Get("load_attachment_percent"));
+  if ((int)(m_LoadRng() % 100) < attachmentPercent)
+  {
+    FileInfo fileInfo;
+    fileInfo.fileId = chatMessage.id;
+    fileInfo.filePath = "photo_" + chatMessage.id + ".jpg";
+    fileInfo.fileType = "image/jpeg";
+    fileInfo.fileStatus = FileStatusNotDownloaded;
+    chatMessage.fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+  }
+
+  return chatMessage;
+}
+
+void DuChat::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  MessageCache::AddFromServiceMessage(m_ProfileId, p_ServiceMessage);
+  m_MessageHandler(p_ServiceMessage);
+}
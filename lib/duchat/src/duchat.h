@@ -7,10 +7,15 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <map>
+#include <random>
+#include <set>
 #include <thread>
 
+#include "config.h"
 #include "protocol.h"
 
 class DuChat : public Protocol
@@ -38,11 +43,40 @@ public:
   void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler);
 
 private:
+  struct LoadChat
+  {
+    std::string id;
+    std::vector<std::string> memberIds;
+    std::vector<ChatMessage> messages; // newest first
+  };
+
+  void Init();
   void PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void PerformLoadRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void InitLoad();
+  void PerformLoadEvents();
+  void ReceiveLoadMessage();
+  void ReceiveLoadChurn();
+  ChatMessage MakeLoadMessage(const LoadChat& p_LoadChat, int64_t p_TimeSent);
+  void CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
 
 private:
   std::string m_ProfileId;
+  std::string m_ProfileDir;
   std::function<void(std::shared_ptr<ServiceMessage>)> m_MessageHandler;
+  Config m_Config;
+
+  // synthetic load mode, enabled by load_chats in profile config
+  bool m_LoadMode = false;
+  std::vector<LoadChat> m_LoadChats;
+  std::map<std::string, size_t> m_LoadChatIndex;
+  std::vector<ContactInfo> m_LoadContacts;
+  std::set<std::pair<std::string, std::string>> m_LoadTyping; // chat and user id
+  std::set<std::string> m_LoadOnline;
+  std::mt19937 m_LoadRng;
+  int64_t m_LoadMsgCount = 0;
+  std::chrono::steady_clock::time_point m_LoadMessageTime;
+  std::chrono::steady_clock::time_point m_LoadChurnTime;
 
   bool m_Running = false;
   std::thread m_Thread;
@@ -18,16 +18,39 @@ void AppConfig::Init()
 {
   const std::map<std::string, std::string> defaultConfig =
   {
+    { "attachment_download_concurrency", "4" },
+    { "attachment_download_max_rate_kb", "0" },
     { "attachment_prefetch", "1" },
     { "attachment_send_type", "1" },
+    { "attachment_upload_concurrency", "3" },
+    { "cache_archive_age_days", "0" },
+    { "cache_compress_text", "0" },
+    { "cache_delete_chat_attachments", "0" },
     { "cache_enabled", "1" },
+    { "cache_export_dir", "" },
+    { "cache_export_format", "jsonl" },
+    { "cache_export_throttle_ms", "20" },
+    { "cache_memory_size_kb", "8192" },
+    { "cache_mmap_size", "0" },
+    { "cache_queue_max_size_mb", "64" },
+    { "cache_retention_attachments_max_size_mb", "0" },
+    { "cache_retention_max_age_days", "0" },
+    { "cache_retention_max_messages", "0" },
+    { "cache_retention_max_size_mb", "0" },
+    { "cache_startup_chats", "10" },
+    { "cache_wal_autocheckpoint", "1000" },
+    { "cache_wal_enabled", "0" },
     { "coredump_enabled", "0" },
     { "downloads_dir", "" },
+    { "memory_budget_mb", "0" },
+    { "profile_connect_policy", "" },
     { "proxy_host", "" },
     { "proxy_pass", "" },
     { "proxy_port", "" },
     { "proxy_user", "" },
     { "timestamp_iso", "0" },
+    { "trace_enabled", "0" },
+    { "whatsapp_store_options", "_journal_mode=WAL&_synchronous=NORMAL&_busy_timeout=5000&_cache_size=-8192" },
   };
 
   const std::string configPath(FileUtil::GetApplicationDir() + std::string("/app.conf"));
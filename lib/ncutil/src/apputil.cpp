@@ -22,6 +22,9 @@
 #include "version.h"
 
 bool AppUtil::m_DeveloperMode = false;
+std::atomic<bool> AppUtil::m_DumpRequested(false);
+std::atomic<bool> AppUtil::m_TerminateRequested(false);
+std::atomic<bool> AppUtil::m_TerminalActive(false);
 
 std::string AppUtil::GetAppNameVersion()
 {
@@ -95,6 +98,8 @@ void AppUtil::InitSignalHandler()
   {
     signal(sig, SignalHandler);
   }
+
+  signal(SIGUSR1, DumpSignalHandler);
 }
 
 void AppUtil::SignalHandler(int p_Signal)
@@ -107,6 +112,7 @@ void AppUtil::SignalHandler(int p_Signal)
 #else
   const int size = 0;
 #endif
+  Log::Flush();
   Log::Callstack(callstack, size, logMsg);
 
   // non-signal safe code section
@@ -119,3 +125,43 @@ void AppUtil::SignalHandler(int p_Signal)
   signal(p_Signal, SIG_DFL);
   kill(getpid(), p_Signal);
 }
+
+void AppUtil::DumpSignalHandler(int /*p_Signal*/)
+{
+  // only flag the request, stats and trace are dumped by the ui loop
+  m_DumpRequested = true;
+}
+
+bool AppUtil::HandleDumpRequest()
+{
+  return m_DumpRequested.exchange(false);
+}
+
+void AppUtil::InitTerminateHandler()
+{
+  // only for headless modes, the ui handles ctrl-c itself as raw key input
+  signal(SIGHUP, TerminateSignalHandler);
+  signal(SIGINT, TerminateSignalHandler);
+  signal(SIGTERM, TerminateSignalHandler);
+}
+
+void AppUtil::TerminateSignalHandler(int /*p_Signal*/)
+{
+  m_TerminateRequested = true;
+}
+
+bool AppUtil::IsTerminateRequested()
+{
+  return m_TerminateRequested;
+}
+
+void AppUtil::SetTerminalActive(bool p_TerminalActive)
+{
+  m_TerminalActive = p_TerminalActive;
+}
+
+bool AppUtil::IsTerminalActive()
+{
+  // @note: inactive when no ui is attached, e.g. in core daemon mode
+  return m_TerminalActive;
+}
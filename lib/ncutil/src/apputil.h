@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 
 class AppUtil
@@ -19,7 +20,17 @@ public:
   static void InitCoredump();
   static void InitSignalHandler();
   static void SignalHandler(int p_Signal);
+  static void DumpSignalHandler(int p_Signal);
+  static bool HandleDumpRequest();
+  static void InitTerminateHandler();
+  static void TerminateSignalHandler(int p_Signal);
+  static bool IsTerminateRequested();
+  static void SetTerminalActive(bool p_TerminalActive);
+  static bool IsTerminalActive();
 
 private:
   static bool m_DeveloperMode;
+  static std::atomic<bool> m_DumpRequested;
+  static std::atomic<bool> m_TerminateRequested;
+  static std::atomic<bool> m_TerminalActive;
 };
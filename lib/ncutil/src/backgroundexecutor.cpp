@@ -0,0 +1,147 @@
+// backgroundexecutor.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "backgroundexecutor.h"
+
+#include <pthread.h>
+
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+#include "threadregistry.h"
+
+bool BackgroundExecutor::m_Running = false;
+std::mutex BackgroundExecutor::m_Mutex;
+std::condition_variable BackgroundExecutor::m_CondVar;
+std::deque<BackgroundExecutor::Job> BackgroundExecutor::m_Jobs[ClassCount];
+std::vector<std::thread> BackgroundExecutor::m_Threads;
+
+#if defined(__linux__)
+// not provided by libc, see linux/ioprio.h
+static const int s_IoprioWhoProcess = 1;
+static const int s_IoprioClassShift = 13;
+static const int s_IoprioClassBestEffort = 2;
+static const int s_IoprioClassIdle = 3;
+static const int s_BatchNice = 10;
+#endif
+
+void BackgroundExecutor::Init()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_Running) return;
+
+  m_Running = true;
+  for (int priorityClass = 0; priorityClass < ClassCount; ++priorityClass)
+  {
+    m_Threads.emplace_back(&BackgroundExecutor::Process, static_cast<PriorityClass>(priorityClass));
+  }
+}
+
+void BackgroundExecutor::Cleanup()
+{
+  // queued jobs are dropped, running jobs complete before their worker exits
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Running) return;
+
+    m_Running = false;
+    for (auto& jobs : m_Jobs)
+    {
+      jobs.clear();
+    }
+  }
+
+  m_CondVar.notify_all();
+  for (auto& thread : m_Threads)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+
+  m_Threads.clear();
+}
+
+bool BackgroundExecutor::Post(PriorityClass p_Class, const Job& p_Job)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Running) return false;
+
+    m_Jobs[p_Class].push_back(p_Job);
+  }
+
+  m_CondVar.notify_all();
+  return true;
+}
+
+void BackgroundExecutor::SetThreadClass(PriorityClass p_Class)
+{
+#if defined(__APPLE__)
+  const qos_class_t qosClass = (p_Class == ClassIdle) ? QOS_CLASS_BACKGROUND : QOS_CLASS_UTILITY;
+  if (pthread_set_qos_class_self_np(qosClass, 0) != 0)
+  {
+    LOG_WARNING("set thread qos class failed");
+  }
+#elif defined(__linux__)
+  // scheduling policy, nice value and io priority are all per thread on linux
+  const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+  struct sched_param param = { };
+  const int policy = (p_Class == ClassIdle) ? SCHED_IDLE : SCHED_BATCH;
+  if (pthread_setschedparam(pthread_self(), policy, &param) != 0)
+  {
+    LOG_WARNING("set thread sched policy %d failed", policy);
+  }
+
+  if ((p_Class == ClassBatch) && (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), s_BatchNice) != 0))
+  {
+    LOG_WARNING("set thread nice %d failed", s_BatchNice);
+  }
+
+  // best effort level 7 is the lowest, idle class only gets disk time when no other io is pending
+  const int ioprio = (p_Class == ClassIdle) ? (s_IoprioClassIdle << s_IoprioClassShift)
+                                            : ((s_IoprioClassBestEffort << s_IoprioClassShift) | 7);
+  if (syscall(SYS_ioprio_set, s_IoprioWhoProcess, tid, ioprio) != 0)
+  {
+    LOG_WARNING("set thread io priority failed");
+  }
+#else
+  (void)p_Class;
+#endif
+}
+
+void BackgroundExecutor::Process(PriorityClass p_Class)
+{
+  ThreadRegistry::Register((p_Class == ClassIdle) ? "bg-idle" : "bg-batch");
+  SetThreadClass(p_Class);
+
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait(lock, [p_Class]() { return !m_Jobs[p_Class].empty() || !m_Running; });
+      if (!m_Running) break;
+
+      job = std::move(m_Jobs[p_Class].front());
+      m_Jobs[p_Class].pop_front();
+    }
+
+    if (job)
+    {
+      job();
+    }
+  }
+}
@@ -0,0 +1,52 @@
+// backgroundexecutor.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// runs maintenance work on worker threads with lowered cpu and io priority, so it does not compete
+// with interactive work. jobs are tagged by priority class, each served by its own worker. long
+// running background threads not owned by the executor apply a class to themselves.
+class BackgroundExecutor
+{
+public:
+  enum PriorityClass
+  {
+    // lowered, but not idle, priority. for work holding locks shared with interactive paths (e.g.
+    // the cache db), which would otherwise be blocked while an idle thread is starved of cpu.
+    ClassBatch = 0,
+    // only runs when the system is otherwise idle, for work not holding shared locks.
+    ClassIdle,
+    ClassCount,
+  };
+
+  typedef std::function<void()> Job;
+
+  static void Init();
+  static void Cleanup();
+
+  // returns false if the job was not queued, i.e. the executor is not running
+  static bool Post(PriorityClass p_Class, const Job& p_Job);
+  // must be called on the thread itself, threads created by it inherit the class
+  static void SetThreadClass(PriorityClass p_Class);
+
+private:
+  static void Process(PriorityClass p_Class);
+
+private:
+  static bool m_Running;
+  static std::mutex m_Mutex;
+  static std::condition_variable m_CondVar;
+  static std::deque<Job> m_Jobs[ClassCount];
+  static std::vector<std::thread> m_Threads;
+};
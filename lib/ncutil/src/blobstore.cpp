@@ -0,0 +1,114 @@
+// blobstore.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "blobstore.h"
+
+#include <cstdio>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fileutil.h"
+#include "log.h"
+
+// creates p_Path as hardlink to stored blob with identical content, returns false if none
+bool BlobStore::Link(const std::string& p_Key, const std::string& p_Path)
+{
+  if (p_Key.empty() || FileUtil::Exists(p_Path)) return false;
+
+  const std::string& blobPath = GetBlobPath(p_Key);
+  if (link(blobPath.c_str(), p_Path.c_str()) != 0) return false;
+
+  LOG_DEBUG("blob linked %s", p_Path.c_str());
+  return true;
+}
+
+// stores downloaded file, or replaces it with hardlink to an already stored identical blob
+void BlobStore::Add(const std::string& p_Key, const std::string& p_Path)
+{
+  if (p_Key.empty()) return;
+
+  struct stat fileStat;
+  if (stat(p_Path.c_str(), &fileStat) != 0) return;
+
+  const std::string& blobPath = GetBlobPath(p_Key);
+  struct stat blobStat;
+  if (stat(blobPath.c_str(), &blobStat) != 0)
+  {
+    FileUtil::MkDir(GetDir());
+    if (link(p_Path.c_str(), blobPath.c_str()) != 0)
+    {
+      LOG_DEBUG("blob add failed %s", p_Path.c_str());
+    }
+
+    return;
+  }
+
+  if ((blobStat.st_dev == fileStat.st_dev) && (blobStat.st_ino == fileStat.st_ino)) return;
+
+  if (blobStat.st_size != fileStat.st_size)
+  {
+    LOG_WARNING("blob size mismatch %s", p_Path.c_str());
+    return;
+  }
+
+  // link next to file and rename over it, so the path always refers to a complete file
+  const std::string& tmpPath = p_Path + ".blob";
+  unlink(tmpPath.c_str());
+  if ((link(blobPath.c_str(), tmpPath.c_str()) != 0) || (rename(tmpPath.c_str(), p_Path.c_str()) != 0))
+  {
+    unlink(tmpPath.c_str());
+    LOG_DEBUG("blob replace failed %s", p_Path.c_str());
+    return;
+  }
+
+  LOG_DEBUG("blob deduplicated %s", p_Path.c_str());
+}
+
+// removes blobs no longer referenced by any downloaded file
+void BlobStore::Cleanup()
+{
+  const std::string& dir = GetDir();
+  if (!FileUtil::IsDir(dir)) return;
+
+  int removed = 0;
+  for (const auto& entry : FileUtil::ListPaths(dir))
+  {
+    if (entry.IsDir()) continue;
+
+    const std::string& blobPath = dir + "/" + entry.name;
+    struct stat blobStat;
+    if ((stat(blobPath.c_str(), &blobStat) == 0) && (blobStat.st_nlink <= 1))
+    {
+      FileUtil::RmFile(blobPath);
+      ++removed;
+    }
+  }
+
+  if (removed > 0)
+  {
+    LOG_DEBUG("blob cleanup removed %d", removed);
+  }
+}
+
+std::string BlobStore::GetDir()
+{
+  return FileUtil::GetApplicationDir() + "/blobs";
+}
+
+std::string BlobStore::GetBlobPath(const std::string& p_Key)
+{
+  // keys may be base64, map path separator and other special chars to file name safe ones
+  std::string name = p_Key;
+  for (auto& ch : name)
+  {
+    if ((ch == '/') || (ch == '\\')) ch = '_';
+    else if (ch == '+') ch = '-';
+  }
+
+  return GetDir() + "/" + name;
+}
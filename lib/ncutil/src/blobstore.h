@@ -0,0 +1,25 @@
+// blobstore.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <string>
+
+// content-addressed store of downloaded files shared by all profiles, holding one hardlink per
+// unique content. keys must identify file content, e.g. a protocol-provided hash verified on
+// download. files on other filesystems than the application dir are not deduplicated.
+class BlobStore
+{
+public:
+  static bool Link(const std::string& p_Key, const std::string& p_Path);
+  static void Add(const std::string& p_Key, const std::string& p_Path);
+  static void Cleanup();
+
+private:
+  static std::string GetDir();
+  static std::string GetBlobPath(const std::string& p_Key);
+};
@@ -0,0 +1,87 @@
+// clipboardworker.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "clipboardworker.h"
+
+#include "clipboard.h"
+#include "log.h"
+#include "threadregistry.h"
+
+ClipboardWorker::ClipboardWorker()
+{
+  m_Thread = std::thread(&ClipboardWorker::Run, this);
+}
+
+ClipboardWorker::~ClipboardWorker()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+  }
+
+  m_CondVar.notify_one();
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+void ClipboardWorker::SetText(const std::string& p_Text)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_HasSetText = true;
+    m_SetText = p_Text;
+  }
+
+  m_CondVar.notify_one();
+}
+
+void ClipboardWorker::GetText(const GetHandler& p_GetHandler)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_GetHandler = p_GetHandler;
+  }
+
+  m_CondVar.notify_one();
+}
+
+void ClipboardWorker::Run()
+{
+  ThreadRegistry::Register("clipboard");
+
+  while (true)
+  {
+    bool hasSetText = false;
+    std::string setText;
+    GetHandler getHandler;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait(lock, [&]() { return !m_Running || m_HasSetText || m_GetHandler; });
+      if (!m_Running) break;
+
+      std::swap(hasSetText, m_HasSetText);
+      std::swap(setText, m_SetText);
+      std::swap(getHandler, m_GetHandler);
+    }
+
+    // set before get, so a paste following a copy gets the copied text
+    if (hasSetText)
+    {
+      LOG_TRACE("clipboard set %d", setText.size());
+      Clipboard::SetText(setText);
+    }
+
+    if (getHandler)
+    {
+      std::string text = Clipboard::GetText();
+      LOG_TRACE("clipboard get %d", text.size());
+      getHandler(std::move(text));
+    }
+  }
+}
@@ -0,0 +1,41 @@
+// clipboardworker.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// performs clipboard access on a worker thread, so slow clipboard tools do not block the caller.
+// at most one set and one get are pending, a newer request replaces a pending one.
+class ClipboardWorker
+{
+public:
+  // called on the worker thread with the clipboard text
+  typedef std::function<void(std::string&&)> GetHandler;
+
+  ClipboardWorker();
+  ~ClipboardWorker();
+
+  void SetText(const std::string& p_Text);
+  void GetText(const GetHandler& p_GetHandler);
+
+private:
+  void Run();
+
+private:
+  std::thread m_Thread;
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  bool m_HasSetText = false;
+  std::string m_SetText;
+  GetHandler m_GetHandler;
+  bool m_Running = true;
+};
@@ -0,0 +1,78 @@
+// compactmessage.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "compactmessage.h"
+
+#include "heapsize.h"
+
+CompactMessage::CompactMessage(const ChatMessage& p_ChatMessage)
+{
+  *this = p_ChatMessage;
+}
+
+CompactMessage& CompactMessage::operator=(const ChatMessage& p_ChatMessage)
+{
+  id = p_ChatMessage.id;
+  senderId = p_ChatMessage.senderId;
+  text = p_ChatMessage.text;
+  quotedId = p_ChatMessage.quotedId;
+  quotedText = p_ChatMessage.quotedText;
+  quotedSender = p_ChatMessage.quotedSender;
+  fileInfo = p_ChatMessage.fileInfo;
+  link = p_ChatMessage.link;
+  timeSent = p_ChatMessage.timeSent;
+  sequence = p_ChatMessage.sequence;
+  isOutgoing = p_ChatMessage.isOutgoing;
+  isRead = p_ChatMessage.isRead;
+  hasMention = p_ChatMessage.hasMention;
+  return *this;
+}
+
+ChatMessage CompactMessage::ToChatMessage() const
+{
+  ChatMessage chatMessage;
+  chatMessage.id = id;
+  chatMessage.senderId = senderId;
+  chatMessage.text = text;
+  chatMessage.quotedId = quotedId;
+  chatMessage.quotedText = quotedText;
+  chatMessage.quotedSender = quotedSender;
+  chatMessage.fileInfo = fileInfo;
+  chatMessage.link = link;
+  chatMessage.timeSent = timeSent;
+  chatMessage.sequence = sequence;
+  chatMessage.isOutgoing = isOutgoing;
+  chatMessage.isRead = isRead;
+  chatMessage.hasMention = hasMention;
+  return chatMessage;
+}
+
+bool CompactMessage::IsEqual(const ChatMessage& p_ChatMessage) const
+{
+  // cheap fields first, as redelivered messages are commonly compared
+  return (timeSent == p_ChatMessage.timeSent) && (sequence == p_ChatMessage.sequence) &&
+         (isOutgoing == p_ChatMessage.isOutgoing) && (isRead == p_ChatMessage.isRead) &&
+         (hasMention == p_ChatMessage.hasMention) && (id == p_ChatMessage.id) &&
+         (senderId == p_ChatMessage.senderId) && (text == p_ChatMessage.text) &&
+         (quotedId == p_ChatMessage.quotedId) && (quotedText == p_ChatMessage.quotedText) &&
+         (quotedSender == p_ChatMessage.quotedSender) && (fileInfo == p_ChatMessage.fileInfo) &&
+         (link == p_ChatMessage.link);
+}
+
+size_t CompactMessage::GetHeapSize() const
+{
+  size_t size = HeapSize::Of(id);
+  for (const CompactStr* str : { &text, &quotedId, &quotedText, &fileInfo, &link })
+  {
+    if (!str->empty())
+    {
+      size += sizeof(std::string) + HeapSize::Of(str->Str());
+    }
+  }
+
+  return size;
+}
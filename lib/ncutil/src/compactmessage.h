@@ -0,0 +1,42 @@
+// compactmessage.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <string>
+
+#include "compactstr.h"
+#include "internedstr.h"
+#include "protocol.h"
+
+// memory-compact form of ChatMessage for long-lived in-memory storage. sender ids are interned,
+// as a chat has few distinct senders, and fields that are empty for most messages are stored
+// out-of-line. field names match ChatMessage, so read access works the same for both.
+struct CompactMessage
+{
+  CompactMessage() = default;
+  CompactMessage(const ChatMessage& p_ChatMessage);
+  CompactMessage& operator=(const ChatMessage& p_ChatMessage);
+
+  ChatMessage ToChatMessage() const;
+  bool IsEqual(const ChatMessage& p_ChatMessage) const;
+  size_t GetHeapSize() const; // approximate, excluding interned strings
+
+  std::string id;
+  InternedStr senderId;
+  CompactStr text;
+  CompactStr quotedId;
+  CompactStr quotedText;
+  InternedStr quotedSender;
+  CompactStr fileInfo;
+  CompactStr link;
+  int64_t timeSent = -1;
+  int64_t sequence = 0;
+  bool isOutgoing = true;
+  bool isRead = false;
+  bool hasMention = false;
+};
@@ -0,0 +1,135 @@
+// compactstr.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+// pointer-sized owning string, stored out-of-line and only allocated when non-empty. intended
+// for optional fields which are empty for most instances.
+class CompactStr
+{
+public:
+  CompactStr() = default;
+
+  CompactStr(const std::string& p_Str)
+  {
+    Assign(p_Str);
+  }
+
+  CompactStr(const CompactStr& p_Other)
+  {
+    Assign(p_Other.Str());
+  }
+
+  CompactStr(CompactStr&& p_Other) noexcept = default;
+
+  CompactStr& operator=(const std::string& p_Str)
+  {
+    Assign(p_Str);
+    return *this;
+  }
+
+  CompactStr& operator=(const CompactStr& p_Other)
+  {
+    if (this != &p_Other)
+    {
+      Assign(p_Other.Str());
+    }
+
+    return *this;
+  }
+
+  CompactStr& operator=(CompactStr&& p_Other) noexcept = default;
+
+  const std::string& Str() const
+  {
+    return m_Str ? *m_Str : EmptyStr();
+  }
+
+  operator const std::string&() const
+  {
+    return Str();
+  }
+
+  const char* c_str() const
+  {
+    return Str().c_str();
+  }
+
+  size_t size() const
+  {
+    return m_Str ? m_Str->size() : 0;
+  }
+
+  bool empty() const
+  {
+    return !m_Str;
+  }
+
+  void clear()
+  {
+    m_Str.reset();
+  }
+
+private:
+  void Assign(const std::string& p_Str)
+  {
+    if (p_Str.empty())
+    {
+      m_Str.reset();
+    }
+    else if (m_Str)
+    {
+      *m_Str = p_Str;
+    }
+    else
+    {
+      m_Str.reset(new std::string(p_Str));
+    }
+  }
+
+  static const std::string& EmptyStr()
+  {
+    static const std::string s_EmptyStr;
+    return s_EmptyStr;
+  }
+
+private:
+  std::unique_ptr<std::string> m_Str;
+};
+
+inline bool operator==(const CompactStr& p_Lhs, const CompactStr& p_Rhs)
+{
+  return p_Lhs.Str() == p_Rhs.Str();
+}
+
+inline bool operator==(const CompactStr& p_Lhs, const std::string& p_Rhs)
+{
+  return p_Lhs.Str() == p_Rhs;
+}
+
+inline bool operator==(const std::string& p_Lhs, const CompactStr& p_Rhs)
+{
+  return p_Lhs == p_Rhs.Str();
+}
+
+inline bool operator!=(const CompactStr& p_Lhs, const CompactStr& p_Rhs)
+{
+  return p_Lhs.Str() != p_Rhs.Str();
+}
+
+inline bool operator!=(const CompactStr& p_Lhs, const std::string& p_Rhs)
+{
+  return p_Lhs.Str() != p_Rhs;
+}
+
+inline bool operator!=(const std::string& p_Lhs, const CompactStr& p_Rhs)
+{
+  return p_Lhs != p_Rhs.Str();
+}
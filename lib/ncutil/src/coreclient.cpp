@@ -0,0 +1,265 @@
+// coreclient.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "coreclient.h"
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "corelink.h"
+#include "log.h"
+#include "messagecodec.h"
+#include "status.h"
+#include "threadregistry.h"
+
+RemoteProtocol::RemoteProtocol(CoreClient* p_CoreClient, const std::string& p_ProfileId,
+                               const std::string& p_DisplayName, int64_t p_Features)
+  : m_CoreClient(p_CoreClient)
+  , m_ProfileId(p_ProfileId)
+  , m_DisplayName(p_DisplayName)
+  , m_Features(p_Features)
+{
+}
+
+std::string RemoteProtocol::GetProfileId() const
+{
+  return m_ProfileId;
+}
+
+std::string RemoteProtocol::GetProfileDisplayName() const
+{
+  return m_DisplayName;
+}
+
+bool RemoteProtocol::HasFeature(ProtocolFeature p_ProtocolFeature) const
+{
+  return (p_ProtocolFeature & m_Features);
+}
+
+bool RemoteProtocol::SetupProfile(const std::string& /*p_ProfilesDir*/, std::string& /*p_ProfileId*/)
+{
+  return false;
+}
+
+bool RemoteProtocol::LoadProfile(const std::string& /*p_ProfilesDir*/, const std::string& /*p_ProfileId*/)
+{
+  return true;
+}
+
+bool RemoteProtocol::CloseProfile()
+{
+  return true;
+}
+
+bool RemoteProtocol::Login()
+{
+  // the daemon stays logged in, attaching only requests its current state
+  Status::Set(Status::FlagOnline);
+  m_CoreClient->Subscribe(m_ProfileId);
+  return true;
+}
+
+bool RemoteProtocol::Logout()
+{
+  return true;
+}
+
+void RemoteProtocol::SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  m_CoreClient->SendRequest(m_ProfileId, p_RequestMessage);
+}
+
+void RemoteProtocol::SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_MessageHandler = p_MessageHandler;
+}
+
+void RemoteProtocol::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  std::function<void(std::shared_ptr<ServiceMessage>)> messageHandler;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    messageHandler = m_MessageHandler;
+  }
+
+  if (messageHandler)
+  {
+    messageHandler(p_ServiceMessage);
+  }
+}
+
+CoreClient::CoreClient()
+{
+}
+
+CoreClient::~CoreClient()
+{
+  Disconnect();
+}
+
+bool CoreClient::Connect(const std::string& p_Path)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  if (p_Path.size() >= sizeof(addr.sun_path))
+  {
+    LOG_ERROR("core socket path too long %s", p_Path.c_str());
+    return false;
+  }
+
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, p_Path.c_str(), sizeof(addr.sun_path) - 1);
+
+  m_Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_Fd == -1)
+  {
+    LOG_ERROR("core socket failed errno %d", errno);
+    return false;
+  }
+
+  CoreLink::InitSocket(m_Fd);
+  if ((connect(m_Fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) || !ReadHello())
+  {
+    LOG_WARNING("core connect failed %s errno %d", p_Path.c_str(), errno);
+    close(m_Fd);
+    m_Fd = -1;
+    return false;
+  }
+
+  m_Thread = std::thread(&CoreClient::Run, this);
+  LOG_INFO("core attached %s, %d profiles", p_Path.c_str(), m_Protocols.size());
+  return true;
+}
+
+void CoreClient::Disconnect()
+{
+  if (m_Fd == -1) return;
+
+  m_Detaching = true;
+  shutdown(m_Fd, SHUT_RDWR);
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+
+  close(m_Fd);
+  m_Fd = -1;
+}
+
+std::vector<std::shared_ptr<RemoteProtocol>> CoreClient::GetProtocols()
+{
+  return m_ProtocolOrder;
+}
+
+void CoreClient::Subscribe(const std::string& p_ProfileId)
+{
+  std::string data;
+  MessageCodec::AppendStr(data, p_ProfileId);
+  Send(CoreLink::MakeFrame(CoreLink::FrameSubscribe, data));
+}
+
+void CoreClient::SendRequest(const std::string& p_ProfileId, std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  std::string request;
+  if (!MessageCodec::EncodeRequest(p_RequestMessage, request))
+  {
+    LOG_WARNING("core skip request %d", p_RequestMessage->GetMessageType());
+    return;
+  }
+
+  std::string data;
+  MessageCodec::AppendStr(data, p_ProfileId);
+  MessageCodec::AppendNum(data, p_RequestMessage->requestId);
+  MessageCodec::AppendStr(data, request);
+  Send(CoreLink::MakeFrame(CoreLink::FrameRequest, data));
+}
+
+bool CoreClient::ReadHello()
+{
+  std::string payload;
+  if (!CoreLink::ReadFrame(m_Fd, payload)) return false;
+
+  MessageCodec::Reader reader(payload);
+  const CoreLink::FrameType frameType = (CoreLink::FrameType)reader.Num();
+  const std::string version = reader.Str();
+  if ((frameType != CoreLink::FrameHello) || (version != CoreLink::GetVersion()))
+  {
+    LOG_ERROR("core version mismatch %s", version.c_str());
+    return false;
+  }
+
+  const int64_t count = reader.Num();
+  for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+  {
+    const std::string profileId = reader.Str();
+    const std::string displayName = reader.Str();
+    const int64_t features = reader.Num();
+    std::shared_ptr<RemoteProtocol> protocol =
+      std::make_shared<RemoteProtocol>(this, profileId, displayName, features);
+    m_Protocols[profileId] = protocol;
+    m_ProtocolOrder.push_back(protocol);
+  }
+
+  return reader.Ok();
+}
+
+void CoreClient::Run()
+{
+  ThreadRegistry::Register("core-client");
+
+  std::string payload;
+  while (CoreLink::ReadFrame(m_Fd, payload))
+  {
+    MessageCodec::Reader reader(payload);
+    const CoreLink::FrameType frameType = (CoreLink::FrameType)reader.Num();
+    if (frameType != CoreLink::FrameService)
+    {
+      LOG_WARNING("core unexpected frame %d", frameType);
+      continue;
+    }
+
+    const int64_t requestId = reader.Num();
+    std::shared_ptr<ServiceMessage> serviceMessage =
+      MessageCodec::DecodeServiceMessage(payload.substr(2 * sizeof(int64_t)));
+    if (!serviceMessage || !reader.Ok())
+    {
+      LOG_WARNING("core invalid service message");
+      continue;
+    }
+
+    serviceMessage->requestId = requestId;
+
+    auto protocolIt = m_Protocols.find(serviceMessage->profileId);
+    if (protocolIt == m_Protocols.end()) continue;
+
+    protocolIt->second->CallMessageHandler(serviceMessage);
+  }
+
+  if (m_Detaching)
+  {
+    LOG_INFO("core detached");
+    return;
+  }
+
+  // daemon exited, the ui keeps showing what it has
+  LOG_WARNING("core connection lost");
+  Status::Clear(Status::FlagOnline);
+  Status::Set(Status::FlagOffline);
+}
+
+void CoreClient::Send(const std::string& p_Payload)
+{
+  std::unique_lock<std::mutex> lock(m_WriteMutex);
+  if (!CoreLink::WriteFrame(m_Fd, p_Payload))
+  {
+    LOG_WARNING("core send failed errno %d", errno);
+  }
+}
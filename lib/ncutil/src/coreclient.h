@@ -0,0 +1,81 @@
+// coreclient.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "protocol.h"
+
+class CoreClient;
+
+// stand-in for a protocol owned by the core daemon, forwards requests over the socket and
+// delivers the daemon's service messages. login subscribes to the daemon's snapshot and deltas.
+class RemoteProtocol : public Protocol
+{
+public:
+  RemoteProtocol(CoreClient* p_CoreClient, const std::string& p_ProfileId, const std::string& p_DisplayName,
+                 int64_t p_Features);
+
+  std::string GetProfileId() const;
+  std::string GetProfileDisplayName() const;
+  bool HasFeature(ProtocolFeature p_ProtocolFeature) const;
+
+  bool SetupProfile(const std::string& p_ProfilesDir, std::string& p_ProfileId);
+  bool LoadProfile(const std::string& p_ProfilesDir, const std::string& p_ProfileId);
+  bool CloseProfile();
+
+  bool Login();
+  bool Logout();
+
+  void SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler);
+  void CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
+
+private:
+  CoreClient* m_CoreClient = nullptr;
+  std::string m_ProfileId;
+  std::string m_DisplayName;
+  int64_t m_Features = 0;
+  std::mutex m_Mutex;
+  std::function<void(std::shared_ptr<ServiceMessage>)> m_MessageHandler;
+};
+
+// ui client side of the core daemon unix socket
+class CoreClient
+{
+public:
+  CoreClient();
+  ~CoreClient();
+
+  bool Connect(const std::string& p_Path);
+  void Disconnect();
+  std::vector<std::shared_ptr<RemoteProtocol>> GetProtocols();
+
+  void Subscribe(const std::string& p_ProfileId);
+  void SendRequest(const std::string& p_ProfileId, std::shared_ptr<RequestMessage> p_RequestMessage);
+
+private:
+  bool ReadHello();
+  void Run();
+  void Send(const std::string& p_Payload);
+
+private:
+  int m_Fd = -1;
+  std::atomic<bool> m_Detaching{ false };
+  std::thread m_Thread;
+  std::mutex m_WriteMutex;
+  std::unordered_map<std::string, std::shared_ptr<RemoteProtocol>> m_Protocols; // set before reader starts
+  std::vector<std::shared_ptr<RemoteProtocol>> m_ProtocolOrder;
+};
@@ -0,0 +1,118 @@
+// corelink.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "corelink.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "fileutil.h"
+#include "messagecodec.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// @note: bump on any change of framing or message codec encoding
+static const std::string s_Version = "nchat-core-3";
+
+// @note: larger frames are treated as a corrupt stream
+static const uint32_t s_MaxFrameSize = 64 * 1024 * 1024;
+
+static bool ReadAll(int p_Fd, char* p_Buf, size_t p_Size)
+{
+  while (p_Size > 0)
+  {
+    const ssize_t rv = read(p_Fd, p_Buf, p_Size);
+    if (rv < 0)
+    {
+      if (errno == EINTR) continue;
+
+      return false;
+    }
+
+    if (rv == 0) return false;
+
+    p_Buf += rv;
+    p_Size -= rv;
+  }
+
+  return true;
+}
+
+static bool WriteAll(int p_Fd, const char* p_Buf, size_t p_Size)
+{
+  while (p_Size > 0)
+  {
+    const ssize_t rv = send(p_Fd, p_Buf, p_Size, MSG_NOSIGNAL);
+    if (rv < 0)
+    {
+      if (errno == EINTR) continue;
+
+      return false;
+    }
+
+    p_Buf += rv;
+    p_Size -= rv;
+  }
+
+  return true;
+}
+
+std::string CoreLink::GetSocketPath()
+{
+  return FileUtil::GetApplicationDir() + "/core.sock";
+}
+
+std::string CoreLink::GetVersion()
+{
+  return s_Version;
+}
+
+void CoreLink::InitSocket(int p_Fd)
+{
+  // not inherited by launched viewers, and a closed peer fails writes instead of raising sigpipe
+  fcntl(p_Fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+  int on = 1;
+  setsockopt(p_Fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+bool CoreLink::ReadFrame(int p_Fd, std::string& p_Payload)
+{
+  uint32_t size = 0;
+  if (!ReadAll(p_Fd, reinterpret_cast<char*>(&size), sizeof(size))) return false;
+
+  if (size > s_MaxFrameSize) return false;
+
+  p_Payload.resize(size);
+  return ReadAll(p_Fd, &p_Payload[0], size);
+}
+
+bool CoreLink::WriteFrame(int p_Fd, const std::string& p_Payload)
+{
+  const uint32_t size = p_Payload.size();
+  if (p_Payload.size() > s_MaxFrameSize) return false;
+
+  return WriteAll(p_Fd, reinterpret_cast<const char*>(&size), sizeof(size)) &&
+         WriteAll(p_Fd, p_Payload.data(), p_Payload.size());
+}
+
+std::string CoreLink::MakeFrame(FrameType p_FrameType, const std::string& p_Data)
+{
+  std::string payload;
+  payload.reserve(sizeof(int64_t) + p_Data.size());
+  MessageCodec::AppendNum(payload, p_FrameType);
+  payload.append(p_Data);
+  return payload;
+}
@@ -0,0 +1,33 @@
+// corelink.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <string>
+
+// framing of the unix socket between core daemon and attached ui clients. each frame is a 32-bit
+// payload size followed by the payload, which starts with its frame type and continues with
+// message codec fields.
+class CoreLink
+{
+public:
+  enum FrameType
+  {
+    FrameNone = 0,
+    FrameHello = 1, // daemon to client at attach: version and profiles
+    FrameSubscribe = 2, // client to daemon: profile id, answered by snapshot then deltas
+    FrameService = 3, // daemon to client: replied request id and service message
+    FrameRequest = 4, // client to daemon: profile id, request id and request
+  };
+
+  static std::string GetSocketPath();
+  static std::string GetVersion();
+  static void InitSocket(int p_Fd);
+  static bool ReadFrame(int p_Fd, std::string& p_Payload);
+  static bool WriteFrame(int p_Fd, const std::string& p_Payload);
+  static std::string MakeFrame(FrameType p_FrameType, const std::string& p_Data = std::string());
+};
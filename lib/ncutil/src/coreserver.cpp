@@ -0,0 +1,570 @@
+// coreserver.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "coreserver.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "apputil.h"
+#include "corelink.h"
+#include "log.h"
+#include "messagecache.h"
+#include "messagecodec.h"
+#include "perfstats.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+#include "trace.h"
+
+// @note: pending output per client before it is considered stuck and disconnected
+static const size_t s_MaxQueuedBytes = 256 * 1024 * 1024;
+
+// @note: interval at which detached clients are reaped while no client attaches
+static const int s_AcceptPollMs = 1000;
+
+CoreServer::CoreServer()
+{
+}
+
+CoreServer::~CoreServer()
+{
+  Stop();
+}
+
+void CoreServer::AddProtocol(std::shared_ptr<Protocol> p_Protocol)
+{
+  const std::string profileId = p_Protocol->GetProfileId();
+  m_Protocols[profileId] = p_Protocol;
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_ProfileStates[profileId];
+}
+
+std::unordered_map<std::string, std::shared_ptr<Protocol>>& CoreServer::GetProtocols()
+{
+  return m_Protocols;
+}
+
+void CoreServer::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  std::string data;
+  MessageCodec::AppendNum(data, p_ServiceMessage->requestId);
+  if (!MessageCodec::EncodeServiceMessage(p_ServiceMessage, data))
+  {
+    LOG_DEBUG("core skip service message %d", p_ServiceMessage->GetMessageType());
+    return;
+  }
+
+  // fetch chats at login like the ui does, so a first client attaching finds them in the snapshot
+  if ((p_ServiceMessage->GetMessageType() == ConnectNotifyType) &&
+      std::static_pointer_cast<ConnectNotify>(p_ServiceMessage)->success)
+  {
+    auto protocolIt = m_Protocols.find(p_ServiceMessage->profileId);
+    if ((protocolIt != m_Protocols.end()) && !protocolIt->second->HasFeature(FeatureAutoGetChatsOnLogin))
+    {
+      protocolIt->second->SendRequest(std::make_shared<GetChatsRequest>());
+    }
+  }
+
+  // encoded once, shared by all subscribed clients
+  std::shared_ptr<const std::string> frame =
+    std::make_shared<const std::string>(CoreLink::MakeFrame(CoreLink::FrameService, data));
+
+  // state update and fan-out are atomic with respect to subscribe, so snapshot and deltas do not gap
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  UpdateState(p_ServiceMessage);
+  for (auto& client : m_Clients)
+  {
+    if (client->profileIds.count(p_ServiceMessage->profileId) == 0) continue;
+
+    Enqueue(client, frame);
+  }
+}
+
+bool CoreServer::Start(const std::string& p_Path)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  if (p_Path.size() >= sizeof(addr.sun_path))
+  {
+    LOG_ERROR("core socket path too long %s", p_Path.c_str());
+    return false;
+  }
+
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, p_Path.c_str(), sizeof(addr.sun_path) - 1);
+
+  // the config dir lock is held, so an existing socket is left from a previous run
+  unlink(p_Path.c_str());
+
+  m_ListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_ListenFd == -1)
+  {
+    LOG_ERROR("core socket failed errno %d", errno);
+    return false;
+  }
+
+  CoreLink::InitSocket(m_ListenFd);
+  if ((bind(m_ListenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0) || (chmod(p_Path.c_str(), 0600) != 0) ||
+      (listen(m_ListenFd, 8) != 0) || (pipe(m_WakeFds) != 0))
+  {
+    LOG_ERROR("core listen failed %s errno %d", p_Path.c_str(), errno);
+    close(m_ListenFd);
+    m_ListenFd = -1;
+    return false;
+  }
+
+  m_Path = p_Path;
+  m_Running = true;
+  m_AcceptThread = std::thread(&CoreServer::Accept, this);
+  LOG_INFO("core listening on %s", m_Path.c_str());
+  return true;
+}
+
+void CoreServer::Run()
+{
+  AppUtil::InitTerminateHandler();
+  while (!AppUtil::IsTerminateRequested())
+  {
+    TimeUtil::Sleep(0.1);
+
+    if (AppUtil::HandleDumpRequest())
+    {
+      PerfStats::Set(PerfStats::StatHeapCacheMemory, MessageCache::GetMemoryHeapSize());
+      const std::string report = PerfStats::GetReport();
+      LOG_INFO("%s", report.c_str());
+      if (Trace::IsEnabled())
+      {
+        Trace::Dump();
+      }
+    }
+  }
+
+  LOG_INFO("core terminate requested");
+}
+
+void CoreServer::Stop()
+{
+  if (!m_Running.exchange(false)) return;
+
+  const char wake = 0;
+  if (write(m_WakeFds[1], &wake, sizeof(wake)) != sizeof(wake))
+  {
+    LOG_WARNING("core wake failed errno %d", errno);
+  }
+
+  if (m_AcceptThread.joinable())
+  {
+    m_AcceptThread.join();
+  }
+
+  ReapClients(true /* p_All */);
+
+  close(m_ListenFd);
+  close(m_WakeFds[0]);
+  close(m_WakeFds[1]);
+  m_ListenFd = -1;
+  m_WakeFds[0] = -1;
+  m_WakeFds[1] = -1;
+  unlink(m_Path.c_str());
+  LOG_INFO("core stopped");
+}
+
+void CoreServer::Accept()
+{
+  ThreadRegistry::Register("core-accept");
+
+  while (m_Running)
+  {
+    struct pollfd fds[2];
+    fds[0].fd = m_ListenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_WakeFds[0];
+    fds[1].events = POLLIN;
+    const int rv = poll(fds, 2, s_AcceptPollMs);
+
+    ReapClients(false /* p_All */);
+
+    if (!m_Running) break;
+
+    if ((rv <= 0) || !(fds[0].revents & POLLIN)) continue;
+
+    const int fd = accept(m_ListenFd, nullptr, nullptr);
+    if (fd == -1)
+    {
+      LOG_WARNING("core accept failed errno %d", errno);
+      continue;
+    }
+
+    CoreLink::InitSocket(fd);
+    std::shared_ptr<Client> client = std::make_shared<Client>();
+    client->fd = fd;
+    Enqueue(client, std::make_shared<const std::string>(CoreLink::MakeFrame(CoreLink::FrameHello, GetHello())));
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Clients.push_back(client);
+      LOG_INFO("core client attached, %d clients", m_Clients.size());
+    }
+
+    client->writeThread = std::thread(&CoreServer::Write, this, client);
+    client->readThread = std::thread(&CoreServer::Read, this, client);
+  }
+}
+
+void CoreServer::Read(std::shared_ptr<Client> p_Client)
+{
+  ThreadRegistry::Register("core-read");
+
+  std::string payload;
+  while (CoreLink::ReadFrame(p_Client->fd, payload))
+  {
+    MessageCodec::Reader reader(payload);
+    const CoreLink::FrameType frameType = (CoreLink::FrameType)reader.Num();
+    const std::string profileId = reader.Str();
+    if (!reader.Ok())
+    {
+      LOG_WARNING("core invalid frame");
+      break;
+    }
+
+    if (frameType == CoreLink::FrameSubscribe)
+    {
+      Subscribe(p_Client, profileId);
+    }
+    else if (frameType == CoreLink::FrameRequest)
+    {
+      // protocols are not added after start, so lookup needs no lock
+      auto protocolIt = m_Protocols.find(profileId);
+      const int64_t requestId = reader.Num();
+      std::shared_ptr<RequestMessage> request = MessageCodec::DecodeRequest(reader.Str());
+      if ((protocolIt != m_Protocols.end()) && request && reader.Ok())
+      {
+        request->requestId = requestId;
+        protocolIt->second->SendRequest(request);
+      }
+      else
+      {
+        LOG_WARNING("core invalid request for %s", profileId.c_str());
+      }
+    }
+    else
+    {
+      LOG_WARNING("core unexpected frame %d", frameType);
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    p_Client->profileIds.clear();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(p_Client->mutex);
+    p_Client->running = false;
+    p_Client->frames.clear();
+  }
+
+  p_Client->condVar.notify_one();
+  shutdown(p_Client->fd, SHUT_RDWR);
+  p_Client->isClosed = true;
+  LOG_INFO("core client detached");
+}
+
+void CoreServer::Write(std::shared_ptr<Client> p_Client)
+{
+  ThreadRegistry::Register("core-write");
+
+  while (true)
+  {
+    std::shared_ptr<const std::string> frame;
+    {
+      std::unique_lock<std::mutex> lock(p_Client->mutex);
+      p_Client->condVar.wait(lock, [&]() { return !p_Client->running || !p_Client->frames.empty(); });
+      if (!p_Client->running) break;
+
+      frame = p_Client->frames.front();
+      p_Client->frames.pop_front();
+      p_Client->queuedBytes -= frame->size();
+    }
+
+    if (!CoreLink::WriteFrame(p_Client->fd, *frame))
+    {
+      // wakes the reader, which completes the detach
+      shutdown(p_Client->fd, SHUT_RDWR);
+      break;
+    }
+  }
+}
+
+void CoreServer::Enqueue(std::shared_ptr<Client> p_Client, std::shared_ptr<const std::string> p_Frame)
+{
+  {
+    std::unique_lock<std::mutex> lock(p_Client->mutex);
+    if (!p_Client->running) return;
+
+    if ((p_Client->queuedBytes + p_Frame->size()) > s_MaxQueuedBytes)
+    {
+      // a stuck client must not hold back protocols or other clients, it may simply attach again
+      LOG_WARNING("core client not keeping up, disconnecting");
+      p_Client->running = false;
+      p_Client->frames.clear();
+      shutdown(p_Client->fd, SHUT_RDWR);
+    }
+    else
+    {
+      p_Client->frames.push_back(p_Frame);
+      p_Client->queuedBytes += p_Frame->size();
+    }
+  }
+
+  p_Client->condVar.notify_one();
+}
+
+void CoreServer::Subscribe(std::shared_ptr<Client> p_Client, const std::string& p_ProfileId)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  auto stateIt = m_ProfileStates.find(p_ProfileId);
+  if (stateIt == m_ProfileStates.end())
+  {
+    LOG_WARNING("core subscribe unknown profile %s", p_ProfileId.c_str());
+    return;
+  }
+
+  if (!p_Client->profileIds.insert(p_ProfileId).second) return;
+
+  // snapshot in the order a protocol reports at login, later deltas apply on top of it
+  const ProfileState& profileState = stateIt->second;
+  std::vector<std::shared_ptr<ServiceMessage>> serviceMessages;
+  if (profileState.isConnected)
+  {
+    std::shared_ptr<ConnectNotify> connectNotify = std::make_shared<ConnectNotify>(p_ProfileId);
+    connectNotify->success = true;
+    serviceMessages.push_back(connectNotify);
+  }
+
+  if (!profileState.contactInfos.empty())
+  {
+    std::shared_ptr<NewContactsNotify> newContactsNotify = std::make_shared<NewContactsNotify>(p_ProfileId);
+    for (const auto& contactInfo : profileState.contactInfos)
+    {
+      newContactsNotify->contactInfos.push_back(contactInfo.second);
+    }
+
+    serviceMessages.push_back(newContactsNotify);
+  }
+
+  if (!profileState.chatInfos.empty())
+  {
+    std::shared_ptr<NewChatsNotify> newChatsNotify = std::make_shared<NewChatsNotify>(p_ProfileId);
+    newChatsNotify->success = true;
+    for (const auto& chatInfo : profileState.chatInfos)
+    {
+      newChatsNotify->chatInfos.push_back(chatInfo.second);
+    }
+
+    serviceMessages.push_back(newChatsNotify);
+  }
+
+  for (const auto& userStatus : profileState.userStatuses)
+  {
+    std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify = std::make_shared<ReceiveStatusNotify>(p_ProfileId);
+    receiveStatusNotify->userId = userStatus.first;
+    receiveStatusNotify->isOnline = userStatus.second.first;
+    receiveStatusNotify->timeSeen = userStatus.second.second;
+    serviceMessages.push_back(receiveStatusNotify);
+  }
+
+  for (const auto& serviceMessage : serviceMessages)
+  {
+    std::string data;
+    MessageCodec::AppendNum(data, 0); // snapshot replies to no request
+    MessageCodec::EncodeServiceMessage(serviceMessage, data);
+    Enqueue(p_Client, std::make_shared<const std::string>(CoreLink::MakeFrame(CoreLink::FrameService, data)));
+  }
+
+  LOG_INFO("core client subscribed %s, contacts %d chats %d", p_ProfileId.c_str(),
+           profileState.contactInfos.size(), profileState.chatInfos.size());
+}
+
+void CoreServer::UpdateState(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  auto stateIt = m_ProfileStates.find(p_ServiceMessage->profileId);
+  if (stateIt == m_ProfileStates.end()) return;
+
+  ProfileState& profileState = stateIt->second;
+  switch (p_ServiceMessage->GetMessageType())
+  {
+    case ConnectNotifyType:
+      {
+        std::shared_ptr<ConnectNotify> notify = std::static_pointer_cast<ConnectNotify>(p_ServiceMessage);
+        profileState.isConnected = notify->success;
+      }
+      break;
+
+    case NewContactsNotifyType:
+      {
+        std::shared_ptr<NewContactsNotify> notify = std::static_pointer_cast<NewContactsNotify>(p_ServiceMessage);
+        for (const auto& contactInfo : notify->contactInfos)
+        {
+          profileState.contactInfos[contactInfo.id] = contactInfo;
+        }
+      }
+      break;
+
+    case NewChatsNotifyType:
+      {
+        std::shared_ptr<NewChatsNotify> notify = std::static_pointer_cast<NewChatsNotify>(p_ServiceMessage);
+        if (!notify->success) break;
+
+        for (const auto& chatInfo : notify->chatInfos)
+        {
+          profileState.chatInfos[chatInfo.id] = chatInfo;
+        }
+      }
+      break;
+
+    case CreateChatNotifyType:
+      {
+        std::shared_ptr<CreateChatNotify> notify = std::static_pointer_cast<CreateChatNotify>(p_ServiceMessage);
+        if (!notify->success) break;
+
+        profileState.chatInfos[notify->chatInfo.id] = notify->chatInfo;
+      }
+      break;
+
+    case DeleteChatNotifyType:
+      {
+        std::shared_ptr<DeleteChatNotify> notify = std::static_pointer_cast<DeleteChatNotify>(p_ServiceMessage);
+        if (!notify->success) break;
+
+        profileState.chatInfos.erase(notify->chatId);
+      }
+      break;
+
+    case UpdateMuteNotifyType:
+      {
+        std::shared_ptr<UpdateMuteNotify> notify = std::static_pointer_cast<UpdateMuteNotify>(p_ServiceMessage);
+        auto chatIt = profileState.chatInfos.find(notify->chatId);
+        if (!notify->success || (chatIt == profileState.chatInfos.end())) break;
+
+        chatIt->second.isMuted = notify->isMuted;
+      }
+      break;
+
+    case NewMessagesNotifyType:
+      {
+        // keeps chat order and unread state current, messages themselves are served from cache
+        std::shared_ptr<NewMessagesNotify> notify = std::static_pointer_cast<NewMessagesNotify>(p_ServiceMessage);
+        auto chatIt = profileState.chatInfos.find(notify->chatId);
+        if (!notify->success || (chatIt == profileState.chatInfos.end())) break;
+
+        for (const auto& chatMessage : notify->chatMessages)
+        {
+          if (chatMessage.timeSent <= chatIt->second.lastMessageTime) continue;
+
+          chatIt->second.lastMessageTime = chatMessage.timeSent;
+          chatIt->second.isUnread = !chatMessage.isOutgoing && !chatMessage.isRead;
+        }
+      }
+      break;
+
+    case MarkMessageReadNotifyType:
+    case MarkMessagesReadNotifyType:
+      {
+        // clients mark the newest message read when viewing a chat
+        bool success = false;
+        std::string chatId;
+        if (p_ServiceMessage->GetMessageType() == MarkMessageReadNotifyType)
+        {
+          std::shared_ptr<MarkMessageReadNotify> notify =
+            std::static_pointer_cast<MarkMessageReadNotify>(p_ServiceMessage);
+          success = notify->success;
+          chatId = notify->chatId;
+        }
+        else
+        {
+          std::shared_ptr<MarkMessagesReadNotify> notify =
+            std::static_pointer_cast<MarkMessagesReadNotify>(p_ServiceMessage);
+          success = notify->success;
+          chatId = notify->chatId;
+        }
+
+        auto chatIt = profileState.chatInfos.find(chatId);
+        if (!success || (chatIt == profileState.chatInfos.end())) break;
+
+        chatIt->second.isUnread = false;
+        chatIt->second.isUnreadMention = false;
+      }
+      break;
+
+    case ReceiveStatusNotifyType:
+      {
+        std::shared_ptr<ReceiveStatusNotify> notify = std::static_pointer_cast<ReceiveStatusNotify>(p_ServiceMessage);
+        profileState.userStatuses[notify->userId] = std::make_pair(notify->isOnline, notify->timeSeen);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void CoreServer::ReapClients(bool p_All)
+{
+  std::vector<std::shared_ptr<Client>> clients;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    // *INDENT-OFF*
+    auto reapIt = std::stable_partition(m_Clients.begin(), m_Clients.end(),
+                                        [&](const std::shared_ptr<Client>& p_Client)
+    {
+      return !p_All && !p_Client->isClosed;
+    });
+    // *INDENT-ON*
+    clients.assign(reapIt, m_Clients.end());
+    m_Clients.erase(reapIt, m_Clients.end());
+  }
+
+  for (auto& client : clients)
+  {
+    shutdown(client->fd, SHUT_RDWR);
+    client->readThread.join();
+    client->writeThread.join();
+    close(client->fd);
+  }
+}
+
+std::string CoreServer::GetHello()
+{
+  std::string data;
+  MessageCodec::AppendStr(data, CoreLink::GetVersion());
+  MessageCodec::AppendNum(data, m_Protocols.size());
+  for (const auto& protocol : m_Protocols)
+  {
+    int64_t features = FeatureNone;
+    for (int bit = 0; bit < 31; ++bit)
+    {
+      const ProtocolFeature feature = (ProtocolFeature)(1 << bit);
+      if (protocol.second->HasFeature(feature))
+      {
+        features |= feature;
+      }
+    }
+
+    MessageCodec::AppendStr(data, protocol.first);
+    MessageCodec::AppendStr(data, protocol.second->GetProfileDisplayName());
+    MessageCodec::AppendNum(data, features);
+  }
+
+  return data;
+}
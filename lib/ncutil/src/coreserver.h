@@ -0,0 +1,87 @@
+// coreserver.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "protocol.h"
+
+// core daemon side of the unix socket, owns the protocols while ui clients attach and detach.
+// tracks connection state, contacts, chats and user status per profile from the service messages,
+// so an attaching client gets a snapshot first and then the same deltas as other clients. clients
+// are written to by their own thread, a client not keeping up is disconnected.
+class CoreServer
+{
+public:
+  CoreServer();
+  ~CoreServer();
+
+  void AddProtocol(std::shared_ptr<Protocol> p_Protocol);
+  std::unordered_map<std::string, std::shared_ptr<Protocol>>& GetProtocols();
+  void MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
+
+  bool Start(const std::string& p_Path);
+  void Run();
+  void Stop();
+
+private:
+  struct ProfileState
+  {
+    bool isConnected = false;
+    std::map<std::string, ContactInfo> contactInfos;
+    std::map<std::string, ChatInfo> chatInfos;
+    std::map<std::string, std::pair<bool, int64_t>> userStatuses; // online and time seen
+  };
+
+  struct Client
+  {
+    int fd = -1;
+    std::thread readThread;
+    std::thread writeThread;
+    std::set<std::string> profileIds; // subscribed, guarded by server mutex
+    std::atomic<bool> isClosed{ false };
+
+    std::mutex mutex;
+    std::condition_variable condVar;
+    std::deque<std::shared_ptr<const std::string>> frames;
+    size_t queuedBytes = 0;
+    bool running = true;
+  };
+
+  void Accept();
+  void Read(std::shared_ptr<Client> p_Client);
+  void Write(std::shared_ptr<Client> p_Client);
+  void Enqueue(std::shared_ptr<Client> p_Client, std::shared_ptr<const std::string> p_Frame);
+  void Subscribe(std::shared_ptr<Client> p_Client, const std::string& p_ProfileId);
+  void UpdateState(std::shared_ptr<ServiceMessage> p_ServiceMessage);
+  void ReapClients(bool p_All);
+  std::string GetHello();
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<Protocol>> m_Protocols;
+  std::string m_Path;
+  int m_ListenFd = -1;
+  int m_WakeFds[2] = { -1, -1 };
+  std::thread m_AcceptThread;
+  std::atomic<bool> m_Running{ false };
+
+  std::mutex m_Mutex;
+  std::unordered_map<std::string, ProfileState> m_ProfileStates;
+  std::vector<std::shared_ptr<Client>> m_Clients;
+};
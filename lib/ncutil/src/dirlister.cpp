@@ -0,0 +1,146 @@
+// dirlister.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "dirlister.h"
+
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "log.h"
+#include "threadregistry.h"
+
+const size_t DirLister::s_BatchSize = 500;
+
+std::mutex DirLister::s_CacheMutex;
+LruCache<std::string, DirLister::Listing> DirLister::s_Cache(200000); // total entries cached
+
+DirLister::DirLister()
+{
+}
+
+DirLister::~DirLister()
+{
+  Cancel();
+}
+
+void DirLister::Start(const std::string& p_Dir)
+{
+  Cancel();
+
+  const int64_t modTime = GetModTime(p_Dir);
+  Listing listing;
+  bool isCached = false;
+  {
+    std::unique_lock<std::mutex> lock(s_CacheMutex);
+    isCached = s_Cache.Get(p_Dir, listing) && (listing.modTime == modTime);
+  }
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_PendingDirEntrys.clear();
+  m_DonePolled = false;
+  if (isCached)
+  {
+    LOG_TRACE("list dir %s cached", p_Dir.c_str());
+    m_PendingDirEntrys.swap(listing.dirEntrys);
+    m_Done = true;
+    return;
+  }
+
+  m_Done = false;
+  m_Thread = std::thread(&DirLister::Run, this, (uint64_t)m_Generation, p_Dir, modTime);
+}
+
+void DirLister::Cancel()
+{
+  ++m_Generation;
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+// appends entries listed since previous poll, returns true if any were added or listing completed
+bool DirLister::Poll(std::vector<DirEntry>& p_DirEntrys, bool& p_Done)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_PendingDirEntrys.empty() && (!m_Done || m_DonePolled)) return false;
+
+  p_DirEntrys.insert(p_DirEntrys.end(), m_PendingDirEntrys.begin(), m_PendingDirEntrys.end());
+  m_PendingDirEntrys.clear();
+  p_Done = m_Done;
+  m_DonePolled = m_Done;
+  return true;
+}
+
+void DirLister::Run(uint64_t p_Generation, std::string p_Dir, int64_t p_ModTime)
+{
+  ThreadRegistry::Register("dir-lister");
+
+  LOG_TRACE("list dir %s start", p_Dir.c_str());
+  Listing listing;
+  listing.modTime = p_ModTime;
+  std::vector<DirEntry> batch;
+  DIR* dir = opendir(p_Dir.c_str());
+  if (dir != nullptr)
+  {
+    // single stat per entry, relative to the open directory
+    const int fd = dirfd(dir);
+    for (dirent* ent = readdir(dir); ent != nullptr; ent = readdir(dir))
+    {
+      if (m_Generation != p_Generation) break;
+
+      if ((strcmp(ent->d_name, ".") == 0) || (strcmp(ent->d_name, "..") == 0)) continue;
+
+      struct stat st;
+      const bool isStat = (fstatat(fd, ent->d_name, &st, 0) == 0);
+      const ssize_t size = (isStat && S_ISDIR(st.st_mode)) ? -1 : (isStat ? st.st_size : 0);
+      batch.push_back(DirEntry(ent->d_name, size));
+      if (batch.size() >= s_BatchSize)
+      {
+        listing.dirEntrys.insert(listing.dirEntrys.end(), batch.begin(), batch.end());
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_PendingDirEntrys.insert(m_PendingDirEntrys.end(), batch.begin(), batch.end());
+        batch.clear();
+      }
+    }
+
+    closedir(dir);
+  }
+
+  if (m_Generation != p_Generation)
+  {
+    LOG_TRACE("list dir %s cancelled", p_Dir.c_str());
+    return;
+  }
+
+  listing.dirEntrys.insert(listing.dirEntrys.end(), batch.begin(), batch.end());
+  LOG_TRACE("list dir %s done %d", p_Dir.c_str(), (int)listing.dirEntrys.size());
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_PendingDirEntrys.insert(m_PendingDirEntrys.end(), batch.begin(), batch.end());
+    m_Done = true;
+  }
+
+  std::unique_lock<std::mutex> lock(s_CacheMutex);
+  const size_t size = listing.dirEntrys.size() + 1;
+  s_Cache.Put(p_Dir, listing, size);
+}
+
+int64_t DirLister::GetModTime(const std::string& p_Dir)
+{
+  struct stat st;
+  if (stat(p_Dir.c_str(), &st) != 0) return -1;
+
+#if defined(__APPLE__)
+  return ((int64_t)st.st_mtimespec.tv_sec * 1000000000LL) + st.st_mtimespec.tv_nsec;
+#else
+  return ((int64_t)st.st_mtim.tv_sec * 1000000000LL) + st.st_mtim.tv_nsec;
+#endif
+}
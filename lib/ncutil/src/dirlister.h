@@ -0,0 +1,55 @@
+// dirlister.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fileutil.h"
+#include "lrucache.h"
+
+// directory listing on a worker thread, delivering entries in batches, with a cache of recent listings
+class DirLister
+{
+public:
+  DirLister();
+  ~DirLister();
+
+  void Start(const std::string& p_Dir);
+  void Cancel();
+  bool Poll(std::vector<DirEntry>& p_DirEntrys, bool& p_Done);
+
+private:
+  struct Listing
+  {
+    int64_t modTime = 0;
+    std::vector<DirEntry> dirEntrys;
+  };
+
+  void Run(uint64_t p_Generation, std::string p_Dir, int64_t p_ModTime);
+  static int64_t GetModTime(const std::string& p_Dir);
+
+private:
+  static const size_t s_BatchSize;
+
+  std::thread m_Thread;
+  std::atomic<uint64_t> m_Generation{ 0 };
+
+  std::mutex m_Mutex;
+  std::vector<DirEntry> m_PendingDirEntrys; // listed but not yet polled
+  bool m_Done = true;
+  bool m_DonePolled = true;
+
+  // @note: cache is shared by all listers, keyed by directory and validated by its modification time
+  static std::mutex s_CacheMutex;
+  static LruCache<std::string, Listing> s_Cache;
+};
@@ -0,0 +1,218 @@
+// downloadscheduler.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "downloadscheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "appconfig.h"
+#include "log.h"
+#include "perfstats.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+
+std::mutex DownloadScheduler::s_SlotMutex;
+std::condition_variable DownloadScheduler::s_SlotCondVar;
+int DownloadScheduler::s_SlotsMax = 1;
+int DownloadScheduler::s_SlotsUsed = 0;
+
+void DownloadScheduler::Init()
+{
+  const int concurrency = std::max(AppConfig::GetNum("attachment_download_concurrency"), 1);
+  m_MaxRateBytes = std::max(AppConfig::GetNum("attachment_download_max_rate_kb"), 0) * 1024LL;
+  m_RateBudgetBytes = m_MaxRateBytes;
+  m_RateBudgetTime = TimeUtil::GetCurrentTimeMSec();
+  LOG_DEBUG("download concurrency %d max rate %lld", concurrency, (long long)m_MaxRateBytes);
+
+  {
+    std::unique_lock<std::mutex> lock(s_SlotMutex);
+    s_SlotsMax = concurrency;
+  }
+
+  m_Running = true;
+
+  // @note: one extra thread is reserved for user-initiated downloads, so they never queue behind prefetch
+  m_Threads.emplace_back(&DownloadScheduler::Process, this, true);
+  for (int i = 0; i < concurrency; ++i)
+  {
+    m_Threads.emplace_back(&DownloadScheduler::Process, this, false);
+  }
+}
+
+void DownloadScheduler::Cleanup()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+    m_CondVar.notify_all();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(s_SlotMutex);
+    s_SlotCondVar.notify_all();
+  }
+
+  for (auto& thread : m_Threads)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+
+  m_Threads.clear();
+  for (auto& queue : m_Queues)
+  {
+    queue.clear();
+  }
+}
+
+void DownloadScheduler::Enqueue(const std::string& p_ChatId, DownloadFilePriority p_Priority, const Job& p_Job,
+                                const CancelHandler& p_CancelHandler)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Queues[p_Priority].push_back(Entry{ p_ChatId, p_Priority, p_Job, p_CancelHandler });
+  m_CondVar.notify_all();
+}
+
+void DownloadScheduler::SetCurrentChat(const std::string& p_ChatId)
+{
+  // queued background downloads for other chats are cancelled when leaving a chat
+  std::vector<CancelHandler> cancelHandlers;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_CurrentChatId = p_ChatId;
+    for (int priority = DownloadFilePriorityPrefetch; priority < DownloadFilePriorityUser; ++priority)
+    {
+      std::deque<Entry>& queue = m_Queues[priority];
+      for (auto it = queue.begin(); it != queue.end(); /* incremented in loop */)
+      {
+        if (it->chatId != p_ChatId)
+        {
+          cancelHandlers.push_back(std::move(it->cancelHandler));
+          it = queue.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+  }
+
+  if (!cancelHandlers.empty())
+  {
+    LOG_DEBUG("download cancel %d queued", (int)cancelHandlers.size());
+  }
+
+  for (auto& cancelHandler : cancelHandlers)
+  {
+    if (cancelHandler)
+    {
+      cancelHandler();
+    }
+  }
+}
+
+void DownloadScheduler::Process(bool p_UserOnly)
+{
+  ThreadRegistry::Register(p_UserOnly ? "download-user" : "download");
+
+  while (true)
+  {
+    Entry entry;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      if (!Dequeue(p_UserOnly, lock, entry)) return;
+    }
+
+    // user-initiated downloads do not wait for a slot
+    const bool isBackground = (entry.priority != DownloadFilePriorityUser);
+    if (isBackground && !AcquireSlot()) return;
+
+    const int64_t bytes = entry.job ? entry.job() : 0;
+    PerfStats::Add(PerfStats::StatDownloadedBytes, bytes);
+
+    if (isBackground)
+    {
+      ReleaseSlot();
+    }
+
+    if (m_MaxRateBytes > 0)
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_RateBudgetBytes -= bytes;
+    }
+  }
+}
+
+bool DownloadScheduler::Dequeue(bool p_UserOnly, std::unique_lock<std::mutex>& p_Lock, Entry& p_Entry)
+{
+  while (m_Running)
+  {
+    // user-initiated downloads are not subject to rate limiting
+    std::deque<Entry>& userQueue = m_Queues[DownloadFilePriorityUser];
+    if (!userQueue.empty())
+    {
+      p_Entry = std::move(userQueue.front());
+      userQueue.pop_front();
+      return true;
+    }
+
+    if (!p_UserOnly && (!m_Queues[DownloadFilePriorityVisible].empty() ||
+                        !m_Queues[DownloadFilePriorityPrefetch].empty()))
+    {
+      int64_t waitMs = 0;
+      if (m_MaxRateBytes > 0)
+      {
+        // token bucket refilled at max rate, allowing bursts of one second
+        const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+        m_RateBudgetBytes = std::min(m_RateBudgetBytes + (((nowTime - m_RateBudgetTime) * m_MaxRateBytes) / 1000),
+                                     m_MaxRateBytes);
+        m_RateBudgetTime = nowTime;
+        if (m_RateBudgetBytes < 0)
+        {
+          waitMs = std::max(((-m_RateBudgetBytes * 1000) / m_MaxRateBytes), (int64_t)1);
+        }
+      }
+
+      if (waitMs == 0)
+      {
+        std::deque<Entry>& queue = !m_Queues[DownloadFilePriorityVisible].empty()
+          ? m_Queues[DownloadFilePriorityVisible] : m_Queues[DownloadFilePriorityPrefetch];
+        p_Entry = std::move(queue.front());
+        queue.pop_front();
+        return true;
+      }
+
+      m_CondVar.wait_for(p_Lock, std::chrono::milliseconds(waitMs));
+      continue;
+    }
+
+    m_CondVar.wait(p_Lock);
+  }
+
+  return false;
+}
+
+bool DownloadScheduler::AcquireSlot()
+{
+  std::unique_lock<std::mutex> lock(s_SlotMutex);
+  s_SlotCondVar.wait(lock, [&]() { return !m_Running || (s_SlotsUsed < s_SlotsMax); });
+  if (!m_Running) return false;
+
+  ++s_SlotsUsed;
+  return true;
+}
+
+void DownloadScheduler::ReleaseSlot()
+{
+  std::unique_lock<std::mutex> lock(s_SlotMutex);
+  --s_SlotsUsed;
+  s_SlotCondVar.notify_all();
+}
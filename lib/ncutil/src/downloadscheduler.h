@@ -0,0 +1,68 @@
+// downloadscheduler.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "protocol.h"
+
+// attachment download scheduler with priority lanes, used by protocols to run blocking download jobs
+class DownloadScheduler
+{
+public:
+  // job performs a blocking download and returns the number of bytes downloaded, zero if unknown
+  typedef std::function<int64_t()> Job;
+  // called for queued jobs that are cancelled before being started
+  typedef std::function<void()> CancelHandler;
+
+  void Init();
+  void Cleanup();
+
+  void Enqueue(const std::string& p_ChatId, DownloadFilePriority p_Priority, const Job& p_Job,
+               const CancelHandler& p_CancelHandler);
+  void SetCurrentChat(const std::string& p_ChatId);
+
+private:
+  struct Entry
+  {
+    std::string chatId;
+    DownloadFilePriority priority;
+    Job job;
+    CancelHandler cancelHandler;
+  };
+
+  void Process(bool p_UserOnly);
+  bool Dequeue(bool p_UserOnly, std::unique_lock<std::mutex>& p_Lock, Entry& p_Entry);
+  bool AcquireSlot();
+  static void ReleaseSlot();
+
+private:
+  std::atomic<bool> m_Running{ false };
+  std::vector<std::thread> m_Threads;
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  std::deque<Entry> m_Queues[DownloadFilePriorityCount];
+  std::string m_CurrentChatId;
+  int64_t m_MaxRateBytes = 0;
+  int64_t m_RateBudgetBytes = 0;
+  int64_t m_RateBudgetTime = 0;
+
+  // @note: slots are shared by all scheduler instances, bounding background downloads across protocols
+  static std::mutex s_SlotMutex;
+  static std::condition_variable s_SlotCondVar;
+  static int s_SlotsMax;
+  static int s_SlotsUsed;
+};
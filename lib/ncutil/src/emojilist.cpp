@@ -7,6 +7,7 @@
 
 #include "emojilist.h"
 
+#include <algorithm>
 #include <map>
 #include <utility>
 
@@ -15,85 +16,233 @@
 #include "log.h"
 #include "emojiutil.h"
 #include "fileutil.h"
+#include "sqlitehelp.h"
+#include "strutil.h"
 
 std::mutex EmojiList::m_Mutex;
-std::unique_ptr<sqlite::database> EmojiList::m_Db;
+std::thread EmojiList::m_Thread;
+std::thread EmojiList::m_FlushThread;
+std::mutex EmojiList::m_DbMutex;
+std::atomic<bool> EmojiList::m_LoadStarted(false);
+bool EmojiList::m_Loaded = false;
+bool EmojiList::m_Sorted = false;
+std::vector<EmojiList::Emoji> EmojiList::m_Emojis;
+std::map<std::string, int> EmojiList::m_PendingUsages;
+std::string EmojiList::m_LastFilter;
+std::vector<size_t> EmojiList::m_LastMatches;
+
+// usage updates are written to db in batches
+static const int s_UsageFlushCount = 10;
 
 void EmojiList::Init()
 {
+  // @note: db is opened on first use, or in background after first frame
   std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Loaded = false;
+  m_Emojis.clear();
+  m_PendingUsages.clear();
+  m_LastMatches.clear();
+}
 
-  static const int dirVersion = 2;
-  const std::string& emojisDir = FileUtil::GetApplicationDir() + "/emojis";
-  FileUtil::InitDirVersion(emojisDir, dirVersion);
+void EmojiList::Cleanup()
+{
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
 
-  const std::string& dbPath = emojisDir + "/db.sqlite";
-  m_Db.reset(new sqlite::database(dbPath));
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  FlushUsagesLocked();
+  if (m_FlushThread.joinable())
+  {
+    m_FlushThread.join();
+  }
+
+  m_Loaded = false;
+  m_Emojis.clear();
+  m_LastMatches.clear();
+  m_LoadStarted = false;
+}
 
-  if (!m_Db) return;
+void EmojiList::StartLoad()
+{
+  if (m_LoadStarted.exchange(true)) return;
+
+  m_Thread = std::thread(&EmojiList::Load);
+}
 
-  *m_Db << "PRAGMA synchronous = OFF";
-  *m_Db << "PRAGMA journal_mode = MEMORY";
+std::vector<std::pair<std::string, std::string>> EmojiList::Get(const std::string& p_Filter)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  LoadLocked();
 
-  // create table if not exists
-  *m_Db << "CREATE TABLE IF NOT EXISTS emojis (name TEXT PRIMARY KEY NOT NULL, emoji TEXT, usages INT);";
+  if (!m_Sorted)
+  {
+    // *INDENT-OFF*
+    std::sort(m_Emojis.begin(), m_Emojis.end(), [](const Emoji& p_Lhs, const Emoji& p_Rhs)
+    {
+      return (p_Lhs.usages != p_Rhs.usages) ? (p_Lhs.usages > p_Rhs.usages) : (p_Lhs.name < p_Rhs.name);
+    });
+    // *INDENT-ON*
+    m_Sorted = true;
+    m_LastMatches.clear();
+  }
 
-  // populate table if empty
-  int rowCount = 0;
-  *m_Db << "SELECT COUNT(emoji) FROM emojis;" >> rowCount;
-  if (rowCount == 0)
+  // case-insensitive substring match, like sql LIKE. a filter extending the previous one only
+  // needs to search the previous matches, which is the common case while typing.
+  const std::string filter = StrUtil::ToLower(p_Filter);
+  std::vector<size_t> matches;
+  const bool narrowing = !m_LastMatches.empty() && (filter.compare(0, m_LastFilter.size(), m_LastFilter) == 0);
+  const size_t count = narrowing ? m_LastMatches.size() : m_Emojis.size();
+  matches.reserve(count);
+  for (size_t i = 0; i < count; ++i)
   {
-    LOG_DEBUG("populate emoji db");
-    *m_Db << "BEGIN;";
-    const std::set<std::string>& emojiView = EmojiUtil::GetView();
-    const std::map<std::string, std::string>& emojiMap = EmojiUtil::GetMap();
-    for (const auto& emoji : emojiMap)
+    const size_t index = narrowing ? m_LastMatches[i] : i;
+    if (filter.empty() || (m_Emojis[index].lowerName.find(filter) != std::string::npos))
     {
-      if (emojiView.count(emoji.first))
-      {
-        *m_Db << "INSERT INTO emojis (name, emoji, usages) VALUES (?,?,0);" << emoji.first << emoji.second;
-      }
+      matches.push_back(index);
     }
-    *m_Db << "COMMIT;";
   }
+
+  std::vector<std::pair<std::string, std::string>> emojis;
+  emojis.reserve(matches.size());
+  for (const size_t index : matches)
+  {
+    emojis.push_back(std::make_pair(m_Emojis[index].name, m_Emojis[index].emoji));
+  }
+
+  m_LastFilter = filter;
+  m_LastMatches.swap(matches);
+  return emojis;
 }
 
-void EmojiList::Cleanup()
+void EmojiList::AddUsage(const std::string& p_Name)
 {
   std::unique_lock<std::mutex> lock(m_Mutex);
+  LoadLocked();
 
-  if (!m_Db) return;
+  for (auto& emoji : m_Emojis)
+  {
+    if (emoji.name == p_Name)
+    {
+      ++emoji.usages;
+      m_Sorted = false;
+      m_LastMatches.clear();
+      break;
+    }
+  }
 
-  m_Db.reset();
+  if (++m_PendingUsages[p_Name] >= s_UsageFlushCount)
+  {
+    FlushUsagesLocked();
+  }
 }
 
-std::vector<std::pair<std::string, std::string>> EmojiList::Get(const std::string& p_Filter)
+void EmojiList::Load()
 {
   std::unique_lock<std::mutex> lock(m_Mutex);
+  LoadLocked();
+}
 
-  if (!m_Db) return std::vector<std::pair<std::string, std::string>>();
+// must be called with lock held
+void EmojiList::LoadLocked()
+{
+  if (m_Loaded) return;
 
-  std::vector<std::pair<std::string, std::string>> emojis;
-  if (p_Filter.empty())
+  m_Loaded = true;
+  std::unique_lock<std::mutex> dbLock(m_DbMutex);
+  try
   {
-    *m_Db << "SELECT name, emoji FROM emojis ORDER BY usages DESC, name ASC;" >>
-      [&](const std::string& name, const std::string& emoji) { emojis.push_back(std::make_pair(name, emoji)); };
+    // db is only kept open while loading and flushing usages
+    sqlite::database db(GetDbPath());
+    db << "PRAGMA synchronous = OFF";
+    db << "PRAGMA journal_mode = MEMORY";
+
+    // create table if not exists
+    db << "CREATE TABLE IF NOT EXISTS emojis (name TEXT PRIMARY KEY NOT NULL, emoji TEXT, usages INT);";
+
+    // populate table if empty
+    int rowCount = 0;
+    db << "SELECT COUNT(emoji) FROM emojis;" >> rowCount;
+    if (rowCount == 0)
+    {
+      LOG_DEBUG("populate emoji db");
+      db << "BEGIN;";
+      const std::set<std::string>& emojiView = EmojiUtil::GetView();
+      const std::map<std::string, std::string>& emojiMap = EmojiUtil::GetMap();
+      for (const auto& emoji : emojiMap)
+      {
+        if (emojiView.count(emoji.first))
+        {
+          db << "INSERT INTO emojis (name, emoji, usages) VALUES (?,?,0);" << emoji.first << emoji.second;
+        }
+      }
+      db << "COMMIT;";
+    }
+
+    // *INDENT-OFF*
+    db << "SELECT name, emoji, usages FROM emojis ORDER BY usages DESC, name ASC;" >>
+      [&](const std::string& name, const std::string& emoji, int usages)
+      {
+        Emoji entry;
+        entry.name = name;
+        entry.emoji = emoji;
+        entry.lowerName = StrUtil::ToLower(name);
+        entry.usages = usages;
+        m_Emojis.push_back(entry);
+      };
+    // *INDENT-ON*
+    m_Sorted = true;
   }
-  else
+  catch (const sqlite::sqlite_exception& ex)
   {
-    *m_Db << "SELECT name, emoji FROM emojis WHERE name LIKE ? ORDER BY usages DESC, name ASC;" <<
-      ("%" + p_Filter + "%") >>
-      [&](const std::string& name, const std::string& emoji) { emojis.push_back(std::make_pair(name, emoji)); };
+    HANDLE_SQLITE_EXCEPTION(ex);
   }
 
-  return emojis;
+  LOG_DEBUG("loaded %d emojis", m_Emojis.size());
 }
 
-void EmojiList::AddUsage(const std::string& p_Name)
+// must be called with lock held
+void EmojiList::FlushUsagesLocked()
 {
-  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_PendingUsages.empty()) return;
 
-  if (!m_Db) return;
+  // written in background, so ui is not blocked by db
+  if (m_FlushThread.joinable())
+  {
+    m_FlushThread.join();
+  }
 
-  *m_Db << "UPDATE emojis SET usages = usages + 1 WHERE name = ?;" << p_Name;
+  std::map<std::string, int> usages;
+  usages.swap(m_PendingUsages);
+  m_FlushThread = std::thread(&EmojiList::FlushUsages, usages);
+}
+
+void EmojiList::FlushUsages(const std::map<std::string, int>& p_Usages)
+{
+  std::unique_lock<std::mutex> dbLock(m_DbMutex);
+  try
+  {
+    sqlite::database db(GetDbPath());
+    db << "PRAGMA synchronous = OFF";
+    db << "PRAGMA journal_mode = MEMORY";
+    db << "BEGIN;";
+    for (const auto& usage : p_Usages)
+    {
+      db << "UPDATE emojis SET usages = usages + ? WHERE name = ?;" << usage.second << usage.first;
+    }
+    db << "COMMIT;";
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+std::string EmojiList::GetDbPath()
+{
+  static const int dirVersion = 2;
+  const std::string& emojisDir = FileUtil::GetApplicationDir() + "/emojis";
+  FileUtil::InitDirVersion(emojisDir, dirVersion);
+  return emojisDir + "/db.sqlite";
 }
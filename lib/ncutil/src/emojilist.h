@@ -7,26 +7,49 @@
 
 #pragma once
 
-#include <memory>
+#include <atomic>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
-namespace sqlite
-{
-  class database;
-}
-
+// emoji list with usage ranking, loaded on first use or in background by StartLoad()
 class EmojiList
 {
 public:
   static void Init();
   static void Cleanup();
+  static void StartLoad();
 
   static std::vector<std::pair<std::string, std::string>> Get(const std::string& p_Filter);
   static void AddUsage(const std::string& p_Name);
 
+private:
+  struct Emoji
+  {
+    std::string name;
+    std::string emoji;
+    std::string lowerName;
+    int usages = 0;
+  };
+
+  static void Load();
+  static void LoadLocked();
+  static void FlushUsagesLocked();
+  static void FlushUsages(const std::map<std::string, int>& p_Usages);
+  static std::string GetDbPath();
+
 private:
   static std::mutex m_Mutex;
-  static std::unique_ptr<sqlite::database> m_Db;
+  static std::thread m_Thread;
+  static std::thread m_FlushThread;
+  static std::mutex m_DbMutex;
+  static std::atomic<bool> m_LoadStarted;
+  static bool m_Loaded;
+  static bool m_Sorted;
+  static std::vector<Emoji> m_Emojis;
+  static std::map<std::string, int> m_PendingUsages;
+  static std::string m_LastFilter;
+  static std::vector<size_t> m_LastMatches; // indices in m_Emojis, valid while sorted
 };
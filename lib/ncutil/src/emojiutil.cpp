@@ -7,7 +7,10 @@
 
 #include "emojiutil.h"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <vector>
 
 #include "emojiutil_map.h"
 #include "emojiutil_view.h"
@@ -15,122 +18,178 @@
 
 std::string EmojiUtil::Emojize(const std::string& p_Str, bool p_Pad)
 {
-  std::string str = p_Str;
+  static const size_t maxShortcodeLen = []()
+  {
+    size_t maxLen = 0;
+    for (auto& emojiPair : s_Map)
+    {
+      maxLen = std::max(maxLen, strlen(emojiPair.first));
+    }
+
+    return maxLen;
+  }();
+
+  // single pass into output, replaced emojis contain no colon so scanning resumes after them
+  std::string str;
+  str.reserve(p_Str.size());
   std::size_t position = 0;
   std::size_t firstColon = std::string::npos;
-  while (firstColon = str.find(":", position), firstColon != std::string::npos)
+  while (firstColon = p_Str.find(':', position), firstColon != std::string::npos)
   {
-    std::size_t secondColon = str.find(":", firstColon + 1);
-    if (secondColon != std::string::npos)
+    str.append(p_Str, position, firstColon - position);
+    std::size_t secondColon = p_Str.find(':', firstColon + 1);
+    if (secondColon == std::string::npos)
+    {
+      position = firstColon;
+      break;
+    }
+
+    const std::size_t colonStrLen = secondColon - firstColon + 1;
+    if (colonStrLen <= maxShortcodeLen)
     {
-      std::string colonStr = str.substr(firstColon, secondColon - firstColon + 1);
-      std::map<std::string, std::string>::iterator it = s_Map.find(colonStr);
-      if (it != s_Map.end())
+      const Entry* entry = FindEntry(std::begin(s_Map), std::end(s_Map), p_Str.c_str() + firstColon, colonStrLen);
+      if (entry != nullptr)
       {
-        std::string emoji = it->second + (p_Pad ? std::string(1, EMOJI_PAD) : "");
-        str.replace(firstColon, secondColon - firstColon + 1, emoji);
+        str += entry->second;
+        if (p_Pad)
+        {
+          str += EMOJI_PAD;
+        }
+
+        position = secondColon + 1;
+        continue;
       }
     }
 
+    str += ':';
     position = firstColon + 1;
   }
 
+  str.append(p_Str, position, std::string::npos);
   return str;
 }
 
 std::string EmojiUtil::Textize(const std::string& p_In)
 {
-  static const std::map<std::string, std::string> emojiToText = []()
+  // ascii chars not part of any emoji are copied without lookup
+  static const std::vector<bool> asciiInEmoji = []()
   {
-    std::map<std::string, std::string> emToText;
+    std::vector<bool> inEmoji(0x80, false);
     for (auto& emojiPair : s_Map)
     {
-      emToText[emojiPair.second] = emojiPair.first;
+      for (const char* emoji = emojiPair.second; *emoji != '\0'; ++emoji)
+      {
+        const unsigned char ch = *emoji;
+        if (ch < 0x80)
+        {
+          inEmoji[ch] = true;
+        }
+      }
     }
 
-    return emToText;
+    return inEmoji;
   }();
 
-  const bool enableDoubleMultiByteLookup = true;
+  // emojis of one char, or two chars with greedy pairing, are replaced with their shortcode
   std::string out;
-  const char* cstr = p_In.c_str();
-  size_t charlen = 0;
-  mbstate_t mbs;
-  std::string mbprev;
-
-  memset(&mbs, 0, sizeof(mbs));
-  while ((charlen = mbrlen(cstr, MB_CUR_MAX, &mbs)) != 0 &&
-         charlen != (size_t)-1 && charlen != (size_t)-2)
+  out.reserve(p_In.size());
+  const char* prev = nullptr;
+  size_t prevLen = 0;
+  auto flushPrev = [&]()
   {
-    std::string mbcur = std::string(cstr, charlen);
+    if (prev == nullptr) return;
 
-    if (enableDoubleMultiByteLookup)
+    const Entry* entry = FindEntry(std::begin(s_ReverseMap), std::end(s_ReverseMap), prev, prevLen);
+    if (entry != nullptr)
     {
-      if (!mbprev.empty())
-      {
-        std::string mbcomb = mbprev + mbcur;
-        if (emojiToText.find(mbcomb) != emojiToText.end())
-        {
-          out += emojiToText.at(mbcomb);
-          mbcur.clear();
-          mbprev.clear();
-        }
-        else
-        {
-          if (emojiToText.find(mbprev) != emojiToText.end())
-          {
-            out += emojiToText.at(mbprev);
-          }
-          else
-          {
-            out += mbprev;
-          }
-
-          mbprev.clear();
-        }
-      }
-
-      if (!mbcur.empty())
-      {
-        mbprev = mbcur;
-      }
+      out += entry->second;
     }
     else
     {
-      if (emojiToText.find(mbcur) != emojiToText.end())
-      {
-        out += emojiToText.at(mbcur);
-      }
-      else
-      {
-        out += mbcur;
-      }
+      out.append(prev, prevLen);
     }
 
-    cstr += charlen;
-  }
+    prev = nullptr;
+  };
 
-  if (enableDoubleMultiByteLookup && !mbprev.empty())
+  const char* cstr = p_In.c_str();
+  size_t charlen = 0;
+  mbstate_t mbs;
+  memset(&mbs, 0, sizeof(mbs));
+  while (true)
   {
-    if (emojiToText.find(mbprev) != emojiToText.end())
+    const unsigned char ch = *cstr;
+    if ((ch != 0) && (ch < 0x80) && !asciiInEmoji[ch])
     {
-      out += emojiToText.at(mbprev);
+      flushPrev();
+      out += (char)ch;
+      ++cstr;
+      continue;
     }
-    else
+
+    charlen = mbrlen(cstr, MB_CUR_MAX, &mbs);
+    if ((charlen == 0) || (charlen == (size_t)-1) || (charlen == (size_t)-2)) break;
+
+    if (prev != nullptr)
     {
-      out += mbprev;
+      // prev always directly precedes current char, so both form one contiguous key
+      const Entry* entry = FindEntry(std::begin(s_ReverseMap), std::end(s_ReverseMap), prev, prevLen + charlen);
+      if (entry != nullptr)
+      {
+        out += entry->second;
+        prev = nullptr;
+        cstr += charlen;
+        continue;
+      }
+
+      flushPrev();
     }
+
+    prev = cstr;
+    prevLen = charlen;
+    cstr += charlen;
   }
 
+  flushPrev();
   return out;
 }
 
 const std::map<std::string, std::string>& EmojiUtil::GetMap()
 {
-  return s_Map;
+  // only built when needed, lookups use the static tables directly
+  static const std::map<std::string, std::string> map = []()
+  {
+    std::map<std::string, std::string> emojiMap;
+    for (auto& emojiPair : s_Map)
+    {
+      emojiMap[emojiPair.first] = emojiPair.second;
+    }
+
+    return emojiMap;
+  }();
+  return map;
 }
 
 const std::set<std::string>& EmojiUtil::GetView()
 {
-  return s_View;
+  static const std::set<std::string> view(std::begin(s_View), std::end(s_View));
+  return view;
+}
+
+const EmojiUtil::Entry* EmojiUtil::FindEntry(const Entry* p_Begin, const Entry* p_End, const char* p_Key,
+                                             size_t p_KeyLen)
+{
+  // tables are sorted by strcmp order of first, p_Key is not null-terminated
+  auto compare = [&](const Entry& p_Entry) -> int
+  {
+    const int rv = strncmp(p_Entry.first, p_Key, p_KeyLen);
+    if (rv != 0) return rv;
+
+    return (p_Entry.first[p_KeyLen] == '\0') ? 0 : 1;
+  };
+
+  const Entry* it = std::lower_bound(p_Begin, p_End, 0, [&](const Entry& p_Entry, int) { return compare(p_Entry) < 0; });
+  if ((it != p_End) && (compare(*it) == 0)) return it;
+
+  return nullptr;
 }
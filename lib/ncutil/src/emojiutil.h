@@ -14,8 +14,17 @@
 class EmojiUtil
 {
 public:
+  struct Entry
+  {
+    const char* first;
+    const char* second;
+  };
+
   static std::string Emojize(const std::string& p_Str, bool p_Pad);
   static std::string Textize(const std::string& p_In);
   static const std::map<std::string, std::string>& GetMap();
   static const std::set<std::string>& GetView();
+
+private:
+  static const Entry* FindEntry(const Entry* p_Begin, const Entry* p_End, const char* p_Key, size_t p_KeyLen);
 };
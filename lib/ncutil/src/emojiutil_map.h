@@ -1,4 +1,5 @@
-static std::map<std::string, std::string> s_Map = {
+// generated shortcode to emoji table, sorted by shortcode for binary search
+static const EmojiUtil::Entry s_Map[] = {
   { ":100:", "💯" },
   { ":1234:", "🔢" },
   { ":1st_place_medal:", "🥇" },
@@ -1939,3 +1940,1946 @@ static std::map<std::string, std::string> s_Map = {
   { ":zombie:", "🧟" },
   { ":zzz:", "💤" },
 };
+
+// generated emoji to shortcode table, sorted by emoji, last shortcode in order above for aliases
+static const EmojiUtil::Entry s_ReverseMap[] = {
+  { "#️⃣", ":keycap_:" },
+  { "0️⃣", ":keycap_0:" },
+  { "1️⃣", ":keycap_1:" },
+  { "2️⃣", ":keycap_2:" },
+  { "3️⃣", ":keycap_3:" },
+  { "4️⃣", ":keycap_4:" },
+  { "5️⃣", ":keycap_5:" },
+  { "6️⃣", ":keycap_6:" },
+  { "7️⃣", ":keycap_7:" },
+  { "8️⃣", ":keycap_8:" },
+  { "9️⃣", ":keycap_9:" },
+  { "©", ":copyright:" },
+  { "®", ":registered:" },
+  { "‼", ":bangbang:" },
+  { "‼️", ":double_exclamation_mark:" },
+  { "⁉", ":interrobang:" },
+  { "⁉️", ":exclamation_question_mark:" },
+  { "™", ":tm:" },
+  { "™️", ":trade_mark:" },
+  { "ℹ", ":information_source:" },
+  { "ℹ️", ":information:" },
+  { "↔", ":left_right_arrow:" },
+  { "↕", ":arrow_up_down:" },
+  { "↕️", ":up_down_arrow:" },
+  { "↖", ":arrow_upper_left:" },
+  { "↖️", ":up_left_arrow:" },
+  { "↗", ":arrow_upper_right:" },
+  { "↗️", ":up_right_arrow:" },
+  { "↘", ":arrow_lower_right:" },
+  { "↘️", ":down_right_arrow:" },
+  { "↙", ":arrow_lower_left:" },
+  { "↙️", ":down_left_arrow:" },
+  { "↩", ":leftwards_arrow_with_hook:" },
+  { "↩️", ":right_arrow_curving_left:" },
+  { "↪", ":arrow_right_hook:" },
+  { "↪️", ":left_arrow_curving_right:" },
+  { "⌚", ":watch:" },
+  { "⌛", ":hourglass:" },
+  { "⌨", ":keyboard:" },
+  { "⎈", ":helm_symbol:" },
+  { "⏏", ":eject_symbol:" },
+  { "⏏️", ":eject_button:" },
+  { "⏩", ":fast_forward:" },
+  { "⏪", ":rewind:" },
+  { "⏫", ":arrow_double_up:" },
+  { "⏬", ":arrow_double_down:" },
+  { "⏭", ":black_right_pointing_double_triangle_with_vertical_bar:" },
+  { "⏭️", ":next_track_button:" },
+  { "⏮", ":black_left_pointing_double_triangle_with_vertical_bar:" },
+  { "⏮️", ":last_track_button:" },
+  { "⏯", ":black_right_pointing_triangle_with_double_vertical_bar:" },
+  { "⏯️", ":play_or_pause_button:" },
+  { "⏰", ":alarm_clock:" },
+  { "⏱", ":stopwatch:" },
+  { "⏲", ":timer_clock:" },
+  { "⏳", ":hourglass_flowing_sand:" },
+  { "⏸", ":double_vertical_bar:" },
+  { "⏸️", ":pause_button:" },
+  { "⏹", ":black_square_for_stop:" },
+  { "⏹️", ":stop_button:" },
+  { "⏺", ":black_circle_for_record:" },
+  { "⏺️", ":record_button:" },
+  { "Ⓜ", ":m:" },
+  { "Ⓜ️", ":circled_m:" },
+  { "▪", ":black_small_square:" },
+  { "▫", ":white_small_square:" },
+  { "▶", ":arrow_forward:" },
+  { "▶️", ":play_button:" },
+  { "◀", ":arrow_backward:" },
+  { "◀️", ":reverse_button:" },
+  { "◻", ":white_medium_square:" },
+  { "◼", ":black_medium_square:" },
+  { "◽", ":white_medium_small_square:" },
+  { "◾", ":black_medium_small_square:" },
+  { "☀", ":sunny:" },
+  { "☀️", ":sun:" },
+  { "☁", ":cloud:" },
+  { "☂", ":umbrella:" },
+  { "☃", ":snowman:" },
+  { "☄", ":comet:" },
+  { "☎", ":telephone:" },
+  { "☑", ":ballot_box_with_check:" },
+  { "☑️", ":check_box_with_check:" },
+  { "☔", ":umbrella_with_rain_drops:" },
+  { "☕", ":coffee:" },
+  { "☘", ":shamrock:" },
+  { "☝", ":point_up:" },
+  { "☝️", ":index_pointing_up:" },
+  { "☠", ":skull_and_crossbones:" },
+  { "☢", ":radioactive_sign:" },
+  { "☢️", ":radioactive:" },
+  { "☣", ":biohazard_sign:" },
+  { "☣️", ":biohazard:" },
+  { "☦", ":orthodox_cross:" },
+  { "☪", ":star_and_crescent:" },
+  { "☮", ":peace_symbol:" },
+  { "☯", ":yin_yang:" },
+  { "☸", ":wheel_of_dharma:" },
+  { "☹", ":white_frowning_face:" },
+  { "☹️", ":frowning_face:" },
+  { "☺", ":relaxed:" },
+  { "☺️", ":smiling_face:" },
+  { "♀️", ":female_sign:" },
+  { "♂️", ":male_sign:" },
+  { "♈", ":aries:" },
+  { "♉", ":taurus:" },
+  { "♊", ":gemini:" },
+  { "♋", ":cancer:" },
+  { "♌", ":leo:" },
+  { "♍", ":virgo:" },
+  { "♎", ":libra:" },
+  { "♏", ":scorpius:" },
+  { "♐", ":sagittarius:" },
+  { "♑", ":capricorn:" },
+  { "♒", ":aquarius:" },
+  { "♓", ":pisces:" },
+  { "♟️", ":chess_pawn:" },
+  { "♠", ":spades:" },
+  { "♠️", ":spade_suit:" },
+  { "♣", ":clubs:" },
+  { "♣️", ":club_suit:" },
+  { "♥", ":hearts:" },
+  { "♥️", ":heart_suit:" },
+  { "♦", ":diamonds:" },
+  { "♦️", ":diamond_suit:" },
+  { "♨", ":hotsprings:" },
+  { "♨️", ":hot_springs:" },
+  { "♻", ":recycle:" },
+  { "♻️", ":recycling_symbol:" },
+  { "♾️", ":infinity:" },
+  { "♿", ":wheelchair:" },
+  { "⚒", ":hammer_and_pick:" },
+  { "⚓", ":anchor:" },
+  { "⚔", ":crossed_swords:" },
+  { "⚕️", ":medical_symbol:" },
+  { "⚖", ":scales:" },
+  { "⚖️", ":balance_scale:" },
+  { "⚗", ":alembic:" },
+  { "⚙", ":gear:" },
+  { "⚛", ":atom_symbol:" },
+  { "⚜", ":fleur_de_lis:" },
+  { "⚠", ":warning:" },
+  { "⚡", ":zap:" },
+  { "⚧️", ":transgender_symbol:" },
+  { "⚪", ":white_circle:" },
+  { "⚫", ":black_circle:" },
+  { "⚰", ":coffin:" },
+  { "⚱", ":funeral_urn:" },
+  { "⚽", ":soccer:" },
+  { "⚾", ":baseball:" },
+  { "⛄", ":snowman_without_snow:" },
+  { "⛅", ":partly_sunny:" },
+  { "⛈", ":thunder_cloud_and_rain:" },
+  { "⛈️", ":cloud_with_lightning_and_rain:" },
+  { "⛎", ":ophiuchus:" },
+  { "⛏", ":pick:" },
+  { "⛑", ":helmet_with_white_cross:" },
+  { "⛑️", ":rescue_worker_s_helmet:" },
+  { "⛓", ":chains:" },
+  { "⛔", ":no_entry:" },
+  { "⛩", ":shinto_shrine:" },
+  { "⛪", ":church:" },
+  { "⛰", ":mountain:" },
+  { "⛱", ":umbrella_on_ground:" },
+  { "⛲", ":fountain:" },
+  { "⛳", ":golf:" },
+  { "⛴", ":ferry:" },
+  { "⛵", ":sailboat:" },
+  { "⛷", ":skier:" },
+  { "⛸", ":ice_skate:" },
+  { "⛹", ":person_with_ball:" },
+  { "⛹️", ":person_bouncing_ball:" },
+  { "⛹️‍♀️", ":woman_bouncing_ball:" },
+  { "⛹️‍♂️", ":man_bouncing_ball:" },
+  { "⛺", ":tent:" },
+  { "⛽", ":fuelpump:" },
+  { "✂", ":scissors:" },
+  { "✅", ":white_check_mark:" },
+  { "✈", ":airplane:" },
+  { "✉", ":envelope:" },
+  { "✊", ":fist:" },
+  { "✋", ":raised_hand:" },
+  { "✌", ":v:" },
+  { "✌️", ":victory_hand:" },
+  { "✍", ":writing_hand:" },
+  { "✏", ":pencil2:" },
+  { "✒", ":black_nib:" },
+  { "✔", ":heavy_check_mark:" },
+  { "✔️", ":check_mark:" },
+  { "✖", ":heavy_multiplication_x:" },
+  { "✖️", ":multiply:" },
+  { "✝", ":latin_cross:" },
+  { "✡", ":star_of_david:" },
+  { "✨", ":sparkles:" },
+  { "✳", ":eight_spoked_asterisk:" },
+  { "✴", ":eight_pointed_black_star:" },
+  { "✴️", ":eight_pointed_star:" },
+  { "❄", ":snowflake:" },
+  { "❇", ":sparkle:" },
+  { "❌", ":x:" },
+  { "❎", ":negative_squared_cross_mark:" },
+  { "❓", ":question:" },
+  { "❔", ":grey_question:" },
+  { "❕", ":grey_exclamation:" },
+  { "❗", ":heavy_exclamation_mark:" },
+  { "❣", ":heavy_heart_exclamation_mark_ornament:" },
+  { "❣️", ":heart_exclamation:" },
+  { "❤", ":heart:" },
+  { "❤️", ":red_heart:" },
+  { "❤️‍🔥", ":heart_on_fire:" },
+  { "❤️‍🩹", ":mending_heart:" },
+  { "➕", ":heavy_plus_sign:" },
+  { "➖", ":heavy_minus_sign:" },
+  { "➗", ":heavy_division_sign:" },
+  { "➡", ":arrow_right:" },
+  { "➡️", ":right_arrow:" },
+  { "➰", ":curly_loop:" },
+  { "➿", ":loop:" },
+  { "⤴", ":arrow_heading_up:" },
+  { "⤴️", ":right_arrow_curving_up:" },
+  { "⤵", ":arrow_heading_down:" },
+  { "⤵️", ":right_arrow_curving_down:" },
+  { "⬅", ":arrow_left:" },
+  { "⬅️", ":left_arrow:" },
+  { "⬆", ":arrow_up:" },
+  { "⬆️", ":up_arrow:" },
+  { "⬇", ":arrow_down:" },
+  { "⬇️", ":down_arrow:" },
+  { "⬛", ":black_large_square:" },
+  { "⬜", ":white_large_square:" },
+  { "⭐", ":star:" },
+  { "⭕", ":o:" },
+  { "〰", ":wavy_dash:" },
+  { "〽", ":part_alternation_mark:" },
+  { "㊗", ":congratulations:" },
+  { "㊗️", ":japanese_congratulations_button:" },
+  { "㊙", ":secret:" },
+  { "㊙️", ":japanese_secret_button:" },
+  { "🀄", ":mahjong:" },
+  { "🃏", ":black_joker:" },
+  { "🅰", ":a:" },
+  { "🅰️", ":a_button:" },
+  { "🅱", ":b:" },
+  { "🅱️", ":b_button:" },
+  { "🅾", ":o2:" },
+  { "🅾️", ":o_button:" },
+  { "🅿", ":parking:" },
+  { "🅿️", ":p_button:" },
+  { "🆎", ":ab:" },
+  { "🆑", ":cl:" },
+  { "🆒", ":cool:" },
+  { "🆓", ":free:" },
+  { "🆔", ":id:" },
+  { "🆕", ":new:" },
+  { "🆖", ":ng:" },
+  { "🆗", ":ok:" },
+  { "🆘", ":sos:" },
+  { "🆙", ":up:" },
+  { "🆚", ":vs:" },
+  { "🇦🇨", ":flag_ascension_island:" },
+  { "🇦🇩", ":flag_andorra:" },
+  { "🇦🇪", ":flag_united_arab_emirates:" },
+  { "🇦🇫", ":flag_afghanistan:" },
+  { "🇦🇬", ":flag_antigua_barbuda:" },
+  { "🇦🇮", ":flag_anguilla:" },
+  { "🇦🇱", ":flag_albania:" },
+  { "🇦🇲", ":flag_armenia:" },
+  { "🇦🇴", ":flag_angola:" },
+  { "🇦🇶", ":flag_antarctica:" },
+  { "🇦🇷", ":flag_argentina:" },
+  { "🇦🇸", ":flag_american_samoa:" },
+  { "🇦🇹", ":flag_austria:" },
+  { "🇦🇺", ":flag_australia:" },
+  { "🇦🇼", ":flag_aruba:" },
+  { "🇦🇽", ":flag_aland_islands:" },
+  { "🇦🇿", ":flag_azerbaijan:" },
+  { "🇧🇦", ":flag_bosnia_herzegovina:" },
+  { "🇧🇧", ":flag_barbados:" },
+  { "🇧🇩", ":flag_bangladesh:" },
+  { "🇧🇪", ":flag_belgium:" },
+  { "🇧🇫", ":flag_burkina_faso:" },
+  { "🇧🇬", ":flag_bulgaria:" },
+  { "🇧🇭", ":flag_bahrain:" },
+  { "🇧🇮", ":flag_burundi:" },
+  { "🇧🇯", ":flag_benin:" },
+  { "🇧🇱", ":flag_st_barthelemy:" },
+  { "🇧🇲", ":flag_bermuda:" },
+  { "🇧🇳", ":flag_brunei:" },
+  { "🇧🇴", ":flag_bolivia:" },
+  { "🇧🇶", ":flag_caribbean_netherlands:" },
+  { "🇧🇷", ":flag_brazil:" },
+  { "🇧🇸", ":flag_bahamas:" },
+  { "🇧🇹", ":flag_bhutan:" },
+  { "🇧🇻", ":flag_bouvet_island:" },
+  { "🇧🇼", ":flag_botswana:" },
+  { "🇧🇾", ":flag_belarus:" },
+  { "🇧🇿", ":flag_belize:" },
+  { "🇨🇦", ":flag_canada:" },
+  { "🇨🇨", ":flag_cocos_islands:" },
+  { "🇨🇩", ":flag_congo_kinshasa:" },
+  { "🇨🇫", ":flag_central_african_republic:" },
+  { "🇨🇬", ":flag_congo_brazzaville:" },
+  { "🇨🇭", ":flag_switzerland:" },
+  { "🇨🇮", ":flag_cote_d_ivoire:" },
+  { "🇨🇰", ":flag_cook_islands:" },
+  { "🇨🇱", ":flag_chile:" },
+  { "🇨🇲", ":flag_cameroon:" },
+  { "🇨🇳", ":flag_china:" },
+  { "🇨🇴", ":flag_colombia:" },
+  { "🇨🇵", ":flag_clipperton_island:" },
+  { "🇨🇷", ":flag_costa_rica:" },
+  { "🇨🇺", ":flag_cuba:" },
+  { "🇨🇻", ":flag_cape_verde:" },
+  { "🇨🇼", ":flag_curacao:" },
+  { "🇨🇽", ":flag_christmas_island:" },
+  { "🇨🇾", ":flag_cyprus:" },
+  { "🇨🇿", ":flag_czechia:" },
+  { "🇩🇪", ":flag_germany:" },
+  { "🇩🇬", ":flag_diego_garcia:" },
+  { "🇩🇯", ":flag_djibouti:" },
+  { "🇩🇰", ":flag_denmark:" },
+  { "🇩🇲", ":flag_dominica:" },
+  { "🇩🇴", ":flag_dominican_republic:" },
+  { "🇩🇿", ":flag_algeria:" },
+  { "🇪🇦", ":flag_ceuta_melilla:" },
+  { "🇪🇨", ":flag_ecuador:" },
+  { "🇪🇪", ":flag_estonia:" },
+  { "🇪🇬", ":flag_egypt:" },
+  { "🇪🇭", ":flag_western_sahara:" },
+  { "🇪🇷", ":flag_eritrea:" },
+  { "🇪🇸", ":flag_spain:" },
+  { "🇪🇹", ":flag_ethiopia:" },
+  { "🇪🇺", ":flag_european_union:" },
+  { "🇫🇮", ":flag_finland:" },
+  { "🇫🇯", ":flag_fiji:" },
+  { "🇫🇰", ":flag_falkland_islands:" },
+  { "🇫🇲", ":flag_micronesia:" },
+  { "🇫🇴", ":flag_faroe_islands:" },
+  { "🇫🇷", ":flag_france:" },
+  { "🇬🇦", ":flag_gabon:" },
+  { "🇬🇧", ":flag_united_kingdom:" },
+  { "🇬🇩", ":flag_grenada:" },
+  { "🇬🇪", ":flag_georgia:" },
+  { "🇬🇫", ":flag_french_guiana:" },
+  { "🇬🇬", ":flag_guernsey:" },
+  { "🇬🇭", ":flag_ghana:" },
+  { "🇬🇮", ":flag_gibraltar:" },
+  { "🇬🇱", ":flag_greenland:" },
+  { "🇬🇲", ":flag_gambia:" },
+  { "🇬🇳", ":flag_guinea:" },
+  { "🇬🇵", ":flag_guadeloupe:" },
+  { "🇬🇶", ":flag_equatorial_guinea:" },
+  { "🇬🇷", ":flag_greece:" },
+  { "🇬🇸", ":flag_south_georgia_south_sandwich_islands:" },
+  { "🇬🇹", ":flag_guatemala:" },
+  { "🇬🇺", ":flag_guam:" },
+  { "🇬🇼", ":flag_guinea_bissau:" },
+  { "🇬🇾", ":flag_guyana:" },
+  { "🇭🇰", ":flag_hong_kong_sar_china:" },
+  { "🇭🇲", ":flag_heard_mcdonald_islands:" },
+  { "🇭🇳", ":flag_honduras:" },
+  { "🇭🇷", ":flag_croatia:" },
+  { "🇭🇹", ":flag_haiti:" },
+  { "🇭🇺", ":flag_hungary:" },
+  { "🇮🇨", ":flag_canary_islands:" },
+  { "🇮🇩", ":flag_indonesia:" },
+  { "🇮🇪", ":flag_ireland:" },
+  { "🇮🇱", ":flag_israel:" },
+  { "🇮🇲", ":flag_isle_of_man:" },
+  { "🇮🇳", ":flag_india:" },
+  { "🇮🇴", ":flag_british_indian_ocean_territory:" },
+  { "🇮🇶", ":flag_iraq:" },
+  { "🇮🇷", ":flag_iran:" },
+  { "🇮🇸", ":flag_iceland:" },
+  { "🇮🇹", ":flag_italy:" },
+  { "🇯🇪", ":flag_jersey:" },
+  { "🇯🇲", ":flag_jamaica:" },
+  { "🇯🇴", ":flag_jordan:" },
+  { "🇯🇵", ":flag_japan:" },
+  { "🇰🇪", ":flag_kenya:" },
+  { "🇰🇬", ":flag_kyrgyzstan:" },
+  { "🇰🇭", ":flag_cambodia:" },
+  { "🇰🇮", ":flag_kiribati:" },
+  { "🇰🇲", ":flag_comoros:" },
+  { "🇰🇳", ":flag_st_kitts_nevis:" },
+  { "🇰🇵", ":flag_north_korea:" },
+  { "🇰🇷", ":flag_south_korea:" },
+  { "🇰🇼", ":flag_kuwait:" },
+  { "🇰🇾", ":flag_cayman_islands:" },
+  { "🇰🇿", ":flag_kazakhstan:" },
+  { "🇱🇦", ":flag_laos:" },
+  { "🇱🇧", ":flag_lebanon:" },
+  { "🇱🇨", ":flag_st_lucia:" },
+  { "🇱🇮", ":flag_liechtenstein:" },
+  { "🇱🇰", ":flag_sri_lanka:" },
+  { "🇱🇷", ":flag_liberia:" },
+  { "🇱🇸", ":flag_lesotho:" },
+  { "🇱🇹", ":flag_lithuania:" },
+  { "🇱🇺", ":flag_luxembourg:" },
+  { "🇱🇻", ":flag_latvia:" },
+  { "🇱🇾", ":flag_libya:" },
+  { "🇲🇦", ":flag_morocco:" },
+  { "🇲🇨", ":flag_monaco:" },
+  { "🇲🇩", ":flag_moldova:" },
+  { "🇲🇪", ":flag_montenegro:" },
+  { "🇲🇫", ":flag_st_martin:" },
+  { "🇲🇬", ":flag_madagascar:" },
+  { "🇲🇭", ":flag_marshall_islands:" },
+  { "🇲🇰", ":flag_north_macedonia:" },
+  { "🇲🇱", ":flag_mali:" },
+  { "🇲🇲", ":flag_myanmar:" },
+  { "🇲🇳", ":flag_mongolia:" },
+  { "🇲🇴", ":flag_macao_sar_china:" },
+  { "🇲🇵", ":flag_northern_mariana_islands:" },
+  { "🇲🇶", ":flag_martinique:" },
+  { "🇲🇷", ":flag_mauritania:" },
+  { "🇲🇸", ":flag_montserrat:" },
+  { "🇲🇹", ":flag_malta:" },
+  { "🇲🇺", ":flag_mauritius:" },
+  { "🇲🇻", ":flag_maldives:" },
+  { "🇲🇼", ":flag_malawi:" },
+  { "🇲🇽", ":flag_mexico:" },
+  { "🇲🇾", ":flag_malaysia:" },
+  { "🇲🇿", ":flag_mozambique:" },
+  { "🇳🇦", ":flag_namibia:" },
+  { "🇳🇨", ":flag_new_caledonia:" },
+  { "🇳🇪", ":flag_niger:" },
+  { "🇳🇫", ":flag_norfolk_island:" },
+  { "🇳🇬", ":flag_nigeria:" },
+  { "🇳🇮", ":flag_nicaragua:" },
+  { "🇳🇱", ":flag_netherlands:" },
+  { "🇳🇴", ":flag_norway:" },
+  { "🇳🇵", ":flag_nepal:" },
+  { "🇳🇷", ":flag_nauru:" },
+  { "🇳🇺", ":flag_niue:" },
+  { "🇳🇿", ":flag_new_zealand:" },
+  { "🇴🇲", ":flag_oman:" },
+  { "🇵🇦", ":flag_panama:" },
+  { "🇵🇪", ":flag_peru:" },
+  { "🇵🇫", ":flag_french_polynesia:" },
+  { "🇵🇬", ":flag_papua_new_guinea:" },
+  { "🇵🇭", ":flag_philippines:" },
+  { "🇵🇰", ":flag_pakistan:" },
+  { "🇵🇱", ":flag_poland:" },
+  { "🇵🇲", ":flag_st_pierre_miquelon:" },
+  { "🇵🇳", ":flag_pitcairn_islands:" },
+  { "🇵🇷", ":flag_puerto_rico:" },
+  { "🇵🇸", ":flag_palestinian_territories:" },
+  { "🇵🇹", ":flag_portugal:" },
+  { "🇵🇼", ":flag_palau:" },
+  { "🇵🇾", ":flag_paraguay:" },
+  { "🇶🇦", ":flag_qatar:" },
+  { "🇷🇪", ":flag_reunion:" },
+  { "🇷🇴", ":flag_romania:" },
+  { "🇷🇸", ":flag_serbia:" },
+  { "🇷🇺", ":flag_russia:" },
+  { "🇷🇼", ":flag_rwanda:" },
+  { "🇸🇦", ":flag_saudi_arabia:" },
+  { "🇸🇧", ":flag_solomon_islands:" },
+  { "🇸🇨", ":flag_seychelles:" },
+  { "🇸🇩", ":flag_sudan:" },
+  { "🇸🇪", ":flag_sweden:" },
+  { "🇸🇬", ":flag_singapore:" },
+  { "🇸🇭", ":flag_st_helena:" },
+  { "🇸🇮", ":flag_slovenia:" },
+  { "🇸🇯", ":flag_svalbard_jan_mayen:" },
+  { "🇸🇰", ":flag_slovakia:" },
+  { "🇸🇱", ":flag_sierra_leone:" },
+  { "🇸🇲", ":flag_san_marino:" },
+  { "🇸🇳", ":flag_senegal:" },
+  { "🇸🇴", ":flag_somalia:" },
+  { "🇸🇷", ":flag_suriname:" },
+  { "🇸🇸", ":flag_south_sudan:" },
+  { "🇸🇹", ":flag_sao_tome_principe:" },
+  { "🇸🇻", ":flag_el_salvador:" },
+  { "🇸🇽", ":flag_sint_maarten:" },
+  { "🇸🇾", ":flag_syria:" },
+  { "🇸🇿", ":flag_eswatini:" },
+  { "🇹🇦", ":flag_tristan_da_cunha:" },
+  { "🇹🇨", ":flag_turks_caicos_islands:" },
+  { "🇹🇩", ":flag_chad:" },
+  { "🇹🇫", ":flag_french_southern_territories:" },
+  { "🇹🇬", ":flag_togo:" },
+  { "🇹🇭", ":flag_thailand:" },
+  { "🇹🇯", ":flag_tajikistan:" },
+  { "🇹🇰", ":flag_tokelau:" },
+  { "🇹🇱", ":flag_timor_leste:" },
+  { "🇹🇲", ":flag_turkmenistan:" },
+  { "🇹🇳", ":flag_tunisia:" },
+  { "🇹🇴", ":flag_tonga:" },
+  { "🇹🇷", ":flag_turkey:" },
+  { "🇹🇹", ":flag_trinidad_tobago:" },
+  { "🇹🇻", ":flag_tuvalu:" },
+  { "🇹🇼", ":flag_taiwan:" },
+  { "🇹🇿", ":flag_tanzania:" },
+  { "🇺🇦", ":flag_ukraine:" },
+  { "🇺🇬", ":flag_uganda:" },
+  { "🇺🇲", ":flag_u_s_outlying_islands:" },
+  { "🇺🇳", ":flag_united_nations:" },
+  { "🇺🇸", ":flag_united_states:" },
+  { "🇺🇾", ":flag_uruguay:" },
+  { "🇺🇿", ":flag_uzbekistan:" },
+  { "🇻🇦", ":flag_vatican_city:" },
+  { "🇻🇨", ":flag_st_vincent_grenadines:" },
+  { "🇻🇪", ":flag_venezuela:" },
+  { "🇻🇬", ":flag_british_virgin_islands:" },
+  { "🇻🇮", ":flag_u_s_virgin_islands:" },
+  { "🇻🇳", ":flag_vietnam:" },
+  { "🇻🇺", ":flag_vanuatu:" },
+  { "🇼🇫", ":flag_wallis_futuna:" },
+  { "🇼🇸", ":flag_samoa:" },
+  { "🇽🇰", ":flag_kosovo:" },
+  { "🇾🇪", ":flag_yemen:" },
+  { "🇾🇹", ":flag_mayotte:" },
+  { "🇿🇦", ":flag_south_africa:" },
+  { "🇿🇲", ":flag_zambia:" },
+  { "🇿🇼", ":flag_zimbabwe:" },
+  { "🈁", ":koko:" },
+  { "🈂", ":sa:" },
+  { "🈂️", ":japanese_service_charge_button:" },
+  { "🈚", ":japanese_free_of_charge_button:" },
+  { "🈯", ":japanese_reserved_button:" },
+  { "🈲", ":japanese_prohibited_button:" },
+  { "🈳", ":japanese_vacancy_button:" },
+  { "🈴", ":japanese_passing_grade_button:" },
+  { "🈵", ":japanese_no_vacancy_button:" },
+  { "🈶", ":japanese_not_free_of_charge_button:" },
+  { "🈷️", ":japanese_monthly_amount_button:" },
+  { "🈸", ":japanese_application_button:" },
+  { "🈹", ":japanese_discount_button:" },
+  { "🈺", ":japanese_open_for_business_button:" },
+  { "🉐", ":ideograph_advantage:" },
+  { "🉑", ":accept:" },
+  { "🌀", ":cyclone:" },
+  { "🌁", ":foggy:" },
+  { "🌂", ":closed_umbrella:" },
+  { "🌃", ":night_with_stars:" },
+  { "🌄", ":sunrise_over_mountains:" },
+  { "🌅", ":sunrise:" },
+  { "🌆", ":city_sunset:" },
+  { "🌇", ":city_sunrise:" },
+  { "🌈", ":rainbow:" },
+  { "🌉", ":bridge_at_night:" },
+  { "🌊", ":ocean:" },
+  { "🌋", ":volcano:" },
+  { "🌌", ":milky_way:" },
+  { "🌍", ":earth_africa:" },
+  { "🌎", ":earth_americas:" },
+  { "🌏", ":earth_asia:" },
+  { "🌐", ":globe_with_meridians:" },
+  { "🌑", ":new_moon:" },
+  { "🌒", ":waxing_crescent_moon:" },
+  { "🌓", ":first_quarter_moon:" },
+  { "🌔", ":waxing_gibbous_moon:" },
+  { "🌕", ":full_moon:" },
+  { "🌖", ":waning_gibbous_moon:" },
+  { "🌗", ":last_quarter_moon:" },
+  { "🌘", ":waning_crescent_moon:" },
+  { "🌙", ":crescent_moon:" },
+  { "🌚", ":new_moon_with_face:" },
+  { "🌛", ":first_quarter_moon_with_face:" },
+  { "🌜", ":last_quarter_moon_with_face:" },
+  { "🌝", ":full_moon_with_face:" },
+  { "🌞", ":sun_with_face:" },
+  { "🌟", ":star2:" },
+  { "🌠", ":stars:" },
+  { "🌡", ":thermometer:" },
+  { "🌤", ":white_sun_with_small_cloud:" },
+  { "🌤️", ":sun_behind_small_cloud:" },
+  { "🌥", ":white_sun_behind_cloud:" },
+  { "🌥️", ":sun_behind_large_cloud:" },
+  { "🌦", ":white_sun_behind_cloud_with_rain:" },
+  { "🌦️", ":sun_behind_rain_cloud:" },
+  { "🌧", ":cloud_with_rain:" },
+  { "🌨", ":cloud_with_snow:" },
+  { "🌩", ":cloud_with_lightning:" },
+  { "🌪", ":cloud_with_tornado:" },
+  { "🌪️", ":tornado:" },
+  { "🌫", ":fog:" },
+  { "🌬", ":wind_blowing_face:" },
+  { "🌬️", ":wind_face:" },
+  { "🌭", ":hot_dog:" },
+  { "🌮", ":taco:" },
+  { "🌯", ":burrito:" },
+  { "🌰", ":chestnut:" },
+  { "🌱", ":seedling:" },
+  { "🌲", ":evergreen_tree:" },
+  { "🌳", ":deciduous_tree:" },
+  { "🌴", ":palm_tree:" },
+  { "🌵", ":cactus:" },
+  { "🌶", ":hot_pepper:" },
+  { "🌷", ":tulip:" },
+  { "🌸", ":cherry_blossom:" },
+  { "🌹", ":rose:" },
+  { "🌺", ":hibiscus:" },
+  { "🌻", ":sunflower:" },
+  { "🌼", ":blossom:" },
+  { "🌽", ":corn:" },
+  { "🌾", ":ear_of_rice:" },
+  { "🌿", ":herb:" },
+  { "🍀", ":four_leaf_clover:" },
+  { "🍁", ":maple_leaf:" },
+  { "🍂", ":fallen_leaf:" },
+  { "🍃", ":leaves:" },
+  { "🍄", ":mushroom:" },
+  { "🍅", ":tomato:" },
+  { "🍆", ":eggplant:" },
+  { "🍇", ":grapes:" },
+  { "🍈", ":melon:" },
+  { "🍉", ":watermelon:" },
+  { "🍊", ":tangerine:" },
+  { "🍋", ":lemon:" },
+  { "🍌", ":banana:" },
+  { "🍍", ":pineapple:" },
+  { "🍎", ":apple:" },
+  { "🍏", ":green_apple:" },
+  { "🍐", ":pear:" },
+  { "🍑", ":peach:" },
+  { "🍒", ":cherries:" },
+  { "🍓", ":strawberry:" },
+  { "🍔", ":hamburger:" },
+  { "🍕", ":pizza:" },
+  { "🍖", ":meat_on_bone:" },
+  { "🍗", ":poultry_leg:" },
+  { "🍘", ":rice_cracker:" },
+  { "🍙", ":rice_ball:" },
+  { "🍚", ":rice:" },
+  { "🍛", ":curry:" },
+  { "🍜", ":ramen:" },
+  { "🍝", ":spaghetti:" },
+  { "🍞", ":bread:" },
+  { "🍟", ":fries:" },
+  { "🍠", ":sweet_potato:" },
+  { "🍡", ":dango:" },
+  { "🍢", ":oden:" },
+  { "🍣", ":sushi:" },
+  { "🍤", ":fried_shrimp:" },
+  { "🍥", ":fish_cake:" },
+  { "🍦", ":icecream:" },
+  { "🍧", ":shaved_ice:" },
+  { "🍨", ":ice_cream:" },
+  { "🍩", ":doughnut:" },
+  { "🍪", ":cookie:" },
+  { "🍫", ":chocolate_bar:" },
+  { "🍬", ":candy:" },
+  { "🍭", ":lollipop:" },
+  { "🍮", ":custard:" },
+  { "🍯", ":honey_pot:" },
+  { "🍰", ":cake:" },
+  { "🍱", ":bento:" },
+  { "🍲", ":stew:" },
+  { "🍳", ":egg:" },
+  { "🍴", ":fork_and_knife:" },
+  { "🍵", ":tea:" },
+  { "🍶", ":sake:" },
+  { "🍷", ":wine_glass:" },
+  { "🍸", ":cocktail:" },
+  { "🍹", ":tropical_drink:" },
+  { "🍺", ":beer:" },
+  { "🍻", ":beers:" },
+  { "🍼", ":baby_bottle:" },
+  { "🍽", ":fork_and_knife_with_plate:" },
+  { "🍾", ":bottle_with_popping_cork:" },
+  { "🍿", ":popcorn:" },
+  { "🎀", ":ribbon:" },
+  { "🎁", ":gift:" },
+  { "🎂", ":birthday:" },
+  { "🎃", ":jack_o_lantern:" },
+  { "🎄", ":christmas_tree:" },
+  { "🎅", ":santa:" },
+  { "🎆", ":fireworks:" },
+  { "🎇", ":sparkler:" },
+  { "🎈", ":balloon:" },
+  { "🎉", ":tada:" },
+  { "🎊", ":confetti_ball:" },
+  { "🎋", ":tanabata_tree:" },
+  { "🎌", ":crossed_flags:" },
+  { "🎍", ":bamboo:" },
+  { "🎎", ":dolls:" },
+  { "🎏", ":flags:" },
+  { "🎐", ":wind_chime:" },
+  { "🎑", ":rice_scene:" },
+  { "🎒", ":school_satchel:" },
+  { "🎓", ":mortar_board:" },
+  { "🎖", ":military_medal:" },
+  { "🎗", ":reminder_ribbon:" },
+  { "🎙", ":studio_microphone:" },
+  { "🎚", ":level_slider:" },
+  { "🎛", ":control_knobs:" },
+  { "🎞", ":film_frames:" },
+  { "🎟", ":admission_tickets:" },
+  { "🎠", ":carousel_horse:" },
+  { "🎡", ":ferris_wheel:" },
+  { "🎢", ":roller_coaster:" },
+  { "🎣", ":fishing_pole_and_fish:" },
+  { "🎤", ":microphone:" },
+  { "🎥", ":movie_camera:" },
+  { "🎦", ":cinema:" },
+  { "🎧", ":headphones:" },
+  { "🎨", ":art:" },
+  { "🎩", ":tophat:" },
+  { "🎪", ":circus_tent:" },
+  { "🎫", ":ticket:" },
+  { "🎬", ":clapper:" },
+  { "🎭", ":performing_arts:" },
+  { "🎮", ":video_game:" },
+  { "🎯", ":dart:" },
+  { "🎰", ":slot_machine:" },
+  { "🎱", ":8ball:" },
+  { "🎲", ":game_die:" },
+  { "🎳", ":bowling:" },
+  { "🎴", ":flower_playing_cards:" },
+  { "🎵", ":musical_note:" },
+  { "🎶", ":notes:" },
+  { "🎷", ":saxophone:" },
+  { "🎸", ":guitar:" },
+  { "🎹", ":musical_keyboard:" },
+  { "🎺", ":trumpet:" },
+  { "🎻", ":violin:" },
+  { "🎼", ":musical_score:" },
+  { "🎽", ":running_shirt_with_sash:" },
+  { "🎾", ":tennis:" },
+  { "🎿", ":ski:" },
+  { "🏀", ":basketball:" },
+  { "🏁", ":checkered_flag:" },
+  { "🏂", ":snowboarder:" },
+  { "🏃", ":running:" },
+  { "🏃‍♀️", ":woman_running:" },
+  { "🏃‍♂️", ":man_running:" },
+  { "🏄", ":surfer:" },
+  { "🏄‍♀️", ":woman_surfing:" },
+  { "🏄‍♂️", ":man_surfing:" },
+  { "🏅", ":sports_medal:" },
+  { "🏆", ":trophy:" },
+  { "🏇", ":horse_racing:" },
+  { "🏈", ":football:" },
+  { "🏉", ":rugby_football:" },
+  { "🏊", ":swimmer:" },
+  { "🏊‍♀️", ":woman_swimming:" },
+  { "🏊‍♂️", ":man_swimming:" },
+  { "🏋", ":weight_lifter:" },
+  { "🏋️", ":person_lifting_weights:" },
+  { "🏋️‍♀️", ":woman_lifting_weights:" },
+  { "🏋️‍♂️", ":man_lifting_weights:" },
+  { "🏌", ":golfer:" },
+  { "🏌️", ":person_golfing:" },
+  { "🏌️‍♀️", ":woman_golfing:" },
+  { "🏌️‍♂️", ":man_golfing:" },
+  { "🏍", ":racing_motorcycle:" },
+  { "🏍️", ":motorcycle:" },
+  { "🏎", ":racing_car:" },
+  { "🏏", ":cricket_bat_and_ball:" },
+  { "🏐", ":volleyball:" },
+  { "🏑", ":field_hockey_stick_and_ball:" },
+  { "🏒", ":ice_hockey_stick_and_puck:" },
+  { "🏓", ":table_tennis_paddle_and_ball:" },
+  { "🏔", ":snow_capped_mountain:" },
+  { "🏕", ":camping:" },
+  { "🏖", ":beach_with_umbrella:" },
+  { "🏗", ":building_construction:" },
+  { "🏘", ":house_buildings:" },
+  { "🏘️", ":houses:" },
+  { "🏙", ":cityscape:" },
+  { "🏚", ":derelict_house_building:" },
+  { "🏚️", ":derelict_house:" },
+  { "🏛", ":classical_building:" },
+  { "🏜", ":desert:" },
+  { "🏝", ":desert_island:" },
+  { "🏞", ":national_park:" },
+  { "🏟", ":stadium:" },
+  { "🏠", ":house:" },
+  { "🏡", ":house_with_garden:" },
+  { "🏢", ":office:" },
+  { "🏣", ":post_office:" },
+  { "🏤", ":european_post_office:" },
+  { "🏥", ":hospital:" },
+  { "🏦", ":bank:" },
+  { "🏧", ":atm:" },
+  { "🏨", ":hotel:" },
+  { "🏩", ":love_hotel:" },
+  { "🏪", ":convenience_store:" },
+  { "🏫", ":school:" },
+  { "🏬", ":department_store:" },
+  { "🏭", ":factory:" },
+  { "🏮", ":lantern:" },
+  { "🏯", ":japanese_castle:" },
+  { "🏰", ":european_castle:" },
+  { "🏳", ":waving_white_flag:" },
+  { "🏳️", ":white_flag:" },
+  { "🏳️‍⚧️", ":transgender_flag:" },
+  { "🏳️‍🌈", ":rainbow_flag:" },
+  { "🏴", ":waving_black_flag:" },
+  { "🏴‍☠️", ":pirate_flag:" },
+  { "🏴󠁧󠁢󠁥󠁮󠁧󠁿", ":flag_england:" },
+  { "🏴󠁧󠁢󠁳󠁣󠁴󠁿", ":flag_scotland:" },
+  { "🏴󠁧󠁢󠁷󠁬󠁳󠁿", ":flag_wales:" },
+  { "🏵", ":rosette:" },
+  { "🏷", ":label:" },
+  { "🏸", ":badminton_racquet_and_shuttlecock:" },
+  { "🏹", ":bow_and_arrow:" },
+  { "🏺", ":amphora:" },
+  { "🏻", ":light_skin_tone:" },
+  { "🏼", ":medium_light_skin_tone:" },
+  { "🏽", ":medium_skin_tone:" },
+  { "🏾", ":medium_dark_skin_tone:" },
+  { "🏿", ":dark_skin_tone:" },
+  { "🐀", ":rat:" },
+  { "🐁", ":mouse2:" },
+  { "🐂", ":ox:" },
+  { "🐃", ":water_buffalo:" },
+  { "🐄", ":cow2:" },
+  { "🐅", ":tiger2:" },
+  { "🐆", ":leopard:" },
+  { "🐇", ":rabbit2:" },
+  { "🐈", ":cat2:" },
+  { "🐈‍⬛", ":black_cat:" },
+  { "🐉", ":dragon:" },
+  { "🐊", ":crocodile:" },
+  { "🐋", ":whale2:" },
+  { "🐌", ":snail:" },
+  { "🐍", ":snake:" },
+  { "🐎", ":racehorse:" },
+  { "🐏", ":ram:" },
+  { "🐐", ":goat:" },
+  { "🐑", ":sheep:" },
+  { "🐒", ":monkey:" },
+  { "🐓", ":rooster:" },
+  { "🐔", ":chicken:" },
+  { "🐕", ":dog2:" },
+  { "🐕‍🦺", ":service_dog:" },
+  { "🐖", ":pig2:" },
+  { "🐗", ":boar:" },
+  { "🐘", ":elephant:" },
+  { "🐙", ":octopus:" },
+  { "🐚", ":shell:" },
+  { "🐛", ":bug:" },
+  { "🐜", ":ant:" },
+  { "🐝", ":honeybee:" },
+  { "🐞", ":beetle:" },
+  { "🐟", ":fish:" },
+  { "🐠", ":tropical_fish:" },
+  { "🐡", ":blowfish:" },
+  { "🐢", ":turtle:" },
+  { "🐣", ":hatching_chick:" },
+  { "🐤", ":baby_chick:" },
+  { "🐥", ":hatched_chick:" },
+  { "🐦", ":bird:" },
+  { "🐧", ":penguin:" },
+  { "🐨", ":koala:" },
+  { "🐩", ":poodle:" },
+  { "🐪", ":dromedary_camel:" },
+  { "🐫", ":camel:" },
+  { "🐬", ":flipper:" },
+  { "🐭", ":mouse:" },
+  { "🐮", ":cow:" },
+  { "🐯", ":tiger:" },
+  { "🐰", ":rabbit:" },
+  { "🐱", ":cat:" },
+  { "🐲", ":dragon_face:" },
+  { "🐳", ":whale:" },
+  { "🐴", ":horse:" },
+  { "🐵", ":monkey_face:" },
+  { "🐶", ":dog:" },
+  { "🐷", ":pig:" },
+  { "🐸", ":frog:" },
+  { "🐹", ":hamster:" },
+  { "🐺", ":wolf:" },
+  { "🐻", ":bear:" },
+  { "🐻‍❄️", ":polar_bear:" },
+  { "🐼", ":panda_face:" },
+  { "🐽", ":pig_nose:" },
+  { "🐾", ":paw_prints:" },
+  { "🐿", ":chipmunk:" },
+  { "👀", ":eyes:" },
+  { "👁", ":eye:" },
+  { "👁️‍🗨️", ":eye_in_speech_bubble:" },
+  { "👂", ":ear:" },
+  { "👃", ":nose:" },
+  { "👄", ":lips:" },
+  { "👅", ":tongue:" },
+  { "👆", ":point_up_2:" },
+  { "👇", ":point_down:" },
+  { "👈", ":point_left:" },
+  { "👉", ":point_right:" },
+  { "👊", ":punch:" },
+  { "👋", ":wave:" },
+  { "👌", ":ok_hand:" },
+  { "👍", ":thumbsup:" },
+  { "👎", ":thumbsdown:" },
+  { "👏", ":clap:" },
+  { "👐", ":open_hands:" },
+  { "👑", ":crown:" },
+  { "👒", ":womans_hat:" },
+  { "👓", ":eyeglasses:" },
+  { "👔", ":necktie:" },
+  { "👕", ":tshirt:" },
+  { "👖", ":jeans:" },
+  { "👗", ":dress:" },
+  { "👘", ":kimono:" },
+  { "👙", ":bikini:" },
+  { "👚", ":womans_clothes:" },
+  { "👛", ":purse:" },
+  { "👜", ":handbag:" },
+  { "👝", ":pouch:" },
+  { "👞", ":shoe:" },
+  { "👟", ":athletic_shoe:" },
+  { "👠", ":high_heel:" },
+  { "👡", ":sandal:" },
+  { "👢", ":boot:" },
+  { "👣", ":footprints:" },
+  { "👤", ":bust_in_silhouette:" },
+  { "👥", ":busts_in_silhouette:" },
+  { "👦", ":boy:" },
+  { "👧", ":girl:" },
+  { "👨", ":man:" },
+  { "👨‍⚕️", ":man_health_worker:" },
+  { "👨‍⚖️", ":man_judge:" },
+  { "👨‍✈️", ":man_pilot:" },
+  { "👨‍❤️‍👨", ":couple_with_heart_man_man:" },
+  { "👨‍❤️‍💋‍👨", ":kiss_man_man:" },
+  { "👨‍🌾", ":man_farmer:" },
+  { "👨‍🍳", ":man_cook:" },
+  { "👨‍🍼", ":man_feeding_baby:" },
+  { "👨‍🎓", ":man_student:" },
+  { "👨‍🎤", ":man_singer:" },
+  { "👨‍🎨", ":man_artist:" },
+  { "👨‍🏫", ":man_teacher:" },
+  { "👨‍🏭", ":man_factory_worker:" },
+  { "👨‍👦", ":family_man_boy:" },
+  { "👨‍👦‍👦", ":family_man_boy_boy:" },
+  { "👨‍👧", ":family_man_girl:" },
+  { "👨‍👧‍👦", ":family_man_girl_boy:" },
+  { "👨‍👧‍👧", ":family_man_girl_girl:" },
+  { "👨‍👨‍👦", ":family_man_man_boy:" },
+  { "👨‍👨‍👦‍👦", ":family_man_man_boy_boy:" },
+  { "👨‍👨‍👧", ":family_man_man_girl:" },
+  { "👨‍👨‍👧‍👦", ":family_man_man_girl_boy:" },
+  { "👨‍👨‍👧‍👧", ":family_man_man_girl_girl:" },
+  { "👨‍👩‍👦", ":family_man_woman_boy:" },
+  { "👨‍👩‍👦‍👦", ":family_man_woman_boy_boy:" },
+  { "👨‍👩‍👧", ":family_man_woman_girl:" },
+  { "👨‍👩‍👧‍👦", ":family_man_woman_girl_boy:" },
+  { "👨‍👩‍👧‍👧", ":family_man_woman_girl_girl:" },
+  { "👨‍💻", ":man_technologist:" },
+  { "👨‍💼", ":man_office_worker:" },
+  { "👨‍🔧", ":man_mechanic:" },
+  { "👨‍🔬", ":man_scientist:" },
+  { "👨‍🚀", ":man_astronaut:" },
+  { "👨‍🚒", ":man_firefighter:" },
+  { "👨‍🦯", ":man_with_white_cane:" },
+  { "👨‍🦰", ":man_red_hair:" },
+  { "👨‍🦱", ":man_curly_hair:" },
+  { "👨‍🦲", ":man_bald:" },
+  { "👨‍🦳", ":man_white_hair:" },
+  { "👨‍🦼", ":man_in_motorized_wheelchair:" },
+  { "👨‍🦽", ":man_in_manual_wheelchair:" },
+  { "👩", ":woman:" },
+  { "👩‍⚕️", ":woman_health_worker:" },
+  { "👩‍⚖️", ":woman_judge:" },
+  { "👩‍✈️", ":woman_pilot:" },
+  { "👩‍❤️‍👨", ":couple_with_heart_woman_man:" },
+  { "👩‍❤️‍👩", ":couple_with_heart_woman_woman:" },
+  { "👩‍❤️‍💋‍👨", ":kiss_woman_man:" },
+  { "👩‍❤️‍💋‍👩", ":kiss_woman_woman:" },
+  { "👩‍🌾", ":woman_farmer:" },
+  { "👩‍🍳", ":woman_cook:" },
+  { "👩‍🍼", ":woman_feeding_baby:" },
+  { "👩‍🎓", ":woman_student:" },
+  { "👩‍🎤", ":woman_singer:" },
+  { "👩‍🎨", ":woman_artist:" },
+  { "👩‍🏫", ":woman_teacher:" },
+  { "👩‍🏭", ":woman_factory_worker:" },
+  { "👩‍👦", ":family_woman_boy:" },
+  { "👩‍👦‍👦", ":family_woman_boy_boy:" },
+  { "👩‍👧", ":family_woman_girl:" },
+  { "👩‍👧‍👦", ":family_woman_girl_boy:" },
+  { "👩‍👧‍👧", ":family_woman_girl_girl:" },
+  { "👩‍👩‍👦", ":family_woman_woman_boy:" },
+  { "👩‍👩‍👦‍👦", ":family_woman_woman_boy_boy:" },
+  { "👩‍👩‍👧", ":family_woman_woman_girl:" },
+  { "👩‍👩‍👧‍👦", ":family_woman_woman_girl_boy:" },
+  { "👩‍👩‍👧‍👧", ":family_woman_woman_girl_girl:" },
+  { "👩‍💻", ":woman_technologist:" },
+  { "👩‍💼", ":woman_office_worker:" },
+  { "👩‍🔧", ":woman_mechanic:" },
+  { "👩‍🔬", ":woman_scientist:" },
+  { "👩‍🚀", ":woman_astronaut:" },
+  { "👩‍🚒", ":woman_firefighter:" },
+  { "👩‍🦯", ":woman_with_white_cane:" },
+  { "👩‍🦰", ":woman_red_hair:" },
+  { "👩‍🦱", ":woman_curly_hair:" },
+  { "👩‍🦲", ":woman_bald:" },
+  { "👩‍🦳", ":woman_white_hair:" },
+  { "👩‍🦼", ":woman_in_motorized_wheelchair:" },
+  { "👩‍🦽", ":woman_in_manual_wheelchair:" },
+  { "👪", ":family:" },
+  { "👫", ":couple:" },
+  { "👬", ":two_men_holding_hands:" },
+  { "👭", ":two_women_holding_hands:" },
+  { "👮", ":cop:" },
+  { "👮‍♀️", ":woman_police_officer:" },
+  { "👮‍♂️", ":man_police_officer:" },
+  { "👯", ":dancers:" },
+  { "👯‍♀️", ":women_with_bunny_ears:" },
+  { "👯‍♂️", ":men_with_bunny_ears:" },
+  { "👰", ":bride_with_veil:" },
+  { "👰‍♀️", ":woman_with_veil:" },
+  { "👰‍♂️", ":man_with_veil:" },
+  { "👱", ":person_with_blond_hair:" },
+  { "👱‍♀️", ":woman_blond_hair:" },
+  { "👱‍♂️", ":man_blond_hair:" },
+  { "👲", ":man_with_gua_pi_mao:" },
+  { "👳", ":man_with_turban:" },
+  { "👳‍♀️", ":woman_wearing_turban:" },
+  { "👳‍♂️", ":man_wearing_turban:" },
+  { "👴", ":older_man:" },
+  { "👵", ":older_woman:" },
+  { "👶", ":baby:" },
+  { "👷", ":construction_worker:" },
+  { "👷‍♀️", ":woman_construction_worker:" },
+  { "👷‍♂️", ":man_construction_worker:" },
+  { "👸", ":princess:" },
+  { "👹", ":japanese_ogre:" },
+  { "👺", ":japanese_goblin:" },
+  { "👻", ":ghost:" },
+  { "👼", ":angel:" },
+  { "👽", ":alien:" },
+  { "👾", ":space_invader:" },
+  { "👿", ":imp:" },
+  { "💀", ":skull:" },
+  { "💁", ":information_desk_person:" },
+  { "💁‍♀️", ":woman_tipping_hand:" },
+  { "💁‍♂️", ":man_tipping_hand:" },
+  { "💂", ":guardsman:" },
+  { "💂‍♀️", ":woman_guard:" },
+  { "💂‍♂️", ":man_guard:" },
+  { "💃", ":dancer:" },
+  { "💄", ":lipstick:" },
+  { "💅", ":nail_care:" },
+  { "💆", ":massage:" },
+  { "💆‍♀️", ":woman_getting_massage:" },
+  { "💆‍♂️", ":man_getting_massage:" },
+  { "💇", ":haircut:" },
+  { "💇‍♀️", ":woman_getting_haircut:" },
+  { "💇‍♂️", ":man_getting_haircut:" },
+  { "💈", ":barber:" },
+  { "💉", ":syringe:" },
+  { "💊", ":pill:" },
+  { "💋", ":kiss:" },
+  { "💌", ":love_letter:" },
+  { "💍", ":ring:" },
+  { "💎", ":gem:" },
+  { "💏", ":couplekiss:" },
+  { "💐", ":bouquet:" },
+  { "💑", ":couple_with_heart:" },
+  { "💒", ":wedding:" },
+  { "💓", ":heartbeat:" },
+  { "💔", ":broken_heart:" },
+  { "💕", ":two_hearts:" },
+  { "💖", ":sparkling_heart:" },
+  { "💗", ":heartpulse:" },
+  { "💘", ":cupid:" },
+  { "💙", ":blue_heart:" },
+  { "💚", ":green_heart:" },
+  { "💛", ":yellow_heart:" },
+  { "💜", ":purple_heart:" },
+  { "💝", ":gift_heart:" },
+  { "💞", ":revolving_hearts:" },
+  { "💟", ":heart_decoration:" },
+  { "💠", ":diamond_shape_with_a_dot_inside:" },
+  { "💡", ":bulb:" },
+  { "💢", ":anger:" },
+  { "💣", ":bomb:" },
+  { "💤", ":zzz:" },
+  { "💥", ":collision:" },
+  { "💦", ":sweat_drops:" },
+  { "💧", ":droplet:" },
+  { "💨", ":dash:" },
+  { "💩", ":shit:" },
+  { "💪", ":muscle:" },
+  { "💫", ":dizzy:" },
+  { "💬", ":speech_balloon:" },
+  { "💭", ":thought_balloon:" },
+  { "💮", ":white_flower:" },
+  { "💯", ":100:" },
+  { "💰", ":moneybag:" },
+  { "💱", ":currency_exchange:" },
+  { "💲", ":heavy_dollar_sign:" },
+  { "💳", ":credit_card:" },
+  { "💴", ":yen:" },
+  { "💵", ":dollar:" },
+  { "💶", ":euro:" },
+  { "💷", ":pound:" },
+  { "💸", ":money_with_wings:" },
+  { "💹", ":chart:" },
+  { "💺", ":seat:" },
+  { "💻", ":computer:" },
+  { "💼", ":briefcase:" },
+  { "💽", ":minidisc:" },
+  { "💾", ":floppy_disk:" },
+  { "💿", ":cd:" },
+  { "📀", ":dvd:" },
+  { "📁", ":file_folder:" },
+  { "📂", ":open_file_folder:" },
+  { "📃", ":page_with_curl:" },
+  { "📄", ":page_facing_up:" },
+  { "📅", ":date:" },
+  { "📆", ":calendar:" },
+  { "📇", ":card_index:" },
+  { "📈", ":chart_with_upwards_trend:" },
+  { "📉", ":chart_with_downwards_trend:" },
+  { "📊", ":bar_chart:" },
+  { "📋", ":clipboard:" },
+  { "📌", ":pushpin:" },
+  { "📍", ":round_pushpin:" },
+  { "📎", ":paperclip:" },
+  { "📏", ":straight_ruler:" },
+  { "📐", ":triangular_ruler:" },
+  { "📑", ":bookmark_tabs:" },
+  { "📒", ":ledger:" },
+  { "📓", ":notebook:" },
+  { "📔", ":notebook_with_decorative_cover:" },
+  { "📕", ":closed_book:" },
+  { "📖", ":open_book:" },
+  { "📗", ":green_book:" },
+  { "📘", ":blue_book:" },
+  { "📙", ":orange_book:" },
+  { "📚", ":books:" },
+  { "📛", ":name_badge:" },
+  { "📜", ":scroll:" },
+  { "📝", ":pencil:" },
+  { "📞", ":telephone_receiver:" },
+  { "📟", ":pager:" },
+  { "📠", ":fax:" },
+  { "📡", ":satellite:" },
+  { "📢", ":loudspeaker:" },
+  { "📣", ":mega:" },
+  { "📤", ":outbox_tray:" },
+  { "📥", ":inbox_tray:" },
+  { "📦", ":package:" },
+  { "📧", ":e_mail:" },
+  { "📨", ":incoming_envelope:" },
+  { "📩", ":envelope_with_arrow:" },
+  { "📪", ":mailbox_closed:" },
+  { "📫", ":mailbox:" },
+  { "📬", ":mailbox_with_mail:" },
+  { "📭", ":mailbox_with_no_mail:" },
+  { "📮", ":postbox:" },
+  { "📯", ":postal_horn:" },
+  { "📰", ":newspaper:" },
+  { "📱", ":iphone:" },
+  { "📲", ":calling:" },
+  { "📳", ":vibration_mode:" },
+  { "📴", ":mobile_phone_off:" },
+  { "📵", ":no_mobile_phones:" },
+  { "📶", ":signal_strength:" },
+  { "📷", ":camera:" },
+  { "📸", ":camera_with_flash:" },
+  { "📹", ":video_camera:" },
+  { "📺", ":tv:" },
+  { "📻", ":radio:" },
+  { "📼", ":vhs:" },
+  { "📽", ":film_projector:" },
+  { "📿", ":prayer_beads:" },
+  { "🔀", ":twisted_rightwards_arrows:" },
+  { "🔁", ":repeat:" },
+  { "🔂", ":repeat_one:" },
+  { "🔃", ":arrows_clockwise:" },
+  { "🔄", ":arrows_counterclockwise:" },
+  { "🔅", ":low_brightness:" },
+  { "🔆", ":high_brightness:" },
+  { "🔇", ":mute:" },
+  { "🔈", ":speaker:" },
+  { "🔉", ":sound:" },
+  { "🔊", ":loud_sound:" },
+  { "🔋", ":battery:" },
+  { "🔌", ":electric_plug:" },
+  { "🔍", ":mag:" },
+  { "🔎", ":mag_right:" },
+  { "🔏", ":lock_with_ink_pen:" },
+  { "🔐", ":closed_lock_with_key:" },
+  { "🔑", ":key:" },
+  { "🔒", ":lock:" },
+  { "🔓", ":unlock:" },
+  { "🔔", ":bell:" },
+  { "🔕", ":no_bell:" },
+  { "🔖", ":bookmark:" },
+  { "🔗", ":link:" },
+  { "🔘", ":radio_button:" },
+  { "🔙", ":back:" },
+  { "🔚", ":end:" },
+  { "🔛", ":on:" },
+  { "🔜", ":soon:" },
+  { "🔝", ":top:" },
+  { "🔞", ":underage:" },
+  { "🔟", ":keycap_10:" },
+  { "🔠", ":capital_abcd:" },
+  { "🔡", ":abcd:" },
+  { "🔢", ":1234:" },
+  { "🔣", ":symbols:" },
+  { "🔤", ":abc:" },
+  { "🔥", ":fire:" },
+  { "🔦", ":flashlight:" },
+  { "🔧", ":wrench:" },
+  { "🔨", ":hammer:" },
+  { "🔩", ":nut_and_bolt:" },
+  { "🔪", ":knife:" },
+  { "🔫", ":gun:" },
+  { "🔬", ":microscope:" },
+  { "🔭", ":telescope:" },
+  { "🔮", ":crystal_ball:" },
+  { "🔯", ":six_pointed_star:" },
+  { "🔰", ":beginner:" },
+  { "🔱", ":trident:" },
+  { "🔲", ":black_square_button:" },
+  { "🔳", ":white_square_button:" },
+  { "🔴", ":red_circle:" },
+  { "🔵", ":large_blue_circle:" },
+  { "🔶", ":large_orange_diamond:" },
+  { "🔷", ":large_blue_diamond:" },
+  { "🔸", ":small_orange_diamond:" },
+  { "🔹", ":small_blue_diamond:" },
+  { "🔺", ":small_red_triangle:" },
+  { "🔻", ":small_red_triangle_down:" },
+  { "🔼", ":arrow_up_small:" },
+  { "🔽", ":arrow_down_small:" },
+  { "🕉", ":om_symbol:" },
+  { "🕉️", ":om:" },
+  { "🕊", ":dove_of_peace:" },
+  { "🕊️", ":dove:" },
+  { "🕋", ":kaaba:" },
+  { "🕌", ":mosque:" },
+  { "🕍", ":synagogue:" },
+  { "🕎", ":menorah_with_nine_branches:" },
+  { "🕐", ":clock1:" },
+  { "🕑", ":clock2:" },
+  { "🕒", ":clock3:" },
+  { "🕓", ":clock4:" },
+  { "🕔", ":clock5:" },
+  { "🕕", ":clock6:" },
+  { "🕖", ":clock7:" },
+  { "🕗", ":clock8:" },
+  { "🕘", ":clock9:" },
+  { "🕙", ":clock10:" },
+  { "🕚", ":clock11:" },
+  { "🕛", ":clock12:" },
+  { "🕜", ":clock130:" },
+  { "🕝", ":clock230:" },
+  { "🕞", ":clock330:" },
+  { "🕟", ":clock430:" },
+  { "🕠", ":clock530:" },
+  { "🕡", ":clock630:" },
+  { "🕢", ":clock730:" },
+  { "🕣", ":clock830:" },
+  { "🕤", ":clock930:" },
+  { "🕥", ":clock1030:" },
+  { "🕦", ":clock1130:" },
+  { "🕧", ":clock1230:" },
+  { "🕯", ":candle:" },
+  { "🕰", ":mantelpiece_clock:" },
+  { "🕳", ":hole:" },
+  { "🕴", ":man_in_business_suit_levitating:" },
+  { "🕴️", ":person_in_suit_levitating:" },
+  { "🕵", ":sleuth_or_spy:" },
+  { "🕵️", ":detective:" },
+  { "🕵️‍♀️", ":woman_detective:" },
+  { "🕵️‍♂️", ":man_detective:" },
+  { "🕶", ":dark_sunglasses:" },
+  { "🕷", ":spider:" },
+  { "🕸", ":spider_web:" },
+  { "🕹", ":joystick:" },
+  { "🕺", ":man_dancing:" },
+  { "🖇", ":linked_paperclips:" },
+  { "🖊", ":lower_left_ballpoint_pen:" },
+  { "🖊️", ":pen:" },
+  { "🖋", ":lower_left_fountain_pen:" },
+  { "🖋️", ":fountain_pen:" },
+  { "🖌", ":lower_left_paintbrush:" },
+  { "🖌️", ":paintbrush:" },
+  { "🖍", ":lower_left_crayon:" },
+  { "🖍️", ":crayon:" },
+  { "🖐", ":raised_hand_with_fingers_splayed:" },
+  { "🖐️", ":hand_with_fingers_splayed:" },
+  { "🖕", ":reversed_hand_with_middle_finger_extended:" },
+  { "🖖", ":raised_hand_with_part_between_middle_and_ring_fingers:" },
+  { "🖤", ":black_heart:" },
+  { "🖥", ":desktop_computer:" },
+  { "🖨", ":printer:" },
+  { "🖱", ":three_button_mouse:" },
+  { "🖱️", ":computer_mouse:" },
+  { "🖲", ":trackball:" },
+  { "🖼", ":frame_with_picture:" },
+  { "🖼️", ":framed_picture:" },
+  { "🗂", ":card_index_dividers:" },
+  { "🗃", ":card_file_box:" },
+  { "🗄", ":file_cabinet:" },
+  { "🗑", ":wastebasket:" },
+  { "🗒", ":spiral_note_pad:" },
+  { "🗒️", ":spiral_notepad:" },
+  { "🗓", ":spiral_calendar_pad:" },
+  { "🗓️", ":spiral_calendar:" },
+  { "🗜", ":compression:" },
+  { "🗜️", ":clamp:" },
+  { "🗝", ":old_key:" },
+  { "🗞", ":rolled_up_newspaper:" },
+  { "🗡", ":dagger_knife:" },
+  { "🗡️", ":dagger:" },
+  { "🗣", ":speaking_head_in_silhouette:" },
+  { "🗣️", ":speaking_head:" },
+  { "🗨️", ":left_speech_bubble:" },
+  { "🗯", ":right_anger_bubble:" },
+  { "🗳", ":ballot_box_with_ballot:" },
+  { "🗺", ":world_map:" },
+  { "🗻", ":mount_fuji:" },
+  { "🗼", ":tokyo_tower:" },
+  { "🗽", ":statue_of_liberty:" },
+  { "🗾", ":japan:" },
+  { "🗿", ":moyai:" },
+  { "😀", ":grinning:" },
+  { "😁", ":grin:" },
+  { "😂", ":joy:" },
+  { "😃", ":smiley:" },
+  { "😄", ":smile:" },
+  { "😅", ":sweat_smile:" },
+  { "😆", ":satisfied:" },
+  { "😇", ":innocent:" },
+  { "😈", ":smiling_imp:" },
+  { "😉", ":wink:" },
+  { "😊", ":blush:" },
+  { "😋", ":yum:" },
+  { "😌", ":relieved:" },
+  { "😍", ":heart_eyes:" },
+  { "😎", ":sunglasses:" },
+  { "😏", ":smirk:" },
+  { "😐", ":neutral_face:" },
+  { "😑", ":expressionless:" },
+  { "😒", ":unamused:" },
+  { "😓", ":sweat:" },
+  { "😔", ":pensive:" },
+  { "😕", ":confused:" },
+  { "😖", ":confounded:" },
+  { "😗", ":kissing:" },
+  { "😘", ":kissing_heart:" },
+  { "😙", ":kissing_smiling_eyes:" },
+  { "😚", ":kissing_closed_eyes:" },
+  { "😛", ":stuck_out_tongue:" },
+  { "😜", ":stuck_out_tongue_winking_eye:" },
+  { "😝", ":stuck_out_tongue_closed_eyes:" },
+  { "😞", ":disappointed:" },
+  { "😟", ":worried:" },
+  { "😠", ":angry:" },
+  { "😡", ":rage:" },
+  { "😢", ":cry:" },
+  { "😣", ":persevere:" },
+  { "😤", ":triumph:" },
+  { "😥", ":disappointed_relieved:" },
+  { "😦", ":frowning:" },
+  { "😧", ":anguished:" },
+  { "😨", ":fearful:" },
+  { "😩", ":weary:" },
+  { "😪", ":sleepy:" },
+  { "😫", ":tired_face:" },
+  { "😬", ":grimacing:" },
+  { "😭", ":sob:" },
+  { "😮", ":open_mouth:" },
+  { "😮‍💨", ":face_exhaling:" },
+  { "😯", ":hushed:" },
+  { "😰", ":cold_sweat:" },
+  { "😱", ":scream:" },
+  { "😲", ":astonished:" },
+  { "😳", ":flushed:" },
+  { "😴", ":sleeping:" },
+  { "😵", ":dizzy_face:" },
+  { "😵‍💫", ":face_with_spiral_eyes:" },
+  { "😶", ":no_mouth:" },
+  { "😶‍🌫️", ":face_in_clouds:" },
+  { "😷", ":mask:" },
+  { "😸", ":smile_cat:" },
+  { "😹", ":joy_cat:" },
+  { "😺", ":smiley_cat:" },
+  { "😻", ":heart_eyes_cat:" },
+  { "😼", ":smirk_cat:" },
+  { "😽", ":kissing_cat:" },
+  { "😾", ":pouting_cat:" },
+  { "😿", ":crying_cat_face:" },
+  { "🙀", ":scream_cat:" },
+  { "🙁", ":slightly_frowning_face:" },
+  { "🙂", ":slightly_smiling_face:" },
+  { "🙃", ":upside_down_face:" },
+  { "🙄", ":face_with_rolling_eyes:" },
+  { "🙅", ":no_good:" },
+  { "🙅‍♀️", ":woman_gesturing_no:" },
+  { "🙅‍♂️", ":man_gesturing_no:" },
+  { "🙆", ":ok_woman:" },
+  { "🙆‍♀️", ":woman_gesturing_ok:" },
+  { "🙆‍♂️", ":man_gesturing_ok:" },
+  { "🙇", ":bow:" },
+  { "🙇‍♀️", ":woman_bowing:" },
+  { "🙇‍♂️", ":man_bowing:" },
+  { "🙈", ":see_no_evil:" },
+  { "🙉", ":hear_no_evil:" },
+  { "🙊", ":speak_no_evil:" },
+  { "🙋", ":raising_hand:" },
+  { "🙋‍♀️", ":woman_raising_hand:" },
+  { "🙋‍♂️", ":man_raising_hand:" },
+  { "🙌", ":raised_hands:" },
+  { "🙍", ":person_frowning:" },
+  { "🙍‍♀️", ":woman_frowning:" },
+  { "🙍‍♂️", ":man_frowning:" },
+  { "🙎", ":person_with_pouting_face:" },
+  { "🙎‍♀️", ":woman_pouting:" },
+  { "🙎‍♂️", ":man_pouting:" },
+  { "🙏", ":pray:" },
+  { "🚀", ":rocket:" },
+  { "🚁", ":helicopter:" },
+  { "🚂", ":steam_locomotive:" },
+  { "🚃", ":railway_car:" },
+  { "🚄", ":bullettrain_side:" },
+  { "🚅", ":bullettrain_front:" },
+  { "🚆", ":train2:" },
+  { "🚇", ":metro:" },
+  { "🚈", ":light_rail:" },
+  { "🚉", ":station:" },
+  { "🚊", ":tram:" },
+  { "🚋", ":train:" },
+  { "🚌", ":bus:" },
+  { "🚍", ":oncoming_bus:" },
+  { "🚎", ":trolleybus:" },
+  { "🚏", ":busstop:" },
+  { "🚐", ":minibus:" },
+  { "🚑", ":ambulance:" },
+  { "🚒", ":fire_engine:" },
+  { "🚓", ":police_car:" },
+  { "🚔", ":oncoming_police_car:" },
+  { "🚕", ":taxi:" },
+  { "🚖", ":oncoming_taxi:" },
+  { "🚗", ":red_car:" },
+  { "🚘", ":oncoming_automobile:" },
+  { "🚙", ":blue_car:" },
+  { "🚚", ":truck:" },
+  { "🚛", ":articulated_lorry:" },
+  { "🚜", ":tractor:" },
+  { "🚝", ":monorail:" },
+  { "🚞", ":mountain_railway:" },
+  { "🚟", ":suspension_railway:" },
+  { "🚠", ":mountain_cableway:" },
+  { "🚡", ":aerial_tramway:" },
+  { "🚢", ":ship:" },
+  { "🚣", ":rowboat:" },
+  { "🚣‍♀️", ":woman_rowing_boat:" },
+  { "🚣‍♂️", ":man_rowing_boat:" },
+  { "🚤", ":speedboat:" },
+  { "🚥", ":traffic_light:" },
+  { "🚦", ":vertical_traffic_light:" },
+  { "🚧", ":construction:" },
+  { "🚨", ":rotating_light:" },
+  { "🚩", ":triangular_flag_on_post:" },
+  { "🚪", ":door:" },
+  { "🚫", ":no_entry_sign:" },
+  { "🚬", ":smoking:" },
+  { "🚭", ":no_smoking:" },
+  { "🚮", ":put_litter_in_its_place:" },
+  { "🚯", ":do_not_litter:" },
+  { "🚰", ":potable_water:" },
+  { "🚱", ":non_potable_water:" },
+  { "🚲", ":bike:" },
+  { "🚳", ":no_bicycles:" },
+  { "🚴", ":bicyclist:" },
+  { "🚴‍♀️", ":woman_biking:" },
+  { "🚴‍♂️", ":man_biking:" },
+  { "🚵", ":mountain_bicyclist:" },
+  { "🚵‍♀️", ":woman_mountain_biking:" },
+  { "🚵‍♂️", ":man_mountain_biking:" },
+  { "🚶", ":walking:" },
+  { "🚶‍♀️", ":woman_walking:" },
+  { "🚶‍♂️", ":man_walking:" },
+  { "🚷", ":no_pedestrians:" },
+  { "🚸", ":children_crossing:" },
+  { "🚹", ":mens:" },
+  { "🚺", ":womens:" },
+  { "🚻", ":restroom:" },
+  { "🚼", ":baby_symbol:" },
+  { "🚽", ":toilet:" },
+  { "🚾", ":wc:" },
+  { "🚿", ":shower:" },
+  { "🛀", ":bath:" },
+  { "🛁", ":bathtub:" },
+  { "🛂", ":passport_control:" },
+  { "🛃", ":customs:" },
+  { "🛄", ":baggage_claim:" },
+  { "🛅", ":left_luggage:" },
+  { "🛋", ":couch_and_lamp:" },
+  { "🛌", ":sleeping_accommodation:" },
+  { "🛍", ":shopping_bags:" },
+  { "🛎", ":bellhop_bell:" },
+  { "🛏", ":bed:" },
+  { "🛐", ":place_of_worship:" },
+  { "🛑", ":stop_sign:" },
+  { "🛒", ":shopping_cart:" },
+  { "🛕", ":hindu_temple:" },
+  { "🛖", ":hut:" },
+  { "🛗", ":elevator:" },
+  { "🛝", ":playground_slide:" },
+  { "🛞", ":wheel:" },
+  { "🛟", ":ring_buoy:" },
+  { "🛠", ":hammer_and_wrench:" },
+  { "🛡", ":shield:" },
+  { "🛢", ":oil_drum:" },
+  { "🛣", ":motorway:" },
+  { "🛤", ":railway_track:" },
+  { "🛥", ":motor_boat:" },
+  { "🛩", ":small_airplane:" },
+  { "🛫", ":airplane_departure:" },
+  { "🛬", ":airplane_arriving:" },
+  { "🛳", ":passenger_ship:" },
+  { "🛴", ":kick_scooter:" },
+  { "🛵", ":motor_scooter:" },
+  { "🛶", ":canoe:" },
+  { "🛷", ":sled:" },
+  { "🛸", ":flying_saucer:" },
+  { "🛹", ":skateboard:" },
+  { "🛺", ":auto_rickshaw:" },
+  { "🛻", ":pickup_truck:" },
+  { "🛼", ":roller_skate:" },
+  { "🟠", ":orange_circle:" },
+  { "🟡", ":yellow_circle:" },
+  { "🟢", ":green_circle:" },
+  { "🟣", ":purple_circle:" },
+  { "🟤", ":brown_circle:" },
+  { "🟥", ":red_square:" },
+  { "🟦", ":blue_square:" },
+  { "🟧", ":orange_square:" },
+  { "🟨", ":yellow_square:" },
+  { "🟩", ":green_square:" },
+  { "🟪", ":purple_square:" },
+  { "🟫", ":brown_square:" },
+  { "🟰", ":heavy_equals_sign:" },
+  { "🤌", ":pinched_fingers:" },
+  { "🤍", ":white_heart:" },
+  { "🤎", ":brown_heart:" },
+  { "🤏", ":pinching_hand:" },
+  { "🤐", ":zipper_mouth_face:" },
+  { "🤑", ":money_mouth_face:" },
+  { "🤒", ":face_with_thermometer:" },
+  { "🤓", ":nerd_face:" },
+  { "🤔", ":thinking_face:" },
+  { "🤕", ":face_with_head_bandage:" },
+  { "🤖", ":robot_face:" },
+  { "🤗", ":hugging_face:" },
+  { "🤘", ":sign_of_the_horns:" },
+  { "🤙", ":call_me_hand:" },
+  { "🤚", ":raised_back_of_hand:" },
+  { "🤛", ":left_facing_fist:" },
+  { "🤜", ":right_facing_fist:" },
+  { "🤝", ":handshake:" },
+  { "🤞", ":crossed_fingers:" },
+  { "🤟", ":love_you_gesture:" },
+  { "🤠", ":cowboy_hat_face:" },
+  { "🤡", ":clown_face:" },
+  { "🤢", ":nauseated_face:" },
+  { "🤣", ":rolling_on_the_floor_laughing:" },
+  { "🤤", ":drooling_face:" },
+  { "🤥", ":lying_face:" },
+  { "🤦", ":person_facepalming:" },
+  { "🤦‍♀️", ":woman_facepalming:" },
+  { "🤦‍♂️", ":man_facepalming:" },
+  { "🤧", ":sneezing_face:" },
+  { "🤨", ":face_with_raised_eyebrow:" },
+  { "🤩", ":star_struck:" },
+  { "🤪", ":zany_face:" },
+  { "🤫", ":shushing_face:" },
+  { "🤬", ":face_with_symbols_on_mouth:" },
+  { "🤭", ":face_with_hand_over_mouth:" },
+  { "🤮", ":face_vomiting:" },
+  { "🤯", ":exploding_head:" },
+  { "🤰", ":pregnant_woman:" },
+  { "🤱", ":breast_feeding:" },
+  { "🤲", ":palms_up_together:" },
+  { "🤳", ":selfie:" },
+  { "🤴", ":prince:" },
+  { "🤵", ":person_in_tuxedo:" },
+  { "🤵‍♀️", ":woman_in_tuxedo:" },
+  { "🤵‍♂️", ":man_in_tuxedo:" },
+  { "🤶", ":mrs_claus:" },
+  { "🤷", ":person_shrugging:" },
+  { "🤷‍♀️", ":woman_shrugging:" },
+  { "🤷‍♂️", ":man_shrugging:" },
+  { "🤸", ":person_cartwheeling:" },
+  { "🤸‍♀️", ":woman_cartwheeling:" },
+  { "🤸‍♂️", ":man_cartwheeling:" },
+  { "🤹", ":person_juggling:" },
+  { "🤹‍♀️", ":woman_juggling:" },
+  { "🤹‍♂️", ":man_juggling:" },
+  { "🤺", ":person_fencing:" },
+  { "🤼", ":people_wrestling:" },
+  { "🤼‍♀️", ":women_wrestling:" },
+  { "🤼‍♂️", ":men_wrestling:" },
+  { "🤽", ":person_playing_water_polo:" },
+  { "🤽‍♀️", ":woman_playing_water_polo:" },
+  { "🤽‍♂️", ":man_playing_water_polo:" },
+  { "🤾", ":person_playing_handball:" },
+  { "🤾‍♀️", ":woman_playing_handball:" },
+  { "🤾‍♂️", ":man_playing_handball:" },
+  { "🤿", ":diving_mask:" },
+  { "🥀", ":wilted_flower:" },
+  { "🥁", ":drum:" },
+  { "🥂", ":clinking_glasses:" },
+  { "🥃", ":tumbler_glass:" },
+  { "🥄", ":spoon:" },
+  { "🥅", ":goal_net:" },
+  { "🥇", ":1st_place_medal:" },
+  { "🥈", ":2nd_place_medal:" },
+  { "🥉", ":3rd_place_medal:" },
+  { "🥊", ":boxing_glove:" },
+  { "🥋", ":martial_arts_uniform:" },
+  { "🥌", ":curling_stone:" },
+  { "🥍", ":lacrosse:" },
+  { "🥎", ":softball:" },
+  { "🥏", ":flying_disc:" },
+  { "🥐", ":croissant:" },
+  { "🥑", ":avocado:" },
+  { "🥒", ":cucumber:" },
+  { "🥓", ":bacon:" },
+  { "🥔", ":potato:" },
+  { "🥕", ":carrot:" },
+  { "🥖", ":baguette_bread:" },
+  { "🥗", ":green_salad:" },
+  { "🥘", ":shallow_pan_of_food:" },
+  { "🥙", ":stuffed_flatbread:" },
+  { "🥛", ":glass_of_milk:" },
+  { "🥜", ":peanuts:" },
+  { "🥝", ":kiwi_fruit:" },
+  { "🥞", ":pancakes:" },
+  { "🥟", ":dumpling:" },
+  { "🥠", ":fortune_cookie:" },
+  { "🥡", ":takeout_box:" },
+  { "🥢", ":chopsticks:" },
+  { "🥣", ":bowl_with_spoon:" },
+  { "🥤", ":cup_with_straw:" },
+  { "🥥", ":coconut:" },
+  { "🥦", ":broccoli:" },
+  { "🥧", ":pie:" },
+  { "🥨", ":pretzel:" },
+  { "🥩", ":cut_of_meat:" },
+  { "🥪", ":sandwich:" },
+  { "🥫", ":canned_food:" },
+  { "🥬", ":leafy_green:" },
+  { "🥭", ":mango:" },
+  { "🥮", ":moon_cake:" },
+  { "🥯", ":bagel:" },
+  { "🥰", ":smiling_face_with_hearts:" },
+  { "🥱", ":yawning_face:" },
+  { "🥲", ":smiling_face_with_tear:" },
+  { "🥳", ":partying_face:" },
+  { "🥴", ":woozy_face:" },
+  { "🥵", ":hot_face:" },
+  { "🥶", ":cold_face:" },
+  { "🥷", ":ninja:" },
+  { "🥸", ":disguised_face:" },
+  { "🥹", ":face_holding_back_tears:" },
+  { "🥺", ":pleading_face:" },
+  { "🥻", ":sari:" },
+  { "🥼", ":lab_coat:" },
+  { "🥽", ":goggles:" },
+  { "🥾", ":hiking_boot:" },
+  { "🥿", ":flat_shoe:" },
+  { "🦀", ":crab:" },
+  { "🦁", ":lion_face:" },
+  { "🦂", ":scorpion:" },
+  { "🦃", ":turkey:" },
+  { "🦄", ":unicorn_face:" },
+  { "🦅", ":eagle:" },
+  { "🦆", ":duck:" },
+  { "🦇", ":bat:" },
+  { "🦈", ":shark:" },
+  { "🦉", ":owl:" },
+  { "🦊", ":fox:" },
+  { "🦋", ":butterfly:" },
+  { "🦌", ":deer:" },
+  { "🦍", ":gorilla:" },
+  { "🦎", ":lizard:" },
+  { "🦏", ":rhinoceros:" },
+  { "🦐", ":shrimp:" },
+  { "🦑", ":squid:" },
+  { "🦒", ":giraffe:" },
+  { "🦓", ":zebra:" },
+  { "🦔", ":hedgehog:" },
+  { "🦕", ":sauropod:" },
+  { "🦖", ":t_rex:" },
+  { "🦗", ":cricket:" },
+  { "🦘", ":kangaroo:" },
+  { "🦙", ":llama:" },
+  { "🦚", ":peacock:" },
+  { "🦛", ":hippopotamus:" },
+  { "🦜", ":parrot:" },
+  { "🦝", ":raccoon:" },
+  { "🦞", ":lobster:" },
+  { "🦟", ":mosquito:" },
+  { "🦠", ":microbe:" },
+  { "🦡", ":badger:" },
+  { "🦢", ":swan:" },
+  { "🦣", ":mammoth:" },
+  { "🦤", ":dodo:" },
+  { "🦥", ":sloth:" },
+  { "🦦", ":otter:" },
+  { "🦧", ":orangutan:" },
+  { "🦨", ":skunk:" },
+  { "🦩", ":flamingo:" },
+  { "🦪", ":oyster:" },
+  { "🦫", ":beaver:" },
+  { "🦬", ":bison:" },
+  { "🦭", ":seal:" },
+  { "🦮", ":guide_dog:" },
+  { "🦯", ":white_cane:" },
+  { "🦰", ":red_hair:" },
+  { "🦱", ":curly_hair:" },
+  { "🦲", ":bald:" },
+  { "🦳", ":white_hair:" },
+  { "🦴", ":bone:" },
+  { "🦵", ":leg:" },
+  { "🦶", ":foot:" },
+  { "🦷", ":tooth:" },
+  { "🦸", ":superhero:" },
+  { "🦸‍♀️", ":woman_superhero:" },
+  { "🦸‍♂️", ":man_superhero:" },
+  { "🦹", ":supervillain:" },
+  { "🦹‍♀️", ":woman_supervillain:" },
+  { "🦹‍♂️", ":man_supervillain:" },
+  { "🦺", ":safety_vest:" },
+  { "🦻", ":ear_with_hearing_aid:" },
+  { "🦼", ":motorized_wheelchair:" },
+  { "🦽", ":manual_wheelchair:" },
+  { "🦾", ":mechanical_arm:" },
+  { "🦿", ":mechanical_leg:" },
+  { "🧀", ":cheese_wedge:" },
+  { "🧁", ":cupcake:" },
+  { "🧂", ":salt:" },
+  { "🧃", ":beverage_box:" },
+  { "🧄", ":garlic:" },
+  { "🧅", ":onion:" },
+  { "🧆", ":falafel:" },
+  { "🧇", ":waffle:" },
+  { "🧈", ":butter:" },
+  { "🧉", ":mate:" },
+  { "🧊", ":ice:" },
+  { "🧋", ":bubble_tea:" },
+  { "🧌", ":troll:" },
+  { "🧍", ":person_standing:" },
+  { "🧍‍♀️", ":woman_standing:" },
+  { "🧍‍♂️", ":man_standing:" },
+  { "🧎", ":person_kneeling:" },
+  { "🧎‍♀️", ":woman_kneeling:" },
+  { "🧎‍♂️", ":man_kneeling:" },
+  { "🧏", ":deaf_person:" },
+  { "🧏‍♀️", ":deaf_woman:" },
+  { "🧏‍♂️", ":deaf_man:" },
+  { "🧐", ":face_with_monocle:" },
+  { "🧑", ":person:" },
+  { "🧑‍⚕️", ":health_worker:" },
+  { "🧑‍⚖️", ":judge:" },
+  { "🧑‍✈️", ":pilot:" },
+  { "🧑‍🌾", ":farmer:" },
+  { "🧑‍🍳", ":cook:" },
+  { "🧑‍🍼", ":person_feeding_baby:" },
+  { "🧑‍🎄", ":mx_claus:" },
+  { "🧑‍🎓", ":student:" },
+  { "🧑‍🎤", ":singer:" },
+  { "🧑‍🎨", ":artist:" },
+  { "🧑‍🏫", ":teacher:" },
+  { "🧑‍🏭", ":factory_worker:" },
+  { "🧑‍💻", ":technologist:" },
+  { "🧑‍💼", ":office_worker:" },
+  { "🧑‍🔧", ":mechanic:" },
+  { "🧑‍🔬", ":scientist:" },
+  { "🧑‍🚀", ":astronaut:" },
+  { "🧑‍🚒", ":firefighter:" },
+  { "🧑‍🤝‍🧑", ":people_holding_hands:" },
+  { "🧑‍🦯", ":person_with_white_cane:" },
+  { "🧑‍🦰", ":person_red_hair:" },
+  { "🧑‍🦱", ":person_curly_hair:" },
+  { "🧑‍🦲", ":person_bald:" },
+  { "🧑‍🦳", ":person_white_hair:" },
+  { "🧑‍🦼", ":person_in_motorized_wheelchair:" },
+  { "🧑‍🦽", ":person_in_manual_wheelchair:" },
+  { "🧒", ":child:" },
+  { "🧓", ":older_person:" },
+  { "🧔", ":person_beard:" },
+  { "🧔‍♀️", ":woman_beard:" },
+  { "🧔‍♂️", ":man_beard:" },
+  { "🧕", ":woman_with_headscarf:" },
+  { "🧖", ":person_in_steamy_room:" },
+  { "🧖‍♀️", ":woman_in_steamy_room:" },
+  { "🧖‍♂️", ":man_in_steamy_room:" },
+  { "🧗", ":person_climbing:" },
+  { "🧗‍♀️", ":woman_climbing:" },
+  { "🧗‍♂️", ":man_climbing:" },
+  { "🧘", ":person_in_lotus_position:" },
+  { "🧘‍♀️", ":woman_in_lotus_position:" },
+  { "🧘‍♂️", ":man_in_lotus_position:" },
+  { "🧙", ":mage:" },
+  { "🧙‍♀️", ":woman_mage:" },
+  { "🧙‍♂️", ":man_mage:" },
+  { "🧚", ":fairy:" },
+  { "🧚‍♀️", ":woman_fairy:" },
+  { "🧚‍♂️", ":man_fairy:" },
+  { "🧛", ":vampire:" },
+  { "🧛‍♀️", ":woman_vampire:" },
+  { "🧛‍♂️", ":man_vampire:" },
+  { "🧜", ":merperson:" },
+  { "🧜‍♀️", ":mermaid:" },
+  { "🧜‍♂️", ":merman:" },
+  { "🧝", ":elf:" },
+  { "🧝‍♀️", ":woman_elf:" },
+  { "🧝‍♂️", ":man_elf:" },
+  { "🧞", ":genie:" },
+  { "🧞‍♀️", ":woman_genie:" },
+  { "🧞‍♂️", ":man_genie:" },
+  { "🧟", ":zombie:" },
+  { "🧟‍♀️", ":woman_zombie:" },
+  { "🧟‍♂️", ":man_zombie:" },
+  { "🧠", ":brain:" },
+  { "🧡", ":orange_heart:" },
+  { "🧢", ":billed_cap:" },
+  { "🧣", ":scarf:" },
+  { "🧤", ":gloves:" },
+  { "🧥", ":coat:" },
+  { "🧦", ":socks:" },
+  { "🧧", ":red_envelope:" },
+  { "🧨", ":firecracker:" },
+  { "🧩", ":puzzle_piece:" },
+  { "🧪", ":test_tube:" },
+  { "🧫", ":petri_dish:" },
+  { "🧬", ":dna:" },
+  { "🧭", ":compass:" },
+  { "🧮", ":abacus:" },
+  { "🧯", ":fire_extinguisher:" },
+  { "🧰", ":toolbox:" },
+  { "🧱", ":brick:" },
+  { "🧲", ":magnet:" },
+  { "🧳", ":luggage:" },
+  { "🧴", ":lotion_bottle:" },
+  { "🧵", ":thread:" },
+  { "🧶", ":yarn:" },
+  { "🧷", ":safety_pin:" },
+  { "🧸", ":teddy_bear:" },
+  { "🧹", ":broom:" },
+  { "🧺", ":basket:" },
+  { "🧻", ":roll_of_paper:" },
+  { "🧼", ":soap:" },
+  { "🧽", ":sponge:" },
+  { "🧾", ":receipt:" },
+  { "🧿", ":nazar_amulet:" },
+  { "🩰", ":ballet_shoes:" },
+  { "🩱", ":one_piece_swimsuit:" },
+  { "🩲", ":briefs:" },
+  { "🩳", ":shorts:" },
+  { "🩴", ":thong_sandal:" },
+  { "🩸", ":drop_of_blood:" },
+  { "🩹", ":adhesive_bandage:" },
+  { "🩺", ":stethoscope:" },
+  { "🩻", ":x_ray:" },
+  { "🩼", ":crutch:" },
+  { "🪀", ":yo_yo:" },
+  { "🪁", ":kite:" },
+  { "🪂", ":parachute:" },
+  { "🪃", ":boomerang:" },
+  { "🪄", ":magic_wand:" },
+  { "🪅", ":pinata:" },
+  { "🪆", ":nesting_dolls:" },
+  { "🪐", ":ringed_planet:" },
+  { "🪑", ":chair:" },
+  { "🪒", ":razor:" },
+  { "🪓", ":axe:" },
+  { "🪔", ":diya_lamp:" },
+  { "🪕", ":banjo:" },
+  { "🪖", ":military_helmet:" },
+  { "🪗", ":accordion:" },
+  { "🪘", ":long_drum:" },
+  { "🪙", ":coin:" },
+  { "🪚", ":carpentry_saw:" },
+  { "🪛", ":screwdriver:" },
+  { "🪜", ":ladder:" },
+  { "🪝", ":hook:" },
+  { "🪞", ":mirror:" },
+  { "🪟", ":window:" },
+  { "🪠", ":plunger:" },
+  { "🪡", ":sewing_needle:" },
+  { "🪢", ":knot:" },
+  { "🪣", ":bucket:" },
+  { "🪤", ":mouse_trap:" },
+  { "🪥", ":toothbrush:" },
+  { "🪦", ":headstone:" },
+  { "🪧", ":placard:" },
+  { "🪨", ":rock:" },
+  { "🪩", ":mirror_ball:" },
+  { "🪪", ":identification_card:" },
+  { "🪫", ":low_battery:" },
+  { "🪬", ":hamsa:" },
+  { "🪰", ":fly:" },
+  { "🪱", ":worm:" },
+  { "🪳", ":cockroach:" },
+  { "🪴", ":potted_plant:" },
+  { "🪵", ":wood:" },
+  { "🪶", ":feather:" },
+  { "🪷", ":lotus:" },
+  { "🪸", ":coral:" },
+  { "🪹", ":empty_nest:" },
+  { "🪺", ":nest_with_eggs:" },
+  { "🫀", ":anatomical_heart:" },
+  { "🫁", ":lungs:" },
+  { "🫂", ":people_hugging:" },
+  { "🫃", ":pregnant_man:" },
+  { "🫄", ":pregnant_person:" },
+  { "🫅", ":person_with_crown:" },
+  { "🫐", ":blueberries:" },
+  { "🫑", ":bell_pepper:" },
+  { "🫒", ":olive:" },
+  { "🫓", ":flatbread:" },
+  { "🫔", ":tamale:" },
+  { "🫕", ":fondue:" },
+  { "🫖", ":teapot:" },
+  { "🫗", ":pouring_liquid:" },
+  { "🫘", ":beans:" },
+  { "🫙", ":jar:" },
+  { "🫠", ":melting_face:" },
+  { "🫡", ":saluting_face:" },
+  { "🫢", ":face_with_open_eyes_and_hand_over_mouth:" },
+  { "🫣", ":face_with_peeking_eye:" },
+  { "🫤", ":face_with_diagonal_mouth:" },
+  { "🫥", ":dotted_line_face:" },
+  { "🫦", ":biting_lip:" },
+  { "🫧", ":bubbles:" },
+  { "🫰", ":hand_with_index_finger_and_thumb_crossed:" },
+  { "🫱", ":rightwards_hand:" },
+  { "🫲", ":leftwards_hand:" },
+  { "🫳", ":palm_down_hand:" },
+  { "🫴", ":palm_up_hand:" },
+  { "🫵", ":index_pointing_at_the_viewer:" },
+  { "🫶", ":heart_hands:" },
+};
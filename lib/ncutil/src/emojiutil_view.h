@@ -1,1357 +1,1358 @@
-static std::set<std::string> s_View = {
-  { ":100:" },
-  { ":1234:" },
-  { ":1st_place_medal:" },
-  { ":2nd_place_medal:" },
-  { ":3rd_place_medal:" },
-  { ":8ball:" },
-  { ":a:" },
-  { ":ab:" },
-  { ":abacus:" },
-  { ":abc:" },
-  { ":abcd:" },
-  { ":accept:" },
-  { ":accordion:" },
-  { ":adhesive_bandage:" },
-  { ":admission_tickets:" },
-  { ":aerial_tramway:" },
-  { ":airplane:" },
-  { ":airplane_arriving:" },
-  { ":airplane_departure:" },
-  { ":alarm_clock:" },
-  { ":alembic:" },
-  { ":alien:" },
-  { ":ambulance:" },
-  { ":amphora:" },
-  { ":anatomical_heart:" },
-  { ":anchor:" },
-  { ":angel:" },
-  { ":anger:" },
-  { ":angry:" },
-  { ":anguished:" },
-  { ":ant:" },
-  { ":apple:" },
-  { ":aquarius:" },
-  { ":aries:" },
-  { ":arrow_backward:" },
-  { ":arrow_double_down:" },
-  { ":arrow_double_up:" },
-  { ":arrow_down:" },
-  { ":arrow_down_small:" },
-  { ":arrow_forward:" },
-  { ":arrow_heading_down:" },
-  { ":arrow_heading_up:" },
-  { ":arrow_left:" },
-  { ":arrow_lower_left:" },
-  { ":arrow_lower_right:" },
-  { ":arrow_right:" },
-  { ":arrow_right_hook:" },
-  { ":arrow_up:" },
-  { ":arrow_up_down:" },
-  { ":arrow_up_small:" },
-  { ":arrow_upper_left:" },
-  { ":arrow_upper_right:" },
-  { ":arrows_clockwise:" },
-  { ":arrows_counterclockwise:" },
-  { ":art:" },
-  { ":articulated_lorry:" },
-  { ":astonished:" },
-  { ":athletic_shoe:" },
-  { ":atm:" },
-  { ":atom_symbol:" },
-  { ":auto_rickshaw:" },
-  { ":avocado:" },
-  { ":axe:" },
-  { ":b:" },
-  { ":baby:" },
-  { ":baby_bottle:" },
-  { ":baby_chick:" },
-  { ":baby_symbol:" },
-  { ":back:" },
-  { ":bacon:" },
-  { ":badger:" },
-  { ":badminton_racquet_and_shuttlecock:" },
-  { ":bagel:" },
-  { ":baggage_claim:" },
-  { ":baguette_bread:" },
-  { ":bald:" },
-  { ":ballet_shoes:" },
-  { ":balloon:" },
-  { ":ballot_box_with_ballot:" },
-  { ":ballot_box_with_check:" },
-  { ":bamboo:" },
-  { ":banana:" },
-  { ":bangbang:" },
-  { ":banjo:" },
-  { ":bank:" },
-  { ":bar_chart:" },
-  { ":barber:" },
-  { ":baseball:" },
-  { ":basket:" },
-  { ":basketball:" },
-  { ":bat:" },
-  { ":bath:" },
-  { ":bathtub:" },
-  { ":battery:" },
-  { ":beach_with_umbrella:" },
-  { ":beans:" },
-  { ":bear:" },
-  { ":beaver:" },
-  { ":bed:" },
-  { ":beer:" },
-  { ":beers:" },
-  { ":beetle:" },
-  { ":beginner:" },
-  { ":bell:" },
-  { ":bell_pepper:" },
-  { ":bellhop_bell:" },
-  { ":bento:" },
-  { ":beverage_box:" },
-  { ":bicyclist:" },
-  { ":bike:" },
-  { ":bikini:" },
-  { ":billed_cap:" },
-  { ":biohazard_sign:" },
-  { ":bird:" },
-  { ":birthday:" },
-  { ":bison:" },
-  { ":biting_lip:" },
-  { ":black_circle:" },
-  { ":black_circle_for_record:" },
-  { ":black_heart:" },
-  { ":black_joker:" },
-  { ":black_large_square:" },
-  { ":black_left_pointing_double_triangle_with_vertical_bar:" },
-  { ":black_medium_small_square:" },
-  { ":black_medium_square:" },
-  { ":black_nib:" },
-  { ":black_right_pointing_double_triangle_with_vertical_bar:" },
-  { ":black_right_pointing_triangle_with_double_vertical_bar:" },
-  { ":black_small_square:" },
-  { ":black_square_button:" },
-  { ":black_square_for_stop:" },
-  { ":blossom:" },
-  { ":blowfish:" },
-  { ":blue_book:" },
-  { ":blue_car:" },
-  { ":blue_heart:" },
-  { ":blue_square:" },
-  { ":blueberries:" },
-  { ":blush:" },
-  { ":boar:" },
-  { ":bomb:" },
-  { ":bone:" },
-  { ":bookmark:" },
-  { ":bookmark_tabs:" },
-  { ":books:" },
-  { ":boomerang:" },
-  { ":boot:" },
-  { ":bottle_with_popping_cork:" },
-  { ":bouquet:" },
-  { ":bow:" },
-  { ":bow_and_arrow:" },
-  { ":bowl_with_spoon:" },
-  { ":bowling:" },
-  { ":boxing_glove:" },
-  { ":boy:" },
-  { ":brain:" },
-  { ":bread:" },
-  { ":breast_feeding:" },
-  { ":brick:" },
-  { ":bride_with_veil:" },
-  { ":bridge_at_night:" },
-  { ":briefcase:" },
-  { ":briefs:" },
-  { ":broccoli:" },
-  { ":broken_heart:" },
-  { ":broom:" },
-  { ":brown_circle:" },
-  { ":brown_heart:" },
-  { ":brown_square:" },
-  { ":bubble_tea:" },
-  { ":bubbles:" },
-  { ":bucket:" },
-  { ":bug:" },
-  { ":building_construction:" },
-  { ":bulb:" },
-  { ":bullettrain_front:" },
-  { ":bullettrain_side:" },
-  { ":burrito:" },
-  { ":bus:" },
-  { ":busstop:" },
-  { ":bust_in_silhouette:" },
-  { ":busts_in_silhouette:" },
-  { ":butter:" },
-  { ":butterfly:" },
-  { ":cactus:" },
-  { ":cake:" },
-  { ":calendar:" },
-  { ":call_me_hand:" },
-  { ":calling:" },
-  { ":camel:" },
-  { ":camera:" },
-  { ":camera_with_flash:" },
-  { ":camping:" },
-  { ":cancer:" },
-  { ":candle:" },
-  { ":candy:" },
-  { ":canned_food:" },
-  { ":canoe:" },
-  { ":capital_abcd:" },
-  { ":capricorn:" },
-  { ":card_file_box:" },
-  { ":card_index:" },
-  { ":card_index_dividers:" },
-  { ":carousel_horse:" },
-  { ":carpentry_saw:" },
-  { ":carrot:" },
-  { ":cat2:" },
-  { ":cat:" },
-  { ":cd:" },
-  { ":chains:" },
-  { ":chair:" },
-  { ":chart:" },
-  { ":chart_with_downwards_trend:" },
-  { ":chart_with_upwards_trend:" },
-  { ":checkered_flag:" },
-  { ":cheese_wedge:" },
-  { ":cherries:" },
-  { ":cherry_blossom:" },
-  { ":chestnut:" },
-  { ":chicken:" },
-  { ":child:" },
-  { ":children_crossing:" },
-  { ":chipmunk:" },
-  { ":chocolate_bar:" },
-  { ":chopsticks:" },
-  { ":christmas_tree:" },
-  { ":church:" },
-  { ":cinema:" },
-  { ":circus_tent:" },
-  { ":city_sunrise:" },
-  { ":city_sunset:" },
-  { ":cityscape:" },
-  { ":cl:" },
-  { ":clap:" },
-  { ":clapper:" },
-  { ":classical_building:" },
-  { ":clinking_glasses:" },
-  { ":clipboard:" },
-  { ":clock1030:" },
-  { ":clock10:" },
-  { ":clock1130:" },
-  { ":clock11:" },
-  { ":clock1230:" },
-  { ":clock12:" },
-  { ":clock130:" },
-  { ":clock1:" },
-  { ":clock230:" },
-  { ":clock2:" },
-  { ":clock330:" },
-  { ":clock3:" },
-  { ":clock430:" },
-  { ":clock4:" },
-  { ":clock530:" },
-  { ":clock5:" },
-  { ":clock630:" },
-  { ":clock6:" },
-  { ":clock730:" },
-  { ":clock7:" },
-  { ":clock830:" },
-  { ":clock8:" },
-  { ":clock930:" },
-  { ":clock9:" },
-  { ":closed_book:" },
-  { ":closed_lock_with_key:" },
-  { ":closed_umbrella:" },
-  { ":cloud:" },
-  { ":cloud_with_lightning:" },
-  { ":cloud_with_rain:" },
-  { ":cloud_with_snow:" },
-  { ":cloud_with_tornado:" },
-  { ":clown_face:" },
-  { ":clubs:" },
-  { ":coat:" },
-  { ":cockroach:" },
-  { ":cocktail:" },
-  { ":coconut:" },
-  { ":coffee:" },
-  { ":coffin:" },
-  { ":coin:" },
-  { ":cold_face:" },
-  { ":cold_sweat:" },
-  { ":collision:" },
-  { ":comet:" },
-  { ":compass:" },
-  { ":compression:" },
-  { ":computer:" },
-  { ":confetti_ball:" },
-  { ":confounded:" },
-  { ":confused:" },
-  { ":congratulations:" },
-  { ":construction:" },
-  { ":construction_worker:" },
-  { ":control_knobs:" },
-  { ":convenience_store:" },
-  { ":cookie:" },
-  { ":cool:" },
-  { ":cop:" },
-  { ":copyright:" },
-  { ":coral:" },
-  { ":corn:" },
-  { ":couch_and_lamp:" },
-  { ":couple:" },
-  { ":couple_with_heart:" },
-  { ":couplekiss:" },
-  { ":cow2:" },
-  { ":cow:" },
-  { ":cowboy_hat_face:" },
-  { ":crab:" },
-  { ":credit_card:" },
-  { ":crescent_moon:" },
-  { ":cricket:" },
-  { ":cricket_bat_and_ball:" },
-  { ":crocodile:" },
-  { ":croissant:" },
-  { ":crossed_fingers:" },
-  { ":crossed_flags:" },
-  { ":crossed_swords:" },
-  { ":crown:" },
-  { ":crutch:" },
-  { ":cry:" },
-  { ":crying_cat_face:" },
-  { ":crystal_ball:" },
-  { ":cucumber:" },
-  { ":cup_with_straw:" },
-  { ":cupcake:" },
-  { ":cupid:" },
-  { ":curling_stone:" },
-  { ":curly_hair:" },
-  { ":curly_loop:" },
-  { ":currency_exchange:" },
-  { ":curry:" },
-  { ":custard:" },
-  { ":customs:" },
-  { ":cut_of_meat:" },
-  { ":cyclone:" },
-  { ":dagger_knife:" },
-  { ":dancer:" },
-  { ":dancers:" },
-  { ":dango:" },
-  { ":dark_skin_tone:" },
-  { ":dark_sunglasses:" },
-  { ":dart:" },
-  { ":dash:" },
-  { ":date:" },
-  { ":deaf_person:" },
-  { ":deciduous_tree:" },
-  { ":deer:" },
-  { ":department_store:" },
-  { ":derelict_house_building:" },
-  { ":desert:" },
-  { ":desert_island:" },
-  { ":desktop_computer:" },
-  { ":diamond_shape_with_a_dot_inside:" },
-  { ":diamonds:" },
-  { ":disappointed:" },
-  { ":disappointed_relieved:" },
-  { ":disguised_face:" },
-  { ":diving_mask:" },
-  { ":diya_lamp:" },
-  { ":dizzy:" },
-  { ":dizzy_face:" },
-  { ":dna:" },
-  { ":do_not_litter:" },
-  { ":dodo:" },
-  { ":dog2:" },
-  { ":dog:" },
-  { ":dollar:" },
-  { ":dolls:" },
-  { ":door:" },
-  { ":dotted_line_face:" },
-  { ":double_vertical_bar:" },
-  { ":doughnut:" },
-  { ":dove_of_peace:" },
-  { ":dragon:" },
-  { ":dragon_face:" },
-  { ":dress:" },
-  { ":dromedary_camel:" },
-  { ":drooling_face:" },
-  { ":drop_of_blood:" },
-  { ":droplet:" },
-  { ":drum:" },
-  { ":duck:" },
-  { ":dumpling:" },
-  { ":dvd:" },
-  { ":e_mail:" },
-  { ":eagle:" },
-  { ":ear:" },
-  { ":ear_of_rice:" },
-  { ":ear_with_hearing_aid:" },
-  { ":earth_africa:" },
-  { ":earth_americas:" },
-  { ":earth_asia:" },
-  { ":egg:" },
-  { ":eggplant:" },
-  { ":eight_pointed_black_star:" },
-  { ":eight_spoked_asterisk:" },
-  { ":eject_symbol:" },
-  { ":electric_plug:" },
-  { ":elephant:" },
-  { ":elevator:" },
-  { ":elf:" },
-  { ":empty_nest:" },
-  { ":end:" },
-  { ":envelope:" },
-  { ":envelope_with_arrow:" },
-  { ":euro:" },
-  { ":european_castle:" },
-  { ":european_post_office:" },
-  { ":evergreen_tree:" },
-  { ":exploding_head:" },
-  { ":expressionless:" },
-  { ":eye:" },
-  { ":eyeglasses:" },
-  { ":eyes:" },
-  { ":face_holding_back_tears:" },
-  { ":face_vomiting:" },
-  { ":face_with_diagonal_mouth:" },
-  { ":face_with_hand_over_mouth:" },
-  { ":face_with_head_bandage:" },
-  { ":face_with_monocle:" },
-  { ":face_with_open_eyes_and_hand_over_mouth:" },
-  { ":face_with_peeking_eye:" },
-  { ":face_with_raised_eyebrow:" },
-  { ":face_with_rolling_eyes:" },
-  { ":face_with_symbols_on_mouth:" },
-  { ":face_with_thermometer:" },
-  { ":factory:" },
-  { ":fairy:" },
-  { ":falafel:" },
-  { ":fallen_leaf:" },
-  { ":family:" },
-  { ":fast_forward:" },
-  { ":fax:" },
-  { ":fearful:" },
-  { ":feather:" },
-  { ":ferris_wheel:" },
-  { ":ferry:" },
-  { ":field_hockey_stick_and_ball:" },
-  { ":file_cabinet:" },
-  { ":file_folder:" },
-  { ":film_frames:" },
-  { ":film_projector:" },
-  { ":fire:" },
-  { ":fire_engine:" },
-  { ":fire_extinguisher:" },
-  { ":firecracker:" },
-  { ":fireworks:" },
-  { ":first_quarter_moon:" },
-  { ":first_quarter_moon_with_face:" },
-  { ":fish:" },
-  { ":fish_cake:" },
-  { ":fishing_pole_and_fish:" },
-  { ":fist:" },
-  { ":flags:" },
-  { ":flamingo:" },
-  { ":flashlight:" },
-  { ":flat_shoe:" },
-  { ":flatbread:" },
-  { ":fleur_de_lis:" },
-  { ":flipper:" },
-  { ":floppy_disk:" },
-  { ":flower_playing_cards:" },
-  { ":flushed:" },
-  { ":fly:" },
-  { ":flying_disc:" },
-  { ":flying_saucer:" },
-  { ":fog:" },
-  { ":foggy:" },
-  { ":fondue:" },
-  { ":foot:" },
-  { ":football:" },
-  { ":footprints:" },
-  { ":fork_and_knife:" },
-  { ":fork_and_knife_with_plate:" },
-  { ":fortune_cookie:" },
-  { ":fountain:" },
-  { ":four_leaf_clover:" },
-  { ":fox:" },
-  { ":frame_with_picture:" },
-  { ":free:" },
-  { ":fried_shrimp:" },
-  { ":fries:" },
-  { ":frog:" },
-  { ":frowning:" },
-  { ":fuelpump:" },
-  { ":full_moon:" },
-  { ":full_moon_with_face:" },
-  { ":funeral_urn:" },
-  { ":game_die:" },
-  { ":garlic:" },
-  { ":gear:" },
-  { ":gem:" },
-  { ":gemini:" },
-  { ":genie:" },
-  { ":ghost:" },
-  { ":gift:" },
-  { ":gift_heart:" },
-  { ":giraffe:" },
-  { ":girl:" },
-  { ":glass_of_milk:" },
-  { ":globe_with_meridians:" },
-  { ":gloves:" },
-  { ":goal_net:" },
-  { ":goat:" },
-  { ":goggles:" },
-  { ":golf:" },
-  { ":golfer:" },
-  { ":gorilla:" },
-  { ":grapes:" },
-  { ":green_apple:" },
-  { ":green_book:" },
-  { ":green_circle:" },
-  { ":green_heart:" },
-  { ":green_salad:" },
-  { ":green_square:" },
-  { ":grey_exclamation:" },
-  { ":grey_question:" },
-  { ":grimacing:" },
-  { ":grin:" },
-  { ":grinning:" },
-  { ":guardsman:" },
-  { ":guide_dog:" },
-  { ":guitar:" },
-  { ":gun:" },
-  { ":haircut:" },
-  { ":hamburger:" },
-  { ":hammer:" },
-  { ":hammer_and_pick:" },
-  { ":hammer_and_wrench:" },
-  { ":hamsa:" },
-  { ":hamster:" },
-  { ":hand_with_index_finger_and_thumb_crossed:" },
-  { ":handbag:" },
-  { ":handshake:" },
-  { ":hatched_chick:" },
-  { ":hatching_chick:" },
-  { ":headphones:" },
-  { ":headstone:" },
-  { ":hear_no_evil:" },
-  { ":heart:" },
-  { ":heart_decoration:" },
-  { ":heart_eyes:" },
-  { ":heart_eyes_cat:" },
-  { ":heart_hands:" },
-  { ":heartbeat:" },
-  { ":heartpulse:" },
-  { ":hearts:" },
-  { ":heavy_check_mark:" },
-  { ":heavy_division_sign:" },
-  { ":heavy_dollar_sign:" },
-  { ":heavy_equals_sign:" },
-  { ":heavy_exclamation_mark:" },
-  { ":heavy_heart_exclamation_mark_ornament:" },
-  { ":heavy_minus_sign:" },
-  { ":heavy_multiplication_x:" },
-  { ":heavy_plus_sign:" },
-  { ":hedgehog:" },
-  { ":helicopter:" },
-  { ":helm_symbol:" },
-  { ":helmet_with_white_cross:" },
-  { ":herb:" },
-  { ":hibiscus:" },
-  { ":high_brightness:" },
-  { ":high_heel:" },
-  { ":hiking_boot:" },
-  { ":hindu_temple:" },
-  { ":hippopotamus:" },
-  { ":hole:" },
-  { ":honey_pot:" },
-  { ":honeybee:" },
-  { ":hook:" },
-  { ":horse:" },
-  { ":horse_racing:" },
-  { ":hospital:" },
-  { ":hot_dog:" },
-  { ":hot_face:" },
-  { ":hot_pepper:" },
-  { ":hotel:" },
-  { ":hotsprings:" },
-  { ":hourglass:" },
-  { ":hourglass_flowing_sand:" },
-  { ":house:" },
-  { ":house_buildings:" },
-  { ":house_with_garden:" },
-  { ":hugging_face:" },
-  { ":hushed:" },
-  { ":hut:" },
-  { ":ice:" },
-  { ":ice_cream:" },
-  { ":ice_hockey_stick_and_puck:" },
-  { ":ice_skate:" },
-  { ":icecream:" },
-  { ":id:" },
-  { ":identification_card:" },
-  { ":ideograph_advantage:" },
-  { ":imp:" },
-  { ":inbox_tray:" },
-  { ":incoming_envelope:" },
-  { ":index_pointing_at_the_viewer:" },
-  { ":information_desk_person:" },
-  { ":information_source:" },
-  { ":innocent:" },
-  { ":interrobang:" },
-  { ":iphone:" },
-  { ":jack_o_lantern:" },
-  { ":japan:" },
-  { ":japanese_application_button:" },
-  { ":japanese_castle:" },
-  { ":japanese_discount_button:" },
-  { ":japanese_free_of_charge_button:" },
-  { ":japanese_goblin:" },
-  { ":japanese_no_vacancy_button:" },
-  { ":japanese_not_free_of_charge_button:" },
-  { ":japanese_ogre:" },
-  { ":japanese_open_for_business_button:" },
-  { ":japanese_passing_grade_button:" },
-  { ":japanese_prohibited_button:" },
-  { ":japanese_reserved_button:" },
-  { ":japanese_vacancy_button:" },
-  { ":jar:" },
-  { ":jeans:" },
-  { ":joy:" },
-  { ":joy_cat:" },
-  { ":joystick:" },
-  { ":kaaba:" },
-  { ":kangaroo:" },
-  { ":key:" },
-  { ":keyboard:" },
-  { ":kick_scooter:" },
-  { ":kimono:" },
-  { ":kiss:" },
-  { ":kissing:" },
-  { ":kissing_cat:" },
-  { ":kissing_closed_eyes:" },
-  { ":kissing_heart:" },
-  { ":kissing_smiling_eyes:" },
-  { ":kite:" },
-  { ":kiwi_fruit:" },
-  { ":knife:" },
-  { ":knot:" },
-  { ":koala:" },
-  { ":koko:" },
-  { ":lab_coat:" },
-  { ":label:" },
-  { ":lacrosse:" },
-  { ":ladder:" },
-  { ":lantern:" },
-  { ":large_blue_circle:" },
-  { ":large_blue_diamond:" },
-  { ":large_orange_diamond:" },
-  { ":last_quarter_moon:" },
-  { ":last_quarter_moon_with_face:" },
-  { ":latin_cross:" },
-  { ":leafy_green:" },
-  { ":leaves:" },
-  { ":ledger:" },
-  { ":left_facing_fist:" },
-  { ":left_luggage:" },
-  { ":left_right_arrow:" },
-  { ":leftwards_arrow_with_hook:" },
-  { ":leftwards_hand:" },
-  { ":leg:" },
-  { ":lemon:" },
-  { ":leo:" },
-  { ":leopard:" },
-  { ":level_slider:" },
-  { ":libra:" },
-  { ":light_rail:" },
-  { ":light_skin_tone:" },
-  { ":link:" },
-  { ":linked_paperclips:" },
-  { ":lion_face:" },
-  { ":lips:" },
-  { ":lipstick:" },
-  { ":lizard:" },
-  { ":llama:" },
-  { ":lobster:" },
-  { ":lock:" },
-  { ":lock_with_ink_pen:" },
-  { ":lollipop:" },
-  { ":long_drum:" },
-  { ":loop:" },
-  { ":lotion_bottle:" },
-  { ":lotus:" },
-  { ":loud_sound:" },
-  { ":loudspeaker:" },
-  { ":love_hotel:" },
-  { ":love_letter:" },
-  { ":love_you_gesture:" },
-  { ":low_battery:" },
-  { ":low_brightness:" },
-  { ":lower_left_ballpoint_pen:" },
-  { ":lower_left_crayon:" },
-  { ":lower_left_fountain_pen:" },
-  { ":lower_left_paintbrush:" },
-  { ":luggage:" },
-  { ":lungs:" },
-  { ":lying_face:" },
-  { ":m:" },
-  { ":mag:" },
-  { ":mag_right:" },
-  { ":mage:" },
-  { ":magic_wand:" },
-  { ":magnet:" },
-  { ":mahjong:" },
-  { ":mailbox:" },
-  { ":mailbox_closed:" },
-  { ":mailbox_with_mail:" },
-  { ":mailbox_with_no_mail:" },
-  { ":mammoth:" },
-  { ":man:" },
-  { ":man_dancing:" },
-  { ":man_in_business_suit_levitating:" },
-  { ":man_with_gua_pi_mao:" },
-  { ":man_with_turban:" },
-  { ":mango:" },
-  { ":mantelpiece_clock:" },
-  { ":manual_wheelchair:" },
-  { ":maple_leaf:" },
-  { ":martial_arts_uniform:" },
-  { ":mask:" },
-  { ":massage:" },
-  { ":mate:" },
-  { ":meat_on_bone:" },
-  { ":mechanical_arm:" },
-  { ":mechanical_leg:" },
-  { ":medium_dark_skin_tone:" },
-  { ":medium_light_skin_tone:" },
-  { ":medium_skin_tone:" },
-  { ":mega:" },
-  { ":melon:" },
-  { ":melting_face:" },
-  { ":menorah_with_nine_branches:" },
-  { ":mens:" },
-  { ":merperson:" },
-  { ":metro:" },
-  { ":microbe:" },
-  { ":microphone:" },
-  { ":microscope:" },
-  { ":military_helmet:" },
-  { ":military_medal:" },
-  { ":milky_way:" },
-  { ":minibus:" },
-  { ":minidisc:" },
-  { ":mirror:" },
-  { ":mirror_ball:" },
-  { ":mobile_phone_off:" },
-  { ":money_mouth_face:" },
-  { ":money_with_wings:" },
-  { ":moneybag:" },
-  { ":monkey:" },
-  { ":monkey_face:" },
-  { ":monorail:" },
-  { ":moon_cake:" },
-  { ":mortar_board:" },
-  { ":mosque:" },
-  { ":mosquito:" },
-  { ":motor_boat:" },
-  { ":motor_scooter:" },
-  { ":motorized_wheelchair:" },
-  { ":motorway:" },
-  { ":mount_fuji:" },
-  { ":mountain:" },
-  { ":mountain_bicyclist:" },
-  { ":mountain_cableway:" },
-  { ":mountain_railway:" },
-  { ":mouse2:" },
-  { ":mouse:" },
-  { ":mouse_trap:" },
-  { ":movie_camera:" },
-  { ":moyai:" },
-  { ":mrs_claus:" },
-  { ":muscle:" },
-  { ":mushroom:" },
-  { ":musical_keyboard:" },
-  { ":musical_note:" },
-  { ":musical_score:" },
-  { ":mute:" },
-  { ":nail_care:" },
-  { ":name_badge:" },
-  { ":national_park:" },
-  { ":nauseated_face:" },
-  { ":nazar_amulet:" },
-  { ":necktie:" },
-  { ":negative_squared_cross_mark:" },
-  { ":nerd_face:" },
-  { ":nest_with_eggs:" },
-  { ":nesting_dolls:" },
-  { ":neutral_face:" },
-  { ":new:" },
-  { ":new_moon:" },
-  { ":new_moon_with_face:" },
-  { ":newspaper:" },
-  { ":ng:" },
-  { ":night_with_stars:" },
-  { ":ninja:" },
-  { ":no_bell:" },
-  { ":no_bicycles:" },
-  { ":no_entry:" },
-  { ":no_entry_sign:" },
-  { ":no_good:" },
-  { ":no_mobile_phones:" },
-  { ":no_mouth:" },
-  { ":no_pedestrians:" },
-  { ":no_smoking:" },
-  { ":non_potable_water:" },
-  { ":nose:" },
-  { ":notebook:" },
-  { ":notebook_with_decorative_cover:" },
-  { ":notes:" },
-  { ":nut_and_bolt:" },
-  { ":o2:" },
-  { ":o:" },
-  { ":ocean:" },
-  { ":octopus:" },
-  { ":oden:" },
-  { ":office:" },
-  { ":oil_drum:" },
-  { ":ok:" },
-  { ":ok_hand:" },
-  { ":ok_woman:" },
-  { ":old_key:" },
-  { ":older_man:" },
-  { ":older_person:" },
-  { ":older_woman:" },
-  { ":olive:" },
-  { ":om_symbol:" },
-  { ":on:" },
-  { ":oncoming_automobile:" },
-  { ":oncoming_bus:" },
-  { ":oncoming_police_car:" },
-  { ":oncoming_taxi:" },
-  { ":one_piece_swimsuit:" },
-  { ":onion:" },
-  { ":open_book:" },
-  { ":open_file_folder:" },
-  { ":open_hands:" },
-  { ":open_mouth:" },
-  { ":ophiuchus:" },
-  { ":orange_book:" },
-  { ":orange_circle:" },
-  { ":orange_heart:" },
-  { ":orange_square:" },
-  { ":orangutan:" },
-  { ":orthodox_cross:" },
-  { ":otter:" },
-  { ":outbox_tray:" },
-  { ":owl:" },
-  { ":ox:" },
-  { ":oyster:" },
-  { ":package:" },
-  { ":page_facing_up:" },
-  { ":page_with_curl:" },
-  { ":pager:" },
-  { ":palm_down_hand:" },
-  { ":palm_tree:" },
-  { ":palm_up_hand:" },
-  { ":palms_up_together:" },
-  { ":pancakes:" },
-  { ":panda_face:" },
-  { ":paperclip:" },
-  { ":parachute:" },
-  { ":parking:" },
-  { ":parrot:" },
-  { ":part_alternation_mark:" },
-  { ":partly_sunny:" },
-  { ":partying_face:" },
-  { ":passenger_ship:" },
-  { ":passport_control:" },
-  { ":paw_prints:" },
-  { ":peace_symbol:" },
-  { ":peach:" },
-  { ":peacock:" },
-  { ":peanuts:" },
-  { ":pear:" },
-  { ":pencil2:" },
-  { ":pencil:" },
-  { ":penguin:" },
-  { ":pensive:" },
-  { ":people_hugging:" },
-  { ":people_wrestling:" },
-  { ":performing_arts:" },
-  { ":persevere:" },
-  { ":person:" },
-  { ":person_beard:" },
-  { ":person_cartwheeling:" },
-  { ":person_climbing:" },
-  { ":person_facepalming:" },
-  { ":person_fencing:" },
-  { ":person_frowning:" },
-  { ":person_in_lotus_position:" },
-  { ":person_in_steamy_room:" },
-  { ":person_in_tuxedo:" },
-  { ":person_juggling:" },
-  { ":person_kneeling:" },
-  { ":person_playing_handball:" },
-  { ":person_playing_water_polo:" },
-  { ":person_shrugging:" },
-  { ":person_standing:" },
-  { ":person_with_ball:" },
-  { ":person_with_blond_hair:" },
-  { ":person_with_crown:" },
-  { ":person_with_pouting_face:" },
-  { ":petri_dish:" },
-  { ":pick:" },
-  { ":pickup_truck:" },
-  { ":pie:" },
-  { ":pig2:" },
-  { ":pig:" },
-  { ":pig_nose:" },
-  { ":pill:" },
-  { ":pinata:" },
-  { ":pinched_fingers:" },
-  { ":pinching_hand:" },
-  { ":pineapple:" },
-  { ":pisces:" },
-  { ":pizza:" },
-  { ":placard:" },
-  { ":place_of_worship:" },
-  { ":playground_slide:" },
-  { ":pleading_face:" },
-  { ":plunger:" },
-  { ":point_down:" },
-  { ":point_left:" },
-  { ":point_right:" },
-  { ":point_up:" },
-  { ":point_up_2:" },
-  { ":police_car:" },
-  { ":poodle:" },
-  { ":popcorn:" },
-  { ":post_office:" },
-  { ":postal_horn:" },
-  { ":postbox:" },
-  { ":potable_water:" },
-  { ":potato:" },
-  { ":potted_plant:" },
-  { ":pouch:" },
-  { ":poultry_leg:" },
-  { ":pound:" },
-  { ":pouring_liquid:" },
-  { ":pouting_cat:" },
-  { ":pray:" },
-  { ":prayer_beads:" },
-  { ":pregnant_man:" },
-  { ":pregnant_person:" },
-  { ":pregnant_woman:" },
-  { ":pretzel:" },
-  { ":prince:" },
-  { ":princess:" },
-  { ":printer:" },
-  { ":punch:" },
-  { ":purple_circle:" },
-  { ":purple_heart:" },
-  { ":purple_square:" },
-  { ":purse:" },
-  { ":pushpin:" },
-  { ":put_litter_in_its_place:" },
-  { ":puzzle_piece:" },
-  { ":question:" },
-  { ":rabbit2:" },
-  { ":rabbit:" },
-  { ":raccoon:" },
-  { ":racehorse:" },
-  { ":racing_car:" },
-  { ":racing_motorcycle:" },
-  { ":radio:" },
-  { ":radio_button:" },
-  { ":radioactive_sign:" },
-  { ":rage:" },
-  { ":railway_car:" },
-  { ":railway_track:" },
-  { ":rainbow:" },
-  { ":raised_back_of_hand:" },
-  { ":raised_hand:" },
-  { ":raised_hand_with_fingers_splayed:" },
-  { ":raised_hand_with_part_between_middle_and_ring_fingers:" },
-  { ":raised_hands:" },
-  { ":raising_hand:" },
-  { ":ram:" },
-  { ":ramen:" },
-  { ":rat:" },
-  { ":razor:" },
-  { ":receipt:" },
-  { ":recycle:" },
-  { ":red_car:" },
-  { ":red_circle:" },
-  { ":red_envelope:" },
-  { ":red_hair:" },
-  { ":red_square:" },
-  { ":registered:" },
-  { ":relaxed:" },
-  { ":relieved:" },
-  { ":reminder_ribbon:" },
-  { ":repeat:" },
-  { ":repeat_one:" },
-  { ":restroom:" },
-  { ":reversed_hand_with_middle_finger_extended:" },
-  { ":revolving_hearts:" },
-  { ":rewind:" },
-  { ":rhinoceros:" },
-  { ":ribbon:" },
-  { ":rice:" },
-  { ":rice_ball:" },
-  { ":rice_cracker:" },
-  { ":rice_scene:" },
-  { ":right_anger_bubble:" },
-  { ":right_facing_fist:" },
-  { ":rightwards_hand:" },
-  { ":ring:" },
-  { ":ring_buoy:" },
-  { ":ringed_planet:" },
-  { ":robot_face:" },
-  { ":rock:" },
-  { ":rocket:" },
-  { ":roll_of_paper:" },
-  { ":rolled_up_newspaper:" },
-  { ":roller_coaster:" },
-  { ":roller_skate:" },
-  { ":rolling_on_the_floor_laughing:" },
-  { ":rooster:" },
-  { ":rose:" },
-  { ":rosette:" },
-  { ":rotating_light:" },
-  { ":round_pushpin:" },
-  { ":rowboat:" },
-  { ":rugby_football:" },
-  { ":running:" },
-  { ":running_shirt_with_sash:" },
-  { ":sa:" },
-  { ":safety_pin:" },
-  { ":safety_vest:" },
-  { ":sagittarius:" },
-  { ":sailboat:" },
-  { ":sake:" },
-  { ":salt:" },
-  { ":saluting_face:" },
-  { ":sandal:" },
-  { ":sandwich:" },
-  { ":santa:" },
-  { ":sari:" },
-  { ":satellite:" },
-  { ":satisfied:" },
-  { ":sauropod:" },
-  { ":saxophone:" },
-  { ":scales:" },
-  { ":scarf:" },
-  { ":school:" },
-  { ":school_satchel:" },
-  { ":scissors:" },
-  { ":scorpion:" },
-  { ":scorpius:" },
-  { ":scream:" },
-  { ":scream_cat:" },
-  { ":screwdriver:" },
-  { ":scroll:" },
-  { ":seal:" },
-  { ":seat:" },
-  { ":secret:" },
-  { ":see_no_evil:" },
-  { ":seedling:" },
-  { ":selfie:" },
-  { ":sewing_needle:" },
-  { ":shallow_pan_of_food:" },
-  { ":shamrock:" },
-  { ":shark:" },
-  { ":shaved_ice:" },
-  { ":sheep:" },
-  { ":shell:" },
-  { ":shield:" },
-  { ":shinto_shrine:" },
-  { ":ship:" },
-  { ":shit:" },
-  { ":shoe:" },
-  { ":shopping_bags:" },
-  { ":shopping_cart:" },
-  { ":shorts:" },
-  { ":shower:" },
-  { ":shrimp:" },
-  { ":shushing_face:" },
-  { ":sign_of_the_horns:" },
-  { ":signal_strength:" },
-  { ":six_pointed_star:" },
-  { ":skateboard:" },
-  { ":ski:" },
-  { ":skier:" },
-  { ":skull:" },
-  { ":skull_and_crossbones:" },
-  { ":skunk:" },
-  { ":sled:" },
-  { ":sleeping:" },
-  { ":sleeping_accommodation:" },
-  { ":sleepy:" },
-  { ":sleuth_or_spy:" },
-  { ":slightly_frowning_face:" },
-  { ":slightly_smiling_face:" },
-  { ":slot_machine:" },
-  { ":sloth:" },
-  { ":small_airplane:" },
-  { ":small_blue_diamond:" },
-  { ":small_orange_diamond:" },
-  { ":small_red_triangle:" },
-  { ":small_red_triangle_down:" },
-  { ":smile:" },
-  { ":smile_cat:" },
-  { ":smiley:" },
-  { ":smiley_cat:" },
-  { ":smiling_face_with_hearts:" },
-  { ":smiling_face_with_tear:" },
-  { ":smiling_imp:" },
-  { ":smirk:" },
-  { ":smirk_cat:" },
-  { ":smoking:" },
-  { ":snail:" },
-  { ":snake:" },
-  { ":sneezing_face:" },
-  { ":snow_capped_mountain:" },
-  { ":snowboarder:" },
-  { ":snowflake:" },
-  { ":snowman:" },
-  { ":snowman_without_snow:" },
-  { ":soap:" },
-  { ":sob:" },
-  { ":soccer:" },
-  { ":socks:" },
-  { ":softball:" },
-  { ":soon:" },
-  { ":sos:" },
-  { ":sound:" },
-  { ":space_invader:" },
-  { ":spades:" },
-  { ":spaghetti:" },
-  { ":sparkle:" },
-  { ":sparkler:" },
-  { ":sparkles:" },
-  { ":sparkling_heart:" },
-  { ":speak_no_evil:" },
-  { ":speaker:" },
-  { ":speaking_head_in_silhouette:" },
-  { ":speech_balloon:" },
-  { ":speedboat:" },
-  { ":spider:" },
-  { ":spider_web:" },
-  { ":spiral_calendar_pad:" },
-  { ":spiral_note_pad:" },
-  { ":sponge:" },
-  { ":spoon:" },
-  { ":sports_medal:" },
-  { ":squid:" },
-  { ":stadium:" },
-  { ":star2:" },
-  { ":star:" },
-  { ":star_and_crescent:" },
-  { ":star_of_david:" },
-  { ":star_struck:" },
-  { ":stars:" },
-  { ":station:" },
-  { ":statue_of_liberty:" },
-  { ":steam_locomotive:" },
-  { ":stethoscope:" },
-  { ":stew:" },
-  { ":stop_sign:" },
-  { ":stopwatch:" },
-  { ":straight_ruler:" },
-  { ":strawberry:" },
-  { ":stuck_out_tongue:" },
-  { ":stuck_out_tongue_closed_eyes:" },
-  { ":stuck_out_tongue_winking_eye:" },
-  { ":studio_microphone:" },
-  { ":stuffed_flatbread:" },
-  { ":sun_with_face:" },
-  { ":sunflower:" },
-  { ":sunglasses:" },
-  { ":sunny:" },
-  { ":sunrise:" },
-  { ":sunrise_over_mountains:" },
-  { ":superhero:" },
-  { ":supervillain:" },
-  { ":surfer:" },
-  { ":sushi:" },
-  { ":suspension_railway:" },
-  { ":swan:" },
-  { ":sweat:" },
-  { ":sweat_drops:" },
-  { ":sweat_smile:" },
-  { ":sweet_potato:" },
-  { ":swimmer:" },
-  { ":symbols:" },
-  { ":synagogue:" },
-  { ":syringe:" },
-  { ":t_rex:" },
-  { ":table_tennis_paddle_and_ball:" },
-  { ":taco:" },
-  { ":tada:" },
-  { ":takeout_box:" },
-  { ":tamale:" },
-  { ":tanabata_tree:" },
-  { ":tangerine:" },
-  { ":taurus:" },
-  { ":taxi:" },
-  { ":tea:" },
-  { ":teapot:" },
-  { ":teddy_bear:" },
-  { ":telephone:" },
-  { ":telephone_receiver:" },
-  { ":telescope:" },
-  { ":tennis:" },
-  { ":tent:" },
-  { ":test_tube:" },
-  { ":thermometer:" },
-  { ":thinking_face:" },
-  { ":thong_sandal:" },
-  { ":thought_balloon:" },
-  { ":thread:" },
-  { ":three_button_mouse:" },
-  { ":thumbsdown:" },
-  { ":thumbsup:" },
-  { ":thunder_cloud_and_rain:" },
-  { ":ticket:" },
-  { ":tiger2:" },
-  { ":tiger:" },
-  { ":timer_clock:" },
-  { ":tired_face:" },
-  { ":tm:" },
-  { ":toilet:" },
-  { ":tokyo_tower:" },
-  { ":tomato:" },
-  { ":tongue:" },
-  { ":toolbox:" },
-  { ":tooth:" },
-  { ":toothbrush:" },
-  { ":top:" },
-  { ":tophat:" },
-  { ":trackball:" },
-  { ":tractor:" },
-  { ":traffic_light:" },
-  { ":train2:" },
-  { ":train:" },
-  { ":tram:" },
-  { ":triangular_flag_on_post:" },
-  { ":triangular_ruler:" },
-  { ":trident:" },
-  { ":triumph:" },
-  { ":troll:" },
-  { ":trolleybus:" },
-  { ":trophy:" },
-  { ":tropical_drink:" },
-  { ":tropical_fish:" },
-  { ":truck:" },
-  { ":trumpet:" },
-  { ":tshirt:" },
-  { ":tulip:" },
-  { ":tumbler_glass:" },
-  { ":turkey:" },
-  { ":turtle:" },
-  { ":tv:" },
-  { ":twisted_rightwards_arrows:" },
-  { ":two_hearts:" },
-  { ":two_men_holding_hands:" },
-  { ":two_women_holding_hands:" },
-  { ":umbrella:" },
-  { ":umbrella_on_ground:" },
-  { ":umbrella_with_rain_drops:" },
-  { ":unamused:" },
-  { ":underage:" },
-  { ":unicorn_face:" },
-  { ":unlock:" },
-  { ":up:" },
-  { ":upside_down_face:" },
-  { ":v:" },
-  { ":vampire:" },
-  { ":vertical_traffic_light:" },
-  { ":vhs:" },
-  { ":vibration_mode:" },
-  { ":video_camera:" },
-  { ":video_game:" },
-  { ":violin:" },
-  { ":virgo:" },
-  { ":volcano:" },
-  { ":volleyball:" },
-  { ":vs:" },
-  { ":waffle:" },
-  { ":walking:" },
-  { ":waning_crescent_moon:" },
-  { ":waning_gibbous_moon:" },
-  { ":warning:" },
-  { ":wastebasket:" },
-  { ":watch:" },
-  { ":water_buffalo:" },
-  { ":watermelon:" },
-  { ":wave:" },
-  { ":waving_black_flag:" },
-  { ":waving_white_flag:" },
-  { ":wavy_dash:" },
-  { ":waxing_crescent_moon:" },
-  { ":waxing_gibbous_moon:" },
-  { ":wc:" },
-  { ":weary:" },
-  { ":wedding:" },
-  { ":weight_lifter:" },
-  { ":whale2:" },
-  { ":whale:" },
-  { ":wheel:" },
-  { ":wheel_of_dharma:" },
-  { ":wheelchair:" },
-  { ":white_cane:" },
-  { ":white_check_mark:" },
-  { ":white_circle:" },
-  { ":white_flower:" },
-  { ":white_frowning_face:" },
-  { ":white_hair:" },
-  { ":white_heart:" },
-  { ":white_large_square:" },
-  { ":white_medium_small_square:" },
-  { ":white_medium_square:" },
-  { ":white_small_square:" },
-  { ":white_square_button:" },
-  { ":white_sun_behind_cloud:" },
-  { ":white_sun_behind_cloud_with_rain:" },
-  { ":white_sun_with_small_cloud:" },
-  { ":wilted_flower:" },
-  { ":wind_blowing_face:" },
-  { ":wind_chime:" },
-  { ":window:" },
-  { ":wine_glass:" },
-  { ":wink:" },
-  { ":wolf:" },
-  { ":woman:" },
-  { ":woman_with_headscarf:" },
-  { ":womans_clothes:" },
-  { ":womans_hat:" },
-  { ":womens:" },
-  { ":wood:" },
-  { ":woozy_face:" },
-  { ":world_map:" },
-  { ":worm:" },
-  { ":worried:" },
-  { ":wrench:" },
-  { ":writing_hand:" },
-  { ":x:" },
-  { ":x_ray:" },
-  { ":yarn:" },
-  { ":yawning_face:" },
-  { ":yellow_circle:" },
-  { ":yellow_heart:" },
-  { ":yellow_square:" },
-  { ":yen:" },
-  { ":yin_yang:" },
-  { ":yo_yo:" },
-  { ":yum:" },
-  { ":zany_face:" },
-  { ":zap:" },
-  { ":zebra:" },
-  { ":zipper_mouth_face:" },
-  { ":zombie:" },
-  { ":zzz:" },
+// generated shortcodes shown in emoji list, sorted
+static const char* const s_View[] = {
+  ":100:",
+  ":1234:",
+  ":1st_place_medal:",
+  ":2nd_place_medal:",
+  ":3rd_place_medal:",
+  ":8ball:",
+  ":a:",
+  ":ab:",
+  ":abacus:",
+  ":abc:",
+  ":abcd:",
+  ":accept:",
+  ":accordion:",
+  ":adhesive_bandage:",
+  ":admission_tickets:",
+  ":aerial_tramway:",
+  ":airplane:",
+  ":airplane_arriving:",
+  ":airplane_departure:",
+  ":alarm_clock:",
+  ":alembic:",
+  ":alien:",
+  ":ambulance:",
+  ":amphora:",
+  ":anatomical_heart:",
+  ":anchor:",
+  ":angel:",
+  ":anger:",
+  ":angry:",
+  ":anguished:",
+  ":ant:",
+  ":apple:",
+  ":aquarius:",
+  ":aries:",
+  ":arrow_backward:",
+  ":arrow_double_down:",
+  ":arrow_double_up:",
+  ":arrow_down:",
+  ":arrow_down_small:",
+  ":arrow_forward:",
+  ":arrow_heading_down:",
+  ":arrow_heading_up:",
+  ":arrow_left:",
+  ":arrow_lower_left:",
+  ":arrow_lower_right:",
+  ":arrow_right:",
+  ":arrow_right_hook:",
+  ":arrow_up:",
+  ":arrow_up_down:",
+  ":arrow_up_small:",
+  ":arrow_upper_left:",
+  ":arrow_upper_right:",
+  ":arrows_clockwise:",
+  ":arrows_counterclockwise:",
+  ":art:",
+  ":articulated_lorry:",
+  ":astonished:",
+  ":athletic_shoe:",
+  ":atm:",
+  ":atom_symbol:",
+  ":auto_rickshaw:",
+  ":avocado:",
+  ":axe:",
+  ":b:",
+  ":baby:",
+  ":baby_bottle:",
+  ":baby_chick:",
+  ":baby_symbol:",
+  ":back:",
+  ":bacon:",
+  ":badger:",
+  ":badminton_racquet_and_shuttlecock:",
+  ":bagel:",
+  ":baggage_claim:",
+  ":baguette_bread:",
+  ":bald:",
+  ":ballet_shoes:",
+  ":balloon:",
+  ":ballot_box_with_ballot:",
+  ":ballot_box_with_check:",
+  ":bamboo:",
+  ":banana:",
+  ":bangbang:",
+  ":banjo:",
+  ":bank:",
+  ":bar_chart:",
+  ":barber:",
+  ":baseball:",
+  ":basket:",
+  ":basketball:",
+  ":bat:",
+  ":bath:",
+  ":bathtub:",
+  ":battery:",
+  ":beach_with_umbrella:",
+  ":beans:",
+  ":bear:",
+  ":beaver:",
+  ":bed:",
+  ":beer:",
+  ":beers:",
+  ":beetle:",
+  ":beginner:",
+  ":bell:",
+  ":bell_pepper:",
+  ":bellhop_bell:",
+  ":bento:",
+  ":beverage_box:",
+  ":bicyclist:",
+  ":bike:",
+  ":bikini:",
+  ":billed_cap:",
+  ":biohazard_sign:",
+  ":bird:",
+  ":birthday:",
+  ":bison:",
+  ":biting_lip:",
+  ":black_circle:",
+  ":black_circle_for_record:",
+  ":black_heart:",
+  ":black_joker:",
+  ":black_large_square:",
+  ":black_left_pointing_double_triangle_with_vertical_bar:",
+  ":black_medium_small_square:",
+  ":black_medium_square:",
+  ":black_nib:",
+  ":black_right_pointing_double_triangle_with_vertical_bar:",
+  ":black_right_pointing_triangle_with_double_vertical_bar:",
+  ":black_small_square:",
+  ":black_square_button:",
+  ":black_square_for_stop:",
+  ":blossom:",
+  ":blowfish:",
+  ":blue_book:",
+  ":blue_car:",
+  ":blue_heart:",
+  ":blue_square:",
+  ":blueberries:",
+  ":blush:",
+  ":boar:",
+  ":bomb:",
+  ":bone:",
+  ":bookmark:",
+  ":bookmark_tabs:",
+  ":books:",
+  ":boomerang:",
+  ":boot:",
+  ":bottle_with_popping_cork:",
+  ":bouquet:",
+  ":bow:",
+  ":bow_and_arrow:",
+  ":bowl_with_spoon:",
+  ":bowling:",
+  ":boxing_glove:",
+  ":boy:",
+  ":brain:",
+  ":bread:",
+  ":breast_feeding:",
+  ":brick:",
+  ":bride_with_veil:",
+  ":bridge_at_night:",
+  ":briefcase:",
+  ":briefs:",
+  ":broccoli:",
+  ":broken_heart:",
+  ":broom:",
+  ":brown_circle:",
+  ":brown_heart:",
+  ":brown_square:",
+  ":bubble_tea:",
+  ":bubbles:",
+  ":bucket:",
+  ":bug:",
+  ":building_construction:",
+  ":bulb:",
+  ":bullettrain_front:",
+  ":bullettrain_side:",
+  ":burrito:",
+  ":bus:",
+  ":busstop:",
+  ":bust_in_silhouette:",
+  ":busts_in_silhouette:",
+  ":butter:",
+  ":butterfly:",
+  ":cactus:",
+  ":cake:",
+  ":calendar:",
+  ":call_me_hand:",
+  ":calling:",
+  ":camel:",
+  ":camera:",
+  ":camera_with_flash:",
+  ":camping:",
+  ":cancer:",
+  ":candle:",
+  ":candy:",
+  ":canned_food:",
+  ":canoe:",
+  ":capital_abcd:",
+  ":capricorn:",
+  ":card_file_box:",
+  ":card_index:",
+  ":card_index_dividers:",
+  ":carousel_horse:",
+  ":carpentry_saw:",
+  ":carrot:",
+  ":cat2:",
+  ":cat:",
+  ":cd:",
+  ":chains:",
+  ":chair:",
+  ":chart:",
+  ":chart_with_downwards_trend:",
+  ":chart_with_upwards_trend:",
+  ":checkered_flag:",
+  ":cheese_wedge:",
+  ":cherries:",
+  ":cherry_blossom:",
+  ":chestnut:",
+  ":chicken:",
+  ":child:",
+  ":children_crossing:",
+  ":chipmunk:",
+  ":chocolate_bar:",
+  ":chopsticks:",
+  ":christmas_tree:",
+  ":church:",
+  ":cinema:",
+  ":circus_tent:",
+  ":city_sunrise:",
+  ":city_sunset:",
+  ":cityscape:",
+  ":cl:",
+  ":clap:",
+  ":clapper:",
+  ":classical_building:",
+  ":clinking_glasses:",
+  ":clipboard:",
+  ":clock1030:",
+  ":clock10:",
+  ":clock1130:",
+  ":clock11:",
+  ":clock1230:",
+  ":clock12:",
+  ":clock130:",
+  ":clock1:",
+  ":clock230:",
+  ":clock2:",
+  ":clock330:",
+  ":clock3:",
+  ":clock430:",
+  ":clock4:",
+  ":clock530:",
+  ":clock5:",
+  ":clock630:",
+  ":clock6:",
+  ":clock730:",
+  ":clock7:",
+  ":clock830:",
+  ":clock8:",
+  ":clock930:",
+  ":clock9:",
+  ":closed_book:",
+  ":closed_lock_with_key:",
+  ":closed_umbrella:",
+  ":cloud:",
+  ":cloud_with_lightning:",
+  ":cloud_with_rain:",
+  ":cloud_with_snow:",
+  ":cloud_with_tornado:",
+  ":clown_face:",
+  ":clubs:",
+  ":coat:",
+  ":cockroach:",
+  ":cocktail:",
+  ":coconut:",
+  ":coffee:",
+  ":coffin:",
+  ":coin:",
+  ":cold_face:",
+  ":cold_sweat:",
+  ":collision:",
+  ":comet:",
+  ":compass:",
+  ":compression:",
+  ":computer:",
+  ":confetti_ball:",
+  ":confounded:",
+  ":confused:",
+  ":congratulations:",
+  ":construction:",
+  ":construction_worker:",
+  ":control_knobs:",
+  ":convenience_store:",
+  ":cookie:",
+  ":cool:",
+  ":cop:",
+  ":copyright:",
+  ":coral:",
+  ":corn:",
+  ":couch_and_lamp:",
+  ":couple:",
+  ":couple_with_heart:",
+  ":couplekiss:",
+  ":cow2:",
+  ":cow:",
+  ":cowboy_hat_face:",
+  ":crab:",
+  ":credit_card:",
+  ":crescent_moon:",
+  ":cricket:",
+  ":cricket_bat_and_ball:",
+  ":crocodile:",
+  ":croissant:",
+  ":crossed_fingers:",
+  ":crossed_flags:",
+  ":crossed_swords:",
+  ":crown:",
+  ":crutch:",
+  ":cry:",
+  ":crying_cat_face:",
+  ":crystal_ball:",
+  ":cucumber:",
+  ":cup_with_straw:",
+  ":cupcake:",
+  ":cupid:",
+  ":curling_stone:",
+  ":curly_hair:",
+  ":curly_loop:",
+  ":currency_exchange:",
+  ":curry:",
+  ":custard:",
+  ":customs:",
+  ":cut_of_meat:",
+  ":cyclone:",
+  ":dagger_knife:",
+  ":dancer:",
+  ":dancers:",
+  ":dango:",
+  ":dark_skin_tone:",
+  ":dark_sunglasses:",
+  ":dart:",
+  ":dash:",
+  ":date:",
+  ":deaf_person:",
+  ":deciduous_tree:",
+  ":deer:",
+  ":department_store:",
+  ":derelict_house_building:",
+  ":desert:",
+  ":desert_island:",
+  ":desktop_computer:",
+  ":diamond_shape_with_a_dot_inside:",
+  ":diamonds:",
+  ":disappointed:",
+  ":disappointed_relieved:",
+  ":disguised_face:",
+  ":diving_mask:",
+  ":diya_lamp:",
+  ":dizzy:",
+  ":dizzy_face:",
+  ":dna:",
+  ":do_not_litter:",
+  ":dodo:",
+  ":dog2:",
+  ":dog:",
+  ":dollar:",
+  ":dolls:",
+  ":door:",
+  ":dotted_line_face:",
+  ":double_vertical_bar:",
+  ":doughnut:",
+  ":dove_of_peace:",
+  ":dragon:",
+  ":dragon_face:",
+  ":dress:",
+  ":dromedary_camel:",
+  ":drooling_face:",
+  ":drop_of_blood:",
+  ":droplet:",
+  ":drum:",
+  ":duck:",
+  ":dumpling:",
+  ":dvd:",
+  ":e_mail:",
+  ":eagle:",
+  ":ear:",
+  ":ear_of_rice:",
+  ":ear_with_hearing_aid:",
+  ":earth_africa:",
+  ":earth_americas:",
+  ":earth_asia:",
+  ":egg:",
+  ":eggplant:",
+  ":eight_pointed_black_star:",
+  ":eight_spoked_asterisk:",
+  ":eject_symbol:",
+  ":electric_plug:",
+  ":elephant:",
+  ":elevator:",
+  ":elf:",
+  ":empty_nest:",
+  ":end:",
+  ":envelope:",
+  ":envelope_with_arrow:",
+  ":euro:",
+  ":european_castle:",
+  ":european_post_office:",
+  ":evergreen_tree:",
+  ":exploding_head:",
+  ":expressionless:",
+  ":eye:",
+  ":eyeglasses:",
+  ":eyes:",
+  ":face_holding_back_tears:",
+  ":face_vomiting:",
+  ":face_with_diagonal_mouth:",
+  ":face_with_hand_over_mouth:",
+  ":face_with_head_bandage:",
+  ":face_with_monocle:",
+  ":face_with_open_eyes_and_hand_over_mouth:",
+  ":face_with_peeking_eye:",
+  ":face_with_raised_eyebrow:",
+  ":face_with_rolling_eyes:",
+  ":face_with_symbols_on_mouth:",
+  ":face_with_thermometer:",
+  ":factory:",
+  ":fairy:",
+  ":falafel:",
+  ":fallen_leaf:",
+  ":family:",
+  ":fast_forward:",
+  ":fax:",
+  ":fearful:",
+  ":feather:",
+  ":ferris_wheel:",
+  ":ferry:",
+  ":field_hockey_stick_and_ball:",
+  ":file_cabinet:",
+  ":file_folder:",
+  ":film_frames:",
+  ":film_projector:",
+  ":fire:",
+  ":fire_engine:",
+  ":fire_extinguisher:",
+  ":firecracker:",
+  ":fireworks:",
+  ":first_quarter_moon:",
+  ":first_quarter_moon_with_face:",
+  ":fish:",
+  ":fish_cake:",
+  ":fishing_pole_and_fish:",
+  ":fist:",
+  ":flags:",
+  ":flamingo:",
+  ":flashlight:",
+  ":flat_shoe:",
+  ":flatbread:",
+  ":fleur_de_lis:",
+  ":flipper:",
+  ":floppy_disk:",
+  ":flower_playing_cards:",
+  ":flushed:",
+  ":fly:",
+  ":flying_disc:",
+  ":flying_saucer:",
+  ":fog:",
+  ":foggy:",
+  ":fondue:",
+  ":foot:",
+  ":football:",
+  ":footprints:",
+  ":fork_and_knife:",
+  ":fork_and_knife_with_plate:",
+  ":fortune_cookie:",
+  ":fountain:",
+  ":four_leaf_clover:",
+  ":fox:",
+  ":frame_with_picture:",
+  ":free:",
+  ":fried_shrimp:",
+  ":fries:",
+  ":frog:",
+  ":frowning:",
+  ":fuelpump:",
+  ":full_moon:",
+  ":full_moon_with_face:",
+  ":funeral_urn:",
+  ":game_die:",
+  ":garlic:",
+  ":gear:",
+  ":gem:",
+  ":gemini:",
+  ":genie:",
+  ":ghost:",
+  ":gift:",
+  ":gift_heart:",
+  ":giraffe:",
+  ":girl:",
+  ":glass_of_milk:",
+  ":globe_with_meridians:",
+  ":gloves:",
+  ":goal_net:",
+  ":goat:",
+  ":goggles:",
+  ":golf:",
+  ":golfer:",
+  ":gorilla:",
+  ":grapes:",
+  ":green_apple:",
+  ":green_book:",
+  ":green_circle:",
+  ":green_heart:",
+  ":green_salad:",
+  ":green_square:",
+  ":grey_exclamation:",
+  ":grey_question:",
+  ":grimacing:",
+  ":grin:",
+  ":grinning:",
+  ":guardsman:",
+  ":guide_dog:",
+  ":guitar:",
+  ":gun:",
+  ":haircut:",
+  ":hamburger:",
+  ":hammer:",
+  ":hammer_and_pick:",
+  ":hammer_and_wrench:",
+  ":hamsa:",
+  ":hamster:",
+  ":hand_with_index_finger_and_thumb_crossed:",
+  ":handbag:",
+  ":handshake:",
+  ":hatched_chick:",
+  ":hatching_chick:",
+  ":headphones:",
+  ":headstone:",
+  ":hear_no_evil:",
+  ":heart:",
+  ":heart_decoration:",
+  ":heart_eyes:",
+  ":heart_eyes_cat:",
+  ":heart_hands:",
+  ":heartbeat:",
+  ":heartpulse:",
+  ":hearts:",
+  ":heavy_check_mark:",
+  ":heavy_division_sign:",
+  ":heavy_dollar_sign:",
+  ":heavy_equals_sign:",
+  ":heavy_exclamation_mark:",
+  ":heavy_heart_exclamation_mark_ornament:",
+  ":heavy_minus_sign:",
+  ":heavy_multiplication_x:",
+  ":heavy_plus_sign:",
+  ":hedgehog:",
+  ":helicopter:",
+  ":helm_symbol:",
+  ":helmet_with_white_cross:",
+  ":herb:",
+  ":hibiscus:",
+  ":high_brightness:",
+  ":high_heel:",
+  ":hiking_boot:",
+  ":hindu_temple:",
+  ":hippopotamus:",
+  ":hole:",
+  ":honey_pot:",
+  ":honeybee:",
+  ":hook:",
+  ":horse:",
+  ":horse_racing:",
+  ":hospital:",
+  ":hot_dog:",
+  ":hot_face:",
+  ":hot_pepper:",
+  ":hotel:",
+  ":hotsprings:",
+  ":hourglass:",
+  ":hourglass_flowing_sand:",
+  ":house:",
+  ":house_buildings:",
+  ":house_with_garden:",
+  ":hugging_face:",
+  ":hushed:",
+  ":hut:",
+  ":ice:",
+  ":ice_cream:",
+  ":ice_hockey_stick_and_puck:",
+  ":ice_skate:",
+  ":icecream:",
+  ":id:",
+  ":identification_card:",
+  ":ideograph_advantage:",
+  ":imp:",
+  ":inbox_tray:",
+  ":incoming_envelope:",
+  ":index_pointing_at_the_viewer:",
+  ":information_desk_person:",
+  ":information_source:",
+  ":innocent:",
+  ":interrobang:",
+  ":iphone:",
+  ":jack_o_lantern:",
+  ":japan:",
+  ":japanese_application_button:",
+  ":japanese_castle:",
+  ":japanese_discount_button:",
+  ":japanese_free_of_charge_button:",
+  ":japanese_goblin:",
+  ":japanese_no_vacancy_button:",
+  ":japanese_not_free_of_charge_button:",
+  ":japanese_ogre:",
+  ":japanese_open_for_business_button:",
+  ":japanese_passing_grade_button:",
+  ":japanese_prohibited_button:",
+  ":japanese_reserved_button:",
+  ":japanese_vacancy_button:",
+  ":jar:",
+  ":jeans:",
+  ":joy:",
+  ":joy_cat:",
+  ":joystick:",
+  ":kaaba:",
+  ":kangaroo:",
+  ":key:",
+  ":keyboard:",
+  ":kick_scooter:",
+  ":kimono:",
+  ":kiss:",
+  ":kissing:",
+  ":kissing_cat:",
+  ":kissing_closed_eyes:",
+  ":kissing_heart:",
+  ":kissing_smiling_eyes:",
+  ":kite:",
+  ":kiwi_fruit:",
+  ":knife:",
+  ":knot:",
+  ":koala:",
+  ":koko:",
+  ":lab_coat:",
+  ":label:",
+  ":lacrosse:",
+  ":ladder:",
+  ":lantern:",
+  ":large_blue_circle:",
+  ":large_blue_diamond:",
+  ":large_orange_diamond:",
+  ":last_quarter_moon:",
+  ":last_quarter_moon_with_face:",
+  ":latin_cross:",
+  ":leafy_green:",
+  ":leaves:",
+  ":ledger:",
+  ":left_facing_fist:",
+  ":left_luggage:",
+  ":left_right_arrow:",
+  ":leftwards_arrow_with_hook:",
+  ":leftwards_hand:",
+  ":leg:",
+  ":lemon:",
+  ":leo:",
+  ":leopard:",
+  ":level_slider:",
+  ":libra:",
+  ":light_rail:",
+  ":light_skin_tone:",
+  ":link:",
+  ":linked_paperclips:",
+  ":lion_face:",
+  ":lips:",
+  ":lipstick:",
+  ":lizard:",
+  ":llama:",
+  ":lobster:",
+  ":lock:",
+  ":lock_with_ink_pen:",
+  ":lollipop:",
+  ":long_drum:",
+  ":loop:",
+  ":lotion_bottle:",
+  ":lotus:",
+  ":loud_sound:",
+  ":loudspeaker:",
+  ":love_hotel:",
+  ":love_letter:",
+  ":love_you_gesture:",
+  ":low_battery:",
+  ":low_brightness:",
+  ":lower_left_ballpoint_pen:",
+  ":lower_left_crayon:",
+  ":lower_left_fountain_pen:",
+  ":lower_left_paintbrush:",
+  ":luggage:",
+  ":lungs:",
+  ":lying_face:",
+  ":m:",
+  ":mag:",
+  ":mag_right:",
+  ":mage:",
+  ":magic_wand:",
+  ":magnet:",
+  ":mahjong:",
+  ":mailbox:",
+  ":mailbox_closed:",
+  ":mailbox_with_mail:",
+  ":mailbox_with_no_mail:",
+  ":mammoth:",
+  ":man:",
+  ":man_dancing:",
+  ":man_in_business_suit_levitating:",
+  ":man_with_gua_pi_mao:",
+  ":man_with_turban:",
+  ":mango:",
+  ":mantelpiece_clock:",
+  ":manual_wheelchair:",
+  ":maple_leaf:",
+  ":martial_arts_uniform:",
+  ":mask:",
+  ":massage:",
+  ":mate:",
+  ":meat_on_bone:",
+  ":mechanical_arm:",
+  ":mechanical_leg:",
+  ":medium_dark_skin_tone:",
+  ":medium_light_skin_tone:",
+  ":medium_skin_tone:",
+  ":mega:",
+  ":melon:",
+  ":melting_face:",
+  ":menorah_with_nine_branches:",
+  ":mens:",
+  ":merperson:",
+  ":metro:",
+  ":microbe:",
+  ":microphone:",
+  ":microscope:",
+  ":military_helmet:",
+  ":military_medal:",
+  ":milky_way:",
+  ":minibus:",
+  ":minidisc:",
+  ":mirror:",
+  ":mirror_ball:",
+  ":mobile_phone_off:",
+  ":money_mouth_face:",
+  ":money_with_wings:",
+  ":moneybag:",
+  ":monkey:",
+  ":monkey_face:",
+  ":monorail:",
+  ":moon_cake:",
+  ":mortar_board:",
+  ":mosque:",
+  ":mosquito:",
+  ":motor_boat:",
+  ":motor_scooter:",
+  ":motorized_wheelchair:",
+  ":motorway:",
+  ":mount_fuji:",
+  ":mountain:",
+  ":mountain_bicyclist:",
+  ":mountain_cableway:",
+  ":mountain_railway:",
+  ":mouse2:",
+  ":mouse:",
+  ":mouse_trap:",
+  ":movie_camera:",
+  ":moyai:",
+  ":mrs_claus:",
+  ":muscle:",
+  ":mushroom:",
+  ":musical_keyboard:",
+  ":musical_note:",
+  ":musical_score:",
+  ":mute:",
+  ":nail_care:",
+  ":name_badge:",
+  ":national_park:",
+  ":nauseated_face:",
+  ":nazar_amulet:",
+  ":necktie:",
+  ":negative_squared_cross_mark:",
+  ":nerd_face:",
+  ":nest_with_eggs:",
+  ":nesting_dolls:",
+  ":neutral_face:",
+  ":new:",
+  ":new_moon:",
+  ":new_moon_with_face:",
+  ":newspaper:",
+  ":ng:",
+  ":night_with_stars:",
+  ":ninja:",
+  ":no_bell:",
+  ":no_bicycles:",
+  ":no_entry:",
+  ":no_entry_sign:",
+  ":no_good:",
+  ":no_mobile_phones:",
+  ":no_mouth:",
+  ":no_pedestrians:",
+  ":no_smoking:",
+  ":non_potable_water:",
+  ":nose:",
+  ":notebook:",
+  ":notebook_with_decorative_cover:",
+  ":notes:",
+  ":nut_and_bolt:",
+  ":o2:",
+  ":o:",
+  ":ocean:",
+  ":octopus:",
+  ":oden:",
+  ":office:",
+  ":oil_drum:",
+  ":ok:",
+  ":ok_hand:",
+  ":ok_woman:",
+  ":old_key:",
+  ":older_man:",
+  ":older_person:",
+  ":older_woman:",
+  ":olive:",
+  ":om_symbol:",
+  ":on:",
+  ":oncoming_automobile:",
+  ":oncoming_bus:",
+  ":oncoming_police_car:",
+  ":oncoming_taxi:",
+  ":one_piece_swimsuit:",
+  ":onion:",
+  ":open_book:",
+  ":open_file_folder:",
+  ":open_hands:",
+  ":open_mouth:",
+  ":ophiuchus:",
+  ":orange_book:",
+  ":orange_circle:",
+  ":orange_heart:",
+  ":orange_square:",
+  ":orangutan:",
+  ":orthodox_cross:",
+  ":otter:",
+  ":outbox_tray:",
+  ":owl:",
+  ":ox:",
+  ":oyster:",
+  ":package:",
+  ":page_facing_up:",
+  ":page_with_curl:",
+  ":pager:",
+  ":palm_down_hand:",
+  ":palm_tree:",
+  ":palm_up_hand:",
+  ":palms_up_together:",
+  ":pancakes:",
+  ":panda_face:",
+  ":paperclip:",
+  ":parachute:",
+  ":parking:",
+  ":parrot:",
+  ":part_alternation_mark:",
+  ":partly_sunny:",
+  ":partying_face:",
+  ":passenger_ship:",
+  ":passport_control:",
+  ":paw_prints:",
+  ":peace_symbol:",
+  ":peach:",
+  ":peacock:",
+  ":peanuts:",
+  ":pear:",
+  ":pencil2:",
+  ":pencil:",
+  ":penguin:",
+  ":pensive:",
+  ":people_hugging:",
+  ":people_wrestling:",
+  ":performing_arts:",
+  ":persevere:",
+  ":person:",
+  ":person_beard:",
+  ":person_cartwheeling:",
+  ":person_climbing:",
+  ":person_facepalming:",
+  ":person_fencing:",
+  ":person_frowning:",
+  ":person_in_lotus_position:",
+  ":person_in_steamy_room:",
+  ":person_in_tuxedo:",
+  ":person_juggling:",
+  ":person_kneeling:",
+  ":person_playing_handball:",
+  ":person_playing_water_polo:",
+  ":person_shrugging:",
+  ":person_standing:",
+  ":person_with_ball:",
+  ":person_with_blond_hair:",
+  ":person_with_crown:",
+  ":person_with_pouting_face:",
+  ":petri_dish:",
+  ":pick:",
+  ":pickup_truck:",
+  ":pie:",
+  ":pig2:",
+  ":pig:",
+  ":pig_nose:",
+  ":pill:",
+  ":pinata:",
+  ":pinched_fingers:",
+  ":pinching_hand:",
+  ":pineapple:",
+  ":pisces:",
+  ":pizza:",
+  ":placard:",
+  ":place_of_worship:",
+  ":playground_slide:",
+  ":pleading_face:",
+  ":plunger:",
+  ":point_down:",
+  ":point_left:",
+  ":point_right:",
+  ":point_up:",
+  ":point_up_2:",
+  ":police_car:",
+  ":poodle:",
+  ":popcorn:",
+  ":post_office:",
+  ":postal_horn:",
+  ":postbox:",
+  ":potable_water:",
+  ":potato:",
+  ":potted_plant:",
+  ":pouch:",
+  ":poultry_leg:",
+  ":pound:",
+  ":pouring_liquid:",
+  ":pouting_cat:",
+  ":pray:",
+  ":prayer_beads:",
+  ":pregnant_man:",
+  ":pregnant_person:",
+  ":pregnant_woman:",
+  ":pretzel:",
+  ":prince:",
+  ":princess:",
+  ":printer:",
+  ":punch:",
+  ":purple_circle:",
+  ":purple_heart:",
+  ":purple_square:",
+  ":purse:",
+  ":pushpin:",
+  ":put_litter_in_its_place:",
+  ":puzzle_piece:",
+  ":question:",
+  ":rabbit2:",
+  ":rabbit:",
+  ":raccoon:",
+  ":racehorse:",
+  ":racing_car:",
+  ":racing_motorcycle:",
+  ":radio:",
+  ":radio_button:",
+  ":radioactive_sign:",
+  ":rage:",
+  ":railway_car:",
+  ":railway_track:",
+  ":rainbow:",
+  ":raised_back_of_hand:",
+  ":raised_hand:",
+  ":raised_hand_with_fingers_splayed:",
+  ":raised_hand_with_part_between_middle_and_ring_fingers:",
+  ":raised_hands:",
+  ":raising_hand:",
+  ":ram:",
+  ":ramen:",
+  ":rat:",
+  ":razor:",
+  ":receipt:",
+  ":recycle:",
+  ":red_car:",
+  ":red_circle:",
+  ":red_envelope:",
+  ":red_hair:",
+  ":red_square:",
+  ":registered:",
+  ":relaxed:",
+  ":relieved:",
+  ":reminder_ribbon:",
+  ":repeat:",
+  ":repeat_one:",
+  ":restroom:",
+  ":reversed_hand_with_middle_finger_extended:",
+  ":revolving_hearts:",
+  ":rewind:",
+  ":rhinoceros:",
+  ":ribbon:",
+  ":rice:",
+  ":rice_ball:",
+  ":rice_cracker:",
+  ":rice_scene:",
+  ":right_anger_bubble:",
+  ":right_facing_fist:",
+  ":rightwards_hand:",
+  ":ring:",
+  ":ring_buoy:",
+  ":ringed_planet:",
+  ":robot_face:",
+  ":rock:",
+  ":rocket:",
+  ":roll_of_paper:",
+  ":rolled_up_newspaper:",
+  ":roller_coaster:",
+  ":roller_skate:",
+  ":rolling_on_the_floor_laughing:",
+  ":rooster:",
+  ":rose:",
+  ":rosette:",
+  ":rotating_light:",
+  ":round_pushpin:",
+  ":rowboat:",
+  ":rugby_football:",
+  ":running:",
+  ":running_shirt_with_sash:",
+  ":sa:",
+  ":safety_pin:",
+  ":safety_vest:",
+  ":sagittarius:",
+  ":sailboat:",
+  ":sake:",
+  ":salt:",
+  ":saluting_face:",
+  ":sandal:",
+  ":sandwich:",
+  ":santa:",
+  ":sari:",
+  ":satellite:",
+  ":satisfied:",
+  ":sauropod:",
+  ":saxophone:",
+  ":scales:",
+  ":scarf:",
+  ":school:",
+  ":school_satchel:",
+  ":scissors:",
+  ":scorpion:",
+  ":scorpius:",
+  ":scream:",
+  ":scream_cat:",
+  ":screwdriver:",
+  ":scroll:",
+  ":seal:",
+  ":seat:",
+  ":secret:",
+  ":see_no_evil:",
+  ":seedling:",
+  ":selfie:",
+  ":sewing_needle:",
+  ":shallow_pan_of_food:",
+  ":shamrock:",
+  ":shark:",
+  ":shaved_ice:",
+  ":sheep:",
+  ":shell:",
+  ":shield:",
+  ":shinto_shrine:",
+  ":ship:",
+  ":shit:",
+  ":shoe:",
+  ":shopping_bags:",
+  ":shopping_cart:",
+  ":shorts:",
+  ":shower:",
+  ":shrimp:",
+  ":shushing_face:",
+  ":sign_of_the_horns:",
+  ":signal_strength:",
+  ":six_pointed_star:",
+  ":skateboard:",
+  ":ski:",
+  ":skier:",
+  ":skull:",
+  ":skull_and_crossbones:",
+  ":skunk:",
+  ":sled:",
+  ":sleeping:",
+  ":sleeping_accommodation:",
+  ":sleepy:",
+  ":sleuth_or_spy:",
+  ":slightly_frowning_face:",
+  ":slightly_smiling_face:",
+  ":slot_machine:",
+  ":sloth:",
+  ":small_airplane:",
+  ":small_blue_diamond:",
+  ":small_orange_diamond:",
+  ":small_red_triangle:",
+  ":small_red_triangle_down:",
+  ":smile:",
+  ":smile_cat:",
+  ":smiley:",
+  ":smiley_cat:",
+  ":smiling_face_with_hearts:",
+  ":smiling_face_with_tear:",
+  ":smiling_imp:",
+  ":smirk:",
+  ":smirk_cat:",
+  ":smoking:",
+  ":snail:",
+  ":snake:",
+  ":sneezing_face:",
+  ":snow_capped_mountain:",
+  ":snowboarder:",
+  ":snowflake:",
+  ":snowman:",
+  ":snowman_without_snow:",
+  ":soap:",
+  ":sob:",
+  ":soccer:",
+  ":socks:",
+  ":softball:",
+  ":soon:",
+  ":sos:",
+  ":sound:",
+  ":space_invader:",
+  ":spades:",
+  ":spaghetti:",
+  ":sparkle:",
+  ":sparkler:",
+  ":sparkles:",
+  ":sparkling_heart:",
+  ":speak_no_evil:",
+  ":speaker:",
+  ":speaking_head_in_silhouette:",
+  ":speech_balloon:",
+  ":speedboat:",
+  ":spider:",
+  ":spider_web:",
+  ":spiral_calendar_pad:",
+  ":spiral_note_pad:",
+  ":sponge:",
+  ":spoon:",
+  ":sports_medal:",
+  ":squid:",
+  ":stadium:",
+  ":star2:",
+  ":star:",
+  ":star_and_crescent:",
+  ":star_of_david:",
+  ":star_struck:",
+  ":stars:",
+  ":station:",
+  ":statue_of_liberty:",
+  ":steam_locomotive:",
+  ":stethoscope:",
+  ":stew:",
+  ":stop_sign:",
+  ":stopwatch:",
+  ":straight_ruler:",
+  ":strawberry:",
+  ":stuck_out_tongue:",
+  ":stuck_out_tongue_closed_eyes:",
+  ":stuck_out_tongue_winking_eye:",
+  ":studio_microphone:",
+  ":stuffed_flatbread:",
+  ":sun_with_face:",
+  ":sunflower:",
+  ":sunglasses:",
+  ":sunny:",
+  ":sunrise:",
+  ":sunrise_over_mountains:",
+  ":superhero:",
+  ":supervillain:",
+  ":surfer:",
+  ":sushi:",
+  ":suspension_railway:",
+  ":swan:",
+  ":sweat:",
+  ":sweat_drops:",
+  ":sweat_smile:",
+  ":sweet_potato:",
+  ":swimmer:",
+  ":symbols:",
+  ":synagogue:",
+  ":syringe:",
+  ":t_rex:",
+  ":table_tennis_paddle_and_ball:",
+  ":taco:",
+  ":tada:",
+  ":takeout_box:",
+  ":tamale:",
+  ":tanabata_tree:",
+  ":tangerine:",
+  ":taurus:",
+  ":taxi:",
+  ":tea:",
+  ":teapot:",
+  ":teddy_bear:",
+  ":telephone:",
+  ":telephone_receiver:",
+  ":telescope:",
+  ":tennis:",
+  ":tent:",
+  ":test_tube:",
+  ":thermometer:",
+  ":thinking_face:",
+  ":thong_sandal:",
+  ":thought_balloon:",
+  ":thread:",
+  ":three_button_mouse:",
+  ":thumbsdown:",
+  ":thumbsup:",
+  ":thunder_cloud_and_rain:",
+  ":ticket:",
+  ":tiger2:",
+  ":tiger:",
+  ":timer_clock:",
+  ":tired_face:",
+  ":tm:",
+  ":toilet:",
+  ":tokyo_tower:",
+  ":tomato:",
+  ":tongue:",
+  ":toolbox:",
+  ":tooth:",
+  ":toothbrush:",
+  ":top:",
+  ":tophat:",
+  ":trackball:",
+  ":tractor:",
+  ":traffic_light:",
+  ":train2:",
+  ":train:",
+  ":tram:",
+  ":triangular_flag_on_post:",
+  ":triangular_ruler:",
+  ":trident:",
+  ":triumph:",
+  ":troll:",
+  ":trolleybus:",
+  ":trophy:",
+  ":tropical_drink:",
+  ":tropical_fish:",
+  ":truck:",
+  ":trumpet:",
+  ":tshirt:",
+  ":tulip:",
+  ":tumbler_glass:",
+  ":turkey:",
+  ":turtle:",
+  ":tv:",
+  ":twisted_rightwards_arrows:",
+  ":two_hearts:",
+  ":two_men_holding_hands:",
+  ":two_women_holding_hands:",
+  ":umbrella:",
+  ":umbrella_on_ground:",
+  ":umbrella_with_rain_drops:",
+  ":unamused:",
+  ":underage:",
+  ":unicorn_face:",
+  ":unlock:",
+  ":up:",
+  ":upside_down_face:",
+  ":v:",
+  ":vampire:",
+  ":vertical_traffic_light:",
+  ":vhs:",
+  ":vibration_mode:",
+  ":video_camera:",
+  ":video_game:",
+  ":violin:",
+  ":virgo:",
+  ":volcano:",
+  ":volleyball:",
+  ":vs:",
+  ":waffle:",
+  ":walking:",
+  ":waning_crescent_moon:",
+  ":waning_gibbous_moon:",
+  ":warning:",
+  ":wastebasket:",
+  ":watch:",
+  ":water_buffalo:",
+  ":watermelon:",
+  ":wave:",
+  ":waving_black_flag:",
+  ":waving_white_flag:",
+  ":wavy_dash:",
+  ":waxing_crescent_moon:",
+  ":waxing_gibbous_moon:",
+  ":wc:",
+  ":weary:",
+  ":wedding:",
+  ":weight_lifter:",
+  ":whale2:",
+  ":whale:",
+  ":wheel:",
+  ":wheel_of_dharma:",
+  ":wheelchair:",
+  ":white_cane:",
+  ":white_check_mark:",
+  ":white_circle:",
+  ":white_flower:",
+  ":white_frowning_face:",
+  ":white_hair:",
+  ":white_heart:",
+  ":white_large_square:",
+  ":white_medium_small_square:",
+  ":white_medium_square:",
+  ":white_small_square:",
+  ":white_square_button:",
+  ":white_sun_behind_cloud:",
+  ":white_sun_behind_cloud_with_rain:",
+  ":white_sun_with_small_cloud:",
+  ":wilted_flower:",
+  ":wind_blowing_face:",
+  ":wind_chime:",
+  ":window:",
+  ":wine_glass:",
+  ":wink:",
+  ":wolf:",
+  ":woman:",
+  ":woman_with_headscarf:",
+  ":womans_clothes:",
+  ":womans_hat:",
+  ":womens:",
+  ":wood:",
+  ":woozy_face:",
+  ":world_map:",
+  ":worm:",
+  ":worried:",
+  ":wrench:",
+  ":writing_hand:",
+  ":x:",
+  ":x_ray:",
+  ":yarn:",
+  ":yawning_face:",
+  ":yellow_circle:",
+  ":yellow_heart:",
+  ":yellow_square:",
+  ":yen:",
+  ":yin_yang:",
+  ":yo_yo:",
+  ":yum:",
+  ":zany_face:",
+  ":zap:",
+  ":zebra:",
+  ":zipper_mouth_face:",
+  ":zombie:",
+  ":zzz:",
 };
@@ -9,7 +9,11 @@
 
 #include <climits>
 #include <fstream>
+#include <mutex>
+#include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <wordexp.h>
 
 #ifdef __APPLE__
@@ -158,24 +162,51 @@ std::string FileUtil::GetFileExt(const std::string& p_Path)
   return p_Path.substr(lastPeriod);
 }
 
-std::string FileUtil::GetMimeType(const std::string& p_Path)
+ssize_t FileUtil::GetFileSize(const std::string& p_Path)
 {
-  int flags = MAGIC_MIME_TYPE;
-  magic_t cookie = magic_open(flags);
-  if (cookie == NULL) return "";
+  struct stat sb;
+  if (stat(p_Path.c_str(), &sb) != 0) return -1;
 
-  std::string mime;
-  if (magic_load(cookie, NULL) == 0)
+  return sb.st_size;
+}
+
+std::string FileUtil::GetMimeType(const std::string& p_Path)
+{
+  // magic database is loaded once for the process lifetime, cookie use is serialized as it is
+  // not thread-safe. only the file header is read, which magic rules for common types look at.
+  static std::mutex s_MagicMutex;
+  static magic_t s_Cookie = []()
   {
-    std::string buf = ReadFile(p_Path);
-    const char* rv = magic_buffer(cookie, buf.c_str(), buf.size());
-    if (rv != NULL)
+    magic_t cookie = magic_open(MAGIC_MIME_TYPE);
+    if ((cookie != NULL) && (magic_load(cookie, NULL) != 0))
     {
-      mime = std::string(rv);
+      LOG_WARNING("magic load failed: %s", magic_error(cookie));
+      magic_close(cookie);
+      cookie = NULL;
     }
+
+    return cookie;
+  }();
+
+  if (s_Cookie == NULL) return "";
+
+  static const size_t s_HeaderSize = 64 * 1024;
+  std::vector<char> buf(s_HeaderSize);
+  int fd = open(p_Path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return "";
+
+  ssize_t len = pread(fd, buf.data(), buf.size(), 0);
+  close(fd);
+  if (len < 0) return "";
+
+  std::string mime;
+  std::unique_lock<std::mutex> lock(s_MagicMutex);
+  const char* rv = magic_buffer(s_Cookie, buf.data(), len);
+  if (rv != NULL)
+  {
+    mime = std::string(rv);
   }
 
-  magic_close(cookie);
   return mime;
 }
 
@@ -71,6 +71,7 @@ public:
   static int GetDirVersion(const std::string& p_Dir);
   static std::string GetDownloadsDir();
   static std::string GetFileExt(const std::string& p_Path);
+  static ssize_t GetFileSize(const std::string& p_Path);
   static std::string GetMimeType(const std::string& p_Path);
   static std::string GetSelfPath();
   static std::string GetLibSuffix();
@@ -0,0 +1,50 @@
+// heapsize.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// approximate heap usage of common containers, for the per-subsystem heap stats. node based
+// containers are counted as value size plus node pointers, allocator headers are not included.
+class HeapSize
+{
+public:
+  static size_t Of(const std::string& p_Str)
+  {
+    // strings within the small string buffer have no heap allocation
+    static const size_t s_InlineCapacity = std::string().capacity();
+    return (p_Str.capacity() > s_InlineCapacity) ? (p_Str.capacity() + 1) : 0;
+  }
+
+  static size_t Of(const std::wstring& p_Str)
+  {
+    static const size_t s_InlineCapacity = std::wstring().capacity();
+    return (p_Str.capacity() > s_InlineCapacity) ? ((p_Str.capacity() + 1) * sizeof(wchar_t)) : 0;
+  }
+
+  template<typename T>
+  static size_t Of(const std::vector<T>& p_Vec)
+  {
+    return p_Vec.capacity() * sizeof(T);
+  }
+
+  // nodes of map, set and list containers, excluding heap owned by the values
+  template<typename TContainer>
+  static size_t Nodes(const TContainer& p_Container)
+  {
+    return p_Container.size() * (sizeof(typename TContainer::value_type) + (3 * sizeof(void*)));
+  }
+
+  // bucket array of unordered containers, excluding nodes
+  template<typename TContainer>
+  static size_t Buckets(const TContainer& p_Container)
+  {
+    return p_Container.bucket_count() * sizeof(void*);
+  }
+};
@@ -0,0 +1,38 @@
+// internedstr.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "internedstr.h"
+
+#include <mutex>
+#include <unordered_set>
+
+InternedStr::InternedStr()
+{
+  static const std::string* s_EmptyStr = Intern(std::string());
+  m_Str = s_EmptyStr;
+}
+
+InternedStr::InternedStr(const std::string& p_Str)
+  : m_Str(Intern(p_Str))
+{
+}
+
+InternedStr::InternedStr(const char* p_Str)
+  : m_Str(Intern(std::string(p_Str)))
+{
+}
+
+const std::string* InternedStr::Intern(const std::string& p_Str)
+{
+  // @note: function-local statics, as handles may be created during static initialization
+  static std::mutex s_Mutex;
+  static std::unordered_set<std::string> s_Strs;
+
+  // set nodes are never erased, so element addresses remain valid
+  std::unique_lock<std::mutex> lock(s_Mutex);
+  return &*s_Strs.insert(p_Str).first;
+}
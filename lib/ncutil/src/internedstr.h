@@ -0,0 +1,100 @@
+// internedstr.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+// handle to a string interned for the process lifetime, equal strings share one handle, so
+// copy, compare and hash are pointer operations. ordering is by pointer, not by content.
+class InternedStr
+{
+public:
+  InternedStr();
+  InternedStr(const std::string& p_Str);
+  InternedStr(const char* p_Str);
+
+  const std::string& Str() const
+  {
+    return *m_Str;
+  }
+
+  operator const std::string&() const
+  {
+    return *m_Str;
+  }
+
+  const char* c_str() const
+  {
+    return m_Str->c_str();
+  }
+
+  bool empty() const
+  {
+    return m_Str->empty();
+  }
+
+  bool operator==(const InternedStr& p_Other) const
+  {
+    return m_Str == p_Other.m_Str;
+  }
+
+  bool operator!=(const InternedStr& p_Other) const
+  {
+    return m_Str != p_Other.m_Str;
+  }
+
+  bool operator<(const InternedStr& p_Other) const
+  {
+    return std::less<const std::string*>()(m_Str, p_Other.m_Str);
+  }
+
+  size_t Hash() const
+  {
+    return std::hash<const std::string*>()(m_Str);
+  }
+
+private:
+  static const std::string* Intern(const std::string& p_Str);
+
+private:
+  const std::string* m_Str;
+};
+
+// comparing with plain strings is by content, and does not intern
+inline bool operator==(const InternedStr& p_Lhs, const std::string& p_Rhs)
+{
+  return p_Lhs.Str() == p_Rhs;
+}
+
+inline bool operator==(const std::string& p_Lhs, const InternedStr& p_Rhs)
+{
+  return p_Lhs == p_Rhs.Str();
+}
+
+inline bool operator!=(const InternedStr& p_Lhs, const std::string& p_Rhs)
+{
+  return p_Lhs.Str() != p_Rhs;
+}
+
+inline bool operator!=(const std::string& p_Lhs, const InternedStr& p_Rhs)
+{
+  return p_Lhs != p_Rhs.Str();
+}
+
+namespace std
+{
+  template<>
+  struct hash<InternedStr>
+  {
+    size_t operator()(const InternedStr& p_Str) const
+    {
+      return p_Str.Hash();
+    }
+  };
+}
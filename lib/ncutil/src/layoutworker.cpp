@@ -0,0 +1,130 @@
+// layoutworker.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "layoutworker.h"
+
+#include <algorithm>
+
+#include "heapsize.h"
+#include "strutil.h"
+#include "threadregistry.h"
+
+LayoutWorker::LayoutWorker(size_t p_MaxLines)
+  : m_Cache(p_MaxLines)
+{
+  m_Thread = std::thread(&LayoutWorker::Run, this);
+}
+
+LayoutWorker::~LayoutWorker()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+  }
+
+  m_CondVar.notify_one();
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+std::vector<std::wstring> LayoutWorker::GetLines(const std::string& p_MsgId, const std::string& p_Text,
+                                                 int p_Width, bool p_EmojiEnabled)
+{
+  // edited text or changed width / emoji setting yields a new key
+  const LayoutKey layoutKey = GetKey(p_MsgId, p_Text, p_Width, p_EmojiEnabled);
+  std::vector<std::wstring> wlines;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_Cache.Get(layoutKey, wlines)) return wlines;
+  }
+
+  wlines = Layout(p_Text, p_Width, p_EmojiEnabled);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Cache.Put(layoutKey, wlines, std::max<size_t>(wlines.size(), 1));
+  return wlines;
+}
+
+void LayoutWorker::Prefetch(std::vector<Job>&& p_Jobs, int p_Width, bool p_EmojiEnabled)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Jobs.assign(std::make_move_iterator(p_Jobs.begin()), std::make_move_iterator(p_Jobs.end()));
+    m_JobsWidth = p_Width;
+    m_JobsEmojiEnabled = p_EmojiEnabled;
+  }
+
+  m_CondVar.notify_one();
+}
+
+LayoutWorker::LayoutKey LayoutWorker::GetKey(const std::string& p_MsgId, const std::string& p_Text, int p_Width,
+                                             bool p_EmojiEnabled)
+{
+  return LayoutKey(p_MsgId, std::hash<std::string>{ }(p_Text), p_Width, p_EmojiEnabled);
+}
+
+std::vector<std::wstring> LayoutWorker::Layout(const std::string& p_Text, int p_Width, bool p_EmojiEnabled)
+{
+  const std::string text = p_EmojiEnabled ? p_Text : StrUtil::Textize(p_Text);
+  std::vector<std::wstring> wlines = StrUtil::WordWrap(StrUtil::ToWString(text), p_Width, false, false, false, 2);
+  for (auto& wline : wlines)
+  {
+    wline = StrUtil::TrimPadWString(wline, p_Width);
+  }
+
+  return wlines;
+}
+
+size_t LayoutWorker::GetCacheHeapSize()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  size_t size = m_Cache.GetNodesHeapSize();
+  // *INDENT-OFF*
+  m_Cache.ForEach([&](const LayoutKey& p_Key, const std::vector<std::wstring>& p_Lines)
+  {
+    size += HeapSize::Of(std::get<0>(p_Key)) + HeapSize::Of(p_Lines);
+    for (const auto& line : p_Lines)
+    {
+      size += HeapSize::Of(line);
+    }
+  });
+  // *INDENT-ON*
+
+  return size;
+}
+
+void LayoutWorker::Run()
+{
+  ThreadRegistry::Register("layout");
+
+  while (true)
+  {
+    Job job;
+    LayoutKey layoutKey;
+    int width = 0;
+    bool emojiEnabled = false;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait(lock, [&]() { return !m_Running || !m_Jobs.empty(); });
+      if (!m_Running) break;
+
+      job = std::move(m_Jobs.front());
+      m_Jobs.pop_front();
+      width = m_JobsWidth;
+      emojiEnabled = m_JobsEmojiEnabled;
+      layoutKey = GetKey(job.msgId, job.text, width, emojiEnabled);
+      if (m_Cache.Contains(layoutKey)) continue;
+    }
+
+    std::vector<std::wstring> wlines = Layout(job.text, width, emojiEnabled);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Cache.Put(layoutKey, wlines, std::max<size_t>(wlines.size(), 1));
+  }
+}
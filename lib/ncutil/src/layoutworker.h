@@ -0,0 +1,57 @@
+// layoutworker.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "lrucache.h"
+
+// word wraps message texts into padded, ready to draw lines on a worker thread. finished layouts
+// are kept in a bounded cache shared with the caller, which lays out synchronously on a miss.
+// layouts of messages near the visible range are queued ahead, so redraws and paging mostly find
+// them ready. a newer prefetch replaces the pending one.
+class LayoutWorker
+{
+public:
+  struct Job
+  {
+    std::string msgId;
+    std::string text;
+  };
+
+  explicit LayoutWorker(size_t p_MaxLines);
+  ~LayoutWorker();
+
+  std::vector<std::wstring> GetLines(const std::string& p_MsgId, const std::string& p_Text, int p_Width,
+                                     bool p_EmojiEnabled);
+  void Prefetch(std::vector<Job>&& p_Jobs, int p_Width, bool p_EmojiEnabled);
+  size_t GetCacheHeapSize();
+
+private:
+  typedef std::tuple<std::string, size_t, int, bool> LayoutKey; // msg id, text hash, width and emoji enabled
+
+  static LayoutKey GetKey(const std::string& p_MsgId, const std::string& p_Text, int p_Width, bool p_EmojiEnabled);
+  static std::vector<std::wstring> Layout(const std::string& p_Text, int p_Width, bool p_EmojiEnabled);
+  void Run();
+
+private:
+  std::thread m_Thread;
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  std::deque<Job> m_Jobs;
+  int m_JobsWidth = 0;
+  bool m_JobsEmojiEnabled = false;
+  LruCache<LayoutKey, std::vector<std::wstring>> m_Cache;
+  bool m_Running = true;
+};
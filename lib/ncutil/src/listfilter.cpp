@@ -0,0 +1,190 @@
+// listfilter.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "listfilter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "log.h"
+#include "strutil.h"
+#include "threadregistry.h"
+
+// lists of this size or more are filtered on a background thread, keeping the dialog responsive
+const size_t ListFilter::s_BackgroundMinKeys = 20000;
+
+ListFilter::ListFilter()
+{
+}
+
+ListFilter::~ListFilter()
+{
+  Stop();
+}
+
+void ListFilter::SetKeys(const std::vector<std::string>& p_Keys)
+{
+  Stop();
+
+  m_Keys.clear();
+  m_Keys.reserve(p_Keys.size());
+  for (const auto& key : p_Keys)
+  {
+    m_Keys.push_back(Normalize(key));
+  }
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Filter.clear();
+  m_DoneFilter.clear();
+  m_DoneCandidates.resize(m_Keys.size());
+  std::iota(m_DoneCandidates.begin(), m_DoneCandidates.end(), 0);
+  m_DoneMatches = m_DoneCandidates;
+  m_Completed = false;
+}
+
+void ListFilter::SetFilter(const std::string& p_Filter)
+{
+  const std::wstring filter = Normalize(p_Filter);
+  if (filter == m_Filter) return;
+
+  Stop();
+  m_Filter = filter;
+
+  // keys matching a longer filter are a subset of those matching its prefix
+  std::vector<size_t> candidates;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_DoneFilter == filter) return;
+
+    if (filter.compare(0, m_DoneFilter.size(), m_DoneFilter) == 0)
+    {
+      candidates = m_DoneCandidates;
+    }
+    else
+    {
+      candidates.resize(m_Keys.size());
+      std::iota(candidates.begin(), candidates.end(), 0);
+    }
+  }
+
+  const uint64_t generation = ++m_Generation;
+  if (candidates.size() >= s_BackgroundMinKeys)
+  {
+    LOG_TRACE("filter %d keys in background", (int)candidates.size());
+    m_Thread = std::thread(&ListFilter::Run, this, generation, filter, std::move(candidates));
+  }
+  else
+  {
+    Run(generation, filter, std::move(candidates));
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Completed = false;
+  }
+}
+
+std::vector<size_t> ListFilter::GetMatches()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  return m_DoneMatches;
+}
+
+// returns true once after a background filter completed
+bool ListFilter::PollCompleted()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  const bool completed = m_Completed;
+  m_Completed = false;
+  return completed;
+}
+
+void ListFilter::Stop()
+{
+  ++m_Generation;
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+void ListFilter::Run(uint64_t p_Generation, std::wstring p_Filter, std::vector<size_t> p_Candidates)
+{
+  ThreadRegistry::Register("list-filter");
+
+  static const size_t cancelCheckInterval = 1024;
+  std::vector<std::pair<Rank, size_t>> ranked;
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < p_Candidates.size(); ++i)
+  {
+    if (((i % cancelCheckInterval) == 0) && (m_Generation != p_Generation)) return;
+
+    const size_t index = p_Candidates[i];
+    const Rank rank = GetRank(m_Keys[index], p_Filter);
+    if (rank == RankNone) continue;
+
+    ranked.push_back(std::make_pair(rank, index));
+    candidates.push_back(index);
+  }
+
+  // equally ranked keys keep their original order
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const std::pair<Rank, size_t>& p_Lhs, const std::pair<Rank, size_t>& p_Rhs)
+  {
+    return p_Lhs.first < p_Rhs.first;
+  });
+
+  std::vector<size_t> matches;
+  matches.reserve(ranked.size());
+  for (const auto& rankedIndex : ranked)
+  {
+    matches.push_back(rankedIndex.second);
+  }
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_Generation != p_Generation) return;
+
+  m_DoneFilter = p_Filter;
+  m_DoneCandidates.swap(candidates);
+  m_DoneMatches.swap(matches);
+  m_Completed = true;
+}
+
+ListFilter::Rank ListFilter::GetRank(const std::wstring& p_Key, const std::wstring& p_Filter)
+{
+  if (p_Filter.empty()) return RankPrefix;
+
+  const size_t pos = p_Key.find(p_Filter);
+  if (pos == 0) return RankPrefix;
+
+  if (pos != std::wstring::npos)
+  {
+    // any later occurrence may start a word even if the first does not
+    for (size_t wordPos = pos; wordPos != std::wstring::npos; wordPos = p_Key.find(p_Filter, wordPos + 1))
+    {
+      if (!std::iswalnum(p_Key[wordPos - 1])) return RankWordStart;
+    }
+
+    return RankSubstring;
+  }
+
+  // fuzzy match requires all filter chars in order
+  size_t keyPos = 0;
+  for (const wchar_t ch : p_Filter)
+  {
+    keyPos = p_Key.find(ch, keyPos);
+    if (keyPos == std::wstring::npos) return RankNone;
+
+    ++keyPos;
+  }
+
+  return RankFuzzy;
+}
+
+std::wstring ListFilter::Normalize(const std::string& p_Str)
+{
+  std::wstring wstr = StrUtil::ToWString(p_Str);
+  StrUtil::ToLowerInPlace(wstr);
+  return wstr;
+}
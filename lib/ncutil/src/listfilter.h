@@ -0,0 +1,57 @@
+// listfilter.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// incremental ranked fuzzy filter over a fixed set of keys, used by list dialogs
+class ListFilter
+{
+public:
+  ListFilter();
+  ~ListFilter();
+
+  void SetKeys(const std::vector<std::string>& p_Keys);
+  void SetFilter(const std::string& p_Filter);
+  std::vector<size_t> GetMatches();
+  bool PollCompleted();
+
+private:
+  enum Rank
+  {
+    RankPrefix = 0,
+    RankWordStart,
+    RankSubstring,
+    RankFuzzy,
+    RankNone,
+  };
+
+  void Stop();
+  void Run(uint64_t p_Generation, std::wstring p_Filter, std::vector<size_t> p_Candidates);
+  static Rank GetRank(const std::wstring& p_Key, const std::wstring& p_Filter);
+  static std::wstring Normalize(const std::string& p_Str);
+
+private:
+  static const size_t s_BackgroundMinKeys;
+
+  std::vector<std::wstring> m_Keys; // normalized, not modified while a filter is running
+  std::wstring m_Filter; // most recently requested
+  std::thread m_Thread;
+  std::atomic<uint64_t> m_Generation{ 0 };
+
+  std::mutex m_Mutex;
+  std::wstring m_DoneFilter; // filter of below results
+  std::vector<size_t> m_DoneCandidates; // matching key indices in key order, base for narrowing
+  std::vector<size_t> m_DoneMatches; // matching key indices in rank order
+  bool m_Completed = false;
+};
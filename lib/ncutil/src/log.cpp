@@ -17,12 +17,35 @@
 #include <sys/time.h>
 
 #include "sysutil.h"
+#include "threadregistry.h"
 
 std::string Log::m_Path;
 int Log::m_VerboseLevel = 0;
 std::mutex Log::m_Mutex;
 int Log::m_LogFd = -1;
 
+std::unique_ptr<Log::Entry[]> Log::m_Queue;
+std::atomic<size_t> Log::m_EnqueuePos(0);
+size_t Log::m_DequeuePos = 0;
+std::atomic<uint64_t> Log::m_DroppedCount(0);
+std::atomic<bool> Log::m_Running(false);
+std::thread Log::m_Thread;
+std::mutex Log::m_DrainMutex;
+std::mutex Log::m_CondMutex;
+std::condition_variable Log::m_CondVar;
+
+static void WriteAll(int p_Fd, const std::string& p_Str)
+{
+  size_t pos = 0;
+  while (pos < p_Str.size())
+  {
+    ssize_t len = write(p_Fd, p_Str.data() + pos, p_Str.size() - pos);
+    if (len <= 0) break;
+
+    pos += len;
+  }
+}
+
 void Log::Init(const std::string& p_Path)
 {
   m_Path = p_Path;
@@ -31,13 +54,37 @@ void Log::Init(const std::string& p_Path)
   rename(m_Path.c_str(), archivePath.c_str());
   Dump("");
   m_LogFd = open(m_Path.c_str(), O_WRONLY | O_APPEND);
+
+  if (m_LogFd != -1)
+  {
+    m_Queue.reset(new Entry[s_QueueSize]);
+    for (size_t i = 0; i < s_QueueSize; ++i)
+    {
+      m_Queue[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    m_EnqueuePos = 0;
+    m_DequeuePos = 0;
+    m_Running = true;
+    m_Thread = std::thread(&Log::Process);
+  }
 }
 
 void Log::Cleanup()
 {
+  if (m_Thread.joinable())
+  {
+    m_Running = false;
+    m_CondVar.notify_one();
+    m_Thread.join();
+  }
+
+  Flush();
+
   if (m_LogFd != -1)
   {
     close(m_LogFd);
+    m_LogFd = -1;
   }
 }
 
@@ -94,6 +141,18 @@ void Log::Error(const char* p_Filename, int p_LineNo, const char* p_Format, ...)
 
 void Log::Dump(const char* p_Str)
 {
+  if (m_Running)
+  {
+    std::string msg(p_Str);
+    if (!Enqueue(0, NULL, 0, NULL, msg))
+    {
+      ++m_DroppedCount;
+    }
+
+    m_CondVar.notify_one();
+    return;
+  }
+
   std::unique_lock<std::mutex> lock(m_Mutex);
   if (m_Path.empty()) return;
 
@@ -105,6 +164,16 @@ void Log::Dump(const char* p_Str)
   }
 }
 
+void Log::Flush()
+{
+  // skipped if the writer is mid-drain, e.g. when called from a signal handler on the writer thread
+  std::unique_lock<std::mutex> lock(m_DrainMutex, std::try_to_lock);
+  if (lock.owns_lock())
+  {
+    Drain();
+  }
+}
+
 void Log::Callstack(void* const* p_Callstack, int p_Size, const char* p_LogMsg)
 {
   if (m_LogFd != -1)
@@ -119,22 +188,174 @@ void Log::Callstack(void* const* p_Callstack, int p_Size, const char* p_LogMsg)
 void Log::Write(const char* p_Filename, int p_LineNo, const char* p_Level,
                 const char* p_Format, va_list p_VaList)
 {
-  std::unique_lock<std::mutex> lock(m_Mutex);
   if (m_Path.empty()) return;
 
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  const int64_t timeUs = (static_cast<int64_t>(tv.tv_sec) * 1000000) + tv.tv_usec;
+
+  // only the message is formatted by the caller, timestamp and layout are done by the writer
+  std::string msg;
+  char buf[1024];
+  va_list vaList;
+  va_copy(vaList, p_VaList);
+  const int len = vsnprintf(buf, sizeof(buf), p_Format, vaList);
+  va_end(vaList);
+  if (len > 0)
+  {
+    if (static_cast<size_t>(len) < sizeof(buf))
+    {
+      msg.assign(buf, len);
+    }
+    else
+    {
+      msg.resize(len + 1);
+      vsnprintf(&msg[0], len + 1, p_Format, p_VaList);
+      msg.resize(len);
+    }
+  }
+
+  if (m_Running)
+  {
+    if (!Enqueue(timeUs, p_Filename, p_LineNo, p_Level, msg))
+    {
+      ++m_DroppedCount;
+    }
+
+    m_CondVar.notify_one();
+    return;
+  }
+
+  std::string line;
+  FormatEntry(timeUs, p_Filename, p_LineNo, p_Level, msg, line);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
   FILE* file = fopen(m_Path.c_str(), "a");
   if (file != NULL)
   {
-    char timestamp[26];
+    fwrite(line.data(), 1, line.size(), file);
+    fclose(file);
+  }
+}
+
+bool Log::Enqueue(int64_t p_TimeUs, const char* p_Filename, int p_LineNo, const char* p_Level,
+                  std::string& p_Msg)
+{
+  Entry* entry = NULL;
+  size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+  while (true)
+  {
+    entry = &m_Queue[pos & (s_QueueSize - 1)];
+    const size_t seq = entry->seq.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0)
+    {
+      if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    }
+    else if (diff < 0)
+    {
+      return false; // full
+    }
+    else
+    {
+      pos = m_EnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  entry->timeUs = p_TimeUs;
+  entry->filename = p_Filename;
+  entry->lineNo = p_LineNo;
+  entry->level = p_Level;
+  entry->msg = std::move(p_Msg);
+  entry->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool Log::HasPending()
+{
+  const Entry& entry = m_Queue[m_DequeuePos & (s_QueueSize - 1)];
+  return entry.seq.load(std::memory_order_acquire) == (m_DequeuePos + 1);
+}
+
+void Log::Drain()
+{
+  if (!m_Queue || (m_LogFd == -1)) return;
+
+  static const size_t maxBufSize = 64 * 1024;
+  std::string buf;
+  const uint64_t droppedCount = m_DroppedCount.exchange(0);
+  if (droppedCount > 0)
+  {
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm* tminfo = localtime(&tv.tv_sec);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tminfo);
-    long msec = tv.tv_usec / 1000;
-    fprintf(file, "%s.%03ld | %s | ", timestamp, msec, p_Level);
-    vfprintf(file, p_Format, p_VaList);
-    fprintf(file, "  (%s:%d)", p_Filename, p_LineNo);
-    fprintf(file, "\n");
-    fclose(file);
+    const int64_t timeUs = (static_cast<int64_t>(tv.tv_sec) * 1000000) + tv.tv_usec;
+    const std::string msg = "dropped " + std::to_string(droppedCount) + " log messages";
+    FormatEntry(timeUs, __FILENAME__, __LINE__, "WARN ", msg, buf);
   }
+
+  while (HasPending())
+  {
+    Entry& entry = m_Queue[m_DequeuePos & (s_QueueSize - 1)];
+    if (entry.level == NULL)
+    {
+      buf += entry.msg;
+    }
+    else
+    {
+      FormatEntry(entry.timeUs, entry.filename, entry.lineNo, entry.level, entry.msg, buf);
+    }
+
+    std::string().swap(entry.msg);
+    entry.seq.store(m_DequeuePos + s_QueueSize, std::memory_order_release);
+    ++m_DequeuePos;
+
+    if (buf.size() >= maxBufSize)
+    {
+      WriteAll(m_LogFd, buf);
+      buf.clear();
+    }
+  }
+
+  if (!buf.empty())
+  {
+    WriteAll(m_LogFd, buf);
+  }
+}
+
+void Log::Process()
+{
+  ThreadRegistry::Register("log");
+
+  while (m_Running)
+  {
+    {
+      // producers notify without holding the mutex, so wait is bounded to not miss a wake up
+      std::unique_lock<std::mutex> lock(m_CondMutex);
+      // *INDENT-OFF*
+      m_CondVar.wait_for(lock, std::chrono::milliseconds(100), []() { return !m_Running || HasPending(); });
+      // *INDENT-ON*
+    }
+
+    std::unique_lock<std::mutex> lock(m_DrainMutex);
+    Drain();
+  }
+}
+
+void Log::FormatEntry(int64_t p_TimeUs, const char* p_Filename, int p_LineNo, const char* p_Level,
+                      const std::string& p_Msg, std::string& p_Out)
+{
+  char timestamp[26];
+  const time_t sec = static_cast<time_t>(p_TimeUs / 1000000);
+  struct tm tminfo;
+  localtime_r(&sec, &tminfo);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tminfo);
+  const long msec = static_cast<long>((p_TimeUs % 1000000) / 1000);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%s.%03ld | %s | ", timestamp, msec, p_Level);
+  char suffix[256];
+  snprintf(suffix, sizeof(suffix), "  (%s:%d)\n", p_Filename, p_LineNo);
+  p_Out += prefix;
+  p_Out += p_Msg;
+  p_Out += suffix;
 }
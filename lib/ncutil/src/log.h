@@ -7,14 +7,26 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 #define __FILENAME__ (strrchr("/" __FILE__, '/') + 1)
 
-#define LOG_TRACE(...) Log::Trace(__FILENAME__, __LINE__, __VA_ARGS__)
-#define LOG_DEBUG(...) Log::Debug(__FILENAME__, __LINE__, __VA_ARGS__)
+// trace and debug arguments are only evaluated when the level is enabled
+#ifdef HAS_NO_TRACELOG
+#define LOG_TRACE(...) \
+  do { if (false) Log::Trace(__FILENAME__, __LINE__, __VA_ARGS__); } while (0)
+#else
+#define LOG_TRACE(...) \
+  do { if (Log::GetTraceEnabled()) Log::Trace(__FILENAME__, __LINE__, __VA_ARGS__); } while (0)
+#endif
+#define LOG_DEBUG(...) \
+  do { if (Log::GetDebugEnabled()) Log::Debug(__FILENAME__, __LINE__, __VA_ARGS__); } while (0)
 #define LOG_INFO(...) Log::Info(__FILENAME__, __LINE__, __VA_ARGS__)
 #define LOG_WARNING(...) Log::Warning(__FILENAME__, __LINE__, __VA_ARGS__)
 #define LOG_ERROR(...) Log::Error(__FILENAME__, __LINE__, __VA_ARGS__)
@@ -31,7 +43,11 @@ public:
   static void SetVerboseLevel(int p_Level);
   static inline int GetVerboseLevel() { return m_VerboseLevel; }
   static inline bool GetDebugEnabled() { return m_VerboseLevel >= DEBUG_LEVEL; }
+#ifdef HAS_NO_TRACELOG
+  static inline bool GetTraceEnabled() { return false; }
+#else
   static inline bool GetTraceEnabled() { return m_VerboseLevel >= TRACE_LEVEL; }
+#endif
 
   static void Trace(const char* p_Filename, int p_LineNo, const char* p_Format, ...);
   static void Debug(const char* p_Filename, int p_LineNo, const char* p_Format, ...);
@@ -40,15 +56,45 @@ public:
   static void Error(const char* p_Filename, int p_LineNo, const char* p_Format, ...);
 
   static void Dump(const char* p_Str);
+  static void Flush();
   static void Callstack(void* const* p_Callstack, int p_Size, const char* p_LogMsg);
 
 private:
+  struct Entry
+  {
+    std::atomic<size_t> seq;
+    int64_t timeUs;
+    const char* filename;
+    int lineNo;
+    const char* level;
+    std::string msg;
+  };
+
   static void Write(const char* p_Filename, int p_LineNo, const char* p_Level,
                     const char* p_Format, va_list p_VaList);
+  static bool Enqueue(int64_t p_TimeUs, const char* p_Filename, int p_LineNo, const char* p_Level,
+                      std::string& p_Msg);
+  static bool HasPending();
+  static void Drain();
+  static void Process();
+  static void FormatEntry(int64_t p_TimeUs, const char* p_Filename, int p_LineNo, const char* p_Level,
+                          const std::string& p_Msg, std::string& p_Out);
 
 private:
   static std::string m_Path;
   static int m_VerboseLevel;
   static std::mutex m_Mutex;
   static int m_LogFd;
+
+  // @note: bounded multi-producer ring buffer drained by a single writer thread
+  static const size_t s_QueueSize = 8192;
+  static std::unique_ptr<Entry[]> m_Queue;
+  static std::atomic<size_t> m_EnqueuePos;
+  static size_t m_DequeuePos;
+  static std::atomic<uint64_t> m_DroppedCount;
+  static std::atomic<bool> m_Running;
+  static std::thread m_Thread;
+  static std::mutex m_DrainMutex;
+  static std::mutex m_CondMutex;
+  static std::condition_variable m_CondVar;
 };
@@ -0,0 +1,129 @@
+// lrucache.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <list>
+#include <map>
+
+// size bounded least-recently-used cache, not thread-safe
+template<typename TKey, typename TValue>
+class LruCache
+{
+public:
+  explicit LruCache(size_t p_MaxSize = 0)
+    : m_MaxSize(p_MaxSize)
+  {
+  }
+
+  void SetMaxSize(size_t p_MaxSize)
+  {
+    m_MaxSize = p_MaxSize;
+    Evict();
+  }
+
+  void Put(const TKey& p_Key, const TValue& p_Value, size_t p_Size)
+  {
+    Remove(p_Key);
+    if (p_Size > m_MaxSize) return;
+
+    m_List.push_front(Entry{ p_Key, p_Value, p_Size });
+    m_Map[p_Key] = m_List.begin();
+    m_Size += p_Size;
+    Evict();
+  }
+
+  bool Get(const TKey& p_Key, TValue& p_Value)
+  {
+    auto it = m_Map.find(p_Key);
+    if (it == m_Map.end()) return false;
+
+    m_List.splice(m_List.begin(), m_List, it->second);
+    p_Value = it->second->value;
+    return true;
+  }
+
+  bool Contains(const TKey& p_Key) const
+  {
+    return m_Map.find(p_Key) != m_Map.end();
+  }
+
+  void Remove(const TKey& p_Key)
+  {
+    auto it = m_Map.find(p_Key);
+    if (it == m_Map.end()) return;
+
+    m_Size -= it->second->size;
+    m_List.erase(it->second);
+    m_Map.erase(it);
+  }
+
+  // remove all keys in range [p_First, p_Last)
+  void RemoveRange(const TKey& p_First, const TKey& p_Last)
+  {
+    auto it = m_Map.lower_bound(p_First);
+    while ((it != m_Map.end()) && (it->first < p_Last))
+    {
+      m_Size -= it->second->size;
+      m_List.erase(it->second);
+      it = m_Map.erase(it);
+    }
+  }
+
+  void Clear()
+  {
+    m_List.clear();
+    m_Map.clear();
+    m_Size = 0;
+  }
+
+  size_t GetSize() const
+  {
+    return m_Size;
+  }
+
+  // calls p_Func(key, value) for each entry, most recently used first
+  template<typename TFunc>
+  void ForEach(TFunc p_Func) const
+  {
+    for (const Entry& entry : m_List)
+    {
+      p_Func(entry.key, entry.value);
+    }
+  }
+
+  // list and map nodes, excluding heap owned by keys and values
+  size_t GetNodesHeapSize() const
+  {
+    return m_List.size() * (sizeof(Entry) + sizeof(TKey) + (7 * sizeof(void*)));
+  }
+
+private:
+  void Evict()
+  {
+    while ((m_Size > m_MaxSize) && !m_List.empty())
+    {
+      const Entry& entry = m_List.back();
+      m_Size -= entry.size;
+      m_Map.erase(entry.key);
+      m_List.pop_back();
+    }
+  }
+
+private:
+  struct Entry
+  {
+    TKey key;
+    TValue value;
+    size_t size;
+  };
+
+  std::list<Entry> m_List;
+  std::map<TKey, typename std::list<Entry>::iterator> m_Map;
+  size_t m_Size = 0;
+  size_t m_MaxSize = 0;
+};
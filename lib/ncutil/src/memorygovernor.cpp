@@ -0,0 +1,121 @@
+// memorygovernor.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "memorygovernor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "appconfig.h"
+#include "log.h"
+#include "sysutil.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+
+int64_t MemoryGovernor::m_BudgetKb = 0;
+std::atomic<bool> MemoryGovernor::m_Running(false);
+std::thread MemoryGovernor::m_Thread;
+std::mutex MemoryGovernor::m_Mutex;
+std::condition_variable MemoryGovernor::m_CondVar;
+std::mutex MemoryGovernor::m_ReclaimMutex;
+std::map<int, std::pair<std::string, MemoryGovernor::Reclaimer>> MemoryGovernor::m_Reclaimers;
+int MemoryGovernor::m_NextId = 1;
+
+// rss is sampled at check interval, and reclaim is not repeated more often than reclaim interval
+static const int64_t s_CheckIntervalMs = 10 * 1000;
+static const int64_t s_ReclaimIntervalMs = 60 * 1000;
+
+void MemoryGovernor::Init()
+{
+  m_BudgetKb = static_cast<int64_t>(std::max(AppConfig::GetNum("memory_budget_mb"), 0)) * 1024;
+  if (m_BudgetKb == 0) return;
+
+  LOG_INFO("memory budget %lld mb", (long long)(m_BudgetKb / 1024));
+  m_Running = true;
+  m_Thread = std::thread(&MemoryGovernor::Process);
+}
+
+void MemoryGovernor::Cleanup()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+    m_CondVar.notify_one();
+  }
+
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+int64_t MemoryGovernor::GetBudgetBytes()
+{
+  return m_BudgetKb * 1024;
+}
+
+int MemoryGovernor::AddReclaimer(const std::string& p_Name, const Reclaimer& p_Reclaimer)
+{
+  std::unique_lock<std::mutex> lock(m_ReclaimMutex);
+  const int id = m_NextId++;
+  m_Reclaimers[id] = std::make_pair(p_Name, p_Reclaimer);
+  return id;
+}
+
+void MemoryGovernor::RemoveReclaimer(int p_Id)
+{
+  // waits for an ongoing reclaim, so the reclaimer is not called after return
+  std::unique_lock<std::mutex> lock(m_ReclaimMutex);
+  m_Reclaimers.erase(p_Id);
+}
+
+void MemoryGovernor::Process()
+{
+  ThreadRegistry::Register("memory");
+
+  int64_t reclaimTime = 0;
+  while (m_Running)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait_for(lock, std::chrono::milliseconds(s_CheckIntervalMs));
+      if (!m_Running) break;
+    }
+
+    int threadCount = 0;
+    int64_t rssKb = 0;
+    if (!SysUtil::GetProcessStats(threadCount, rssKb)) continue;
+
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    if ((rssKb <= m_BudgetKb) || ((nowTime - reclaimTime) < s_ReclaimIntervalMs)) continue;
+
+    reclaimTime = nowTime;
+    Reclaim(rssKb);
+  }
+}
+
+void MemoryGovernor::Reclaim(int64_t p_RssKb)
+{
+  LOG_INFO("memory rss %lld mb above budget %lld mb, reclaiming", (long long)(p_RssKb / 1024),
+           (long long)(m_BudgetKb / 1024));
+
+  std::unique_lock<std::mutex> lock(m_ReclaimMutex);
+  for (const auto& reclaimer : m_Reclaimers)
+  {
+    const int64_t startTime = TimeUtil::GetCurrentTimeMSec();
+    reclaimer.second.second();
+    LOG_DEBUG("memory reclaim %s in %lld ms", reclaimer.second.first.c_str(),
+              (long long)(TimeUtil::GetCurrentTimeMSec() - startTime));
+  }
+
+  int threadCount = 0;
+  int64_t rssKb = 0;
+  if (SysUtil::GetProcessStats(threadCount, rssKb))
+  {
+    LOG_INFO("memory rss %lld mb after reclaim", (long long)(rssKb / 1024));
+  }
+}
@@ -0,0 +1,47 @@
+// memorygovernor.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// process memory budget, monitors rss and when above budget asks registered components (ui model,
+// message cache, protocols) to release memory. reclaimers are called from the governor thread.
+class MemoryGovernor
+{
+public:
+  typedef std::function<void()> Reclaimer;
+
+  static void Init();
+  static void Cleanup();
+  static int64_t GetBudgetBytes();
+
+  // @note: reclaimers must not add or remove reclaimers
+  static int AddReclaimer(const std::string& p_Name, const Reclaimer& p_Reclaimer);
+  static void RemoveReclaimer(int p_Id);
+
+private:
+  static void Process();
+  static void Reclaim(int64_t p_RssKb);
+
+private:
+  static int64_t m_BudgetKb;
+  static std::atomic<bool> m_Running;
+  static std::thread m_Thread;
+  static std::mutex m_Mutex;
+  static std::condition_variable m_CondVar;
+  static std::mutex m_ReclaimMutex;
+  static std::map<int, std::pair<std::string, Reclaimer>> m_Reclaimers;
+  static int m_NextId;
+};
@@ -0,0 +1,558 @@
+// messagearchive.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "messagearchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include "log.h"
+
+// @note: block header fields are stored in host byte order, archives are not portable between hosts
+static const uint32_t s_BlockMagic = 0x5241434e; // "NCAR"
+static const size_t s_HeaderSize = (4 * sizeof(uint32_t)) + (2 * sizeof(int64_t)) + sizeof(uint32_t);
+
+namespace
+{
+  void PutVarint(std::string& p_Buf, uint64_t p_Value)
+  {
+    while (p_Value >= 0x80)
+    {
+      p_Buf.push_back(static_cast<char>((p_Value & 0x7f) | 0x80));
+      p_Value >>= 7;
+    }
+
+    p_Buf.push_back(static_cast<char>(p_Value));
+  }
+
+  bool GetVarint(const char*& p_Pos, const char* p_End, uint64_t& p_Value)
+  {
+    p_Value = 0;
+    for (int shift = 0; (shift < 64) && (p_Pos < p_End); shift += 7)
+    {
+      const uint8_t byte = static_cast<uint8_t>(*p_Pos++);
+      p_Value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+  }
+
+  uint64_t ZigZag(int64_t p_Value)
+  {
+    return (static_cast<uint64_t>(p_Value) << 1) ^ static_cast<uint64_t>(p_Value >> 63);
+  }
+
+  int64_t UnZigZag(uint64_t p_Value)
+  {
+    return static_cast<int64_t>(p_Value >> 1) ^ -static_cast<int64_t>(p_Value & 1);
+  }
+
+  template<typename T>
+  void PutField(char*& p_Pos, const T& p_Value)
+  {
+    memcpy(p_Pos, &p_Value, sizeof(T));
+    p_Pos += sizeof(T);
+  }
+
+  template<typename T>
+  void GetField(const char*& p_Pos, T& p_Value)
+  {
+    memcpy(&p_Value, p_Pos, sizeof(T));
+    p_Pos += sizeof(T);
+  }
+}
+
+MessageArchive::MessageArchive(const std::string& p_Path)
+  : m_Path(p_Path)
+{
+}
+
+MessageArchive::~MessageArchive()
+{
+  Unmap();
+}
+
+bool MessageArchive::Append(const std::vector<ChatMessage>& p_ChatMessages, size_t& p_Offset)
+{
+  if (p_ChatMessages.empty()) return true;
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+
+  std::vector<ChatMessage> chatMessages = p_ChatMessages;
+  std::sort(chatMessages.begin(), chatMessages.end(), IsBefore);
+
+  const std::string raw = Encode(chatMessages);
+  uLongf compSize = compressBound(raw.size());
+  std::string buf(s_HeaderSize + compSize, '\0');
+  if (compress2(reinterpret_cast<Bytef*>(&buf[s_HeaderSize]), &compSize,
+                reinterpret_cast<const Bytef*>(raw.data()), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    LOG_WARNING("archive compress failed %s", m_Path.c_str());
+    return false;
+  }
+
+  buf.resize(s_HeaderSize + compSize);
+
+  Block block;
+  block.offset = m_ValidSize + s_HeaderSize;
+  block.rawSize = static_cast<uint32_t>(raw.size());
+  block.compSize = static_cast<uint32_t>(compSize);
+  block.count = static_cast<uint32_t>(chatMessages.size());
+  block.minTimeSent = chatMessages.front().timeSent;
+  block.maxTimeSent = chatMessages.back().timeSent;
+  const uint32_t crc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(&buf[s_HeaderSize]),
+                                                   compSize));
+
+  char* pos = &buf[0];
+  PutField(pos, s_BlockMagic);
+  PutField(pos, block.rawSize);
+  PutField(pos, block.compSize);
+  PutField(pos, block.count);
+  PutField(pos, block.minTimeSent);
+  PutField(pos, block.maxTimeSent);
+  PutField(pos, crc);
+
+  // a partial block left by an interrupted append is overwritten
+  int fd = open(m_Path.c_str(), O_WRONLY | O_CREAT, 0600);
+  if (fd == -1)
+  {
+    LOG_WARNING("archive open failed %s", m_Path.c_str());
+    return false;
+  }
+
+  bool rv = (ftruncate(fd, static_cast<off_t>(m_ValidSize)) == 0) &&
+    (pwrite(fd, buf.data(), buf.size(), static_cast<off_t>(m_ValidSize)) == static_cast<ssize_t>(buf.size())) &&
+    (fsync(fd) == 0);
+  close(fd);
+  if (!rv)
+  {
+    LOG_WARNING("archive write failed %s", m_Path.c_str());
+    return false;
+  }
+
+  m_ValidSize += buf.size();
+  m_Blocks.push_back(block);
+  Map();
+  p_Offset = block.offset;
+  return true;
+}
+
+void MessageArchive::GetMessagesBefore(int64_t p_TimeSent, int64_t p_Sequence, const std::string& p_Id, int p_Limit,
+                                       std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+
+  ChatMessage fromMessage;
+  fromMessage.timeSent = p_TimeSent;
+  fromMessage.sequence = p_Sequence;
+  fromMessage.id = p_Id;
+
+  // blocks are visited newest first, until remaining blocks cannot hold newer messages than those found
+  std::vector<const Block*> blocks;
+  for (const auto& block : m_Blocks)
+  {
+    if (block.minTimeSent <= p_TimeSent)
+    {
+      blocks.push_back(&block);
+    }
+  }
+
+  std::sort(blocks.begin(), blocks.end(), [](const Block* p_Lhs, const Block* p_Rhs)
+  {
+    return p_Lhs->maxTimeSent > p_Rhs->maxTimeSent;
+  });
+
+  std::vector<ChatMessage> candidates;
+  for (const Block* block : blocks)
+  {
+    if ((p_Limit > 0) && (candidates.size() >= static_cast<size_t>(p_Limit)))
+    {
+      std::nth_element(candidates.begin(), candidates.begin() + (p_Limit - 1), candidates.end(),
+                       [](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs) { return IsBefore(p_Rhs, p_Lhs); });
+      candidates.resize(p_Limit);
+      const int64_t oldestTimeSent = candidates.back().timeSent;
+      if (block->maxTimeSent < oldestTimeSent) break;
+    }
+
+    std::vector<ChatMessage> chatMessages;
+    if (!Decode(*block, chatMessages)) continue;
+
+    for (auto& chatMessage : chatMessages)
+    {
+      if (IsBefore(chatMessage, fromMessage))
+      {
+        candidates.push_back(std::move(chatMessage));
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs) { return IsBefore(p_Rhs, p_Lhs); });
+  if ((p_Limit > 0) && (candidates.size() > static_cast<size_t>(p_Limit)))
+  {
+    candidates.resize(p_Limit);
+  }
+
+  p_ChatMessages.insert(p_ChatMessages.end(), candidates.begin(), candidates.end());
+}
+
+void MessageArchive::GetBlockMessages(size_t p_Offset, const std::set<std::string>& p_Ids,
+                                      std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+
+  const Block* block = GetBlock(p_Offset);
+  std::vector<ChatMessage> chatMessages;
+  if ((block == nullptr) || !Decode(*block, chatMessages)) return;
+
+  for (auto& chatMessage : chatMessages)
+  {
+    if (p_Ids.count(chatMessage.id))
+    {
+      p_ChatMessages.push_back(std::move(chatMessage));
+    }
+  }
+}
+
+void MessageArchive::ForEachBlock(const std::function<void(size_t, const std::vector<ChatMessage>&)>& p_Func)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+
+  for (const auto& block : m_Blocks)
+  {
+    std::vector<ChatMessage> chatMessages;
+    if (!Decode(block, chatMessages)) continue;
+
+    p_Func(block.offset, chatMessages);
+  }
+}
+
+void MessageArchive::GetMessagesAfter(int64_t p_TimeSent, const std::string& p_Id, int p_Limit,
+                                      std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+
+  // ordered by (timeSent, id) as export watermarks, blocks are visited oldest first
+  auto isAfter = [](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs)
+  {
+    return std::tie(p_Lhs.timeSent, p_Lhs.id) > std::tie(p_Rhs.timeSent, p_Rhs.id);
+  };
+
+  ChatMessage fromMessage;
+  fromMessage.timeSent = p_TimeSent;
+  fromMessage.id = p_Id;
+
+  std::vector<const Block*> blocks;
+  for (const auto& block : m_Blocks)
+  {
+    if (block.maxTimeSent >= p_TimeSent)
+    {
+      blocks.push_back(&block);
+    }
+  }
+
+  std::sort(blocks.begin(), blocks.end(), [](const Block* p_Lhs, const Block* p_Rhs)
+  {
+    return p_Lhs->minTimeSent < p_Rhs->minTimeSent;
+  });
+
+  std::vector<ChatMessage> candidates;
+  for (const Block* block : blocks)
+  {
+    if ((p_Limit > 0) && (candidates.size() >= static_cast<size_t>(p_Limit)))
+    {
+      std::nth_element(candidates.begin(), candidates.begin() + (p_Limit - 1), candidates.end(),
+                       [&](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs) { return isAfter(p_Rhs, p_Lhs); });
+      candidates.resize(p_Limit);
+      const int64_t newestTimeSent = candidates.back().timeSent;
+      if (block->minTimeSent > newestTimeSent) break;
+    }
+
+    std::vector<ChatMessage> chatMessages;
+    if (!Decode(*block, chatMessages)) continue;
+
+    for (auto& chatMessage : chatMessages)
+    {
+      if (isAfter(chatMessage, fromMessage))
+      {
+        candidates.push_back(std::move(chatMessage));
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [&](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs) { return isAfter(p_Rhs, p_Lhs); });
+  if ((p_Limit > 0) && (candidates.size() > static_cast<size_t>(p_Limit)))
+  {
+    candidates.resize(p_Limit);
+  }
+
+  p_ChatMessages.insert(p_ChatMessages.end(), candidates.begin(), candidates.end());
+}
+
+bool MessageArchive::IsEmpty()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+  return m_Blocks.empty();
+}
+
+int64_t MessageArchive::GetMaxTimeSent()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Load();
+  int64_t maxTimeSent = std::numeric_limits<int64_t>::min();
+  for (const auto& block : m_Blocks)
+  {
+    maxTimeSent = std::max(maxTimeSent, block.maxTimeSent);
+  }
+
+  return maxTimeSent;
+}
+
+void MessageArchive::Remove()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Unmap();
+  unlink(m_Path.c_str());
+  m_Blocks.clear();
+  m_ValidSize = 0;
+  m_Loaded = true;
+}
+
+bool MessageArchive::IsBefore(const ChatMessage& p_Lhs, const ChatMessage& p_Rhs)
+{
+  return std::tie(p_Lhs.timeSent, p_Lhs.sequence, p_Lhs.id) < std::tie(p_Rhs.timeSent, p_Rhs.sequence, p_Rhs.id);
+}
+
+// must be called with lock held
+void MessageArchive::Load()
+{
+  if (m_Loaded) return;
+
+  m_Loaded = true;
+  Map();
+
+  size_t offset = 0;
+  while ((offset + s_HeaderSize) <= m_DataSize)
+  {
+    const char* pos = m_Data + offset;
+    uint32_t magic = 0;
+    uint32_t crc = 0;
+    Block block;
+    GetField(pos, magic);
+    GetField(pos, block.rawSize);
+    GetField(pos, block.compSize);
+    GetField(pos, block.count);
+    GetField(pos, block.minTimeSent);
+    GetField(pos, block.maxTimeSent);
+    GetField(pos, crc);
+    block.offset = offset + s_HeaderSize;
+    if ((magic != s_BlockMagic) || ((block.offset + block.compSize) > m_DataSize)) break;
+
+    if (crc32(0, reinterpret_cast<const Bytef*>(m_Data + block.offset), block.compSize) != crc) break;
+
+    m_Blocks.push_back(block);
+    offset = block.offset + block.compSize;
+  }
+
+  m_ValidSize = offset;
+  if (m_ValidSize != m_DataSize)
+  {
+    LOG_WARNING("archive %s has %d trailing bytes", m_Path.c_str(), m_DataSize - m_ValidSize);
+  }
+}
+
+// must be called with lock held
+void MessageArchive::Map()
+{
+  Unmap();
+
+  int fd = open(m_Path.c_str(), O_RDONLY);
+  if (fd == -1) return;
+
+  struct stat st;
+  if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+  {
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      m_Data = static_cast<const char*>(data);
+      m_DataSize = static_cast<size_t>(st.st_size);
+    }
+    else
+    {
+      LOG_WARNING("archive mmap failed %s", m_Path.c_str());
+    }
+  }
+
+  close(fd);
+}
+
+// must be called with lock held
+void MessageArchive::Unmap()
+{
+  m_CachedOffset = 0;
+  m_CachedMessages.clear();
+  if (m_Data != nullptr)
+  {
+    munmap(const_cast<char*>(m_Data), m_DataSize);
+    m_Data = nullptr;
+    m_DataSize = 0;
+  }
+}
+
+// must be called with lock held
+const MessageArchive::Block* MessageArchive::GetBlock(size_t p_Offset) const
+{
+  // blocks are appended, so ordered by offset
+  auto it = std::lower_bound(m_Blocks.begin(), m_Blocks.end(), p_Offset, [](const Block& p_Block, size_t p_Value)
+  {
+    return p_Block.offset < p_Value;
+  });
+
+  return ((it != m_Blocks.end()) && (it->offset == p_Offset)) ? &*it : nullptr;
+}
+
+// must be called with lock held
+bool MessageArchive::Decode(const Block& p_Block, std::vector<ChatMessage>& p_ChatMessages)
+{
+  if ((m_Data == nullptr) || ((p_Block.offset + p_Block.compSize) > m_DataSize)) return false;
+
+  // consecutive history pages are mostly served by the same block
+  if (m_CachedOffset == p_Block.offset)
+  {
+    p_ChatMessages = m_CachedMessages;
+    return true;
+  }
+
+  std::string raw(p_Block.rawSize, '\0');
+  uLongf rawSize = p_Block.rawSize;
+  if ((uncompress(reinterpret_cast<Bytef*>(&raw[0]), &rawSize,
+                  reinterpret_cast<const Bytef*>(m_Data + p_Block.offset), p_Block.compSize) != Z_OK) ||
+      (rawSize != p_Block.rawSize))
+  {
+    LOG_WARNING("archive uncompress failed %s", m_Path.c_str());
+    return false;
+  }
+
+  const char* pos = raw.data();
+  const char* end = raw.data() + raw.size();
+  std::vector<ChatMessage> chatMessages(p_Block.count);
+
+  // integer columns: delta coded timestamps, sequences and flags
+  int64_t timeSent = 0;
+  uint64_t value = 0;
+  for (auto& chatMessage : chatMessages)
+  {
+    if (!GetVarint(pos, end, value)) return false;
+
+    timeSent += UnZigZag(value);
+    chatMessage.timeSent = timeSent;
+  }
+
+  for (auto& chatMessage : chatMessages)
+  {
+    if (!GetVarint(pos, end, value)) return false;
+
+    chatMessage.sequence = UnZigZag(value);
+  }
+
+  for (auto& chatMessage : chatMessages)
+  {
+    if (!GetVarint(pos, end, value)) return false;
+
+    chatMessage.isOutgoing = (value & 0x1);
+    chatMessage.isRead = (value & 0x2);
+  }
+
+  // string columns: lengths followed by concatenated data
+  std::string ChatMessage::* columns[] =
+  {
+    &ChatMessage::id, &ChatMessage::senderId, &ChatMessage::text, &ChatMessage::quotedId,
+    &ChatMessage::quotedText, &ChatMessage::quotedSender, &ChatMessage::fileInfo,
+  };
+
+  for (auto column : columns)
+  {
+    std::vector<uint64_t> lengths(chatMessages.size());
+    for (auto& length : lengths)
+    {
+      if (!GetVarint(pos, end, length)) return false;
+    }
+
+    for (size_t i = 0; i < chatMessages.size(); ++i)
+    {
+      if (lengths[i] > static_cast<uint64_t>(end - pos)) return false;
+
+      (chatMessages[i].*column).assign(pos, lengths[i]);
+      pos += lengths[i];
+    }
+  }
+
+  m_CachedOffset = p_Block.offset;
+  m_CachedMessages = chatMessages;
+  p_ChatMessages = std::move(chatMessages);
+  return true;
+}
+
+std::string MessageArchive::Encode(const std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::string raw;
+  int64_t timeSent = 0;
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    PutVarint(raw, ZigZag(chatMessage.timeSent - timeSent));
+    timeSent = chatMessage.timeSent;
+  }
+
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    PutVarint(raw, ZigZag(chatMessage.sequence));
+  }
+
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    PutVarint(raw, (chatMessage.isOutgoing ? 0x1 : 0x0) | (chatMessage.isRead ? 0x2 : 0x0));
+  }
+
+  const std::string ChatMessage::* columns[] =
+  {
+    &ChatMessage::id, &ChatMessage::senderId, &ChatMessage::text, &ChatMessage::quotedId,
+    &ChatMessage::quotedText, &ChatMessage::quotedSender, &ChatMessage::fileInfo,
+  };
+
+  for (auto column : columns)
+  {
+    for (const auto& chatMessage : p_ChatMessages)
+    {
+      PutVarint(raw, (chatMessage.*column).size());
+    }
+
+    for (const auto& chatMessage : p_ChatMessages)
+    {
+      raw += chatMessage.*column;
+    }
+  }
+
+  return raw;
+}
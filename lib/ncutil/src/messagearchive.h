@@ -0,0 +1,70 @@
+// messagearchive.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+
+// append-only archive of cold messages of one chat. messages are stored in zlib compressed blocks,
+// each holding its messages column by column (timestamps, senders, texts, ...), and read through a
+// read-only memory mapping of the file. archived messages are immutable, blocks are located by the
+// payload offset returned on append.
+class MessageArchive
+{
+public:
+  explicit MessageArchive(const std::string& p_Path);
+  ~MessageArchive();
+
+  bool Append(const std::vector<ChatMessage>& p_ChatMessages, size_t& p_Offset);
+  void GetMessagesBefore(int64_t p_TimeSent, int64_t p_Sequence, const std::string& p_Id, int p_Limit,
+                         std::vector<ChatMessage>& p_ChatMessages);
+  void GetBlockMessages(size_t p_Offset, const std::set<std::string>& p_Ids, std::vector<ChatMessage>& p_ChatMessages);
+  void ForEachBlock(const std::function<void(size_t, const std::vector<ChatMessage>&)>& p_Func);
+  void GetMessagesAfter(int64_t p_TimeSent, const std::string& p_Id, int p_Limit,
+                        std::vector<ChatMessage>& p_ChatMessages);
+  bool IsEmpty();
+  int64_t GetMaxTimeSent();
+  void Remove();
+
+  static bool IsBefore(const ChatMessage& p_Lhs, const ChatMessage& p_Rhs);
+
+private:
+  struct Block
+  {
+    size_t offset = 0; // payload offset in file
+    uint32_t rawSize = 0;
+    uint32_t compSize = 0;
+    uint32_t count = 0;
+    int64_t minTimeSent = 0;
+    int64_t maxTimeSent = 0;
+  };
+
+  void Load();
+  void Map();
+  void Unmap();
+  const Block* GetBlock(size_t p_Offset) const;
+  bool Decode(const Block& p_Block, std::vector<ChatMessage>& p_ChatMessages);
+  static std::string Encode(const std::vector<ChatMessage>& p_ChatMessages);
+
+private:
+  std::mutex m_Mutex;
+  std::string m_Path;
+  bool m_Loaded = false;
+  std::vector<Block> m_Blocks;
+  size_t m_ValidSize = 0; // size of complete blocks, a trailing partial block is overwritten on append
+  const char* m_Data = nullptr;
+  size_t m_DataSize = 0;
+  size_t m_CachedOffset = 0; // last decoded block, 0 = none
+  std::vector<ChatMessage> m_CachedMessages;
+};
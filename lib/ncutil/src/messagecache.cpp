@@ -7,75 +7,262 @@
 
 #include "messagecache.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
 #include <fstream>
+#include <iostream>
 #include <iterator>
 #include <map>
+#include <set>
 #include <sstream>
+#include <tuple>
 #include <utility>
 
 #include <sqlite_modern_cpp.h>
 
 #include "appconfig.h"
+#include "backgroundexecutor.h"
+#include "blobstore.h"
 #include "log.h"
+#include "memorygovernor.h"
+#include "messagearchive.h"
+#include "perfstats.h"
 #include "fileutil.h"
+#include "heapsize.h"
 #include "protocolutil.h"
 #include "sqlitehelp.h"
+#include "status.h"
 #include "strutil.h"
+#include "textcompressor.h"
+#include "threadregistry.h"
 #include "timeutil.h"
+#include "trace.h"
 
 std::function<void(std::shared_ptr<ServiceMessage>)> MessageCache::m_MessageHandler;
-std::mutex MessageCache::m_DbMutex;
-std::map<std::string, std::unique_ptr<sqlite::database>> MessageCache::m_Dbs;
-std::unordered_map<std::string, std::unordered_map<std::string, bool>> MessageCache::m_InSync;
-std::unordered_map<std::string, bool> MessageCache::m_CheckSync;
-bool MessageCache::m_Running = false;
-std::thread MessageCache::m_Thread;
-std::mutex MessageCache::m_QueueMutex;
-std::condition_variable MessageCache::m_CondVar;
-std::deque<std::shared_ptr<MessageCache::Request>> MessageCache::m_Queue;
+std::mutex MessageCache::m_Mutex;
+std::map<std::string, std::shared_ptr<MessageCache::ProfileCache>> MessageCache::m_ProfileCaches;
+std::mutex MessageCache::m_MemoryMutex;
+LruCache<MessageCache::MessageKey, ChatMessage> MessageCache::m_MemoryMessages;
+LruCache<MessageCache::PageKey, std::vector<std::string>> MessageCache::m_MemoryPages;
+uint64_t MessageCache::m_MemoryGeneration = 0;
+int64_t MessageCache::m_MemoryHits = 0;
+int64_t MessageCache::m_MemoryMisses = 0;
+std::mutex MessageCache::m_AttachmentMutex;
+std::unordered_map<std::string, MessageCache::AttachmentEntry> MessageCache::m_Attachments;
+std::atomic<uint64_t> MessageCache::m_AttachmentGeneration(0);
+std::mutex MessageCache::m_ExportMutex;
+std::thread MessageCache::m_ExportThread;
+std::atomic<bool> MessageCache::m_ExportRunning(false);
+std::atomic<bool> MessageCache::m_ExportCancel(false);
 std::string MessageCache::m_HistoryDir;
 bool MessageCache::m_CacheEnabled = true;
+size_t MessageCache::m_QueueMaxSize = 0;
+bool MessageCache::m_ReadOnly = false;
+int MessageCache::m_ReclaimerId = 0;
 
 // @note: minor db schema updates can simply update table name to avoid losing other tables data
 static const std::string s_TableContacts = "contacts2";
 static const std::string s_TableChats = "chats2";
 
+// @note: max number of queued requests processed per batch, limits how long db lock is held
+static const size_t s_MaxBatchRequests = 64;
+
+// @note: queued writes are flushed at shutdown only if the worker gets to them within this time
+static const int64_t s_ShutdownFlushTimeoutMs = 2000;
+
+// @note: number of rows read per query during export, bounds memory usage regardless of chat size
+static const int s_ExportChunkSize = 1000;
+static const size_t s_InParamCount = 32; // ids per IN (...) list, short lists are padded to share one statement
+static const std::string s_ExportWatermarkFile = "export_watermark.txt";
+static const int64_t s_ExportMmapSize = 256 * 1024 * 1024; // export scans use at least this mmap size
+
+// @note: retention deletes in small batches during idle time, limits how long db lock is held
+static const int s_RetentionBatchSize = 500;
+static const int s_RetentionVacuumPages = 256;
+static const int s_RetentionStartDelayMs = 10 * 1000;
+static const int s_RetentionBatchDelayMs = 100;
+static const int s_RetentionIntervalMs = 10 * 60 * 1000;
+static const std::string s_RetentionConfigFile = "retention.conf";
+
+// @note: messages moved per archival batch, each batch becomes one compressed archive block
+static const int s_ArchiveBatchSize = 2000;
+
+// @note: deleted chats are hidden at once, their messages purged in small batches when idle
+static const int s_PurgeBatchSize = 500;
+static const int s_PurgeBatchDelayMs = 20;
+
+// @note: schema changes within existing tables are applied as migrations tracked by user_version
+static const int s_SchemaVersion = 12;
+
+// @note: texts may be stored compressed, and quoted texts as null referencing the quoted message,
+// see InsertMessage. reads expand them with these columns of messages m.
+// @note: chat keys are allocated above both live and retired keys, as messages of a deleted chat
+// keep its retired key until purged and must not be inherited by a new chat
+static const std::string s_SqlInsertChatId = "INSERT OR IGNORE INTO chatids (chatKey, id) VALUES ("
+  "MAX(COALESCE((SELECT MAX(chatKey) FROM chatids), 0), COALESCE((SELECT MAX(chatKey) FROM chatpurges), 0)) + 1, ?);";
+
+static const std::string s_SqlMessageTexts = "nc_text(m.text), m.quotedId, nc_text(COALESCE(m.quotedText, "
+  "(SELECT r.text FROM messages r WHERE r.chatKey = m.chatKey AND r.id = m.quotedId)))";
+static const size_t s_CompressTextMinSize = 64;
+
+// @note: unread counts are capped, larger counts are shown as the cap
+static const int s_UnreadCountMax = 999;
+static const int s_TextDictSamples = 5000;
+
+// @note: legacy messages are converted in batches when idle, any write to a chat converts it first
+static const int s_MigrationBatchSize = 1000;
+static const int s_MigrationBatchDelayMs = 10;
+static const std::string s_TableMessagesLegacy = "messages_legacy";
+
 void MessageCache::Init()
 {
   m_CacheEnabled = AppConfig::GetBool("cache_enabled");
 
   if (!m_CacheEnabled) return;
 
+  // @note: memory budget is shared with 1/8 for pages, which only hold message ids
+  const size_t memorySize = static_cast<size_t>(std::max(AppConfig::GetNum("cache_memory_size_kb"), 0)) * 1024;
+  {
+    std::unique_lock<std::mutex> lock(m_MemoryMutex);
+    m_MemoryMessages.SetMaxSize(memorySize - (memorySize / 8));
+    m_MemoryPages.SetMaxSize(memorySize / 8);
+  }
+
+  m_QueueMaxSize = static_cast<size_t>(std::max(AppConfig::GetNum("cache_queue_max_size_mb"), 0)) * 1024 * 1024;
+
   static const int dirVersion = 6;
   m_HistoryDir = FileUtil::GetApplicationDir() + "/history";
   FileUtil::InitDirVersion(m_HistoryDir, dirVersion);
+  m_ReclaimerId = MemoryGovernor::AddReclaimer("message cache", &MessageCache::ReleaseMemory);
+}
 
-  std::unique_lock<std::mutex> lock(m_QueueMutex);
-  if (!m_Running)
-  {
-    m_Running = true;
-    m_Thread = std::thread(MessageCache::Process);
-  }
+void MessageCache::SetReadOnly(bool p_ReadOnly)
+{
+  // offline mode, must be set before profiles are added. caches are opened as left by their
+  // protocol, writes are dropped and retention is not performed. schema upgrades still apply.
+  m_ReadOnly = p_ReadOnly;
 }
 
 void MessageCache::Cleanup()
 {
   if (!m_CacheEnabled) return;
 
-  if (m_Running)
+  MemoryGovernor::RemoveReclaimer(m_ReclaimerId);
+
+  {
+    // abort in-app export at next chunk, its output is resumable by next incremental export
+    std::unique_lock<std::mutex> lock(m_ExportMutex);
+    m_ExportCancel = true;
+    if (m_ExportThread.joinable())
+    {
+      m_ExportThread.join();
+    }
+
+    m_ExportCancel = false;
+  }
+
+  std::map<std::string, std::shared_ptr<ProfileCache>> profileCaches;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    std::swap(profileCaches, m_ProfileCaches);
+  }
+
+  // stop all workers before joining, so their final flushes run in parallel
+  const int64_t stopTime = TimeUtil::GetCurrentTimeMSec();
+  for (auto& profileCache : profileCaches)
+  {
+    std::shared_ptr<ProfileCache> cache = profileCache.second;
+    std::unique_lock<std::mutex> lock(cache->queueMutex);
+    cache->running = false;
+    cache->stopTime = stopTime;
+    cache->condVar.notify_one();
+    cache->queueSpaceCondVar.notify_all();
+  }
+
+  for (auto& profileCache : profileCaches)
   {
+    std::shared_ptr<ProfileCache> cache = profileCache.second;
+    if (cache->thread.joinable())
     {
-      std::unique_lock<std::mutex> lock(m_QueueMutex);
-      m_Running = false;
-      m_CondVar.notify_one();
+      cache->thread.join();
     }
-    m_Thread.join();
+
+    {
+      std::unique_lock<std::mutex> lock(cache->readDbMutex);
+      ClearStatements(cache->readStmts);
+      cache->readDb.reset();
+    }
+
+    std::unique_lock<std::mutex> lock(cache->dbMutex);
+    ClearStatements(cache->stmts);
+    cache->db.reset();
+  }
+
+  LOG_INFO("cache stopped %d profiles in %d ms", profileCaches.size(), TimeUtil::GetCurrentTimeMSec() - stopTime);
+
+  {
+    std::unique_lock<std::mutex> lock(m_MemoryMutex);
+    LOG_INFO("cache memory hits %d misses %d", m_MemoryHits, m_MemoryMisses);
+    m_MemoryMessages.Clear();
+    m_MemoryPages.Clear();
   }
 
   {
-    std::unique_lock<std::mutex> lock(m_DbMutex);
+    std::unique_lock<std::mutex> lock(m_AttachmentMutex);
+    m_Attachments.clear();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
     m_MessageHandler = nullptr;
-    m_Dbs.clear();
+  }
+}
+
+void MessageCache::ReleaseMemory()
+{
+  if (!m_CacheEnabled) return;
+
+  // recently fetched messages are read from db again when needed
+  {
+    std::unique_lock<std::mutex> lock(m_MemoryMutex);
+    m_MemoryMessages.Clear();
+    m_MemoryPages.Clear();
+  }
+
+  std::vector<std::shared_ptr<ProfileCache>> caches;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (const auto& profileCache : m_ProfileCaches)
+    {
+      caches.push_back(profileCache.second);
+    }
+  }
+
+  for (const auto& cache : caches)
+  {
+    try
+    {
+      {
+        std::unique_lock<std::mutex> lock(cache->dbMutex);
+        if (cache->db)
+        {
+          *cache->db << "PRAGMA shrink_memory;";
+        }
+      }
+
+      std::unique_lock<std::mutex> lock(cache->readDbMutex);
+      if (cache->readDb)
+      {
+        *cache->readDb << "PRAGMA shrink_memory;";
+      }
+    }
+    catch (const sqlite::sqlite_exception& ex)
+    {
+      HANDLE_SQLITE_EXCEPTION(ex);
+    }
   }
 }
 
@@ -83,7 +270,7 @@ void MessageCache::SetMessageHandler(const std::function<void(std::shared_ptr<Se
 {
   if (!m_CacheEnabled) return;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
+  std::unique_lock<std::mutex> lock(m_Mutex);
   m_MessageHandler = p_MessageHandler;
 }
 
@@ -94,17 +281,15 @@ void MessageCache::AddFromServiceMessage(const std::string& p_ProfileId,
   {
     case NewChatsNotifyType:
       {
-        std::shared_ptr<NewChatsNotify> newChatsNotify =
-          std::static_pointer_cast<NewChatsNotify>(p_ServiceMessage);
-        MessageCache::AddChats(p_ProfileId, newChatsNotify->chatInfos);
+        const NewChatsNotify& newChatsNotify = static_cast<const NewChatsNotify&>(*p_ServiceMessage);
+        MessageCache::AddChats(p_ProfileId, newChatsNotify.chatInfos);
       }
       break;
 
     case NewContactsNotifyType:
       {
-        std::shared_ptr<NewContactsNotify> newContactsNotify =
-          std::static_pointer_cast<NewContactsNotify>(p_ServiceMessage);
-        MessageCache::AddContacts(p_ProfileId, newContactsNotify->contactInfos);
+        const NewContactsNotify& newContactsNotify = static_cast<const NewContactsNotify&>(*p_ServiceMessage);
+        MessageCache::AddContacts(p_ProfileId, newContactsNotify.contactInfos);
       }
       break;
 
@@ -115,68 +300,115 @@ void MessageCache::AddFromServiceMessage(const std::string& p_ProfileId,
         if (newMessagesNotify->success && !newMessagesNotify->cached &&
             newMessagesNotify->sequence)
         {
+          // share the notify messages, which are only read by the ui and the cache from here on
+          std::shared_ptr<const std::vector<ChatMessage>> chatMessages(newMessagesNotify,
+                                                                       &newMessagesNotify->chatMessages);
           MessageCache::AddMessages(p_ProfileId, newMessagesNotify->chatId,
-                                    newMessagesNotify->fromMsgId, newMessagesNotify->chatMessages);
+                                    newMessagesNotify->fromMsgId, chatMessages);
         }
       }
       break;
 
     case MarkMessageReadNotifyType:
       {
-        std::shared_ptr<MarkMessageReadNotify> markMessageReadNotify =
-          std::static_pointer_cast<MarkMessageReadNotify>(p_ServiceMessage);
-        MessageCache::UpdateMessageIsRead(p_ProfileId, markMessageReadNotify->chatId,
-                                          markMessageReadNotify->msgId, true);
+        const MarkMessageReadNotify& markMessageReadNotify =
+          static_cast<const MarkMessageReadNotify&>(*p_ServiceMessage);
+        MessageCache::UpdateMessageIsRead(p_ProfileId, markMessageReadNotify.chatId,
+                                          markMessageReadNotify.msgId, true);
+      }
+      break;
+
+    case MarkMessagesReadNotifyType:
+      {
+        const MarkMessagesReadNotify& markMessagesReadNotify =
+          static_cast<const MarkMessagesReadNotify&>(*p_ServiceMessage);
+        MessageCache::UpdateMessagesIsRead(p_ProfileId, markMessagesReadNotify.chatId,
+                                           markMessagesReadNotify.msgId, false /*p_IsOutgoing*/);
+      }
+      break;
+
+    case ReadOutboxNotifyType:
+      {
+        const ReadOutboxNotify& readOutboxNotify = static_cast<const ReadOutboxNotify&>(*p_ServiceMessage);
+        MessageCache::UpdateMessagesIsRead(p_ProfileId, readOutboxNotify.chatId, readOutboxNotify.msgId,
+                                           true /*p_IsOutgoing*/);
       }
       break;
 
     case DeleteMessageNotifyType:
       {
-        std::shared_ptr<DeleteMessageNotify> deleteMessageNotify =
-          std::static_pointer_cast<DeleteMessageNotify>(p_ServiceMessage);
-        if (deleteMessageNotify->success)
+        const DeleteMessageNotify& deleteMessageNotify = static_cast<const DeleteMessageNotify&>(*p_ServiceMessage);
+        if (deleteMessageNotify.success)
+        {
+          MessageCache::DeleteOneMessage(p_ProfileId, deleteMessageNotify.chatId, deleteMessageNotify.msgId);
+        }
+      }
+      break;
+
+    case DeleteMessagesNotifyType:
+      {
+        const DeleteMessagesNotify& deleteMessagesNotify =
+          static_cast<const DeleteMessagesNotify&>(*p_ServiceMessage);
+        if (deleteMessagesNotify.success)
         {
-          MessageCache::DeleteOneMessage(p_ProfileId, deleteMessageNotify->chatId, deleteMessageNotify->msgId);
+          for (const auto& msgId : deleteMessagesNotify.msgIds)
+          {
+            MessageCache::DeleteOneMessage(p_ProfileId, deleteMessagesNotify.chatId, msgId);
+          }
         }
       }
       break;
 
     case DeleteChatNotifyType:
       {
-        std::shared_ptr<DeleteChatNotify> deleteChatNotify =
-          std::static_pointer_cast<DeleteChatNotify>(p_ServiceMessage);
-        if (deleteChatNotify->success)
+        const DeleteChatNotify& deleteChatNotify = static_cast<const DeleteChatNotify&>(*p_ServiceMessage);
+        if (deleteChatNotify.success)
         {
-          MessageCache::DeleteChat(p_ProfileId, deleteChatNotify->chatId);
+          MessageCache::DeleteChat(p_ProfileId, deleteChatNotify.chatId);
         }
       }
       break;
 
     case NewMessageStatusNotifyType:
       {
-        std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
-          std::static_pointer_cast<NewMessageStatusNotify>(p_ServiceMessage);
-        MessageCache::UpdateMessageIsRead(p_ProfileId, newMessageStatusNotify->chatId,
-                                          newMessageStatusNotify->msgId, newMessageStatusNotify->isRead);
+        const NewMessageStatusNotify& newMessageStatusNotify =
+          static_cast<const NewMessageStatusNotify&>(*p_ServiceMessage);
+        MessageCache::UpdateMessageIsRead(p_ProfileId, newMessageStatusNotify.chatId,
+                                          newMessageStatusNotify.msgId, newMessageStatusNotify.isRead);
       }
       break;
 
     case NewMessageFileNotifyType:
       {
-        std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
-          std::static_pointer_cast<NewMessageFileNotify>(p_ServiceMessage);
-        MessageCache::UpdateMessageFileInfo(p_ProfileId, newMessageFileNotify->chatId,
-                                            newMessageFileNotify->msgId, newMessageFileNotify->fileInfo);
+        const NewMessageFileNotify& newMessageFileNotify = static_cast<const NewMessageFileNotify&>(*p_ServiceMessage);
+        MessageCache::UpdateMessageFileInfo(p_ProfileId, newMessageFileNotify.chatId,
+                                            newMessageFileNotify.msgId, newMessageFileNotify.fileInfo);
+        const FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(newMessageFileNotify.fileInfo);
+        if ((fileInfo.fileStatus == FileStatusDownloaded) && !fileInfo.filePath.empty() &&
+            (fileInfo.filePath.at(0) == '/'))
+        {
+          MessageCache::AddAttachment(p_ProfileId, newMessageFileNotify.chatId, fileInfo.filePath);
+        }
       }
       break;
 
     case UpdateMuteNotifyType:
       {
-        std::shared_ptr<UpdateMuteNotify> updateMuteNotify = std::static_pointer_cast<UpdateMuteNotify>(
-          p_ServiceMessage);
-        if (updateMuteNotify->success)
+        const UpdateMuteNotify& updateMuteNotify = static_cast<const UpdateMuteNotify&>(*p_ServiceMessage);
+        if (updateMuteNotify.success)
+        {
+          MessageCache::UpdateMute(p_ProfileId, updateMuteNotify.chatId, updateMuteNotify.isMuted);
+        }
+      }
+      break;
+
+    case SearchMessagesNotifyType:
+      {
+        const SearchMessagesNotify& searchMessagesNotify =
+          static_cast<const SearchMessagesNotify&>(*p_ServiceMessage);
+        if (searchMessagesNotify.success && searchMessagesNotify.isServer)
         {
-          MessageCache::UpdateMute(p_ProfileId, updateMuteNotify->chatId, updateMuteNotify->isMuted);
+          MessageCache::AddFoundMessages(p_ProfileId, searchMessagesNotify.chatMessages);
         }
       }
       break;
@@ -190,53 +422,64 @@ void MessageCache::AddProfile(const std::string& p_ProfileId, bool p_CheckSync,
 {
   if (!m_CacheEnabled) return;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
-  if (m_Dbs.count(p_ProfileId) > 0)
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_ProfileCaches.count(p_ProfileId) > 0)
   {
     LOG_WARNING("profile %s already added", p_ProfileId.c_str());
     return;
   }
 
-  m_CheckSync[p_ProfileId] = p_CheckSync;
+  std::shared_ptr<ProfileCache> cache = std::make_shared<ProfileCache>();
+  cache->profileId = p_ProfileId;
+  cache->checkSync = p_CheckSync;
+  LoadRetentionPolicies(*cache);
 
   const std::string& dbDir = m_HistoryDir + "/" + p_ProfileId;
-  if (p_IsSetup)
+  if (p_IsSetup && !m_ReadOnly)
   {
     FileUtil::RmDir(dbDir);
   }
 
   // @todo: remove MkDir once WmChat::s_CacheDirVersion is bumped from 0, as InitDirVersion will create it
   FileUtil::MkDir(dbDir);
-  FileUtil::InitDirVersion(dbDir, p_DirVersion);
+  if (!m_ReadOnly)
+  {
+    FileUtil::InitDirVersion(dbDir, p_DirVersion);
+  }
 
   const std::string& dbPath = dbDir + "/db.sqlite";
-  m_Dbs[p_ProfileId].reset(new sqlite::database(dbPath));
-  if (!m_Dbs[p_ProfileId]) return;
+  cache->dbPath = dbPath;
+  cache->archiveDir = dbDir + "/archive";
+  cache->textCompressor = std::make_shared<TextCompressor>();
+  static const bool compressText = AppConfig::GetBool("cache_compress_text");
+  cache->compressText = compressText;
+  cache->db.reset(new sqlite::database(dbPath));
+  if (!cache->db) return;
+
+  cache->textCompressor->Register(*cache->db);
 
   try
   {
-    *m_Dbs[p_ProfileId] << "PRAGMA synchronous = OFF";
-    *m_Dbs[p_ProfileId] << "PRAGMA journal_mode = MEMORY";
+    static const bool walEnabled = AppConfig::GetBool("cache_wal_enabled");
+    static const int mmapSize = AppConfig::GetNum("cache_mmap_size");
+    if (walEnabled)
+    {
+      static const int walAutoCheckpoint = AppConfig::GetNum("cache_wal_autocheckpoint");
+      *cache->db << "PRAGMA journal_mode = WAL";
+      *cache->db << "PRAGMA synchronous = NORMAL";
+      *cache->db << "PRAGMA wal_autocheckpoint = " + std::to_string(walAutoCheckpoint);
+    }
+    else
+    {
+      *cache->db << "PRAGMA synchronous = OFF";
+      *cache->db << "PRAGMA journal_mode = MEMORY";
+    }
 
-    // create table if not exists
-    *m_Dbs[p_ProfileId] << "CREATE TABLE IF NOT EXISTS messages ("
-      "chatId TEXT,"
-      "id TEXT,"
-      "senderId TEXT,"
-      "text TEXT,"
-      "quotedId TEXT,"
-      "quotedText TEXT,"
-      "quotedSender TEXT,"
-      "fileInfo TEXT,"
-      "fileStatus INT,"
-      "fileType TEXT,"
-      "timeSent INT,"
-      "isOutgoing INT,"
-      "isRead INT,"
-      "UNIQUE(chatId, id) ON CONFLICT REPLACE"
-      ");";
+    *cache->db << "PRAGMA mmap_size = " + std::to_string(mmapSize);
+    *cache->db << "PRAGMA auto_vacuum = INCREMENTAL"; // only effective for new db, see PerformRetention
 
-    *m_Dbs[p_ProfileId] << "CREATE TABLE IF NOT EXISTS " + s_TableContacts + " ("
+    // create table if not exists, messages tables are created by schema migration
+    *cache->db << "CREATE TABLE IF NOT EXISTS " + s_TableContacts + " ("
       "id TEXT,"
       "name TEXT,"
       "phone TEXT,"
@@ -244,18 +487,52 @@ void MessageCache::AddProfile(const std::string& p_ProfileId, bool p_CheckSync,
       "UNIQUE(id) ON CONFLICT REPLACE"
       ");";
 
-    *m_Dbs[p_ProfileId] << "CREATE TABLE IF NOT EXISTS " + s_TableChats + " ("
+    *cache->db << "CREATE TABLE IF NOT EXISTS " + s_TableChats + " ("
       "id TEXT,"
       "isMuted INT,"
       "UNIQUE(id) ON CONFLICT REPLACE"
       ");";
 
-    // @todo: create index (id, timeSent, chatId)
+    MigrateSchema(*cache);
+    LoadLegacyChats(*cache);
+    LoadAttachments(*cache);
+    LoadSyncWatermarks(*cache);
+    LoadTextDictionaries(*cache);
+
+    int hasSearch = 0;
+    *cache->db << "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+      "name = 'messages_fts');" >> hasSearch;
+    cache->hasSearch = hasSearch;
+
+    int hasPurges = 0;
+    *cache->db << "SELECT EXISTS (SELECT 1 FROM chatpurges);" >> hasPurges;
+    cache->purgePending = hasPurges && !m_ReadOnly;
+
+    // wal allows synchronous fetches to read concurrently with the writer thread
+    if (walEnabled)
+    {
+      sqlite::sqlite_config readConfig;
+      readConfig.flags = sqlite::OpenFlags::READONLY;
+      cache->readDb.reset(new sqlite::database(dbPath, readConfig));
+      cache->textCompressor->Register(*cache->readDb);
+      *cache->readDb << "PRAGMA mmap_size = " + std::to_string(mmapSize);
+    }
   }
   catch (const sqlite::sqlite_exception& ex)
   {
     HANDLE_SQLITE_EXCEPTION(ex);
   }
+
+  cache->running = true;
+  cache->thread = std::thread(MessageCache::Process, cache);
+  m_ProfileCaches[p_ProfileId] = cache;
+}
+
+bool MessageCache::HasProfile(const std::string& p_ProfileId)
+{
+  if (!m_CacheEnabled) return false;
+
+  return GetProfileCache(p_ProfileId) != nullptr;
 }
 
 void MessageCache::AddMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
@@ -264,12 +541,38 @@ void MessageCache::AddMessages(const std::string& p_ProfileId, const std::string
 {
   if (!m_CacheEnabled) return;
 
+  AddMessages(p_ProfileId, p_ChatId, p_FromMsgId, std::make_shared<const std::vector<ChatMessage>>(p_ChatMessages));
+}
+
+void MessageCache::AddMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                               const std::string& p_FromMsgId,
+                               std::shared_ptr<const std::vector<ChatMessage>> p_ChatMessages)
+{
+  if (!m_CacheEnabled) return;
+
+  const size_t count = p_ChatMessages->size();
   std::shared_ptr<AddMessagesRequest> addMessagesRequest = std::make_shared<AddMessagesRequest>();
   addMessagesRequest->profileId = p_ProfileId;
   addMessagesRequest->chatId = p_ChatId;
   addMessagesRequest->fromMsgId = p_FromMsgId;
-  addMessagesRequest->chatMessages = p_ChatMessages;
+  addMessagesRequest->chatMessageBatches.push_back(std::move(p_ChatMessages));
   EnqueueRequest(addMessagesRequest);
+  PerfStats::Add(PerfStats::StatCacheInserts, count);
+  PerfStats::AddProfileMessages(p_ProfileId, count);
+}
+
+void MessageCache::AddFoundMessages(const std::string& p_ProfileId,
+                                    const std::vector<std::pair<std::string, ChatMessage>>& p_ChatMessages)
+{
+  if (!m_CacheEnabled) return;
+
+  // server search results are scattered over history, so only kept in memory, as the db holds
+  // contiguous ranges. this still lets opening a found message be served by FetchOneMessage.
+  const uint64_t generation = GetMemoryGeneration();
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    PutMemoryMessages(p_ProfileId, chatMessage.first, { chatMessage.second }, generation);
+  }
 }
 
 void MessageCache::AddChats(const std::string& p_ProfileId, const std::vector<ChatInfo>& p_ChatInfos)
@@ -297,10 +600,7 @@ bool MessageCache::FetchChats(const std::string& p_ProfileId, const std::unorder
 {
   if (!m_CacheEnabled) return false;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
-  if (!m_Dbs[p_ProfileId]) return false;
-
-  lock.unlock();
+  if (!GetProfileCache(p_ProfileId)) return false;
 
   std::shared_ptr<FetchChatsRequest> fetchChatsRequest = std::make_shared<FetchChatsRequest>();
   fetchChatsRequest->profileId = p_ProfileId;
@@ -315,10 +615,7 @@ bool MessageCache::FetchContacts(const std::string& p_ProfileId)
 {
   if (!m_CacheEnabled) return false;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
-  if (!m_Dbs[p_ProfileId]) return false;
-
-  lock.unlock();
+  if (!GetProfileCache(p_ProfileId)) return false;
 
   std::shared_ptr<FetchContactsRequest> fetchContactsRequest =
     std::make_shared<FetchContactsRequest>();
@@ -329,55 +626,74 @@ bool MessageCache::FetchContacts(const std::string& p_ProfileId)
   return true;
 }
 
+bool MessageCache::FetchSnapshot(const std::string& p_ProfileId, const int p_ChatLimit, const int p_MessageLimit)
+{
+  if (!m_CacheEnabled) return false;
+
+  if (!GetProfileCache(p_ProfileId)) return false;
+
+  FetchContacts(p_ProfileId);
+
+  std::shared_ptr<FetchChatsRequest> fetchChatsRequest = std::make_shared<FetchChatsRequest>();
+  fetchChatsRequest->profileId = p_ProfileId;
+  fetchChatsRequest->snapshotChats = p_ChatLimit;
+  fetchChatsRequest->snapshotMessages = p_MessageLimit;
+
+  LOG_DEBUG("cache sync fetch snapshot");
+  PerformRequest(fetchChatsRequest);
+  return true;
+}
+
 bool MessageCache::FetchMessagesFrom(const std::string& p_ProfileId, const std::string& p_ChatId,
                                      const std::string& p_FromMsgId, const int p_Limit,
                                      const bool p_Sync)
 {
   if (!m_CacheEnabled) return false;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
-  if (!m_Dbs[p_ProfileId]) return false;
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
 
-  if (m_CheckSync[p_ProfileId] && !m_InSync[p_ProfileId][p_ChatId]) return false;
+  PerfStats::Add(PerfStats::StatCacheFetches, 1);
+  if (!IsInSync(*cache, p_ChatId) && !IsBeforeSyncWatermark(*cache, p_ChatId, p_FromMsgId)) return false;
 
-  int count = 0;
+  // messages of the chat still queued are newer than any cached. the fetch is then performed async,
+  // as the worker commits queued writes before performing later reads.
+  const bool hasWrites = p_FromMsgId.empty() && HasChatWrites(*cache, p_ChatId);
 
-  try
+  // page held in memory is known to be non-empty, probe db otherwise
+  bool hasMessages = hasWrites || HasMemoryPage(p_ProfileId, p_ChatId, p_FromMsgId, p_Limit);
+  if (!hasMessages)
   {
+    // anchor and older messages are also looked up in the archive index, merged in by MergeArchivedMessages
     int64_t fromMsgIdTimeSent = 0;
-    if (!p_FromMsgId.empty())
+    int64_t fromMsgIdSequence = 0;
+    std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+    try
     {
+      GetFromMsgIdKey(*cache, p_ChatId, p_FromMsgId, fromMsgIdTimeSent, fromMsgIdSequence);
+
+      static const std::string sqlBefore = "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND "
+        "(timeSent < ? OR (timeSent = ? AND (sequence < ? OR (sequence = ? AND id < ?))))";
       // *INDENT-OFF*
-      *m_Dbs[p_ProfileId] << "SELECT timeSent FROM messages WHERE chatId = ? AND id = ?;"
-                          << p_ChatId << p_FromMsgId >>
-        [&](const int64_t& timeSent)
+      GetReadStatement(*cache, "SELECT EXISTS (SELECT 1 FROM messages WHERE " + sqlBefore + ") OR "
+                       "EXISTS (SELECT 1 FROM archiveids WHERE " + sqlBefore + " AND removed = 0);")
+                          << p_ChatId << fromMsgIdTimeSent << fromMsgIdTimeSent << fromMsgIdSequence
+                          << fromMsgIdSequence << p_FromMsgId
+                          << p_ChatId << fromMsgIdTimeSent << fromMsgIdTimeSent << fromMsgIdSequence
+                          << fromMsgIdSequence << p_FromMsgId >>
+        [&](const int& existsRes)
         {
-          fromMsgIdTimeSent = timeSent;
+          hasMessages = existsRes;
         };
       // *INDENT-ON*
     }
-    else
+    catch (const sqlite::sqlite_exception& ex)
     {
-      fromMsgIdTimeSent = std::numeric_limits<int64_t>::max();
+      HANDLE_SQLITE_EXCEPTION(ex);
     }
-
-    // *INDENT-OFF*
-    *m_Dbs[p_ProfileId] << "SELECT COUNT(*) FROM messages WHERE chatId = ? AND timeSent < ?;"
-                        << p_ChatId << fromMsgIdTimeSent >>
-      [&](const int& countRes)
-      {
-        count = countRes;
-      };
-    // *INDENT-ON*
-  }
-  catch (const sqlite::sqlite_exception& ex)
-  {
-    HANDLE_SQLITE_EXCEPTION(ex);
   }
 
-  lock.unlock();
-
-  if (count > 0)
+  if (hasMessages)
   {
     std::shared_ptr<FetchMessagesFromRequest> fetchFromRequest =
       std::make_shared<FetchMessagesFromRequest>();
@@ -386,16 +702,14 @@ bool MessageCache::FetchMessagesFrom(const std::string& p_ProfileId, const std::
     fetchFromRequest->fromMsgId = p_FromMsgId;
     fetchFromRequest->limit = p_Limit;
 
-    if (p_Sync)
+    if (p_Sync && !hasWrites)
     {
-      LOG_DEBUG("cache sync fetch %s %s count %d", p_ChatId.c_str(),
-                p_FromMsgId.c_str(), count);
+      LOG_DEBUG("cache sync fetch %s %s", p_ChatId.c_str(), p_FromMsgId.c_str());
       PerformRequest(fetchFromRequest);
     }
     else
     {
-      LOG_DEBUG("cache async fetch %s %s count %d", p_ChatId.c_str(),
-                p_FromMsgId.c_str(), count);
+      LOG_DEBUG("cache async fetch %s %s", p_ChatId.c_str(), p_FromMsgId.c_str());
       EnqueueRequest(fetchFromRequest);
     }
 
@@ -403,41 +717,106 @@ bool MessageCache::FetchMessagesFrom(const std::string& p_ProfileId, const std::
   }
   else
   {
-    LOG_DEBUG("cache cannot fetch %s %s count %d", p_ChatId.c_str(),
-              p_FromMsgId.c_str(), count);
+    LOG_DEBUG("cache cannot fetch %s %s", p_ChatId.c_str(), p_FromMsgId.c_str());
     return false;
   }
 }
 
-bool MessageCache::FetchOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                   const std::string& p_MsgId, const bool p_Sync)
+bool MessageCache::FetchLatestForChats(const std::string& p_ProfileId, const std::vector<std::string>& p_ChatIds,
+                                       const int p_PerChatLimit, const bool p_Sync)
 {
   if (!m_CacheEnabled) return false;
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
-  if (!m_Dbs[p_ProfileId]) return false;
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
 
-  bool inSync = (!m_CheckSync[p_ProfileId] || m_InSync[p_ProfileId][p_ChatId]);
-  LOG_TRACE("get cached message %d %d in %s", inSync, p_MsgId.c_str(), p_ChatId.c_str());
+  std::shared_ptr<FetchLatestForChatsRequest> fetchLatestRequest = std::make_shared<FetchLatestForChatsRequest>();
+  fetchLatestRequest->profileId = p_ProfileId;
+  fetchLatestRequest->limit = p_PerChatLimit;
+  for (const auto& chatId : p_ChatIds)
+  {
+    PerfStats::Add(PerfStats::StatCacheFetches, 1);
+    if (IsInSync(*cache, chatId))
+    {
+      fetchLatestRequest->chatIds.push_back(chatId);
+    }
+  }
 
-  int count = 0;
-  try
+  if (fetchLatestRequest->chatIds.empty() || (p_PerChatLimit <= 0)) return false;
+
+  if (p_Sync)
   {
-    // *INDENT-OFF*
-    *m_Dbs[p_ProfileId] << "SELECT COUNT(*) FROM messages WHERE chatId = ? AND id = ?;"
-                        << p_ChatId << p_MsgId >>
-      [&](const int& countRes)
+    // chats with queued writes are fetched async, performed after the writes are committed
+    std::shared_ptr<FetchLatestForChatsRequest> asyncLatestRequest = std::make_shared<FetchLatestForChatsRequest>();
+    asyncLatestRequest->profileId = p_ProfileId;
+    asyncLatestRequest->limit = p_PerChatLimit;
+    std::vector<std::string> syncChatIds;
+    for (const auto& chatId : fetchLatestRequest->chatIds)
+    {
+      if (HasChatWrites(*cache, chatId))
       {
-        count = countRes;
-      };
-    // *INDENT-ON*
+        asyncLatestRequest->chatIds.push_back(chatId);
+      }
+      else
+      {
+        syncChatIds.push_back(chatId);
+      }
+    }
+
+    fetchLatestRequest->chatIds.swap(syncChatIds);
+    if (!asyncLatestRequest->chatIds.empty())
+    {
+      LOG_DEBUG("cache async fetch latest %d chats", asyncLatestRequest->chatIds.size());
+      EnqueueRequest(asyncLatestRequest);
+    }
+
+    if (!fetchLatestRequest->chatIds.empty())
+    {
+      LOG_DEBUG("cache sync fetch latest %d chats", fetchLatestRequest->chatIds.size());
+      PerformRequest(fetchLatestRequest);
+    }
   }
-  catch (const sqlite::sqlite_exception& ex)
+  else
   {
-    HANDLE_SQLITE_EXCEPTION(ex);
+    LOG_DEBUG("cache async fetch latest %d chats", fetchLatestRequest->chatIds.size());
+    EnqueueRequest(fetchLatestRequest);
   }
 
-  lock.unlock();
+  return true;
+}
+
+bool MessageCache::FetchOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                   const std::string& p_MsgId, const bool p_Sync)
+{
+  if (!m_CacheEnabled) return false;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
+
+  bool inSync = IsInSync(*cache, p_ChatId);
+  LOG_TRACE("get cached message %d %d in %s", inSync, p_MsgId.c_str(), p_ChatId.c_str());
+
+  int count = HasMemoryMessage(p_ProfileId, p_ChatId, p_MsgId) ? 1 : 0;
+  if (count == 0)
+  {
+    std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+    try
+    {
+      // *INDENT-OFF*
+      GetReadStatement(*cache, "SELECT COUNT(*) FROM messages WHERE "
+                       "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;")
+                          << p_ChatId << p_MsgId >>
+        [&](const int& countRes)
+        {
+          count = countRes;
+        };
+      // *INDENT-ON*
+    }
+    catch (const sqlite::sqlite_exception& ex)
+    {
+      HANDLE_SQLITE_EXCEPTION(ex);
+    }
+  }
 
   if (count > 0)
   {
@@ -466,26 +845,126 @@ bool MessageCache::FetchOneMessage(const std::string& p_ProfileId, const std::st
   }
 }
 
-void MessageCache::DeleteOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                    const std::string& p_MsgId)
+bool MessageCache::FetchMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::vector<std::string>& p_MsgIds, std::vector<std::string>& p_MissingMsgIds)
 {
-  if (!m_CacheEnabled) return;
+  if (!m_CacheEnabled) return false;
 
-  std::shared_ptr<DeleteOneMessageRequest> deleteOneMessageRequest =
-    std::make_shared<DeleteOneMessageRequest>();
-  deleteOneMessageRequest->profileId = p_ProfileId;
-  deleteOneMessageRequest->chatId = p_ChatId;
-  deleteOneMessageRequest->msgId = p_MsgId;
-  EnqueueRequest(deleteOneMessageRequest);
-}
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
 
-void MessageCache::DeleteChat(const std::string& p_ProfileId, const std::string& p_ChatId)
-{
-  if (!m_CacheEnabled) return;
+  // resolve which messages are cached in one query, cached ones are then fetched in one async request
+  std::set<std::string> foundMsgIds;
+  std::vector<std::string> dbMsgIds;
+  for (const auto& msgId : p_MsgIds)
+  {
+    if (HasMemoryMessage(p_ProfileId, p_ChatId, msgId))
+    {
+      foundMsgIds.insert(msgId);
+    }
+    else
+    {
+      dbMsgIds.push_back(msgId);
+    }
+  }
 
-  std::shared_ptr<DeleteOneChatRequest> deleteChatRequest =
-    std::make_shared<DeleteOneChatRequest>();
-  deleteChatRequest->profileId = p_ProfileId;
+  if (!dbMsgIds.empty())
+  {
+    std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+    try
+    {
+      // archived messages are resolved by the archive index, and only decoded by the async request
+      static const std::string inParams = StrUtil::Join(std::vector<std::string>(s_InParamCount, "?"), ",");
+      static const std::string sql = "SELECT id FROM messages WHERE "
+        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id IN (" + inParams + ") UNION ALL "
+        "SELECT id FROM archiveids WHERE "
+        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND removed = 0 AND id IN (" + inParams + ");";
+      for (const auto& chunk : GetInParamChunks(dbMsgIds))
+      {
+        sqlite::database_binder& existsStmt = GetReadStatement(*cache, sql);
+        for (int i = 0; i < 2; ++i)
+        {
+          existsStmt << p_ChatId;
+          for (const auto& msgId : chunk)
+          {
+            existsStmt << msgId;
+          }
+        }
+
+        // *INDENT-OFF*
+        existsStmt >>
+          [&](const std::string& id)
+          {
+            foundMsgIds.insert(id);
+          };
+        // *INDENT-ON*
+      }
+    }
+    catch (const sqlite::sqlite_exception& ex)
+    {
+      HANDLE_SQLITE_EXCEPTION(ex);
+    }
+  }
+
+  std::shared_ptr<FetchMessagesRequest> fetchMessagesRequest = std::make_shared<FetchMessagesRequest>();
+  fetchMessagesRequest->profileId = p_ProfileId;
+  fetchMessagesRequest->chatId = p_ChatId;
+  for (const auto& msgId : p_MsgIds)
+  {
+    if (foundMsgIds.count(msgId))
+    {
+      fetchMessagesRequest->msgIds.push_back(msgId);
+    }
+    else
+    {
+      p_MissingMsgIds.push_back(msgId);
+    }
+  }
+
+  LOG_DEBUG("cache async fetch %s %d of %d", p_ChatId.c_str(), fetchMessagesRequest->msgIds.size(), p_MsgIds.size());
+  if (!fetchMessagesRequest->msgIds.empty())
+  {
+    EnqueueRequest(fetchMessagesRequest);
+  }
+
+  return true;
+}
+
+bool MessageCache::FetchChatUnreads(const std::string& p_ProfileId, const std::vector<std::string>& p_ChatIds)
+{
+  if (!m_CacheEnabled) return false;
+
+  if (!GetProfileCache(p_ProfileId)) return false;
+
+  std::shared_ptr<FetchChatUnreadsRequest> fetchChatUnreadsRequest = std::make_shared<FetchChatUnreadsRequest>();
+  fetchChatUnreadsRequest->profileId = p_ProfileId;
+  fetchChatUnreadsRequest->chatIds = p_ChatIds;
+
+  LOG_DEBUG("cache async fetch unreads %d chats", p_ChatIds.size());
+  EnqueueRequest(fetchChatUnreadsRequest);
+  return true;
+}
+
+void MessageCache::DeleteOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                    const std::string& p_MsgId)
+{
+  if (!m_CacheEnabled) return;
+
+  std::shared_ptr<DeleteOneMessageRequest> deleteOneMessageRequest =
+    std::make_shared<DeleteOneMessageRequest>();
+  deleteOneMessageRequest->profileId = p_ProfileId;
+  deleteOneMessageRequest->chatId = p_ChatId;
+  deleteOneMessageRequest->msgId = p_MsgId;
+  EnqueueRequest(deleteOneMessageRequest);
+}
+
+void MessageCache::DeleteChat(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  if (!m_CacheEnabled) return;
+
+  std::shared_ptr<DeleteOneChatRequest> deleteChatRequest =
+    std::make_shared<DeleteOneChatRequest>();
+  deleteChatRequest->profileId = p_ProfileId;
   deleteChatRequest->chatId = p_ChatId;
   EnqueueRequest(deleteChatRequest);
 }
@@ -503,6 +982,19 @@ void MessageCache::UpdateMessageIsRead(const std::string& p_ProfileId, const std
   EnqueueRequest(updateIsReadRequest);
 }
 
+void MessageCache::UpdateMessagesIsRead(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                        const std::string& p_MsgId, bool p_IsOutgoing)
+{
+  if (!m_CacheEnabled) return;
+
+  std::shared_ptr<UpdateMessagesIsReadRequest> updateIsReadRequest = std::make_shared<UpdateMessagesIsReadRequest>();
+  updateIsReadRequest->profileId = p_ProfileId;
+  updateIsReadRequest->chatId = p_ChatId;
+  updateIsReadRequest->msgId = p_MsgId;
+  updateIsReadRequest->isOutgoing = p_IsOutgoing;
+  EnqueueRequest(updateIsReadRequest);
+}
+
 void MessageCache::UpdateMessageFileInfo(const std::string& p_ProfileId, const std::string& p_ChatId,
                                          const std::string& p_MsgId, const std::string& p_FileInfo)
 {
@@ -529,339 +1021,1030 @@ void MessageCache::UpdateMute(const std::string& p_ProfileId, const std::string&
   EnqueueRequest(updateMuteRequest);
 }
 
-void MessageCache::Export(const std::string& p_ExportDir)
+void MessageCache::AddAttachment(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::string& p_FilePath)
+{
+  if (!m_CacheEnabled) return;
+
+  std::shared_ptr<UpdateAttachmentRequest> updateAttachmentRequest =
+    std::make_shared<UpdateAttachmentRequest>();
+  updateAttachmentRequest->profileId = p_ProfileId;
+  updateAttachmentRequest->chatId = p_ChatId;
+  updateAttachmentRequest->filePath = p_FilePath;
+  EnqueueRequest(updateAttachmentRequest);
+}
+
+void MessageCache::AccessAttachment(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                    const std::string& p_FilePath)
+{
+  if (!m_CacheEnabled) return;
+
+  if (!IsAttachmentIndexed(p_FilePath)) return;
+
+  std::shared_ptr<UpdateAttachmentRequest> updateAttachmentRequest =
+    std::make_shared<UpdateAttachmentRequest>();
+  updateAttachmentRequest->profileId = p_ProfileId;
+  updateAttachmentRequest->chatId = p_ChatId;
+  updateAttachmentRequest->filePath = p_FilePath;
+  updateAttachmentRequest->isAccess = true;
+  EnqueueRequest(updateAttachmentRequest);
+}
+
+bool MessageCache::IsAttachmentIndexed(const std::string& p_FilePath)
+{
+  std::unique_lock<std::mutex> lock(m_AttachmentMutex);
+  return m_Attachments.count(p_FilePath) > 0;
+}
+
+uint64_t MessageCache::GetAttachmentGeneration()
+{
+  return m_AttachmentGeneration;
+}
+
+void MessageCache::GetMemoryStats(int64_t& p_Hits, int64_t& p_Misses)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  p_Hits = m_MemoryHits;
+  p_Misses = m_MemoryMisses;
+}
+
+void MessageCache::Export(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental)
+{
+  PerformExport(p_ExportDir, p_ExportFormat, p_Incremental, false /* p_Background */);
+}
+
+bool MessageCache::StartExport(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental)
+{
+  if (!m_CacheEnabled)
+  {
+    LOG_WARNING("export not started, cache not enabled.");
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(m_ExportMutex);
+  if (m_ExportRunning)
+  {
+    LOG_WARNING("export not started, already running.");
+    return false;
+  }
+
+  if (m_ExportThread.joinable())
+  {
+    m_ExportThread.join();
+  }
+
+  m_ExportRunning = true;
+  Status::SetExportProgress(0);
+  Status::Set(Status::FlagExporting);
+  m_ExportThread = std::thread([p_ExportDir, p_ExportFormat, p_Incremental]()
+  {
+    // export workers inherit the lowered priority, batch class as they briefly take the read db lock
+    BackgroundExecutor::SetThreadClass(BackgroundExecutor::ClassBatch);
+    PerformExport(p_ExportDir, p_ExportFormat, p_Incremental, true /* p_Background */);
+    Status::Clear(Status::FlagExporting);
+    m_ExportRunning = false;
+  });
+
+  return true;
+}
+
+bool MessageCache::IsExportRunning()
+{
+  return m_ExportRunning;
+}
+
+void MessageCache::PerformExport(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental,
+                                 bool p_Background)
 {
+  // background export logs instead of writing to the terminal owned by the ui
+  auto Print = [&](const std::string& p_Str)
+  {
+    if (p_Background)
+    {
+      LOG_INFO("export: %s", p_Str.c_str());
+    }
+    else
+    {
+      std::cout << p_Str << "\n";
+    }
+  };
+
   if (!m_CacheEnabled)
   {
-    std::cout << "Export failed (cache not enabled).\n";
+    Print("Export failed (cache not enabled).");
     LOG_ERROR("export failed, cache not enabled.");
     return;
   }
 
-  std::unique_lock<std::mutex> lock(m_DbMutex);
+  if (!IsExportFormat(p_ExportFormat))
+  {
+    Print("Export failed (unsupported format " + p_ExportFormat + ").");
+    LOG_ERROR("export failed, unsupported format %s.", p_ExportFormat.c_str());
+    return;
+  }
+
+  const bool isJsonl = (p_ExportFormat.compare(0, 5, "jsonl") == 0);
+  const bool isArchive = (p_ExportFormat.find(".tgz") != std::string::npos);
 
-  for (auto& db : m_Dbs)
+  std::map<std::string, std::shared_ptr<ProfileCache>> profileCaches;
   {
-    const std::string profileId = db.first;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    profileCaches = m_ProfileCaches;
+  }
+
+  size_t profileIndex = 0;
+  for (auto& profileCache : profileCaches)
+  {
+    if (m_ExportCancel) break;
+
+    const std::string profileId = profileCache.first;
+    std::shared_ptr<ProfileCache> cache = profileCache.second;
     const std::string dirPath = p_ExportDir + "/" + profileId;
-    FileUtil::RmDir(dirPath);
+    if (!p_Incremental)
+    {
+      FileUtil::RmDir(dirPath);
+    }
+
     FileUtil::MkDir(dirPath);
 
-    std::cout << profileId << "\n";
+    Print(profileId);
+
+    // legacy messages are only exported once converted
+    while (cache->hasLegacyMessages && !m_ExportCancel)
+    {
+      TimeUtil::Sleep(0.1);
+    }
 
     std::vector<std::string> chatIds;
     std::map<std::string, std::string> contactNames;
 
-    try
     {
-      // *INDENT-OFF*
-      *m_Dbs[profileId] << "SELECT DISTINCT chatId FROM messages;" >>
-        [&](const std::string& chatId)
-        {
-          chatIds.push_back(chatId);
-        };
+      std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+      try
+      {
+        // *INDENT-OFF*
+        GetReadStatement(*cache, "SELECT id FROM chatids WHERE EXISTS "
+                         "(SELECT 1 FROM messages WHERE messages.chatKey = chatids.chatKey);") >>
+          [&](const std::string& chatId)
+          {
+            chatIds.push_back(chatId);
+          };
 
-      const std::string selfName = "You";
-      *m_Dbs[profileId] << "SELECT id, name, isSelf FROM " + s_TableContacts + ";" >>
-        [&](const std::string& id, const std::string& name, int32_t isSelf)
-        {
-          contactNames[id] = isSelf ? selfName : name;
-        };
-      // *INDENT-ON*
+        const std::string selfName = "You";
+        GetReadStatement(*cache, "SELECT id, name, isSelf FROM " + s_TableContacts + ";") >>
+          [&](const std::string& id, const std::string& name, int32_t isSelf)
+          {
+            contactNames[id] = isSelf ? selfName : name;
+          };
+        // *INDENT-ON*
+      }
+      catch (const sqlite::sqlite_exception& ex)
+      {
+        HANDLE_SQLITE_EXCEPTION(ex);
+      }
     }
-    catch (const sqlite::sqlite_exception& ex)
+
+    // chats may be fully archived
+    for (const auto& chatId : GetArchivedChatIds(*cache))
     {
-      HANDLE_SQLITE_EXCEPTION(ex);
+      if (std::find(chatIds.begin(), chatIds.end(), chatId) == chatIds.end())
+      {
+        chatIds.push_back(chatId);
+      }
+    }
+
+    // resume after last exported message of each chat
+    std::map<std::string, std::pair<int64_t, std::string>> watermarks;
+    if (p_Incremental)
+    {
+      watermarks = LoadExportWatermarks(dirPath);
     }
 
-    const int limit = std::numeric_limits<int>::max();
-    const int64_t fromMsgIdTimeSent = std::numeric_limits<int64_t>::max();
     for (const auto& chatId : chatIds)
     {
-      std::ofstream outFile;
-      std::string lastYear;
-      std::string chatName = chatId;
-      std::string chatUser = contactNames[chatId];
-      if (!chatUser.empty())
+      if (!watermarks.count(chatId))
       {
-        chatUser.erase(remove_if(chatUser.begin(), chatUser.end(), [](char c) { return !isalpha(c); }), chatUser.end());
-        chatName += "_" + chatUser;
+        watermarks[chatId] = std::make_pair(std::numeric_limits<int64_t>::min(), std::string());
       }
+    }
 
-      std::vector<ChatMessage> chatMessages;
-      PerformFetchMessagesFrom(profileId, chatId, fromMsgIdTimeSent, limit, chatMessages);
-
-      std::map<std::string, std::string> messageMap;
-      for (auto chatMessage = chatMessages.rbegin(); chatMessage != chatMessages.rend(); ++chatMessage)
+    // chats are exported in parallel, each worker with its own read-only connection, background export
+    // uses a single worker to leave cpu and disk bandwidth for the running ui and protocols
+    const size_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t maxThreads = p_Background ? 1 : std::min(hwThreads, (size_t)8);
+    const size_t numThreads = std::min(maxThreads, std::max(chatIds.size(), (size_t)1));
+    std::mutex outMutex;
+    std::atomic<size_t> nextChat(0);
+    size_t doneChats = 0;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+      // *INDENT-OFF*
+      workers.push_back(std::thread([&]()
       {
-        std::string timestr = TimeUtil::GetTimeString(chatMessage->timeSent, true /* p_IsExport */);
-        std::string year = TimeUtil::GetYearString(chatMessage->timeSent);;
-        if (year != lastYear)
+        try
         {
-          lastYear = year;
-          std::string outPath = dirPath + "/" + chatName + "_" + year + ".txt";
-          std::cout << "Writing " << outPath << "\n";
-          if (outFile.is_open())
+          sqlite::sqlite_config config;
+          config.flags = sqlite::OpenFlags::READONLY;
+          sqlite::database db(cache->dbPath, config);
+          cache->textCompressor->Register(db);
+          SqliteScan::EnableMmap(db, std::max<int64_t>(AppConfig::GetNum("cache_mmap_size"), s_ExportMmapSize));
+          size_t chatIndex = 0;
+          while (!m_ExportCancel && ((chatIndex = nextChat++) < chatIds.size()))
           {
-            outFile.close();
-          }
-
-          outFile.open(outPath, std::ios::binary);
-        }
+            const std::string& chatId = chatIds.at(chatIndex);
+            std::pair<int64_t, std::string> watermark;
+            {
+              std::unique_lock<std::mutex> lock(outMutex);
+              watermark = watermarks[chatId];
+            }
 
-        std::string sender =
-          contactNames[chatMessage->senderId].empty() ? chatMessage->senderId : contactNames[chatMessage->senderId];
-        std::string header = sender + " (" + timestr + ")";
-        outFile << header << "\n";
+            ExportChat(db, dirPath, chatId, contactNames, isJsonl, watermark, outMutex, GetArchive(*cache, chatId),
+                       p_Background);
 
-        std::string quotedMsg;
-        messageMap[chatMessage->id] = chatMessage->text;
-        if (!chatMessage->quotedId.empty())
-        {
-          auto quotedIt = messageMap.find(chatMessage->quotedId);
-          if (quotedIt != messageMap.end())
-          {
-            quotedMsg = "> " + quotedIt->second;
-            quotedMsg =
-              StrUtil::ToString(StrUtil::Join(StrUtil::WordWrap(StrUtil::ToWString(quotedMsg),
-                                                                72, false, false, true, 2), L"\n"));
-          }
-          else
-          {
-            quotedMsg = ">";
+            std::unique_lock<std::mutex> lock(outMutex);
+            watermarks[chatId] = watermark;
+            if (p_Background)
+            {
+              // progress weighs profiles equally, each by its share of exported chats
+              const size_t percent = ((profileIndex * chatIds.size()) + (++doneChats)) * 100 /
+                (profileCaches.size() * chatIds.size());
+              Status::SetExportProgress(static_cast<int32_t>(percent));
+            }
           }
-
-          outFile << quotedMsg << "\n";
         }
-
-        if (!chatMessage->fileInfo.empty())
+        catch (const sqlite::sqlite_exception& ex)
         {
-          FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(chatMessage->fileInfo);
-          std::string fileName = FileUtil::BaseName(fileInfo.filePath);
-          outFile << fileName << "\n";
+          LOG_ERROR("export failed %d: %s", ex.get_code(), ex.what());
         }
+      }));
+      // *INDENT-ON*
+    }
 
-        if (!chatMessage->text.empty())
-        {
-          outFile << chatMessage->text << "\n";
-        }
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
 
-        outFile << "\n";
+    // watermarks reflect partial progress, so a cancelled export resumes where it stopped
+    SaveExportWatermarks(dirPath, watermarks);
+    ++profileIndex;
+
+    if (isArchive && !m_ExportCancel)
+    {
+      const std::string archivePath = p_ExportDir + "/" + profileId + ".tgz";
+      Print("Writing " + archivePath);
+      const std::string cmd = "tar -czf \"" + archivePath + "\" -C \"" + p_ExportDir + "\" \"" + profileId + "\"";
+      int rv = system(cmd.c_str());
+      if (rv != 0)
+      {
+        Print("Archive failed (" + std::to_string(rv) + ").");
+        LOG_ERROR("archive cmd failed (%d) %s", rv, cmd.c_str());
       }
     }
   }
 
-  std::cout << "Export completed.\n";
+  Print(m_ExportCancel ? "Export cancelled." : "Export completed.");
+}
+
+bool MessageCache::IsExportFormat(const std::string& p_ExportFormat)
+{
+  static const std::set<std::string> exportFormats = { "txt", "jsonl", "txt.tgz", "jsonl.tgz" };
+  return exportFormats.count(p_ExportFormat);
 }
 
-void MessageCache::Process()
+void MessageCache::ExportChat(sqlite::database& p_Db, const std::string& p_DirPath, const std::string& p_ChatId,
+                              const std::map<std::string, std::string>& p_ContactNames, bool p_IsJsonl,
+                              std::pair<int64_t, std::string>& p_Watermark, std::mutex& p_OutMutex,
+                              std::shared_ptr<MessageArchive> p_Archive, bool p_Background)
 {
-  while (m_Running)
+  auto GetContactName = [&](const std::string& p_Id) -> const std::string*
   {
-    std::shared_ptr<Request> request;
+    auto it = p_ContactNames.find(p_Id);
+    return ((it != p_ContactNames.end()) && !it->second.empty()) ? &it->second : nullptr;
+  };
+
+  std::string chatName = p_ChatId;
+  const std::string* chatContactName = GetContactName(p_ChatId);
+  std::string chatUser = chatContactName ? *chatContactName : std::string();
+  if (!chatUser.empty())
+  {
+    chatUser.erase(remove_if(chatUser.begin(), chatUser.end(), [](char c) { return !isalpha(c); }), chatUser.end());
+    chatName += "_" + chatUser;
+  }
 
+  // rows are formatted from column views into reused buffers, avoiding per-row allocations
+  struct ExportRow
+  {
+    SqliteText id;
+    SqliteText senderId;
+    SqliteText text;
+    SqliteText quotedId;
+    SqliteText filePath;
+    int64_t timeSent = 0;
+    bool isOutgoing = false;
+    bool isRead = false;
+  };
+
+  auto ToText = [](const std::string& p_Str) -> SqliteText
+  {
+    SqliteText text;
+    text.data = p_Str.data();
+    text.size = p_Str.size();
+    return text;
+  };
+
+  std::unordered_map<std::string, std::unique_ptr<sqlite::database_binder>> stmts;
+  std::ofstream outFile;
+  std::string outPath;
+  std::string line;
+  std::string senderId;
+  std::string quotedId;
+  std::string lastId;
+  int64_t lastTimeSent = 0;
+  auto WriteRow = [&](const ExportRow& p_Row)
+  {
+    const std::string year = p_IsJsonl ? "" : TimeUtil::GetYearString(p_Row.timeSent);
+    const std::string filePath = p_DirPath + "/" + chatName + (p_IsJsonl ? ".jsonl" : "_" + year + ".txt");
+    if (filePath != outPath)
     {
-      std::unique_lock<std::mutex> lock(m_QueueMutex);
-      while (m_Queue.empty() && m_Running)
+      outPath = filePath;
+      if (p_Background)
+      {
+        LOG_DEBUG("export: writing %s", outPath.c_str());
+      }
+      else
+      {
+        std::unique_lock<std::mutex> lock(p_OutMutex);
+        std::cout << "Writing " << outPath << "\n";
+      }
+
+      if (outFile.is_open())
       {
-        m_CondVar.wait(lock);
+        outFile.close();
       }
 
-      if (!m_Running)
+      outFile.open(outPath, std::ios::binary | std::ios::app);
+    }
+
+    senderId.assign(p_Row.senderId.data, p_Row.senderId.size);
+    const std::string* contactName = GetContactName(senderId);
+    const std::string& sender = contactName ? *contactName : senderId;
+
+    // quoted text is resolved from db, as history is not kept in memory
+    std::string quotedText;
+    bool hasQuotedText = false;
+    if (!p_Row.quotedId.empty())
+    {
+      quotedId.assign(p_Row.quotedId.data, p_Row.quotedId.size);
+      // *INDENT-OFF*
+      GetStatement(p_Db, stmts, "SELECT nc_text(text) FROM messages WHERE "
+                   "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;")
+        << p_ChatId << quotedId >>
+        [&](const std::string& text)
+        {
+          quotedText = text;
+          hasQuotedText = true;
+        };
+      // *INDENT-ON*
+
+      // archived quoted message is located by the archive index, decoding only its block
+      if (!hasQuotedText && !p_Archive->IsEmpty())
       {
-        if (!m_Queue.empty())
+        std::vector<ChatMessage> quotedMessages;
+        // *INDENT-OFF*
+        GetStatement(p_Db, stmts, "SELECT blockOffset FROM archiveids WHERE "
+                     "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? AND removed = 0;")
+          << p_ChatId << quotedId >>
+          [&](int64_t blockOffset)
+          {
+            p_Archive->GetBlockMessages(static_cast<size_t>(blockOffset), std::set<std::string>({ quotedId }),
+                                        quotedMessages);
+          };
+        // *INDENT-ON*
+
+        if (!quotedMessages.empty())
         {
-          LOG_WARNING("Exiting with non-empty queue %d", m_Queue.size());
+          quotedText = quotedMessages.front().text;
+          hasQuotedText = true;
         }
+      }
+    }
+
+    // base name of file path
+    SqliteText fileName = p_Row.filePath;
+    while ((fileName.size > 1) && (fileName.data[fileName.size - 1] == '/'))
+    {
+      --fileName.size;
+    }
+
+    for (size_t i = fileName.size; i > 0; --i)
+    {
+      if ((fileName.data[i - 1] == '/') && (i < fileName.size))
+      {
+        fileName.data += i;
+        fileName.size -= i;
         break;
       }
+    }
 
-      request = m_Queue.front();
-      m_Queue.pop_front();
+    line.clear();
+    if (p_IsJsonl)
+    {
+      line += "{\"id\":\"";
+      StrUtil::AppendEscapeJson(line, p_Row.id.data, p_Row.id.size);
+      line += "\",\"senderId\":\"";
+      StrUtil::AppendEscapeJson(line, p_Row.senderId.data, p_Row.senderId.size);
+      line += "\",\"sender\":\"";
+      StrUtil::AppendEscapeJson(line, sender.data(), sender.size());
+      line += "\",\"timeSent\":";
+      line += std::to_string(p_Row.timeSent);
+      line += ",\"isOutgoing\":";
+      line += (p_Row.isOutgoing ? "true" : "false");
+      line += ",\"isRead\":";
+      line += (p_Row.isRead ? "true" : "false");
+      line += ",\"quotedId\":\"";
+      StrUtil::AppendEscapeJson(line, p_Row.quotedId.data, p_Row.quotedId.size);
+      line += "\",\"quotedText\":\"";
+      StrUtil::AppendEscapeJson(line, quotedText.data(), quotedText.size());
+      line += "\",\"file\":\"";
+      StrUtil::AppendEscapeJson(line, fileName.data, fileName.size);
+      line += "\",\"text\":\"";
+      StrUtil::AppendEscapeJson(line, p_Row.text.data, p_Row.text.size);
+      line += "\"}\n";
     }
+    else
+    {
+      line += sender + " (" + TimeUtil::GetTimeString(p_Row.timeSent, true /* p_IsExport */) + ")\n";
 
-    PerformRequest(request);
-    TimeUtil::Sleep(0.001); // hack for GCC -O2 to enable context switching for non-empty queue
-  }
+      if (!p_Row.quotedId.empty())
+      {
+        std::string quotedMsg = ">";
+        if (hasQuotedText)
+        {
+          quotedMsg = "> " + quotedText;
+          quotedMsg =
+            StrUtil::ToString(StrUtil::Join(StrUtil::WordWrap(StrUtil::ToWString(quotedMsg),
+                                                              72, false, false, true, 2), L"\n"));
+        }
+
+        line += quotedMsg + "\n";
+      }
+
+      if (!fileName.empty())
+      {
+        line.append(fileName.data, fileName.size);
+        line += "\n";
+      }
 
-  if (!m_Queue.empty())
+      if (!p_Row.text.empty())
+      {
+        line.append(p_Row.text.data, p_Row.text.size);
+        line += "\n";
+      }
+
+      line += "\n";
+    }
+
+    outFile.write(line.data(), line.size());
+    lastTimeSent = p_Row.timeSent;
+    lastId.assign(p_Row.id.data, p_Row.id.size);
+  };
+
+  SqliteScan scan(p_Db,
+                  "SELECT m.id, s.id, nc_text(m.text), m.quotedId, m.filePath, m.timeSent, m.isOutgoing, m.isRead "
+                  "FROM messages m LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+                  "WHERE m.chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND "
+                  "(m.timeSent > ? OR (m.timeSent = ? AND m.id > ?)) "
+                  "ORDER BY m.timeSent ASC, m.id ASC LIMIT ?;");
+  int64_t count = 0;
+  bool isArchived = !p_Archive->IsEmpty();
+  std::set<std::string> removedIds;
+  if (isArchived)
   {
-    LOG_WARNING("Exiting with non-empty queue %d", m_Queue.size());
+    // *INDENT-OFF*
+    GetStatement(p_Db, stmts, "SELECT id FROM archiveids WHERE "
+                 "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND removed = 1;") << p_ChatId >>
+      [&](const std::string& id)
+      {
+        removedIds.insert(id);
+      };
+    // *INDENT-ON*
   }
-}
-
-void MessageCache::EnqueueRequest(std::shared_ptr<Request> p_Request)
-{
-  std::unique_lock<std::mutex> lock(m_QueueMutex);
-  m_Queue.push_back(p_Request);
-  m_CondVar.notify_one();
-}
 
-void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
-{
-  switch (p_Request->GetRequestType())
+  while (true)
   {
-    case AddMessagesRequestType:
+    // read one chunk at a time in chronological order, resuming after last written message
+    int64_t chunkCount = 0;
+    if (isArchived)
+    {
+      // archived messages are older than those in db, and exported first
+      std::vector<ChatMessage> chatMessages;
+      p_Archive->GetMessagesAfter(p_Watermark.first, p_Watermark.second, s_ExportChunkSize, chatMessages);
+      for (const auto& chatMessage : chatMessages)
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<AddMessagesRequest> addMessagesRequest =
-          std::static_pointer_cast<AddMessagesRequest>(p_Request);
-        const std::string& profileId = addMessagesRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        ++chunkCount;
+        if (removedIds.count(chatMessage.id))
+        {
+          // deleted, or exported from db, only advances the watermark
+          lastTimeSent = chatMessage.timeSent;
+          lastId = chatMessage.id;
+          continue;
+        }
 
-        const std::string& chatId = addMessagesRequest->chatId;
-        const std::string& fromMsgId = addMessagesRequest->fromMsgId;
-        LOG_DEBUG("cache add %s %s %d", chatId.c_str(), fromMsgId.c_str(),
-                  addMessagesRequest->chatMessages.size());
+        const std::string filePath =
+          chatMessage.fileInfo.empty() ? "" : ProtocolUtil::FileInfoFromHex(chatMessage.fileInfo).filePath;
+        ExportRow row;
+        row.id = ToText(chatMessage.id);
+        row.senderId = ToText(chatMessage.senderId);
+        row.text = ToText(chatMessage.text);
+        row.quotedId = ToText(chatMessage.quotedId);
+        row.filePath = ToText(filePath);
+        row.timeSent = chatMessage.timeSent;
+        row.isOutgoing = chatMessage.isOutgoing;
+        row.isRead = chatMessage.isRead;
+        WriteRow(row);
+      }
 
-        if (m_CheckSync[profileId] && !m_InSync[profileId][chatId])
-        {
-          if (!addMessagesRequest->chatMessages.empty())
-          {
-            std::string msgIds;
-            for (const auto& msg : addMessagesRequest->chatMessages)
-            {
-              msgIds += (!msgIds.empty()) ? "," : "";
-              msgIds += "'" + msg.id + "'";
-            }
+      isArchived = (chunkCount > 0);
+    }
 
-            int count = 0;
-            try
-            {
-              // *INDENT-OFF*
-              *m_Dbs[profileId] << "SELECT COUNT(*) FROM messages WHERE chatId = ? AND id IN (" +
-                msgIds + ");" << chatId >>
-                [&](const int& countRes)
-                {
-                  count = countRes;
-                };
-              // *INDENT-ON*
-            }
-            catch (const sqlite::sqlite_exception& ex)
-            {
-              HANDLE_SQLITE_EXCEPTION(ex);
-            }
+    if (!isArchived)
+    {
+      scan.Reset();
+      scan << p_ChatId << p_Watermark.first << p_Watermark.first << p_Watermark.second
+           << static_cast<int64_t>(s_ExportChunkSize);
+      while (scan.Step())
+      {
+        ExportRow row;
+        row.id = scan.GetText(0);
+        row.senderId = scan.GetText(1);
+        row.text = scan.GetText(2);
+        row.quotedId = scan.GetText(3);
+        row.filePath = scan.GetText(4); // only file name is exported
+        row.timeSent = scan.GetInt64(5);
+        row.isOutgoing = scan.GetInt64(6);
+        row.isRead = scan.GetInt64(7);
+        WriteRow(row);
+        ++chunkCount;
+      }
+    }
 
-            if (count > 0)
-            {
-              m_InSync[profileId][chatId] = true;
-              LOG_DEBUG("cache in sync %s list (%s)", chatId.c_str(), msgIds.c_str());
-            }
-            else
-            {
-              LOG_DEBUG("cache not in sync %s list (%s)", chatId.c_str(), msgIds.c_str());
-            }
-          }
-        }
+    if (chunkCount == 0) break;
 
-        try
-        {
-          *m_Dbs[profileId] << "BEGIN;";
-          for (const auto& msg : addMessagesRequest->chatMessages)
-          {
-            *m_Dbs[profileId] << "INSERT INTO messages "
-              "(chatId, id, senderId, text, quotedId, quotedText, quotedSender, fileInfo, timeSent, isOutgoing, isRead) VALUES "
-              "(?,?,?,?,?,?,?,?,?,?,?);" <<
-              chatId << msg.id << msg.senderId << msg.text << msg.quotedId << msg.quotedText << msg.quotedSender <<
-              msg.fileInfo << msg.timeSent <<
-              msg.isOutgoing << msg.isRead;
-          }
-          *m_Dbs[profileId] << "COMMIT;";
-        }
-        catch (const sqlite::sqlite_exception& ex)
-        {
-          HANDLE_SQLITE_EXCEPTION(ex);
-        }
+    p_Watermark = std::make_pair(lastTimeSent, lastId);
+    count += chunkCount;
+
+    if (p_Background)
+    {
+      // flush and pause between chunks, bounding export disk and cpu usage while ui is running
+      outFile.flush();
+      if (m_ExportCancel) break;
+
+      static const int throttleMs = AppConfig::GetNum("cache_export_throttle_ms");
+      if (throttleMs > 0)
+      {
+        TimeUtil::Sleep(throttleMs / 1000.0);
       }
-      break;
+    }
+  }
 
-    case AddChatsRequestType:
+  ClearStatements(stmts);
+  LOG_DEBUG("export %s %d messages", p_ChatId.c_str(), count);
+}
+
+std::map<std::string, std::pair<int64_t, std::string>> MessageCache::LoadExportWatermarks(const std::string& p_DirPath)
+{
+  std::map<std::string, std::pair<int64_t, std::string>> watermarks;
+  std::ifstream inFile(p_DirPath + "/" + s_ExportWatermarkFile);
+  std::string line;
+  while (std::getline(inFile, line))
+  {
+    // chat id, time sent and message id of last exported message
+    std::vector<std::string> fields = StrUtil::Split(line, '\t');
+    if ((fields.size() != 3) || !StrUtil::IsInteger(fields.at(1))) continue;
+
+    watermarks[fields.at(0)] = std::make_pair(std::stoll(fields.at(1)), fields.at(2));
+  }
+
+  return watermarks;
+}
+
+void MessageCache::SaveExportWatermarks(const std::string& p_DirPath,
+                                        const std::map<std::string, std::pair<int64_t, std::string>>& p_Watermarks)
+{
+  std::ofstream outFile(p_DirPath + "/" + s_ExportWatermarkFile, std::ios::binary);
+  for (const auto& watermark : p_Watermarks)
+  {
+    if (watermark.second.second.empty()) continue;
+
+    outFile << watermark.first << "\t" << watermark.second.first << "\t" << watermark.second.second << "\n";
+  }
+}
+
+bool MessageCache::Search(const std::string& p_ProfileId, const std::string& p_Query, const int p_Limit,
+                          const bool p_Sync)
+{
+  if (!m_CacheEnabled) return false;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
+
+  if (!cache->hasSearch) return false; // set once at AddProfile
+
+  std::shared_ptr<SearchRequest> searchRequest = std::make_shared<SearchRequest>();
+  searchRequest->profileId = p_ProfileId;
+  searchRequest->query = p_Query;
+  searchRequest->limit = p_Limit;
+
+  if (p_Sync)
+  {
+    LOG_DEBUG("cache sync search %d", p_Limit);
+    PerformRequest(searchRequest);
+  }
+  else
+  {
+    LOG_DEBUG("cache async search %d", p_Limit);
+    EnqueueRequest(searchRequest);
+  }
+
+  return true;
+}
+
+// outbox is written synchronously, so a queued message is durable once the send is accepted
+bool MessageCache::AddOutbox(const std::string& p_ProfileId, const OutboxEntry& p_OutboxEntry)
+{
+  if (!m_CacheEnabled || m_ReadOnly) return false;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return false;
+
+  std::unique_lock<std::mutex> lock(cache->dbMutex);
+  if (!cache->db) return false;
+
+  try
+  {
+    const ChatMessage& chatMessage = p_OutboxEntry.chatMessage;
+    (GetStatement(*cache, "INSERT OR REPLACE INTO outbox (outboxKey, chatId, text, quotedId, quotedText, "
+                  "quotedSender, fileInfo, timeQueued, attempts, failed) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);") <<
+     p_OutboxEntry.key << p_OutboxEntry.chatId << chatMessage.text << chatMessage.quotedId << chatMessage.quotedText <<
+     chatMessage.quotedSender << chatMessage.fileInfo << TimeUtil::GetCurrentTimeMSec() << p_OutboxEntry.attempts <<
+     (int)p_OutboxEntry.failed).execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+    return false;
+  }
+
+  return true;
+}
+
+void MessageCache::UpdateOutbox(const std::string& p_ProfileId, const OutboxEntry& p_OutboxEntry)
+{
+  if (!m_CacheEnabled || m_ReadOnly) return;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return;
+
+  std::unique_lock<std::mutex> lock(cache->dbMutex);
+  if (!cache->db) return;
+
+  try
+  {
+    (GetStatement(*cache, "UPDATE outbox SET attempts = ?, failed = ? WHERE outboxKey = ?;") <<
+     p_OutboxEntry.attempts << (int)p_OutboxEntry.failed << p_OutboxEntry.key).execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+void MessageCache::RemoveOutbox(const std::string& p_ProfileId, int64_t p_Key)
+{
+  if (!m_CacheEnabled || m_ReadOnly) return;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return;
+
+  std::unique_lock<std::mutex> lock(cache->dbMutex);
+  if (!cache->db) return;
+
+  try
+  {
+    (GetStatement(*cache, "DELETE FROM outbox WHERE outboxKey = ?;") << p_Key).execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+std::vector<MessageCache::OutboxEntry> MessageCache::FetchOutbox(const std::string& p_ProfileId)
+{
+  std::vector<OutboxEntry> outboxEntries;
+  if (!m_CacheEnabled) return outboxEntries;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return outboxEntries;
+
+  std::unique_lock<std::mutex> lock(cache->dbMutex);
+  if (!cache->db) return outboxEntries;
+
+  try
+  {
+    // *INDENT-OFF*
+    GetStatement(*cache, "SELECT outboxKey, chatId, text, quotedId, quotedText, quotedSender, fileInfo, attempts, "
+                 "failed FROM outbox ORDER BY outboxKey;") >>
+      [&](int64_t p_Key, const std::string& p_ChatId, const std::string& p_Text, const std::string& p_QuotedId,
+          const std::string& p_QuotedText, const std::string& p_QuotedSender, const std::string& p_FileInfo,
+          int p_Attempts, int p_Failed)
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<AddChatsRequest> addChatsRequest =
-          std::static_pointer_cast<AddChatsRequest>(p_Request);
-        const std::string& profileId = addChatsRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        OutboxEntry outboxEntry;
+        outboxEntry.key = p_Key;
+        outboxEntry.chatId = p_ChatId;
+        outboxEntry.chatMessage.text = p_Text;
+        outboxEntry.chatMessage.quotedId = p_QuotedId;
+        outboxEntry.chatMessage.quotedText = p_QuotedText;
+        outboxEntry.chatMessage.quotedSender = p_QuotedSender;
+        outboxEntry.chatMessage.fileInfo = p_FileInfo;
+        outboxEntry.attempts = p_Attempts;
+        outboxEntry.failed = p_Failed;
+        outboxEntries.push_back(outboxEntry);
+      };
+    // *INDENT-ON*
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  LOG_DEBUG("cache fetched %d outbox entries for %s", (int)outboxEntries.size(), p_ProfileId.c_str());
+  return outboxEntries;
+}
 
-        LOG_DEBUG("cache add chats %d", addChatsRequest->chatInfos.size());
+void MessageCache::Process(std::shared_ptr<ProfileCache> p_ProfileCache)
+{
+  ThreadRegistry::Register("cache");
 
-        if (addChatsRequest->chatInfos.empty()) return;
+  const bool hasRetention = !m_ReadOnly && HasRetentionPolicy(*p_ProfileCache);
+  int idleDelayMs = p_ProfileCache->hasLegacyMessages ? s_MigrationBatchDelayMs : s_RetentionStartDelayMs;
+  bool retentionStarted = false;
+  while (true)
+  {
+    std::vector<std::shared_ptr<Request>> requests;
 
-        try
+    {
+      std::unique_lock<std::mutex> lock(p_ProfileCache->queueMutex);
+      auto isReady = [&]()
+      {
+        return !p_ProfileCache->queue.empty() || !p_ProfileCache->running;
+      };
+
+      if (p_ProfileCache->hasLegacyMessages || hasRetention || p_ProfileCache->purgePending)
+      {
+        const int delayMs = p_ProfileCache->purgePending ? std::min(idleDelayMs, s_PurgeBatchDelayMs) : idleDelayMs;
+        if (!p_ProfileCache->condVar.wait_for(lock, std::chrono::milliseconds(delayMs), isReady))
         {
-          *m_Dbs[profileId] << "BEGIN;";
-          for (const auto& chatInfo : addChatsRequest->chatInfos)
+          // idle timeout, purge of deleted chats and schema migration complete before retention starts
+          lock.unlock();
+          if (p_ProfileCache->purgePending)
           {
-            *m_Dbs[profileId] << "INSERT INTO " + s_TableChats + " "
-              "(id, isMuted) VALUES "
-              "(?, ?);" <<
-              chatInfo.id << chatInfo.isMuted;
+            p_ProfileCache->purgePending = PerformPurge(*p_ProfileCache);
           }
-          *m_Dbs[profileId] << "COMMIT;";
-        }
-        catch (const sqlite::sqlite_exception& ex)
-        {
-          HANDLE_SQLITE_EXCEPTION(ex);
+          else if (p_ProfileCache->hasLegacyMessages)
+          {
+            PerformMigration(*p_ProfileCache);
+            idleDelayMs = p_ProfileCache->hasLegacyMessages ? s_MigrationBatchDelayMs : s_RetentionStartDelayMs;
+          }
+          else if (p_ProfileCache->retentionPending)
+          {
+            idleDelayMs = s_RetentionBatchDelayMs;
+          }
+          else if (retentionStarted && !p_ProfileCache->retentionHasMore)
+          {
+            retentionStarted = false;
+            idleDelayMs = s_RetentionIntervalMs;
+          }
+          else
+          {
+            // batches run at lowered priority, polled for completion so the writer stays responsive
+            auto retentionJob = [p_ProfileCache]()
+            {
+              bool hasMore = PerformRetention(*p_ProfileCache);
+              hasMore = PerformAttachmentRetention(*p_ProfileCache) || hasMore;
+              hasMore = PerformArchival(*p_ProfileCache) || hasMore;
+              p_ProfileCache->retentionHasMore = hasMore;
+              p_ProfileCache->retentionPending = false;
+            };
+
+            retentionStarted = true;
+            p_ProfileCache->retentionPending = true;
+            if (!BackgroundExecutor::Post(BackgroundExecutor::ClassBatch, retentionJob))
+            {
+              p_ProfileCache->retentionHasMore = false;
+              p_ProfileCache->retentionPending = false;
+            }
+
+            idleDelayMs = s_RetentionBatchDelayMs;
+          }
+
+          continue;
         }
       }
-      break;
+      else
+      {
+        p_ProfileCache->condVar.wait(lock, isReady);
+      }
 
-    case AddContactsRequestType:
+      if (!p_ProfileCache->running)
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<AddContactsRequest> addContactsRequest =
-          std::static_pointer_cast<AddContactsRequest>(p_Request);
-        const std::string& profileId = addContactsRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        requests.assign(p_ProfileCache->queue.begin(), p_ProfileCache->queue.end());
+        p_ProfileCache->queue.clear();
+        p_ProfileCache->queueHeapSize = 0;
+        PerfStats::Add(PerfStats::StatCacheQueueDepth, -(int64_t)requests.size());
+        PerfStats::Add(PerfStats::StatHeapCacheQueues, -GetRequestsHeapSize(requests));
+        const int64_t stopTime = p_ProfileCache->stopTime;
+        lock.unlock();
+        PerformShutdownFlush(*p_ProfileCache, requests, stopTime);
+        break;
+      }
 
-        LOG_DEBUG("cache add contacts %d", addContactsRequest->contactInfos.size());
+      while (!p_ProfileCache->queue.empty() && (requests.size() < s_MaxBatchRequests))
+      {
+        requests.push_back(p_ProfileCache->queue.front());
+        p_ProfileCache->queue.pop_front();
+      }
 
-        if (addContactsRequest->contactInfos.empty()) return;
+      const size_t requestsHeapSize = GetRequestsHeapSize(requests);
+      p_ProfileCache->queueHeapSize -= std::min(requestsHeapSize, p_ProfileCache->queueHeapSize);
+      if ((m_QueueMaxSize > 0) && (p_ProfileCache->queueHeapSize < m_QueueMaxSize))
+      {
+        p_ProfileCache->queueSpaceCondVar.notify_all();
+      }
 
-        try
-        {
-          *m_Dbs[profileId] << "BEGIN;";
-          for (const auto& contactInfo : addContactsRequest->contactInfos)
-          {
-            *m_Dbs[profileId] << "INSERT INTO " + s_TableContacts + " "
-              "(id, name, phone, isSelf) VALUES "
-              "(?,?,?,?);" <<
-              contactInfo.id << contactInfo.name << contactInfo.phone << contactInfo.isSelf;
-          }
-          *m_Dbs[profileId] << "COMMIT;";
-        }
-        catch (const sqlite::sqlite_exception& ex)
-        {
-          HANDLE_SQLITE_EXCEPTION(ex);
-        }
+      PerfStats::Add(PerfStats::StatCacheQueueDepth, -(int64_t)requests.size());
+      PerfStats::Add(PerfStats::StatHeapCacheQueues, -requestsHeapSize);
+    }
+
+    // requests are dequeued in order, so the batch is done up to its last one
+    const uint64_t batchSeq = requests.empty() ? 0 : requests.back()->seq;
+    CoalesceRequests(*p_ProfileCache, requests);
+
+    // consecutive write requests are committed in a single transaction
+    std::vector<std::shared_ptr<Request>> writeRequests;
+    for (auto& request : requests)
+    {
+      if (IsWriteRequest(request))
+      {
+        writeRequests.push_back(request);
       }
-      break;
+      else
+      {
+        PerformWriteRequests(*p_ProfileCache, writeRequests);
+        writeRequests.clear();
+        PerformRequest(request);
+      }
+    }
+
+    PerformWriteRequests(*p_ProfileCache, writeRequests);
+    SetProcessed(*p_ProfileCache, batchSeq);
+  }
+}
+
+void MessageCache::SetProcessed(ProfileCache& p_ProfileCache, uint64_t p_Seq)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.queueMutex);
+  p_ProfileCache.processedSeq = std::max(p_ProfileCache.processedSeq, p_Seq);
+  for (auto it = p_ProfileCache.chatWriteSeqs.begin(); it != p_ProfileCache.chatWriteSeqs.end();
+       /* incremented in loop */)
+  {
+    if (it->second <= p_ProfileCache.processedSeq)
+    {
+      it = p_ProfileCache.chatWriteSeqs.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void MessageCache::PerformShutdownFlush(ProfileCache& p_ProfileCache, std::vector<std::shared_ptr<Request>>& p_Requests,
+                                        int64_t p_StopTime)
+{
+  // pending reads have no one left to notify, pending writes are committed in one transaction
+  // unless the worker was busy past the deadline, then they are dropped and resynced next start
+  std::vector<std::shared_ptr<Request>> writeRequests;
+  std::copy_if(p_Requests.begin(), p_Requests.end(), std::back_inserter(writeRequests), IsWriteRequest);
+  if (writeRequests.empty()) return;
+
+  const int64_t startTime = TimeUtil::GetCurrentTimeMSec();
+  if ((startTime - p_StopTime) > s_ShutdownFlushTimeoutMs)
+  {
+    LOG_WARNING("cache %s shutdown flush timeout, dropping %d writes", p_ProfileCache.profileId.c_str(),
+                writeRequests.size());
+    return;
+  }
+
+  const size_t count = writeRequests.size();
+  CoalesceRequests(p_ProfileCache, writeRequests);
+  PerformWriteRequests(p_ProfileCache, writeRequests);
+  LOG_INFO("cache %s shutdown flushed %d writes in %d ms", p_ProfileCache.profileId.c_str(), count,
+           TimeUtil::GetCurrentTimeMSec() - startTime);
+}
+
+void MessageCache::EnqueueRequest(std::shared_ptr<Request> p_Request)
+{
+  if (m_ReadOnly && IsWriteRequest(p_Request)) return;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_Request->profileId);
+  if (!cache) return;
+
+  const size_t heapSize = GetRequestHeapSize(*p_Request);
+  std::unique_lock<std::mutex> lock(cache->queueMutex);
+  p_Request->seq = ++cache->enqueueSeq;
+  if (p_Request->GetRequestType() == AddMessagesRequestType)
+  {
+    cache->chatWriteSeqs[static_cast<const AddMessagesRequest&>(*p_Request).chatId] = p_Request->seq;
+  }
+
+  cache->queue.push_back(p_Request);
+  cache->queueHeapSize += heapSize;
+  PerfStats::Add(PerfStats::StatCacheQueueDepth, 1);
+  PerfStats::Add(PerfStats::StatHeapCacheQueues, heapSize);
+  cache->condVar.notify_one();
+}
+
+bool MessageCache::HasChatWrites(ProfileCache& p_ProfileCache, const std::string& p_ChatId)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.queueMutex);
+  return p_ProfileCache.chatWriteSeqs.count(p_ChatId) > 0;
+}
+
+bool MessageCache::WaitQueueSpace(const std::string& p_ProfileId, int p_TimeoutMs)
+{
+  // backpressure for bulk producers such as history sync, which call this before fetching or
+  // delivering more messages. the limit is soft, enqueueing itself never blocks, so ui thread
+  // requests and live updates are unaffected.
+  if (!m_CacheEnabled || (m_QueueMaxSize == 0)) return true;
+
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_ProfileId);
+  if (!cache) return true;
+
+  std::unique_lock<std::mutex> lock(cache->queueMutex);
+  // *INDENT-OFF*
+  const bool hasSpace = cache->queueSpaceCondVar.wait_for(lock, std::chrono::milliseconds(p_TimeoutMs), [&]()
+  {
+    return (cache->queueHeapSize < m_QueueMaxSize) || !cache->running;
+  });
+  // *INDENT-ON*
+  if (!hasSpace)
+  {
+    LOG_DEBUG("cache %s queue full %d bytes", p_ProfileId.c_str(), cache->queueHeapSize);
+  }
+
+  return hasSpace;
+}
+
+void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
+{
+  TraceSpan requestSpan("MessageCache::PerformRequest", "type", p_Request->GetRequestType());
+  std::shared_ptr<ProfileCache> cache = GetProfileCache(p_Request->profileId);
+  if (!cache) return;
+
+  if (IsWriteRequest(p_Request))
+  {
+    PerformWriteRequests(*cache, std::vector<std::shared_ptr<Request>>({ p_Request }));
+    return;
+  }
 
+  switch (p_Request->GetRequestType())
+  {
     case FetchChatsRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<FetchChatsRequest> fetchChatsRequest =
-          std::static_pointer_cast<FetchChatsRequest>(p_Request);
-        const std::string& profileId = fetchChatsRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+        const FetchChatsRequest& fetchChatsRequest = static_cast<const FetchChatsRequest&>(*p_Request);
+        const std::string& profileId = fetchChatsRequest.profileId;
 
-        const bool noFilter = fetchChatsRequest->chatIds.empty();
+        const bool noFilter = fetchChatsRequest.chatIds.empty();
         std::vector<ChatInfo> chatInfos;
         try
         {
           // *INDENT-OFF*
           std::map<std::string, int32_t> chatIdMuted;
-          *m_Dbs[profileId] << "SELECT id, isMuted FROM " + s_TableChats + ";" >>
+          GetReadStatement(*cache, "SELECT id, isMuted FROM " + s_TableChats + ";") >>
             [&](const std::string& chatId, int32_t isMuted)
             {
               chatIdMuted[chatId] = isMuted;
             };
 
-          *m_Dbs[profileId] << "SELECT chatId, MAX(timeSent), isOutgoing, isRead FROM messages "
-            "GROUP BY chatId;" >>
+          GetReadStatement(*cache, "SELECT c.id, MAX(m.timeSent), m.isOutgoing, m.isRead FROM messages m "
+                           "JOIN chatids c ON c.chatKey = m.chatKey GROUP BY m.chatKey;") >>
             [&](const std::string& chatId, int64_t timeSent, int32_t isOutgoing, int32_t isRead)
             {
-              if (noFilter || fetchChatsRequest->chatIds.count(chatId))
+              if (noFilter || fetchChatsRequest.chatIds.count(chatId))
               {
                 ChatInfo chatInfo;
                 chatInfo.id = chatId;
@@ -886,22 +2069,41 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
         newChatsNotify->success = true;
         newChatsNotify->chatInfos = chatInfos;
         CallMessageHandler(newChatsNotify);
+
+        const int snapshotChats = std::min<int>(fetchChatsRequest.snapshotChats, chatInfos.size());
+        if ((snapshotChats > 0) && (fetchChatsRequest.snapshotMessages > 0))
+        {
+          // *INDENT-OFF*
+          std::partial_sort(chatInfos.begin(), chatInfos.begin() + snapshotChats, chatInfos.end(),
+                            [](const ChatInfo& lhs, const ChatInfo& rhs)
+                            {
+                              return lhs.lastMessageTime > rhs.lastMessageTime;
+                            });
+          // *INDENT-ON*
+          std::vector<std::string> chatIds;
+          for (int i = 0; i < snapshotChats; ++i)
+          {
+            chatIds.push_back(chatInfos[i].id);
+          }
+
+          FetchLatestForChats(profileId, chatIds, fetchChatsRequest.snapshotMessages, true /*p_Sync*/);
+
+          LOG_DEBUG("cache fetch snapshot %d chats", snapshotChats);
+        }
       }
       break;
 
     case FetchContactsRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<FetchContactsRequest> fetchContactsRequest =
-          std::static_pointer_cast<FetchContactsRequest>(p_Request);
-        const std::string& profileId = fetchContactsRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+        const FetchContactsRequest& fetchContactsRequest = static_cast<const FetchContactsRequest&>(*p_Request);
+        const std::string& profileId = fetchContactsRequest.profileId;
 
         std::vector<ContactInfo> contactInfos;
         try
         {
           // *INDENT-OFF*
-          *m_Dbs[profileId] << "SELECT id, name, phone, isSelf FROM " + s_TableContacts + ";" >>
+          GetReadStatement(*cache, "SELECT id, name, phone, isSelf FROM " + s_TableContacts + ";") >>
             [&](const std::string& id, const std::string& name, const std::string& phone, int32_t isSelf)
             {
               ContactInfo contactInfo;
@@ -930,78 +2132,151 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
 
     case FetchMessagesFromRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<FetchMessagesFromRequest> fetchFromRequest =
-          std::static_pointer_cast<FetchMessagesFromRequest>(p_Request);
-        const std::string& profileId = fetchFromRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const FetchMessagesFromRequest& fetchFromRequest = static_cast<const FetchMessagesFromRequest&>(*p_Request);
+        const std::string& profileId = fetchFromRequest.profileId;
 
-        const std::string& chatId = fetchFromRequest->chatId;
-        const std::string& fromMsgId = fetchFromRequest->fromMsgId;
-        const int limit = fetchFromRequest->limit;
+        const std::string& chatId = fetchFromRequest.chatId;
+        const std::string& fromMsgId = fetchFromRequest.fromMsgId;
+        const int limit = fetchFromRequest.limit;
 
-        int64_t fromMsgIdTimeSent = 0;
-        if (!fromMsgId.empty())
+        std::vector<ChatMessage> chatMessages;
+        if (GetMemoryPage(profileId, chatId, fromMsgId, limit, chatMessages))
+        {
+          LOG_DEBUG("cache memory fetch from %s %s %d %d", chatId.c_str(), fromMsgId.c_str(), limit,
+                    chatMessages.size());
+        }
+        else
         {
+          const uint64_t generation = GetMemoryGeneration();
+          std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+          int64_t fromMsgIdTimeSent = 0;
+          int64_t fromMsgIdSequence = 0;
           try
           {
-            // *INDENT-OFF*
-            *m_Dbs[profileId] << "SELECT timeSent FROM messages WHERE chatId = ? AND id = ?;" <<
-              chatId << fromMsgId >>
-              [&](const int64_t& timeSent)
-              {
-                fromMsgIdTimeSent = timeSent;
-              };
-            // *INDENT-ON*
+            GetFromMsgIdKey(*cache, chatId, fromMsgId, fromMsgIdTimeSent, fromMsgIdSequence);
           }
           catch (const sqlite::sqlite_exception& ex)
           {
             HANDLE_SQLITE_EXCEPTION(ex);
           }
+
+          PerformFetchMessagesFrom(*cache, chatId, fromMsgIdTimeSent, fromMsgIdSequence, fromMsgId, limit,
+                                   chatMessages);
+          lock.unlock();
+
+          MergeArchivedMessages(*cache, chatId, fromMsgIdTimeSent, fromMsgIdSequence, fromMsgId, limit, chatMessages);
+          LOG_DEBUG("cache fetch from %s %s %d %d", chatId.c_str(), fromMsgId.c_str(), limit, chatMessages.size());
+
+          PutMemoryPage(profileId, chatId, fromMsgId, limit, chatMessages, generation);
         }
-        else
-        {
-          fromMsgIdTimeSent = std::numeric_limits<int64_t>::max();
-        }
-
-        std::vector<ChatMessage> chatMessages;
-        PerformFetchMessagesFrom(profileId, chatId, fromMsgIdTimeSent, limit, chatMessages);
-        LOG_DEBUG("cache fetch from %s %s %d %d", chatId.c_str(), fromMsgId.c_str(), limit, chatMessages.size());
-        lock.unlock();
 
         std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(profileId);
         newMessagesNotify->success = true;
         newMessagesNotify->chatId = chatId;
-        newMessagesNotify->chatMessages = chatMessages;
+        newMessagesNotify->chatMessages = std::move(chatMessages);
         newMessagesNotify->fromMsgId = fromMsgId;
         newMessagesNotify->cached = true;
         newMessagesNotify->sequence = true; // in-sequence history request
-        CallMessageHandler(newMessagesNotify);
+        for (const auto& chunk : ProtocolUtil::SplitMessagesNotify(newMessagesNotify))
+        {
+          CallMessageHandler(chunk);
+        }
+      }
+      break;
+
+    case FetchLatestForChatsRequestType:
+      {
+        const FetchLatestForChatsRequest& fetchLatestRequest =
+          static_cast<const FetchLatestForChatsRequest&>(*p_Request);
+        const std::string& profileId = fetchLatestRequest.profileId;
+        const int limit = fetchLatestRequest.limit;
+
+        std::map<std::string, std::vector<ChatMessage>> chatMessages;
+        std::vector<std::string> dbChatIds;
+        for (const auto& chatId : fetchLatestRequest.chatIds)
+        {
+          if (!GetMemoryPage(profileId, chatId, "", limit, chatMessages[chatId]))
+          {
+            dbChatIds.push_back(chatId);
+          }
+        }
+
+        if (!dbChatIds.empty())
+        {
+          const uint64_t generation = GetMemoryGeneration();
+          std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+          PerformFetchLatestForChats(*cache, dbChatIds, limit, chatMessages);
+          lock.unlock();
+
+          // chats with a short page may have older messages archived
+          for (const auto& chatId : dbChatIds)
+          {
+            MergeArchivedMessages(*cache, chatId, std::numeric_limits<int64_t>::max(),
+                                  std::numeric_limits<int64_t>::max(), "", limit, chatMessages[chatId]);
+          }
+
+          for (const auto& chatId : dbChatIds)
+          {
+            PutMemoryPage(profileId, chatId, "", limit, chatMessages[chatId], generation);
+          }
+        }
+
+        LOG_DEBUG("cache fetch latest %d chats %d from db", fetchLatestRequest.chatIds.size(), dbChatIds.size());
+
+        // grouped per chat, as the ui tracks history requests and paging per chat
+        for (const auto& chatId : fetchLatestRequest.chatIds)
+        {
+          std::vector<ChatMessage>& messages = chatMessages[chatId];
+          if (messages.empty()) continue;
+
+          std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(profileId);
+          newMessagesNotify->success = true;
+          newMessagesNotify->chatId = chatId;
+          newMessagesNotify->chatMessages = std::move(messages);
+          newMessagesNotify->cached = true;
+          newMessagesNotify->sequence = true; // in-sequence history request
+          for (const auto& chunk : ProtocolUtil::SplitMessagesNotify(newMessagesNotify))
+          {
+            CallMessageHandler(chunk);
+          }
+        }
       }
       break;
 
     case FetchOneMessageRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<FetchOneMessageRequest> fetchOneRequest =
-          std::static_pointer_cast<FetchOneMessageRequest>(p_Request);
-        const std::string& profileId = fetchOneRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const FetchOneMessageRequest& fetchOneRequest = static_cast<const FetchOneMessageRequest&>(*p_Request);
+        const std::string& profileId = fetchOneRequest.profileId;
 
-        const std::string& chatId = fetchOneRequest->chatId;
-        const std::string& msgId = fetchOneRequest->msgId;
+        const std::string& chatId = fetchOneRequest.chatId;
+        const std::string& msgId = fetchOneRequest.msgId;
 
         std::vector<ChatMessage> chatMessages;
-        PerformFetchOneMessage(profileId, chatId, msgId, chatMessages);
-        LOG_DEBUG("cache fetch one %s %s %d", chatId.c_str(), msgId.c_str(), chatMessages.size());
-        lock.unlock();
+        if (GetMemoryMessage(profileId, chatId, msgId, chatMessages))
+        {
+          LOG_DEBUG("cache memory fetch one %s %s", chatId.c_str(), msgId.c_str());
+        }
+        else
+        {
+          const uint64_t generation = GetMemoryGeneration();
+          std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+          PerformFetchOneMessage(*cache, chatId, msgId, chatMessages);
+          std::vector<std::tuple<std::string, std::string, size_t>> archivedLocations;
+          LocateArchivedMessages(*cache, chatId, std::vector<std::string>(1, msgId), chatMessages, archivedLocations);
+          lock.unlock();
+
+          GetArchivedMessages(*cache, archivedLocations, chatMessages);
+          LOG_DEBUG("cache fetch one %s %s %d", chatId.c_str(), msgId.c_str(), chatMessages.size());
+
+          PutMemoryMessages(profileId, chatId, chatMessages, generation);
+        }
 
         if (!chatMessages.empty())
         {
           std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(profileId);
           newMessagesNotify->success = true;
           newMessagesNotify->chatId = chatId;
-          newMessagesNotify->chatMessages = chatMessages;
+          newMessagesNotify->chatMessages = std::move(chatMessages);
           newMessagesNotify->cached = true;
           newMessagesNotify->sequence = false; // out-of-sequence single message
           CallMessageHandler(newMessagesNotify);
@@ -1009,20 +2284,335 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
       }
       break;
 
+    case FetchMessagesRequestType:
+      {
+        const FetchMessagesRequest& fetchMessagesRequest = static_cast<const FetchMessagesRequest&>(*p_Request);
+        const std::string& profileId = fetchMessagesRequest.profileId;
+        const std::string& chatId = fetchMessagesRequest.chatId;
+
+        std::vector<ChatMessage> chatMessages;
+        std::vector<std::string> dbMsgIds;
+        for (const auto& msgId : fetchMessagesRequest.msgIds)
+        {
+          if (!GetMemoryMessage(profileId, chatId, msgId, chatMessages))
+          {
+            dbMsgIds.push_back(msgId);
+          }
+        }
+
+        if (!dbMsgIds.empty())
+        {
+          const uint64_t generation = GetMemoryGeneration();
+          std::vector<ChatMessage> dbChatMessages;
+          std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+          PerformFetchMessages(*cache, chatId, dbMsgIds, dbChatMessages);
+          std::vector<std::tuple<std::string, std::string, size_t>> archivedLocations;
+          LocateArchivedMessages(*cache, chatId, dbMsgIds, dbChatMessages, archivedLocations);
+          lock.unlock();
+
+          GetArchivedMessages(*cache, archivedLocations, dbChatMessages);
+
+          PutMemoryMessages(profileId, chatId, dbChatMessages, generation);
+          chatMessages.insert(chatMessages.end(), dbChatMessages.begin(), dbChatMessages.end());
+        }
+
+        LOG_DEBUG("cache fetch %s %d of %d", chatId.c_str(), chatMessages.size(), fetchMessagesRequest.msgIds.size());
+        if (!chatMessages.empty())
+        {
+          std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(profileId);
+          newMessagesNotify->success = true;
+          newMessagesNotify->chatId = chatId;
+          newMessagesNotify->chatMessages = std::move(chatMessages);
+          newMessagesNotify->cached = true;
+          newMessagesNotify->sequence = false; // out-of-sequence messages
+          CallMessageHandler(newMessagesNotify);
+        }
+      }
+      break;
+
+    case FetchChatUnreadsRequestType:
+      {
+        const FetchChatUnreadsRequest& fetchChatUnreadsRequest =
+          static_cast<const FetchChatUnreadsRequest&>(*p_Request);
+        std::shared_ptr<ChatUnreadNotify> chatUnreadNotify =
+          std::make_shared<ChatUnreadNotify>(fetchChatUnreadsRequest.profileId);
+        std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+        PerformFetchChatUnreads(*cache, fetchChatUnreadsRequest.chatIds, chatUnreadNotify->chatUnreadInfos);
+        lock.unlock();
+
+        LOG_DEBUG("cache fetch unreads %d chats", chatUnreadNotify->chatUnreadInfos.size());
+        CallMessageHandler(chatUnreadNotify);
+      }
+      break;
+
+    case SearchRequestType:
+      {
+        std::unique_lock<std::mutex> lock(GetReadMutex(*cache));
+        const SearchRequest& searchRequest = static_cast<const SearchRequest&>(*p_Request);
+        const std::string& profileId = searchRequest.profileId;
+
+        const std::string& matchQuery = GetSearchMatchQuery(searchRequest.query);
+        std::vector<std::pair<std::string, ChatMessage>> chatMessages;
+        std::vector<std::tuple<std::string, std::string, size_t>> archivedMatches; // chat id, id, block offset
+        bool success = true;
+        if (!matchQuery.empty())
+        {
+          try
+          {
+            // *INDENT-OFF*
+            GetReadStatement(*cache,
+              "SELECT c.id, m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+              "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+              "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM messages_fts "
+              "JOIN messages m ON m.msgKey = messages_fts.rowid "
+              "JOIN chatids c ON c.chatKey = m.chatKey "
+              "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+              "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+              "WHERE messages_fts MATCH ? ORDER BY rank LIMIT ?;")
+              << matchQuery << searchRequest.limit >>
+              [&](const std::string& chatId, const std::string& id, const std::string& senderId,
+                  const std::string& text, const std::string& quotedId, const std::string& quotedText,
+                  const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+                  const std::string& fileId, const std::string& filePath, const std::string& fileType,
+                  int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
+              {
+                ChatMessage chatMessage;
+                chatMessage.id = id;
+                chatMessage.senderId = senderId;
+                chatMessage.text = text;
+                chatMessage.quotedId = quotedId;
+                chatMessage.quotedText = quotedText;
+                chatMessage.quotedSender = quotedSender;
+                chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
+                chatMessage.timeSent = timeSent;
+                chatMessage.sequence = sequence;
+                chatMessage.isOutgoing = isOutgoing;
+                chatMessage.isRead = isRead;
+
+                chatMessages.push_back(std::make_pair(chatId, chatMessage));
+              };
+
+            // archived matches rank after cached ones, their ranks are not comparable
+            const int archiveLimit = searchRequest.limit - static_cast<int>(chatMessages.size());
+            if (archiveLimit > 0)
+            {
+              GetReadStatement(*cache,
+                "SELECT c.id, a.id, a.blockOffset FROM archive_fts "
+                "JOIN archiveids a ON a.archiveKey = archive_fts.rowid "
+                "JOIN chatids c ON c.chatKey = a.chatKey "
+                "WHERE archive_fts MATCH ? AND a.removed = 0 ORDER BY rank LIMIT ?;")
+                << matchQuery << archiveLimit >>
+                [&](const std::string& chatId, const std::string& id, int64_t blockOffset)
+                {
+                  archivedMatches.push_back(std::make_tuple(chatId, id, static_cast<size_t>(blockOffset)));
+                };
+            }
+            // *INDENT-ON*
+          }
+          catch (const sqlite::sqlite_exception& ex)
+          {
+            // malformed match expressions are reported to caller, not treated as fatal
+            LOG_WARNING("cache search failed %d: %s", ex.get_code(), ex.what());
+            success = false;
+          }
+        }
+
+        lock.unlock();
+        GetArchivedMessages(*cache, archivedMatches, chatMessages);
+        LOG_DEBUG("cache search %d %d", searchRequest.limit, chatMessages.size());
+
+        std::shared_ptr<SearchMessagesNotify> searchMessagesNotify =
+          std::make_shared<SearchMessagesNotify>(profileId);
+        searchMessagesNotify->success = success;
+        searchMessagesNotify->query = searchRequest.query;
+        searchMessagesNotify->chatMessages = std::move(chatMessages);
+        CallMessageHandler(searchMessagesNotify);
+      }
+      break;
+
+    default:
+      {
+        LOG_WARNING("cache unknown request type %d", p_Request->GetRequestType());
+      }
+      break;
+  }
+}
+
+// must be called with lock held, within a transaction
+void MessageCache::PerformWriteRequest(ProfileCache& p_ProfileCache, std::shared_ptr<Request> p_Request)
+{
+  switch (p_Request->GetRequestType())
+  {
+    case AddMessagesRequestType:
+      {
+        const AddMessagesRequest& addMessagesRequest = static_cast<const AddMessagesRequest&>(*p_Request);
+
+        const std::string& chatId = addMessagesRequest.chatId;
+        const std::string& fromMsgId = addMessagesRequest.fromMsgId;
+        const size_t messageCount = addMessagesRequest.GetMessageCount();
+        LOG_DEBUG("cache add %s %s %d", chatId.c_str(), fromMsgId.c_str(), messageCount);
+
+        MigrateLegacyChat(p_ProfileCache, chatId, 0);
+
+        if (!IsInSync(p_ProfileCache, chatId))
+        {
+          if (messageCount > 0)
+          {
+            bool inSync = false;
+            try
+            {
+              sqlite::database_binder& existsStmt =
+                GetStatement(p_ProfileCache, "SELECT EXISTS (SELECT 1 FROM messages WHERE "
+                             "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?);");
+              for (const auto& chatMessageBatch : addMessagesRequest.chatMessageBatches)
+              {
+                for (const auto& msg : *chatMessageBatch)
+                {
+                  // *INDENT-OFF*
+                  existsStmt << chatId << msg.id >>
+                    [&](const int& existsRes)
+                    {
+                      inSync = existsRes;
+                    };
+                  // *INDENT-ON*
+
+                  if (inSync) break;
+
+                  existsStmt.reset();
+                }
+
+                if (inSync) break;
+              }
+            }
+            catch (const sqlite::sqlite_exception& ex)
+            {
+              HANDLE_SQLITE_EXCEPTION(ex);
+            }
+
+            if (inSync)
+            {
+              SetInSync(p_ProfileCache, chatId);
+              LOG_DEBUG("cache in sync %s", chatId.c_str());
+            }
+            else
+            {
+              LOG_DEBUG("cache not in sync %s", chatId.c_str());
+            }
+          }
+        }
+
+        try
+        {
+          if (messageCount > 0)
+          {
+            (GetStatement(p_ProfileCache, s_SqlInsertChatId) << chatId).execute();
+          }
+
+          for (const auto& chatMessageBatch : addMessagesRequest.chatMessageBatches)
+          {
+            for (const auto& msg : *chatMessageBatch)
+            {
+              InsertMessage(p_ProfileCache, chatId, msg);
+            }
+          }
+
+          // archived messages added again, e.g. when edited, are superseded by their copy in db
+          if ((messageCount > 0) && !GetArchive(p_ProfileCache, chatId)->IsEmpty())
+          {
+            sqlite::database_binder& removeStmt =
+              GetStatement(p_ProfileCache, "UPDATE archiveids SET removed = 1 WHERE "
+                           "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? AND removed = 0;");
+            for (const auto& chatMessageBatch : addMessagesRequest.chatMessageBatches)
+            {
+              for (const auto& msg : *chatMessageBatch)
+              {
+                removeStmt.reset();
+                (removeStmt << chatId << msg.id).execute();
+              }
+            }
+          }
+
+          UpdateSyncWatermark(p_ProfileCache, chatId, addMessagesRequest);
+        }
+        catch (const sqlite::sqlite_exception& ex)
+        {
+          HANDLE_SQLITE_EXCEPTION(ex);
+        }
+      }
+      break;
+
+    case AddChatsRequestType:
+      {
+        const AddChatsRequest& addChatsRequest = static_cast<const AddChatsRequest&>(*p_Request);
+
+        LOG_DEBUG("cache add chats %d", addChatsRequest.chatInfos.size());
+
+        if (addChatsRequest.chatInfos.empty()) return;
+
+        try
+        {
+          // full chat lists are resent on login, so rows are only replaced when changed
+          sqlite::database_binder& insertStmt = GetStatement(p_ProfileCache, "INSERT INTO " + s_TableChats + " "
+            "(id, isMuted) SELECT ?, ? WHERE NOT EXISTS "
+            "(SELECT 1 FROM " + s_TableChats + " WHERE id = ? AND isMuted IS ?);");
+          for (const auto& chatInfo : addChatsRequest.chatInfos)
+          {
+            insertStmt.reset();
+            insertStmt << chatInfo.id << chatInfo.isMuted << chatInfo.id << chatInfo.isMuted;
+            insertStmt.execute();
+          }
+        }
+        catch (const sqlite::sqlite_exception& ex)
+        {
+          HANDLE_SQLITE_EXCEPTION(ex);
+        }
+      }
+      break;
+
+    case AddContactsRequestType:
+      {
+        const AddContactsRequest& addContactsRequest = static_cast<const AddContactsRequest&>(*p_Request);
+
+        LOG_DEBUG("cache add contacts %d", addContactsRequest.contactInfos.size());
+
+        if (addContactsRequest.contactInfos.empty()) return;
+
+        try
+        {
+          // full contact lists are resent on login, so rows are only replaced when changed
+          sqlite::database_binder& insertStmt = GetStatement(p_ProfileCache, "INSERT INTO " + s_TableContacts + " "
+            "(id, name, phone, isSelf) SELECT ?, ?, ?, ? WHERE NOT EXISTS "
+            "(SELECT 1 FROM " + s_TableContacts + " WHERE id = ? AND name IS ? AND phone IS ? AND isSelf IS ?);");
+          for (const auto& contactInfo : addContactsRequest.contactInfos)
+          {
+            insertStmt.reset();
+            insertStmt << contactInfo.id << contactInfo.name << contactInfo.phone << contactInfo.isSelf
+                       << contactInfo.id << contactInfo.name << contactInfo.phone << contactInfo.isSelf;
+            insertStmt.execute();
+          }
+        }
+        catch (const sqlite::sqlite_exception& ex)
+        {
+          HANDLE_SQLITE_EXCEPTION(ex);
+        }
+      }
+      break;
+
     case DeleteOneMessageRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<DeleteOneMessageRequest> deleteOneMessageRequest =
-          std::static_pointer_cast<DeleteOneMessageRequest>(p_Request);
-        const std::string& profileId = deleteOneMessageRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const DeleteOneMessageRequest& deleteOneMessageRequest =
+          static_cast<const DeleteOneMessageRequest&>(*p_Request);
 
-        const std::string& chatId = deleteOneMessageRequest->chatId;
-        const std::string& msgId = deleteOneMessageRequest->msgId;
+        const std::string& chatId = deleteOneMessageRequest.chatId;
+        const std::string& msgId = deleteOneMessageRequest.msgId;
 
         try
         {
-          *m_Dbs[profileId] << "DELETE FROM messages WHERE chatId = ? AND id = ?;" << chatId << msgId;
+          MigrateLegacyChat(p_ProfileCache, chatId, 0);
+          (GetStatement(p_ProfileCache, "DELETE FROM messages WHERE "
+                        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;") << chatId << msgId).execute();
+          (GetStatement(p_ProfileCache, "UPDATE archiveids SET removed = 1 WHERE "
+                        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;") << chatId << msgId).execute();
         }
         catch (const sqlite::sqlite_exception& ex)
         {
@@ -1035,45 +2625,61 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
 
     case DeleteOneChatRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<DeleteOneChatRequest> deleteChatRequest =
-          std::static_pointer_cast<DeleteOneChatRequest>(p_Request);
-        const std::string& profileId = deleteChatRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const DeleteOneChatRequest& deleteChatRequest = static_cast<const DeleteOneChatRequest&>(*p_Request);
 
-        const std::string& chatId = deleteChatRequest->chatId;
+        const std::string& chatId = deleteChatRequest.chatId;
 
         try
         {
-          *m_Dbs[profileId] << "DELETE FROM messages WHERE chatId = ?;" << chatId;
-
-          *m_Dbs[profileId] << "DELETE FROM " + s_TableChats + " WHERE id = ?;" << chatId;
+          // messages are detached by retiring the chat key, a chat recreated with the same id, or any
+          // new chat, gets a new key, see s_SqlInsertChatId. they are purged in batches when idle
+          // instead of in one long transaction
+          static const bool deleteAttachments = AppConfig::GetBool("cache_delete_chat_attachments");
+          MigrateLegacyChat(p_ProfileCache, chatId, 0);
+          (GetStatement(p_ProfileCache, "INSERT OR REPLACE INTO chatpurges "
+                        "(chatKey, chatId, timeDeleted, purgeAttachments) "
+                        "SELECT chatKey, id, ?, ? FROM chatids WHERE id = ?;") <<
+           (TimeUtil::GetCurrentTimeMSec() / 1000) << (int)deleteAttachments << chatId).execute();
+          p_ProfileCache.purgePending = true;
+
+          (GetStatement(p_ProfileCache, "DELETE FROM chatids WHERE id = ?;") << chatId).execute();
+
+          (GetStatement(p_ProfileCache, "DELETE FROM " + s_TableChats + " WHERE id = ?;") << chatId).execute();
+
+          (GetStatement(p_ProfileCache, "DELETE FROM syncwatermarks WHERE chatId = ?;") << chatId).execute();
         }
         catch (const sqlite::sqlite_exception& ex)
         {
           HANDLE_SQLITE_EXCEPTION(ex);
         }
 
+        GetArchive(p_ProfileCache, chatId)->Remove();
+
+        {
+          std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+          p_ProfileCache.syncWatermarks.erase(chatId);
+        }
+
         LOG_DEBUG("cache delete %s", chatId.c_str());
       }
       break;
 
     case UpdateMessageIsReadRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<UpdateMessageIsReadRequest> updateIsReadRequest =
-          std::static_pointer_cast<UpdateMessageIsReadRequest>(p_Request);
-        const std::string& profileId = updateIsReadRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const UpdateMessageIsReadRequest& updateIsReadRequest =
+          static_cast<const UpdateMessageIsReadRequest&>(*p_Request);
 
-        const std::string& chatId = updateIsReadRequest->chatId;
-        const std::string& msgId = updateIsReadRequest->msgId;
-        bool isRead = updateIsReadRequest->isRead;
+        const std::string& chatId = updateIsReadRequest.chatId;
+        const std::string& msgId = updateIsReadRequest.msgId;
+        bool isRead = updateIsReadRequest.isRead;
 
         try
         {
-          *m_Dbs[profileId] << "UPDATE messages SET isRead = ? WHERE chatId = ? AND id = ?;" << (int)isRead << chatId <<
-            msgId;
+          MigrateLegacyChat(p_ProfileCache, chatId, 0);
+          RestoreArchivedMessage(p_ProfileCache, chatId, msgId);
+          (GetStatement(p_ProfileCache, "UPDATE messages SET isRead = ? WHERE "
+                        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;") << (int)isRead <<
+           chatId << msgId).execute();
         }
         catch (const sqlite::sqlite_exception& ex)
         {
@@ -1084,22 +2690,52 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
       }
       break;
 
+    case UpdateMessagesIsReadRequestType:
+      {
+        const UpdateMessagesIsReadRequest& updateIsReadRequest =
+          static_cast<const UpdateMessagesIsReadRequest&>(*p_Request);
+
+        const std::string& chatId = updateIsReadRequest.chatId;
+        const std::string& msgId = updateIsReadRequest.msgId;
+
+        try
+        {
+          // received or sent messages up to and including the high-watermark message are marked read
+          MigrateLegacyChat(p_ProfileCache, chatId, 0);
+          (GetStatement(p_ProfileCache, "UPDATE messages SET isRead = 1 WHERE "
+                        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND isOutgoing = ? AND isRead = 0 "
+                        "AND timeSent <= (SELECT timeSent FROM messages WHERE "
+                        "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?);") <<
+           chatId << (int32_t)updateIsReadRequest.isOutgoing << chatId << msgId).execute();
+        }
+        catch (const sqlite::sqlite_exception& ex)
+        {
+          HANDLE_SQLITE_EXCEPTION(ex);
+        }
+
+        LOG_DEBUG("cache update read up to %s %s %d", chatId.c_str(), msgId.c_str(),
+                  updateIsReadRequest.isOutgoing);
+      }
+      break;
+
     case UpdateMessageFileInfoRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<UpdateMessageFileInfoRequest> updateMessageFileInfoRequest =
-          std::static_pointer_cast<UpdateMessageFileInfoRequest>(p_Request);
-        const std::string& profileId = updateMessageFileInfoRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const UpdateMessageFileInfoRequest& updateMessageFileInfoRequest =
+          static_cast<const UpdateMessageFileInfoRequest&>(*p_Request);
 
-        const std::string& chatId = updateMessageFileInfoRequest->chatId;
-        const std::string& msgId = updateMessageFileInfoRequest->msgId;
-        const std::string& fileInfo = updateMessageFileInfoRequest->fileInfo;
+        const std::string& chatId = updateMessageFileInfoRequest.chatId;
+        const std::string& msgId = updateMessageFileInfoRequest.msgId;
+        const std::string& fileInfo = updateMessageFileInfoRequest.fileInfo;
 
         try
         {
-          *m_Dbs[profileId] << "UPDATE messages SET fileInfo = ? WHERE chatId = ? AND id = ?;"
-                            << fileInfo << chatId << msgId;
+          MigrateLegacyChat(p_ProfileCache, chatId, 0);
+          const FileInfo& fileColumns = fileInfo.empty() ? FileInfo() : ProtocolUtil::FileInfoFromHex(fileInfo);
+          std::unique_ptr<int> fileStatus(fileInfo.empty() ? nullptr : new int(fileColumns.fileStatus));
+          RestoreArchivedMessage(p_ProfileCache, chatId, msgId);
+          (GetStatement(p_ProfileCache, "UPDATE messages SET fileStatus = ?, fileId = ?, filePath = ?, fileType = ? "
+                        "WHERE chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;")
+           << fileStatus << fileColumns.fileId << fileColumns.filePath << fileColumns.fileType << chatId << msgId).execute();
         }
         catch (const sqlite::sqlite_exception& ex)
         {
@@ -1112,21 +2748,16 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
 
     case UpdateMuteRequestType:
       {
-        std::unique_lock<std::mutex> lock(m_DbMutex);
-        std::shared_ptr<UpdateMuteRequest> updateMuteRequest =
-          std::static_pointer_cast<UpdateMuteRequest>(p_Request);
-        const std::string& profileId = updateMuteRequest->profileId;
-        if (!m_Dbs[profileId]) return;
+        const UpdateMuteRequest& updateMuteRequest = static_cast<const UpdateMuteRequest&>(*p_Request);
 
-        const std::string& chatId = updateMuteRequest->chatId;
-        bool isMuted = updateMuteRequest->isMuted;
+        const std::string& chatId = updateMuteRequest.chatId;
+        bool isMuted = updateMuteRequest.isMuted;
 
         try
         {
-          *m_Dbs[profileId] << "INSERT INTO " + s_TableChats + " "
-            "(id, isMuted) VALUES "
-            "(?, ?);" <<
-            chatId << isMuted;
+          (GetStatement(p_ProfileCache, "INSERT INTO " + s_TableChats + " "
+                        "(id, isMuted) VALUES "
+                        "(?, ?);") << chatId << isMuted).execute();
         }
         catch (const sqlite::sqlite_exception& ex)
         {
@@ -1137,29 +2768,111 @@ void MessageCache::PerformRequest(std::shared_ptr<Request> p_Request)
       }
       break;
 
+    case UpdateAttachmentRequestType:
+      {
+        const UpdateAttachmentRequest& updateAttachmentRequest =
+          static_cast<const UpdateAttachmentRequest&>(*p_Request);
+
+        const std::string& chatId = updateAttachmentRequest.chatId;
+        const std::string& filePath = updateAttachmentRequest.filePath;
+        if (updateAttachmentRequest.isAccess && !IsAttachmentIndexed(filePath)) break;
+
+        const ssize_t size = FileUtil::GetFileSize(filePath);
+        if (size < 0) break;
+
+        AttachmentEntry attachmentEntry;
+        attachmentEntry.profileId = p_ProfileCache.profileId;
+        attachmentEntry.chatId = chatId;
+        attachmentEntry.size = size;
+        attachmentEntry.lastAccess = TimeUtil::GetCurrentTimeMSec() / 1000;
+
+        try
+        {
+          (GetStatement(p_ProfileCache, "INSERT OR REPLACE INTO attachments "
+                        "(path, chatId, size, lastAccess) VALUES "
+                        "(?, ?, ?, ?);") << filePath << chatId << attachmentEntry.size <<
+           attachmentEntry.lastAccess).execute();
+        }
+        catch (const sqlite::sqlite_exception& ex)
+        {
+          HANDLE_SQLITE_EXCEPTION(ex);
+        }
+
+        {
+          std::unique_lock<std::mutex> lock(m_AttachmentMutex);
+          m_Attachments[filePath] = attachmentEntry;
+        }
+
+        LOG_DEBUG("cache update attachment %s %s %d", chatId.c_str(), filePath.c_str(), size);
+      }
+      break;
+
     default:
       {
-        LOG_WARNING("cache unknown request type %d", p_Request->GetRequestType());
+        LOG_WARNING("cache unknown write request type %d", p_Request->GetRequestType());
       }
       break;
   }
 }
 
-void MessageCache::PerformFetchMessagesFrom(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                            const int64_t p_FromMsgIdTimeSent, const int p_Limit,
+void MessageCache::PerformWriteRequests(ProfileCache& p_ProfileCache,
+                                        const std::vector<std::shared_ptr<Request>>& p_Requests)
+{
+  if (p_Requests.empty()) return;
+
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return;
+
+  try
+  {
+    PerfTimer commitTimer(PerfStats::StatCacheCommitUs);
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    for (auto& request : p_Requests)
+    {
+      PerformWriteRequest(p_ProfileCache, request);
+    }
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  // update memory after commit, so concurrent readers cannot store stale data
+  for (auto& request : p_Requests)
+  {
+    UpdateMemory(request);
+  }
+
+  LOG_TRACE("cache committed %d requests", p_Requests.size());
+}
+
+void MessageCache::PerformFetchMessagesFrom(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                            const int64_t p_FromMsgIdTimeSent, const int64_t p_FromMsgIdSequence,
+                                            const std::string& p_FromMsgId, const int p_Limit,
                                             std::vector<ChatMessage>& p_ChatMessages)
 {
   try
   {
+    // keyset pagination on (timeSent, sequence, id), served by messages_chatKey_timeSent index
     // *INDENT-OFF*
-    *m_Dbs[p_ProfileId] <<
-      "SELECT id, senderId, text, quotedId, quotedText, quotedSender, fileInfo, timeSent, "
-      "isOutgoing, isRead FROM messages WHERE chatId = ? AND timeSent < ? "
-      "ORDER BY timeSent DESC LIMIT ?;" << p_ChatId << p_FromMsgIdTimeSent << p_Limit >>
+    GetReadStatement(p_ProfileCache,
+      "SELECT m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+      "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+      "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM messages m "
+      "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+      "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+      "WHERE m.chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND "
+      "(m.timeSent < ? OR (m.timeSent = ? AND (m.sequence < ? OR (m.sequence = ? AND m.id < ?)))) "
+      "ORDER BY m.timeSent DESC, m.sequence DESC, m.id DESC LIMIT ?;")
+      << p_ChatId << p_FromMsgIdTimeSent << p_FromMsgIdTimeSent << p_FromMsgIdSequence << p_FromMsgIdSequence
+      << p_FromMsgId << p_Limit >>
       [&](const std::string& id, const std::string& senderId, const std::string& text,
           const std::string& quotedId, const std::string& quotedText,
-          const std::string& quotedSender, const std::string& fileInfo,
-          int64_t timeSent, int32_t isOutgoing, int32_t isRead)
+          const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+          const std::string& fileId, const std::string& filePath, const std::string& fileType,
+          int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
       {
         ChatMessage chatMessage;
         chatMessage.id = id;
@@ -1168,8 +2881,9 @@ void MessageCache::PerformFetchMessagesFrom(const std::string& p_ProfileId, cons
         chatMessage.quotedId = quotedId;
         chatMessage.quotedText = quotedText;
         chatMessage.quotedSender = quotedSender;
-        chatMessage.fileInfo = fileInfo;
+        chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
         chatMessage.timeSent = timeSent;
+        chatMessage.sequence = sequence;
         chatMessage.isOutgoing = isOutgoing;
         chatMessage.isRead = isRead;
 
@@ -1183,20 +2897,201 @@ void MessageCache::PerformFetchMessagesFrom(const std::string& p_ProfileId, cons
   }
 }
 
-void MessageCache::PerformFetchOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                          const std::string& p_MsgId,
-                                          std::vector<ChatMessage>& p_ChatMessages)
+// does not access db, so may be called without lock held
+void MessageCache::GetArchivedMessages(ProfileCache& p_ProfileCache,
+                                       const std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations,
+                                       std::vector<std::pair<std::string, ChatMessage>>& p_ChatMessages)
 {
-  try
+  // each block is decoded once for all its messages, which are returned in the order located
+  std::map<std::pair<std::string, size_t>, std::set<std::string>> blockIds;
+  for (const auto& location : p_Locations)
   {
-    // *INDENT-OFF*
-    *m_Dbs[p_ProfileId] <<
-      "SELECT id, senderId, text, quotedId, quotedText, quotedSender, fileInfo, timeSent, "
-      "isOutgoing, isRead FROM messages WHERE chatId = ? AND id = ?;" << p_ChatId << p_MsgId >>
-      [&](const std::string& id, const std::string& senderId, const std::string& text,
+    blockIds[std::make_pair(std::get<0>(location), std::get<2>(location))].insert(std::get<1>(location));
+  }
+
+  std::map<std::pair<std::string, std::string>, ChatMessage> archivedMessages;
+  for (const auto& block : blockIds)
+  {
+    const std::string& chatId = block.first.first;
+    std::vector<ChatMessage> chatMessages;
+    GetArchive(p_ProfileCache, chatId)->GetBlockMessages(block.first.second, block.second, chatMessages);
+    for (auto& chatMessage : chatMessages)
+    {
+      const std::string id = chatMessage.id;
+      archivedMessages[std::make_pair(chatId, id)] = std::move(chatMessage);
+    }
+  }
+
+  for (const auto& location : p_Locations)
+  {
+    auto it = archivedMessages.find(std::make_pair(std::get<0>(location), std::get<1>(location)));
+    if (it != archivedMessages.end())
+    {
+      p_ChatMessages.push_back(std::make_pair(it->first.first, std::move(it->second)));
+      archivedMessages.erase(it);
+    }
+  }
+}
+
+// does not access db, so may be called without lock held
+void MessageCache::GetArchivedMessages(ProfileCache& p_ProfileCache,
+                                       const std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations,
+                                       std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::vector<std::pair<std::string, ChatMessage>> chatMessages;
+  GetArchivedMessages(p_ProfileCache, p_Locations, chatMessages);
+  for (auto& chatMessage : chatMessages)
+  {
+    p_ChatMessages.push_back(std::move(chatMessage.second));
+  }
+}
+
+// must be called without lock held, archive blocks are decoded without holding it
+void MessageCache::MergeArchivedMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                         const int64_t p_FromMsgIdTimeSent, const int64_t p_FromMsgIdSequence,
+                                         const std::string& p_FromMsgId, const int p_Limit,
+                                         std::vector<ChatMessage>& p_ChatMessages)
+{
+  // archived messages are merged in when db holds too few older messages, or may hold older ones
+  std::shared_ptr<MessageArchive> archive = GetArchive(p_ProfileCache, p_ChatId);
+  if ((p_Limit <= 0) || archive->IsEmpty()) return;
+
+  if ((static_cast<int>(p_ChatMessages.size()) >= p_Limit) &&
+      (archive->GetMaxTimeSent() < p_ChatMessages.back().timeSent)) return;
+
+  std::set<std::string> removedIds;
+  {
+    std::unique_lock<std::mutex> lock(GetReadMutex(p_ProfileCache));
+    try
+    {
+      // *INDENT-OFF*
+      GetReadStatement(p_ProfileCache, "SELECT id FROM archiveids WHERE "
+                       "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND removed = 1;") << p_ChatId >>
+        [&](const std::string& id)
+        {
+          removedIds.insert(id);
+        };
+      // *INDENT-ON*
+    }
+    catch (const sqlite::sqlite_exception& ex)
+    {
+      HANDLE_SQLITE_EXCEPTION(ex);
+    }
+  }
+
+  std::vector<ChatMessage> archivedMessages;
+  archive->GetMessagesBefore(p_FromMsgIdTimeSent, p_FromMsgIdSequence, p_FromMsgId,
+                             p_Limit + static_cast<int>(removedIds.size()), archivedMessages);
+  if (archivedMessages.empty()) return;
+
+  // messages both archived and in db remain after an interrupted archival batch, and may then be
+  // archived twice
+  std::set<std::string> msgIds = removedIds;
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    msgIds.insert(chatMessage.id);
+  }
+
+  for (auto& archivedMessage : archivedMessages)
+  {
+    if (msgIds.insert(archivedMessage.id).second)
+    {
+      p_ChatMessages.push_back(std::move(archivedMessage));
+    }
+  }
+
+  std::sort(p_ChatMessages.begin(), p_ChatMessages.end(), [](const ChatMessage& p_Lhs, const ChatMessage& p_Rhs)
+  {
+    return MessageArchive::IsBefore(p_Rhs, p_Lhs);
+  });
+
+  if (static_cast<int>(p_ChatMessages.size()) > p_Limit)
+  {
+    p_ChatMessages.resize(p_Limit);
+  }
+}
+
+void MessageCache::PerformFetchLatestForChats(ProfileCache& p_ProfileCache,
+                                              const std::vector<std::string>& p_ChatIds, const int p_Limit,
+                                              std::map<std::string, std::vector<ChatMessage>>& p_ChatMessages)
+{
+  try
+  {
+    // latest page of all chats in one statement, rows are numbered per chat on keys only, in
+    // messages_chatKey_timeSent order, and texts are only read for rows within the limit
+    static const std::string sql =
+      "SELECT c.id, m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+      "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+      "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM ("
+      "SELECT msgKey, ROW_NUMBER() OVER (PARTITION BY chatKey ORDER BY timeSent DESC, sequence DESC, id DESC) "
+      "AS rowNum FROM messages WHERE chatKey IN (SELECT chatKey FROM chatids WHERE id IN (" +
+      StrUtil::Join(std::vector<std::string>(s_InParamCount, "?"), ",") + "))) w "
+      "JOIN messages m ON m.msgKey = w.msgKey "
+      "JOIN chatids c ON c.chatKey = m.chatKey "
+      "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+      "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+      "WHERE w.rowNum <= ? ORDER BY m.chatKey, w.rowNum;";
+    for (const auto& chunk : GetInParamChunks(p_ChatIds))
+    {
+      sqlite::database_binder& fetchStmt = GetReadStatement(p_ProfileCache, sql);
+      for (const auto& chatId : chunk)
+      {
+        fetchStmt << chatId;
+      }
+
+      fetchStmt << p_Limit;
+
+      // *INDENT-OFF*
+      fetchStmt >>
+        [&](const std::string& chatId, const std::string& id, const std::string& senderId, const std::string& text,
+            const std::string& quotedId, const std::string& quotedText,
+            const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+            const std::string& fileId, const std::string& filePath, const std::string& fileType,
+            int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
+        {
+          ChatMessage chatMessage;
+          chatMessage.id = id;
+          chatMessage.senderId = senderId;
+          chatMessage.text = text;
+          chatMessage.quotedId = quotedId;
+          chatMessage.quotedText = quotedText;
+          chatMessage.quotedSender = quotedSender;
+          chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
+          chatMessage.timeSent = timeSent;
+          chatMessage.sequence = sequence;
+          chatMessage.isOutgoing = isOutgoing;
+          chatMessage.isRead = isRead;
+
+          p_ChatMessages[chatId].push_back(chatMessage);
+        };
+      // *INDENT-ON*
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+void MessageCache::PerformFetchOneMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                          const std::string& p_MsgId,
+                                          std::vector<ChatMessage>& p_ChatMessages)
+{
+  try
+  {
+    // *INDENT-OFF*
+    GetReadStatement(p_ProfileCache,
+      "SELECT m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+      "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+      "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM messages m "
+      "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+      "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+      "WHERE m.chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND m.id = ?;") << p_ChatId << p_MsgId >>
+      [&](const std::string& id, const std::string& senderId, const std::string& text,
           const std::string& quotedId, const std::string& quotedText,
-          const std::string& quotedSender, const std::string& fileInfo,
-          int64_t timeSent, int32_t isOutgoing, int32_t isRead)
+          const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+          const std::string& fileId, const std::string& filePath, const std::string& fileType,
+          int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
       {
         ChatMessage chatMessage;
         chatMessage.id = id;
@@ -1205,8 +3100,9 @@ void MessageCache::PerformFetchOneMessage(const std::string& p_ProfileId, const
         chatMessage.quotedId = quotedId;
         chatMessage.quotedText = quotedText;
         chatMessage.quotedSender = quotedSender;
-        chatMessage.fileInfo = fileInfo;
+        chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
         chatMessage.timeSent = timeSent;
+        chatMessage.sequence = sequence;
         chatMessage.isOutgoing = isOutgoing;
         chatMessage.isRead = isRead;
 
@@ -1220,11 +3116,1939 @@ void MessageCache::PerformFetchOneMessage(const std::string& p_ProfileId, const
   }
 }
 
-void MessageCache::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+void MessageCache::PerformFetchMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                        const std::vector<std::string>& p_MsgIds,
+                                        std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::set<std::string> foundMsgIds;
+  try
+  {
+    static const std::string sql =
+      "SELECT m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+      "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+      "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM messages m "
+      "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+      "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+      "WHERE m.chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND m.id IN (" +
+      StrUtil::Join(std::vector<std::string>(s_InParamCount, "?"), ",") + ");";
+    for (const auto& chunk : GetInParamChunks(p_MsgIds))
+    {
+      sqlite::database_binder& fetchStmt = GetReadStatement(p_ProfileCache, sql);
+      fetchStmt << p_ChatId;
+      for (const auto& msgId : chunk)
+      {
+        fetchStmt << msgId;
+      }
+
+      // *INDENT-OFF*
+      fetchStmt >>
+        [&](const std::string& id, const std::string& senderId, const std::string& text,
+            const std::string& quotedId, const std::string& quotedText,
+            const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+            const std::string& fileId, const std::string& filePath, const std::string& fileType,
+            int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
+        {
+          if (!foundMsgIds.insert(id).second) return;
+
+          ChatMessage chatMessage;
+          chatMessage.id = id;
+          chatMessage.senderId = senderId;
+          chatMessage.text = text;
+          chatMessage.quotedId = quotedId;
+          chatMessage.quotedText = quotedText;
+          chatMessage.quotedSender = quotedSender;
+          chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
+          chatMessage.timeSent = timeSent;
+          chatMessage.sequence = sequence;
+          chatMessage.isOutgoing = isOutgoing;
+          chatMessage.isRead = isRead;
+
+          p_ChatMessages.push_back(chatMessage);
+        };
+      // *INDENT-ON*
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+// must be called with lock held
+void MessageCache::LocateArchivedMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                          const std::vector<std::string>& p_MsgIds,
+                                          const std::vector<ChatMessage>& p_ChatMessages,
+                                          std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations)
+{
+  // messages not found in db are located by the archive index, to be decoded without lock held
+  std::set<std::string> foundMsgIds;
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    foundMsgIds.insert(chatMessage.id);
+  }
+
+  std::vector<std::string> msgIds;
+  for (const auto& msgId : p_MsgIds)
+  {
+    if (!foundMsgIds.count(msgId))
+    {
+      msgIds.push_back(msgId);
+    }
+  }
+
+  if (msgIds.empty()) return;
+
+  try
+  {
+    static const std::string sql = "SELECT id, blockOffset FROM archiveids WHERE "
+      "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND removed = 0 AND id IN (" +
+      StrUtil::Join(std::vector<std::string>(s_InParamCount, "?"), ",") + ");";
+    for (const auto& chunk : GetInParamChunks(msgIds))
+    {
+      sqlite::database_binder& locateStmt = GetReadStatement(p_ProfileCache, sql);
+      locateStmt << p_ChatId;
+      for (const auto& msgId : chunk)
+      {
+        locateStmt << msgId;
+      }
+
+      // *INDENT-OFF*
+      locateStmt >>
+        [&](const std::string& id, int64_t blockOffset)
+        {
+          if (!foundMsgIds.insert(id).second) return;
+
+          p_Locations.push_back(std::make_tuple(p_ChatId, id, static_cast<size_t>(blockOffset)));
+        };
+      // *INDENT-ON*
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+// must be called with lock held
+void MessageCache::PerformFetchChatUnreads(ProfileCache& p_ProfileCache, const std::vector<std::string>& p_ChatIds,
+                                           std::vector<ChatUnreadInfo>& p_ChatUnreadInfos)
+{
+  // newest message by the timeSent index, unread messages counted on the partial unread index,
+  // so neither reads message bodies nor scans read history
+  try
+  {
+    std::vector<std::string> chatIds = p_ChatIds;
+    if (chatIds.empty())
+    {
+      // *INDENT-OFF*
+      GetReadStatement(p_ProfileCache, "SELECT id FROM chatids;") >>
+        [&](const std::string& chatId)
+        {
+          chatIds.push_back(chatId);
+        };
+      // *INDENT-ON*
+    }
+
+    for (const auto& chatId : chatIds)
+    {
+      ChatUnreadInfo chatUnreadInfo;
+      chatUnreadInfo.id = chatId;
+      // *INDENT-OFF*
+      GetReadStatement(p_ProfileCache, "SELECT timeSent, isOutgoing, isRead FROM messages WHERE "
+                       "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) "
+                       "ORDER BY timeSent DESC, sequence DESC, id DESC LIMIT 1;") << chatId >>
+        [&](int64_t timeSent, int32_t isOutgoing, int32_t isRead)
+        {
+          chatUnreadInfo.lastMessageTime = timeSent;
+          chatUnreadInfo.isUnread = !isOutgoing && !isRead;
+        };
+      // *INDENT-ON*
+      if (chatUnreadInfo.lastMessageTime == -1) continue;
+
+      if (chatUnreadInfo.isUnread)
+      {
+        // *INDENT-OFF*
+        GetReadStatement(p_ProfileCache, "SELECT COUNT(*), COALESCE(MAX(hasMention), 0) FROM "
+                         "(SELECT hasMention FROM messages WHERE chatKey = (SELECT chatKey FROM chatids WHERE id = ?) "
+                         "AND isRead = 0 AND isOutgoing = 0 ORDER BY timeSent DESC LIMIT ?);")
+                           << chatId << s_UnreadCountMax >>
+          [&](int32_t unreadCount, int32_t hasMention)
+          {
+            chatUnreadInfo.unreadCount = unreadCount;
+            chatUnreadInfo.hasUnreadMention = hasMention;
+          };
+        // *INDENT-ON*
+      }
+
+      p_ChatUnreadInfos.push_back(chatUnreadInfo);
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+}
+
+std::vector<std::vector<std::string>> MessageCache::GetInParamChunks(const std::vector<std::string>& p_Ids)
+{
+  // split into fixed size chunks, the last padded by repeating its first id
+  std::vector<std::vector<std::string>> chunks;
+  for (size_t i = 0; i < p_Ids.size(); i += s_InParamCount)
+  {
+    std::vector<std::string> chunk(p_Ids.begin() + i, p_Ids.begin() + std::min(i + s_InParamCount, p_Ids.size()));
+    chunk.resize(s_InParamCount, chunk.front());
+    chunks.push_back(std::move(chunk));
+  }
+
+  return chunks;
+}
+
+// must be called with lock held, within a transaction, may throw sqlite_exception
+void MessageCache::InsertMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                 const ChatMessage& p_ChatMessage)
+{
+  sqlite::database_binder& insertSenderStmt =
+    GetStatement(p_ProfileCache, "INSERT OR IGNORE INTO senderids (id) VALUES (?);");
+  (insertSenderStmt << p_ChatMessage.senderId).execute();
+  if (p_ChatMessage.quotedSender != p_ChatMessage.senderId)
+  {
+    insertSenderStmt.reset();
+    (insertSenderStmt << p_ChatMessage.quotedSender).execute();
+  }
+
+  const FileInfo& fileInfo =
+    p_ChatMessage.fileInfo.empty() ? FileInfo() : ProtocolUtil::FileInfoFromHex(p_ChatMessage.fileInfo);
+  std::unique_ptr<int> fileStatus(p_ChatMessage.fileInfo.empty() ? nullptr : new int(fileInfo.fileStatus));
+
+  // in compressed storage mode, longer texts are stored as compressed blobs, and quoted texts equal to
+  // the quoted message text as null, expanded by s_SqlMessageTexts on read
+  std::vector<char> textBlob;
+  std::vector<char> quotedTextBlob;
+  bool quotedTextByRef = false;
+  if (p_ProfileCache.compressText)
+  {
+    if (p_ChatMessage.text.size() >= s_CompressTextMinSize)
+    {
+      p_ProfileCache.textCompressor->Compress(p_ChatMessage.text, textBlob);
+    }
+
+    if (!p_ChatMessage.quotedId.empty() && !p_ChatMessage.quotedText.empty())
+    {
+      int isQuotedText = 0;
+      GetStatement(p_ProfileCache, "SELECT EXISTS (SELECT 1 FROM messages WHERE "
+                   "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? AND nc_text(text) = ?);")
+        << p_ChatId << p_ChatMessage.quotedId << p_ChatMessage.quotedText >> isQuotedText;
+      quotedTextByRef = isQuotedText;
+    }
+
+    if (!quotedTextByRef && (p_ChatMessage.quotedText.size() >= s_CompressTextMinSize))
+    {
+      p_ProfileCache.textCompressor->Compress(p_ChatMessage.quotedText, quotedTextBlob);
+    }
+  }
+
+  // updated in place rather than replaced, so a redelivered quoted message keeps replies referencing its text
+  // *INDENT-OFF*
+  sqlite::database_binder& insertStmt = GetStatement(p_ProfileCache, "INSERT INTO messages "
+    "(chatKey, id, senderKey, text, quotedId, quotedText, quotedSenderKey, fileStatus, fileId, filePath, fileType, "
+    "timeSent, sequence, isOutgoing, isRead, hasMention) VALUES "
+    "((SELECT chatKey FROM chatids WHERE id = ?), ?, (SELECT senderKey FROM senderids WHERE id = ?), ?, ?, ?, "
+    "(SELECT senderKey FROM senderids WHERE id = ?), ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT (chatKey, id) DO UPDATE SET senderKey = excluded.senderKey, text = excluded.text, "
+    "quotedId = excluded.quotedId, quotedText = excluded.quotedText, quotedSenderKey = excluded.quotedSenderKey, "
+    "fileStatus = excluded.fileStatus, fileId = excluded.fileId, filePath = excluded.filePath, "
+    "fileType = excluded.fileType, timeSent = excluded.timeSent, sequence = excluded.sequence, "
+    "isOutgoing = excluded.isOutgoing, isRead = excluded.isRead, hasMention = excluded.hasMention;");
+  insertStmt << p_ChatId << p_ChatMessage.id << p_ChatMessage.senderId;
+  if (!textBlob.empty())
+  {
+    insertStmt << textBlob;
+  }
+  else
+  {
+    insertStmt << p_ChatMessage.text;
+  }
+
+  insertStmt << p_ChatMessage.quotedId;
+  if (quotedTextByRef)
+  {
+    insertStmt << std::unique_ptr<std::string>();
+  }
+  else if (!quotedTextBlob.empty())
+  {
+    insertStmt << quotedTextBlob;
+  }
+  else
+  {
+    insertStmt << p_ChatMessage.quotedText;
+  }
+
+  insertStmt << p_ChatMessage.quotedSender <<
+    fileStatus << fileInfo.fileId << fileInfo.filePath << fileInfo.fileType << p_ChatMessage.timeSent <<
+    p_ChatMessage.sequence << p_ChatMessage.isOutgoing << p_ChatMessage.isRead << p_ChatMessage.hasMention;
+  insertStmt.execute();
+  // *INDENT-ON*
+}
+
+void MessageCache::LoadLegacyChats(ProfileCache& p_ProfileCache)
+{
+  int hasLegacyMessages = 0;
+  *p_ProfileCache.db << "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+    "name = '" + s_TableMessagesLegacy + "');" >> hasLegacyMessages;
+  if (!hasLegacyMessages) return;
+
+  // most recently active chats are converted first
+  // *INDENT-OFF*
+  *p_ProfileCache.db << "SELECT chatId FROM " + s_TableMessagesLegacy + " GROUP BY chatId "
+    "ORDER BY MAX(timeSent) DESC;" >>
+    [&](const std::string& chatId)
+    {
+      p_ProfileCache.legacyChatQueue.push_back(chatId);
+      p_ProfileCache.legacyChatIds.insert(chatId);
+    };
+  // *INDENT-ON*
+
+  p_ProfileCache.hasLegacyMessages = true;
+  LOG_INFO("cache migrate %d legacy chats", p_ProfileCache.legacyChatIds.size());
+}
+
+// must be called with lock held, within a transaction
+int MessageCache::MigrateLegacyChat(ProfileCache& p_ProfileCache, const std::string& p_ChatId, int p_Limit)
+{
+  // converts up to p_Limit (0 = all) messages, returns number converted
+  if (!p_ProfileCache.legacyChatIds.count(p_ChatId)) return 0;
+
+  int count = 0;
+  try
+  {
+    (GetStatement(p_ProfileCache, s_SqlInsertChatId) << p_ChatId).execute();
+
+    while (true)
+    {
+      std::vector<ChatMessage> chatMessages;
+      int64_t minRowId = std::numeric_limits<int64_t>::max();
+      const int limit = (p_Limit > 0) ? std::min(p_Limit - count, s_MigrationBatchSize) : s_MigrationBatchSize;
+      // *INDENT-OFF*
+      GetStatement(p_ProfileCache, "SELECT rowid, id, senderId, text, quotedId, quotedText, quotedSender, "
+        "fileInfo, timeSent, isOutgoing, isRead FROM " + s_TableMessagesLegacy + " WHERE chatId = ? "
+        "ORDER BY rowid DESC LIMIT ?;") << p_ChatId << limit >>
+        [&](int64_t rowId, const std::string& id, const std::string& senderId, const std::string& text,
+            const std::string& quotedId, const std::string& quotedText, const std::string& quotedSender,
+            const std::string& fileInfo, int64_t timeSent, int32_t isOutgoing, int32_t isRead)
+        {
+          ChatMessage chatMessage;
+          chatMessage.id = id;
+          chatMessage.senderId = senderId;
+          chatMessage.text = text;
+          chatMessage.quotedId = quotedId;
+          chatMessage.quotedText = quotedText;
+          chatMessage.quotedSender = quotedSender;
+          chatMessage.fileInfo = fileInfo;
+          chatMessage.timeSent = timeSent;
+          chatMessage.isOutgoing = isOutgoing;
+          chatMessage.isRead = isRead;
+          chatMessages.push_back(std::move(chatMessage));
+          minRowId = std::min(minRowId, rowId);
+        };
+      // *INDENT-ON*
+
+      if (chatMessages.empty())
+      {
+        p_ProfileCache.legacyChatIds.erase(p_ChatId);
+        LOG_DEBUG("cache migrated %s", p_ChatId.c_str());
+        break;
+      }
+
+      for (const auto& chatMessage : chatMessages)
+      {
+        InsertMessage(p_ProfileCache, p_ChatId, chatMessage);
+      }
+
+      (GetStatement(p_ProfileCache, "DELETE FROM " + s_TableMessagesLegacy + " WHERE chatId = ? AND rowid >= ?;")
+       << p_ChatId << minRowId).execute();
+
+      count += static_cast<int>(chatMessages.size());
+      if ((p_Limit > 0) && (count >= p_Limit)) break;
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  if (count > 0)
+  {
+    std::unique_lock<std::mutex> memoryLock(m_MemoryMutex);
+    RemoveMemoryChat(p_ProfileCache.profileId, p_ChatId);
+    ++m_MemoryGeneration;
+  }
+
+  return count;
+}
+
+void MessageCache::PerformMigration(ProfileCache& p_ProfileCache)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return;
+
+  try
+  {
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    int budget = s_MigrationBatchSize;
+    while ((budget > 0) && !p_ProfileCache.legacyChatQueue.empty())
+    {
+      const std::string chatId = p_ProfileCache.legacyChatQueue.front();
+      budget -= MigrateLegacyChat(p_ProfileCache, chatId, budget);
+      if (p_ProfileCache.legacyChatIds.count(chatId)) break;
+
+      p_ProfileCache.legacyChatQueue.pop_front();
+    }
+
+    if (p_ProfileCache.legacyChatQueue.empty())
+    {
+      *p_ProfileCache.db << "DROP TABLE IF EXISTS " + s_TableMessagesLegacy + ";";
+    }
+
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  if (p_ProfileCache.legacyChatQueue.empty())
+  {
+    p_ProfileCache.legacyChatIds.clear();
+    p_ProfileCache.hasLegacyMessages = false;
+    LOG_INFO("cache migration completed");
+  }
+}
+
+std::string MessageCache::GetFileInfo(bool p_HasFile, int p_FileStatus, const std::string& p_FileId,
+                                      const std::string& p_FilePath, const std::string& p_FileType)
 {
-  if (m_MessageHandler)
+  if (!p_HasFile) return "";
+
+  FileInfo fileInfo;
+  fileInfo.fileStatus = static_cast<FileStatus>(p_FileStatus);
+  fileInfo.fileId = p_FileId;
+  fileInfo.filePath = p_FilePath;
+  fileInfo.fileType = p_FileType;
+  return ProtocolUtil::FileInfoToHex(fileInfo);
+}
+
+void MessageCache::LoadRetentionPolicies(ProfileCache& p_ProfileCache)
+{
+  static const int maxAgeDays = std::max(AppConfig::GetNum("cache_retention_max_age_days"), 0);
+  static const int maxMessages = std::max(AppConfig::GetNum("cache_retention_max_messages"), 0);
+  static const int maxSizeMb = std::max(AppConfig::GetNum("cache_retention_max_size_mb"), 0);
+  static const int attachmentsMaxSizeMb = std::max(AppConfig::GetNum("cache_retention_attachments_max_size_mb"), 0);
+  static const int archiveAgeDays = std::max(AppConfig::GetNum("cache_archive_age_days"), 0);
+  p_ProfileCache.retentionPolicy.maxAgeDays = maxAgeDays;
+  p_ProfileCache.retentionPolicy.maxMessages = maxMessages;
+  p_ProfileCache.retentionMaxSize = static_cast<int64_t>(maxSizeMb) * 1024 * 1024;
+  p_ProfileCache.attachmentsMaxSize = static_cast<int64_t>(attachmentsMaxSizeMb) * 1024 * 1024;
+  p_ProfileCache.archiveAge = static_cast<int64_t>(archiveAgeDays) * 24 * 3600 * 1000;
+
+  // optional overrides, one per line: <profileid>/<param>=<value> or <profileid>/<chatid>/<param>=<value>
+  const std::string& path = FileUtil::GetApplicationDir() + "/" + s_RetentionConfigFile;
+  std::ifstream stream(path);
+  if (!stream.good()) return;
+
+  const std::string& prefix = p_ProfileCache.profileId + "/";
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    if (line.empty() || (line[0] == '#')) continue;
+
+    const size_t eqPos = line.find('=');
+    if ((eqPos == std::string::npos) || (line.compare(0, prefix.size(), prefix) != 0)) continue;
+
+    const std::string& key = line.substr(prefix.size(), eqPos - prefix.size());
+    const std::string& valueStr = line.substr(eqPos + 1);
+    if (!StrUtil::IsInteger(valueStr))
+    {
+      LOG_WARNING("invalid retention value \"%s\"", line.c_str());
+      continue;
+    }
+
+    const int value = std::max(static_cast<int>(StrUtil::ToInteger(valueStr)), 0);
+    const size_t slashPos = key.rfind('/');
+    const std::string& chatId = (slashPos != std::string::npos) ? key.substr(0, slashPos) : "";
+    const std::string& param = (slashPos != std::string::npos) ? key.substr(slashPos + 1) : key;
+    RetentionPolicy& policy = chatId.empty() ? p_ProfileCache.retentionPolicy
+                                             : p_ProfileCache.chatRetentionPolicies[chatId];
+    if (param == "max_age_days")
+    {
+      policy.maxAgeDays = value;
+    }
+    else if (param == "max_messages")
+    {
+      policy.maxMessages = value;
+    }
+    else if ((param == "max_size_mb") && chatId.empty())
+    {
+      p_ProfileCache.retentionMaxSize = static_cast<int64_t>(value) * 1024 * 1024;
+    }
+    else if ((param == "attachments_max_size_mb") && chatId.empty())
+    {
+      p_ProfileCache.attachmentsMaxSize = static_cast<int64_t>(value) * 1024 * 1024;
+    }
+    else
+    {
+      LOG_WARNING("unknown retention param \"%s\"", line.c_str());
+    }
+  }
+}
+
+bool MessageCache::HasRetentionPolicy(ProfileCache& p_ProfileCache)
+{
+  if ((p_ProfileCache.retentionPolicy.maxAgeDays > 0) || (p_ProfileCache.retentionPolicy.maxMessages > 0) ||
+      (p_ProfileCache.retentionMaxSize > 0) || (p_ProfileCache.attachmentsMaxSize > 0) ||
+      (p_ProfileCache.archiveAge > 0))
+  {
+    return true;
+  }
+
+  for (const auto& chatRetentionPolicy : p_ProfileCache.chatRetentionPolicies)
+  {
+    if ((chatRetentionPolicy.second.maxAgeDays > 0) || (chatRetentionPolicy.second.maxMessages > 0))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool MessageCache::PerformRetention(ProfileCache& p_ProfileCache)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return false;
+
+  // returns true if more work remains, to run next batch soon
+  int budget = s_RetentionBatchSize;
+  int64_t freelistCount = 0;
+  std::set<std::string> deletedChatIds;
+  try
+  {
+    // incremental vacuum requires auto_vacuum, which existing dbs only get through a full vacuum
+    int autoVacuum = 0;
+    *p_ProfileCache.db << "PRAGMA auto_vacuum;" >> autoVacuum;
+    if (autoVacuum != 2)
+    {
+      LOG_INFO("cache enable incremental vacuum for %s", p_ProfileCache.profileId.c_str());
+      try
+      {
+        *p_ProfileCache.db << "PRAGMA auto_vacuum = INCREMENTAL;";
+        *p_ProfileCache.db << "VACUUM;";
+      }
+      catch (const sqlite::sqlite_exception& ex)
+      {
+        LOG_WARNING("cache vacuum failed %d: %s", ex.get_code(), ex.what());
+      }
+
+      *p_ProfileCache.db << "PRAGMA auto_vacuum;" >> autoVacuum;
+    }
+
+    std::vector<std::pair<std::string, int64_t>> chatCounts;
+    // *INDENT-OFF*
+    *p_ProfileCache.db << "SELECT c.id, COUNT(*) FROM messages m JOIN chatids c ON c.chatKey = m.chatKey "
+      "GROUP BY m.chatKey;" >>
+      [&](const std::string& chatId, int64_t count)
+      {
+        chatCounts.push_back(std::make_pair(chatId, count));
+      };
+    // *INDENT-ON*
+
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    auto deleteMessages = [&](sqlite::database_binder& p_Stmt, const std::string& p_ChatId) -> int64_t
+    {
+      p_Stmt.execute();
+      int64_t deleted = 0;
+      *p_ProfileCache.db << "SELECT changes();" >> deleted;
+      if (deleted > 0)
+      {
+        deletedChatIds.insert(p_ChatId);
+        budget -= static_cast<int>(std::min<int64_t>(deleted, budget));
+      }
+
+      return deleted;
+    };
+
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    for (const auto& chatCount : chatCounts)
+    {
+      if (budget <= 0) break;
+
+      const std::string& chatId = chatCount.first;
+      RetentionPolicy policy = p_ProfileCache.retentionPolicy;
+      auto it = p_ProfileCache.chatRetentionPolicies.find(chatId);
+      if (it != p_ProfileCache.chatRetentionPolicies.end())
+      {
+        if (it->second.maxAgeDays >= 0) policy.maxAgeDays = it->second.maxAgeDays;
+        if (it->second.maxMessages >= 0) policy.maxMessages = it->second.maxMessages;
+      }
+
+      int64_t count = chatCount.second;
+      if (policy.maxAgeDays > 0)
+      {
+        const int64_t minTimeSent = nowTime - (static_cast<int64_t>(policy.maxAgeDays) * 24 * 3600 * 1000);
+        // *INDENT-OFF*
+        count -= deleteMessages(GetStatement(p_ProfileCache,
+          "DELETE FROM messages WHERE msgKey IN (SELECT msgKey FROM messages WHERE "
+          "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND timeSent < ? LIMIT ?);") << chatId << minTimeSent << budget, chatId);
+        // *INDENT-ON*
+      }
+
+      if ((budget > 0) && (policy.maxMessages > 0) && (count > policy.maxMessages))
+      {
+        const int64_t excess = std::min<int64_t>(count - policy.maxMessages, budget);
+        // *INDENT-OFF*
+        deleteMessages(GetStatement(p_ProfileCache,
+          "DELETE FROM messages WHERE msgKey IN (SELECT msgKey FROM messages WHERE "
+          "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) ORDER BY timeSent ASC, sequence ASC, id ASC LIMIT ?);") << chatId << excess, chatId);
+        // *INDENT-ON*
+      }
+    }
+
+    if ((budget > 0) && (p_ProfileCache.retentionMaxSize > 0))
+    {
+      int64_t pageCount = 0;
+      int64_t freePageCount = 0;
+      int64_t pageSize = 0;
+      *p_ProfileCache.db << "PRAGMA page_count;" >> pageCount;
+      *p_ProfileCache.db << "PRAGMA freelist_count;" >> freePageCount;
+      *p_ProfileCache.db << "PRAGMA page_size;" >> pageSize;
+      if (((pageCount - freePageCount) * pageSize) > p_ProfileCache.retentionMaxSize)
+      {
+        // delete from the chat holding the oldest message
+        std::string chatId;
+        // *INDENT-OFF*
+        *p_ProfileCache.db << "SELECT c.id, MIN(m.timeSent) AS minTimeSent FROM messages m "
+          "JOIN chatids c ON c.chatKey = m.chatKey GROUP BY m.chatKey ORDER BY minTimeSent ASC LIMIT 1;" >>
+          [&](const std::string& p_ChatId, int64_t)
+          {
+            chatId = p_ChatId;
+          };
+
+        if (!chatId.empty())
+        {
+          deleteMessages(GetStatement(p_ProfileCache,
+            "DELETE FROM messages WHERE msgKey IN (SELECT msgKey FROM messages WHERE "
+            "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) ORDER BY timeSent ASC, sequence ASC, id ASC LIMIT ?);") << chatId << budget, chatId);
+        }
+        // *INDENT-ON*
+
+        // size is evaluated again on next batch
+        budget = 0;
+      }
+    }
+
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+
+    if (autoVacuum == 2)
+    {
+      *p_ProfileCache.db << "PRAGMA freelist_count;" >> freelistCount;
+      if (freelistCount > 0)
+      {
+        *p_ProfileCache.db << "PRAGMA incremental_vacuum(" + std::to_string(s_RetentionVacuumPages) + ");";
+        freelistCount = std::max<int64_t>(freelistCount - s_RetentionVacuumPages, 0);
+      }
+    }
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  if (!deletedChatIds.empty())
+  {
+    std::unique_lock<std::mutex> memoryLock(m_MemoryMutex);
+    for (const auto& chatId : deletedChatIds)
+    {
+      RemoveMemoryChat(p_ProfileCache.profileId, chatId);
+    }
+
+    ++m_MemoryGeneration;
+    LOG_DEBUG("cache retention deleted messages in %d chats", deletedChatIds.size());
+  }
+
+  // keep going while batches are full or free pages remain to be vacuumed
+  return (budget <= 0) || (freelistCount > 0);
+}
+
+// must be called with lock held
+void MessageCache::LoadAttachments(ProfileCache& p_ProfileCache)
+{
+  std::unordered_map<std::string, AttachmentEntry> attachments;
+  // *INDENT-OFF*
+  *p_ProfileCache.db << "SELECT path, chatId, size, lastAccess FROM attachments;" >>
+    [&](const std::string& p_Path, const std::string& p_ChatId, int64_t p_Size, int64_t p_LastAccess)
+    {
+      AttachmentEntry& attachmentEntry = attachments[p_Path];
+      attachmentEntry.profileId = p_ProfileCache.profileId;
+      attachmentEntry.chatId = p_ChatId;
+      attachmentEntry.size = p_Size;
+      attachmentEntry.lastAccess = p_LastAccess;
+    };
+  // *INDENT-ON*
+
+  LOG_DEBUG("cache loaded %d attachments for %s", attachments.size(), p_ProfileCache.profileId.c_str());
+  std::unique_lock<std::mutex> lock(m_AttachmentMutex);
+  m_Attachments.insert(attachments.begin(), attachments.end());
+}
+
+bool MessageCache::PerformAttachmentRetention(ProfileCache& p_ProfileCache)
+{
+  if (p_ProfileCache.attachmentsMaxSize <= 0) return false;
+
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return false;
+
+  // returns true if more work remains, to run next batch soon
+  bool hasMore = false;
+  std::vector<std::string> evictedPaths;
+  try
+  {
+    int64_t totalSize = 0;
+    *p_ProfileCache.db << "SELECT IFNULL(SUM(size), 0) FROM attachments;" >> totalSize;
+    if (totalSize <= p_ProfileCache.attachmentsMaxSize) return false;
+
+    // evict least recently accessed, only removing files within the application dir
+    const std::string& appDir = FileUtil::GetApplicationDir() + "/";
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    // *INDENT-OFF*
+    GetStatement(p_ProfileCache, "SELECT path, size FROM attachments ORDER BY lastAccess ASC LIMIT ?;") <<
+      s_RetentionBatchSize >>
+      [&](const std::string& p_Path, int64_t p_Size)
+      {
+        if (totalSize <= p_ProfileCache.attachmentsMaxSize) return;
+
+        evictedPaths.push_back(p_Path);
+        totalSize -= p_Size;
+      };
+    // *INDENT-ON*
+
+    for (const auto& path : evictedPaths)
+    {
+      if (path.compare(0, appDir.size(), appDir) == 0)
+      {
+        FileUtil::RmFile(path);
+      }
+
+      (GetStatement(p_ProfileCache, "DELETE FROM attachments WHERE path = ?;") << path).execute();
+    }
+
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+    hasMore = (totalSize > p_ProfileCache.attachmentsMaxSize);
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  if (!evictedPaths.empty())
+  {
+    // evicted files may have been the last reference to a shared blob
+    lock.unlock();
+    BlobStore::Cleanup();
+
+    std::unique_lock<std::mutex> attachmentLock(m_AttachmentMutex);
+    for (const auto& path : evictedPaths)
+    {
+      m_Attachments.erase(path);
+    }
+
+    ++m_AttachmentGeneration;
+    LOG_DEBUG("cache retention evicted %d attachments", evictedPaths.size());
+  }
+
+  return hasMore;
+}
+
+bool MessageCache::PerformArchival(ProfileCache& p_ProfileCache)
+{
+  if (p_ProfileCache.archiveAge <= 0) return false;
+
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return false;
+
+  // moves one batch of the oldest messages of one chat, written to its archive before deleted from db.
+  // unread messages are kept in db, where unread counts and read updates apply. messages already
+  // archived once, then restored or re-added, stay in db as the archive cannot replace their copy.
+  static const std::string sqlArchivable = "m.timeSent < ? AND (m.isRead = 1 OR m.isOutgoing = 1) AND "
+    "NOT EXISTS (SELECT 1 FROM archiveids a WHERE a.chatKey = m.chatKey AND a.id = m.id)";
+  const int64_t maxTimeSent = TimeUtil::GetCurrentTimeMSec() - p_ProfileCache.archiveAge;
+  std::string chatId;
+  std::vector<ChatMessage> chatMessages;
+  try
+  {
+    // *INDENT-OFF*
+    GetStatement(p_ProfileCache, "SELECT c.id FROM chatids c WHERE EXISTS "
+                 "(SELECT 1 FROM messages m WHERE m.chatKey = c.chatKey AND " + sqlArchivable + ") LIMIT 1;")
+      << maxTimeSent >>
+      [&](const std::string& p_ChatId)
+      {
+        chatId = p_ChatId;
+      };
+
+    if (chatId.empty()) return false;
+
+    GetStatement(p_ProfileCache,
+      "SELECT m.id, s.id, " + s_SqlMessageTexts + ", q.id, "
+      "m.fileStatus IS NOT NULL, m.fileStatus, m.fileId, m.filePath, m.fileType, "
+      "m.timeSent, m.sequence, m.isOutgoing, m.isRead FROM messages m "
+      "LEFT JOIN senderids s ON s.senderKey = m.senderKey "
+      "LEFT JOIN senderids q ON q.senderKey = m.quotedSenderKey "
+      "WHERE m.chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND " + sqlArchivable + " "
+      "ORDER BY m.timeSent ASC, m.sequence ASC, m.id ASC LIMIT ?;")
+      << chatId << maxTimeSent << s_ArchiveBatchSize >>
+      [&](const std::string& id, const std::string& senderId, const std::string& text,
+          const std::string& quotedId, const std::string& quotedText,
+          const std::string& quotedSender, int32_t hasFile, int32_t fileStatus,
+          const std::string& fileId, const std::string& filePath, const std::string& fileType,
+          int64_t timeSent, int64_t sequence, int32_t isOutgoing, int32_t isRead)
+      {
+        ChatMessage chatMessage;
+        chatMessage.id = id;
+        chatMessage.senderId = senderId;
+        chatMessage.text = text;
+        chatMessage.quotedId = quotedId;
+        chatMessage.quotedText = quotedText;
+        chatMessage.quotedSender = quotedSender;
+        chatMessage.fileInfo = GetFileInfo(hasFile, fileStatus, fileId, filePath, fileType);
+        chatMessage.timeSent = timeSent;
+        chatMessage.sequence = sequence;
+        chatMessage.isOutgoing = isOutgoing;
+        chatMessage.isRead = isRead;
+        chatMessages.push_back(std::move(chatMessage));
+      };
+    // *INDENT-ON*
+
+    if (chatMessages.empty()) return false;
+
+    FileUtil::MkDir(p_ProfileCache.archiveDir);
+    size_t offset = 0;
+    if (!GetArchive(p_ProfileCache, chatId)->Append(chatMessages, offset))
+    {
+      LOG_WARNING("cache archival failed %s", chatId.c_str());
+      return false;
+    }
+
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    sqlite::database_binder& deleteStmt =
+      GetStatement(p_ProfileCache, "DELETE FROM messages WHERE chatKey = (SELECT chatKey FROM chatids WHERE id = ?) "
+                   "AND id = ?;");
+    for (const auto& chatMessage : chatMessages)
+    {
+      deleteStmt.reset();
+      (deleteStmt << chatId << chatMessage.id).execute();
+    }
+
+    InsertArchiveIndex(p_ProfileCache, chatId, offset, chatMessages, p_ProfileCache.hasSearch);
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+    return false;
+  }
+
+  LOG_DEBUG("cache archived %d messages of %s", chatMessages.size(), chatId.c_str());
+  return true;
+}
+
+bool MessageCache::PerformPurge(ProfileCache& p_ProfileCache)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.dbMutex);
+  if (!p_ProfileCache.db) return false;
+
+  // removes one batch of messages of one deleted chat, returns true if more remain
+  int64_t chatKey = -1;
+  std::string chatId;
+  int64_t timeDeleted = 0;
+  int32_t purgeAttachments = 0;
+  std::vector<std::string> removedPaths;
+  try
+  {
+    // *INDENT-OFF*
+    GetStatement(p_ProfileCache, "SELECT chatKey, chatId, timeDeleted, purgeAttachments FROM chatpurges LIMIT 1;") >>
+      [&](int64_t p_ChatKey, const std::string& p_ChatId, int64_t p_TimeDeleted, int32_t p_PurgeAttachments)
+      {
+        chatKey = p_ChatKey;
+        chatId = p_ChatId;
+        timeDeleted = p_TimeDeleted;
+        purgeAttachments = p_PurgeAttachments;
+      };
+    // *INDENT-ON*
+
+    if (chatKey == -1) return false;
+
+    GetStatement(p_ProfileCache, "BEGIN;").execute();
+    (GetStatement(p_ProfileCache, "DELETE FROM messages WHERE msgKey IN "
+                  "(SELECT msgKey FROM messages WHERE chatKey = ? LIMIT ?);") << chatKey << s_PurgeBatchSize).execute();
+    int64_t deleted = 0;
+    *p_ProfileCache.db << "SELECT changes();" >> deleted;
+    if (deleted < s_PurgeBatchSize)
+    {
+      // archive file is removed on delete, its index rows once messages are purged
+      (GetStatement(p_ProfileCache, "DELETE FROM archiveids WHERE archiveKey IN "
+                    "(SELECT archiveKey FROM archiveids WHERE chatKey = ? LIMIT ?);")
+       << chatKey << (s_PurgeBatchSize - deleted)).execute();
+      int64_t archiveDeleted = 0;
+      *p_ProfileCache.db << "SELECT changes();" >> archiveDeleted;
+      deleted += archiveDeleted;
+    }
+
+    // attachments downloaded after the chat was deleted belong to a recreated chat and are kept
+    if (purgeAttachments)
+    {
+      // *INDENT-OFF*
+      (GetStatement(p_ProfileCache, "SELECT path FROM attachments WHERE chatId = ? AND lastAccess <= ? LIMIT ?;")
+        << chatId << timeDeleted << s_PurgeBatchSize) >>
+        [&](const std::string& p_Path)
+        {
+          removedPaths.push_back(p_Path);
+        };
+      // *INDENT-ON*
+
+      for (const auto& path : removedPaths)
+      {
+        (GetStatement(p_ProfileCache, "DELETE FROM attachments WHERE path = ?;") << path).execute();
+      }
+    }
+
+    if ((deleted < s_PurgeBatchSize) && ((int)removedPaths.size() < s_PurgeBatchSize))
+    {
+      (GetStatement(p_ProfileCache, "DELETE FROM chatpurges WHERE chatKey = ?;") << chatKey).execute();
+      LOG_DEBUG("cache purged %s", chatId.c_str());
+    }
+
+    GetStatement(p_ProfileCache, "COMMIT;").execute();
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    HANDLE_SQLITE_EXCEPTION(ex);
+    return false;
+  }
+
+  lock.unlock();
+  if (!removedPaths.empty())
+  {
+    // only files within the application dir are removed, as for attachment retention
+    const std::string& appDir = FileUtil::GetApplicationDir() + "/";
+    for (const auto& path : removedPaths)
+    {
+      if (path.compare(0, appDir.size(), appDir) == 0)
+      {
+        FileUtil::RmFile(path);
+      }
+    }
+
+    BlobStore::Cleanup();
+
+    std::unique_lock<std::mutex> attachmentLock(m_AttachmentMutex);
+    for (const auto& path : removedPaths)
+    {
+      m_Attachments.erase(path);
+    }
+
+    ++m_AttachmentGeneration;
+  }
+
+  return true;
+}
+
+std::shared_ptr<MessageArchive> MessageCache::GetArchive(ProfileCache& p_ProfileCache, const std::string& p_ChatId)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.archiveMutex);
+  std::shared_ptr<MessageArchive>& archive = p_ProfileCache.archives[p_ChatId];
+  if (!archive)
+  {
+    archive = std::make_shared<MessageArchive>(p_ProfileCache.archiveDir + "/" + StrUtil::StrToHex(p_ChatId) +
+                                               ".arc");
+  }
+
+  return archive;
+}
+
+std::vector<std::string> MessageCache::GetArchivedChatIds(ProfileCache& p_ProfileCache)
+{
+  std::vector<std::string> chatIds;
+  if (!FileUtil::IsDir(p_ProfileCache.archiveDir)) return chatIds;
+
+  const std::string ext = ".arc";
+  for (const auto& dirEntry : FileUtil::ListPaths(p_ProfileCache.archiveDir))
+  {
+    const std::string& name = dirEntry.name;
+    if ((name.size() > ext.size()) && (name.compare(name.size() - ext.size(), ext.size(), ext) == 0))
+    {
+      chatIds.push_back(StrUtil::StrFromHex(name.substr(0, name.size() - ext.size())));
+    }
+  }
+
+  return chatIds;
+}
+
+// must be called with lock held, may throw sqlite_exception
+void MessageCache::GetFromMsgIdKey(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                   const std::string& p_FromMsgId, int64_t& p_TimeSent, int64_t& p_Sequence)
+{
+  p_TimeSent = 0;
+  p_Sequence = 0;
+  if (p_FromMsgId.empty())
+  {
+    p_TimeSent = std::numeric_limits<int64_t>::max();
+    p_Sequence = std::numeric_limits<int64_t>::max();
+    return;
+  }
+
+  // anchor may be archived, then its key is held by the archive index
+  // *INDENT-OFF*
+  GetReadStatement(p_ProfileCache, "SELECT timeSent, sequence FROM messages WHERE "
+                   "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? "
+                   "UNION ALL SELECT timeSent, sequence FROM archiveids WHERE "
+                   "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? LIMIT 1;")
+                      << p_ChatId << p_FromMsgId << p_ChatId << p_FromMsgId >>
+    [&](const int64_t& timeSent, const int64_t& sequence)
+    {
+      p_TimeSent = timeSent;
+      p_Sequence = sequence;
+    };
+  // *INDENT-ON*
+}
+
+// must be called with lock held, may throw sqlite_exception
+void MessageCache::MigrateSchema(ProfileCache& p_ProfileCache)
+{
+  int schemaVersion = 0;
+  *p_ProfileCache.db << "PRAGMA user_version;" >> schemaVersion;
+  if (schemaVersion >= s_SchemaVersion) return;
+
+  LOG_INFO("migrate cache schema %d to %d", schemaVersion, s_SchemaVersion);
+
+  *p_ProfileCache.db << "BEGIN;";
+  try
+  {
+    PerformSchemaMigration(p_ProfileCache, schemaVersion);
+    *p_ProfileCache.db << "PRAGMA user_version = " + std::to_string(s_SchemaVersion) + ";";
+    *p_ProfileCache.db << "COMMIT;";
+  }
+  catch (...)
+  {
+    // a failed migration is undone as a whole, so the connection is not left within its transaction,
+    // and it is retried from the same version on next load
+    SqliteHelp::Rollback(*p_ProfileCache.db);
+    throw;
+  }
+}
+
+// must be called within a transaction, may throw sqlite_exception
+void MessageCache::PerformSchemaMigration(ProfileCache& p_ProfileCache, int p_SchemaVersion)
+{
+  if (p_SchemaVersion < 3)
+  {
+    // chat and sender ids are stored once in dictionary tables, file info in structured columns.
+    // existing messages are kept in a legacy table and converted in background, see PerformMigration
+    int hasMessages = 0;
+    *p_ProfileCache.db << "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+      "name = 'messages');" >> hasMessages;
+    if (hasMessages)
+    {
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_insert;";
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_delete;";
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_update;";
+      *p_ProfileCache.db << "DROP TABLE IF EXISTS messages_fts;";
+      *p_ProfileCache.db << "DROP INDEX IF EXISTS messages_chatId_timeSent;";
+      *p_ProfileCache.db << "ALTER TABLE messages RENAME TO " + s_TableMessagesLegacy + ";";
+    }
+
+    // explicit integer primary keys, as vacuum may otherwise renumber rowids
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS chatids ("
+      "chatKey INTEGER PRIMARY KEY,"
+      "id TEXT UNIQUE"
+      ");";
+
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS senderids ("
+      "senderKey INTEGER PRIMARY KEY,"
+      "id TEXT UNIQUE"
+      ");";
+
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS messages ("
+      "msgKey INTEGER PRIMARY KEY,"
+      "chatKey INT,"
+      "id TEXT,"
+      "senderKey INT,"
+      "text TEXT,"
+      "quotedId TEXT,"
+      "quotedText TEXT,"
+      "quotedSenderKey INT,"
+      "fileStatus INT,"
+      "fileId TEXT,"
+      "filePath TEXT,"
+      "fileType TEXT,"
+      "timeSent INT,"
+      "isOutgoing INT,"
+      "isRead INT,"
+      "UNIQUE(chatKey, id) ON CONFLICT REPLACE"
+      ");";
+
+    // lookups by (chatKey, id) are served by the autoindex of the unique constraint
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS messages_chatKey_timeSent "
+      "ON messages (chatKey, timeSent DESC, id DESC);";
+
+    CreateSearchIndex(p_ProfileCache);
+  }
+
+  if (p_SchemaVersion < 4)
+  {
+    // protocol provided sequence orders messages with equal timeSent
+    *p_ProfileCache.db << "ALTER TABLE messages ADD COLUMN sequence INT NOT NULL DEFAULT 0;";
+    *p_ProfileCache.db << "DROP INDEX IF EXISTS messages_chatKey_timeSent;";
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS messages_chatKey_timeSent "
+      "ON messages (chatKey, timeSent DESC, sequence DESC, id DESC);";
+  }
+
+  if (p_SchemaVersion < 5)
+  {
+    // downloaded attachments, evicted least recently accessed first when over budget
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS attachments ("
+      "path TEXT PRIMARY KEY,"
+      "chatId TEXT,"
+      "size INT,"
+      "lastAccess INT"
+      ");";
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS attachments_lastAccess ON attachments (lastAccess);";
+  }
+
+  if (p_SchemaVersion < 6)
+  {
+    // newest (timeSent, sequence) up to which cached chat history is known to be contiguous
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS syncwatermarks ("
+      "chatId TEXT PRIMARY KEY,"
+      "timeSent INT,"
+      "sequence INT"
+      ");";
+  }
+
+  if (p_SchemaVersion < 7)
+  {
+    // outgoing messages pending send, removed once the protocol confirms them
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS outbox ("
+      "outboxKey INTEGER PRIMARY KEY,"
+      "chatId TEXT,"
+      "text TEXT,"
+      "quotedId TEXT,"
+      "quotedText TEXT,"
+      "quotedSender TEXT,"
+      "fileInfo TEXT,"
+      "timeQueued INT,"
+      "attempts INT,"
+      "failed INT"
+      ");";
+  }
+
+  if (p_SchemaVersion < 8)
+  {
+    // per-profile text compression dictionaries, referenced by key from compressed texts
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS textdicts ("
+      "dictKey INTEGER PRIMARY KEY,"
+      "dict BLOB,"
+      "timeCreated INT"
+      ");";
+
+    // quoted texts stored by reference get their own copy when the quoted message is removed
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS messages_chatKey_quotedRef "
+      "ON messages (chatKey, quotedId) WHERE quotedText IS NULL;";
+    *p_ProfileCache.db << "CREATE TRIGGER IF NOT EXISTS messages_quote_delete AFTER DELETE ON messages BEGIN "
+      "UPDATE messages SET quotedText = old.text WHERE chatKey = old.chatKey AND quotedId = old.id AND "
+      "quotedText IS NULL; END;";
+
+    // search index reads expanded texts, recreated as content may now be compressed
+    int hasSearch = 0;
+    *p_ProfileCache.db << "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+      "name = 'messages_fts');" >> hasSearch;
+    if (hasSearch)
+    {
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_insert;";
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_delete;";
+      *p_ProfileCache.db << "DROP TRIGGER IF EXISTS messages_fts_update;";
+      *p_ProfileCache.db << "DROP TABLE IF EXISTS messages_fts;";
+      CreateSearchIndex(p_ProfileCache);
+    }
+  }
+
+  if (p_SchemaVersion < 9)
+  {
+    // unread incoming messages are few, a partial index keeps unread counts and mention flags
+    // index-only, see PerformFetchChatUnreads
+    *p_ProfileCache.db << "ALTER TABLE messages ADD COLUMN hasMention INT NOT NULL DEFAULT 0;";
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS messages_chatKey_unread "
+      "ON messages (chatKey, timeSent DESC, hasMention) WHERE isRead = 0 AND isOutgoing = 0;";
+  }
+
+  if (p_SchemaVersion < 10)
+  {
+    // chat keys of deleted chats with messages remaining, see PerformPurge
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS chatpurges ("
+      "chatKey INTEGER PRIMARY KEY,"
+      "chatId TEXT,"
+      "timeDeleted INT,"
+      "purgeAttachments INT"
+      ");";
+  }
+
+  if (p_SchemaVersion < 11)
+  {
+    // archived messages by id, so lookups and paging probes need no block decode, see PerformArchival.
+    // removed ones, deleted or superseded by a copy in messages, are skipped when reading the archive
+    *p_ProfileCache.db << "CREATE TABLE IF NOT EXISTS archiveids ("
+      "archiveKey INTEGER PRIMARY KEY,"
+      "chatKey INT,"
+      "id TEXT,"
+      "timeSent INT,"
+      "sequence INT,"
+      "blockOffset INT,"
+      "removed INT NOT NULL DEFAULT 0,"
+      "UNIQUE(chatKey, id) ON CONFLICT REPLACE"
+      ");";
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS archiveids_chatKey_timeSent "
+      "ON archiveids (chatKey, timeSent DESC, sequence DESC, id DESC);";
+    *p_ProfileCache.db << "CREATE INDEX IF NOT EXISTS archiveids_chatKey_removed "
+      "ON archiveids (chatKey) WHERE removed = 1;";
+
+    int hasSearch = 0;
+    *p_ProfileCache.db << "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND "
+      "name = 'messages_fts');" >> hasSearch;
+    if (hasSearch)
+    {
+      CreateArchiveSearchIndex(p_ProfileCache);
+    }
+
+    // archives written before the index existed are indexed once
+    for (const auto& chatId : GetArchivedChatIds(p_ProfileCache))
+    {
+      // *INDENT-OFF*
+      GetArchive(p_ProfileCache, chatId)->ForEachBlock([&](size_t p_Offset,
+                                                           const std::vector<ChatMessage>& p_ChatMessages)
+      {
+        InsertArchiveIndex(p_ProfileCache, chatId, p_Offset, p_ChatMessages, hasSearch);
+      });
+      // *INDENT-ON*
+    }
+  }
+
+  if (p_SchemaVersion < 12)
+  {
+    // messages are upserted, so quoted texts stored by reference also get their own copy when the
+    // quoted message is edited
+    *p_ProfileCache.db << "CREATE TRIGGER IF NOT EXISTS messages_quote_update AFTER UPDATE OF text ON messages "
+      "WHEN old.text IS NOT new.text BEGIN "
+      "UPDATE messages SET quotedText = old.text WHERE chatKey = old.chatKey AND quotedId = old.id AND "
+      "quotedText IS NULL; END;";
+  }
+}
+
+// must be called with lock held
+void MessageCache::CreateSearchIndex(ProfileCache& p_ProfileCache)
+{
+  try
+  {
+    *p_ProfileCache.db << "CREATE VIEW IF NOT EXISTS messages_texts AS "
+      "SELECT msgKey, nc_text(text) AS text FROM messages;";
+    *p_ProfileCache.db << "CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts "
+      "USING fts5(text, content='messages_texts', content_rowid='msgKey');";
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    // sqlite built without fts5, search is unavailable but cache remains usable
+    LOG_WARNING("cache search index not supported %d: %s", ex.get_code(), ex.what());
+    return;
+  }
+
+  // external content index is kept in sync by triggers, covering insert, replace and delete
+  *p_ProfileCache.db << "CREATE TRIGGER IF NOT EXISTS messages_fts_insert AFTER INSERT ON messages BEGIN "
+    "INSERT INTO messages_fts (rowid, text) VALUES (new.msgKey, nc_text(new.text)); END;";
+  *p_ProfileCache.db << "CREATE TRIGGER IF NOT EXISTS messages_fts_delete AFTER DELETE ON messages BEGIN "
+    "INSERT INTO messages_fts (messages_fts, rowid, text) VALUES ('delete', old.msgKey, nc_text(old.text)); END;";
+  *p_ProfileCache.db << "CREATE TRIGGER IF NOT EXISTS messages_fts_update AFTER UPDATE OF text ON messages BEGIN "
+    "INSERT INTO messages_fts (messages_fts, rowid, text) VALUES ('delete', old.msgKey, nc_text(old.text)); "
+    "INSERT INTO messages_fts (rowid, text) VALUES (new.msgKey, nc_text(new.text)); END;";
+
+  // index messages cached before the search index was created
+  *p_ProfileCache.db << "INSERT INTO messages_fts (messages_fts) VALUES ('rebuild');";
+
+  CreateArchiveSearchIndex(p_ProfileCache);
+}
+
+// must be called with lock held, within a transaction, may throw sqlite_exception
+void MessageCache::RestoreArchivedMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                          const std::string& p_MsgId)
+{
+  // archived messages are immutable, so one to be updated is first copied back to db, superseding
+  // its archived copy
+  std::vector<std::tuple<std::string, std::string, size_t>> locations;
+  // *INDENT-OFF*
+  GetStatement(p_ProfileCache, "SELECT blockOffset FROM archiveids WHERE "
+               "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ? AND removed = 0;")
+    << p_ChatId << p_MsgId >>
+    [&](int64_t blockOffset)
+    {
+      locations.push_back(std::make_tuple(p_ChatId, p_MsgId, static_cast<size_t>(blockOffset)));
+    };
+  // *INDENT-ON*
+
+  if (locations.empty()) return;
+
+  std::vector<std::pair<std::string, ChatMessage>> chatMessages;
+  GetArchivedMessages(p_ProfileCache, locations, chatMessages);
+  if (chatMessages.empty()) return;
+
+  InsertMessage(p_ProfileCache, p_ChatId, chatMessages.front().second);
+  (GetStatement(p_ProfileCache, "UPDATE archiveids SET removed = 1 WHERE "
+                "chatKey = (SELECT chatKey FROM chatids WHERE id = ?) AND id = ?;") << p_ChatId << p_MsgId).execute();
+  LOG_DEBUG("cache restored archived %s %s", p_ChatId.c_str(), p_MsgId.c_str());
+}
+
+// must be called with lock held
+void MessageCache::CreateArchiveSearchIndex(ProfileCache& p_ProfileCache)
+{
+  // archived texts are only held compressed in archive files, so indexed without content. rows of
+  // removed or purged archived messages are not deleted, as that requires their text, and are
+  // skipped by joining archiveids instead
+  *p_ProfileCache.db << "CREATE VIRTUAL TABLE IF NOT EXISTS archive_fts USING fts5(text, content='');";
+}
+
+// must be called with lock held, may throw sqlite_exception
+void MessageCache::InsertArchiveIndex(ProfileCache& p_ProfileCache, const std::string& p_ChatId, size_t p_Offset,
+                                      const std::vector<ChatMessage>& p_ChatMessages, bool p_HasSearch)
+{
+  sqlite::database_binder& insertStmt =
+    GetStatement(p_ProfileCache, "INSERT INTO archiveids (chatKey, id, timeSent, sequence, blockOffset) VALUES ("
+                 "(SELECT chatKey FROM chatids WHERE id = ?), ?, ?, ?, ?);");
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    insertStmt.reset();
+    (insertStmt << p_ChatId << chatMessage.id << chatMessage.timeSent << chatMessage.sequence
+                << static_cast<int64_t>(p_Offset)).execute();
+
+    if (p_HasSearch && !chatMessage.text.empty())
+    {
+      (GetStatement(p_ProfileCache, "INSERT INTO archive_fts (rowid, text) VALUES (last_insert_rowid(), ?);")
+       << chatMessage.text).execute();
+    }
+  }
+}
+
+std::string MessageCache::GetSearchMatchQuery(const std::string& p_Query)
+{
+  // quote each term to disable fts5 query syntax, and prefix match the last (partially typed) term
+  std::vector<std::string> terms;
+  std::string term;
+  for (const char& ch : p_Query + " ")
+  {
+    if (isspace(static_cast<unsigned char>(ch)))
+    {
+      if (!term.empty())
+      {
+        terms.push_back("\"" + term + "\"");
+        term.clear();
+      }
+    }
+    else if (ch == '"')
+    {
+      term += "\"\"";
+    }
+    else
+    {
+      term += ch;
+    }
+  }
+
+  if (terms.empty()) return "";
+
+  terms.back() += "*";
+  std::string matchQuery;
+  for (const auto& matchTerm : terms)
+  {
+    matchQuery += (matchQuery.empty() ? "" : " ") + matchTerm;
+  }
+
+  return matchQuery;
+}
+
+// must be called with lock held, returned statement is reset and ready for binding
+sqlite::database_binder& MessageCache::GetStatement(ProfileCache& p_ProfileCache, const std::string& p_Sql)
+{
+  return GetStatement(*p_ProfileCache.db, p_ProfileCache.stmts, p_Sql);
+}
+
+// must be called with read lock held
+sqlite::database_binder& MessageCache::GetReadStatement(ProfileCache& p_ProfileCache, const std::string& p_Sql)
+{
+  if (p_ProfileCache.readDb)
+  {
+    return GetStatement(*p_ProfileCache.readDb, p_ProfileCache.readStmts, p_Sql);
+  }
+
+  return GetStatement(*p_ProfileCache.db, p_ProfileCache.stmts, p_Sql);
+}
+
+sqlite::database_binder& MessageCache::GetStatement(sqlite::database& p_Db,
+                                                    std::unordered_map<std::string,
+                                                                       std::unique_ptr<sqlite::database_binder>>& p_Stmts,
+                                                    const std::string& p_Sql)
+{
+  std::unique_ptr<sqlite::database_binder>& stmt = p_Stmts[p_Sql];
+  if (!stmt)
+  {
+    stmt.reset(new sqlite::database_binder(p_Db << p_Sql));
+  }
+  else
+  {
+    stmt->reset();
+  }
+
+  return *stmt;
+}
+
+std::mutex& MessageCache::GetReadMutex(ProfileCache& p_ProfileCache)
+{
+  // read connection is set once at AddProfile
+  return p_ProfileCache.readDb ? p_ProfileCache.readDbMutex : p_ProfileCache.dbMutex;
+}
+
+// must be called with lock held
+void MessageCache::ClearStatements(std::unordered_map<std::string, std::unique_ptr<sqlite::database_binder>>& p_Stmts)
+{
+  for (auto& stmt : p_Stmts)
+  {
+    // prevent sqlite_modern_cpp from executing unused statements on destruction
+    if (stmt.second && !stmt.second->used())
+    {
+      stmt.second->used(true);
+    }
+  }
+
+  p_Stmts.clear();
+}
+
+bool MessageCache::IsWriteRequest(std::shared_ptr<Request> p_Request)
+{
+  switch (p_Request->GetRequestType())
+  {
+    case AddMessagesRequestType:
+    case AddChatsRequestType:
+    case AddContactsRequestType:
+    case DeleteOneMessageRequestType:
+    case DeleteOneChatRequestType:
+    case UpdateMessageIsReadRequestType:
+    case UpdateMessagesIsReadRequestType:
+    case UpdateMessageFileInfoRequestType:
+    case UpdateMuteRequestType:
+    case UpdateAttachmentRequestType:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+void MessageCache::CoalesceRequests(ProfileCache& p_ProfileCache, std::vector<std::shared_ptr<Request>>& p_Requests)
+{
+  // keep only the last read and file info update per message, as each overwrites the previous
+  std::set<std::tuple<RequestType, std::string, std::string>> updatedMsgs;
+  for (auto it = p_Requests.rbegin(); it != p_Requests.rend(); ++it)
+  {
+    const RequestType requestType = (*it)->GetRequestType();
+    if (requestType == UpdateMessageIsReadRequestType)
+    {
+      std::shared_ptr<UpdateMessageIsReadRequest> updateIsReadRequest =
+        std::static_pointer_cast<UpdateMessageIsReadRequest>(*it);
+      if (!updatedMsgs.insert(std::make_tuple(requestType, updateIsReadRequest->chatId,
+                                              updateIsReadRequest->msgId)).second)
+      {
+        it->reset();
+      }
+    }
+    else if (requestType == UpdateMessageFileInfoRequestType)
+    {
+      std::shared_ptr<UpdateMessageFileInfoRequest> updateMessageFileInfoRequest =
+        std::static_pointer_cast<UpdateMessageFileInfoRequest>(*it);
+      if (!updatedMsgs.insert(std::make_tuple(requestType, updateMessageFileInfoRequest->chatId,
+                                              updateMessageFileInfoRequest->msgId)).second)
+      {
+        it->reset();
+      }
+    }
+  }
+
+  // merge adjacent message additions for the same chat, unless pending its in-sync check
+  std::vector<std::shared_ptr<Request>> requests;
+  for (auto& request : p_Requests)
+  {
+    if (!request) continue;
+
+    if (!requests.empty() && (request->GetRequestType() == AddMessagesRequestType) &&
+        (requests.back()->GetRequestType() == AddMessagesRequestType))
+    {
+      std::shared_ptr<AddMessagesRequest> prevRequest = std::static_pointer_cast<AddMessagesRequest>(requests.back());
+      std::shared_ptr<AddMessagesRequest> addMessagesRequest = std::static_pointer_cast<AddMessagesRequest>(request);
+      if ((prevRequest->chatId == addMessagesRequest->chatId) &&
+          IsInSync(p_ProfileCache, addMessagesRequest->chatId))
+      {
+        prevRequest->chatMessageBatches.insert(prevRequest->chatMessageBatches.end(),
+                                               addMessagesRequest->chatMessageBatches.begin(),
+                                               addMessagesRequest->chatMessageBatches.end());
+        continue;
+      }
+    }
+
+    requests.push_back(request);
+  }
+
+  p_Requests.swap(requests);
+}
+
+bool MessageCache::HasMemoryMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                    const std::string& p_MsgId)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  return m_MemoryMessages.Contains(MessageKey(p_ProfileId, p_ChatId, p_MsgId));
+}
+
+bool MessageCache::HasMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::string& p_FromMsgId, const int p_Limit)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  return m_MemoryPages.Contains(PageKey(p_ProfileId, p_ChatId, p_FromMsgId, p_Limit));
+}
+
+bool MessageCache::GetMemoryMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                    const std::string& p_MsgId, std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  ChatMessage chatMessage;
+  if (!m_MemoryMessages.Get(MessageKey(p_ProfileId, p_ChatId, p_MsgId), chatMessage))
+  {
+    ++m_MemoryMisses;
+    PerfStats::Add(PerfStats::StatCacheMisses, 1);
+    return false;
+  }
+
+  ++m_MemoryHits;
+  PerfStats::Add(PerfStats::StatCacheHits, 1);
+  p_ChatMessages.push_back(chatMessage);
+  return true;
+}
+
+bool MessageCache::GetMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::string& p_FromMsgId, const int p_Limit,
+                                 std::vector<ChatMessage>& p_ChatMessages)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  std::vector<std::string> msgIds;
+  if (m_MemoryPages.Get(PageKey(p_ProfileId, p_ChatId, p_FromMsgId, p_Limit), msgIds))
+  {
+    // page is only usable while all its messages remain in memory
+    std::vector<ChatMessage> chatMessages;
+    for (const auto& msgId : msgIds)
+    {
+      ChatMessage chatMessage;
+      if (!m_MemoryMessages.Get(MessageKey(p_ProfileId, p_ChatId, msgId), chatMessage)) break;
+
+      chatMessages.push_back(std::move(chatMessage));
+    }
+
+    if (chatMessages.size() == msgIds.size())
+    {
+      ++m_MemoryHits;
+      PerfStats::Add(PerfStats::StatCacheHits, 1);
+      p_ChatMessages = chatMessages;
+      return true;
+    }
+  }
+
+  ++m_MemoryMisses;
+  PerfStats::Add(PerfStats::StatCacheMisses, 1);
+  return false;
+}
+
+void MessageCache::PutMemoryMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                     const std::vector<ChatMessage>& p_ChatMessages, uint64_t p_Generation)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  if (p_Generation != m_MemoryGeneration) return;
+
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    m_MemoryMessages.Put(MessageKey(p_ProfileId, p_ChatId, chatMessage.id), chatMessage,
+                         GetMemorySize(chatMessage));
+  }
+}
+
+void MessageCache::PutMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::string& p_FromMsgId, const int p_Limit,
+                                 const std::vector<ChatMessage>& p_ChatMessages, uint64_t p_Generation)
+{
+  if (p_ChatMessages.empty()) return;
+
+  PutMemoryMessages(p_ProfileId, p_ChatId, p_ChatMessages, p_Generation);
+
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  if (p_Generation != m_MemoryGeneration) return;
+
+  std::vector<std::string> msgIds;
+  size_t size = sizeof(msgIds) + p_FromMsgId.size();
+  for (const auto& chatMessage : p_ChatMessages)
+  {
+    msgIds.push_back(chatMessage.id);
+    size += sizeof(std::string) + chatMessage.id.size();
+  }
+
+  m_MemoryPages.Put(PageKey(p_ProfileId, p_ChatId, p_FromMsgId, p_Limit), msgIds, size);
+}
+
+uint64_t MessageCache::GetMemoryGeneration()
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  return m_MemoryGeneration;
+}
+
+void MessageCache::UpdateMemory(std::shared_ptr<Request> p_Request)
+{
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  const std::string& profileId = p_Request->profileId;
+  switch (p_Request->GetRequestType())
+  {
+    case AddMessagesRequestType:
+      {
+        const AddMessagesRequest& addMessagesRequest = static_cast<const AddMessagesRequest&>(*p_Request);
+        const std::string& chatId = addMessagesRequest.chatId;
+        for (const auto& chatMessageBatch : addMessagesRequest.chatMessageBatches)
+        {
+          for (const auto& chatMessage : *chatMessageBatch)
+          {
+            const MessageKey messageKey(profileId, chatId, chatMessage.id);
+            if (m_MemoryMessages.Contains(messageKey))
+            {
+              // match db content, which excludes fields not cached
+              ChatMessage cachedMessage = chatMessage;
+              cachedMessage.link.clear();
+              cachedMessage.hasMention = false;
+              m_MemoryMessages.Put(messageKey, cachedMessage, GetMemorySize(cachedMessage));
+            }
+          }
+        }
+
+        // new messages may belong in any cached page of the chat
+        m_MemoryPages.RemoveRange(PageKey(profileId, chatId, "", INT_MIN),
+                                  PageKey(profileId, chatId + '\0', "", INT_MIN));
+      }
+      break;
+
+    case DeleteOneMessageRequestType:
+      {
+        const DeleteOneMessageRequest& deleteOneMessageRequest =
+          static_cast<const DeleteOneMessageRequest&>(*p_Request);
+        m_MemoryMessages.Remove(MessageKey(profileId, deleteOneMessageRequest.chatId,
+                                           deleteOneMessageRequest.msgId));
+      }
+      break;
+
+    case DeleteOneChatRequestType:
+      {
+        const DeleteOneChatRequest& deleteOneChatRequest = static_cast<const DeleteOneChatRequest&>(*p_Request);
+        RemoveMemoryChat(profileId, deleteOneChatRequest.chatId);
+      }
+      break;
+
+    case UpdateMessageIsReadRequestType:
+      {
+        const UpdateMessageIsReadRequest& updateMessageIsReadRequest =
+          static_cast<const UpdateMessageIsReadRequest&>(*p_Request);
+        const MessageKey messageKey(profileId, updateMessageIsReadRequest.chatId,
+                                    updateMessageIsReadRequest.msgId);
+        ChatMessage chatMessage;
+        if (m_MemoryMessages.Get(messageKey, chatMessage))
+        {
+          chatMessage.isRead = updateMessageIsReadRequest.isRead;
+          m_MemoryMessages.Put(messageKey, chatMessage, GetMemorySize(chatMessage));
+        }
+      }
+      break;
+
+    case UpdateMessagesIsReadRequestType:
+      {
+        // range update may touch any cached message of the chat
+        const UpdateMessagesIsReadRequest& updateMessagesIsReadRequest =
+          static_cast<const UpdateMessagesIsReadRequest&>(*p_Request);
+        const std::string& chatId = updateMessagesIsReadRequest.chatId;
+        m_MemoryMessages.RemoveRange(MessageKey(profileId, chatId, ""),
+                                     MessageKey(profileId, chatId + '\0', ""));
+      }
+      break;
+
+    case UpdateMessageFileInfoRequestType:
+      {
+        const UpdateMessageFileInfoRequest& updateMessageFileInfoRequest =
+          static_cast<const UpdateMessageFileInfoRequest&>(*p_Request);
+        const MessageKey messageKey(profileId, updateMessageFileInfoRequest.chatId,
+                                    updateMessageFileInfoRequest.msgId);
+        ChatMessage chatMessage;
+        if (m_MemoryMessages.Get(messageKey, chatMessage))
+        {
+          chatMessage.fileInfo = updateMessageFileInfoRequest.fileInfo;
+          m_MemoryMessages.Put(messageKey, chatMessage, GetMemorySize(chatMessage));
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  ++m_MemoryGeneration;
+}
+
+void MessageCache::RemoveMemoryChat(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  // caller must hold m_MemoryMutex
+  m_MemoryMessages.RemoveRange(MessageKey(p_ProfileId, p_ChatId, ""),
+                               MessageKey(p_ProfileId, p_ChatId + '\0', ""));
+  m_MemoryPages.RemoveRange(PageKey(p_ProfileId, p_ChatId, "", INT_MIN),
+                            PageKey(p_ProfileId, p_ChatId + '\0', "", INT_MIN));
+}
+
+size_t MessageCache::GetMemorySize(const ChatMessage& p_ChatMessage)
+{
+  // approximate, including key strings
+  return sizeof(ChatMessage) + (3 * sizeof(std::string)) + (2 * p_ChatMessage.id.size()) +
+         p_ChatMessage.senderId.size() + p_ChatMessage.text.size() + p_ChatMessage.quotedId.size() +
+         p_ChatMessage.quotedText.size() + p_ChatMessage.quotedSender.size() + p_ChatMessage.fileInfo.size();
+}
+
+size_t MessageCache::GetRequestHeapSize(const Request& p_Request)
+{
+  // approximate, request object and shared pointer control block, plus held messages and infos
+  static const size_t s_RequestBaseSize = 128;
+  size_t size = s_RequestBaseSize;
+  switch (p_Request.GetRequestType())
+  {
+    case AddMessagesRequestType:
+      for (const auto& chatMessageBatch : static_cast<const AddMessagesRequest&>(p_Request).chatMessageBatches)
+      {
+        for (const auto& chatMessage : *chatMessageBatch)
+        {
+          size += GetMemorySize(chatMessage);
+        }
+      }
+      break;
+
+    case AddChatsRequestType:
+      for (const auto& chatInfo : static_cast<const AddChatsRequest&>(p_Request).chatInfos)
+      {
+        size += sizeof(ChatInfo) + HeapSize::Of(chatInfo.id);
+      }
+      break;
+
+    case AddContactsRequestType:
+      for (const auto& contactInfo : static_cast<const AddContactsRequest&>(p_Request).contactInfos)
+      {
+        size += sizeof(ContactInfo) + HeapSize::Of(contactInfo.id) + HeapSize::Of(contactInfo.name) +
+          HeapSize::Of(contactInfo.phone);
+      }
+      break;
+
+    case FetchMessagesRequestType:
+      for (const auto& msgId : static_cast<const FetchMessagesRequest&>(p_Request).msgIds)
+      {
+        size += sizeof(std::string) + HeapSize::Of(msgId);
+      }
+      break;
+
+    case FetchChatUnreadsRequestType:
+      for (const auto& chatId : static_cast<const FetchChatUnreadsRequest&>(p_Request).chatIds)
+      {
+        size += sizeof(std::string) + HeapSize::Of(chatId);
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return size;
+}
+
+int64_t MessageCache::GetRequestsHeapSize(const std::vector<std::shared_ptr<Request>>& p_Requests)
+{
+  int64_t size = 0;
+  for (const auto& request : p_Requests)
+  {
+    size += GetRequestHeapSize(*request);
+  }
+
+  return size;
+}
+
+size_t MessageCache::GetMemoryHeapSize()
+{
+  // lru sizes are approximate bytes, see GetMemorySize
+  std::unique_lock<std::mutex> lock(m_MemoryMutex);
+  return m_MemoryMessages.GetSize() + m_MemoryPages.GetSize();
+}
+
+bool MessageCache::IsInSync(ProfileCache& p_ProfileCache, const std::string& p_ChatId)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+  return !p_ProfileCache.checkSync || p_ProfileCache.inSync[p_ChatId];
+}
+
+void MessageCache::SetInSync(ProfileCache& p_ProfileCache, const std::string& p_ChatId)
+{
+  std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+  p_ProfileCache.inSync[p_ChatId] = true;
+}
+
+bool MessageCache::IsBeforeSyncWatermark(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                         const std::string& p_FromMsgId)
+{
+  // history older than a message at or before the persisted watermark may be served before sync check
+  if (p_FromMsgId.empty()) return false;
+
+  std::pair<int64_t, int64_t> syncWatermark;
+  {
+    std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+    auto it = p_ProfileCache.syncWatermarks.find(p_ChatId);
+    if (it == p_ProfileCache.syncWatermarks.end()) return false;
+
+    syncWatermark = it->second;
+  }
+
+  int64_t fromMsgIdTimeSent = 0;
+  int64_t fromMsgIdSequence = 0;
+  std::unique_lock<std::mutex> lock(GetReadMutex(p_ProfileCache));
+  try
+  {
+    GetFromMsgIdKey(p_ProfileCache, p_ChatId, p_FromMsgId, fromMsgIdTimeSent, fromMsgIdSequence);
+  }
+  catch (const sqlite::sqlite_exception& ex)
+  {
+    HANDLE_SQLITE_EXCEPTION(ex);
+  }
+
+  if ((fromMsgIdTimeSent == 0) && (fromMsgIdSequence == 0)) return false; // not cached
+
+  return std::make_pair(fromMsgIdTimeSent, fromMsgIdSequence) <= syncWatermark;
+}
+
+// must be called with lock held, may throw sqlite_exception
+void MessageCache::UpdateSyncWatermark(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                       const AddMessagesRequest& p_AddMessagesRequest)
+{
+  if (!p_ProfileCache.checkSync || !IsInSync(p_ProfileCache, p_ChatId)) return;
+
+  // messages added while in sync extend the contiguous history, sponsored messages excluded
+  std::pair<int64_t, int64_t> newestKey(0, 0);
+  for (const auto& chatMessageBatch : p_AddMessagesRequest.chatMessageBatches)
+  {
+    for (const auto& msg : *chatMessageBatch)
+    {
+      if (msg.timeSent == std::numeric_limits<int64_t>::max()) continue;
+
+      newestKey = std::max(newestKey, std::make_pair(msg.timeSent, msg.sequence));
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+    auto it = p_ProfileCache.syncWatermarks.find(p_ChatId);
+    if ((newestKey.first == 0) ||
+        ((it != p_ProfileCache.syncWatermarks.end()) && (newestKey <= it->second))) return;
+
+    p_ProfileCache.syncWatermarks[p_ChatId] = newestKey;
+  }
+
+  (GetStatement(p_ProfileCache, "INSERT OR REPLACE INTO syncwatermarks (chatId, timeSent, sequence) "
+                "VALUES (?, ?, ?);") << p_ChatId << newestKey.first << newestKey.second).execute();
+}
+
+// must be called with lock held, may throw sqlite_exception
+void MessageCache::LoadSyncWatermarks(ProfileCache& p_ProfileCache)
+{
+  if (!p_ProfileCache.checkSync) return;
+
+  std::unique_lock<std::mutex> lock(p_ProfileCache.syncMutex);
+  // *INDENT-OFF*
+  *p_ProfileCache.db << "SELECT chatId, timeSent, sequence FROM syncwatermarks;" >>
+    [&](const std::string& p_ChatId, int64_t p_TimeSent, int64_t p_Sequence)
+    {
+      p_ProfileCache.syncWatermarks[p_ChatId] = std::make_pair(p_TimeSent, p_Sequence);
+    };
+  // *INDENT-ON*
+
+  LOG_DEBUG("cache loaded %d sync watermarks for %s", p_ProfileCache.syncWatermarks.size(),
+            p_ProfileCache.profileId.c_str());
+}
+
+// may throw sqlite_exception
+void MessageCache::LoadTextDictionaries(ProfileCache& p_ProfileCache)
+{
+  // *INDENT-OFF*
+  *p_ProfileCache.db << "SELECT dictKey, dict FROM textdicts;" >>
+    [&](int64_t p_DictKey, const std::vector<char>& p_Dict)
+    {
+      p_ProfileCache.textCompressor->AddDictionary(p_DictKey, std::string(p_Dict.begin(), p_Dict.end()));
+    };
+  // *INDENT-ON*
+
+  if (!p_ProfileCache.compressText || p_ProfileCache.textCompressor->HasDictionary()) return;
+
+  // trained once from recent messages, until then texts are compressed without dictionary
+  std::vector<std::string> samples;
+  // *INDENT-OFF*
+  *p_ProfileCache.db << "SELECT nc_text(text) FROM messages ORDER BY msgKey DESC LIMIT ?;" << s_TextDictSamples >>
+    [&](const std::string& p_Text)
+    {
+      samples.push_back(p_Text);
+    };
+  // *INDENT-ON*
+
+  const std::string dict = TextCompressor::TrainDictionary(samples);
+  if (dict.empty()) return;
+
+  *p_ProfileCache.db << "INSERT INTO textdicts (dict, timeCreated) VALUES (?, ?);" <<
+    std::vector<char>(dict.begin(), dict.end()) << TimeUtil::GetCurrentTimeMSec();
+  p_ProfileCache.textCompressor->AddDictionary(p_ProfileCache.db->last_insert_rowid(), dict);
+  LOG_INFO("cache trained text dictionary %d bytes from %d messages for %s", dict.size(), samples.size(),
+           p_ProfileCache.profileId.c_str());
+}
+
+std::shared_ptr<MessageCache::ProfileCache> MessageCache::GetProfileCache(const std::string& p_ProfileId)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  auto it = m_ProfileCaches.find(p_ProfileId);
+  return (it != m_ProfileCaches.end()) ? it->second : nullptr;
+}
+
+void MessageCache::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  std::function<void(std::shared_ptr<ServiceMessage>)> messageHandler;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    messageHandler = m_MessageHandler;
+  }
+
+  if (messageHandler)
   {
-    m_MessageHandler(p_ServiceMessage);
+    messageHandler(p_ServiceMessage);
   }
   else
   {
@@ -7,23 +7,31 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "lrucache.h"
 #include "protocol.h"
 
 namespace sqlite
 {
   class database;
+  class database_binder;
 }
 
+class MessageArchive;
+class TextCompressor;
+
 class MessageCache
 {
 private:
@@ -40,8 +48,14 @@ private:
     DeleteOneMessageRequestType,
     DeleteOneChatRequestType,
     UpdateMessageIsReadRequestType,
+    UpdateMessagesIsReadRequestType,
     UpdateMessageFileInfoRequestType,
     UpdateMuteRequestType,
+    SearchRequestType,
+    UpdateAttachmentRequestType,
+    FetchMessagesRequestType,
+    FetchChatUnreadsRequestType,
+    FetchLatestForChatsRequestType,
   };
 
   class Request
@@ -49,23 +63,36 @@ private:
   public:
     virtual ~Request() { }
     virtual RequestType GetRequestType() const { return UnknownRequestType; }
+    std::string profileId;
+    uint64_t seq = 0; // enqueue order within profile, set by EnqueueRequest
   };
 
   class AddMessagesRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return AddMessagesRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string fromMsgId;
-    std::vector<ChatMessage> chatMessages;
+    // batches are shared read-only with their originating notify, and merged requests keep
+    // one entry per batch, so messages are not copied on the way to the db
+    std::vector<std::shared_ptr<const std::vector<ChatMessage>>> chatMessageBatches;
+
+    size_t GetMessageCount() const
+    {
+      size_t count = 0;
+      for (const auto& chatMessageBatch : chatMessageBatches)
+      {
+        count += chatMessageBatch->size();
+      }
+
+      return count;
+    }
   };
 
   class AddChatsRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return AddChatsRequestType; }
-    std::string profileId;
     std::vector<ChatInfo> chatInfos;
   };
 
@@ -73,7 +100,6 @@ private:
   {
   public:
     virtual RequestType GetRequestType() const { return AddContactsRequestType; }
-    std::string profileId;
     std::vector<ContactInfo> contactInfos;
   };
 
@@ -81,41 +107,61 @@ private:
   {
   public:
     virtual RequestType GetRequestType() const { return FetchChatsRequestType; }
-    std::string profileId;
     std::unordered_set<std::string> chatIds; // optionally fetch only specified chats
+    int snapshotChats = 0; // optionally fetch latest messages of most recent chats
+    int snapshotMessages = 0;
   };
 
   class FetchContactsRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return FetchContactsRequestType; }
-    std::string profileId;
   };
 
   class FetchMessagesFromRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return FetchMessagesFromRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string fromMsgId;
     int limit = 0;
   };
 
+  class FetchLatestForChatsRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return FetchLatestForChatsRequestType; }
+    std::vector<std::string> chatIds;
+    int limit = 0; // per chat
+  };
+
   class FetchOneMessageRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return FetchOneMessageRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string msgId;
   };
 
+  class FetchMessagesRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return FetchMessagesRequestType; }
+    std::string chatId;
+    std::vector<std::string> msgIds;
+  };
+
+  class FetchChatUnreadsRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return FetchChatUnreadsRequestType; }
+    std::vector<std::string> chatIds; // optionally fetch only specified chats
+  };
+
   class DeleteOneMessageRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return DeleteOneMessageRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string msgId;
   };
@@ -124,7 +170,6 @@ private:
   {
   public:
     virtual RequestType GetRequestType() const { return DeleteOneChatRequestType; }
-    std::string profileId;
     std::string chatId;
   };
 
@@ -132,17 +177,24 @@ private:
   {
   public:
     virtual RequestType GetRequestType() const { return UpdateMessageIsReadRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string msgId;
     bool isRead = false;
   };
 
+  class UpdateMessagesIsReadRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return UpdateMessagesIsReadRequestType; }
+    std::string chatId;
+    std::string msgId;
+    bool isOutgoing = false; // received or sent messages
+  };
+
   class UpdateMessageFileInfoRequest : public Request
   {
   public:
     virtual RequestType GetRequestType() const { return UpdateMessageFileInfoRequestType; }
-    std::string profileId;
     std::string chatId;
     std::string msgId;
     std::string fileInfo;
@@ -152,67 +204,331 @@ private:
   {
   public:
     virtual RequestType GetRequestType() const { return UpdateMuteRequestType; }
-    std::string profileId;
     std::string chatId;
     bool isMuted;
   };
 
+  class UpdateAttachmentRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return UpdateAttachmentRequestType; }
+    std::string chatId;
+    std::string filePath;
+    bool isAccess = false; // only refresh last access time, if already indexed
+  };
+
+  // downloaded attachment, indexed by file path
+  struct AttachmentEntry
+  {
+    std::string profileId;
+    std::string chatId;
+    int64_t size = 0;
+    int64_t lastAccess = 0; // sec since epoch
+  };
+
+  class SearchRequest : public Request
+  {
+  public:
+    virtual RequestType GetRequestType() const { return SearchRequestType; }
+    std::string query;
+    int limit = 0;
+  };
+
+  typedef std::tuple<std::string, std::string, std::string> MessageKey; // profile, chat and message id
+  typedef std::tuple<std::string, std::string, std::string, int> PageKey; // profile, chat, from msg id and limit
+
+  class RetentionPolicy
+  {
+  public:
+    int maxAgeDays = -1; // -1 = inherit, 0 = unlimited
+    int maxMessages = -1;
+  };
+
+  class ProfileCache
+  {
+  public:
+    std::string profileId;
+    std::string dbPath;
+    // decodes compressed texts for all connections, so must outlive them
+    std::shared_ptr<TextCompressor> textCompressor;
+    bool compressText = false;
+    std::mutex dbMutex;
+    std::unique_ptr<sqlite::database> db;
+    std::unordered_map<std::string, std::unique_ptr<sqlite::database_binder>> stmts;
+    bool hasSearch = false;
+
+    // separate read connection in wal mode, otherwise reads use db
+    std::mutex readDbMutex;
+    std::unique_ptr<sqlite::database> readDb;
+    std::unordered_map<std::string, std::unique_ptr<sqlite::database_binder>> readStmts;
+
+    std::mutex syncMutex;
+    std::unordered_map<std::string, bool> inSync;
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>> syncWatermarks; // newest contiguous key per chat
+    bool checkSync = false;
+
+    // chats pending conversion from legacy schema, only accessed by worker thread after AddProfile
+    std::deque<std::string> legacyChatQueue;
+    std::set<std::string> legacyChatIds;
+    std::atomic<bool> hasLegacyMessages{ false };
+
+    // retention runs as a background executor job, at most one pending per profile
+    std::atomic<bool> retentionPending{ false };
+    std::atomic<bool> retentionHasMore{ false };
+
+    // messages of deleted chats remain to be purged, only accessed by worker thread after AddProfile
+    bool purgePending = false;
+
+    // only accessed by worker thread and retention job after AddProfile
+    RetentionPolicy retentionPolicy;
+    std::map<std::string, RetentionPolicy> chatRetentionPolicies;
+    int64_t retentionMaxSize = 0; // bytes, 0 = unlimited
+    int64_t attachmentsMaxSize = 0; // bytes, 0 = unlimited
+    int64_t archiveAge = 0; // msec, 0 = disabled
+
+    // append-only archives of cold messages per chat, see PerformArchival
+    std::string archiveDir;
+    std::mutex archiveMutex;
+    std::unordered_map<std::string, std::shared_ptr<MessageArchive>> archives;
+
+    bool running = false;
+    int64_t stopTime = 0; // msec, set by Cleanup when running is cleared
+    std::thread thread;
+    std::mutex queueMutex;
+    std::condition_variable condVar;
+    std::deque<std::shared_ptr<Request>> queue;
+    size_t queueHeapSize = 0; // approximate bytes held by queued requests
+    std::condition_variable queueSpaceCondVar; // signalled when queue drops below its max size
+    uint64_t enqueueSeq = 0; // last request enqueued
+    uint64_t processedSeq = 0; // last request performed, writes before it committed
+    std::unordered_map<std::string, uint64_t> chatWriteSeqs; // last message write enqueued per chat, until processed
+  };
+
+public:
+  // outgoing message not yet confirmed sent by the protocol, persisted so it survives restarts
+  struct OutboxEntry
+  {
+    int64_t key = 0; // unique per profile, orders entries in send order
+    std::string chatId;
+    ChatMessage chatMessage;
+    int attempts = 0;
+    bool failed = false;
+  };
+
 public:
   static void Init();
   static void Cleanup();
+  static void SetReadOnly(bool p_ReadOnly);
+  static void ReleaseMemory();
+  static size_t GetMemoryHeapSize();
   static void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler);
 
   static void AddFromServiceMessage(const std::string& p_ProfileId, std::shared_ptr<ServiceMessage> p_ServiceMessage);
 
   static void AddProfile(const std::string& p_ProfileId, bool p_CheckSync, int p_DirVersion, bool p_IsSetup);
+  static bool HasProfile(const std::string& p_ProfileId);
   static void AddMessages(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_FromMsgId,
                           const std::vector<ChatMessage>& p_ChatMessages);
+  static void AddMessages(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_FromMsgId,
+                          std::shared_ptr<const std::vector<ChatMessage>> p_ChatMessages);
+  static void AddFoundMessages(const std::string& p_ProfileId,
+                               const std::vector<std::pair<std::string, ChatMessage>>& p_ChatMessages);
   static void AddChats(const std::string& p_ProfileId, const std::vector<ChatInfo>& p_ChatInfos);
   static void AddContacts(const std::string& p_ProfileId, const std::vector<ContactInfo>& p_ContactInfos);
   static bool FetchChats(const std::string& p_ProfileId, const std::unordered_set<std::string>& p_ChatIds);
   static bool FetchContacts(const std::string& p_ProfileId);
+  static bool FetchSnapshot(const std::string& p_ProfileId, const int p_ChatLimit, const int p_MessageLimit);
   static bool FetchMessagesFrom(const std::string& p_ProfileId, const std::string& p_ChatId,
                                 const std::string& p_FromMsgId,
                                 const int p_Limit, const bool p_Sync);
+  static bool FetchLatestForChats(const std::string& p_ProfileId, const std::vector<std::string>& p_ChatIds,
+                                  const int p_PerChatLimit, const bool p_Sync);
   static bool FetchOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
                               const std::string& p_MsgId, const bool p_Sync);
+  static bool FetchMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                            const std::vector<std::string>& p_MsgIds, std::vector<std::string>& p_MissingMsgIds);
+  static bool FetchChatUnreads(const std::string& p_ProfileId, const std::vector<std::string>& p_ChatIds);
   static void DeleteOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId);
   static void DeleteChat(const std::string& p_ProfileId, const std::string& p_ChatId);
   static void UpdateMessageIsRead(const std::string& p_ProfileId, const std::string& p_ChatId,
                                   const std::string& p_MsgId,
                                   bool p_IsRead);
+  static void UpdateMessagesIsRead(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                   const std::string& p_MsgId, bool p_IsOutgoing);
   static void UpdateMessageFileInfo(const std::string& p_ProfileId, const std::string& p_ChatId,
                                     const std::string& p_MsgId, const std::string& p_FileInfo);
 
   static void UpdateMute(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsMuted);
-  static void Export(const std::string& p_ExportDir);
+  static void AddAttachment(const std::string& p_ProfileId, const std::string& p_ChatId,
+                            const std::string& p_FilePath);
+  static void AccessAttachment(const std::string& p_ProfileId, const std::string& p_ChatId,
+                               const std::string& p_FilePath);
+  static bool IsAttachmentIndexed(const std::string& p_FilePath);
+  static uint64_t GetAttachmentGeneration();
+  static void GetMemoryStats(int64_t& p_Hits, int64_t& p_Misses);
+  static void Export(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental);
+  static bool StartExport(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental);
+  static bool IsExportRunning();
+  static bool IsExportFormat(const std::string& p_ExportFormat);
+  static bool Search(const std::string& p_ProfileId, const std::string& p_Query, const int p_Limit,
+                     const bool p_Sync);
+  static bool AddOutbox(const std::string& p_ProfileId, const OutboxEntry& p_OutboxEntry);
+  static void UpdateOutbox(const std::string& p_ProfileId, const OutboxEntry& p_OutboxEntry);
+  static void RemoveOutbox(const std::string& p_ProfileId, int64_t p_Key);
+  static std::vector<OutboxEntry> FetchOutbox(const std::string& p_ProfileId);
+  static bool WaitQueueSpace(const std::string& p_ProfileId, int p_TimeoutMs);
 
 private:
-  static void Process();
+  static void Process(std::shared_ptr<ProfileCache> p_ProfileCache);
   static void EnqueueRequest(std::shared_ptr<Request> p_Request);
+  static bool HasChatWrites(ProfileCache& p_ProfileCache, const std::string& p_ChatId);
+  static void SetProcessed(ProfileCache& p_ProfileCache, uint64_t p_Seq);
   static void PerformRequest(std::shared_ptr<Request> p_Request);
-  static void PerformFetchMessagesFrom(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                       const int64_t p_FromMsgIdTimeSent, const int p_Limit,
+  static void PerformWriteRequests(ProfileCache& p_ProfileCache,
+                                   const std::vector<std::shared_ptr<Request>>& p_Requests);
+  static void PerformWriteRequest(ProfileCache& p_ProfileCache, std::shared_ptr<Request> p_Request);
+  static void PerformFetchMessagesFrom(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                       const int64_t p_FromMsgIdTimeSent, const int64_t p_FromMsgIdSequence,
+                                       const std::string& p_FromMsgId, const int p_Limit,
                                        std::vector<ChatMessage>& p_ChatMessages);
-  static void PerformFetchOneMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+  static void PerformFetchLatestForChats(ProfileCache& p_ProfileCache, const std::vector<std::string>& p_ChatIds,
+                                         const int p_Limit,
+                                         std::map<std::string, std::vector<ChatMessage>>& p_ChatMessages);
+  static void PerformFetchOneMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
                                      const std::string& p_MsgId, std::vector<ChatMessage>& p_ChatMessages);
+  static void PerformFetchMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                   const std::vector<std::string>& p_MsgIds, std::vector<ChatMessage>& p_ChatMessages);
+  static void LocateArchivedMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                     const std::vector<std::string>& p_MsgIds,
+                                     const std::vector<ChatMessage>& p_ChatMessages,
+                                     std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations);
+  static void PerformFetchChatUnreads(ProfileCache& p_ProfileCache, const std::vector<std::string>& p_ChatIds,
+                                      std::vector<ChatUnreadInfo>& p_ChatUnreadInfos);
+  static std::vector<std::vector<std::string>> GetInParamChunks(const std::vector<std::string>& p_Ids);
+
+  static void PerformExport(const std::string& p_ExportDir, const std::string& p_ExportFormat, bool p_Incremental,
+                            bool p_Background);
+  static void ExportChat(sqlite::database& p_Db, const std::string& p_DirPath, const std::string& p_ChatId,
+                         const std::map<std::string, std::string>& p_ContactNames, bool p_IsJsonl,
+                         std::pair<int64_t, std::string>& p_Watermark, std::mutex& p_OutMutex,
+                         std::shared_ptr<MessageArchive> p_Archive, bool p_Background);
+  static std::map<std::string, std::pair<int64_t, std::string>> LoadExportWatermarks(const std::string& p_DirPath);
+  static void SaveExportWatermarks(const std::string& p_DirPath,
+                                   const std::map<std::string, std::pair<int64_t, std::string>>& p_Watermarks);
+
+  static void InsertMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                            const ChatMessage& p_ChatMessage);
+  static void LoadLegacyChats(ProfileCache& p_ProfileCache);
+  static int MigrateLegacyChat(ProfileCache& p_ProfileCache, const std::string& p_ChatId, int p_Limit);
+  static void PerformMigration(ProfileCache& p_ProfileCache);
+  static std::string GetFileInfo(bool p_HasFile, int p_FileStatus, const std::string& p_FileId,
+                                 const std::string& p_FilePath, const std::string& p_FileType);
 
+  static void LoadRetentionPolicies(ProfileCache& p_ProfileCache);
+  static bool HasRetentionPolicy(ProfileCache& p_ProfileCache);
+  static bool PerformRetention(ProfileCache& p_ProfileCache);
+  static void LoadAttachments(ProfileCache& p_ProfileCache);
+  static bool PerformAttachmentRetention(ProfileCache& p_ProfileCache);
+  static bool PerformArchival(ProfileCache& p_ProfileCache);
+  static bool PerformPurge(ProfileCache& p_ProfileCache);
+  static std::shared_ptr<MessageArchive> GetArchive(ProfileCache& p_ProfileCache, const std::string& p_ChatId);
+  static std::vector<std::string> GetArchivedChatIds(ProfileCache& p_ProfileCache);
+  static void InsertArchiveIndex(ProfileCache& p_ProfileCache, const std::string& p_ChatId, size_t p_Offset,
+                                 const std::vector<ChatMessage>& p_ChatMessages, bool p_HasSearch);
+  static void GetArchivedMessages(ProfileCache& p_ProfileCache,
+                                  const std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations,
+                                  std::vector<std::pair<std::string, ChatMessage>>& p_ChatMessages);
+  static void GetArchivedMessages(ProfileCache& p_ProfileCache,
+                                  const std::vector<std::tuple<std::string, std::string, size_t>>& p_Locations,
+                                  std::vector<ChatMessage>& p_ChatMessages);
+  static void MergeArchivedMessages(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                    const int64_t p_FromMsgIdTimeSent, const int64_t p_FromMsgIdSequence,
+                                    const std::string& p_FromMsgId, const int p_Limit,
+                                    std::vector<ChatMessage>& p_ChatMessages);
+  static void RestoreArchivedMessage(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                     const std::string& p_MsgId);
+
+  static void GetFromMsgIdKey(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                              const std::string& p_FromMsgId, int64_t& p_TimeSent, int64_t& p_Sequence);
+  static void MigrateSchema(ProfileCache& p_ProfileCache);
+  static void PerformSchemaMigration(ProfileCache& p_ProfileCache, int p_SchemaVersion);
+  static void CreateSearchIndex(ProfileCache& p_ProfileCache);
+  static void CreateArchiveSearchIndex(ProfileCache& p_ProfileCache);
+  static std::string GetSearchMatchQuery(const std::string& p_Query);
+  static sqlite::database_binder& GetStatement(ProfileCache& p_ProfileCache, const std::string& p_Sql);
+  static sqlite::database_binder& GetReadStatement(ProfileCache& p_ProfileCache, const std::string& p_Sql);
+  static sqlite::database_binder& GetStatement(sqlite::database& p_Db,
+                                               std::unordered_map<std::string,
+                                                                  std::unique_ptr<sqlite::database_binder>>& p_Stmts,
+                                               const std::string& p_Sql);
+  static std::mutex& GetReadMutex(ProfileCache& p_ProfileCache);
+  static void ClearStatements(std::unordered_map<std::string, std::unique_ptr<sqlite::database_binder>>& p_Stmts);
+
+  static bool IsWriteRequest(std::shared_ptr<Request> p_Request);
+  static void CoalesceRequests(ProfileCache& p_ProfileCache, std::vector<std::shared_ptr<Request>>& p_Requests);
+  static void PerformShutdownFlush(ProfileCache& p_ProfileCache, std::vector<std::shared_ptr<Request>>& p_Requests,
+                                   int64_t p_StopTime);
+  static bool HasMemoryMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                               const std::string& p_MsgId);
+  static bool HasMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                            const std::string& p_FromMsgId, const int p_Limit);
+  static bool GetMemoryMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                               const std::string& p_MsgId, std::vector<ChatMessage>& p_ChatMessages);
+  static bool GetMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                            const std::string& p_FromMsgId, const int p_Limit,
+                            std::vector<ChatMessage>& p_ChatMessages);
+  static void PutMemoryMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                const std::vector<ChatMessage>& p_ChatMessages, uint64_t p_Generation);
+  static void PutMemoryPage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                            const std::string& p_FromMsgId, const int p_Limit,
+                            const std::vector<ChatMessage>& p_ChatMessages, uint64_t p_Generation);
+  static uint64_t GetMemoryGeneration();
+  static void UpdateMemory(std::shared_ptr<Request> p_Request);
+  static void RemoveMemoryChat(const std::string& p_ProfileId, const std::string& p_ChatId);
+  static size_t GetMemorySize(const ChatMessage& p_ChatMessage);
+  static size_t GetRequestHeapSize(const Request& p_Request);
+  static int64_t GetRequestsHeapSize(const std::vector<std::shared_ptr<Request>>& p_Requests);
+
+  static bool IsInSync(ProfileCache& p_ProfileCache, const std::string& p_ChatId);
+  static void SetInSync(ProfileCache& p_ProfileCache, const std::string& p_ChatId);
+  static bool IsBeforeSyncWatermark(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                    const std::string& p_FromMsgId);
+  static void UpdateSyncWatermark(ProfileCache& p_ProfileCache, const std::string& p_ChatId,
+                                  const AddMessagesRequest& p_AddMessagesRequest);
+  static void LoadSyncWatermarks(ProfileCache& p_ProfileCache);
+  static void LoadTextDictionaries(ProfileCache& p_ProfileCache);
+  static std::shared_ptr<ProfileCache> GetProfileCache(const std::string& p_ProfileId);
   static void CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
 
 private:
   static std::function<void(std::shared_ptr<ServiceMessage>)> m_MessageHandler;
 
-  static std::mutex m_DbMutex;
-  static std::map<std::string, std::unique_ptr<sqlite::database>> m_Dbs;
-  static std::unordered_map<std::string, std::unordered_map<std::string, bool>> m_InSync;
-  static std::unordered_map<std::string, bool> m_CheckSync;
+  // protects m_MessageHandler and m_ProfileCaches, each profile has its own db and queue locks
+  static std::mutex m_Mutex;
+  static std::map<std::string, std::shared_ptr<ProfileCache>> m_ProfileCaches;
+
+  // recently fetched messages and history pages, keeping disk access off the ui path
+  static std::mutex m_MemoryMutex;
+  static LruCache<MessageKey, ChatMessage> m_MemoryMessages;
+  static LruCache<PageKey, std::vector<std::string>> m_MemoryPages;
+  static uint64_t m_MemoryGeneration;
+  static int64_t m_MemoryHits;
+  static int64_t m_MemoryMisses;
+
+  // index of downloaded attachments of all profiles, answering download state without disk access
+  static std::mutex m_AttachmentMutex;
+  static std::unordered_map<std::string, AttachmentEntry> m_Attachments;
+  static std::atomic<uint64_t> m_AttachmentGeneration; // incremented when attachments are evicted
 
-  static bool m_Running;
-  static std::thread m_Thread;
-  static std::mutex m_QueueMutex;
-  static std::condition_variable m_CondVar;
-  static std::deque<std::shared_ptr<Request>> m_Queue;
+  // in-app export, reading through its own read-only connection and never taking the db write lock
+  static std::mutex m_ExportMutex;
+  static std::thread m_ExportThread;
+  static std::atomic<bool> m_ExportRunning;
+  static std::atomic<bool> m_ExportCancel;
 
   static std::string m_HistoryDir;
   static bool m_CacheEnabled;
+  static size_t m_QueueMaxSize;
+  static bool m_ReadOnly;
+  static int m_ReclaimerId;
 };
@@ -0,0 +1,1092 @@
+// messagecodec.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "messagecodec.h"
+
+#include <cstring>
+
+#include "objectpool.h"
+
+MessageCodec::Reader::Reader(const std::string& p_Data)
+  : m_Data(p_Data)
+{
+}
+
+int64_t MessageCodec::Reader::Num()
+{
+  int64_t num = 0;
+  if ((m_Pos + sizeof(num)) > m_Data.size())
+  {
+    m_Ok = false;
+    return 0;
+  }
+
+  memcpy(&num, m_Data.data() + m_Pos, sizeof(num));
+  m_Pos += sizeof(num);
+  return num;
+}
+
+std::string MessageCodec::Reader::Str()
+{
+  const int64_t size = Num();
+  if ((size < 0) || ((m_Pos + size) > m_Data.size()))
+  {
+    m_Ok = false;
+    return std::string();
+  }
+
+  std::string str = m_Data.substr(m_Pos, size);
+  m_Pos += size;
+  return str;
+}
+
+ChatMessage MessageCodec::Reader::Message()
+{
+  ChatMessage chatMessage;
+  chatMessage.id = Str();
+  chatMessage.senderId = Str();
+  chatMessage.text = Str();
+  chatMessage.quotedId = Str();
+  chatMessage.quotedText = Str();
+  chatMessage.quotedSender = Str();
+  chatMessage.fileInfo = Str();
+  chatMessage.link = Str();
+  chatMessage.timeSent = Num();
+  chatMessage.sequence = Num();
+  chatMessage.isOutgoing = Num();
+  chatMessage.isRead = Num();
+  chatMessage.hasMention = Num();
+  return chatMessage;
+}
+
+ChatInfo MessageCodec::Reader::Chat()
+{
+  ChatInfo chatInfo;
+  chatInfo.id = Str();
+  chatInfo.isUnread = Num();
+  chatInfo.isUnreadMention = Num();
+  chatInfo.isMuted = Num();
+  chatInfo.lastMessageTime = Num();
+  return chatInfo;
+}
+
+bool MessageCodec::Reader::Ok() const
+{
+  return m_Ok;
+}
+
+void MessageCodec::AppendNum(std::string& p_Data, int64_t p_Num)
+{
+  char buf[sizeof(p_Num)];
+  memcpy(buf, &p_Num, sizeof(p_Num));
+  p_Data.append(buf, sizeof(buf));
+}
+
+void MessageCodec::AppendStr(std::string& p_Data, const std::string& p_Str)
+{
+  AppendNum(p_Data, (int64_t)p_Str.size());
+  p_Data.append(p_Str);
+}
+
+void MessageCodec::AppendMessage(std::string& p_Data, const ChatMessage& p_ChatMessage)
+{
+  AppendStr(p_Data, p_ChatMessage.id);
+  AppendStr(p_Data, p_ChatMessage.senderId);
+  AppendStr(p_Data, p_ChatMessage.text);
+  AppendStr(p_Data, p_ChatMessage.quotedId);
+  AppendStr(p_Data, p_ChatMessage.quotedText);
+  AppendStr(p_Data, p_ChatMessage.quotedSender);
+  AppendStr(p_Data, p_ChatMessage.fileInfo);
+  AppendStr(p_Data, p_ChatMessage.link);
+  AppendNum(p_Data, p_ChatMessage.timeSent);
+  AppendNum(p_Data, p_ChatMessage.sequence);
+  AppendNum(p_Data, p_ChatMessage.isOutgoing);
+  AppendNum(p_Data, p_ChatMessage.isRead);
+  AppendNum(p_Data, p_ChatMessage.hasMention);
+}
+
+void MessageCodec::AppendChat(std::string& p_Data, const ChatInfo& p_ChatInfo)
+{
+  AppendStr(p_Data, p_ChatInfo.id);
+  AppendNum(p_Data, p_ChatInfo.isUnread);
+  AppendNum(p_Data, p_ChatInfo.isUnreadMention);
+  AppendNum(p_Data, p_ChatInfo.isMuted);
+  AppendNum(p_Data, p_ChatInfo.lastMessageTime);
+}
+
+bool MessageCodec::EncodeServiceMessage(std::shared_ptr<ServiceMessage> p_ServiceMessage, std::string& p_Data)
+{
+  const MessageType messageType = p_ServiceMessage->GetMessageType();
+  AppendNum(p_Data, messageType);
+  AppendStr(p_Data, p_ServiceMessage->profileId);
+
+  switch (messageType)
+  {
+    case NewContactsNotifyType:
+      {
+        std::shared_ptr<NewContactsNotify> notify = std::static_pointer_cast<NewContactsNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->contactInfos.size());
+        for (const auto& contactInfo : notify->contactInfos)
+        {
+          AppendStr(p_Data, contactInfo.id);
+          AppendStr(p_Data, contactInfo.name);
+          AppendStr(p_Data, contactInfo.phone);
+          AppendNum(p_Data, contactInfo.isSelf);
+        }
+      }
+      break;
+
+    case NewChatsNotifyType:
+      {
+        std::shared_ptr<NewChatsNotify> notify = std::static_pointer_cast<NewChatsNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendNum(p_Data, notify->chatInfos.size());
+        for (const auto& chatInfo : notify->chatInfos)
+        {
+          AppendChat(p_Data, chatInfo);
+        }
+      }
+      break;
+
+    case NewMessagesNotifyType:
+      {
+        std::shared_ptr<NewMessagesNotify> notify = std::static_pointer_cast<NewMessagesNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->fromMsgId);
+        AppendNum(p_Data, notify->cached);
+        AppendNum(p_Data, notify->sequence | (notify->more << 1)); // more bit keeps older recordings readable
+        AppendNum(p_Data, notify->chatMessages.size());
+        for (const auto& chatMessage : notify->chatMessages)
+        {
+          AppendMessage(p_Data, chatMessage);
+        }
+      }
+      break;
+
+    case SendMessageNotifyType:
+      {
+        std::shared_ptr<SendMessageNotify> notify = std::static_pointer_cast<SendMessageNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendMessage(p_Data, notify->chatMessage);
+      }
+      break;
+
+    case ConnectNotifyType:
+      {
+        std::shared_ptr<ConnectNotify> notify = std::static_pointer_cast<ConnectNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+      }
+      break;
+
+    case MarkMessageReadNotifyType:
+      {
+        std::shared_ptr<MarkMessageReadNotify> notify =
+          std::static_pointer_cast<MarkMessageReadNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+      }
+      break;
+
+    case MarkMessagesReadNotifyType:
+      {
+        std::shared_ptr<MarkMessagesReadNotify> notify =
+          std::static_pointer_cast<MarkMessagesReadNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+        AppendNum(p_Data, notify->msgIds.size());
+        for (const auto& msgId : notify->msgIds)
+        {
+          AppendStr(p_Data, msgId);
+        }
+      }
+      break;
+
+    case DeleteMessageNotifyType:
+      {
+        std::shared_ptr<DeleteMessageNotify> notify = std::static_pointer_cast<DeleteMessageNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+      }
+      break;
+
+    case SendTypingNotifyType:
+      {
+        std::shared_ptr<SendTypingNotify> notify = std::static_pointer_cast<SendTypingNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendNum(p_Data, notify->isTyping);
+      }
+      break;
+
+    case SetStatusNotifyType:
+      {
+        std::shared_ptr<SetStatusNotify> notify = std::static_pointer_cast<SetStatusNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendNum(p_Data, notify->isOnline);
+      }
+      break;
+
+    case CreateChatNotifyType:
+      {
+        std::shared_ptr<CreateChatNotify> notify = std::static_pointer_cast<CreateChatNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendChat(p_Data, notify->chatInfo);
+      }
+      break;
+
+    case ReceiveTypingNotifyType:
+      {
+        std::shared_ptr<ReceiveTypingNotify> notify = std::static_pointer_cast<ReceiveTypingNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->userId);
+        AppendNum(p_Data, notify->isTyping);
+      }
+      break;
+
+    case ReceiveStatusNotifyType:
+      {
+        std::shared_ptr<ReceiveStatusNotify> notify = std::static_pointer_cast<ReceiveStatusNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->userId);
+        AppendNum(p_Data, notify->isOnline);
+        AppendNum(p_Data, notify->timeSeen);
+      }
+      break;
+
+    case NewMessageStatusNotifyType:
+      {
+        std::shared_ptr<NewMessageStatusNotify> notify =
+          std::static_pointer_cast<NewMessageStatusNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+        AppendNum(p_Data, notify->isRead);
+      }
+      break;
+
+    case ReadOutboxNotifyType:
+      {
+        std::shared_ptr<ReadOutboxNotify> notify = std::static_pointer_cast<ReadOutboxNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+      }
+      break;
+
+    case NewMessageFileNotifyType:
+      {
+        std::shared_ptr<NewMessageFileNotify> notify = std::static_pointer_cast<NewMessageFileNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+        AppendStr(p_Data, notify->fileInfo);
+        AppendNum(p_Data, notify->downloadFileAction);
+      }
+      break;
+
+    case NewMessageFileProgressNotifyType:
+      {
+        std::shared_ptr<NewMessageFileProgressNotify> notify =
+          std::static_pointer_cast<NewMessageFileProgressNotify>(p_ServiceMessage);
+        AppendStr(p_Data, notify->chatId);
+        AppendStr(p_Data, notify->msgId);
+        AppendNum(p_Data, notify->downloadedBytes);
+        AppendNum(p_Data, notify->totalBytes);
+      }
+      break;
+
+    case DeleteChatNotifyType:
+      {
+        std::shared_ptr<DeleteChatNotify> notify = std::static_pointer_cast<DeleteChatNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+      }
+      break;
+
+    case DeleteMessagesNotifyType:
+      {
+        std::shared_ptr<DeleteMessagesNotify> notify =
+          std::static_pointer_cast<DeleteMessagesNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendNum(p_Data, notify->msgIds.size());
+        for (const auto& msgId : notify->msgIds)
+        {
+          AppendStr(p_Data, msgId);
+        }
+      }
+      break;
+
+    case UpdateMuteNotifyType:
+      {
+        std::shared_ptr<UpdateMuteNotify> notify = std::static_pointer_cast<UpdateMuteNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->chatId);
+        AppendNum(p_Data, notify->isMuted);
+      }
+      break;
+
+    case SearchMessagesNotifyType:
+      {
+        std::shared_ptr<SearchMessagesNotify> notify =
+          std::static_pointer_cast<SearchMessagesNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->success);
+        AppendStr(p_Data, notify->query);
+        AppendNum(p_Data, notify->chatMessages.size());
+        for (const auto& chatMessage : notify->chatMessages)
+        {
+          AppendStr(p_Data, chatMessage.first);
+          AppendMessage(p_Data, chatMessage.second);
+        }
+
+        AppendNum(p_Data, notify->isServer);
+      }
+      break;
+
+    case ChatUnreadNotifyType:
+      {
+        std::shared_ptr<ChatUnreadNotify> notify = std::static_pointer_cast<ChatUnreadNotify>(p_ServiceMessage);
+        AppendNum(p_Data, notify->chatUnreadInfos.size());
+        for (const auto& chatUnreadInfo : notify->chatUnreadInfos)
+        {
+          AppendStr(p_Data, chatUnreadInfo.id);
+          AppendNum(p_Data, chatUnreadInfo.lastMessageTime);
+          AppendNum(p_Data, chatUnreadInfo.unreadCount);
+          AppendNum(p_Data, chatUnreadInfo.isUnread);
+          AppendNum(p_Data, chatUnreadInfo.hasUnreadMention);
+        }
+      }
+      break;
+
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+std::shared_ptr<ServiceMessage> MessageCodec::DecodeServiceMessage(const std::string& p_Data)
+{
+  Reader reader(p_Data);
+  const MessageType messageType = (MessageType)reader.Num();
+  const std::string profileId = reader.Str();
+
+  std::shared_ptr<ServiceMessage> serviceMessage;
+  switch (messageType)
+  {
+    case NewContactsNotifyType:
+      {
+        std::shared_ptr<NewContactsNotify> notify = std::make_shared<NewContactsNotify>(profileId);
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          ContactInfo contactInfo;
+          contactInfo.id = reader.Str();
+          contactInfo.name = reader.Str();
+          contactInfo.phone = reader.Str();
+          contactInfo.isSelf = reader.Num();
+          notify->contactInfos.push_back(contactInfo);
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    case NewChatsNotifyType:
+      {
+        std::shared_ptr<NewChatsNotify> notify = std::make_shared<NewChatsNotify>(profileId);
+        notify->success = reader.Num();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          notify->chatInfos.push_back(reader.Chat());
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    case NewMessagesNotifyType:
+      {
+        std::shared_ptr<NewMessagesNotify> notify = std::make_shared<NewMessagesNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->fromMsgId = reader.Str();
+        notify->cached = reader.Num();
+        const int64_t flags = reader.Num();
+        notify->sequence = (flags & 1);
+        notify->more = (flags & 2);
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          notify->chatMessages.push_back(reader.Message());
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    case SendMessageNotifyType:
+      {
+        std::shared_ptr<SendMessageNotify> notify = std::make_shared<SendMessageNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->chatMessage = reader.Message();
+        serviceMessage = notify;
+      }
+      break;
+
+    case ConnectNotifyType:
+      {
+        std::shared_ptr<ConnectNotify> notify = std::make_shared<ConnectNotify>(profileId);
+        notify->success = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case MarkMessageReadNotifyType:
+      {
+        std::shared_ptr<MarkMessageReadNotify> notify = std::make_shared<MarkMessageReadNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        serviceMessage = notify;
+      }
+      break;
+
+    case MarkMessagesReadNotifyType:
+      {
+        std::shared_ptr<MarkMessagesReadNotify> notify = std::make_shared<MarkMessagesReadNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          notify->msgIds.push_back(reader.Str());
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    case DeleteMessageNotifyType:
+      {
+        std::shared_ptr<DeleteMessageNotify> notify = std::make_shared<DeleteMessageNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        serviceMessage = notify;
+      }
+      break;
+
+    case SendTypingNotifyType:
+      {
+        std::shared_ptr<SendTypingNotify> notify = std::make_shared<SendTypingNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->isTyping = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case SetStatusNotifyType:
+      {
+        std::shared_ptr<SetStatusNotify> notify = std::make_shared<SetStatusNotify>(profileId);
+        notify->success = reader.Num();
+        notify->isOnline = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case CreateChatNotifyType:
+      {
+        std::shared_ptr<CreateChatNotify> notify = std::make_shared<CreateChatNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatInfo = reader.Chat();
+        serviceMessage = notify;
+      }
+      break;
+
+    case ReceiveTypingNotifyType:
+      {
+        std::shared_ptr<ReceiveTypingNotify> notify = ObjectPool::MakeShared<ReceiveTypingNotify>(profileId);
+        notify->chatId = reader.Str();
+        notify->userId = reader.Str();
+        notify->isTyping = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case ReceiveStatusNotifyType:
+      {
+        std::shared_ptr<ReceiveStatusNotify> notify = ObjectPool::MakeShared<ReceiveStatusNotify>(profileId);
+        notify->userId = reader.Str();
+        notify->isOnline = reader.Num();
+        notify->timeSeen = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case NewMessageStatusNotifyType:
+      {
+        std::shared_ptr<NewMessageStatusNotify> notify = ObjectPool::MakeShared<NewMessageStatusNotify>(profileId);
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        notify->isRead = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case ReadOutboxNotifyType:
+      {
+        std::shared_ptr<ReadOutboxNotify> notify = ObjectPool::MakeShared<ReadOutboxNotify>(profileId);
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        serviceMessage = notify;
+      }
+      break;
+
+    case NewMessageFileNotifyType:
+      {
+        std::shared_ptr<NewMessageFileNotify> notify = std::make_shared<NewMessageFileNotify>(profileId);
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        notify->fileInfo = reader.Str();
+        notify->downloadFileAction = (DownloadFileAction)reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case NewMessageFileProgressNotifyType:
+      {
+        std::shared_ptr<NewMessageFileProgressNotify> notify =
+          std::make_shared<NewMessageFileProgressNotify>(profileId);
+        notify->chatId = reader.Str();
+        notify->msgId = reader.Str();
+        notify->downloadedBytes = reader.Num();
+        notify->totalBytes = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case DeleteChatNotifyType:
+      {
+        std::shared_ptr<DeleteChatNotify> notify = std::make_shared<DeleteChatNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        serviceMessage = notify;
+      }
+      break;
+
+    case DeleteMessagesNotifyType:
+      {
+        std::shared_ptr<DeleteMessagesNotify> notify = std::make_shared<DeleteMessagesNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          notify->msgIds.push_back(reader.Str());
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    case UpdateMuteNotifyType:
+      {
+        std::shared_ptr<UpdateMuteNotify> notify = std::make_shared<UpdateMuteNotify>(profileId);
+        notify->success = reader.Num();
+        notify->chatId = reader.Str();
+        notify->isMuted = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case SearchMessagesNotifyType:
+      {
+        std::shared_ptr<SearchMessagesNotify> notify = std::make_shared<SearchMessagesNotify>(profileId);
+        notify->success = reader.Num();
+        notify->query = reader.Str();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          const std::string chatId = reader.Str();
+          notify->chatMessages.push_back(std::make_pair(chatId, reader.Message()));
+        }
+
+        notify->isServer = reader.Num();
+        serviceMessage = notify;
+      }
+      break;
+
+    case ChatUnreadNotifyType:
+      {
+        std::shared_ptr<ChatUnreadNotify> notify = std::make_shared<ChatUnreadNotify>(profileId);
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          ChatUnreadInfo chatUnreadInfo;
+          chatUnreadInfo.id = reader.Str();
+          chatUnreadInfo.lastMessageTime = reader.Num();
+          chatUnreadInfo.unreadCount = reader.Num();
+          chatUnreadInfo.isUnread = reader.Num();
+          chatUnreadInfo.hasUnreadMention = reader.Num();
+          notify->chatUnreadInfos.push_back(chatUnreadInfo);
+        }
+
+        serviceMessage = notify;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return reader.Ok() ? serviceMessage : nullptr;
+}
+
+bool MessageCodec::EncodeRequest(std::shared_ptr<RequestMessage> p_RequestMessage, std::string& p_Data)
+{
+  const MessageType messageType = p_RequestMessage->GetMessageType();
+  AppendNum(p_Data, messageType);
+
+  switch (messageType)
+  {
+    case GetContactsRequestType:
+      break;
+
+    case GetChatsRequestType:
+      {
+        std::shared_ptr<GetChatsRequest> request = std::static_pointer_cast<GetChatsRequest>(p_RequestMessage);
+        AppendNum(p_Data, request->chatIds.size());
+        for (const auto& chatId : request->chatIds)
+        {
+          AppendStr(p_Data, chatId);
+        }
+      }
+      break;
+
+    case GetStatusRequestType:
+      {
+        std::shared_ptr<GetStatusRequest> request = std::static_pointer_cast<GetStatusRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->userId);
+      }
+      break;
+
+    case GetMessageRequestType:
+      {
+        std::shared_ptr<GetMessageRequest> request = std::static_pointer_cast<GetMessageRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+        AppendNum(p_Data, request->cached);
+      }
+      break;
+
+    case GetMessagesRequestType:
+      {
+        std::shared_ptr<GetMessagesRequest> request = std::static_pointer_cast<GetMessagesRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->fromMsgId);
+        AppendNum(p_Data, request->limit);
+      }
+      break;
+
+    case SendMessageRequestType:
+      {
+        std::shared_ptr<SendMessageRequest> request = std::static_pointer_cast<SendMessageRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendMessage(p_Data, request->chatMessage);
+      }
+      break;
+
+    case EditMessageRequestType:
+      {
+        std::shared_ptr<EditMessageRequest> request = std::static_pointer_cast<EditMessageRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+        AppendMessage(p_Data, request->chatMessage);
+      }
+      break;
+
+    case MarkMessageReadRequestType:
+      {
+        std::shared_ptr<MarkMessageReadRequest> request =
+          std::static_pointer_cast<MarkMessageReadRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+      }
+      break;
+
+    case MarkMessagesReadRequestType:
+      {
+        std::shared_ptr<MarkMessagesReadRequest> request =
+          std::static_pointer_cast<MarkMessagesReadRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+        AppendNum(p_Data, request->msgIds.size());
+        for (const auto& msgId : request->msgIds)
+        {
+          AppendStr(p_Data, msgId);
+        }
+      }
+      break;
+
+    case DeleteMessageRequestType:
+      {
+        std::shared_ptr<DeleteMessageRequest> request =
+          std::static_pointer_cast<DeleteMessageRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->senderId);
+        AppendStr(p_Data, request->msgId);
+      }
+      break;
+
+    case DeleteChatRequestType:
+      {
+        std::shared_ptr<DeleteChatRequest> request = std::static_pointer_cast<DeleteChatRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+      }
+      break;
+
+    case SendTypingRequestType:
+      {
+        std::shared_ptr<SendTypingRequest> request = std::static_pointer_cast<SendTypingRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendNum(p_Data, request->isTyping);
+      }
+      break;
+
+    case SetStatusRequestType:
+      {
+        std::shared_ptr<SetStatusRequest> request = std::static_pointer_cast<SetStatusRequest>(p_RequestMessage);
+        AppendNum(p_Data, request->isOnline);
+      }
+      break;
+
+    case CreateChatRequestType:
+      {
+        std::shared_ptr<CreateChatRequest> request = std::static_pointer_cast<CreateChatRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->userId);
+      }
+      break;
+
+    case DeferGetChatDetailsRequestType:
+      {
+        std::shared_ptr<DeferGetChatDetailsRequest> request =
+          std::static_pointer_cast<DeferGetChatDetailsRequest>(p_RequestMessage);
+        AppendNum(p_Data, request->chatIds.size());
+        for (const auto& chatId : request->chatIds)
+        {
+          AppendStr(p_Data, chatId);
+        }
+
+        AppendNum(p_Data, request->isGetTypeOnly);
+      }
+      break;
+
+    case DeferGetUserDetailsRequestType:
+      {
+        std::shared_ptr<DeferGetUserDetailsRequest> request =
+          std::static_pointer_cast<DeferGetUserDetailsRequest>(p_RequestMessage);
+        AppendNum(p_Data, request->userIds.size());
+        for (const auto& userId : request->userIds)
+        {
+          AppendStr(p_Data, userId);
+        }
+      }
+      break;
+
+    case DownloadFileRequestType:
+      {
+        std::shared_ptr<DownloadFileRequest> request = std::static_pointer_cast<DownloadFileRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+        AppendStr(p_Data, request->fileId);
+        AppendNum(p_Data, request->downloadFileAction);
+        AppendNum(p_Data, request->downloadFilePriority);
+      }
+      break;
+
+    case DeferDownloadFileRequestType:
+      {
+        std::shared_ptr<DeferDownloadFileRequest> request =
+          std::static_pointer_cast<DeferDownloadFileRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+        AppendStr(p_Data, request->msgId);
+        AppendStr(p_Data, request->fileId);
+        AppendStr(p_Data, request->downloadId);
+        AppendNum(p_Data, request->downloadFileAction);
+        AppendNum(p_Data, request->downloadFilePriority);
+      }
+      break;
+
+    case SetCurrentChatRequestType:
+      {
+        std::shared_ptr<SetCurrentChatRequest> request =
+          std::static_pointer_cast<SetCurrentChatRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+      }
+      break;
+
+    case DeferGetSponsoredMessagesRequestType:
+      {
+        std::shared_ptr<DeferGetSponsoredMessagesRequest> request =
+          std::static_pointer_cast<DeferGetSponsoredMessagesRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->chatId);
+      }
+      break;
+
+    case SearchMessagesRequestType:
+      {
+        std::shared_ptr<SearchMessagesRequest> request =
+          std::static_pointer_cast<SearchMessagesRequest>(p_RequestMessage);
+        AppendStr(p_Data, request->query);
+        AppendNum(p_Data, request->limit);
+      }
+      break;
+
+    case ReconnectRequestType:
+      break;
+
+    default:
+      // defer notify requests carry protocol internal state and never leave the process
+      return false;
+  }
+
+  return true;
+}
+
+std::shared_ptr<RequestMessage> MessageCodec::DecodeRequest(const std::string& p_Data)
+{
+  Reader reader(p_Data);
+  const MessageType messageType = (MessageType)reader.Num();
+
+  std::shared_ptr<RequestMessage> requestMessage;
+  switch (messageType)
+  {
+    case GetContactsRequestType:
+      requestMessage = std::make_shared<GetContactsRequest>();
+      break;
+
+    case GetChatsRequestType:
+      {
+        std::shared_ptr<GetChatsRequest> request = std::make_shared<GetChatsRequest>();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          request->chatIds.insert(reader.Str());
+        }
+
+        requestMessage = request;
+      }
+      break;
+
+    case GetStatusRequestType:
+      {
+        std::shared_ptr<GetStatusRequest> request = std::make_shared<GetStatusRequest>();
+        request->userId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case GetMessageRequestType:
+      {
+        std::shared_ptr<GetMessageRequest> request = std::make_shared<GetMessageRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        request->cached = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case GetMessagesRequestType:
+      {
+        std::shared_ptr<GetMessagesRequest> request = std::make_shared<GetMessagesRequest>();
+        request->chatId = reader.Str();
+        request->fromMsgId = reader.Str();
+        request->limit = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case SendMessageRequestType:
+      {
+        std::shared_ptr<SendMessageRequest> request = std::make_shared<SendMessageRequest>();
+        request->chatId = reader.Str();
+        request->chatMessage = reader.Message();
+        requestMessage = request;
+      }
+      break;
+
+    case EditMessageRequestType:
+      {
+        std::shared_ptr<EditMessageRequest> request = std::make_shared<EditMessageRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        request->chatMessage = reader.Message();
+        requestMessage = request;
+      }
+      break;
+
+    case MarkMessageReadRequestType:
+      {
+        std::shared_ptr<MarkMessageReadRequest> request = std::make_shared<MarkMessageReadRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case MarkMessagesReadRequestType:
+      {
+        std::shared_ptr<MarkMessagesReadRequest> request = std::make_shared<MarkMessagesReadRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          request->msgIds.push_back(reader.Str());
+        }
+
+        requestMessage = request;
+      }
+      break;
+
+    case DeleteMessageRequestType:
+      {
+        std::shared_ptr<DeleteMessageRequest> request = std::make_shared<DeleteMessageRequest>();
+        request->chatId = reader.Str();
+        request->senderId = reader.Str();
+        request->msgId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case DeleteChatRequestType:
+      {
+        std::shared_ptr<DeleteChatRequest> request = std::make_shared<DeleteChatRequest>();
+        request->chatId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case SendTypingRequestType:
+      {
+        std::shared_ptr<SendTypingRequest> request = std::make_shared<SendTypingRequest>();
+        request->chatId = reader.Str();
+        request->isTyping = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case SetStatusRequestType:
+      {
+        std::shared_ptr<SetStatusRequest> request = std::make_shared<SetStatusRequest>();
+        request->isOnline = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case CreateChatRequestType:
+      {
+        std::shared_ptr<CreateChatRequest> request = std::make_shared<CreateChatRequest>();
+        request->userId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case DeferGetChatDetailsRequestType:
+      {
+        std::shared_ptr<DeferGetChatDetailsRequest> request = std::make_shared<DeferGetChatDetailsRequest>();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          request->chatIds.push_back(reader.Str());
+        }
+
+        request->isGetTypeOnly = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case DeferGetUserDetailsRequestType:
+      {
+        std::shared_ptr<DeferGetUserDetailsRequest> request = std::make_shared<DeferGetUserDetailsRequest>();
+        const int64_t count = reader.Num();
+        for (int64_t i = 0; (i < count) && reader.Ok(); ++i)
+        {
+          request->userIds.push_back(reader.Str());
+        }
+
+        requestMessage = request;
+      }
+      break;
+
+    case DownloadFileRequestType:
+      {
+        std::shared_ptr<DownloadFileRequest> request = std::make_shared<DownloadFileRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        request->fileId = reader.Str();
+        request->downloadFileAction = (DownloadFileAction)reader.Num();
+        request->downloadFilePriority = (DownloadFilePriority)reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case DeferDownloadFileRequestType:
+      {
+        std::shared_ptr<DeferDownloadFileRequest> request = std::make_shared<DeferDownloadFileRequest>();
+        request->chatId = reader.Str();
+        request->msgId = reader.Str();
+        request->fileId = reader.Str();
+        request->downloadId = reader.Str();
+        request->downloadFileAction = (DownloadFileAction)reader.Num();
+        request->downloadFilePriority = (DownloadFilePriority)reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case SetCurrentChatRequestType:
+      {
+        std::shared_ptr<SetCurrentChatRequest> request = std::make_shared<SetCurrentChatRequest>();
+        request->chatId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case DeferGetSponsoredMessagesRequestType:
+      {
+        std::shared_ptr<DeferGetSponsoredMessagesRequest> request =
+          std::make_shared<DeferGetSponsoredMessagesRequest>();
+        request->chatId = reader.Str();
+        requestMessage = request;
+      }
+      break;
+
+    case SearchMessagesRequestType:
+      {
+        std::shared_ptr<SearchMessagesRequest> request = std::make_shared<SearchMessagesRequest>();
+        request->query = reader.Str();
+        request->limit = reader.Num();
+        requestMessage = request;
+      }
+      break;
+
+    case ReconnectRequestType:
+      requestMessage = std::make_shared<ReconnectRequest>();
+      break;
+
+    default:
+      break;
+  }
+
+  return reader.Ok() ? requestMessage : nullptr;
+}
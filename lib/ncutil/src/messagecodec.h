@@ -0,0 +1,48 @@
+// messagecodec.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "protocol.h"
+
+// compact binary encoding of protocol requests and service messages, used by message recordings
+// and the core daemon socket. fields are written in declaration order as native endian 64-bit
+// numbers and length prefixed strings.
+class MessageCodec
+{
+public:
+  class Reader
+  {
+  public:
+    explicit Reader(const std::string& p_Data);
+
+    int64_t Num();
+    std::string Str();
+    ChatMessage Message();
+    ChatInfo Chat();
+    bool Ok() const;
+
+  private:
+    const std::string& m_Data;
+    size_t m_Pos = 0;
+    bool m_Ok = true;
+  };
+
+  static void AppendNum(std::string& p_Data, int64_t p_Num);
+  static void AppendStr(std::string& p_Data, const std::string& p_Str);
+  static void AppendMessage(std::string& p_Data, const ChatMessage& p_ChatMessage);
+  static void AppendChat(std::string& p_Data, const ChatInfo& p_ChatInfo);
+
+  static bool EncodeServiceMessage(std::shared_ptr<ServiceMessage> p_ServiceMessage, std::string& p_Data);
+  static std::shared_ptr<ServiceMessage> DecodeServiceMessage(const std::string& p_Data);
+  static bool EncodeRequest(std::shared_ptr<RequestMessage> p_RequestMessage, std::string& p_Data);
+  static std::shared_ptr<RequestMessage> DecodeRequest(const std::string& p_Data);
+};
@@ -0,0 +1,127 @@
+// messagerecorder.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "messagerecorder.h"
+
+#include <chrono>
+
+#include "log.h"
+#include "messagecodec.h"
+
+std::atomic<bool> MessageRecorder::m_IsOpen(false);
+std::mutex MessageRecorder::m_Mutex;
+std::ofstream MessageRecorder::m_File;
+int64_t MessageRecorder::m_StartUSec = 0;
+
+// @note: bump on any change of record encoding
+static const std::string s_FileHeader = "nchat-recording-1\n";
+
+static int64_t GetTimeUSec()
+{
+  const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+bool MessageRecorder::Open(const std::string& p_Path)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_File.open(p_Path, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!m_File.is_open())
+  {
+    LOG_WARNING("failed to open recording %s", p_Path.c_str());
+    return false;
+  }
+
+  m_File << s_FileHeader;
+  m_StartUSec = GetTimeUSec();
+  m_IsOpen = true;
+  LOG_INFO("recording service messages to %s", p_Path.c_str());
+  return true;
+}
+
+void MessageRecorder::Close()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (!m_IsOpen) return;
+
+  m_IsOpen = false;
+  m_File.close();
+}
+
+bool MessageRecorder::IsOpen()
+{
+  return m_IsOpen;
+}
+
+void MessageRecorder::Write(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  std::string data;
+  if (!Encode(p_ServiceMessage, data)) return;
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (!m_IsOpen) return;
+
+  std::string record;
+  MessageCodec::AppendNum(record, GetTimeUSec() - m_StartUSec);
+  MessageCodec::AppendStr(record, data);
+  m_File.write(record.data(), record.size());
+}
+
+bool MessageRecorder::Load(const std::string& p_Path, std::vector<Record>& p_Records)
+{
+  std::ifstream file(p_Path, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (content.compare(0, s_FileHeader.size(), s_FileHeader) != 0)
+  {
+    LOG_WARNING("invalid recording %s", p_Path.c_str());
+    return false;
+  }
+
+  content.erase(0, s_FileHeader.size());
+  MessageCodec::Reader reader(content);
+  while (true)
+  {
+    Record record;
+    record.timeUSec = reader.Num();
+    record.data = reader.Str();
+    if (!reader.Ok()) break;
+
+    p_Records.push_back(std::move(record));
+  }
+
+  return true;
+}
+
+bool MessageRecorder::Encode(std::shared_ptr<ServiceMessage> p_ServiceMessage, std::string& p_Data)
+{
+  switch (p_ServiceMessage->GetMessageType())
+  {
+    case NewContactsNotifyType:
+    case NewChatsNotifyType:
+    case NewMessagesNotifyType:
+    case ConnectNotifyType:
+    case ReceiveTypingNotifyType:
+    case ReceiveStatusNotifyType:
+    case NewMessageStatusNotifyType:
+    case ReadOutboxNotifyType:
+    case NewMessageFileNotifyType:
+    case NewMessageFileProgressNotifyType:
+    case DeleteChatNotifyType:
+    case DeleteMessagesNotifyType:
+    case UpdateMuteNotifyType:
+      return MessageCodec::EncodeServiceMessage(p_ServiceMessage, p_Data);
+
+    default:
+      // responses to ui requests are not recorded, as replay issues no requests
+      return false;
+  }
+}
+
+std::shared_ptr<ServiceMessage> MessageRecorder::Decode(const std::string& p_Data)
+{
+  return MessageCodec::DecodeServiceMessage(p_Data);
+}
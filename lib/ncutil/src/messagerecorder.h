@@ -0,0 +1,46 @@
+// messagerecorder.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+
+// records service messages received by the ui to a file, for replay by the benchmark driver
+class MessageRecorder
+{
+public:
+  struct Record
+  {
+    int64_t timeUSec = 0; // time since start of recording
+    std::string data; // encoded service message
+  };
+
+  static bool Open(const std::string& p_Path);
+  static void Close();
+  static bool IsOpen();
+  static void Write(std::shared_ptr<ServiceMessage> p_ServiceMessage);
+
+  static bool Load(const std::string& p_Path, std::vector<Record>& p_Records);
+  static std::shared_ptr<ServiceMessage> Decode(const std::string& p_Data);
+
+private:
+  static bool Encode(std::shared_ptr<ServiceMessage> p_ServiceMessage, std::string& p_Data);
+
+private:
+  static std::atomic<bool> m_IsOpen;
+  static std::mutex m_Mutex;
+  static std::ofstream m_File;
+  static int64_t m_StartUSec;
+};
@@ -0,0 +1,142 @@
+// objectpool.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// process-wide free list of fixed-size blocks, shared by all threads as objects are commonly
+// created by a protocol thread and released by the ui thread. blocks are allocated on demand,
+// and at most s_MaxFree are kept for reuse.
+template<size_t TSize>
+class BlockPool
+{
+public:
+  static void* Alloc()
+  {
+    Pool& pool = GetPool();
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      if (pool.head != nullptr)
+      {
+        Block* block = pool.head;
+        pool.head = block->next;
+        --pool.count;
+        return block;
+      }
+    }
+
+    return ::operator new(s_BlockSize);
+  }
+
+  static void Free(void* p_Ptr)
+  {
+    Pool& pool = GetPool();
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      if (pool.count < s_MaxFree)
+      {
+        Block* block = static_cast<Block*>(p_Ptr);
+        block->next = pool.head;
+        pool.head = block;
+        ++pool.count;
+        return;
+      }
+    }
+
+    ::operator delete(p_Ptr);
+  }
+
+private:
+  struct Block
+  {
+    Block* next;
+  };
+
+  struct Pool
+  {
+    std::mutex mutex;
+    Block* head = nullptr;
+    size_t count = 0;
+  };
+
+  static Pool& GetPool()
+  {
+    // @note: intentionally leaked, as objects may be released during static destruction
+    static Pool* s_Pool = new Pool();
+    return *s_Pool;
+  }
+
+private:
+  static const size_t s_Align = alignof(std::max_align_t);
+  static const size_t s_BlockSize = ((((TSize > sizeof(Block)) ? TSize : sizeof(Block)) + s_Align - 1) / s_Align) *
+                                    s_Align;
+  static const size_t s_MaxFree = 1024;
+};
+
+// allocator serving single objects from a BlockPool of matching size, for allocate_shared
+template<typename T>
+class PoolAllocator
+{
+public:
+  typedef T value_type;
+
+  PoolAllocator() = default;
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U>&)
+  {
+  }
+
+  T* allocate(size_t p_Count)
+  {
+    if ((p_Count == 1) && (alignof(T) <= alignof(std::max_align_t)))
+    {
+      return static_cast<T*>(BlockPool<sizeof(T)>::Alloc());
+    }
+
+    return static_cast<T*>(::operator new(p_Count * sizeof(T)));
+  }
+
+  void deallocate(T* p_Ptr, size_t p_Count)
+  {
+    if ((p_Count == 1) && (alignof(T) <= alignof(std::max_align_t)))
+    {
+      BlockPool<sizeof(T)>::Free(p_Ptr);
+      return;
+    }
+
+    ::operator delete(p_Ptr);
+  }
+
+  template<typename U>
+  bool operator==(const PoolAllocator<U>&) const
+  {
+    return true;
+  }
+
+  template<typename U>
+  bool operator!=(const PoolAllocator<U>&) const
+  {
+    return false;
+  }
+};
+
+// pool-backed replacement for std::make_shared, for short-lived objects created at high rates
+class ObjectPool
+{
+public:
+  template<typename T, typename... TArgs>
+  static std::shared_ptr<T> MakeShared(TArgs&&... p_Args)
+  {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<TArgs>(p_Args)...);
+  }
+};
@@ -0,0 +1,111 @@
+// offlinechat.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "offlinechat.h"
+
+#include "log.h"
+#include "messagecache.h"
+#include "status.h"
+
+OfflineChat::OfflineChat(const std::string& p_ProfileId)
+  : m_ProfileId(p_ProfileId)
+{
+}
+
+std::string OfflineChat::GetProfileId() const
+{
+  return m_ProfileId;
+}
+
+std::string OfflineChat::GetProfileDisplayName() const
+{
+  return "";
+}
+
+bool OfflineChat::HasFeature(ProtocolFeature p_ProtocolFeature) const
+{
+  // chats are fetched from cache at login, as no connect notify is sent
+  ProtocolFeature customFeatures = FeatureAutoGetChatsOnLogin;
+  return (p_ProtocolFeature & customFeatures);
+}
+
+bool OfflineChat::SetupProfile(const std::string& /*p_ProfilesDir*/, std::string& /*p_ProfileId*/)
+{
+  return false;
+}
+
+bool OfflineChat::LoadProfile(const std::string& /*p_ProfilesDir*/, const std::string& /*p_ProfileId*/)
+{
+  // dir version is not checked in read-only mode, so any protocol cache version is opened
+  MessageCache::AddProfile(m_ProfileId, false /*p_CheckSync*/, 0 /*p_DirVersion*/, false /*p_IsSetup*/);
+  return true;
+}
+
+bool OfflineChat::CloseProfile()
+{
+  return true;
+}
+
+bool OfflineChat::Login()
+{
+  // never connects, so the ui keeps the profile offline and does not resend its outbox
+  Status::Set(Status::FlagOffline);
+  MessageCache::FetchContacts(m_ProfileId);
+  MessageCache::FetchChats(m_ProfileId, std::unordered_set<std::string>());
+  return true;
+}
+
+bool OfflineChat::Logout()
+{
+  return true;
+}
+
+void OfflineChat::SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  // cache fetches are asynchronous and notify through the cache message handler
+  switch (p_RequestMessage->GetMessageType())
+  {
+    case GetContactsRequestType:
+      MessageCache::FetchContacts(m_ProfileId);
+      break;
+
+    case GetChatsRequestType:
+      {
+        std::shared_ptr<GetChatsRequest> getChatsRequest =
+          std::static_pointer_cast<GetChatsRequest>(p_RequestMessage);
+        MessageCache::FetchChats(m_ProfileId, getChatsRequest->chatIds);
+      }
+      break;
+
+    case GetMessageRequestType:
+      {
+        std::shared_ptr<GetMessageRequest> getMessageRequest =
+          std::static_pointer_cast<GetMessageRequest>(p_RequestMessage);
+        MessageCache::FetchOneMessage(m_ProfileId, getMessageRequest->chatId, getMessageRequest->msgId,
+                                      false /*p_Sync*/);
+      }
+      break;
+
+    case GetMessagesRequestType:
+      {
+        std::shared_ptr<GetMessagesRequest> getMessagesRequest =
+          std::static_pointer_cast<GetMessagesRequest>(p_RequestMessage);
+        MessageCache::FetchMessagesFrom(m_ProfileId, getMessagesRequest->chatId, getMessagesRequest->fromMsgId,
+                                        getMessagesRequest->limit, false /*p_Sync*/);
+      }
+      break;
+
+    default:
+      LOG_DEBUG("offline ignore request %d", p_RequestMessage->GetMessageType());
+      break;
+  }
+}
+
+void OfflineChat::SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& /*p_MessageHandler*/)
+{
+  // all notifications originate from the message cache, which has its own handler
+}
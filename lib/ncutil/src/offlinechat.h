@@ -0,0 +1,40 @@
+// offlinechat.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "protocol.h"
+
+// stand-in for a profile's protocol in offline mode, serves chats, contacts and history from
+// the message cache without loading the protocol library. requests that would change the
+// account or the cache are ignored.
+class OfflineChat : public Protocol
+{
+public:
+  explicit OfflineChat(const std::string& p_ProfileId);
+
+  std::string GetProfileId() const;
+  std::string GetProfileDisplayName() const;
+  bool HasFeature(ProtocolFeature p_ProtocolFeature) const;
+
+  bool SetupProfile(const std::string& p_ProfilesDir, std::string& p_ProfileId);
+  bool LoadProfile(const std::string& p_ProfilesDir, const std::string& p_ProfileId);
+  bool CloseProfile();
+
+  bool Login();
+  bool Logout();
+
+  void SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler);
+
+private:
+  std::string m_ProfileId;
+};
@@ -0,0 +1,269 @@
+// ondemandchat.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "ondemandchat.h"
+
+#include <chrono>
+
+#include "appconfig.h"
+#include "log.h"
+#include "messagecache.h"
+#include "strutil.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+
+// duration a periodically synced profile stays logged in, for history and updates to arrive
+static const int64_t s_SyncWindowMs = 2 * 60 * 1000;
+
+OnDemandChat::OnDemandChat(std::shared_ptr<Protocol> p_Protocol, ConnectPolicy p_ConnectPolicy,
+                           int p_SyncIntervalMin)
+  : m_Protocol(p_Protocol)
+  , m_OfflineChat(p_Protocol->GetProfileId())
+  , m_ConnectPolicy(p_ConnectPolicy)
+  , m_SyncIntervalMs(static_cast<int64_t>(p_SyncIntervalMin) * 60 * 1000)
+{
+}
+
+OnDemandChat::~OnDemandChat()
+{
+}
+
+OnDemandChat::ConnectPolicy OnDemandChat::GetConnectPolicy(const std::string& p_ProfileId, int& p_SyncIntervalMin)
+{
+  // comma-separated entries of profile id and policy, e.g. Telegram_+15551234567:on_demand,
+  // WhatsApp_+15557654321:periodic:30
+  const std::string policies = AppConfig::GetStr("profile_connect_policy");
+  for (const auto& entry : StrUtil::Split(policies, ','))
+  {
+    std::vector<std::string> fields = StrUtil::Split(entry, ':');
+    if ((fields.size() < 2) || (fields.at(0) != p_ProfileId)) continue;
+
+    if ((fields.at(1) == "on_demand") && (fields.size() == 2))
+    {
+      return ConnectOnDemand;
+    }
+
+    if ((fields.at(1) == "periodic") && (fields.size() == 3) && (StrUtil::ToInteger(fields.at(2)) > 0))
+    {
+      p_SyncIntervalMin = static_cast<int>(StrUtil::ToInteger(fields.at(2)));
+      return ConnectPeriodic;
+    }
+
+    if (fields.at(1) != "always")
+    {
+      LOG_WARNING("invalid connect policy \"%s\"", entry.c_str());
+    }
+
+    return ConnectAlways;
+  }
+
+  return ConnectAlways;
+}
+
+std::string OnDemandChat::GetProfileId() const
+{
+  return m_Protocol->GetProfileId();
+}
+
+std::string OnDemandChat::GetProfileDisplayName() const
+{
+  return m_Protocol->GetProfileDisplayName();
+}
+
+bool OnDemandChat::HasFeature(ProtocolFeature p_ProtocolFeature) const
+{
+  return m_Protocol->HasFeature(p_ProtocolFeature);
+}
+
+bool OnDemandChat::SetupProfile(const std::string& /*p_ProfilesDir*/, std::string& /*p_ProfileId*/)
+{
+  return false;
+}
+
+bool OnDemandChat::LoadProfile(const std::string& p_ProfilesDir, const std::string& p_ProfileId)
+{
+  return m_Protocol->LoadProfile(p_ProfilesDir, p_ProfileId);
+}
+
+bool OnDemandChat::CloseProfile()
+{
+  return m_Protocol->CloseProfile();
+}
+
+bool OnDemandChat::Login()
+{
+  const std::string profileId = GetProfileId();
+  LOG_INFO("login %s deferred, policy %d", profileId.c_str(), m_ConnectPolicy);
+
+  // chats are shown from cache until connected, the connect notify then triggers a refresh
+  MessageCache::FetchContacts(profileId);
+  MessageCache::FetchChats(profileId, std::unordered_set<std::string>());
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Running = true;
+  if (m_Activated || (m_ConnectPolicy == ConnectPeriodic))
+  {
+    StartThread();
+  }
+
+  return true;
+}
+
+bool OnDemandChat::Logout()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+  }
+
+  m_CondVar.notify_all();
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (!m_Connected) return true;
+
+  m_Connected = false;
+  lock.unlock();
+  return m_Protocol->Logout();
+}
+
+void OnDemandChat::SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_Connected)
+    {
+      lock.unlock();
+      m_Protocol->SendRequest(p_RequestMessage);
+      return;
+    }
+  }
+
+  switch (p_RequestMessage->GetMessageType())
+  {
+    case GetContactsRequestType:
+    case GetChatsRequestType:
+    case GetMessageRequestType:
+    case GetMessagesRequestType:
+      m_OfflineChat.SendRequest(p_RequestMessage);
+      return;
+
+    case SetCurrentChatRequestType:
+      if (std::static_pointer_cast<SetCurrentChatRequest>(p_RequestMessage)->chatId.empty())
+      {
+        return;
+      }
+      break;
+
+    // background requests, not a reason to connect
+    case GetStatusRequestType:
+    case SetStatusRequestType:
+    case SendTypingRequestType:
+    case DeferNotifyRequestType:
+    case DeferGetChatDetailsRequestType:
+    case DeferGetUserDetailsRequestType:
+    case DeferDownloadFileRequestType:
+    case DeferGetSponsoredMessagesRequestType:
+    case ReconnectRequestType:
+      LOG_DEBUG("dormant ignore request %d", p_RequestMessage->GetMessageType());
+      return;
+
+    default:
+      break;
+  }
+
+  // navigated to a chat or user action, held until logged in
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_PendingRequests.push_back(p_RequestMessage);
+  }
+
+  Activate();
+}
+
+void OnDemandChat::SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler)
+{
+  m_Protocol->SetMessageHandler(p_MessageHandler);
+}
+
+void OnDemandChat::Activate()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_Activated) return;
+
+    LOG_INFO("activate %s", GetProfileId().c_str());
+    m_Activated = true;
+    if (m_Running && !m_Thread.joinable())
+    {
+      StartThread();
+    }
+  }
+
+  m_CondVar.notify_all();
+}
+
+void OnDemandChat::StartThread()
+{
+  // @note: called with m_Mutex held
+  m_Thread = std::thread(&OnDemandChat::Process, this);
+}
+
+void OnDemandChat::Process()
+{
+  ThreadRegistry::Register("on-demand");
+
+  const std::string profileId = GetProfileId();
+  int64_t syncTime = TimeUtil::GetCurrentTimeMSec() + m_SyncIntervalMs;
+  int64_t syncEndTime = 0;
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (m_Running)
+  {
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    if (!m_Connected && (m_Activated || ((m_ConnectPolicy == ConnectPeriodic) && (nowTime >= syncTime))))
+    {
+      // login blocks while connecting, so it is not performed on the ui thread
+      LOG_INFO("login %s %s", profileId.c_str(), m_Activated ? "activated" : "sync");
+      lock.unlock();
+      m_Protocol->Login();
+      lock.lock();
+      m_Connected = true;
+      syncEndTime = TimeUtil::GetCurrentTimeMSec() + s_SyncWindowMs;
+      for (auto& pendingRequest : m_PendingRequests)
+      {
+        m_Protocol->SendRequest(pendingRequest);
+      }
+
+      m_PendingRequests.clear();
+      continue;
+    }
+
+    if (m_Connected && !m_Activated && (nowTime >= syncEndTime))
+    {
+      LOG_INFO("logout %s sync done", profileId.c_str());
+      m_Connected = false;
+      syncTime = nowTime + m_SyncIntervalMs;
+      lock.unlock();
+      m_Protocol->Logout();
+      lock.lock();
+      continue;
+    }
+
+    if (m_Activated || (m_ConnectPolicy != ConnectPeriodic))
+    {
+      m_CondVar.wait(lock);
+    }
+    else
+    {
+      const int64_t waitMs = (m_Connected ? syncEndTime : syncTime) - nowTime;
+      m_CondVar.wait_for(lock, std::chrono::milliseconds(waitMs));
+    }
+  }
+}
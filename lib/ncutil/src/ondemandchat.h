@@ -0,0 +1,75 @@
+// ondemandchat.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "offlinechat.h"
+#include "protocol.h"
+
+// wraps a loaded profile that is not logged in at startup. while dormant, chats, contacts and
+// history are served from the message cache, and the wrapped protocol has no library threads or
+// network sessions. it is logged in when the user navigates to one of its chats or sends a
+// request needing the network, or periodically for a background sync.
+class OnDemandChat : public Protocol
+{
+public:
+  enum ConnectPolicy
+  {
+    ConnectAlways = 0,
+    ConnectOnDemand,
+    ConnectPeriodic,
+  };
+
+  OnDemandChat(std::shared_ptr<Protocol> p_Protocol, ConnectPolicy p_ConnectPolicy, int p_SyncIntervalMin);
+  virtual ~OnDemandChat();
+
+  // parses app config profile_connect_policy, profiles not listed are always connected
+  static ConnectPolicy GetConnectPolicy(const std::string& p_ProfileId, int& p_SyncIntervalMin);
+
+  std::string GetProfileId() const;
+  std::string GetProfileDisplayName() const;
+  bool HasFeature(ProtocolFeature p_ProtocolFeature) const;
+
+  bool SetupProfile(const std::string& p_ProfilesDir, std::string& p_ProfileId);
+  bool LoadProfile(const std::string& p_ProfilesDir, const std::string& p_ProfileId);
+  bool CloseProfile();
+
+  bool Login();
+  bool Logout();
+
+  void SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler);
+
+private:
+  void Activate();
+  void StartThread();
+  void Process();
+
+private:
+  std::shared_ptr<Protocol> m_Protocol;
+  OfflineChat m_OfflineChat;
+  const ConnectPolicy m_ConnectPolicy;
+  const int64_t m_SyncIntervalMs;
+
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  std::thread m_Thread;
+  bool m_Running = false;
+  // activated by the user, stays connected until logout
+  bool m_Activated = false;
+  // wrapped protocol logged in, requests are then forwarded directly
+  bool m_Connected = false;
+  std::deque<std::shared_ptr<RequestMessage>> m_PendingRequests;
+};
@@ -0,0 +1,208 @@
+// perfstats.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "perfstats.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include "sysutil.h"
+#include "threadregistry.h"
+
+std::atomic<int64_t> PerfStats::m_Stats[PerfStats::StatCount];
+std::atomic<int64_t> PerfStats::m_MaxStats[PerfStats::StatCount];
+std::atomic<int64_t> PerfStats::m_Buckets[PerfStats::StatCount][PerfStats::s_BucketCount];
+std::mutex PerfStats::m_ProfileMessagesMutex;
+std::map<std::string, int64_t> PerfStats::m_ProfileMessages;
+
+void PerfStats::Set(Stat p_Stat, int64_t p_Value)
+{
+  m_Stats[p_Stat].store(p_Value, std::memory_order_relaxed);
+  UpdateMax(p_Stat, p_Value);
+}
+
+void PerfStats::Add(Stat p_Stat, int64_t p_Value)
+{
+  const int64_t value = m_Stats[p_Stat].fetch_add(p_Value, std::memory_order_relaxed) + p_Value;
+  UpdateMax(p_Stat, value);
+}
+
+void PerfStats::Record(Stat p_Stat, int64_t p_Usec)
+{
+  Set(p_Stat, p_Usec);
+
+  int bucket = 0;
+  while (((p_Usec >> bucket) > 1) && (bucket < (s_BucketCount - 1)))
+  {
+    ++bucket;
+  }
+
+  m_Buckets[p_Stat][bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t PerfStats::Get(Stat p_Stat)
+{
+  return m_Stats[p_Stat].load(std::memory_order_relaxed);
+}
+
+void PerfStats::AddProfileMessages(const std::string& p_ProfileId, int64_t p_Count)
+{
+  std::lock_guard<std::mutex> lock(m_ProfileMessagesMutex);
+  m_ProfileMessages[p_ProfileId] += p_Count;
+}
+
+int64_t PerfStats::GetTimeUSec()
+{
+  const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+std::string PerfStats::ToString()
+{
+  // draw times of top/help/status/list/history/entry views, followed by
+  // model lock, cache queue/commit, protocol request queue/history fetch, tdlib queries,
+  // input latency of typing/chat switch/page up and rss
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  ss << "draw";
+  for (int stat = StatDrawTopUs; stat <= StatDrawEntryUs; ++stat)
+  {
+    ss << ((stat == StatDrawTopUs) ? " " : "/") << (Get(static_cast<Stat>(stat)) / 1000.0);
+  }
+
+  ss << " lock " << (Get(StatModelLockUs) / 1000.0);
+  ss << " cache " << Get(StatCacheQueueDepth) << "/" << (Get(StatCacheCommitUs) / 1000.0);
+  ss << " req " << Get(StatRequestQueueDepth) << "/" << (Get(StatHistoryFetchUs) / 1000.0);
+  ss << " td " << Get(StatTdQueriesInFlight);
+  ss << " input " << (Get(StatInputTypingUs) / 1000.0) << "/" << (Get(StatInputChatSwitchUs) / 1000.0) << "/"
+     << (Get(StatInputPageUpUs) / 1000.0);
+
+  int threadCount = 0;
+  int64_t rssKb = 0;
+  if (SysUtil::GetProcessStats(threadCount, rssKb))
+  {
+    ss << " rss " << (rssKb / 1024) << "M";
+  }
+
+  return ss.str();
+}
+
+std::string PerfStats::GetReport()
+{
+  std::stringstream ss;
+  ss << "stats report\n";
+
+  int threadCount = 0;
+  int64_t rssKb = 0;
+  if (SysUtil::GetProcessStats(threadCount, rssKb))
+  {
+    ss << "  process threads " << threadCount << " rss " << rssKb << " kb\n";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_ProfileMessagesMutex);
+    for (const auto& profileMessages : m_ProfileMessages)
+    {
+      ss << "  messages " << profileMessages.first << " " << profileMessages.second << "\n";
+    }
+  }
+
+  const int64_t hits = Get(StatCacheHits);
+  const int64_t misses = Get(StatCacheMisses);
+  const int64_t hitRate = ((hits + misses) > 0) ? ((100 * hits) / (hits + misses)) : 0;
+  ss << "  cache hit rate " << hitRate << "%\n";
+
+  for (int i = StatCacheQueueDepth; i < StatCount; ++i)
+  {
+    const Stat stat = static_cast<Stat>(i);
+    ss << "  " << GetName(stat) << " " << Get(stat);
+    if ((stat <= StatRequestsTracked) || (stat >= StatHeapUiMessages))
+    {
+      ss << " max " << m_MaxStats[stat].load(std::memory_order_relaxed);
+    }
+
+    ss << "\n";
+  }
+
+  // latency histograms, listing non-empty buckets as <upper bound usec>:<count>
+  for (int i = StatDrawTopUs; i <= StatInputPageUpUs; ++i)
+  {
+    const Stat stat = static_cast<Stat>(i);
+    ss << "  " << GetName(stat) << " last " << Get(stat) << " max " <<
+      m_MaxStats[stat].load(std::memory_order_relaxed) << " hist";
+    for (int bucket = 0; bucket < s_BucketCount; ++bucket)
+    {
+      const int64_t count = m_Buckets[stat][bucket].load(std::memory_order_relaxed);
+      if (count == 0) continue;
+
+      if (bucket == (s_BucketCount - 1))
+      {
+        ss << " inf:" << count;
+      }
+      else
+      {
+        ss << " " << (int64_t(2) << bucket) << ":" << count;
+      }
+    }
+
+    ss << "\n";
+  }
+
+  ss << ThreadRegistry::GetReport();
+  return ss.str();
+}
+
+void PerfStats::UpdateMax(Stat p_Stat, int64_t p_Value)
+{
+  int64_t maxValue = m_MaxStats[p_Stat].load(std::memory_order_relaxed);
+  while ((p_Value > maxValue) &&
+         !m_MaxStats[p_Stat].compare_exchange_weak(maxValue, p_Value, std::memory_order_relaxed))
+  {
+  }
+}
+
+const char* PerfStats::GetName(Stat p_Stat)
+{
+  static const char* names[StatCount] =
+  {
+    "draw top usec",
+    "draw help usec",
+    "draw status usec",
+    "draw list usec",
+    "draw history usec",
+    "draw entry usec",
+    "model lock usec",
+    "cache commit usec",
+    "history fetch usec",
+    "whatsapp store usec",
+    "input typing usec",
+    "input chat switch usec",
+    "input page up usec",
+    "cache queue depth",
+    "request queue depth",
+    "tdlib queries in flight",
+    "requests tracked",
+    "cache inserts",
+    "cache fetches",
+    "cache hits",
+    "cache misses",
+    "redraws",
+    "downloaded bytes",
+    "requests cancelled",
+    "uploaded bytes",
+    "heap ui messages bytes",
+    "heap ui contacts bytes",
+    "heap layout cache bytes",
+    "heap cache queues bytes",
+    "heap cache memory bytes",
+    "heap tdlib maps bytes",
+    "heap cgo buffers bytes",
+  };
+
+  return names[p_Stat];
+}
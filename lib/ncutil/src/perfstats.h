@@ -0,0 +1,103 @@
+// perfstats.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// runtime performance counters, gauges and latency histograms. shown live in the
+// status view in developer mode, and reported to the log upon SIGUSR1.
+class PerfStats
+{
+public:
+  enum Stat
+  {
+    // latencies (usec)
+    StatDrawTopUs = 0,
+    StatDrawHelpUs,
+    StatDrawStatusUs,
+    StatDrawListUs,
+    StatDrawHistoryUs,
+    StatDrawEntryUs,
+    StatModelLockUs,
+    StatCacheCommitUs,
+    StatHistoryFetchUs,
+    StatWmStoreUs,
+    StatInputTypingUs, // key read until entry painted
+    StatInputChatSwitchUs, // key read until history of new chat painted with no page in flight
+    StatInputPageUpUs, // key read until older page painted
+    // gauges
+    StatCacheQueueDepth,
+    StatRequestQueueDepth,
+    StatTdQueriesInFlight,
+    StatRequestsTracked, // dedup entries of all request trackers
+    // counters
+    StatCacheInserts,
+    StatCacheFetches,
+    StatCacheHits,
+    StatCacheMisses,
+    StatRedraws,
+    StatDownloadedBytes,
+    StatRequestsCancelled,
+    StatUploadedBytes,
+    // heap estimates (bytes)
+    StatHeapUiMessages,
+    StatHeapUiContacts,
+    StatHeapLayoutCache,
+    StatHeapCacheQueues,
+    StatHeapCacheMemory,
+    StatHeapTdMaps,
+    StatHeapCgoBuffers,
+    StatCount,
+  };
+
+  static void Set(Stat p_Stat, int64_t p_Value);
+  static void Add(Stat p_Stat, int64_t p_Value);
+  static void Record(Stat p_Stat, int64_t p_Usec);
+  static int64_t Get(Stat p_Stat);
+  static void AddProfileMessages(const std::string& p_ProfileId, int64_t p_Count);
+  static int64_t GetTimeUSec();
+  static std::string ToString();
+  static std::string GetReport();
+
+private:
+  static void UpdateMax(Stat p_Stat, int64_t p_Value);
+  static const char* GetName(Stat p_Stat);
+
+private:
+  // @note: latency histogram buckets are powers of two usec, last bucket holds all above
+  static const int s_BucketCount = 24;
+  static std::atomic<int64_t> m_Stats[StatCount];
+  static std::atomic<int64_t> m_MaxStats[StatCount];
+  static std::atomic<int64_t> m_Buckets[StatCount][s_BucketCount];
+  static std::mutex m_ProfileMessagesMutex;
+  static std::map<std::string, int64_t> m_ProfileMessages;
+};
+
+// records the time elapsed from construction to destruction into a latency stat
+class PerfTimer
+{
+public:
+  explicit PerfTimer(PerfStats::Stat p_Stat)
+    : m_Stat(p_Stat)
+    , m_BeginUSec(PerfStats::GetTimeUSec())
+  {
+  }
+
+  ~PerfTimer()
+  {
+    PerfStats::Record(m_Stat, PerfStats::GetTimeUSec() - m_BeginUSec);
+  }
+
+private:
+  PerfStats::Stat m_Stat;
+  int64_t m_BeginUSec = 0;
+};
@@ -0,0 +1,133 @@
+// previewstore.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "previewstore.h"
+
+#include <cstdio>
+
+#include "backgroundexecutor.h"
+#include "fileutil.h"
+#include "log.h"
+#include "strutil.h"
+#include "threadregistry.h"
+
+bool PreviewStore::m_Running = false;
+std::mutex PreviewStore::m_Mutex;
+std::condition_variable PreviewStore::m_CondVar;
+std::deque<PreviewStore::Job> PreviewStore::m_Jobs;
+std::vector<std::thread> PreviewStore::m_Threads;
+
+// @note: jobs added while the queue is full are dropped, previews are provided again on next load
+static const size_t s_MaxJobs = 256;
+static const int s_ThreadCount = 2;
+
+void PreviewStore::Init()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_Running) return;
+
+  m_Running = true;
+  for (int i = 0; i < s_ThreadCount; ++i)
+  {
+    m_Threads.emplace_back(&PreviewStore::Process);
+  }
+}
+
+void PreviewStore::Cleanup()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Running) return;
+
+    m_Running = false;
+    m_Jobs.clear();
+  }
+
+  m_CondVar.notify_all();
+  for (auto& thread : m_Threads)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+
+  m_Threads.clear();
+}
+
+void PreviewStore::Add(const std::string& p_ProfileId, const std::string& p_FileId, const std::string& p_Data)
+{
+  if (p_FileId.empty() || p_Data.empty()) return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Running) return;
+
+    if (m_Jobs.size() >= s_MaxJobs)
+    {
+      LOG_DEBUG("preview dropped, queue full");
+      return;
+    }
+
+    Job job;
+    job.path = GetFilePath(p_ProfileId, p_FileId);
+    job.data = p_Data;
+    m_Jobs.push_back(std::move(job));
+  }
+
+  m_CondVar.notify_one();
+}
+
+// returns path of stored preview, or empty if none
+std::string PreviewStore::GetPath(const std::string& p_ProfileId, const std::string& p_FileId)
+{
+  if (p_FileId.empty()) return "";
+
+  const std::string& path = GetFilePath(p_ProfileId, p_FileId);
+  return FileUtil::Exists(path) ? path : "";
+}
+
+void PreviewStore::Process()
+{
+  ThreadRegistry::Register("preview");
+  BackgroundExecutor::SetThreadClass(BackgroundExecutor::ClassIdle);
+
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait(lock, []() { return !m_Jobs.empty() || !m_Running; });
+      if (!m_Running) break;
+
+      job = std::move(m_Jobs.front());
+      m_Jobs.pop_front();
+    }
+
+    if (FileUtil::Exists(job.path)) continue;
+
+    // write next to target and rename, so readers never see a partial preview
+    FileUtil::MkDir(FileUtil::DirName(job.path));
+    const std::string& tmpPath = job.path + ".tmp";
+    FileUtil::WriteFile(tmpPath, job.data);
+    if (rename(tmpPath.c_str(), job.path.c_str()) != 0)
+    {
+      FileUtil::RmFile(tmpPath);
+      LOG_WARNING("preview write failed %s", job.path.c_str());
+      continue;
+    }
+
+    LOG_TRACE("preview stored %s", job.path.c_str());
+  }
+}
+
+std::string PreviewStore::GetFilePath(const std::string& p_ProfileId, const std::string& p_FileId)
+{
+  // file ids may contain any chars, so are hex encoded to form a file name
+  return FileUtil::GetApplicationDir() + "/history/" + p_ProfileId + "/previews/" +
+    StrUtil::StrToHex(p_FileId) + ".jpg";
+}
@@ -0,0 +1,44 @@
+// previewstore.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// small image previews (protocol-provided thumbnails) of attachments, stored per profile next to
+// the message cache. files are written by a worker pool, so protocol threads never wait for disk.
+class PreviewStore
+{
+public:
+  static void Init();
+  static void Cleanup();
+
+  static void Add(const std::string& p_ProfileId, const std::string& p_FileId, const std::string& p_Data);
+  static std::string GetPath(const std::string& p_ProfileId, const std::string& p_FileId);
+
+private:
+  struct Job
+  {
+    std::string path;
+    std::string data;
+  };
+
+  static void Process();
+  static std::string GetFilePath(const std::string& p_ProfileId, const std::string& p_FileId);
+
+private:
+  static bool m_Running;
+  static std::mutex m_Mutex;
+  static std::condition_variable m_CondVar;
+  static std::deque<Job> m_Jobs;
+  static std::vector<std::thread> m_Threads;
+};
@@ -0,0 +1,111 @@
+// processlauncher.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "processlauncher.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "threadregistry.h"
+
+extern char** environ;
+
+const size_t ProcessLauncher::s_MaxQueued = 16;
+
+ProcessLauncher::ProcessLauncher()
+{
+  m_Thread = std::thread(&ProcessLauncher::Run, this);
+}
+
+ProcessLauncher::~ProcessLauncher()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+    m_Cmds.clear();
+  }
+
+  m_CondVar.notify_one();
+  if (m_Thread.joinable())
+  {
+    m_Thread.join();
+  }
+}
+
+bool ProcessLauncher::Launch(const std::string& p_Cmd)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_Cmds.size() >= s_MaxQueued)
+    {
+      LOG_WARNING("cmd \"%s\" dropped, queue full", p_Cmd.c_str());
+      return false;
+    }
+
+    m_Cmds.push_back(p_Cmd);
+  }
+
+  m_CondVar.notify_one();
+  return true;
+}
+
+// runs command through the shell and waits for it, returning its exit status, or -1 on failure
+int ProcessLauncher::Spawn(const std::string& p_Cmd)
+{
+  // @note: stdin is detached, so the child cannot consume terminal input
+  posix_spawn_file_actions_t fileActions;
+  posix_spawn_file_actions_init(&fileActions);
+  posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+  const char* argv[] = { "sh", "-c", p_Cmd.c_str(), nullptr };
+  pid_t pid = 0;
+  const int spawnRv = posix_spawn(&pid, "/bin/sh", &fileActions, nullptr, const_cast<char* const*>(argv), environ);
+  posix_spawn_file_actions_destroy(&fileActions);
+  if (spawnRv != 0)
+  {
+    LOG_WARNING("cmd \"%s\" spawn failed (%d)", p_Cmd.c_str(), spawnRv);
+    return -1;
+  }
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) == -1)
+  {
+    if (errno != EINTR) return -1;
+  }
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+void ProcessLauncher::Run()
+{
+  ThreadRegistry::Register("launcher");
+
+  while (true)
+  {
+    std::string cmd;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_CondVar.wait(lock, [&]() { return !m_Running || !m_Cmds.empty(); });
+      if (!m_Running) break;
+
+      cmd = m_Cmds.front();
+      m_Cmds.pop_front();
+    }
+
+    LOG_TRACE("cmd \"%s\" start", cmd.c_str());
+    const int rv = Spawn(cmd);
+    if (rv != 0)
+    {
+      LOG_WARNING("cmd \"%s\" failed (%d)", cmd.c_str(), rv);
+    }
+  }
+}
@@ -0,0 +1,38 @@
+// processlauncher.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// runs shell commands on a worker thread, so slow commands do not block the caller. the queue
+// is bounded, commands launched while it is full are dropped.
+class ProcessLauncher
+{
+public:
+  ProcessLauncher();
+  ~ProcessLauncher();
+
+  bool Launch(const std::string& p_Cmd);
+
+private:
+  void Run();
+  static int Spawn(const std::string& p_Cmd);
+
+private:
+  static const size_t s_MaxQueued;
+
+  std::thread m_Thread;
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  std::deque<std::string> m_Cmds;
+  bool m_Running = true;
+};
@@ -7,10 +7,16 @@
 
 #include "protocolutil.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "log.h"
 #include "protocol.h"
 #include "strutil.h"
 
+// @note: about two screens of history, so the first chunk fills the view
+static const size_t s_MessagesChunkSize = 64;
+
 FileInfo ProtocolUtil::FileInfoFromHex(const std::string& p_Str)
 {
   FileInfo fileInfo;
@@ -54,10 +60,60 @@ FileInfo ProtocolUtil::FileInfoFromHex(const std::string& p_Str)
 
 std::string ProtocolUtil::FileInfoToHex(const FileInfo& p_FileInfo)
 {
-  const std::string hexStr =
-    StrUtil::NumToHex<int>(p_FileInfo.fileStatus) + "," +
-    StrUtil::StrToHex(p_FileInfo.fileId) + "," +
-    StrUtil::StrToHex(p_FileInfo.filePath) + "," +
-    StrUtil::StrToHex(p_FileInfo.fileType) + "\n";
+  // built in a single preallocated buffer, as it is called for every message with attachment
+  const std::string fileStatusHex = StrUtil::NumToHex<int>(p_FileInfo.fileStatus);
+  std::string hexStr;
+  hexStr.reserve(fileStatusHex.size() + (2 * (p_FileInfo.fileId.size() + p_FileInfo.filePath.size() +
+                                              p_FileInfo.fileType.size())) + 4);
+  hexStr += fileStatusHex;
+  hexStr += ',';
+  StrUtil::StrAppendHex(hexStr, p_FileInfo.fileId);
+  hexStr += ',';
+  StrUtil::StrAppendHex(hexStr, p_FileInfo.filePath);
+  hexStr += ',';
+  StrUtil::StrAppendHex(hexStr, p_FileInfo.fileType);
+  hexStr += '\n';
   return hexStr;
 }
+
+bool ProtocolUtil::IsChatInfoEqual(const ChatInfo& p_Lhs, const ChatInfo& p_Rhs)
+{
+  return (p_Lhs.id == p_Rhs.id) && (p_Lhs.isUnread == p_Rhs.isUnread) &&
+         (p_Lhs.isUnreadMention == p_Rhs.isUnreadMention) && (p_Lhs.isMuted == p_Rhs.isMuted) &&
+         (p_Lhs.lastMessageTime == p_Rhs.lastMessageTime);
+}
+
+bool ProtocolUtil::IsContactInfoEqual(const ContactInfo& p_Lhs, const ContactInfo& p_Rhs)
+{
+  return (p_Lhs.id == p_Rhs.id) && (p_Lhs.name == p_Rhs.name) && (p_Lhs.phone == p_Rhs.phone) &&
+         (p_Lhs.isSelf == p_Rhs.isSelf);
+}
+
+std::vector<std::shared_ptr<NewMessagesNotify>> ProtocolUtil::SplitMessagesNotify(
+  std::shared_ptr<NewMessagesNotify> p_NewMessagesNotify)
+{
+  // history replies with messages newest first are streamed as bounded chunks, all but last flagged more
+  std::vector<ChatMessage>& chatMessages = p_NewMessagesNotify->chatMessages;
+  if (chatMessages.size() <= s_MessagesChunkSize) return { p_NewMessagesNotify };
+
+  std::vector<std::shared_ptr<NewMessagesNotify>> chunks;
+  for (size_t begin = 0; begin < chatMessages.size(); begin += s_MessagesChunkSize)
+  {
+    const size_t end = std::min(begin + s_MessagesChunkSize, chatMessages.size());
+    std::shared_ptr<NewMessagesNotify> chunk = std::make_shared<NewMessagesNotify>(p_NewMessagesNotify->profileId);
+    chunk->requestId = p_NewMessagesNotify->requestId;
+    chunk->success = p_NewMessagesNotify->success;
+    chunk->chatId = p_NewMessagesNotify->chatId;
+    chunk->fromMsgId = p_NewMessagesNotify->fromMsgId;
+    chunk->cached = p_NewMessagesNotify->cached;
+    chunk->sequence = p_NewMessagesNotify->sequence;
+    chunk->more = (end < chatMessages.size());
+    chunk->chatMessages.assign(std::make_move_iterator(chatMessages.begin() + begin),
+                               std::make_move_iterator(chatMessages.begin() + end));
+    chunks.push_back(chunk);
+  }
+
+  LOG_DEBUG("split messages %s count %d in %d chunks", p_NewMessagesNotify->chatId.c_str(), chatMessages.size(),
+            chunks.size());
+  return chunks;
+}
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "protocol.h"
 
 class ProtocolUtil
@@ -14,4 +17,19 @@ class ProtocolUtil
 public:
   static FileInfo FileInfoFromHex(const std::string& p_Str);
   static std::string FileInfoToHex(const FileInfo& p_FileInfo);
+  static bool IsChatInfoEqual(const ChatInfo& p_Lhs, const ChatInfo& p_Rhs);
+  static bool IsContactInfoEqual(const ContactInfo& p_Lhs, const ContactInfo& p_Rhs);
+  static std::vector<std::shared_ptr<NewMessagesNotify>> SplitMessagesNotify(
+    std::shared_ptr<NewMessagesNotify> p_NewMessagesNotify);
+
+  // messages are ordered by (timeSent, sequence, id), accepts ChatMessage and CompactMessage
+  template<typename TLhs, typename TRhs>
+  static bool IsMessageOlder(const TLhs& p_Lhs, const TRhs& p_Rhs)
+  {
+    if (p_Lhs.timeSent != p_Rhs.timeSent) return p_Lhs.timeSent < p_Rhs.timeSent;
+
+    if (p_Lhs.sequence != p_Rhs.sequence) return p_Lhs.sequence < p_Rhs.sequence;
+
+    return p_Lhs.id < p_Rhs.id;
+  }
 };
@@ -0,0 +1,112 @@
+// requestqueue.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "requestqueue.h"
+
+#include <algorithm>
+
+#include "log.h"
+#include "perfstats.h"
+#include "timeutil.h"
+
+void RequestQueue::Push(std::shared_ptr<RequestMessage> p_RequestMessage)
+{
+  const Lane lane = GetLane(p_RequestMessage->GetMessageType());
+  m_Lanes[lane].push_back(Entry{ p_RequestMessage, TimeUtil::GetCurrentTimeMSec() });
+  m_MaxDepth[lane] = std::max(m_MaxDepth[lane], m_Lanes[lane].size());
+  PerfStats::Add(PerfStats::StatRequestQueueDepth, 1);
+}
+
+std::shared_ptr<RequestMessage> RequestQueue::Pop()
+{
+  // highest priority non-empty lane, unless a lower lane has been passed over too many times
+  int lane = -1;
+  for (int i = 0; i < LaneCount; ++i)
+  {
+    if (m_Lanes[i].empty()) continue;
+
+    if (lane == -1)
+    {
+      lane = i;
+    }
+    else if (m_Skipped[i] >= s_MaxSkipped)
+    {
+      lane = i;
+      break;
+    }
+  }
+
+  if (lane == -1) return nullptr;
+
+  for (int i = 0; i < LaneCount; ++i)
+  {
+    m_Skipped[i] = (m_Lanes[i].empty() || (i == lane)) ? 0 : (m_Skipped[i] + 1);
+  }
+
+  Entry entry = std::move(m_Lanes[lane].front());
+  m_Lanes[lane].pop_front();
+  PerfStats::Add(PerfStats::StatRequestQueueDepth, -1);
+  m_MaxWaitMs[lane] = std::max(m_MaxWaitMs[lane], TimeUtil::GetCurrentTimeMSec() - entry.time);
+  return entry.requestMessage;
+}
+
+bool RequestQueue::Empty() const
+{
+  for (int i = 0; i < LaneCount; ++i)
+  {
+    if (!m_Lanes[i].empty()) return false;
+  }
+
+  return true;
+}
+
+void RequestQueue::LogStats() const
+{
+  LOG_DEBUG("request queue max depth %d/%d/%d max wait %d/%d/%d ms",
+            (int)m_MaxDepth[LaneInteractive], (int)m_MaxDepth[LaneForeground], (int)m_MaxDepth[LaneBackground],
+            (int)m_MaxWaitMs[LaneInteractive], (int)m_MaxWaitMs[LaneForeground], (int)m_MaxWaitMs[LaneBackground]);
+}
+
+void RequestQueue::Clear()
+{
+  for (int i = 0; i < LaneCount; ++i)
+  {
+    PerfStats::Add(PerfStats::StatRequestQueueDepth, -(int64_t)m_Lanes[i].size());
+    m_Lanes[i].clear();
+    m_Skipped[i] = 0;
+    m_MaxDepth[i] = 0;
+    m_MaxWaitMs[i] = 0;
+  }
+}
+
+RequestQueue::Lane RequestQueue::GetLane(MessageType p_MessageType)
+{
+  switch (p_MessageType)
+  {
+    case SendMessageRequestType:
+    case EditMessageRequestType:
+    case DeleteMessageRequestType:
+    case DeleteChatRequestType:
+    case MarkMessageReadRequestType:
+    case MarkMessagesReadRequestType:
+    case SendTypingRequestType:
+    case SetStatusRequestType:
+    case CreateChatRequestType:
+    case SetCurrentChatRequestType:
+      return LaneInteractive;
+
+    case DeferNotifyRequestType:
+    case DeferGetChatDetailsRequestType:
+    case DeferGetUserDetailsRequestType:
+    case DeferDownloadFileRequestType:
+    case DeferGetSponsoredMessagesRequestType:
+      return LaneBackground;
+
+    default:
+      return LaneForeground;
+  }
+}
@@ -0,0 +1,49 @@
+// requestqueue.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "protocol.h"
+
+// prioritized protocol request queue, not thread-safe. requests are ordered fifo within a lane.
+class RequestQueue
+{
+public:
+  enum Lane
+  {
+    LaneInteractive = 0, // sends, edits, deletes and other user actions
+    LaneForeground, // chat and message fetches
+    LaneBackground, // deferred requests
+    LaneCount,
+  };
+
+  void Push(std::shared_ptr<RequestMessage> p_RequestMessage);
+  std::shared_ptr<RequestMessage> Pop();
+  bool Empty() const;
+  void Clear();
+  void LogStats() const;
+
+  static Lane GetLane(MessageType p_MessageType);
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<RequestMessage> requestMessage;
+    int64_t time;
+  };
+
+  std::deque<Entry> m_Lanes[LaneCount];
+  // @note: number of pops a non-empty lane has been passed over, for starvation protection
+  int m_Skipped[LaneCount] = { 0 };
+  size_t m_MaxDepth[LaneCount] = { 0 };
+  int64_t m_MaxWaitMs[LaneCount] = { 0 };
+  static const int s_MaxSkipped = 16;
+};
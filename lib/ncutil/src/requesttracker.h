@@ -0,0 +1,95 @@
+// requesttracker.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lrucache.h"
+#include "perfstats.h"
+
+// dedup of issued requests, a request may be repeated once its window has expired. entries are
+// bounded by count, least recently used evicted first, and the total count of all trackers is
+// published as a stats gauge. not thread-safe.
+template<typename TKey>
+class RequestTracker
+{
+public:
+  RequestTracker(size_t p_MaxCount, int64_t p_WindowMs)
+    : m_Requests(p_MaxCount)
+    , m_WindowMs(p_WindowMs)
+  {
+  }
+
+  ~RequestTracker()
+  {
+    PerfStats::Add(PerfStats::StatRequestsTracked, -m_Count);
+  }
+
+  // returns true and tracks the request if not already issued within the window
+  bool TryBegin(const TKey& p_Key, int64_t p_NowMs)
+  {
+    int64_t beginMs = 0;
+    if (m_Requests.Get(p_Key, beginMs) && ((p_NowMs - beginMs) < m_WindowMs)) return false;
+
+    m_Requests.Put(p_Key, p_NowMs, 1);
+    Publish();
+    return true;
+  }
+
+  void Remove(const TKey& p_Key)
+  {
+    m_Requests.Remove(p_Key);
+    Publish();
+  }
+
+  // remove all keys in range [p_First, p_Last), e.g. those of a deleted chat
+  void RemoveRange(const TKey& p_First, const TKey& p_Last)
+  {
+    m_Requests.RemoveRange(p_First, p_Last);
+    Publish();
+  }
+
+  void Clear()
+  {
+    m_Requests.Clear();
+    Publish();
+  }
+
+  size_t GetCount() const
+  {
+    return m_Requests.GetSize();
+  }
+
+  // calls p_Func(key, beginMs) for each entry, most recently used first
+  template<typename TFunc>
+  void ForEach(TFunc p_Func) const
+  {
+    m_Requests.ForEach(p_Func);
+  }
+
+  // list and map nodes, excluding heap owned by keys
+  size_t GetNodesHeapSize() const
+  {
+    return m_Requests.GetNodesHeapSize();
+  }
+
+private:
+  void Publish()
+  {
+    // published as delta, as multiple trackers share the stat
+    const int64_t count = static_cast<int64_t>(m_Requests.GetSize());
+    PerfStats::Add(PerfStats::StatRequestsTracked, count - m_Count);
+    m_Count = count;
+  }
+
+private:
+  LruCache<TKey, int64_t> m_Requests; // begin time by key, unit size so max size is a count
+  const int64_t m_WindowMs;
+  int64_t m_Count = 0; // last published
+};
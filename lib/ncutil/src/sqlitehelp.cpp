@@ -19,3 +19,101 @@ void SqliteHelp::HandleSqliteException(const char* p_Filename, int p_LineNo,
              code, what, sql.c_str());
   throw;
 }
+
+void SqliteHelp::Rollback(sqlite::database& p_Db)
+{
+  // ends a transaction left open by a failed statement, unless sqlite already rolled it back, e.g. when
+  // out of memory or disk. does not throw, so it may be called before rethrowing the original exception
+  sqlite3* db = p_Db.connection().get();
+  if (sqlite3_get_autocommit(db)) return;
+
+  sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+}
+
+SqliteScan::SqliteScan(sqlite::database& p_Db, const std::string& p_Sql)
+  : m_Sql(p_Sql)
+{
+  int rv = sqlite3_prepare_v2(p_Db.connection().get(), p_Sql.c_str(), -1, &m_Stmt, nullptr);
+  if (rv != SQLITE_OK)
+  {
+    sqlite::errors::throw_sqlite_error(rv, p_Sql);
+  }
+}
+
+SqliteScan::~SqliteScan()
+{
+  sqlite3_finalize(m_Stmt);
+}
+
+SqliteScan& SqliteScan::operator<<(int64_t p_Value)
+{
+  int rv = sqlite3_bind_int64(m_Stmt, ++m_BindIndex, p_Value);
+  if (rv != SQLITE_OK)
+  {
+    sqlite::errors::throw_sqlite_error(rv, m_Sql);
+  }
+
+  return *this;
+}
+
+SqliteScan& SqliteScan::operator<<(const std::string& p_Value)
+{
+  int rv = sqlite3_bind_text(m_Stmt, ++m_BindIndex, p_Value.data(), static_cast<int>(p_Value.size()),
+                             SQLITE_TRANSIENT);
+  if (rv != SQLITE_OK)
+  {
+    sqlite::errors::throw_sqlite_error(rv, m_Sql);
+  }
+
+  return *this;
+}
+
+bool SqliteScan::Step()
+{
+  int rv = sqlite3_step(m_Stmt);
+  if (rv == SQLITE_ROW) return true;
+
+  if (rv != SQLITE_DONE)
+  {
+    sqlite::errors::throw_sqlite_error(rv, m_Sql);
+  }
+
+  return false;
+}
+
+void SqliteScan::Reset()
+{
+  sqlite3_reset(m_Stmt);
+  sqlite3_clear_bindings(m_Stmt);
+  m_BindIndex = 0;
+}
+
+int64_t SqliteScan::GetInt64(int p_Column) const
+{
+  return sqlite3_column_int64(m_Stmt, p_Column);
+}
+
+SqliteText SqliteScan::GetText(int p_Column) const
+{
+  // size must be queried after text, which may convert the column
+  SqliteText text;
+  const unsigned char* data = sqlite3_column_text(m_Stmt, p_Column);
+  if (data != nullptr)
+  {
+    text.data = reinterpret_cast<const char*>(data);
+    text.size = static_cast<size_t>(sqlite3_column_bytes(m_Stmt, p_Column));
+  }
+
+  return text;
+}
+
+bool SqliteScan::IsNull(int p_Column) const
+{
+  return sqlite3_column_type(m_Stmt, p_Column) == SQLITE_NULL;
+}
+
+void SqliteScan::EnableMmap(sqlite::database& p_Db, int64_t p_MmapSize)
+{
+  // scans of a large db are served from the page cache without copying into sqlite buffers
+  p_Db << "PRAGMA mmap_size = " + std::to_string(p_MmapSize) + ";";
+}
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include <sqlite_modern_cpp.h>
@@ -20,4 +21,40 @@ class SqliteHelp
 public:
   static void HandleSqliteException(const char* p_Filename, int p_LineNo,
                                     const sqlite::sqlite_exception& p_Ex);
+  static void Rollback(sqlite::database& p_Db);
+};
+
+// view of text column data owned by sqlite, valid until next SqliteScan::Step()
+struct SqliteText
+{
+  const char* data = "";
+  size_t size = 0;
+
+  bool empty() const { return size == 0; }
+  std::string str() const { return std::string(data, size); }
+};
+
+// forward-only scan of a query for bulk reads, exposing columns without per-row allocations.
+// throws sqlite_exception on errors.
+class SqliteScan
+{
+public:
+  SqliteScan(sqlite::database& p_Db, const std::string& p_Sql);
+  ~SqliteScan();
+
+  SqliteScan& operator<<(int64_t p_Value);
+  SqliteScan& operator<<(const std::string& p_Value);
+  bool Step();
+  void Reset();
+
+  int64_t GetInt64(int p_Column) const;
+  SqliteText GetText(int p_Column) const;
+  bool IsNull(int p_Column) const;
+
+  static void EnableMmap(sqlite::database& p_Db, int64_t p_MmapSize);
+
+private:
+  sqlite3_stmt* m_Stmt = nullptr;
+  std::string m_Sql;
+  int m_BindIndex = 0;
 };
@@ -0,0 +1,122 @@
+// startupprofile.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "startupprofile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "log.h"
+
+std::atomic<bool> StartupProfile::m_Enabled(false);
+std::chrono::steady_clock::time_point StartupProfile::m_StartTime = std::chrono::steady_clock::now();
+std::mutex StartupProfile::m_Mutex;
+std::vector<StartupProfile::Span> StartupProfile::m_Spans;
+std::vector<std::string> StartupProfile::m_Marks;
+
+void StartupProfile::SetEnabled(bool p_Enabled)
+{
+  m_Enabled = p_Enabled;
+}
+
+bool StartupProfile::IsEnabled()
+{
+  return m_Enabled;
+}
+
+int64_t StartupProfile::GetElapsedUSec()
+{
+  const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - m_StartTime;
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void StartupProfile::AddSpan(const std::string& p_Name, int64_t p_BeginUSec, int64_t p_EndUSec)
+{
+  if (!m_Enabled) return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Span span;
+  span.name = p_Name;
+  span.beginUSec = p_BeginUSec;
+  span.endUSec = p_EndUSec;
+  m_Spans.push_back(span);
+}
+
+void StartupProfile::Mark(const std::string& p_Name)
+{
+  if (!m_Enabled) return;
+
+  // only first occurrence of a milestone is recorded
+  const int64_t nowUSec = GetElapsedUSec();
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (std::find(m_Marks.begin(), m_Marks.end(), p_Name) != m_Marks.end()) return;
+
+  m_Marks.push_back(p_Name);
+  Span span;
+  span.name = p_Name;
+  span.beginUSec = nowUSec;
+  span.endUSec = -1;
+  m_Spans.push_back(span);
+}
+
+void StartupProfile::Report()
+{
+  if (!m_Enabled) return;
+
+  std::vector<Span> spans;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    spans = m_Spans;
+  }
+
+  // *INDENT-OFF*
+  std::stable_sort(spans.begin(), spans.end(), [](const Span& lhs, const Span& rhs)
+  {
+    return lhs.beginUSec < rhs.beginUSec;
+  });
+  // *INDENT-ON*
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  ss << "Startup profile (ms):\n";
+  ss << "      start   duration  phase\n";
+  for (const auto& span : spans)
+  {
+    ss << std::setw(11) << (span.beginUSec / 1000.0);
+    if (span.endUSec >= 0)
+    {
+      ss << std::setw(11) << ((span.endUSec - span.beginUSec) / 1000.0);
+    }
+    else
+    {
+      ss << std::setw(11) << "-";
+    }
+
+    ss << "  " << span.name << "\n";
+  }
+
+  const std::string& report = ss.str();
+  LOG_INFO("%s", report.c_str());
+  std::cout << report;
+}
+
+StartupSpan::StartupSpan(const std::string& p_Name)
+{
+  if (!StartupProfile::IsEnabled()) return;
+
+  m_Name = p_Name;
+  m_BeginUSec = StartupProfile::GetElapsedUSec();
+}
+
+StartupSpan::~StartupSpan()
+{
+  if (m_BeginUSec < 0) return;
+
+  StartupProfile::AddSpan(m_Name, m_BeginUSec, StartupProfile::GetElapsedUSec());
+}
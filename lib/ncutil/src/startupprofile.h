@@ -0,0 +1,53 @@
+// startupprofile.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// records startup phase timing, reported on exit when enabled
+class StartupProfile
+{
+public:
+  static void SetEnabled(bool p_Enabled);
+  static bool IsEnabled();
+  static int64_t GetElapsedUSec();
+  static void AddSpan(const std::string& p_Name, int64_t p_BeginUSec, int64_t p_EndUSec);
+  static void Mark(const std::string& p_Name);
+  static void Report();
+
+private:
+  struct Span
+  {
+    std::string name;
+    int64_t beginUSec = 0;
+    int64_t endUSec = 0;
+  };
+
+  static std::atomic<bool> m_Enabled;
+  static std::chrono::steady_clock::time_point m_StartTime;
+  static std::mutex m_Mutex;
+  static std::vector<Span> m_Spans;
+  static std::vector<std::string> m_Marks;
+};
+
+// records a span from construction to destruction
+class StartupSpan
+{
+public:
+  explicit StartupSpan(const std::string& p_Name);
+  ~StartupSpan();
+
+private:
+  std::string m_Name;
+  int64_t m_BeginUSec = -1;
+};
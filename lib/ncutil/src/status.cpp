@@ -7,37 +7,189 @@
 
 #include "status.h"
 
-uint32_t Status::m_Flags = 0;
-std::mutex Status::m_Mutex;
+std::atomic<uint32_t> Status::m_Flags(0);
+std::atomic<int32_t> Status::m_Counts[Status::s_FlagCount];
+std::atomic<void (*)()> Status::m_ChangeHandler(nullptr);
+std::atomic<int32_t> Status::m_ExportProgress(0);
+std::atomic<int64_t> Status::m_BackfillCount(0);
+std::atomic<int64_t> Status::m_UploadedBytes(0);
+std::atomic<int64_t> Status::m_UploadTotalBytes(0);
+
+static int GetFlagIndex(uint32_t p_Flag)
+{
+  int index = 0;
+  while ((p_Flag >>= 1) != 0)
+  {
+    ++index;
+  }
+
+  return index;
+}
 
 uint32_t Status::Get()
 {
-  return m_Flags;
+  uint32_t flags = m_Flags.load();
+  for (int i = 0; i < s_FlagCount; ++i)
+  {
+    const uint32_t flag = (1 << i);
+    if ((flag & s_CountedFlags) && (m_Counts[i].load() > 0))
+    {
+      flags |= flag;
+    }
+  }
+
+  return flags;
 }
 
 void Status::Set(uint32_t p_Flags)
 {
-  std::unique_lock<std::mutex> lock(m_Mutex);
-  m_Flags |= p_Flags;
+  bool changed = false;
+  const uint32_t plainFlags = p_Flags & ~s_CountedFlags;
+  if (plainFlags != 0)
+  {
+    changed |= ((m_Flags.fetch_or(plainFlags) & plainFlags) != plainFlags);
+  }
+
+  for (int i = 0; i < s_FlagCount; ++i)
+  {
+    const uint32_t flag = (1 << i);
+    if (flag & p_Flags & s_CountedFlags)
+    {
+      changed |= (m_Counts[i].fetch_add(1) == 0);
+    }
+  }
+
+  if (changed)
+  {
+    NotifyChange();
+  }
 }
 
 void Status::Clear(uint32_t p_Flags)
 {
-  std::unique_lock<std::mutex> lock(m_Mutex);
-  m_Flags &= ~p_Flags;
+  bool changed = false;
+  const uint32_t plainFlags = p_Flags & ~s_CountedFlags;
+  if (plainFlags != 0)
+  {
+    changed |= ((m_Flags.fetch_and(~plainFlags) & plainFlags) != 0);
+  }
+
+  for (int i = 0; i < s_FlagCount; ++i)
+  {
+    const uint32_t flag = (1 << i);
+    if (flag & p_Flags & s_CountedFlags)
+    {
+      // decrement, but not below zero in case of an unbalanced clear
+      std::atomic<int32_t>& count = m_Counts[i];
+      int32_t value = count.load();
+      while ((value > 0) && !count.compare_exchange_weak(value, value - 1))
+      {
+      }
+
+      changed |= (value == 1);
+    }
+  }
+
+  if (changed)
+  {
+    NotifyChange();
+  }
 }
 
 std::string Status::ToString(uint32_t p_Mask)
 {
-  std::unique_lock<std::mutex> lock(m_Mutex);
-  const uint32_t maskedFlags = m_Flags & p_Mask;
+  const uint32_t maskedFlags = Get() & p_Mask;
 
   if (maskedFlags & FlagSyncing) return "Syncing";
+  if (maskedFlags & FlagBackfilling)
+  {
+    // messages of full chat loads stored so far
+    return "Loading history (" + std::to_string(m_BackfillCount.load()) + ")";
+  }
+
   if (maskedFlags & FlagFetching) return "Fetching";
+  if (maskedFlags & FlagUploading)
+  {
+    // number of active uploads, and their progress where reported by the protocol
+    const int32_t count = m_Counts[GetFlagIndex(FlagUploading)].load();
+    const int64_t totalBytes = m_UploadTotalBytes.load();
+    const int64_t uploadedBytes = m_UploadedBytes.load();
+    std::string detail = (count > 1) ? std::to_string(count) : "";
+    if ((totalBytes > 0) && (uploadedBytes > 0))
+    {
+      detail += (detail.empty() ? "" : ", ") + std::to_string((uploadedBytes * 100) / totalBytes) + "%";
+    }
+
+    return detail.empty() ? "Uploading" : ("Uploading (" + detail + ")");
+  }
+
   if (maskedFlags & FlagSending) return "Sending";
   if (maskedFlags & FlagUpdating) return "Updating";
+  if (maskedFlags & FlagConnecting)
+  {
+    // number of profiles still connecting
+    const int32_t count = m_Counts[GetFlagIndex(FlagConnecting)].load();
+    return (count > 1) ? ("Connecting (" + std::to_string(count) + ")") : "Connecting";
+  }
+
+  if (maskedFlags & FlagExporting)
+  {
+    return "Exporting (" + std::to_string(m_ExportProgress.load()) + "%)";
+  }
+
   if (maskedFlags & FlagAway) return "Away";
   if (maskedFlags & FlagOnline) return "Online";
 
   return "Offline";
 }
+
+void Status::SetChangeHandler(void (*p_ChangeHandler)())
+{
+  m_ChangeHandler = p_ChangeHandler;
+}
+
+void Status::SetExportProgress(int32_t p_Percent)
+{
+  if (m_ExportProgress.exchange(p_Percent) != p_Percent)
+  {
+    NotifyChange();
+  }
+}
+
+int32_t Status::GetExportProgress()
+{
+  return m_ExportProgress;
+}
+
+void Status::SetBackfillCount(int64_t p_Count)
+{
+  if (m_BackfillCount.exchange(p_Count) != p_Count)
+  {
+    NotifyChange();
+  }
+}
+
+int64_t Status::GetBackfillCount()
+{
+  return m_BackfillCount;
+}
+
+void Status::AddUploadBytes(int64_t p_Uploaded, int64_t p_Total)
+{
+  // totals of active uploads, added at start and progress, and subtracted again at completion
+  m_UploadedBytes += p_Uploaded;
+  m_UploadTotalBytes += p_Total;
+  if (p_Uploaded != 0)
+  {
+    NotifyChange();
+  }
+}
+
+void Status::NotifyChange()
+{
+  void (*changeHandler)() = m_ChangeHandler.load();
+  if (changeHandler != nullptr)
+  {
+    changeHandler();
+  }
+}
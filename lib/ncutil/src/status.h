@@ -7,8 +7,8 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
-#include <mutex>
 #include <string>
 
 class Status
@@ -24,14 +24,36 @@ public:
     FlagUpdating = (1 << 4),
     FlagSyncing = (1 << 5),
     FlagAway = (1 << 6),
+    FlagConnecting = (1 << 7),
+    FlagExporting = (1 << 8),
+    FlagBackfilling = (1 << 9),
+    FlagUploading = (1 << 10),
   };
 
   static uint32_t Get();
   static void Set(uint32_t p_Flags);
   static void Clear(uint32_t p_Flags);
   static std::string ToString(uint32_t p_Mask);
+  static void SetChangeHandler(void (*p_ChangeHandler)());
+  static void SetExportProgress(int32_t p_Percent);
+  static int32_t GetExportProgress();
+  static void SetBackfillCount(int64_t p_Count);
+  static int64_t GetBackfillCount();
+  static void AddUploadBytes(int64_t p_Uploaded, int64_t p_Total);
 
 private:
-  static uint32_t m_Flags;
-  static std::mutex m_Mutex;
+  static void NotifyChange();
+
+private:
+  // @note: activity flags are set/cleared in pairs per request and nest, others are plain state
+  static const uint32_t s_CountedFlags = FlagFetching | FlagSending | FlagUpdating | FlagConnecting |
+                                       FlagUploading;
+  static const int s_FlagCount = 11;
+  static std::atomic<uint32_t> m_Flags;
+  static std::atomic<int32_t> m_Counts[s_FlagCount];
+  static std::atomic<int32_t> m_ExportProgress;
+  static std::atomic<int64_t> m_BackfillCount;
+  static std::atomic<int64_t> m_UploadedBytes;
+  static std::atomic<int64_t> m_UploadTotalBytes;
+  static std::atomic<void (*)()> m_ChangeHandler;
 };
@@ -7,8 +7,11 @@
 
 #include "strutil.h"
 
+#include <atomic>
 #include <codecvt>
+#include <cstdint>
 #include <cstring>
+#include <cwctype>
 #include <fstream>
 #include <iostream>
 #include <locale>
@@ -21,7 +24,39 @@
 #include "emojiutil.h"
 #include "log.h"
 
-void StrUtil::DeleteToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars)
+// wcwidth() cached in lazily allocated blocks of 256 code points
+static int WCharWidth(wchar_t p_WCh)
+{
+  static const uint32_t blockCount = 0x110000 >> 8;
+  const uint32_t codePoint = (uint32_t)p_WCh;
+  if ((codePoint >= 0x110000) || (MB_CUR_MAX == 1)) return wcwidth(p_WCh); // outside unicode or c locale
+
+  // @note: blocks are never freed, a lost publish race only costs one extra block computation
+  static std::atomic<int8_t*> blocks[blockCount];
+  const uint32_t blockIndex = codePoint >> 8;
+  int8_t* block = blocks[blockIndex].load(std::memory_order_acquire);
+  if (block == nullptr)
+  {
+    int8_t* newBlock = new int8_t[256];
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      newBlock[i] = (int8_t)wcwidth((wchar_t)((blockIndex << 8) | i));
+    }
+
+    if (blocks[blockIndex].compare_exchange_strong(block, newBlock, std::memory_order_acq_rel))
+    {
+      block = newBlock;
+    }
+    else
+    {
+      delete[] newBlock;
+    }
+  }
+
+  return block[codePoint & 0xFF];
+}
+
+void StrUtil::DeleteToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars)
 {
   int searchPos = std::max(0, (p_Pos + p_Offs));
   size_t nextMatchPos = p_Str.find_first_of(p_Chars, searchPos);
@@ -37,7 +72,7 @@ void StrUtil::DeleteToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std
   p_Pos = std::min(p_Pos, (int)p_Str.size());
 }
 
-void StrUtil::DeleteToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars)
+void StrUtil::DeleteToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars)
 {
   int searchPos = std::max(0, (p_Pos + p_Offs));
   size_t prevMatchPos = p_Str.find_last_of(p_Chars, searchPos);
@@ -55,46 +90,138 @@ std::string StrUtil::Emojize(const std::string& p_Str, bool p_Pad /*= false*/)
   return EmojiUtil::Emojize(p_Str, p_Pad);
 }
 
-std::string StrUtil::EscapeRawUrls(const std::string& p_Str)
+std::string StrUtil::EscapeJson(const std::string& p_Str)
 {
-  std::string str = p_Str;
   std::string rv;
-  std::regex rg("\\(?\\[?(http|https):\\/\\/([^\\s]+)");
-  std::smatch sm;
-  while (regex_search(str, sm, rg))
+  rv.reserve(p_Str.size());
+  AppendEscapeJson(rv, p_Str.data(), p_Str.size());
+  return rv;
+}
+
+void StrUtil::AppendEscapeJson(std::string& p_Dest, const char* p_Data, size_t p_Size)
+{
+  for (size_t i = 0; i < p_Size; ++i)
   {
-    rv += sm.prefix().str();
+    const char ch = p_Data[i];
+    switch (ch)
+    {
+      case '"': p_Dest += "\\\""; break;
+      case '\\': p_Dest += "\\\\"; break;
+      case '\b': p_Dest += "\\b"; break;
+      case '\f': p_Dest += "\\f"; break;
+      case '\n': p_Dest += "\\n"; break;
+      case '\r': p_Dest += "\\r"; break;
+      case '\t': p_Dest += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(ch) < 0x20)
+        {
+          char hexstr[8] = { 0 };
+          snprintf(hexstr, sizeof(hexstr), "\\u%04x", static_cast<unsigned char>(ch));
+          p_Dest += hexstr;
+        }
+        else
+        {
+          p_Dest += ch;
+        }
+        break;
+    }
+  }
+}
+
+// whitespace as matched by \s in a std::regex
+static inline bool IsUrlSpace(char p_Ch)
+{
+  return (p_Ch == ' ') || (p_Ch == '\t') || (p_Ch == '\n') || (p_Ch == '\v') || (p_Ch == '\f') || (p_Ch == '\r');
+}
+
+// returns end of an url "http(s)://<non-space>+" at p_Pos, or npos if there is none
+static size_t UrlEnd(const std::string& p_Str, size_t p_Pos)
+{
+  static const std::string http = "http://";
+  static const std::string https = "https://";
+  size_t pos = std::string::npos;
+  if (p_Str.compare(p_Pos, http.size(), http) == 0)
+  {
+    pos = p_Pos + http.size();
+  }
+  else if (p_Str.compare(p_Pos, https.size(), https) == 0)
+  {
+    pos = p_Pos + https.size();
+  }
+
+  if ((pos >= p_Str.size()) || IsUrlSpace(p_Str[pos])) return std::string::npos;
+
+  while ((pos < p_Str.size()) && !IsUrlSpace(p_Str[pos]))
+  {
+    ++pos;
+  }
+
+  return pos;
+}
 
-    std::string url = sm.str();
-    if (url.size() >= 2)
+// linear scan equivalent to std::regex_search for "\(?\[?(http|https):\/\/([^\s]+)" from p_Pos, with
+// the bracket prefix only if p_AllowBracket. returns match begin, or npos, and sets p_End.
+static size_t FindRawUrl(const std::string& p_Str, size_t p_Pos, bool p_AllowBracket, size_t& p_End)
+{
+  for (size_t begin = p_Str.find_first_of(p_AllowBracket ? "([h" : "(h", p_Pos); begin != std::string::npos;
+       begin = p_Str.find_first_of(p_AllowBracket ? "([h" : "(h", begin + 1))
+  {
+    size_t pos = begin;
+    if (p_Str[pos] == '(')
     {
-      if ((url.front() == '(') || (url.front() == '['))
-      {
-        rv += url;
-      }
-      else
-      {
-        rv += "[" + url + "]";
-      }
+      ++pos;
+    }
+
+    if (p_AllowBracket && (pos < p_Str.size()) && (p_Str[pos] == '['))
+    {
+      ++pos;
+    }
+
+    p_End = UrlEnd(p_Str, pos);
+    if (p_End != std::string::npos) return begin;
+  }
+
+  return std::string::npos;
+}
+
+std::string StrUtil::EscapeRawUrls(const std::string& p_Str)
+{
+  std::string rv;
+  size_t pos = 0;
+  size_t end = 0;
+  for (size_t begin = FindRawUrl(p_Str, pos, true, end); begin != std::string::npos;
+       begin = FindRawUrl(p_Str, pos, true, end))
+  {
+    rv.append(p_Str, pos, begin - pos);
+    if ((p_Str[begin] == '(') || (p_Str[begin] == '['))
+    {
+      rv.append(p_Str, begin, end - begin);
+    }
+    else
+    {
+      rv += '[';
+      rv.append(p_Str, begin, end - begin);
+      rv += ']';
     }
-    str = sm.suffix();
+
+    pos = end;
   }
 
-  rv += str;
+  rv.append(p_Str, pos, std::string::npos);
 
   return rv;
 }
 
 std::vector<std::string> StrUtil::ExtractUrlsFromStr(const std::string& p_Str)
 {
-  std::string str = p_Str;
   std::vector<std::string> rv;
-  std::regex rg("\\(?(http|https):\\/\\/([^\\s]+)");
-  std::smatch sm;
-  while (regex_search(str, sm, rg))
+  size_t pos = 0;
+  size_t end = 0;
+  for (size_t begin = FindRawUrl(p_Str, pos, false, end); begin != std::string::npos;
+       begin = FindRawUrl(p_Str, pos, false, end))
   {
-    std::string url = sm.str();
-    if ((url.size() >= 2) && (url.front() == '('))
+    std::string url = p_Str.substr(begin, end - begin);
+    if (url.front() == '(')
     {
       size_t closeParenthesis = url.find(')');
       if (closeParenthesis != std::string::npos)
@@ -102,13 +229,68 @@ std::vector<std::string> StrUtil::ExtractUrlsFromStr(const std::string& p_Str)
         url = url.substr(1, closeParenthesis - 1);
       }
     }
+
     rv.push_back(url);
-    str = sm.suffix();
+    pos = end;
   }
 
   return rv;
 }
 
+template<typename TChar>
+static inline TChar AsciiLower(TChar p_Ch)
+{
+  return ((p_Ch >= 'A') && (p_Ch <= 'Z')) ? (TChar)(p_Ch + ('a' - 'A')) : p_Ch;
+}
+
+// ascii case-insensitive find of a needle with A-Z already lowered, other characters match exactly.
+// candidates for its first character are located with char_traits find (memchr / wmemchr, which
+// libc vectorizes), and only those are compared, so text without candidates is scanned at memory speed.
+template<typename TString>
+static size_t FindIgnoreCaseImpl(const TString& p_Str, const TString& p_LowerNeedle, size_t p_Pos)
+{
+  typedef typename TString::value_type CharType;
+  typedef typename TString::traits_type Traits;
+  if (p_LowerNeedle.empty()) return (p_Pos <= p_Str.size()) ? p_Pos : TString::npos;
+
+  if ((p_Pos >= p_Str.size()) || (p_LowerNeedle.size() > (p_Str.size() - p_Pos))) return TString::npos;
+
+  const CharType lowerFirst = p_LowerNeedle[0];
+  const bool isAlpha = (lowerFirst >= 'a') && (lowerFirst <= 'z');
+  const CharType upperFirst = isAlpha ? (CharType)(lowerFirst - ('a' - 'A')) : lowerFirst;
+  const CharType* data = p_Str.data();
+  const CharType* last = data + (p_Str.size() - p_LowerNeedle.size()); // last possible match start
+  const CharType* lowerIt = Traits::find(data + p_Pos, (last - (data + p_Pos)) + 1, lowerFirst);
+  const CharType* upperIt = isAlpha ? Traits::find(data + p_Pos, (last - (data + p_Pos)) + 1, upperFirst) : nullptr;
+  while ((lowerIt != nullptr) || (upperIt != nullptr))
+  {
+    const bool isLower = (upperIt == nullptr) || ((lowerIt != nullptr) && (lowerIt < upperIt));
+    const CharType* it = isLower ? lowerIt : upperIt;
+    size_t i = 1;
+    while ((i < p_LowerNeedle.size()) && (AsciiLower(it[i]) == p_LowerNeedle[i]))
+    {
+      ++i;
+    }
+
+    if (i == p_LowerNeedle.size()) return it - data;
+
+    const CharType* next = (it < last) ? Traits::find(it + 1, last - it, isLower ? lowerFirst : upperFirst) : nullptr;
+    (isLower ? lowerIt : upperIt) = next;
+  }
+
+  return TString::npos;
+}
+
+size_t StrUtil::FindIgnoreCase(const std::string& p_Str, const std::string& p_LowerNeedle, size_t p_Pos /*= 0*/)
+{
+  return FindIgnoreCaseImpl(p_Str, p_LowerNeedle, p_Pos);
+}
+
+size_t StrUtil::FindIgnoreCase(const std::wstring& p_Str, const std::wstring& p_LowerNeedle, size_t p_Pos /*= 0*/)
+{
+  return FindIgnoreCaseImpl(p_Str, p_LowerNeedle, p_Pos);
+}
+
 std::string StrUtil::GetPass()
 {
   std::string pass;
@@ -142,8 +324,7 @@ std::string StrUtil::GetPhoneNumber()
 
 std::string StrUtil::GetProtocolName(const std::string& p_ProfileId)
 {
-  std::vector<std::string> parts = StrUtil::Split(p_ProfileId, '_');
-  return parts.empty() ? p_ProfileId : parts.at(0);
+  return StrUtil::SplitFirst(p_ProfileId, '_');
 }
 
 bool StrUtil::GetQuotePrefix(const std::wstring& p_String, std::wstring& p_Prefix, std::wstring& p_Line)
@@ -214,7 +395,7 @@ std::wstring StrUtil::Join(const std::vector<std::wstring>& p_Lines, const std::
   return str;
 }
 
-void StrUtil::JumpToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars)
+void StrUtil::JumpToNextMatch(const std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars)
 {
   int searchPos = std::max(0, (p_Pos + p_Offs));
   size_t nextMatchPos = p_Str.find_first_of(p_Chars, searchPos);
@@ -228,7 +409,7 @@ void StrUtil::JumpToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::
   }
 }
 
-void StrUtil::JumpToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars)
+void StrUtil::JumpToPrevMatch(const std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars)
 {
   int searchPos = std::max(0, (p_Pos + p_Offs));
   size_t prevMatchPos = p_Str.find_last_of(p_Chars, searchPos);
@@ -266,25 +447,79 @@ void StrUtil::ReplaceString(std::string& p_Str, const std::string& p_Search, con
 
 std::vector<std::string> StrUtil::Split(const std::string& p_Str, char p_Sep)
 {
+  // a string with n separators always yields n + 1 parts, like the getline based split did
   std::vector<std::string> vec;
-  std::stringstream ss(p_Str);
-  while (ss.good())
+  size_t pos = 0;
+  size_t begin = 0;
+  size_t len = 0;
+  while (SplitNext(p_Str, p_Sep, pos, begin, len))
   {
-    std::string str;
-    getline(ss, str, p_Sep);
-    vec.push_back(str);
+    vec.emplace_back(p_Str, begin, len);
   }
+
   return vec;
 }
 
+std::string StrUtil::SplitFirst(const std::string& p_Str, char p_Sep)
+{
+  const void* sep = memchr(p_Str.data(), p_Sep, p_Str.size());
+  return (sep == nullptr) ? p_Str : p_Str.substr(0, static_cast<const char*>(sep) - p_Str.data());
+}
+
+// iterates parts as offsets without copying, p_Pos starts at 0 and is npos after the last part
+bool StrUtil::SplitNext(const std::string& p_Str, char p_Sep, size_t& p_Pos, size_t& p_Begin, size_t& p_Len)
+{
+  if (p_Pos > p_Str.size()) return false;
+
+  const void* sep = memchr(p_Str.data() + p_Pos, p_Sep, p_Str.size() - p_Pos);
+  const size_t end = (sep == nullptr) ? p_Str.size() : (static_cast<const char*>(sep) - p_Str.data());
+  p_Begin = p_Pos;
+  p_Len = end - p_Pos;
+  p_Pos = (sep == nullptr) ? std::string::npos : (end + 1);
+  return true;
+}
+
+static const char s_HexDigits[] = "0123456789ABCDEF";
+
+// value of hex digit, or -1
+static inline int HexValue(char p_Ch)
+{
+  if ((p_Ch >= '0') && (p_Ch <= '9')) return p_Ch - '0';
+  if ((p_Ch >= 'A') && (p_Ch <= 'F')) return p_Ch - 'A' + 10;
+  if ((p_Ch >= 'a') && (p_Ch <= 'f')) return p_Ch - 'a' + 10;
+  return -1;
+}
+
+void StrUtil::StrAppendHex(std::string& p_Dest, const std::string& p_String)
+{
+  const size_t offset = p_Dest.size();
+  p_Dest.resize(offset + (p_String.size() * 2));
+  for (size_t i = 0; i < p_String.size(); ++i)
+  {
+    const unsigned char ch = p_String[i];
+    p_Dest[offset + (2 * i)] = s_HexDigits[ch >> 4];
+    p_Dest[offset + (2 * i) + 1] = s_HexDigits[ch & 0xF];
+  }
+}
+
 std::string StrUtil::StrFromHex(const std::string& p_String)
 {
-  std::string result;
-  std::istringstream iss(p_String);
-  char buf[3] = { 0 };
-  while (iss.read(buf, 2))
+  const size_t len = p_String.size() / 2;
+  std::string result(len, '\0');
+  for (size_t i = 0; i < len; ++i)
   {
-    result += static_cast<char>(strtol(buf, NULL, 16) & 0xff);
+    const int hi = HexValue(p_String[(2 * i)]);
+    const int lo = HexValue(p_String[(2 * i) + 1]);
+    if ((hi != -1) && (lo != -1))
+    {
+      result[i] = static_cast<char>((hi << 4) | lo);
+    }
+    else
+    {
+      // keep strtol() semantics for malformed pairs
+      char buf[3] = { p_String[(2 * i)], p_String[(2 * i) + 1], 0 };
+      result[i] = static_cast<char>(strtol(buf, NULL, 16) & 0xff);
+    }
   }
 
   return result;
@@ -308,15 +543,15 @@ std::string StrUtil::StrFromOct(const std::string& p_String)
 
 std::string StrUtil::StrToHex(const std::string& p_String)
 {
-  std::ostringstream oss;
-  for (const char& ch : p_String)
+  std::string result(p_String.size() * 2, '\0');
+  for (size_t i = 0; i < p_String.size(); ++i)
   {
-    char buf[3] = { 0 };
-    snprintf(buf, sizeof(buf), "%02X", (unsigned char)ch);
-    oss << buf;
+    const unsigned char ch = p_String[i];
+    result[(2 * i)] = s_HexDigits[ch >> 4];
+    result[(2 * i) + 1] = s_HexDigits[ch & 0xF];
   }
 
-  return oss.str();
+  return result;
 }
 
 std::string StrUtil::Textize(const std::string& p_Str)
@@ -333,19 +568,182 @@ long StrUtil::ToInteger(const std::string& p_Str)
 std::string StrUtil::ToLower(const std::string& p_Str)
 {
   std::string lower = p_Str;
-  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  ToLowerInPlace(lower);
   return lower;
 }
 
 std::wstring StrUtil::ToLower(const std::wstring& p_WStr)
 {
   std::wstring lower = p_WStr;
-  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  ToLowerInPlace(lower);
   return lower;
 }
 
+void StrUtil::ToLowerInPlace(std::string& p_Str)
+{
+  // bytes of multi-byte utf-8 sequences are never in A-Z, so they are left as is
+  for (char& ch : p_Str)
+  {
+    if ((ch >= 'A') && (ch <= 'Z'))
+    {
+      ch = ch + ('a' - 'A');
+    }
+  }
+}
+
+void StrUtil::ToLowerInPlace(std::wstring& p_WStr)
+{
+  for (wchar_t& ch : p_WStr)
+  {
+    if (ch < 0x80)
+    {
+      if ((ch >= L'A') && (ch <= L'Z'))
+      {
+        ch = ch + (L'a' - L'A');
+      }
+    }
+    else
+    {
+      ch = std::towlower(ch);
+    }
+  }
+}
+
+// number of leading ascii bytes, checked a word at a time
+static size_t AsciiPrefixLen(const char* p_Data, size_t p_Len)
+{
+  size_t pos = 0;
+  for (; (pos + sizeof(uint64_t)) <= p_Len; pos += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, p_Data + pos, sizeof(word));
+    if ((word & 0x8080808080808080ULL) != 0) break;
+  }
+
+  while ((pos < p_Len) && ((unsigned char)p_Data[pos] < 0x80))
+  {
+    ++pos;
+  }
+
+  return pos;
+}
+
+// strict utf-8 decode, rejecting overlong forms, surrogates and code points above U+10FFFF
+static bool Utf8ToWString(const std::string& p_Str, std::wstring& p_WStr)
+{
+  const char* data = p_Str.data();
+  const size_t len = p_Str.size();
+  p_WStr.resize(len); // never more code points than bytes
+  wchar_t* out = &p_WStr[0];
+  size_t outLen = 0;
+  size_t pos = 0;
+  while (pos < len)
+  {
+    const size_t asciiLen = AsciiPrefixLen(data + pos, len - pos);
+    for (size_t i = 0; i < asciiLen; ++i)
+    {
+      out[outLen++] = (wchar_t)data[pos + i];
+    }
+
+    pos += asciiLen;
+    if (pos >= len) break;
+
+    const unsigned char ch = data[pos];
+    uint32_t codePoint = 0;
+    size_t count = 0;
+    unsigned char min = 0x80;
+    unsigned char max = 0xBF;
+    if ((ch >= 0xC2) && (ch <= 0xDF))
+    {
+      codePoint = ch & 0x1F;
+      count = 1;
+    }
+    else if ((ch >= 0xE0) && (ch <= 0xEF))
+    {
+      codePoint = ch & 0x0F;
+      count = 2;
+      min = (ch == 0xE0) ? 0xA0 : 0x80;
+      max = (ch == 0xED) ? 0x9F : 0xBF;
+    }
+    else if ((ch >= 0xF0) && (ch <= 0xF4))
+    {
+      codePoint = ch & 0x07;
+      count = 3;
+      min = (ch == 0xF0) ? 0x90 : 0x80;
+      max = (ch == 0xF4) ? 0x8F : 0xBF;
+    }
+    else
+    {
+      return false;
+    }
+
+    if ((pos + count) >= len) return false;
+
+    for (size_t i = 1; i <= count; ++i)
+    {
+      const unsigned char cont = data[pos + i];
+      if ((cont < min) || (cont > max)) return false;
+
+      codePoint = (codePoint << 6) | (cont & 0x3F);
+      min = 0x80;
+      max = 0xBF;
+    }
+
+    out[outLen++] = (wchar_t)codePoint;
+    pos += count + 1;
+  }
+
+  p_WStr.resize(outLen);
+  return true;
+}
+
+static bool WStringToUtf8(const std::wstring& p_WStr, std::string& p_Str)
+{
+  p_Str.resize(p_WStr.size() * 4); // at most four bytes per code point
+  char* out = &p_Str[0];
+  size_t outLen = 0;
+  for (wchar_t wch : p_WStr)
+  {
+    const uint32_t codePoint = (uint32_t)wch;
+    if (codePoint < 0x80)
+    {
+      out[outLen++] = (char)codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+      out[outLen++] = (char)(0xC0 | (codePoint >> 6));
+      out[outLen++] = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+      if ((codePoint >= 0xD800) && (codePoint <= 0xDFFF)) return false;
+
+      out[outLen++] = (char)(0xE0 | (codePoint >> 12));
+      out[outLen++] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+      out[outLen++] = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint <= 0x10FFFF)
+    {
+      out[outLen++] = (char)(0xF0 | (codePoint >> 18));
+      out[outLen++] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+      out[outLen++] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+      out[outLen++] = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  p_Str.resize(outLen);
+  return true;
+}
+
 std::string StrUtil::ToString(const std::wstring& p_WStr)
 {
+  std::string str;
+  if ((sizeof(wchar_t) >= 4) && WStringToUtf8(p_WStr, str)) return str;
+
   try
   {
     return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{ }.to_bytes(p_WStr);
@@ -355,13 +753,16 @@ std::string StrUtil::ToString(const std::wstring& p_WStr)
     LOG_WARNING("failed to convert from utf-16");
     std::wstring wstr = p_WStr;
     wstr.erase(std::remove_if(wstr.begin(), wstr.end(), [](wchar_t wch) { return !isascii(wch); }), wstr.end());
-    std::string str = std::string(wstr.begin(), wstr.end());
+    str = std::string(wstr.begin(), wstr.end());
     return str;
   }
 }
 
 std::wstring StrUtil::ToWString(const std::string& p_Str)
 {
+  std::wstring wstr;
+  if ((sizeof(wchar_t) >= 4) && Utf8ToWString(p_Str, wstr)) return wstr;
+
   try
   {
     return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{ }.from_bytes(p_Str);
@@ -371,7 +772,7 @@ std::wstring StrUtil::ToWString(const std::string& p_Str)
     LOG_WARNING("failed to convert from utf-8");
     std::string str = p_Str;
     str.erase(std::remove_if(str.begin(), str.end(), [](unsigned char ch) { return !isascii(ch); }), str.end());
-    std::wstring wstr = std::wstring(str.begin(), str.end());
+    wstr = std::wstring(str.begin(), str.end());
     return wstr;
   }
 }
@@ -379,21 +780,50 @@ std::wstring StrUtil::ToWString(const std::string& p_Str)
 std::wstring StrUtil::TrimPadWString(const std::wstring& p_Str, int p_Len)
 {
   p_Len = std::max(p_Len, 0);
-  std::wstring str = p_Str;
-  if (WStringWidth(str) > p_Len)
+  const int width = WStringWidth(p_Str);
+  if (width > p_Len)
   {
-    str = str.substr(0, p_Len);
-    int subLen = p_Len;
-    while (WStringWidth(str) > p_Len)
+    // longest prefix of at most p_Len chars that fits, prefix widths follow WStringWidth()
+    const int maxLen = std::min(p_Len, (int)p_Str.size());
+    int subLen = 0;
+    int sumWidth = 0;
+    bool isPrintable = true;
+    bool isTerminated = false;
+    for (int len = 1; len <= maxLen; ++len)
     {
-      str = str.substr(0, --subLen);
+      const wchar_t wch = p_Str[len - 1];
+      if (wch == 0)
+      {
+        isTerminated = true;
+      }
+      else if (!isTerminated && isPrintable)
+      {
+        const int charWidth = ((wch >= 0x20) && (wch < 0x7F)) ? 1 : WCharWidth(wch);
+        if (charWidth == -1)
+        {
+          isPrintable = false;
+        }
+        else
+        {
+          sumWidth += charWidth;
+        }
+      }
+
+      const int prefixWidth = isPrintable ? sumWidth : len;
+      if (prefixWidth <= p_Len)
+      {
+        subLen = len;
+      }
     }
+
+    return p_Str.substr(0, subLen);
   }
-  else if (WStringWidth(str) < p_Len)
+  else if (width < p_Len)
   {
-    str = str + std::wstring(p_Len - WStringWidth(str), ' ');
+    return p_Str + std::wstring(p_Len - width, ' ');
   }
-  return str;
+
+  return p_Str;
 }
 
 std::vector<std::wstring> StrUtil::WordWrap(std::wstring p_Text, unsigned p_LineLength,
@@ -413,15 +843,8 @@ std::vector<std::wstring> StrUtil::WordWrap(std::wstring p_Text, unsigned p_Line
                                             bool p_QuoteWrap, int p_ExpandTabSize,
                                             int p_Pos, int& p_WrapLine, int& p_WrapPos)
 {
-  std::wostringstream wrapped;
   std::vector<std::wstring> lines;
 
-  p_WrapLine = 0;
-  p_WrapPos = 0;
-
-  const unsigned wrapLineLength = p_LineLength - 1; // lines with spaces allowed to width - 1
-  const unsigned overflowLineLength = p_LineLength; // overflowing lines allowed to full width
-
   if (p_ProcessFormatFlowed)
   {
     bool prevLineFlowed = false;
@@ -503,125 +926,262 @@ std::vector<std::wstring> StrUtil::WordWrap(std::wstring p_Text, unsigned p_Line
     p_Text = outss.str().substr(1);
   }
 
-  if (p_ExpandTabSize > 0)
+  size_t lineStart = 0;
+  bool isFirstLine = true;
+  while (lineStart < p_Text.size())
   {
-    size_t pos = 0;
-    const std::wstring wsearch = L"\t";
-    while ((pos = p_Text.find(wsearch, pos)) != std::wstring::npos)
+    size_t lineEnd = p_Text.find(L'\n', lineStart);
+    if (lineEnd == std::wstring::npos)
     {
-      size_t lineStart = p_Text.rfind(L'\n', pos);
-      if (lineStart == std::wstring::npos)
-      {
-        lineStart = 0;
-      }
+      lineEnd = p_Text.size();
+    }
+
+    WordWrapLine(p_Text.substr(lineStart, lineEnd - lineStart), p_LineLength, p_OutputFormatFlowed, p_QuoteWrap,
+                 p_ExpandTabSize, isFirstLine, lines);
+    lineStart = lineEnd + 1;
+    isFirstLine = false;
+  }
 
-      const size_t tabColumn = pos - lineStart - 1;
-      const int tabSpaces = (p_ExpandTabSize - (tabColumn % p_ExpandTabSize));
-      std::wstring replace(tabSpaces, L' ');
+  WordWrapPos(lines, p_LineLength, p_Pos, p_WrapLine, p_WrapPos);
+  return lines;
+}
 
-      p_Text.replace(pos, wsearch.length(), replace);
-      pos += replace.length();
+void StrUtil::WordWrapLine(const std::wstring& p_Line, unsigned p_LineLength, bool p_OutputFormatFlowed,
+                           bool p_QuoteWrap, int p_ExpandTabSize, bool p_IsFirstLine,
+                           std::vector<std::wstring>& p_Lines)
+{
+  const unsigned wrapLineLength = p_LineLength - 1; // lines with spaces allowed to width - 1
+  const unsigned overflowLineLength = p_LineLength; // overflowing lines allowed to full width
+
+  std::wstring line;
+  if ((p_ExpandTabSize > 0) && (p_Line.find(L'\t') != std::wstring::npos))
+  {
+    line.reserve(p_Line.size());
+    for (wchar_t wch : p_Line)
+    {
+      if (wch == L'\t')
+      {
+        // first text line column is offset by one, kept for compatibility with earlier wrapping
+        const size_t tabColumn = p_IsFirstLine ? (line.size() - 1) : line.size();
+        const int tabSpaces = (p_ExpandTabSize - (tabColumn % p_ExpandTabSize));
+        line.append(tabSpaces, L' ');
+      }
+      else
+      {
+        line.push_back(wch);
+      }
     }
   }
+  else
+  {
+    line = p_Line;
+  }
 
-  if (true)
+  const std::wstring flowedSuffix = p_OutputFormatFlowed ? L" " : L"";
+  const size_t quotePrefixMaxLen = p_LineLength / 2;
+
+  std::wstring quotePrefix;
+  std::wstring tmpLine;
+  const bool hasQuotePrefix = p_QuoteWrap && GetQuotePrefix(line, quotePrefix, tmpLine);
+  if (!hasQuotePrefix)
   {
-    std::wstring line;
-    std::wstring prevQuotePrefix;
-    std::wistringstream textss(p_Text);
-    const std::wstring flowedSuffix = p_OutputFormatFlowed ? L" " : L"";
-    const size_t quotePrefixMaxLen = p_LineLength / 2;
-    while (std::getline(textss, line))
+    // wrap by offset, to stay linear for long lines
+    size_t offset = 0;
+    while (true)
     {
-      std::wstring linePart = line;
-
-      std::wstring quotePrefix;
-      std::wstring tmpLine;
-      size_t quotePrefixLen = 0;
-      const bool hasQuotePrefix = p_QuoteWrap && GetQuotePrefix(linePart, quotePrefix, tmpLine);
-      if (hasQuotePrefix)
+      const size_t partLen = line.size() - offset;
+      if (partLen > wrapLineLength)
       {
-        quotePrefix.erase(std::remove(quotePrefix.begin(), quotePrefix.end(), L' '), quotePrefix.end());
-        quotePrefix += L' ';
-        quotePrefixLen = quotePrefix.size();
-        if (quotePrefixLen > quotePrefixMaxLen)
+        size_t spacePos = line.rfind(L' ', offset + wrapLineLength);
+        if ((spacePos != std::wstring::npos) && (spacePos > offset))
         {
-          quotePrefix = quotePrefix.substr(quotePrefixLen - quotePrefixMaxLen);
-          quotePrefixLen = quotePrefix.size();
+          p_Lines.push_back(line.substr(offset, spacePos - offset) + flowedSuffix);
+          offset = spacePos + 1;
+        }
+        else
+        {
+          p_Lines.push_back(line.substr(offset, overflowLineLength));
+          offset = std::min(offset + overflowLineLength, line.size());
         }
-
-        linePart = quotePrefix + tmpLine;
       }
+      else
+      {
+        p_Lines.push_back(line.substr(offset));
+        break;
+      }
+    }
+
+    return;
+  }
+
+  quotePrefix.erase(std::remove(quotePrefix.begin(), quotePrefix.end(), L' '), quotePrefix.end());
+  quotePrefix += L' ';
+  size_t quotePrefixLen = quotePrefix.size();
+  if (quotePrefixLen > quotePrefixMaxLen)
+  {
+    quotePrefix = quotePrefix.substr(quotePrefixLen - quotePrefixMaxLen);
+    quotePrefixLen = quotePrefix.size();
+  }
 
-      while (true)
+  std::wstring linePart = quotePrefix + tmpLine;
+  while (true)
+  {
+    std::wstring tmpPrefix;
+    if (!GetQuotePrefix(linePart, tmpPrefix, tmpLine))
+    {
+      linePart = quotePrefix + linePart;
+    }
+
+    if (linePart.size() > wrapLineLength)
+    {
+      size_t spacePos = linePart.rfind(L' ', wrapLineLength);
+      if ((spacePos != std::wstring::npos) && (spacePos > quotePrefixLen))
       {
-        std::wstring tmpPrefix;
-        if (hasQuotePrefix && !GetQuotePrefix(linePart, tmpPrefix, tmpLine))
+        p_Lines.push_back(linePart.substr(0, spacePos) + flowedSuffix);
+        if (linePart.size() > (spacePos + 1))
         {
-          linePart = quotePrefix + linePart;
+          linePart = linePart.substr(spacePos + 1);
         }
-
-        if (linePart.size() > wrapLineLength)
+        else
         {
-          size_t spacePos = linePart.rfind(L' ', wrapLineLength);
-          if ((spacePos != std::wstring::npos) && (spacePos > quotePrefixLen))
-          {
-            lines.push_back(linePart.substr(0, spacePos) + flowedSuffix);
-            if (linePart.size() > (spacePos + 1))
-            {
-              linePart = linePart.substr(spacePos + 1);
-            }
-            else
-            {
-              linePart.clear();
-            }
-          }
-          else
-          {
-            lines.push_back(linePart.substr(0, overflowLineLength));
-            if (linePart.size() > overflowLineLength)
-            {
-              linePart = linePart.substr(overflowLineLength);
-            }
-            else
-            {
-              linePart.clear();
-            }
-          }
+          linePart.clear();
+        }
+      }
+      else
+      {
+        p_Lines.push_back(linePart.substr(0, overflowLineLength));
+        if (linePart.size() > overflowLineLength)
+        {
+          linePart = linePart.substr(overflowLineLength);
         }
         else
         {
-          lines.push_back(linePart);
           linePart.clear();
-          break;
         }
       }
     }
+    else
+    {
+      p_Lines.push_back(linePart);
+      break;
+    }
   }
+}
 
-  for (auto& line : lines)
+void StrUtil::WordWrapPos(const std::vector<std::wstring>& p_Lines, unsigned p_LineLength, int p_Pos,
+                          int& p_WrapLine, int& p_WrapPos)
+{
+  p_WrapLine = 0;
+  p_WrapPos = 0;
+
+  const unsigned overflowLineLength = p_LineLength;
+  for (auto& line : p_Lines)
   {
-    if (p_Pos > 0)
+    if (p_Pos <= 0) break;
+
+    int lineLength = std::min((unsigned)line.size() + 1, overflowLineLength);
+    if (lineLength <= p_Pos)
     {
-      int lineLength = std::min((unsigned)line.size() + 1, overflowLineLength);
-      if (lineLength <= p_Pos)
-      {
-        p_Pos -= lineLength;
-        ++p_WrapLine;
-      }
-      else
-      {
-        p_WrapPos = p_Pos;
-        p_Pos = 0;
-      }
+      p_Pos -= lineLength;
+      ++p_WrapLine;
+    }
+    else
+    {
+      p_WrapPos = p_Pos;
+      p_Pos = 0;
     }
   }
-
-  return lines;
 }
 
 int StrUtil::WStringWidth(const std::wstring& p_WStr)
 {
-  int width = wcswidth(p_WStr.c_str(), p_WStr.size());
-  return (width != -1) ? width : p_WStr.size();
+  // same result as wcswidth(), with -1 for non-printable replaced by char count
+  const size_t len = p_WStr.size();
+  const wchar_t* data = p_WStr.data();
+  int width = 0;
+  for (size_t i = 0; i < len; ++i)
+  {
+    const wchar_t wch = data[i];
+    if ((wch >= 0x20) && (wch < 0x7F))
+    {
+      ++width;
+      continue;
+    }
+
+    if (wch == 0) break;
+
+    const int charWidth = WCharWidth(wch);
+    if (charWidth == -1) return len;
+
+    width += charWidth;
+  }
+
+  return width;
+}
+
+std::string StrUtil::DecimalToHex(long long p_Value)
+{
+  return (p_Value < 0) ? DecimalToHex(true, 0ULL - static_cast<unsigned long long>(p_Value))
+                       : DecimalToHex(false, static_cast<unsigned long long>(p_Value));
+}
+
+std::string StrUtil::DecimalToHex(unsigned long long p_Value)
+{
+  return DecimalToHex(false, p_Value);
+}
+
+std::string StrUtil::DecimalToHex(bool p_IsNegative, unsigned long long p_Value)
+{
+  // hex of ascii decimal, i.e. '-' is 2D and digit d is 3d
+  char buf[2 * 21];
+  char* end = buf + sizeof(buf);
+  char* pos = end;
+  do
+  {
+    *(--pos) = (char)('0' + (p_Value % 10));
+    *(--pos) = '3';
+    p_Value /= 10;
+  }
+  while (p_Value != 0);
+
+  if (p_IsNegative)
+  {
+    *(--pos) = 'D';
+    *(--pos) = '2';
+  }
+
+  return std::string(pos, end);
+}
+
+bool StrUtil::DecimalFromHex(const std::string& p_Str, bool& p_IsNegative, unsigned long long& p_Value)
+{
+  // only plain optionally signed decimals that cannot overflow, others are left to std::stringstream
+  size_t pos = 0;
+  p_IsNegative = false;
+  if ((p_Str.size() >= 2) && (p_Str[0] == '2'))
+  {
+    if ((p_Str[1] == 'D') || (p_Str[1] == 'd'))
+    {
+      p_IsNegative = true;
+      pos = 2;
+    }
+    else if ((p_Str[1] == 'B') || (p_Str[1] == 'b'))
+    {
+      pos = 2;
+    }
+  }
+
+  const size_t digitCount = (p_Str.size() - pos) / 2;
+  if (((p_Str.size() % 2) != 0) || (digitCount == 0) || (digitCount > 18)) return false;
+
+  p_Value = 0;
+  for (; pos < p_Str.size(); pos += 2)
+  {
+    const char digit = p_Str[pos + 1];
+    if ((p_Str[pos] != '3') || (digit < '0') || (digit > '9')) return false;
+
+    p_Value = (p_Value * 10) + (digit - '0');
+  }
+
+  return true;
 }
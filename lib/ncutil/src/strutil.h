@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <limits>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #define EMOJI_PAD 1
@@ -16,11 +18,15 @@
 class StrUtil
 {
 public:
-  static void DeleteToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars);
-  static void DeleteToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars);
+  static void DeleteToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars);
+  static void DeleteToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars);
   static std::string Emojize(const std::string& p_Str, bool p_Pad = false);
+  static std::string EscapeJson(const std::string& p_Str);
+  static void AppendEscapeJson(std::string& p_Dest, const char* p_Data, size_t p_Size);
   static std::string EscapeRawUrls(const std::string& p_Str);
   static std::vector<std::string> ExtractUrlsFromStr(const std::string& p_Str);
+  static size_t FindIgnoreCase(const std::string& p_Str, const std::string& p_LowerNeedle, size_t p_Pos = 0);
+  static size_t FindIgnoreCase(const std::wstring& p_Str, const std::wstring& p_LowerNeedle, size_t p_Pos = 0);
   static std::string GetPass();
   static std::string GetPhoneNumber();
   static std::string GetProtocolName(const std::string& p_ProfileId);
@@ -29,12 +35,15 @@ public:
   static bool IsValidTextKey(int p_Key);
   static std::string Join(const std::vector<std::string>& p_Lines, const std::string& p_Delim);
   static std::wstring Join(const std::vector<std::wstring>& p_Lines, const std::wstring& p_Delim);
-  static void JumpToNextMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars);
-  static void JumpToPrevMatch(std::wstring& p_Str, int& p_Pos, int p_Offs, std::wstring p_Chars);
+  static void JumpToNextMatch(const std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars);
+  static void JumpToPrevMatch(const std::wstring& p_Str, int& p_Pos, int p_Offs, const std::wstring& p_Chars);
   static std::string NumAddPrefix(const std::string& p_Str, const char p_Ch);
   static bool NumHasPrefix(const std::string& p_Str, const char p_Ch);
   static void ReplaceString(std::string& p_Str, const std::string& p_Search, const std::string& p_Replace);
   static std::vector<std::string> Split(const std::string& p_Str, char p_Sep);
+  static std::string SplitFirst(const std::string& p_Str, char p_Sep);
+  static bool SplitNext(const std::string& p_Str, char p_Sep, size_t& p_Pos, size_t& p_Begin, size_t& p_Len);
+  static void StrAppendHex(std::string& p_Dest, const std::string& p_String);
   static std::string StrFromHex(const std::string& p_String);
   static std::string StrFromOct(const std::string& p_String);
   static std::string StrToHex(const std::string& p_String);
@@ -42,6 +51,8 @@ public:
   static long ToInteger(const std::string& p_Str);
   static std::string ToLower(const std::string& p_Str);
   static std::wstring ToLower(const std::wstring& p_WStr);
+  static void ToLowerInPlace(std::string& p_Str);
+  static void ToLowerInPlace(std::wstring& p_WStr);
   static std::string ToString(const std::wstring& p_WStr);
   static std::wstring ToWString(const std::string& p_Str);
   static std::wstring TrimPadWString(const std::wstring& p_Str, int p_Len);
@@ -50,11 +61,37 @@ public:
   static std::vector<std::wstring> WordWrap(std::wstring p_Text, unsigned p_LineLength, bool p_ProcessFormatFlowed,
                                             bool p_OutputFormatFlowed, bool p_QuoteWrap, int p_ExpandTabSize, int p_Pos,
                                             int& p_WrapLine, int& p_WrapPos);
+  static void WordWrapLine(const std::wstring& p_Line, unsigned p_LineLength, bool p_OutputFormatFlowed,
+                           bool p_QuoteWrap, int p_ExpandTabSize, bool p_IsFirstLine,
+                           std::vector<std::wstring>& p_Lines);
+  static void WordWrapPos(const std::vector<std::wstring>& p_Lines, unsigned p_LineLength, int p_Pos,
+                          int& p_WrapLine, int& p_WrapPos);
   static int WStringWidth(const std::wstring& p_WStr);
 
 public:
   template<typename T>
   static inline std::string NumToHex(const T& p_Value)
+  {
+    return NumToHex(p_Value, std::integral_constant<bool, std::is_integral<T>::value && (sizeof(T) > 1)>());
+  }
+
+  template<typename T>
+  static inline T NumFromHex(const std::string& p_Str)
+  {
+    return NumFromHex<T>(p_Str, std::integral_constant<bool, std::is_integral<T>::value && (sizeof(T) > 1)>());
+  }
+
+private:
+  // integer ids are encoded as hex of their decimal string, fast paths below skip the string streams
+  template<typename T>
+  static inline std::string NumToHex(const T& p_Value, std::true_type)
+  {
+    typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type IntType;
+    return DecimalToHex(static_cast<IntType>(p_Value));
+  }
+
+  template<typename T>
+  static inline std::string NumToHex(const T& p_Value, std::false_type)
   {
     std::stringstream ss;
     ss << p_Value;
@@ -62,11 +99,37 @@ public:
   }
 
   template<typename T>
-  static inline T NumFromHex(const std::string& p_Str)
+  static inline T NumFromHex(const std::string& p_Str, std::true_type)
+  {
+    bool isNegative = false;
+    unsigned long long value = 0;
+    if (DecimalFromHex(p_Str, isNegative, value))
+    {
+      if (!isNegative && (value <= (unsigned long long)std::numeric_limits<T>::max()))
+      {
+        return (T)value;
+      }
+      else if (isNegative && std::is_signed<T>::value &&
+               (value <= (unsigned long long)std::numeric_limits<T>::max()))
+      {
+        return (T)(-(long long)value);
+      }
+    }
+
+    return NumFromHex<T>(p_Str, std::false_type());
+  }
+
+  template<typename T>
+  static inline T NumFromHex(const std::string& p_Str, std::false_type)
   {
     std::stringstream ss(StrFromHex(p_Str));
     T value = 0;
     ss >> value;
     return value;
   }
+
+  static std::string DecimalToHex(long long p_Value);
+  static std::string DecimalToHex(unsigned long long p_Value);
+  static std::string DecimalToHex(bool p_IsNegative, unsigned long long p_Value);
+  static bool DecimalFromHex(const std::string& p_Str, bool& p_IsNegative, unsigned long long& p_Value);
 };
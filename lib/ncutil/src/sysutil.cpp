@@ -6,3 +6,45 @@
 // nchat is distributed under the MIT license, see LICENSE for details.
 
 #include "sysutil.h"
+
+#include <fstream>
+#include <string>
+
+#ifdef __APPLE__
+#include <libproc.h>
+#include <unistd.h>
+#endif
+
+bool SysUtil::GetProcessStats(int& p_ThreadCount, int64_t& p_RssKb)
+{
+#if defined(__APPLE__)
+  struct proc_taskinfo taskinfo;
+  if (proc_pidinfo(getpid(), PROC_PIDTASKINFO, 0, &taskinfo, sizeof(taskinfo)) == sizeof(taskinfo))
+  {
+    p_ThreadCount = taskinfo.pti_threadnum;
+    p_RssKb = (int64_t)(taskinfo.pti_resident_size / 1024);
+    return true;
+  }
+#elif defined(__linux__)
+  std::ifstream file("/proc/self/status");
+  std::string line;
+  bool hasThreads = false;
+  bool hasRss = false;
+  while (std::getline(file, line))
+  {
+    if (line.compare(0, 8, "Threads:") == 0)
+    {
+      p_ThreadCount = std::stoi(line.substr(8));
+      hasThreads = true;
+    }
+    else if (line.compare(0, 6, "VmRSS:") == 0)
+    {
+      p_RssKb = std::stoll(line.substr(6));
+      hasRss = true;
+    }
+  }
+
+  return hasThreads && hasRss;
+#endif
+  return false;
+}
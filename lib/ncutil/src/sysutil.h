@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #define UNUSED(x) SysUtil::Unused(x)
 
 class SysUtil
@@ -17,4 +19,6 @@ public:
   {
     (void)p_Arg;
   }
+
+  static bool GetProcessStats(int& p_ThreadCount, int64_t& p_RssKb);
 };
@@ -0,0 +1,256 @@
+// textcompressor.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "textcompressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "log.h"
+
+// blob layout is format version, dictionary key (uint32 le), text size (uint32 le) and raw deflate data
+static const unsigned char s_FormatVersion = 1;
+static const size_t s_HeaderSize = 9;
+static const int s_CompressLevel = 6;
+static const int s_WindowBits = -15; // raw deflate, as the header holds what a zlib wrapper would
+
+// dictionary is bounded by the deflate window, training needs enough text to find common words
+static const size_t s_MaxDictSize = 32 * 1024;
+static const size_t s_MinTrainSize = 64 * 1024;
+static const size_t s_MaxWordSize = 32;
+
+namespace
+{
+  void PutUInt32(char* p_Buf, uint32_t p_Value)
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      p_Buf[i] = static_cast<char>((p_Value >> (8 * i)) & 0xff);
+    }
+  }
+
+  uint32_t GetUInt32(const char* p_Buf)
+  {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+      value |= static_cast<uint32_t>(static_cast<unsigned char>(p_Buf[i])) << (8 * i);
+    }
+
+    return value;
+  }
+}
+
+TextCompressor::TextCompressor()
+{
+  memset(&m_Deflate, 0, sizeof(m_Deflate));
+}
+
+TextCompressor::~TextCompressor()
+{
+  if (m_DeflateInit)
+  {
+    deflateEnd(&m_Deflate);
+  }
+}
+
+void TextCompressor::AddDictionary(int64_t p_Key, const std::string& p_Dict)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Dicts[p_Key] = p_Dict;
+  m_ActiveKey = std::max(m_ActiveKey, p_Key);
+}
+
+bool TextCompressor::HasDictionary()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  return !m_Dicts.empty();
+}
+
+bool TextCompressor::Compress(const std::string& p_Text, std::vector<char>& p_Blob)
+{
+  // returns false and empty blob when compression does not save space, then text is stored as is
+  p_Blob.clear();
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (!m_DeflateInit)
+  {
+    if (deflateInit2(&m_Deflate, s_CompressLevel, Z_DEFLATED, s_WindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      LOG_WARNING("text compress init failed");
+      return false;
+    }
+
+    m_DeflateInit = true;
+  }
+  else
+  {
+    deflateReset(&m_Deflate);
+  }
+
+  const int64_t dictKey = m_ActiveKey;
+  auto dictIt = m_Dicts.find(dictKey);
+  if (dictIt != m_Dicts.end())
+  {
+    deflateSetDictionary(&m_Deflate, reinterpret_cast<const Bytef*>(dictIt->second.data()),
+                         dictIt->second.size());
+  }
+
+  p_Blob.resize(s_HeaderSize + deflateBound(&m_Deflate, p_Text.size()));
+  m_Deflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p_Text.data()));
+  m_Deflate.avail_in = p_Text.size();
+  m_Deflate.next_out = reinterpret_cast<Bytef*>(&p_Blob[s_HeaderSize]);
+  m_Deflate.avail_out = p_Blob.size() - s_HeaderSize;
+  if (deflate(&m_Deflate, Z_FINISH) != Z_STREAM_END)
+  {
+    p_Blob.clear();
+    return false;
+  }
+
+  const size_t blobSize = s_HeaderSize + m_Deflate.total_out;
+  if (blobSize >= p_Text.size())
+  {
+    p_Blob.clear();
+    return false;
+  }
+
+  p_Blob.resize(blobSize);
+  p_Blob[0] = static_cast<char>(s_FormatVersion);
+  PutUInt32(&p_Blob[1], static_cast<uint32_t>(dictKey));
+  PutUInt32(&p_Blob[5], static_cast<uint32_t>(p_Text.size()));
+  return true;
+}
+
+bool TextCompressor::Decompress(const char* p_Data, size_t p_Size, std::string& p_Text)
+{
+  if ((p_Size < s_HeaderSize) || (static_cast<unsigned char>(p_Data[0]) != s_FormatVersion)) return false;
+
+  const int64_t dictKey = GetUInt32(&p_Data[1]);
+  const std::string* dict = nullptr;
+  if (dictKey != 0)
+  {
+    // dictionaries are not removed once added, so may be used outside the lock
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    auto dictIt = m_Dicts.find(dictKey);
+    if (dictIt == m_Dicts.end()) return false;
+
+    dict = &dictIt->second;
+  }
+
+  z_stream inflateStream;
+  memset(&inflateStream, 0, sizeof(inflateStream));
+  if (inflateInit2(&inflateStream, s_WindowBits) != Z_OK) return false;
+
+  if (dict != nullptr)
+  {
+    inflateSetDictionary(&inflateStream, reinterpret_cast<const Bytef*>(dict->data()), dict->size());
+  }
+
+  p_Text.resize(GetUInt32(&p_Data[5]));
+  inflateStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p_Data + s_HeaderSize));
+  inflateStream.avail_in = p_Size - s_HeaderSize;
+  inflateStream.next_out = reinterpret_cast<Bytef*>(&p_Text[0]);
+  inflateStream.avail_out = p_Text.size();
+  const int rv = inflate(&inflateStream, Z_FINISH);
+  const bool ok = (rv == Z_STREAM_END) && (inflateStream.total_out == p_Text.size());
+  inflateEnd(&inflateStream);
+  return ok;
+}
+
+void TextCompressor::Register(sqlite::database& p_Db)
+{
+  // deterministic, so it may be used in views and triggers
+  int rv = sqlite3_create_function_v2(p_Db.connection().get(), "nc_text", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                      this, &TextCompressor::TextFunction, nullptr, nullptr, nullptr);
+  if (rv != SQLITE_OK)
+  {
+    LOG_WARNING("text function register failed %d", rv);
+  }
+}
+
+std::string TextCompressor::TrainDictionary(const std::vector<std::string>& p_Samples)
+{
+  // words (with their trailing separator) ranked by bytes they would save, most valuable placed
+  // last, as deflate encodes nearer matches more compactly
+  size_t sampleSize = 0;
+  std::unordered_map<std::string, size_t> wordCounts;
+  for (const auto& sample : p_Samples)
+  {
+    sampleSize += sample.size();
+    size_t begin = 0;
+    while (begin < sample.size())
+    {
+      size_t end = sample.find_first_of(" \n", begin);
+      end = (end == std::string::npos) ? sample.size() : (end + 1);
+      if (((end - begin) >= 3) && ((end - begin) <= s_MaxWordSize))
+      {
+        ++wordCounts[sample.substr(begin, end - begin)];
+      }
+
+      begin = end;
+    }
+  }
+
+  if (sampleSize < s_MinTrainSize) return std::string();
+
+  std::vector<std::pair<size_t, const std::string*>> scoredWords;
+  for (const auto& wordCount : wordCounts)
+  {
+    if (wordCount.second < 2) continue;
+
+    scoredWords.push_back(std::make_pair(wordCount.second * wordCount.first.size(), &wordCount.first));
+  }
+
+  // *INDENT-OFF*
+  std::sort(scoredWords.begin(), scoredWords.end(),
+            [](const std::pair<size_t, const std::string*>& p_Lhs, const std::pair<size_t, const std::string*>& p_Rhs)
+            {
+              return p_Lhs.first > p_Rhs.first;
+            });
+  // *INDENT-ON*
+
+  std::vector<const std::string*> dictWords;
+  size_t dictSize = 0;
+  for (const auto& scoredWord : scoredWords)
+  {
+    if ((dictSize + scoredWord.second->size()) > s_MaxDictSize) break;
+
+    dictWords.push_back(scoredWord.second);
+    dictSize += scoredWord.second->size();
+  }
+
+  std::string dict;
+  dict.reserve(dictSize);
+  for (auto it = dictWords.rbegin(); it != dictWords.rend(); ++it)
+  {
+    dict += **it;
+  }
+
+  return dict;
+}
+
+void TextCompressor::TextFunction(sqlite3_context* p_Context, int p_Argc, sqlite3_value** p_Argv)
+{
+  if ((p_Argc != 1) || (sqlite3_value_type(p_Argv[0]) != SQLITE_BLOB))
+  {
+    sqlite3_result_value(p_Context, p_Argv[0]);
+    return;
+  }
+
+  TextCompressor* textCompressor = static_cast<TextCompressor*>(sqlite3_user_data(p_Context));
+  const char* data = static_cast<const char*>(sqlite3_value_blob(p_Argv[0]));
+  const size_t size = static_cast<size_t>(sqlite3_value_bytes(p_Argv[0]));
+  std::string text;
+  if (!textCompressor->Decompress(data, size, text))
+  {
+    LOG_WARNING("text decompress failed");
+    sqlite3_result_null(p_Context);
+    return;
+  }
+
+  sqlite3_result_text(p_Context, text.data(), text.size(), SQLITE_TRANSIENT);
+}
@@ -0,0 +1,46 @@
+// textcompressor.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <zlib.h>
+
+// compresses message texts with a per-profile preset deflate dictionary, trained from the
+// profile's own messages. compressed texts are stored as blobs, which the sql function
+// nc_text(x) registered on each connection expands, other values are returned unchanged.
+class TextCompressor
+{
+public:
+  TextCompressor();
+  ~TextCompressor();
+
+  void AddDictionary(int64_t p_Key, const std::string& p_Dict);
+  bool HasDictionary();
+  bool Compress(const std::string& p_Text, std::vector<char>& p_Blob);
+  bool Decompress(const char* p_Data, size_t p_Size, std::string& p_Text);
+  void Register(sqlite::database& p_Db);
+
+  static std::string TrainDictionary(const std::vector<std::string>& p_Samples);
+
+private:
+  static void TextFunction(sqlite3_context* p_Context, int p_Argc, sqlite3_value** p_Argv);
+
+private:
+  std::mutex m_Mutex;
+  std::map<int64_t, std::string> m_Dicts; // entries are never removed, keys of stored blobs
+  int64_t m_ActiveKey = 0; // newest dictionary, used for compression
+  z_stream m_Deflate;
+  bool m_DeflateInit = false;
+};
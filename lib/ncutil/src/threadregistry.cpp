@@ -0,0 +1,180 @@
+// threadregistry.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "threadregistry.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include "timeutil.h"
+
+std::mutex ThreadRegistry::m_Mutex;
+std::map<int64_t, ThreadRegistry::Entry> ThreadRegistry::m_Entries;
+
+namespace
+{
+  int64_t GetThreadId()
+  {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(pthread_mach_thread_np(pthread_self()));
+#elif defined(__linux__)
+    return static_cast<int64_t>(syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+  }
+
+  // unregisters the thread upon its exit
+  class ThreadGuard
+  {
+  public:
+    ~ThreadGuard()
+    {
+      if (registered)
+      {
+        ThreadRegistry::Unregister();
+      }
+    }
+
+    bool registered = false;
+  };
+
+  thread_local ThreadGuard s_ThreadGuard;
+}
+
+void ThreadRegistry::Register(const std::string& p_Name)
+{
+#if defined(__APPLE__)
+  pthread_setname_np(p_Name.c_str());
+#elif defined(__linux__)
+  // main thread name is the process name, kept for e.g. pgrep
+  if (GetThreadId() != static_cast<int64_t>(getpid()))
+  {
+    pthread_setname_np(pthread_self(), p_Name.substr(0, 15).c_str());
+  }
+#endif
+
+  Entry entry;
+  entry.name = p_Name;
+  entry.tid = GetThreadId();
+  entry.startTime = TimeUtil::GetCurrentTimeMSec();
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Entries[entry.tid] = entry;
+  }
+
+  s_ThreadGuard.registered = true;
+}
+
+void ThreadRegistry::Unregister()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Entries.erase(GetThreadId());
+  s_ThreadGuard.registered = false;
+}
+
+std::string ThreadRegistry::GetReport()
+{
+  std::map<int64_t, Entry> entries;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    entries = m_Entries;
+  }
+
+  // listed as name, cpu time and wakeups, followed by cpu usage over thread lifetime
+  std::stringstream ss;
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  for (const auto& entry : entries)
+  {
+    int64_t cpuUs = 0;
+    int64_t wakeups = 0;
+    if (!GetThreadStats(entry.second, cpuUs, wakeups)) continue;
+
+    const int64_t lifeMs = std::max<int64_t>(nowTime - entry.second.startTime, 1);
+    ss << "  thread " << entry.second.name << " tid " << entry.first << " cpu " << (cpuUs / 1000) << " ms";
+    if (wakeups >= 0)
+    {
+      ss << " wakeups " << wakeups;
+    }
+
+    ss << " usage " << ((cpuUs / 10) / lifeMs) << "%\n";
+  }
+
+  return ss.str();
+}
+
+bool ThreadRegistry::GetThreadStats(const Entry& p_Entry, int64_t& p_CpuUs, int64_t& p_Wakeups)
+{
+#if defined(__APPLE__)
+  thread_basic_info_data_t info;
+  mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+  if (thread_info(static_cast<thread_act_t>(p_Entry.tid), THREAD_BASIC_INFO, (thread_info_t)&info,
+                  &count) != KERN_SUCCESS) return false;
+
+  p_CpuUs = (static_cast<int64_t>(info.user_time.seconds + info.system_time.seconds) * 1000000) +
+    info.user_time.microseconds + info.system_time.microseconds;
+  p_Wakeups = -1; // not available
+  return true;
+#elif defined(__linux__)
+  const std::string taskDir = "/proc/self/task/" + std::to_string(p_Entry.tid);
+  std::ifstream statFile(taskDir + "/stat");
+  std::string stat;
+  if (!std::getline(statFile, stat)) return false;
+
+  // utime and stime are fields 14 and 15, counted after the parenthesized thread name
+  const size_t nameEnd = stat.rfind(')');
+  if (nameEnd == std::string::npos) return false;
+
+  std::istringstream fields(stat.substr(nameEnd + 2));
+  std::string field;
+  int64_t utime = 0;
+  int64_t stime = 0;
+  for (int index = 3; (index <= 15) && (fields >> field); ++index)
+  {
+    if (index == 14)
+    {
+      utime = std::stoll(field);
+    }
+    else if (index == 15)
+    {
+      stime = std::stoll(field);
+    }
+  }
+
+  static const int64_t ticksPerSec = std::max<int64_t>(sysconf(_SC_CLK_TCK), 1);
+  p_CpuUs = ((utime + stime) * 1000000) / ticksPerSec;
+
+  std::ifstream statusFile(taskDir + "/status");
+  std::string line;
+  p_Wakeups = 0;
+  while (std::getline(statusFile, line))
+  {
+    if (line.compare(0, 24, "voluntary_ctxt_switches:") == 0)
+    {
+      p_Wakeups = std::stoll(line.substr(24));
+      break;
+    }
+  }
+
+  return true;
+#else
+  (void)p_Entry;
+  (void)p_CpuUs;
+  (void)p_Wakeups;
+  return false;
+#endif
+}
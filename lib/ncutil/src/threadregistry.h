@@ -0,0 +1,39 @@
+// threadregistry.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// names nchat-owned threads (shown by e.g. top -H) and reports their cpu time and wakeups
+// (voluntary context switches) in the stats report. threads unregister automatically at exit.
+class ThreadRegistry
+{
+public:
+  // must be called on the thread itself, os thread names are truncated to 15 chars, and not set
+  // for the main thread on linux, where it is the process name
+  static void Register(const std::string& p_Name);
+  static void Unregister();
+  static std::string GetReport();
+
+private:
+  struct Entry
+  {
+    std::string name;
+    int64_t tid = 0;
+    int64_t startTime = 0;
+  };
+
+  static bool GetThreadStats(const Entry& p_Entry, int64_t& p_CpuUs, int64_t& p_Wakeups);
+
+private:
+  static std::mutex m_Mutex;
+  static std::map<int64_t, Entry> m_Entries;
+};
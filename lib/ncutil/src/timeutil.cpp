@@ -7,7 +7,10 @@
 
 #include "timeutil.h"
 
+#include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <limits>
 
 #include <unistd.h>
 
@@ -22,6 +25,91 @@ int64_t TimeUtil::GetCurrentTimeMSec()
   return static_cast<int64_t>((now.tv_sec * 1000) + (now.tv_usec / 1000));
 }
 
+int64_t TimeUtil::GetSteadyTimeMSec()
+{
+  // steady clock is CLOCK_MONOTONIC on linux and CLOCK_UPTIME_RAW on macos, both exclude suspend
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const time_t s_UseWeekdayMaxAge = (6 * 24 * 3600);
+static const size_t s_DayBucketsMax = 1024;
+
+enum DateFormat
+{
+  DateFormatIso,
+  DateFormatToday,
+  DateFormatWeekday,
+  DateFormatYear,
+  DateFormatFull,
+};
+
+static DateFormat GetDateFormat(time_t p_TimeSent, const struct tm& p_TmSent, time_t p_TimeNow,
+                                const struct tm& p_TmNow, bool p_IsExport)
+{
+  static bool isTimestampIso = AppConfig::GetBool("timestamp_iso");
+  if (isTimestampIso) return DateFormatIso;
+
+  if (p_IsExport) return DateFormatFull;
+
+  if ((p_TmSent.tm_year == p_TmNow.tm_year) && (p_TmSent.tm_mon == p_TmNow.tm_mon) &&
+      (p_TmSent.tm_mday == p_TmNow.tm_mday)) return DateFormatToday;
+
+  if ((p_TimeNow - p_TimeSent) <= s_UseWeekdayMaxAge) return DateFormatWeekday;
+
+  if (p_TmSent.tm_year == p_TmNow.tm_year) return DateFormatYear;
+
+  return DateFormatFull;
+}
+
+// date part of a time string including trailing space, empty for today
+static std::string GetDatePrefix(DateFormat p_DateFormat, const struct tm& p_TmSent)
+{
+  char tmpstr[32] = { 0 };
+  switch (p_DateFormat)
+  {
+    case DateFormatIso:
+      strftime(tmpstr, sizeof(tmpstr), "%Y-%m-%d ", &p_TmSent);
+      break;
+
+    case DateFormatWeekday:
+      strftime(tmpstr, sizeof(tmpstr), "%a ", &p_TmSent);
+      break;
+
+    case DateFormatYear:
+      {
+        int dlen = snprintf(tmpstr, sizeof(tmpstr), "%d ", p_TmSent.tm_mday);
+        strftime(tmpstr + dlen, sizeof(tmpstr) - dlen, "%b ", &p_TmSent);
+      }
+      break;
+
+    case DateFormatFull:
+      {
+        int dlen = snprintf(tmpstr, sizeof(tmpstr), "%d ", p_TmSent.tm_mday);
+        strftime(tmpstr + dlen, sizeof(tmpstr) - dlen, "%b %Y ", &p_TmSent);
+      }
+      break;
+
+    case DateFormatToday:
+    default:
+      break;
+  }
+
+  return std::string(tmpstr);
+}
+
+// start of the local day p_DayOffset days after the one of p_Tm
+static time_t GetDayStart(const struct tm& p_Tm, int p_DayOffset)
+{
+  struct tm tmDay = p_Tm;
+  tmDay.tm_mday += p_DayOffset;
+  tmDay.tm_hour = 0;
+  tmDay.tm_min = 0;
+  tmDay.tm_sec = 0;
+  tmDay.tm_isdst = -1;
+  return mktime(&tmDay);
+}
+
 std::string TimeUtil::GetTimeString(int64_t p_TimeSent, bool p_IsExport)
 {
   time_t timeSent = (time_t)(p_TimeSent / 1000);
@@ -30,42 +118,11 @@ std::string TimeUtil::GetTimeString(int64_t p_TimeSent, bool p_IsExport)
   time_t timeNow = time(NULL);
   struct tm tmNow;
   localtime_r(&timeNow, &tmNow);
-  char tmpstr[32] = { 0 };
-  static int64_t useWeekdayMaxAge = (6 * 24 * 3600);
-  static bool isTimestampIso = AppConfig::GetBool("timestamp_iso");
-
-  if (isTimestampIso)
-  {
-    strftime(tmpstr, sizeof(tmpstr), "%Y-%m-%d %H:%M", &tmSent);
-  }
-  else if (p_IsExport)
-  {
-    int dlen = snprintf(tmpstr, sizeof(tmpstr), "%d ", tmSent.tm_mday);
-    strftime(tmpstr + dlen, sizeof(tmpstr) - dlen, "%b %Y %H:%M", &tmSent);
-  }
-  else
-  {
-    if ((tmSent.tm_year == tmNow.tm_year) && (tmSent.tm_mon == tmNow.tm_mon) && (tmSent.tm_mday == tmNow.tm_mday))
-    {
-      strftime(tmpstr, sizeof(tmpstr), "%H:%M", &tmSent);
-    }
-    else if ((timeNow - timeSent) <= useWeekdayMaxAge)
-    {
-      strftime(tmpstr, sizeof(tmpstr), "%a %H:%M", &tmSent);
-    }
-    else if (tmSent.tm_year == tmNow.tm_year)
-    {
-      int dlen = snprintf(tmpstr, sizeof(tmpstr), "%d ", tmSent.tm_mday);
-      strftime(tmpstr + dlen, sizeof(tmpstr) - dlen, "%b %H:%M", &tmSent);
-    }
-    else
-    {
-      int dlen = snprintf(tmpstr, sizeof(tmpstr), "%d ", tmSent.tm_mday);
-      strftime(tmpstr + dlen, sizeof(tmpstr) - dlen, "%b %Y %H:%M", &tmSent);
-    }
-  }
+  char tmpstr[8] = { 0 };
+  strftime(tmpstr, sizeof(tmpstr), "%H:%M", &tmSent);
 
-  return std::string(tmpstr);
+  const DateFormat dateFormat = GetDateFormat(timeSent, tmSent, timeNow, tmNow, p_IsExport);
+  return GetDatePrefix(dateFormat, tmSent) + tmpstr;
 }
 
 std::string TimeUtil::GetYearString(int64_t p_TimeSent)
@@ -87,3 +144,97 @@ void TimeUtil::Sleep(double p_Sec)
 {
   usleep(static_cast<useconds_t>(p_Sec * 1000000));
 }
+
+TimeFormatter::TimeFormatter(bool p_IsExport)
+  : m_IsExport(p_IsExport)
+{
+}
+
+std::string TimeFormatter::GetTimeString(int64_t p_TimeSent, int64_t* p_ValidUntil /*= nullptr*/)
+{
+  const time_t timeSent = (time_t)(p_TimeSent / 1000);
+  const time_t timeNow = time(NULL);
+  if ((timeNow < m_TodayStart) || (timeNow >= m_TodayEnd))
+  {
+    UpdateToday(timeNow);
+  }
+
+  char tmpstr[16] = { 0 };
+  auto it = m_DayBuckets.upper_bound(timeSent);
+  if (it != m_DayBuckets.begin())
+  {
+    --it;
+    const DayBucket& bucket = it->second;
+    if ((timeSent < bucket.dayEnd) && (timeNow < bucket.validUntil))
+    {
+      const int daySec = static_cast<int>(timeSent - it->first);
+      snprintf(tmpstr, sizeof(tmpstr), "%02d:%02d", daySec / 3600, (daySec % 3600) / 60);
+      if (p_ValidUntil != nullptr)
+      {
+        *p_ValidUntil = bucket.validUntil;
+      }
+
+      return bucket.prefix + tmpstr;
+    }
+  }
+
+  struct tm tmSent;
+  localtime_r(&timeSent, &tmSent);
+  strftime(tmpstr, sizeof(tmpstr), "%H:%M", &tmSent);
+  const DateFormat dateFormat = GetDateFormat(timeSent, tmSent, timeNow, m_TmNow, m_IsExport);
+  const std::string prefix = GetDatePrefix(dateFormat, tmSent);
+
+  // relative formats change at midnight, weekday names also once older than the weekday max age
+  const bool isAbsolute = (dateFormat == DateFormatIso) || m_IsExport;
+  time_t validUntil = isAbsolute ? std::numeric_limits<time_t>::max() : m_TodayEnd;
+  if (dateFormat == DateFormatWeekday)
+  {
+    validUntil = std::min(validUntil, timeSent + s_UseWeekdayMaxAge + 1);
+  }
+
+  if (p_ValidUntil != nullptr)
+  {
+    *p_ValidUntil = validUntil;
+  }
+
+  // cache the prefix if it applies to the whole day, and the day has no utc offset change
+  const time_t dayStart = GetDayStart(tmSent, 0);
+  const time_t dayEnd = GetDayStart(tmSent, 1);
+  time_t bucketValidUntil = validUntil;
+  bool isCacheable = ((dayEnd - dayStart) == (24 * 3600));
+  if (isCacheable && !isAbsolute)
+  {
+    if (dateFormat == DateFormatWeekday)
+    {
+      bucketValidUntil = std::min(m_TodayEnd, dayStart + s_UseWeekdayMaxAge + 1);
+      isCacheable = (timeNow < bucketValidUntil);
+    }
+    else if (dateFormat != DateFormatToday)
+    {
+      isCacheable = ((timeNow - (dayEnd - 1)) > s_UseWeekdayMaxAge);
+    }
+  }
+
+  if (isCacheable)
+  {
+    if (m_DayBuckets.size() >= s_DayBucketsMax)
+    {
+      m_DayBuckets.clear();
+    }
+
+    DayBucket& bucket = m_DayBuckets[dayStart];
+    bucket.dayEnd = dayEnd;
+    bucket.validUntil = bucketValidUntil;
+    bucket.prefix = prefix;
+  }
+
+  return prefix + tmpstr;
+}
+
+void TimeFormatter::UpdateToday(time_t p_TimeNow)
+{
+  localtime_r(&p_TimeNow, &m_TmNow);
+  m_TodayStart = GetDayStart(m_TmNow, 0);
+  m_TodayEnd = GetDayStart(m_TmNow, 1);
+  m_DayBuckets.clear();
+}
@@ -8,13 +8,44 @@
 #pragma once
 
 #include <cstdint>
+#include <ctime>
+#include <map>
 #include <string>
 
 class TimeUtil
 {
 public:
   static int64_t GetCurrentTimeMSec();
+  static int64_t GetSteadyTimeMSec(); // not advancing while system is suspended
   static std::string GetTimeString(int64_t p_TimeSent, bool p_IsExport);
   static std::string GetYearString(int64_t p_TimeSent);
   static void Sleep(double p_Sec);
 };
+
+// timestamp formatter caching the date prefix per local day, so messages from the same day only
+// compute HH:MM. not thread-safe, use one instance per thread.
+class TimeFormatter
+{
+public:
+  explicit TimeFormatter(bool p_IsExport);
+
+  // p_ValidUntil is set to the time (sec) until which the returned string stays correct
+  std::string GetTimeString(int64_t p_TimeSent, int64_t* p_ValidUntil = nullptr);
+
+private:
+  struct DayBucket
+  {
+    time_t dayEnd = 0;
+    time_t validUntil = 0;
+    std::string prefix;
+  };
+
+  void UpdateToday(time_t p_TimeNow);
+
+private:
+  bool m_IsExport = false;
+  time_t m_TodayStart = 0;
+  time_t m_TodayEnd = 0;
+  struct tm m_TmNow = { };
+  std::map<time_t, DayBucket> m_DayBuckets; // keyed by local day start
+};
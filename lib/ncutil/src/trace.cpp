@@ -0,0 +1,168 @@
+// trace.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "trace.h"
+
+#include <chrono>
+#include <fstream>
+
+#include <unistd.h>
+
+#include "appconfig.h"
+#include "fileutil.h"
+#include "log.h"
+#include "timeutil.h"
+
+std::atomic<bool> Trace::m_Enabled(false);
+std::mutex Trace::m_BuffersMutex;
+std::vector<std::shared_ptr<Trace::ThreadBuffer>> Trace::m_Buffers;
+
+// @note: events per thread, oldest are overwritten when full
+static const size_t s_ThreadBufferEvents = 8192;
+
+void Trace::Init()
+{
+  m_Enabled = AppConfig::GetBool("trace_enabled");
+  if (!m_Enabled) return;
+
+  LOG_INFO("tracing enabled, dump with SIGUSR1 (pid %d)", (int)getpid());
+}
+
+void Trace::Cleanup()
+{
+  m_Enabled = false;
+}
+
+bool Trace::IsEnabled()
+{
+  return m_Enabled.load(std::memory_order_relaxed);
+}
+
+int64_t Trace::GetTimeUSec()
+{
+  const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+void Trace::AddSpan(const char* p_Name, int64_t p_BeginUSec, int64_t p_EndUSec,
+                    const char* p_ArgName, int64_t p_ArgValue)
+{
+  if (!IsEnabled()) return;
+
+  Event event;
+  event.name = p_Name;
+  event.argName = p_ArgName;
+  event.beginUSec = p_BeginUSec;
+  event.endUSec = p_EndUSec;
+  event.argValue = p_ArgValue;
+  AddEvent(event);
+}
+
+void Trace::AddCounter(const char* p_Name, int64_t p_Value)
+{
+  if (!IsEnabled()) return;
+
+  Event event;
+  event.name = p_Name;
+  event.beginUSec = GetTimeUSec();
+  event.argValue = p_Value;
+  AddEvent(event);
+}
+
+std::string Trace::Dump()
+{
+  if (!IsEnabled())
+  {
+    LOG_WARNING("tracing not enabled");
+    return "";
+  }
+
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(m_BuffersMutex);
+    buffers = m_Buffers;
+  }
+
+  const std::string path = FileUtil::GetApplicationDir() + "/trace-" +
+    std::to_string(TimeUtil::GetCurrentTimeMSec() / 1000) + ".json";
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  if (!file.is_open())
+  {
+    LOG_WARNING("failed to open %s", path.c_str());
+    return "";
+  }
+
+  size_t count = 0;
+  file << "{\"traceEvents\":[\n";
+  for (auto& buffer : buffers)
+  {
+    std::vector<Event> events;
+    {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      if (buffer->wrapped)
+      {
+        events.insert(events.end(), buffer->events.begin() + buffer->next, buffer->events.end());
+      }
+
+      events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+    }
+
+    for (const auto& event : events)
+    {
+      file << ((count++ > 0) ? ",\n" : "");
+      file << "{\"name\":\"" << event.name << "\",\"cat\":\"nchat\",\"pid\":1,\"tid\":" << buffer->tid <<
+        ",\"ts\":" << event.beginUSec;
+      if (event.endUSec >= 0)
+      {
+        file << ",\"ph\":\"X\",\"dur\":" << (event.endUSec - event.beginUSec);
+        if (event.argName != nullptr)
+        {
+          file << ",\"args\":{\"" << event.argName << "\":" << event.argValue << "}";
+        }
+      }
+      else
+      {
+        file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.argValue << "}";
+      }
+
+      file << "}";
+    }
+  }
+
+  file << "\n]}\n";
+  LOG_INFO("trace dumped %d events to %s", (int)count, path.c_str());
+  return path;
+}
+
+void Trace::AddEvent(const Event& p_Event)
+{
+  ThreadBuffer& buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events[buffer.next] = p_Event;
+  if (++buffer.next == buffer.events.size())
+  {
+    buffer.next = 0;
+    buffer.wrapped = true;
+  }
+}
+
+Trace::ThreadBuffer& Trace::GetThreadBuffer()
+{
+  // buffers are owned by the registry so they outlive their threads until dumped
+  thread_local ThreadBuffer* threadBuffer = nullptr;
+  if (threadBuffer == nullptr)
+  {
+    std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+    buffer->events.resize(s_ThreadBufferEvents);
+    std::lock_guard<std::mutex> lock(m_BuffersMutex);
+    buffer->tid = (int)m_Buffers.size() + 1;
+    m_Buffers.push_back(buffer);
+    threadBuffer = buffer.get();
+  }
+
+  return *threadBuffer;
+}
@@ -0,0 +1,85 @@
+// trace.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// lightweight tracing of scoped spans and counters into per-thread ring buffers,
+// dumped in chrome trace_event json format. names must be string literals.
+class Trace
+{
+public:
+  static void Init();
+  static void Cleanup();
+  static bool IsEnabled();
+  static int64_t GetTimeUSec();
+  static void AddSpan(const char* p_Name, int64_t p_BeginUSec, int64_t p_EndUSec,
+                      const char* p_ArgName = nullptr, int64_t p_ArgValue = 0);
+  static void AddCounter(const char* p_Name, int64_t p_Value);
+  static std::string Dump();
+
+private:
+  struct Event
+  {
+    const char* name = nullptr;
+    const char* argName = nullptr;
+    int64_t beginUSec = 0;
+    int64_t endUSec = -1; // -1 for counters
+    int64_t argValue = 0;
+  };
+
+  struct ThreadBuffer
+  {
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t next = 0;
+    bool wrapped = false;
+    int tid = 0;
+  };
+
+  static void AddEvent(const Event& p_Event);
+  static ThreadBuffer& GetThreadBuffer();
+
+private:
+  static std::atomic<bool> m_Enabled;
+  static std::mutex m_BuffersMutex;
+  static std::vector<std::shared_ptr<ThreadBuffer>> m_Buffers;
+};
+
+// records a span from construction to destruction
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const char* p_Name, const char* p_ArgName = nullptr, int64_t p_ArgValue = 0)
+  {
+    if (!Trace::IsEnabled()) return;
+
+    m_Name = p_Name;
+    m_ArgName = p_ArgName;
+    m_ArgValue = p_ArgValue;
+    m_BeginUSec = Trace::GetTimeUSec();
+  }
+
+  ~TraceSpan()
+  {
+    if (m_Name == nullptr) return;
+
+    Trace::AddSpan(m_Name, m_BeginUSec, Trace::GetTimeUSec(), m_ArgName, m_ArgValue);
+  }
+
+private:
+  const char* m_Name = nullptr;
+  const char* m_ArgName = nullptr;
+  int64_t m_ArgValue = 0;
+  int64_t m_BeginUSec = 0;
+};
@@ -0,0 +1,155 @@
+// uploadscheduler.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "uploadscheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "appconfig.h"
+#include "fileutil.h"
+#include "log.h"
+#include "perfstats.h"
+#include "status.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+
+void UploadScheduler::Init()
+{
+  const int concurrency = std::max(AppConfig::GetNum("attachment_upload_concurrency"), 1);
+  LOG_DEBUG("upload concurrency %d", concurrency);
+
+  m_Running = true;
+  for (int i = 0; i < concurrency; ++i)
+  {
+    m_Threads.emplace_back(&UploadScheduler::Process, this);
+  }
+}
+
+void UploadScheduler::Cleanup()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Running = false;
+    m_CondVar.notify_all();
+  }
+
+  for (auto& thread : m_Threads)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+
+  m_Threads.clear();
+
+  // uploads not started are reported failed, allowing the user to send them again
+  std::deque<Entry> queue;
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    queue.swap(m_Queue);
+  }
+
+  for (auto& entry : queue)
+  {
+    LOG_WARNING("upload cancelled %s", entry.filePath.c_str());
+    if (entry.doneHandler)
+    {
+      entry.doneHandler(false);
+    }
+  }
+}
+
+void UploadScheduler::Enqueue(const std::string& p_FilePath, const Job& p_Job, const DoneHandler& p_DoneHandler)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  Entry entry;
+  entry.filePath = p_FilePath;
+  entry.job = p_Job;
+  entry.doneHandler = p_DoneHandler;
+  m_Queue.push_back(std::move(entry));
+  m_CondVar.notify_one();
+}
+
+void UploadScheduler::Process()
+{
+  ThreadRegistry::Register("upload");
+
+  while (true)
+  {
+    Entry entry;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      if (!Dequeue(lock, entry)) return;
+    }
+
+    const ssize_t fileSize = FileUtil::GetFileSize(entry.filePath);
+    const int64_t totalBytes = std::max(fileSize, (ssize_t)0);
+    Status::Set(Status::FlagUploading);
+    Status::AddUploadBytes(0, totalBytes);
+    const bool success = entry.job ? entry.job() : false;
+    Status::AddUploadBytes(0, -totalBytes);
+    Status::Clear(Status::FlagUploading);
+
+    if (success)
+    {
+      PerfStats::Add(PerfStats::StatUploadedBytes, totalBytes);
+    }
+    else if (m_Running && (++entry.attempts < s_MaxAttempts))
+    {
+      // retried after other queued uploads, with increasing delay
+      LOG_WARNING("upload %s failed, retry %d", entry.filePath.c_str(), entry.attempts);
+      entry.retryTime = TimeUtil::GetCurrentTimeMSec() + (s_RetryDelayMs * entry.attempts);
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Queue.push_back(std::move(entry));
+      m_CondVar.notify_one();
+      continue;
+    }
+    else
+    {
+      LOG_WARNING("upload %s failed", entry.filePath.c_str());
+    }
+
+    if (entry.doneHandler)
+    {
+      entry.doneHandler(success);
+    }
+  }
+}
+
+bool UploadScheduler::Dequeue(std::unique_lock<std::mutex>& p_Lock, Entry& p_Entry)
+{
+  while (m_Running)
+  {
+    // uploads are started in queue order, skipping entries waiting for retry
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    int64_t waitMs = -1;
+    for (auto it = m_Queue.begin(); it != m_Queue.end(); ++it)
+    {
+      if (it->retryTime <= nowTime)
+      {
+        p_Entry = std::move(*it);
+        m_Queue.erase(it);
+        return true;
+      }
+
+      waitMs = (waitMs == -1) ? (it->retryTime - nowTime) : std::min(waitMs, it->retryTime - nowTime);
+    }
+
+    if (waitMs > 0)
+    {
+      m_CondVar.wait_for(p_Lock, std::chrono::milliseconds(waitMs));
+    }
+    else
+    {
+      m_CondVar.wait(p_Lock);
+    }
+  }
+
+  return false;
+}
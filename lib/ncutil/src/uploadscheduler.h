@@ -0,0 +1,56 @@
+// uploadscheduler.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// attachment upload scheduler, used by protocols whose uploads block, to pipeline several file sends
+// per profile. failed uploads are retried with a delay, e.g. to resume sending after a reconnect.
+class UploadScheduler
+{
+public:
+  // job performs a blocking upload and send, and returns false on failure
+  typedef std::function<bool()> Job;
+  // called once per job with the final result, after any retries
+  typedef std::function<void(bool)> DoneHandler;
+
+  void Init();
+  void Cleanup();
+
+  void Enqueue(const std::string& p_FilePath, const Job& p_Job, const DoneHandler& p_DoneHandler);
+
+private:
+  struct Entry
+  {
+    std::string filePath;
+    Job job;
+    DoneHandler doneHandler;
+    int attempts = 0;
+    int64_t retryTime = 0;
+  };
+
+  void Process();
+  bool Dequeue(std::unique_lock<std::mutex>& p_Lock, Entry& p_Entry);
+
+private:
+  std::atomic<bool> m_Running{ false };
+  std::vector<std::thread> m_Threads;
+  std::mutex m_Mutex;
+  std::condition_variable m_CondVar;
+  std::deque<Entry> m_Queue;
+  static const int s_MaxAttempts = 3;
+  static const int64_t s_RetryDelayMs = 5000;
+};
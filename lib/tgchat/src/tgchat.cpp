@@ -7,18 +7,24 @@
 
 #include "tgchat.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <td/telegram/Client.h>
-#include <td/telegram/Log.h>
 #include <td/telegram/td_api.h>
 #include <td/telegram/td_api.hpp>
 
@@ -28,15 +34,28 @@
 
 #include "appconfig.h"
 #include "apputil.h"
+#include "backgroundexecutor.h"
 #include "config.h"
+#include "downloadscheduler.h"
 #include "fileutil.h"
+#include "heapsize.h"
 #include "log.h"
 #include "messagecache.h"
+#include "objectpool.h"
 #include "path.hpp"
+#include "perfstats.h"
+#include "previewstore.h"
 #include "protocolutil.h"
+#include "requestqueue.h"
+#include "requesttracker.h"
+#include "startupprofile.h"
 #include "status.h"
 #include "strutil.h"
+#include "sysutil.h"
+#include "tgmarkdown.h"
+#include "threadregistry.h"
 #include "timeutil.h"
+#include "trace.h"
 
 // #define SIMULATED_SPONSORED_MESSAGES
 
@@ -76,9 +95,15 @@ auto overloaded(F... f)
   return detail::overload<F...>(f...);
 }
 
+class TdClientManager;
+class TdRequestPool;
 
 class TgChat::Impl
 {
+  friend class TdClientManager;
+  friend class TdRequestPool;
+  friend class TgChatBench;
+
 public:
   Impl()
   {
@@ -87,6 +112,7 @@ public:
 
   virtual ~Impl()
   {
+    PerfStats::Add(PerfStats::StatHeapTdMaps, -m_HeapSize);
   }
 
   std::string GetProfileId() const;
@@ -111,10 +137,13 @@ private:
   std::function<void(std::shared_ptr<ServiceMessage>)> m_MessageHandler;
 
   bool m_Running = false;
-  std::thread m_Thread;
-  std::deque<std::shared_ptr<RequestMessage>> m_RequestsQueue;
-  std::mutex m_ProcessMutex;
-  std::condition_variable m_ProcessCondVar;
+  // @note: request queue and flags are guarded by the shared request pool mutex
+  RequestQueue m_RequestsQueue;
+  bool m_RequestsRegistered = false;
+  bool m_RequestsScheduled = false;
+  bool m_RequestsActive = false;
+  int m_LoginThreadCount = 0;
+  int64_t m_LoginRssKb = 0;
 
 private:
   enum ChatType
@@ -135,13 +164,24 @@ private:
   void InitProxy();
   void Cleanup();
   void ProcessService();
-  void ProcessResponse(td::Client::Response response);
+  void ProcessResponse(td::ClientManager::Response response);
   void ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> update);
   void ProcessStatusUpdate(int64_t p_UserId,
                            td::td_api::object_ptr<td::td_api::UserStatus> p_Status);
   std::function<void(Object)> CreateAuthQueryHandler();
   void OnAuthStateUpdate();
   void SendQuery(td::td_api::object_ptr<td::td_api::Function> f, std::function<void(Object)> handler);
+  void QueueNewMessage(int64_t p_ChatId, ChatMessage p_ChatMessage);
+  void UpdateLastReadOutboxMessage(int64_t p_ChatId, int64_t p_LastReadMsgId);
+  void FlushNewMessages();
+  bool HasPendingNewMessages() const;
+  struct DetailsBatch;
+  void CompleteDetailsQuery(const std::shared_ptr<DetailsBatch>& p_DetailsBatch);
+  void FlushDetails(DetailsBatch& p_DetailsBatch);
+  void FlushTimedOutDetails();
+  bool HasPendingDetails() const;
+  void PurgeTimedOutQueries();
+  void UpdateHeapStats();
   void CheckAuthError(Object object);
   void CreateChat(Object p_Object);
   std::string GetRandomString(size_t p_Len);
@@ -152,7 +192,13 @@ private:
                                std::string& p_Text, std::string& p_FileInfo);
   void TdMessageConvert(td::td_api::message& p_TdMessage, ChatMessage& p_ChatMessage);
   void DownloadFile(std::string p_ChatId, std::string p_MsgId, std::string p_FileId, std::string p_DownloadId,
-                    DownloadFileAction p_DownloadFileAction);
+                    DownloadFileAction p_DownloadFileAction, DownloadFilePriority p_DownloadFilePriority);
+  void StartDownload(int32_t p_TdFileId, int32_t p_TdPriority);
+  void UpdateDownload(td::td_api::file& p_File);
+  void FinishDownload(int32_t p_TdFileId, FileStatus p_FileStatus, const std::string& p_Path, int64_t p_Size);
+  void CancelDownloads();
+  void UpdateUpload(td::td_api::file& p_File);
+  void ClearUploads();
   void RequestSponsoredMessagesIfNeeded();
   void GetSponsoredMessages(const std::string& p_ChatId);
   void ViewSponsoredMessage(const std::string& p_ChatId, const std::string& p_MsgId);
@@ -160,37 +206,535 @@ private:
   bool IsGroup(int64_t p_UserId);
   bool IsSelf(int64_t p_UserId);
   std::string GetContactName(int64_t p_UserId);
-  void GetChatHistory(int64_t p_ChatId, int64_t p_FromMsgId, int32_t p_Offset, int32_t p_Limit, bool p_Sequence);
+  void GetChatHistory(int64_t p_ChatId, int64_t p_FromMsgId, int32_t p_Offset, int32_t p_Limit, bool p_Sequence,
+                      bool p_OnlyLocal = false);
+  void GetChatsPage(std::shared_ptr<GetChatsRequest> p_GetChatsRequest, int32_t p_Offset);
+  void SearchServerMessages(std::shared_ptr<SearchMessagesRequest> p_SearchMessagesRequest,
+                            const std::string& p_Offset, int p_Found);
+  void StartBackfill();
+  void StopBackfill();
+  void AddBackfillChats(const std::vector<std::string>& p_ChatIds);
+  void ProcessBackfill();
+  void StartStorageOptimizer();
+  void StopStorageOptimizer();
+  void ProcessStorageOptimizer();
+  bool WaitStorageQuery(td::td_api::object_ptr<td::td_api::Function> p_Function, Object& p_Result);
+  void OptimizeStorage();
+  static td::td_api::object_ptr<td::td_api::FileType> GetFileType(const std::string& p_Name);
+  void GetBackfillHistory(int64_t p_ChatId, int64_t p_FromMsgId);
   td::td_api::object_ptr<td::td_api::formattedText> GetFormattedText(const std::string& p_Text);
   td::td_api::object_ptr<td::td_api::inputMessageText> GetMessageText(const std::string& p_Text);
   std::string ConvertMarkdownV2ToV1(const std::string& p_Str);
 
 private:
-  std::thread m_ServiceThread;
   std::string m_SetupPhoneNumber;
   Config m_Config;
-  std::unique_ptr<td::Client> m_Client;
-  std::map<std::uint64_t, std::function<void(Object)>> m_Handlers;
+  bool m_LocalHistory = false; // history read from tdlib database, not stored in message cache
+  td::ClientManager::ClientId m_ClientId = 0;
+  DownloadScheduler m_DownloadScheduler;
+
+  // @note: downloads are asynchronous and deduplicated per tdlib file id, progress and completion is
+  // reported from updateFile to all messages referencing the file
+  struct DownloadWaiter
+  {
+    std::string chatId;
+    std::string msgId;
+    std::string fileId;
+    DownloadFileAction downloadFileAction = DownloadFileActionNone;
+  };
+
+  struct Download
+  {
+    std::vector<DownloadWaiter> waiters;
+    int queuedCount = 0;
+    bool userQueued = false;
+    bool started = false;
+    int lastPercent = -1;
+    std::shared_ptr<std::promise<int64_t>> promise;
+  };
+
+  std::mutex m_DownloadsMutex;
+  std::unordered_map<int32_t, Download> m_Downloads;
+
+  // @note: uploads are scheduled by tdlib, active ones are tracked for status progress only
+  struct Upload
+  {
+    int64_t uploadedBytes = 0;
+    int64_t totalBytes = 0;
+  };
+
+  std::mutex m_UploadsMutex;
+  std::unordered_map<int32_t, Upload> m_Uploads;
+
+  // @note: history backfill into message cache, watermark is the oldest fetched message id per chat
+  bool m_BackfillRunning = false;
+  std::thread m_BackfillThread;
+  std::mutex m_BackfillMutex;
+  std::condition_variable m_BackfillCondVar;
+  std::deque<int64_t> m_BackfillQueue;
+  std::set<int64_t> m_BackfillChats;
+  Config m_BackfillConfig;
+  int m_BackfillInFlight = 0;
+  int m_BackfillConcurrency = 0;
+  int32_t m_BackfillWindow = 0;
+  int64_t m_BackfillIntervalMs = 0;
+  int64_t m_BackfillTime = 0;
+  int m_BackfillUnsavedCount = 0;
+  static const int s_BackfillSaveInterval = 50;
+  static const int s_BackfillQueueWaitMs = 500;
+  static const std::string s_BackfillDone;
+
+  // @note: storage optimizer enforces storage_budget entries "type:max_mb:max_days" on tdlib files
+  struct StorageBudget
+  {
+    std::string fileType;
+    int64_t maxSize = -1;
+    int32_t maxAge = -1;
+  };
+
+  bool m_StorageRunning = false;
+  std::thread m_StorageThread;
+  std::mutex m_StorageMutex;
+  std::condition_variable m_StorageCondVar;
+  std::vector<StorageBudget> m_StorageBudgets;
+  int64_t m_StorageIntervalMs = 0;
+  static const int64_t s_StorageStartDelayMs = 5 * 60 * 1000;
+  static const int64_t s_StorageActiveRetryMs = 60 * 1000;
+  static const int64_t s_StorageQueryTimeoutMs = 10 * 60 * 1000;
+
+  struct QueryHandler
+  {
+    std::function<void(Object)> handler;
+    int64_t sendTime = 0;
+  };
+
+  // @note: accessed from both request and service threads, entries are removed on response or timeout
+  std::mutex m_HandlersMutex;
+  std::unordered_map<std::uint64_t, QueryHandler> m_Handlers;
+  int64_t m_HandlersPurgeTime = 0;
+  size_t m_HandlersMaxCount = 0;
+  static const int64_t s_QueryTimeoutMs = 60 * 60 * 1000; // storage optimization may be slow
+  static const int64_t s_QueryPurgeIntervalMs = 60 * 1000;
+  // @note: new message updates are only accessed from the td client manager receive thread
+  std::map<int64_t, std::vector<ChatMessage>> m_PendingNewMessages;
+  size_t m_PendingNewMessagesCount = 0;
+  int64_t m_PendingNewMessagesTime = 0;
+  static const size_t s_NewMessagesBatchMaxCount = 256;
+  static const int64_t s_NewMessagesBatchMaxAgeMs = 100;
+  // user and chat detail responses of one request, notified together once all are in, or partially
+  // when waiting longer than max age. created on request thread, after that only accessed from the
+  // td client manager receive thread.
+  struct DetailsBatch
+  {
+    size_t pendingCount = 0;
+    bool started = false;
+    int64_t flushTime = 0;
+    std::vector<ContactInfo> contactInfos;
+    std::vector<ChatInfo> chatInfos;
+  };
+  std::vector<std::shared_ptr<DetailsBatch>> m_DetailsBatches; // started batches
+  static const int64_t s_DetailsBatchMaxAgeMs = 1000;
   td::td_api::object_ptr<td::td_api::AuthorizationState> m_AuthorizationState;
   bool m_IsSetup = false;
   bool m_Authorized = false;
   bool m_WasAuthorized = false;
   std::int64_t m_SelfUserId = 0;
   std::uint64_t m_AuthQueryId = 0;
-  std::uint64_t m_CurrentQueryId = 0;
-  std::map<int64_t, int64_t> m_LastReadInboxMessage;
-  std::map<int64_t, int64_t> m_LastReadOutboxMessage;
-  std::map<int64_t, std::set<int64_t>> m_UnreadOutboxMessages;
-  std::map<int64_t, ContactInfo> m_ContactInfos;
-  std::map<int64_t, ChatType> m_ChatTypes;
+  std::atomic<std::uint64_t> m_CurrentQueryId{ 0 };
+  std::unordered_map<int64_t, int64_t> m_LastReadInboxMessage;
+  std::unordered_map<int64_t, int64_t> m_LastReadOutboxMessage;
+  // @note: sorted ascending, as read receipts mark all messages up to an id as read
+  std::unordered_map<int64_t, std::vector<int64_t>> m_UnreadOutboxMessages;
+  std::unordered_map<int64_t, ContactInfo> m_ContactInfos;
+  std::unordered_map<int64_t, ChatType> m_ChatTypes;
   int64_t m_CurrentChat = 0;
   const char m_SponsoredMessageMsgIdPrefix = '+';
   std::map<std::string, std::set<std::string>> m_SponsoredMessageIds;
+#ifdef SIMULATED_SPONSORED_MESSAGES
+  static const int64_t s_SponsoredMessagesIntervalMs = 10 * 1000; // 10 sec
+#else
+  static const int64_t s_SponsoredMessagesIntervalMs = 5 * 60 * 1000; // 5 min
+#endif
+  static const size_t s_SponsoredMessagesChatsMax = 100;
+  // chats sponsored messages were requested for, only accessed from request thread
+  RequestTracker<int64_t> m_SponsoredMessagesRequests{ s_SponsoredMessagesChatsMax, s_SponsoredMessagesIntervalMs };
   int m_ProfileDirVersion = 0;
   bool m_WasOnline = false;
+  int64_t m_HeapSize = 0; // last published to heap stats
   static const int s_CacheDirVersion = 2;
+  static const int32_t s_ChatsPageSize = 100;
+};
+
+const std::string TgChat::Impl::s_BackfillDone = "done";
+
+// shared td client manager, a single receive thread dispatches responses of all profiles by client id
+class TdClientManager
+{
+public:
+  static td::ClientManager::ClientId AddClient(TgChat::Impl* p_Impl)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Manager)
+    {
+      m_Manager = std::make_unique<td::ClientManager>();
+    }
+
+    const td::ClientManager::ClientId clientId = m_Manager->create_client_id();
+    m_Clients[clientId] = p_Impl;
+    if (!m_Running)
+    {
+      m_Running = true;
+      m_Thread = std::thread(&TdClientManager::Process, ++m_Generation);
+    }
+
+    return clientId;
+  }
+
+  static void RemoveClient(td::ClientManager::ClientId p_ClientId)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (m_Clients.count(p_ClientId) == 0) return;
+
+    // closing results in an authorizationStateClosed update, which also wakes up the receive thread
+    m_ClosingClients.insert(p_ClientId);
+    m_Manager->send(p_ClientId, s_CloseRequestId, td::td_api::make_object<td::td_api::close>());
+    const bool closed = m_CondVar.wait_for(lock, std::chrono::seconds(s_CloseTimeoutSec),
+                                           [&]() { return m_Clients.count(p_ClientId) == 0; });
+    if (!closed)
+    {
+      LOG_WARNING("client %d close timed out", p_ClientId);
+      m_Clients.erase(p_ClientId);
+      m_ClosingClients.erase(p_ClientId);
+    }
+
+    if (m_Clients.empty() && m_Running)
+    {
+      m_Running = false;
+      std::thread thread = std::move(m_Thread);
+      lock.unlock();
+      thread.join();
+    }
+  }
+
+  static void Send(td::ClientManager::ClientId p_ClientId, td::ClientManager::RequestId p_RequestId,
+                   td::td_api::object_ptr<td::td_api::Function> p_Function)
+  {
+    m_Manager->send(p_ClientId, p_RequestId, std::move(p_Function));
+  }
+
+private:
+  static void Process(uint64_t p_Generation)
+  {
+    ThreadRegistry::Register("td-client");
+
+    bool hasPendingNewMessages = false;
+    bool hasPendingDetails = false;
+    while (true)
+    {
+      {
+        // exit when stopped, or superseded by a new thread after a quick stop and restart
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (!m_Running || (m_Generation != p_Generation)) return;
+      }
+
+      // blocking, timeout only serves periodic query and details batch timeout checks. pending new
+      // messages are flushed as soon as no more queued responses are available.
+      const double timeoutSec = hasPendingNewMessages ? 0.0 : (hasPendingDetails ? s_DetailsTimeoutSec :
+                                                               s_ReceiveTimeoutSec);
+      td::ClientManager::Response response = m_Manager->receive(timeoutSec);
+
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      if (response.object)
+      {
+        const bool isClosed = (response.object->get_id() == td::td_api::updateAuthorizationState::ID) &&
+          (static_cast<td::td_api::updateAuthorizationState&>(*response.object).authorization_state_->get_id() ==
+           td::td_api::authorizationStateClosed::ID);
+
+        auto it = m_Clients.find(response.client_id);
+        if ((it != m_Clients.end()) && (response.request_id != s_CloseRequestId))
+        {
+          it->second->ProcessResponse(std::move(response));
+        }
+
+        if (isClosed && (m_ClosingClients.erase(response.client_id) > 0))
+        {
+          m_Clients.erase(response.client_id);
+          m_CondVar.notify_all();
+        }
+      }
+
+      hasPendingNewMessages = false;
+      hasPendingDetails = false;
+      for (auto& client : m_Clients)
+      {
+        if (!response.object)
+        {
+          client.second->FlushNewMessages();
+        }
+
+        hasPendingNewMessages = hasPendingNewMessages || client.second->HasPendingNewMessages();
+        client.second->FlushTimedOutDetails();
+        hasPendingDetails = hasPendingDetails || client.second->HasPendingDetails();
+        client.second->PurgeTimedOutQueries();
+      }
+    }
+  }
+
+private:
+  static const td::ClientManager::RequestId s_CloseRequestId = std::numeric_limits<std::uint64_t>::max();
+  static constexpr double s_ReceiveTimeoutSec = 60.0;
+  static constexpr double s_DetailsTimeoutSec = 0.25;
+  static const int s_CloseTimeoutSec = 10;
+  static std::unique_ptr<td::ClientManager> m_Manager;
+  static std::map<td::ClientManager::ClientId, TgChat::Impl*> m_Clients;
+  static std::set<td::ClientManager::ClientId> m_ClosingClients;
+  static bool m_Running;
+  static uint64_t m_Generation;
+  static std::thread m_Thread;
+  static std::mutex m_Mutex;
+  static std::condition_variable m_CondVar;
+};
+
+std::unique_ptr<td::ClientManager> TdClientManager::m_Manager;
+std::map<td::ClientManager::ClientId, TgChat::Impl*> TdClientManager::m_Clients;
+std::set<td::ClientManager::ClientId> TdClientManager::m_ClosingClients;
+bool TdClientManager::m_Running = false;
+uint64_t TdClientManager::m_Generation = 0;
+std::thread TdClientManager::m_Thread;
+std::mutex TdClientManager::m_Mutex;
+std::condition_variable TdClientManager::m_CondVar;
+constexpr double TdClientManager::s_ReceiveTimeoutSec;
+constexpr double TdClientManager::s_DetailsTimeoutSec;
+
+// tdlib internal log, passed to the async logger instead of being written synchronously by tdlib. errors
+// and warnings are always passed on, more verbose messages are sampled up to a max rate per second.
+class TdLogSink
+{
+public:
+  static void Init(int p_Verbosity, const std::string& p_TagVerbosities, int p_MaxRate)
+  {
+    m_MaxRate = p_MaxRate;
+    td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogStream>(
+                                 td::td_api::make_object<td::td_api::logStreamEmpty>()));
+    td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogVerbosityLevel>(p_Verbosity));
+
+    // per module verbosity, e.g. "net_query=1,files=3"
+    const std::vector<std::string> entries = StrUtil::Split(p_TagVerbosities, ',');
+    for (const auto& entry : entries)
+    {
+      const std::vector<std::string> fields = StrUtil::Split(entry, '=');
+      if ((fields.size() != 2) || fields.at(0).empty()) continue;
+
+      const std::string& tag = fields.at(0);
+      const int tagVerbosity = (int)StrUtil::ToInteger(fields.at(1));
+      td::td_api::object_ptr<td::td_api::Object> result = td::ClientManager::execute(
+        td::td_api::make_object<td::td_api::setLogTagVerbosityLevel>(tag, tagVerbosity));
+      if (result && (result->get_id() == td::td_api::error::ID))
+      {
+        LOG_WARNING("td log tag %s verbosity %d failed", tag.c_str(), tagVerbosity);
+      }
+    }
+
+    td::ClientManager::set_log_message_callback(p_Verbosity, &TdLogSink::LogMessage);
+    LOG_DEBUG("td log verbosity %d tags \"%s\" max rate %d", p_Verbosity, p_TagVerbosities.c_str(), p_MaxRate);
+  }
+
+private:
+  static void LogMessage(int p_VerbosityLevel, const char* p_Message)
+  {
+    // called on tdlib threads
+    if (p_VerbosityLevel > s_WarningVerbosity)
+    {
+      const int maxRate = m_MaxRate;
+      if (maxRate > 0)
+      {
+        const int64_t nowSec = TimeUtil::GetCurrentTimeMSec() / 1000;
+        int64_t windowSec = m_WindowSec;
+        if ((windowSec != nowSec) && m_WindowSec.compare_exchange_strong(windowSec, nowSec))
+        {
+          m_WindowCount = 0;
+          const uint64_t sampledOutCount = m_SampledOutCount.exchange(0);
+          if (sampledOutCount > 0)
+          {
+            LOG_DEBUG("td log sampled out %llu messages", (unsigned long long)sampledOutCount);
+          }
+        }
+
+        if (++m_WindowCount > maxRate)
+        {
+          ++m_SampledOutCount;
+          return;
+        }
+      }
+    }
+
+    size_t len = strlen(p_Message);
+    while ((len > 0) && (p_Message[len - 1] == '\n'))
+    {
+      --len;
+    }
+
+    const std::string message(p_Message, len);
+    if (p_VerbosityLevel <= s_ErrorVerbosity)
+    {
+      LOG_ERROR("td %s", message.c_str());
+    }
+    else if (p_VerbosityLevel <= s_WarningVerbosity)
+    {
+      LOG_WARNING("td %s", message.c_str());
+    }
+    else
+    {
+      LOG_DEBUG("td %s", message.c_str());
+    }
+  }
+
+private:
+  static const int s_ErrorVerbosity = 1;
+  static const int s_WarningVerbosity = 2;
+  static std::atomic<int> m_MaxRate;
+  static std::atomic<int64_t> m_WindowSec;
+  static std::atomic<int> m_WindowCount;
+  static std::atomic<uint64_t> m_SampledOutCount;
+};
+
+std::atomic<int> TdLogSink::m_MaxRate(0);
+std::atomic<int64_t> TdLogSink::m_WindowSec(0);
+std::atomic<int> TdLogSink::m_WindowCount(0);
+std::atomic<uint64_t> TdLogSink::m_SampledOutCount(0);
+
+// shared request worker pool, requests of a profile are performed in order by at most one worker at a time
+class TdRequestPool
+{
+public:
+  static void AddClient(TgChat::Impl* p_Impl)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    p_Impl->m_RequestsRegistered = true;
+    ++m_ClientCount;
+    if (!m_Running)
+    {
+      m_Running = true;
+      ++m_Generation;
+      for (int i = 0; i < s_WorkerCount; ++i)
+      {
+        m_Threads.emplace_back(&TdRequestPool::Process, m_Generation);
+      }
+    }
+
+    Schedule(p_Impl);
+  }
+
+  static void RemoveClient(TgChat::Impl* p_Impl)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!p_Impl->m_RequestsRegistered) return;
+
+    // remaining queued requests are dropped, as previously when stopping the per-profile thread
+    p_Impl->m_RequestsRegistered = false;
+    m_Ready.erase(std::remove(m_Ready.begin(), m_Ready.end(), p_Impl), m_Ready.end());
+    m_CondVar.wait(lock, [&]() { return !p_Impl->m_RequestsActive; });
+    p_Impl->m_RequestsScheduled = false;
+    p_Impl->m_RequestsQueue.LogStats();
+    p_Impl->m_RequestsQueue.Clear();
+
+    if ((--m_ClientCount == 0) && m_Running)
+    {
+      m_Running = false;
+      m_CondVar.notify_all();
+      std::vector<std::thread> threads = std::move(m_Threads);
+      m_Threads.clear();
+      lock.unlock();
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+    }
+  }
+
+  static void Enqueue(TgChat::Impl* p_Impl, std::shared_ptr<RequestMessage> p_RequestMessage)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (p_RequestMessage)
+    {
+      p_Impl->m_RequestsQueue.Push(p_RequestMessage);
+    }
+
+    Schedule(p_Impl);
+  }
+
+  static int GetWorkerCount()
+  {
+    return s_WorkerCount;
+  }
+
+private:
+  static void Schedule(TgChat::Impl* p_Impl)
+  {
+    if (!p_Impl->m_RequestsRegistered || p_Impl->m_RequestsScheduled || p_Impl->m_RequestsQueue.Empty()) return;
+
+    p_Impl->m_RequestsScheduled = true;
+    m_Ready.push_back(p_Impl);
+    m_CondVar.notify_all();
+  }
+
+  static void Process(uint64_t p_Generation)
+  {
+    ThreadRegistry::Register("td-request");
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (m_Running && (m_Generation == p_Generation))
+    {
+      if (m_Ready.empty())
+      {
+        m_CondVar.wait(lock);
+        continue;
+      }
+
+      TgChat::Impl* impl = m_Ready.front();
+      m_Ready.pop_front();
+      if (!impl->m_MessageHandler)
+      {
+        // rescheduled when message handler is set
+        LOG_DEBUG("postpone request handling");
+        impl->m_RequestsScheduled = false;
+        continue;
+      }
+
+      std::shared_ptr<RequestMessage> requestMessage = impl->m_RequestsQueue.Pop();
+      impl->m_RequestsActive = true;
+
+      lock.unlock();
+      impl->PerformRequest(requestMessage);
+      lock.lock();
+
+      // requeue at back for round-robin between profiles
+      impl->m_RequestsActive = false;
+      impl->m_RequestsScheduled = false;
+      Schedule(impl);
+      m_CondVar.notify_all();
+    }
+  }
+
+private:
+  static const int s_WorkerCount = 2;
+  static std::deque<TgChat::Impl*> m_Ready;
+  static int m_ClientCount;
+  static bool m_Running;
+  static uint64_t m_Generation;
+  static std::vector<std::thread> m_Threads;
+  static std::mutex m_Mutex;
+  static std::condition_variable m_CondVar;
 };
 
+std::deque<TgChat::Impl*> TdRequestPool::m_Ready;
+int TdRequestPool::m_ClientCount = 0;
+bool TdRequestPool::m_Running = false;
+uint64_t TdRequestPool::m_Generation = 0;
+std::vector<std::thread> TdRequestPool::m_Threads;
+std::mutex TdRequestPool::m_Mutex;
+std::condition_variable TdRequestPool::m_CondVar;
+
 // Public interface
 extern "C" TgChat* CreateTgChat()
 {
@@ -275,7 +819,7 @@ std::string TgChat::Impl::GetProfileDisplayName() const
 
 bool TgChat::Impl::HasFeature(ProtocolFeature p_ProtocolFeature) const
 {
-  static int customFeatures = FeatureTypingTimeout | FeatureEditMessagesWithinTwoDays;
+  static int customFeatures = FeatureTypingTimeout | FeatureEditMessagesWithinTwoDays | FeatureServerSearch;
   return (p_ProtocolFeature & customFeatures);
 }
 
@@ -358,11 +902,19 @@ bool TgChat::Impl::Login()
 
   if (!m_Running)
   {
+    SysUtil::GetProcessStats(m_LoginThreadCount, m_LoginRssKb);
     m_Running = true;
-    m_Thread = std::thread(&TgChat::Impl::Process, this);
 
-    Init();
-    m_ServiceThread = std::thread(&TgChat::Impl::ProcessService, this);
+    // requests sent before login are queued, and handled once the client is initialized
+    {
+      StartupSpan tdInitSpan("tdlib init " + m_ProfileId);
+      Init();
+      TdRequestPool::AddClient(this);
+    }
+
+    m_DownloadScheduler.Init();
+    StartBackfill();
+    StartStorageOptimizer();
   }
 
   return true;
@@ -372,23 +924,14 @@ bool TgChat::Impl::Logout()
 {
   Status::Clear(Status::FlagOnline);
 
-  if (m_Running)
-  {
-    std::unique_lock<std::mutex> lock(m_ProcessMutex);
-    m_Running = false;
-    m_ProcessCondVar.notify_one();
-  }
-
-  if (m_Thread.joinable())
-  {
-    m_Thread.join();
-  }
-
-  if (m_ServiceThread.joinable())
-  {
-    m_ServiceThread.join();
-  }
+  m_Running = false;
+  TdRequestPool::RemoveClient(this);
 
+  StopBackfill();
+  StopStorageOptimizer();
+  CancelDownloads();
+  ClearUploads();
+  m_DownloadScheduler.Cleanup();
   Cleanup();
 
   return true;
@@ -396,52 +939,27 @@ bool TgChat::Impl::Logout()
 
 void TgChat::Impl::Process()
 {
-  while (m_Running)
-  {
-    std::shared_ptr<RequestMessage> requestMessage;
-
-    {
-      std::unique_lock<std::mutex> lock(m_ProcessMutex);
-      while (m_RequestsQueue.empty() && m_Running)
-      {
-        m_ProcessCondVar.wait(lock);
-      }
-
-      if (!m_Running)
-      {
-        break;
-      }
-
-      if (!m_MessageHandler)
-      {
-        LOG_DEBUG("postpone request handling");
-        m_ProcessCondVar.wait(lock);
-        continue;
-      }
-
-      requestMessage = m_RequestsQueue.front();
-      m_RequestsQueue.pop_front();
-    }
-
-    PerformRequest(requestMessage);
-  }
+  // requests are performed by the shared request pool
 }
 
 void TgChat::Impl::SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 {
-  std::unique_lock<std::mutex> lock(m_ProcessMutex);
-  m_RequestsQueue.push_back(p_RequestMessage);
-  m_ProcessCondVar.notify_one();
+  TdRequestPool::Enqueue(this, p_RequestMessage);
 }
 
 void TgChat::Impl::SetMessageHandler(const std::function<void(std::shared_ptr<ServiceMessage>)>& p_MessageHandler)
 {
   m_MessageHandler = p_MessageHandler;
+  TdRequestPool::Enqueue(this, nullptr); // resume postponed requests
 }
 
 void TgChat::Impl::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
 {
-  MessageCache::AddFromServiceMessage(m_ProfileId, p_ServiceMessage);
+  // with local history, tdlib database is the only message store, the cache keeps chats, contacts etc
+  if (!m_LocalHistory || (p_ServiceMessage->GetMessageType() != NewMessagesNotifyType))
+  {
+    MessageCache::AddFromServiceMessage(m_ProfileId, p_ServiceMessage);
+  }
 
   if (!m_MessageHandler)
   {
@@ -454,6 +972,12 @@ void TgChat::Impl::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceM
 
 void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 {
+  if (p_RequestMessage->IsCancelled())
+  {
+    LOG_DEBUG("Skip cancelled request %d", p_RequestMessage->GetMessageType());
+    return;
+  }
+
   // *INDENT-OFF*
   switch (p_RequestMessage->GetMessageType())
   {
@@ -493,35 +1017,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         Status::Set(Status::FlagFetching);
         std::shared_ptr<GetChatsRequest> getChatsRequest =
           std::static_pointer_cast<GetChatsRequest>(p_RequestMessage);
-        int32_t limit = std::numeric_limits<int32_t>::max(); // no limit
-
-        SendQuery(td::td_api::make_object<td::td_api::getChats>(nullptr, limit),
-                  [this, getChatsRequest](Object object)
-        {
-          Status::Clear(Status::FlagFetching);
-
-          if (object->get_id() == td::td_api::error::ID) return;
-
-          auto chats = td::move_tl_object_as<td::td_api::chats>(object);
-          if (chats->chat_ids_.size() == 0) return;
-
-          const bool noFilter = getChatsRequest->chatIds.empty();
-          std::vector<std::string> chatIds;
-          std::vector<ChatInfo> chatInfos;
-          for (auto chatId : chats->chat_ids_)
-          {
-            std::string chatIdStr = StrUtil::NumToHex(chatId);
-            if (noFilter || getChatsRequest->chatIds.count(chatIdStr))
-            {
-              chatIds.push_back(chatIdStr);
-            }
-          }
-
-          std::shared_ptr<DeferGetChatDetailsRequest> deferGetChatDetailsRequest =
-            std::make_shared<DeferGetChatDetailsRequest>();
-          deferGetChatDetailsRequest->chatIds = chatIds;
-          SendRequest(deferGetChatDetailsRequest);
-        });
+        GetChatsPage(getChatsRequest, 0);
       }
       break;
 
@@ -565,27 +1061,35 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
 
         const bool isGetTypeOnly = deferGetChatDetailsRequest->isGetTypeOnly;
         const std::vector<std::string>& chatIds = deferGetChatDetailsRequest->chatIds;
+        if (chatIds.empty()) break;
+
+        // one status span and chats notify for the whole request
+        std::shared_ptr<DetailsBatch> detailsBatch = std::make_shared<DetailsBatch>();
+        detailsBatch->pendingCount = chatIds.size();
+        Status::Set(Status::FlagFetching);
         for (auto& chatId : chatIds)
         {
-          Status::Set(Status::FlagFetching);
           std::int64_t chatIdNum = StrUtil::NumFromHex<int64_t>(chatId);
 
           auto get_chat = td::td_api::make_object<td::td_api::getChat>();
           get_chat->chat_id_ = chatIdNum;
           SendQuery(std::move(get_chat),
-                    [this, chatId, isGetTypeOnly](Object object)
+                    [this, chatId, isGetTypeOnly, detailsBatch](Object object)
           {
-            Status::Clear(Status::FlagFetching);
-
             if (object->get_id() == td::td_api::error::ID)
             {
               LOG_WARNING("get chat details failed %s", chatId.c_str());
+              CompleteDetailsQuery(detailsBatch);
               return;
             }
 
             auto tchat = td::move_tl_object_as<td::td_api::chat>(object);
 
-            if (!tchat) return;
+            if (!tchat)
+            {
+              CompleteDetailsQuery(detailsBatch);
+              return;
+            }
 
             if (tchat->type_->get_id() == td::td_api::chatTypePrivate::ID)
             {
@@ -617,7 +1121,11 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
               LOG_WARNING("unknown chat type %d", tchat->type_->get_id());
             }
 
-            if (isGetTypeOnly) return;
+            if (isGetTypeOnly)
+            {
+              CompleteDetailsQuery(detailsBatch);
+              return;
+            }
 
             ChatInfo chatInfo;
             chatInfo.id = StrUtil::NumToHex(tchat->id_);
@@ -629,41 +1137,11 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
             int64_t lastMessageHash =
               (tchat->last_message_ != nullptr) ? (std::hash<std::string>{ } (StrUtil::NumToHex(tchat->last_message_->id_)) % 256) : 0;
             chatInfo.lastMessageTime = (lastMessageTimeSec * 1000) + lastMessageHash;
-
-            std::vector<ChatInfo> chatInfos;
-            chatInfos.push_back(chatInfo);
-
-            std::shared_ptr<NewChatsNotify> newChatsNotify =
-              std::make_shared<NewChatsNotify>(m_ProfileId);
-            newChatsNotify->success = true;
-            newChatsNotify->chatInfos = chatInfos;
-            CallMessageHandler(newChatsNotify);
+            detailsBatch->chatInfos.push_back(chatInfo);
 
             m_LastReadInboxMessage[tchat->id_] = tchat->last_read_inbox_message_id_;
-            m_LastReadOutboxMessage[tchat->id_] = tchat->last_read_outbox_message_id_;
-
-            std::set<int64_t>& unreadMessages = m_UnreadOutboxMessages[tchat->id_];
-            if (!unreadMessages.empty())
-            {
-              for (auto it = unreadMessages.begin(); it != unreadMessages.end(); /* inc in loop */)
-              {
-                if (*it <= tchat->last_read_outbox_message_id_)
-                {
-                  std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
-                    std::make_shared<NewMessageStatusNotify>(m_ProfileId);
-                  newMessageStatusNotify->chatId = StrUtil::NumToHex(tchat->id_);
-                  newMessageStatusNotify->msgId = StrUtil::NumToHex(*it);
-                  newMessageStatusNotify->isRead = true;
-                  CallMessageHandler(newMessageStatusNotify);
-
-                  it = unreadMessages.erase(it);
-                }
-                else
-                {
-                  it = std::next(it);
-                }
-              }
-            }
+            UpdateLastReadOutboxMessage(tchat->id_, tchat->last_read_outbox_message_id_);
+            CompleteDetailsQuery(detailsBatch);
           });
         }
       }
@@ -677,23 +1155,34 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
           std::static_pointer_cast<DeferGetUserDetailsRequest>(p_RequestMessage);
 
         const std::vector<std::string>& userIds = deferGetUserDetailsRequest->userIds;
+        if (userIds.empty()) break;
+
+        // one status span and contacts notify for the whole request
+        std::shared_ptr<DetailsBatch> detailsBatch = std::make_shared<DetailsBatch>();
+        detailsBatch->pendingCount = userIds.size();
+        Status::Set(Status::FlagFetching);
         for (auto& userId : userIds)
         {
-          Status::Set(Status::FlagFetching);
           std::int64_t userIdNum = StrUtil::NumFromHex<int64_t>(userId);
 
           auto get_user = td::td_api::make_object<td::td_api::getUser>();
           get_user->user_id_ = userIdNum;
           SendQuery(std::move(get_user),
-                    [this](Object object)
+                    [this, detailsBatch](Object object)
           {
-            Status::Clear(Status::FlagFetching);
-
-            if (object->get_id() == td::td_api::error::ID) return;
+            if (object->get_id() == td::td_api::error::ID)
+            {
+              CompleteDetailsQuery(detailsBatch);
+              return;
+            }
 
             auto tuser = td::move_tl_object_as<td::td_api::user>(object);
 
-            if (!tuser) return;
+            if (!tuser)
+            {
+              CompleteDetailsQuery(detailsBatch);
+              return;
+            }
 
             const int64_t contactId = tuser->id_;
             ContactInfo contactInfo;
@@ -703,14 +1192,8 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
             contactInfo.phone = tuser->phone_number_;
             contactInfo.isSelf = IsSelf(contactId);
             m_ContactInfos[contactId] = contactInfo;
-
-            std::vector<ContactInfo> contactInfos;
-            contactInfos.push_back(contactInfo);
-
-            std::shared_ptr<NewContactsNotify> newContactsNotify =
-              std::make_shared<NewContactsNotify>(m_ProfileId);
-            newContactsNotify->contactInfos = contactInfos;
-            CallMessageHandler(newContactsNotify);
+            detailsBatch->contactInfos.push_back(contactInfo);
+            CompleteDetailsQuery(detailsBatch);
           });
         }
       }
@@ -722,7 +1205,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         std::shared_ptr<GetMessageRequest> getMessageRequest =
           std::static_pointer_cast<GetMessageRequest>(p_RequestMessage);
 
-        if (getMessageRequest->cached)
+        if (getMessageRequest->cached && !m_LocalHistory)
         {
           if (MessageCache::FetchOneMessage(m_ProfileId, getMessageRequest->chatId,
                                             getMessageRequest->msgId, false /*p_Sync*/))
@@ -736,7 +1219,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         int32_t offset = -1; // to get fromMsgId itself
         int32_t limit = 1;
         bool sequence = false; // out-of-sequence single message
-        GetChatHistory(chatId, fromMsgId, offset, limit, sequence);
+        GetChatHistory(chatId, fromMsgId, offset, limit, sequence, m_LocalHistory);
       }
       break;
 
@@ -746,8 +1229,8 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         std::shared_ptr<GetMessagesRequest> getMessagesRequest =
           std::static_pointer_cast<GetMessagesRequest>(p_RequestMessage);
 
-        if (!getMessagesRequest->fromMsgId.empty() ||
-            (getMessagesRequest->limit == std::numeric_limits<int>::max()))
+        if (!m_LocalHistory && (!getMessagesRequest->fromMsgId.empty() ||
+                                (getMessagesRequest->limit == std::numeric_limits<int>::max())))
         {
           if (MessageCache::FetchMessagesFrom(m_ProfileId, getMessagesRequest->chatId,
                                               getMessagesRequest->fromMsgId,
@@ -762,7 +1245,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         int32_t offset = 0;
         int32_t limit = getMessagesRequest->limit;
         bool sequence = true; // in-sequence history request
-        GetChatHistory(chatId, fromMsgId, offset, limit, sequence);
+        GetChatHistory(chatId, fromMsgId, offset, limit, sequence, m_LocalHistory);
       }
       break;
 
@@ -791,7 +1274,12 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
           static const bool attachmentSendType = AppConfig::GetBool("attachment_send_type");
           FileInfo fileInfo =
             ProtocolUtil::FileInfoFromHex(sendMessageRequest->chatMessage.fileInfo);
-          std::string mimeType = StrUtil::Split(fileInfo.fileType, '/').at(0);
+          if (fileInfo.fileType.empty())
+          {
+            fileInfo.fileType = FileUtil::GetMimeType(fileInfo.filePath);
+          }
+
+          std::string mimeType = StrUtil::SplitFirst(fileInfo.fileType, '/');
           if (attachmentSendType && (mimeType == "audio"))
           {
             auto message_content = td::td_api::make_object<td::td_api::inputMessageAudio>();
@@ -823,11 +1311,10 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         {
           Status::Clear(Status::FlagSending);
 
-          if (object->get_id() == td::td_api::error::ID) return;
-
+          // failures are reported too, so the ui outbox can retry
           std::shared_ptr<SendMessageNotify> sendMessageNotify =
             std::make_shared<SendMessageNotify>(m_ProfileId);
-          sendMessageNotify->success = true;
+          sendMessageNotify->success = (object->get_id() != td::td_api::error::ID);
 
           sendMessageNotify->chatId = sendMessageRequest->chatId;
           sendMessageNotify->chatMessage = sendMessageRequest->chatMessage;
@@ -903,11 +1390,60 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
       }
       break;
 
-    case DeleteMessageRequestType:
+    case MarkMessagesReadRequestType:
       {
-        LOG_DEBUG("Delete message");
-        Status::Set(Status::FlagUpdating);
-        std::shared_ptr<DeleteMessageRequest> deleteMessageRequest =
+        LOG_DEBUG("Mark messages read");
+        std::shared_ptr<MarkMessagesReadRequest> markMessagesReadRequest =
+          std::static_pointer_cast<MarkMessagesReadRequest>(p_RequestMessage);
+        int64_t chatId = StrUtil::NumFromHex<int64_t>(markMessagesReadRequest->chatId);
+
+        // sponsored messages are viewed separately, and cannot serve as high-watermark
+        std::string highMsgId;
+        std::vector<std::int64_t> msgIds;
+        for (const auto& msgId : markMessagesReadRequest->msgIds)
+        {
+          if (IsSponsoredMessageId(msgId))
+          {
+            ViewSponsoredMessage(markMessagesReadRequest->chatId, msgId);
+            continue;
+          }
+
+          if (highMsgId.empty())
+          {
+            highMsgId = msgId;
+          }
+
+          msgIds.push_back(StrUtil::NumFromHex<int64_t>(msgId));
+        }
+
+        if (msgIds.empty()) return;
+
+        auto view_messages = td::td_api::make_object<td::td_api::viewMessages>();
+        view_messages->chat_id_ = chatId;
+        view_messages->message_ids_ = msgIds;
+        view_messages->force_read_ = true;
+
+        SendQuery(std::move(view_messages),
+                  [this, markMessagesReadRequest, highMsgId](Object object)
+        {
+          if (object->get_id() == td::td_api::error::ID) return;
+
+          std::shared_ptr<MarkMessagesReadNotify> markMessagesReadNotify =
+            std::make_shared<MarkMessagesReadNotify>(m_ProfileId);
+          markMessagesReadNotify->success = true;
+          markMessagesReadNotify->chatId = markMessagesReadRequest->chatId;
+          markMessagesReadNotify->msgId = highMsgId;
+          markMessagesReadNotify->msgIds = markMessagesReadRequest->msgIds;
+          CallMessageHandler(markMessagesReadNotify);
+        });
+      }
+      break;
+
+    case DeleteMessageRequestType:
+      {
+        LOG_DEBUG("Delete message");
+        Status::Set(Status::FlagUpdating);
+        std::shared_ptr<DeleteMessageRequest> deleteMessageRequest =
           std::static_pointer_cast<DeleteMessageRequest>(
           p_RequestMessage);
         int64_t chatId = StrUtil::NumFromHex<int64_t>(deleteMessageRequest->chatId);
@@ -942,6 +1478,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
           std::static_pointer_cast<DeleteChatRequest>(
           p_RequestMessage);
         int64_t chatId = StrUtil::NumFromHex<int64_t>(deleteChatRequest->chatId);
+        m_SponsoredMessagesRequests.Remove(chatId);
 
         auto delete_chat = td::td_api::make_object<td::td_api::deleteChat>();
         delete_chat->chat_id_ = chatId;
@@ -1085,12 +1622,13 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         std::string msgId = downloadFileRequest->msgId;
         std::string fileId = downloadFileRequest->fileId;
         DownloadFileAction downloadFileAction = downloadFileRequest->downloadFileAction;
+        DownloadFilePriority downloadFilePriority = downloadFileRequest->downloadFilePriority;
 
         auto get_remote_file = td::td_api::make_object<td::td_api::getRemoteFile>();
         get_remote_file->remote_file_id_ = fileId;
         get_remote_file->file_type_ = nullptr;
         SendQuery(std::move(get_remote_file),
-                  [this, chatId, msgId, fileId, downloadFileAction](Object object)
+                  [this, chatId, msgId, fileId, downloadFileAction, downloadFilePriority](Object object)
         {
           if (object->get_id() == td::td_api::error::ID) return;
 
@@ -1106,6 +1644,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
             deferDownloadFileRequest->fileId = fileId;
             deferDownloadFileRequest->downloadId = downloadId;
             deferDownloadFileRequest->downloadFileAction = downloadFileAction;
+            deferDownloadFileRequest->downloadFilePriority = downloadFilePriority;
             SendRequest(deferDownloadFileRequest);
           }
         });
@@ -1121,7 +1660,8 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
         std::string fileId = deferDownloadFileRequest->fileId;
         std::string downloadId = deferDownloadFileRequest->downloadId;
         DownloadFileAction downloadFileAction = deferDownloadFileRequest->downloadFileAction;
-        DownloadFile(chatId, msgId, fileId, downloadId, downloadFileAction);
+        DownloadFilePriority downloadFilePriority = deferDownloadFileRequest->downloadFilePriority;
+        DownloadFile(chatId, msgId, fileId, downloadId, downloadFileAction, downloadFilePriority);
       }
       break;
 
@@ -1131,6 +1671,7 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
           std::static_pointer_cast<SetCurrentChatRequest>(p_RequestMessage);
         int64_t chatId = StrUtil::NumFromHex<int64_t>(setCurrentChatRequest->chatId);
         m_CurrentChat = chatId;
+        m_DownloadScheduler.SetCurrentChat(setCurrentChatRequest->chatId);
         RequestSponsoredMessagesIfNeeded();
       }
       break;
@@ -1144,6 +1685,25 @@ void TgChat::Impl::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessa
       }
       break;
 
+    case SearchMessagesRequestType:
+      {
+        std::shared_ptr<SearchMessagesRequest> searchMessagesRequest =
+          std::static_pointer_cast<SearchMessagesRequest>(p_RequestMessage);
+        LOG_DEBUG("search server messages %d", searchMessagesRequest->limit);
+        SearchServerMessages(searchMessagesRequest, "", 0);
+      }
+      break;
+
+    case ReconnectRequestType:
+      {
+        // tdlib drops and reopens its connections on any network type change, and then catches up
+        // on missed updates itself
+        LOG_DEBUG("reconnect");
+        SendQuery(td::td_api::make_object<td::td_api::setNetworkType>(
+                    td::td_api::make_object<td::td_api::networkTypeOther>()), nullptr);
+      }
+      break;
+
     default:
       LOG_DEBUG("unknown request message %d", p_RequestMessage->GetMessageType());
       break;
@@ -1159,19 +1719,33 @@ void TgChat::Impl::Init()
     { "local_key", "" },
     { "markdown_enabled", "1" },
     { "markdown_version", "1" },
+    { "backfill_enabled", "0" },
+    { "backfill_concurrency", "2" },
+    { "backfill_interval_ms", "1000" },
+    { "backfill_window", "100" },
+    { "local_history", "0" },
+    { "storage_budget", "" },
+    { "storage_interval_hours", "24" },
+    { "td_log_verbosity", "" },
+    { "td_log_tags", "" },
+    { "td_log_max_rate", "200" },
   };
   const std::string configPath(m_ProfileDir + std::string("/telegram.conf"));
   m_Config = Config(configPath, defaultConfig);
+  m_LocalHistory = (m_Config.Get("local_history") == "1");
+  LOG_DEBUG("local history %d", m_LocalHistory);
 
   {
     static std::mutex ctorMutex;
     std::unique_lock<std::mutex> lock(ctorMutex);
 
-    td::Log::set_verbosity_level(Log::GetDebugEnabled() ? 5 : 1);
-    const std::string logPath(m_ProfileDir + std::string("/td.log"));
-    td::Log::set_file_path(logPath);
-    td::Log::set_max_file_size(1024 * 1024);
-    m_Client = std::make_unique<td::Client>();
+    // tdlib logging is process wide, last initialized profile settings apply
+    const std::string logVerbosity = m_Config.Get("td_log_verbosity");
+    const int verbosity = !logVerbosity.empty() ? (int)StrUtil::ToInteger(logVerbosity) :
+      (Log::GetDebugEnabled() ? 5 : 1);
+    const int maxRate = (int)StrUtil::ToInteger(m_Config.Get("td_log_max_rate"));
+    TdLogSink::Init(verbosity, m_Config.Get("td_log_tags"), maxRate);
+    m_ClientId = TdClientManager::AddClient(this);
   }
 
   InitProxy();
@@ -1227,36 +1801,261 @@ void TgChat::Impl::InitProxy()
 void TgChat::Impl::Cleanup()
 {
   m_Config.Save();
-  td::td_api::close();
+  if (m_ClientId != 0)
+  {
+    TdClientManager::RemoveClient(m_ClientId);
+    m_ClientId = 0;
+  }
 }
 
 void TgChat::Impl::ProcessService()
 {
+  // responses are handled by the shared receive thread, only used to wait for setup to complete
   while (m_Running)
   {
-    auto response = m_Client->receive(0.1);
-    if (response.object)
+    TimeUtil::Sleep(0.1);
+  }
+}
+
+void TgChat::Impl::ProcessResponse(td::ClientManager::Response response)
+{
+  if (!response.object) return;
+
+  // preserve ordering by flushing pending new messages before processing any other response
+  if ((response.request_id != 0) || (response.object->get_id() != td::td_api::updateNewMessage::ID))
+  {
+    FlushNewMessages();
+  }
+
+  if (response.request_id == 0) return ProcessUpdate(std::move(response.object));
+
+  std::function<void(Object)> handler;
+  {
+    std::unique_lock<std::mutex> lock(m_HandlersMutex);
+    auto it = m_Handlers.find(response.request_id);
+    if (it == m_Handlers.end()) return;
+
+    handler = std::move(it->second.handler);
+    m_Handlers.erase(it);
+    PerfStats::Add(PerfStats::StatTdQueriesInFlight, -1);
+  }
+
+  handler(std::move(response.object));
+}
+
+void TgChat::Impl::QueueNewMessage(int64_t p_ChatId, ChatMessage p_ChatMessage)
+{
+  if (m_PendingNewMessagesCount == 0)
+  {
+    m_PendingNewMessagesTime = TimeUtil::GetCurrentTimeMSec();
+  }
+
+  m_PendingNewMessages[p_ChatId].push_back(std::move(p_ChatMessage));
+  ++m_PendingNewMessagesCount;
+
+  // bound batch size and latency during a continuous stream of updates
+  if ((m_PendingNewMessagesCount >= s_NewMessagesBatchMaxCount) ||
+      ((TimeUtil::GetCurrentTimeMSec() - m_PendingNewMessagesTime) >= s_NewMessagesBatchMaxAgeMs))
+  {
+    FlushNewMessages();
+  }
+}
+
+void TgChat::Impl::FlushNewMessages()
+{
+  if (m_PendingNewMessagesCount == 0) return;
+
+  LOG_TRACE("flush new msgs %d chats %d", (int)m_PendingNewMessagesCount, (int)m_PendingNewMessages.size());
+
+  std::map<int64_t, std::vector<ChatMessage>> pendingNewMessages;
+  pendingNewMessages.swap(m_PendingNewMessages);
+  m_PendingNewMessagesCount = 0;
+
+  for (auto& pendingNewMessage : pendingNewMessages)
+  {
+    std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+      std::make_shared<NewMessagesNotify>(m_ProfileId);
+    newMessagesNotify->success = true;
+    newMessagesNotify->chatId = StrUtil::NumToHex(pendingNewMessage.first);
+    newMessagesNotify->chatMessages = std::move(pendingNewMessage.second);
+    newMessagesNotify->cached = false;
+    newMessagesNotify->sequence = true;
+    CallMessageHandler(newMessagesNotify);
+  }
+}
+
+bool TgChat::Impl::HasPendingNewMessages() const
+{
+  return (m_PendingNewMessagesCount > 0);
+}
+
+void TgChat::Impl::CompleteDetailsQuery(const std::shared_ptr<DetailsBatch>& p_DetailsBatch)
+{
+  if (!p_DetailsBatch->started)
+  {
+    p_DetailsBatch->started = true;
+    p_DetailsBatch->flushTime = TimeUtil::GetCurrentTimeMSec();
+    m_DetailsBatches.push_back(p_DetailsBatch);
+  }
+
+  if (--p_DetailsBatch->pendingCount > 0) return;
+
+  FlushDetails(*p_DetailsBatch);
+  m_DetailsBatches.erase(std::remove(m_DetailsBatches.begin(), m_DetailsBatches.end(), p_DetailsBatch),
+                         m_DetailsBatches.end());
+  Status::Clear(Status::FlagFetching);
+}
+
+void TgChat::Impl::FlushDetails(DetailsBatch& p_DetailsBatch)
+{
+  p_DetailsBatch.flushTime = TimeUtil::GetCurrentTimeMSec();
+  if (!p_DetailsBatch.contactInfos.empty())
+  {
+    LOG_TRACE("flush user details %d", (int)p_DetailsBatch.contactInfos.size());
+    std::shared_ptr<NewContactsNotify> newContactsNotify = std::make_shared<NewContactsNotify>(m_ProfileId);
+    newContactsNotify->contactInfos.swap(p_DetailsBatch.contactInfos);
+    CallMessageHandler(newContactsNotify);
+  }
+
+  if (!p_DetailsBatch.chatInfos.empty())
+  {
+    LOG_TRACE("flush chat details %d", (int)p_DetailsBatch.chatInfos.size());
+    std::shared_ptr<NewChatsNotify> newChatsNotify = std::make_shared<NewChatsNotify>(m_ProfileId);
+    newChatsNotify->success = true;
+    newChatsNotify->chatInfos.swap(p_DetailsBatch.chatInfos);
+    CallMessageHandler(newChatsNotify);
+  }
+}
+
+void TgChat::Impl::FlushTimedOutDetails()
+{
+  // responses received so far are shown while the rest of a slow batch is still pending
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  for (auto& detailsBatch : m_DetailsBatches)
+  {
+    if ((nowTime - detailsBatch->flushTime) < s_DetailsBatchMaxAgeMs) continue;
+
+    FlushDetails(*detailsBatch);
+  }
+}
+
+bool TgChat::Impl::HasPendingDetails() const
+{
+  return !m_DetailsBatches.empty();
+}
+
+void TgChat::Impl::UpdateLastReadOutboxMessage(int64_t p_ChatId, int64_t p_LastReadMsgId)
+{
+  m_LastReadOutboxMessage[p_ChatId] = p_LastReadMsgId;
+
+  auto unreadIt = m_UnreadOutboxMessages.find(p_ChatId);
+  if (unreadIt == m_UnreadOutboxMessages.end()) return;
+
+  std::vector<int64_t>& unreadMessages = unreadIt->second;
+  auto readEnd = std::upper_bound(unreadMessages.begin(), unreadMessages.end(), p_LastReadMsgId);
+  if (readEnd != unreadMessages.begin())
+  {
+    // one range notify up to the newest read message, instead of one per message
+    std::shared_ptr<ReadOutboxNotify> readOutboxNotify = ObjectPool::MakeShared<ReadOutboxNotify>(m_ProfileId);
+    readOutboxNotify->chatId = StrUtil::NumToHex(p_ChatId);
+    readOutboxNotify->msgId = StrUtil::NumToHex(*std::prev(readEnd));
+    CallMessageHandler(readOutboxNotify);
+  }
+
+  unreadMessages.erase(unreadMessages.begin(), readEnd);
+  if (unreadMessages.empty())
+  {
+    m_UnreadOutboxMessages.erase(unreadIt);
+  }
+}
+
+void TgChat::Impl::PurgeTimedOutQueries()
+{
+  // timed out handlers are called with an error, so that their status flags are cleared
+  std::vector<std::function<void(Object)>> timedOutHandlers;
+  {
+    std::unique_lock<std::mutex> lock(m_HandlersMutex);
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    if ((nowTime - m_HandlersPurgeTime) < s_QueryPurgeIntervalMs) return;
+
+    m_HandlersPurgeTime = nowTime;
+    for (auto it = m_Handlers.begin(); it != m_Handlers.end(); /* incremented in loop */)
     {
-      ProcessResponse(std::move(response));
+      if ((nowTime - it->second.sendTime) >= s_QueryTimeoutMs)
+      {
+        LOG_WARNING("query %llu timed out", (unsigned long long)it->first);
+        timedOutHandlers.push_back(std::move(it->second.handler));
+        it = m_Handlers.erase(it);
+        PerfStats::Add(PerfStats::StatTdQueriesInFlight, -1);
+      }
+      else
+      {
+        ++it;
+      }
     }
+
+    LOG_DEBUG("queries in flight %d max %d", (int)m_Handlers.size(), (int)m_HandlersMaxCount);
+    m_HandlersMaxCount = m_Handlers.size();
+  }
+
+  for (auto& handler : timedOutHandlers)
+  {
+    handler(td::td_api::make_object<td::td_api::error>(408, "Query timed out"));
   }
+
+  UpdateHeapStats();
 }
 
-void TgChat::Impl::ProcessResponse(td::Client::Response response)
+void TgChat::Impl::UpdateHeapStats()
 {
-  if (!response.object) return;
+  // called from td client manager receive thread, which owns the maps below
+  size_t size = 0;
+  {
+    std::unique_lock<std::mutex> lock(m_HandlersMutex);
+    size += HeapSize::Nodes(m_Handlers) + HeapSize::Buckets(m_Handlers);
+  }
+
+  size += HeapSize::Nodes(m_PendingNewMessages);
+  for (const auto& pendingNewMessages : m_PendingNewMessages)
+  {
+    size += HeapSize::Of(pendingNewMessages.second);
+    for (const auto& chatMessage : pendingNewMessages.second)
+    {
+      size += sizeof(ChatMessage) + HeapSize::Of(chatMessage.id) + HeapSize::Of(chatMessage.senderId) +
+        HeapSize::Of(chatMessage.text) + HeapSize::Of(chatMessage.quotedText) + HeapSize::Of(chatMessage.fileInfo);
+    }
+  }
+
+  size += HeapSize::Nodes(m_ContactInfos) + HeapSize::Buckets(m_ContactInfos);
+  for (const auto& contactInfo : m_ContactInfos)
+  {
+    size += HeapSize::Of(contactInfo.second.id) + HeapSize::Of(contactInfo.second.name) +
+      HeapSize::Of(contactInfo.second.phone);
+  }
 
-  if (response.id == 0) return ProcessUpdate(std::move(response.object));
+  size += HeapSize::Nodes(m_UnreadOutboxMessages) + HeapSize::Buckets(m_UnreadOutboxMessages);
+  for (const auto& unreadOutboxMessages : m_UnreadOutboxMessages)
+  {
+    size += HeapSize::Of(unreadOutboxMessages.second);
+  }
 
-  auto it = m_Handlers.find(response.id);
-  if (it != m_Handlers.end())
+  size += HeapSize::Nodes(m_LastReadInboxMessage) + HeapSize::Buckets(m_LastReadInboxMessage);
+  size += HeapSize::Nodes(m_LastReadOutboxMessage) + HeapSize::Buckets(m_LastReadOutboxMessage);
+  size += HeapSize::Nodes(m_ChatTypes) + HeapSize::Buckets(m_ChatTypes);
+  size += HeapSize::Nodes(m_SponsoredMessageIds);
+  for (const auto& sponsoredMessageIds : m_SponsoredMessageIds)
   {
-    it->second(std::move(response.object));
+    size += HeapSize::Nodes(sponsoredMessageIds.second);
   }
+
+  // published as delta, as multiple profiles share the stat
+  PerfStats::Add(PerfStats::StatHeapTdMaps, (int64_t)size - m_HeapSize);
+  m_HeapSize = size;
 }
 
 void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> update)
 {
+  TraceSpan updateSpan("TgChat::ProcessUpdate", "id", update->get_id());
   // *INDENT-OFF*
   td::td_api::downcast_call(*update, overloaded(
   [this](td::td_api::updateAuthorizationState& update_authorization_state)
@@ -1331,17 +2130,7 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
     bool isPending = (message->sending_state_ != nullptr);
     if (!isPending) // ignore pending messages as their ids change once sent
     {
-      std::vector<ChatMessage> chatMessages;
-      chatMessages.push_back(chatMessage);
-
-      std::shared_ptr<NewMessagesNotify> newMessagesNotify =
-        std::make_shared<NewMessagesNotify>(m_ProfileId);
-      newMessagesNotify->success = true;
-      newMessagesNotify->chatId = StrUtil::NumToHex(message->chat_id_);
-      newMessagesNotify->chatMessages = chatMessages;
-      newMessagesNotify->cached = false;
-      newMessagesNotify->sequence = true;
-      CallMessageHandler(newMessagesNotify);
+      QueueNewMessage(message->chat_id_, std::move(chatMessage));
     }
   },
   [this](td::td_api::updateMessageSendSucceeded& update_message_send_succeeded)
@@ -1354,13 +2143,13 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
     TdMessageConvert(*message, chatMessage);
 
     std::vector<ChatMessage> chatMessages;
-    chatMessages.push_back(chatMessage);
+    chatMessages.push_back(std::move(chatMessage));
 
     std::shared_ptr<NewMessagesNotify> newMessagesNotify =
       std::make_shared<NewMessagesNotify>(m_ProfileId);
     newMessagesNotify->success = true;
     newMessagesNotify->chatId = StrUtil::NumToHex(message->chat_id_);
-    newMessagesNotify->chatMessages = chatMessages;
+    newMessagesNotify->chatMessages = std::move(chatMessages);
     newMessagesNotify->cached = false;
     newMessagesNotify->sequence = true;
     CallMessageHandler(newMessagesNotify);
@@ -1390,7 +2179,7 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
       }
 
       std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify =
-        std::make_shared<ReceiveTypingNotify>(m_ProfileId);
+        ObjectPool::MakeShared<ReceiveTypingNotify>(m_ProfileId);
       receiveTypingNotify->chatId = StrUtil::NumToHex(chatId);
       receiveTypingNotify->userId = StrUtil::NumToHex(userId);
       receiveTypingNotify->isTyping = isTyping;
@@ -1407,31 +2196,7 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
   {
     LOG_TRACE("chat read outbox update");
 
-    m_LastReadOutboxMessage[chat_read_outbox.chat_id_] =
-      chat_read_outbox.last_read_outbox_message_id_;
-
-    std::set<int64_t>& unreadMessages = m_UnreadOutboxMessages[chat_read_outbox.chat_id_];
-    if (!unreadMessages.empty())
-    {
-      for (auto it = unreadMessages.begin(); it != unreadMessages.end(); /* increment in loop */)
-      {
-        if (*it <= chat_read_outbox.last_read_outbox_message_id_)
-        {
-          std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
-            std::make_shared<NewMessageStatusNotify>(m_ProfileId);
-          newMessageStatusNotify->chatId = StrUtil::NumToHex(chat_read_outbox.chat_id_);
-          newMessageStatusNotify->msgId = StrUtil::NumToHex(*it);
-          newMessageStatusNotify->isRead = true;
-          CallMessageHandler(newMessageStatusNotify);
-
-          it = unreadMessages.erase(it);
-        }
-        else
-        {
-          it = std::next(it);
-        }
-      }
-    }
+    UpdateLastReadOutboxMessage(chat_read_outbox.chat_id_, chat_read_outbox.last_read_outbox_message_id_);
   },
   [this](td::td_api::updateChatReadInbox& chat_read_inbox)
   {
@@ -1444,17 +2209,16 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
 
     LOG_TRACE("delete messages update");
 
-    std::string chatId = StrUtil::NumToHex(delete_messages.chat_id_);
-    std::vector<std::int64_t> msgIds = delete_messages.message_ids_;
-    for (const auto& msgId : msgIds)
+    std::shared_ptr<DeleteMessagesNotify> deleteMessagesNotify =
+      std::make_shared<DeleteMessagesNotify>(m_ProfileId);
+    deleteMessagesNotify->success = true;
+    deleteMessagesNotify->chatId = StrUtil::NumToHex(delete_messages.chat_id_);
+    for (const auto& msgId : delete_messages.message_ids_)
     {
-      std::shared_ptr<DeleteMessageNotify> deleteMessageNotify =
-        std::make_shared<DeleteMessageNotify>(m_ProfileId);
-      deleteMessageNotify->success = true;
-      deleteMessageNotify->chatId = chatId;
-      deleteMessageNotify->msgId = StrUtil::NumToHex(msgId);
-      CallMessageHandler(deleteMessageNotify);
+      deleteMessagesNotify->msgIds.push_back(StrUtil::NumToHex(msgId));
     }
+
+    CallMessageHandler(deleteMessagesNotify);
   },
   [this](td::td_api::updateConnectionState& connection_state)
   {
@@ -1608,9 +2372,13 @@ void TgChat::Impl::ProcessUpdate(td::td_api::object_ptr<td::td_api::Object> upda
   {
     LOG_TRACE("update saved animations");
   },
-  [](td::td_api::updateFile&)
+  [this](td::td_api::updateFile& update_file)
   {
     LOG_TRACE("update file");
+    if (!update_file.file_) return;
+
+    UpdateDownload(*update_file.file_);
+    UpdateUpload(*update_file.file_);
   },
   [](auto& anyupdate)
   {
@@ -1663,7 +2431,7 @@ void TgChat::Impl::ProcessStatusUpdate(int64_t p_UserId,
   }
 
   std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify =
-    std::make_shared<ReceiveStatusNotify>(m_ProfileId);
+    ObjectPool::MakeShared<ReceiveStatusNotify>(m_ProfileId);
   receiveStatusNotify->userId = StrUtil::NumToHex(p_UserId);
   receiveStatusNotify->isOnline = isOnline;
   receiveStatusNotify->timeSeen = timeSeen;
@@ -1696,6 +2464,15 @@ void TgChat::Impl::OnAuthStateUpdate()
     }
     else
     {
+      int threadCount = 0;
+      int64_t rssKb = 0;
+      if (SysUtil::GetProcessStats(threadCount, rssKb))
+      {
+        LOG_INFO("profile %s ready, process threads %d (%+d) rss %lld kb (%+lld kb), shared request workers %d",
+                 m_ProfileId.c_str(), threadCount, threadCount - m_LoginThreadCount, (long long)rssKb,
+                 (long long)(rssKb - m_LoginRssKb), TdRequestPool::GetWorkerCount());
+      }
+
       SendQuery(td::td_api::make_object<td::td_api::getMe>(),
       [this](Object object)
       {
@@ -1721,7 +2498,7 @@ void TgChat::Impl::OnAuthStateUpdate()
       connectNotify->success = true;
 
       std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-        std::make_shared<DeferNotifyRequest>();
+        ObjectPool::MakeShared<DeferNotifyRequest>();
       deferNotifyRequest->serviceMessage = connectNotify;
       SendRequest(deferNotifyRequest);
     }
@@ -1870,9 +2647,14 @@ void TgChat::Impl::SendQuery(td::td_api::object_ptr<td::td_api::Function> f,
   auto query_id = GetNextQueryId();
   if (handler)
   {
-    m_Handlers.emplace(query_id, std::move(handler));
+    std::unique_lock<std::mutex> lock(m_HandlersMutex);
+    QueryHandler& queryHandler = m_Handlers[query_id];
+    queryHandler.handler = std::move(handler);
+    queryHandler.sendTime = TimeUtil::GetCurrentTimeMSec();
+    m_HandlersMaxCount = std::max(m_HandlersMaxCount, m_Handlers.size());
+    PerfStats::Add(PerfStats::StatTdQueriesInFlight, 1);
   }
-  m_Client->send({ query_id, std::move(f) });
+  TdClientManager::Send(m_ClientId, query_id, std::move(f));
 }
 
 void TgChat::Impl::CheckAuthError(Object object)
@@ -1956,11 +2738,63 @@ std::string TgChat::Impl::GetText(td::td_api::object_ptr<td::td_api::formattedTe
 {
   if (!p_FormattedText) return "";
 
-  std::string text = p_FormattedText->text_;
+  // text is moved out of the td object, which is discarded after conversion
   static const bool markdownEnabled = (m_Config.Get("markdown_enabled") == "1");
   static const int32_t markdownVersion = (m_Config.Get("markdown_version") == "1") ? 1 : 2;
-  if (markdownEnabled)
+  if (!markdownEnabled || p_FormattedText->entities_.empty()) return std::move(p_FormattedText->text_);
+
+  // render natively, falling back to tdlib for entities not representable as nested markup
+  std::vector<TgMarkdown::Entity> entities;
+  for (const auto& textEntity : p_FormattedText->entities_)
+  {
+    if (!textEntity || !textEntity->type_) continue;
+
+    TgMarkdown::Entity entity;
+    entity.offset = textEntity->offset_;
+    entity.length = textEntity->length_;
+    switch (textEntity->type_->get_id())
+    {
+      case td::td_api::textEntityTypeBold::ID:
+        entity.type = TgMarkdown::EntityBold;
+        break;
+
+      case td::td_api::textEntityTypeItalic::ID:
+        entity.type = TgMarkdown::EntityItalic;
+        break;
+
+      case td::td_api::textEntityTypeStrikethrough::ID:
+        entity.type = TgMarkdown::EntityStrikethrough;
+        break;
+
+      case td::td_api::textEntityTypeCode::ID:
+        entity.type = TgMarkdown::EntityCode;
+        break;
+
+      case td::td_api::textEntityTypePre::ID:
+        entity.type = TgMarkdown::EntityPre;
+        break;
+
+      case td::td_api::textEntityTypePreCode::ID:
+        entity.type = TgMarkdown::EntityPre;
+        entity.arg = static_cast<const td::td_api::textEntityTypePreCode&>(*textEntity->type_).language_;
+        break;
+
+      case td::td_api::textEntityTypeTextUrl::ID:
+        entity.type = TgMarkdown::EntityTextUrl;
+        entity.arg = static_cast<const td::td_api::textEntityTypeTextUrl&>(*textEntity->type_).url_;
+        break;
+
+      default: // other entities have no markdown representation, and are kept as plain text
+        continue;
+    }
+
+    entities.push_back(std::move(entity));
+  }
+
+  std::string text;
+  if (!TgMarkdown::Render(p_FormattedText->text_, std::move(entities), markdownVersion, text))
   {
+    text = p_FormattedText->text_;
     auto getMarkdownText = td::td_api::make_object<td::td_api::getMarkdownText>(std::move(p_FormattedText));
     td::Client::Request parseRequest{ 2, std::move(getMarkdownText) };
     auto parseResponse = td::Client::execute(std::move(parseRequest));
@@ -1989,7 +2823,7 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   else if (p_TdMessageContent.get_id() == td::td_api::messageAnimatedEmoji::ID)
   {
     auto& messageAnimatedEmoji = static_cast<td::td_api::messageAnimatedEmoji&>(p_TdMessageContent);
-    p_Text = messageAnimatedEmoji.emoji_;
+    p_Text = std::move(messageAnimatedEmoji.emoji_);
   }
   else if (p_TdMessageContent.get_id() == td::td_api::messageAnimation::ID)
   {
@@ -1999,20 +2833,20 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   {
     auto& messageAudio = static_cast<td::td_api::messageAudio&>(p_TdMessageContent);
 
-    std::string id = messageAudio.audio_->audio_->remote_->id_;
-    std::string path = messageAudio.audio_->audio_->local_->path_;
-    std::string fileName = messageAudio.audio_->file_name_;
+    std::string id = std::move(messageAudio.audio_->audio_->remote_->id_);
+    std::string path = std::move(messageAudio.audio_->audio_->local_->path_);
+    std::string fileName = std::move(messageAudio.audio_->file_name_);
     p_Text = GetText(std::move(messageAudio.caption_));
     FileInfo fileInfo;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(id);
     if (!path.empty())
     {
-      fileInfo.filePath = path;
+      fileInfo.filePath = std::move(path);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
     {
-      fileInfo.filePath = fileName;
+      fileInfo.filePath = std::move(fileName);
       fileInfo.fileStatus = FileStatusNotDownloaded;
     }
 
@@ -2050,20 +2884,20 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   {
     auto& messageDocument = static_cast<td::td_api::messageDocument&>(p_TdMessageContent);
 
-    std::string id = messageDocument.document_->document_->remote_->id_;
-    std::string path = messageDocument.document_->document_->local_->path_;
-    std::string fileName = messageDocument.document_->file_name_;
+    std::string id = std::move(messageDocument.document_->document_->remote_->id_);
+    std::string path = std::move(messageDocument.document_->document_->local_->path_);
+    std::string fileName = std::move(messageDocument.document_->file_name_);
     p_Text = GetText(std::move(messageDocument.caption_));
     FileInfo fileInfo;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(id);
     if (!path.empty())
     {
-      fileInfo.filePath = path;
+      fileInfo.filePath = std::move(path);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
     {
-      fileInfo.filePath = fileName;
+      fileInfo.filePath = std::move(fileName);
       fileInfo.fileStatus = FileStatusNotDownloaded;
     }
 
@@ -2082,17 +2916,20 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
       auto& localFile = photoFile->local_;
       auto& localPath = localFile->path_;
       FileInfo fileInfo;
-      std::string id = photoFile->remote_->id_;
-      fileInfo.fileId = id;
+      fileInfo.fileId = std::move(photoFile->remote_->id_);
       if (!localPath.empty())
       {
-        fileInfo.filePath = localPath;
+        fileInfo.filePath = std::move(localPath);
         fileInfo.fileStatus = FileStatusDownloaded;
       }
       else
       {
         fileInfo.filePath = "[Photo]";
         fileInfo.fileStatus = FileStatusNotDownloaded;
+        if (photo->minithumbnail_)
+        {
+          PreviewStore::Add(m_ProfileId, fileInfo.fileId, photo->minithumbnail_->data_);
+        }
       }
 
       p_FileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
@@ -2106,17 +2943,16 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   {
     auto& messageSticker = static_cast<td::td_api::messageSticker&>(p_TdMessageContent);
     auto& sticker = messageSticker.sticker_;
-    p_Text = sticker->emoji_;
+    p_Text = std::move(sticker->emoji_);
 
     auto& stickerFile = sticker->sticker_;
     auto& localFile = stickerFile->local_;
     auto& localPath = localFile->path_;
     FileInfo fileInfo;
-    std::string id = stickerFile->remote_->id_;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(stickerFile->remote_->id_);
     if (!localPath.empty())
     {
-      fileInfo.filePath = localPath;
+      fileInfo.filePath = std::move(localPath);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
@@ -2137,17 +2973,20 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
     auto& localFile = videoFile->local_;
     auto& localPath = localFile->path_;
     FileInfo fileInfo;
-    std::string id = videoFile->remote_->id_;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(videoFile->remote_->id_);
     if (!localPath.empty())
     {
-      fileInfo.filePath = localPath;
+      fileInfo.filePath = std::move(localPath);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
     {
       fileInfo.filePath = "[Video]";
       fileInfo.fileStatus = FileStatusNotDownloaded;
+      if (video->minithumbnail_)
+      {
+        PreviewStore::Add(m_ProfileId, fileInfo.fileId, video->minithumbnail_->data_);
+      }
     }
 
     p_FileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
@@ -2161,11 +3000,10 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
     auto& localFile = videoFile->local_;
     auto& localPath = localFile->path_;
     FileInfo fileInfo;
-    std::string id = videoFile->remote_->id_;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(videoFile->remote_->id_);
     if (!localPath.empty())
     {
-      fileInfo.filePath = localPath;
+      fileInfo.filePath = std::move(localPath);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
@@ -2180,14 +3018,14 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   {
     auto& messageVoiceNote = static_cast<td::td_api::messageVoiceNote&>(p_TdMessageContent);
 
-    std::string id = messageVoiceNote.voice_note_->voice_->remote_->id_;
-    std::string path = messageVoiceNote.voice_note_->voice_->local_->path_;
+    std::string id = std::move(messageVoiceNote.voice_note_->voice_->remote_->id_);
+    std::string path = std::move(messageVoiceNote.voice_note_->voice_->local_->path_);
     p_Text = GetText(std::move(messageVoiceNote.caption_));
     FileInfo fileInfo;
-    fileInfo.fileId = id;
+    fileInfo.fileId = std::move(id);
     if (!path.empty())
     {
-      fileInfo.filePath = path;
+      fileInfo.filePath = std::move(path);
       fileInfo.fileStatus = FileStatusDownloaded;
     }
     else
@@ -2205,7 +3043,7 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   else if (p_TdMessageContent.get_id() == td::td_api::messageChatAddMembers::ID)
   {
     auto& messageChatAddMembers = static_cast<td::td_api::messageChatAddMembers&>(p_TdMessageContent);
-    auto ids = messageChatAddMembers.member_user_ids_;
+    const auto& ids = messageChatAddMembers.member_user_ids_;
 
     if ((ids.size() == 1) && (ids.at(0) == p_SenderId))
     {
@@ -2238,7 +3076,7 @@ void TgChat::Impl::TdMessageContentConvert(td::td_api::MessageContent& p_TdMessa
   else if (p_TdMessageContent.get_id() == td::td_api::messageChatChangeTitle::ID)
   {
     auto& messageChatChangeTitle = static_cast<td::td_api::messageChatChangeTitle&>(p_TdMessageContent);
-    auto title = messageChatChangeTitle.title_;
+    const std::string& title = messageChatChangeTitle.title_;
     p_Text = "[Changed group name to " + title + "]";
   }
   else if (p_TdMessageContent.get_id() == td::td_api::messageChatUpgradeFrom::ID)
@@ -2281,7 +3119,8 @@ void TgChat::Impl::TdMessageConvert(td::td_api::message& p_TdMessage, ChatMessag
   p_ChatMessage.id = StrUtil::NumToHex(p_TdMessage.id_);
   p_ChatMessage.senderId = StrUtil::NumToHex(senderId);
   p_ChatMessage.isOutgoing = p_TdMessage.is_outgoing_;
-  p_ChatMessage.timeSent = (((int64_t)p_TdMessage.date_) * 1000) + (std::hash<std::string>{ }(p_ChatMessage.id) % 256);
+  p_ChatMessage.timeSent = ((int64_t)p_TdMessage.date_) * 1000;
+  p_ChatMessage.sequence = p_TdMessage.id_; // message ids increase within a chat
 
   if (p_TdMessage.reply_to_ && (p_TdMessage.reply_to_->get_id() == td::td_api::messageReplyToMessage::ID))
   {
@@ -2300,14 +3139,28 @@ void TgChat::Impl::TdMessageConvert(td::td_api::message& p_TdMessage, ChatMessag
     p_ChatMessage.isRead = (p_TdMessage.id_ <= m_LastReadOutboxMessage[p_TdMessage.chat_id_]);
     if (!p_ChatMessage.isRead)
     {
-      m_UnreadOutboxMessages[p_TdMessage.chat_id_].insert(p_TdMessage.id_);
+      // new messages typically have the highest id, and are appended
+      std::vector<int64_t>& unreadMessages = m_UnreadOutboxMessages[p_TdMessage.chat_id_];
+      if (unreadMessages.empty() || (unreadMessages.back() < p_TdMessage.id_))
+      {
+        unreadMessages.push_back(p_TdMessage.id_);
+      }
+      else
+      {
+        auto it = std::lower_bound(unreadMessages.begin(), unreadMessages.end(), p_TdMessage.id_);
+        if (*it != p_TdMessage.id_)
+        {
+          unreadMessages.insert(it, p_TdMessage.id_);
+        }
+      }
     }
   }
   else
   {
-    if (m_LastReadInboxMessage.count(p_TdMessage.chat_id_) > 0)
+    auto it = m_LastReadInboxMessage.find(p_TdMessage.chat_id_);
+    if (it != m_LastReadInboxMessage.end())
     {
-      p_ChatMessage.isRead = (p_TdMessage.id_ <= m_LastReadInboxMessage[p_TdMessage.chat_id_]);
+      p_ChatMessage.isRead = (p_TdMessage.id_ <= it->second);
     }
     else
     {
@@ -2318,61 +3171,285 @@ void TgChat::Impl::TdMessageConvert(td::td_api::message& p_TdMessage, ChatMessag
 
 void TgChat::Impl::DownloadFile(std::string p_ChatId, std::string p_MsgId, std::string p_FileId,
                                 std::string p_DownloadId,
-                                DownloadFileAction p_DownloadFileAction)
+                                DownloadFileAction p_DownloadFileAction,
+                                DownloadFilePriority p_DownloadFilePriority)
 {
-  LOG_DEBUG("download file %s %s", p_FileId.c_str(), p_DownloadId.c_str());
-  try
+  LOG_DEBUG("download file %s %s prio %d", p_FileId.c_str(), p_DownloadId.c_str(), p_DownloadFilePriority);
+
+  // tdlib priority 1-32, user-initiated downloads highest
+  static const int32_t tdPriorities[DownloadFilePriorityCount] = { 1, 16, 32 };
+  const int32_t tdPriority = tdPriorities[p_DownloadFilePriority];
+  const int32_t tdFileId = StrUtil::NumFromHex<std::int32_t>(p_DownloadId);
+  const bool isUser = (p_DownloadFilePriority == DownloadFilePriorityUser);
+
   {
-    auto download_file = td::td_api::make_object<td::td_api::downloadFile>();
-    download_file->file_id_ = StrUtil::NumFromHex<std::int32_t>(p_DownloadId);
-    download_file->priority_ = 32;
-    download_file->synchronous_ = true;
-    SendQuery(std::move(download_file),
-              [this, p_ChatId, p_MsgId, p_FileId, p_DownloadFileAction](Object object)
+    // the same file referenced by several messages is only downloaded once
+    std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+    Download& download = m_Downloads[tdFileId];
+    const bool isNew = download.waiters.empty();
+    download.waiters.push_back(DownloadWaiter{ p_ChatId, p_MsgId, p_FileId, p_DownloadFileAction });
+    if (!isNew && (download.started || download.userQueued || !isUser))
     {
-      if (object->get_id() == td::td_api::error::ID) return;
+      LOG_DEBUG("download file %s joined, %d waiters", p_DownloadId.c_str(), (int)download.waiters.size());
+      return;
+    }
 
-      if (object->get_id() == td::td_api::file::ID)
-      {
-        auto file_ = td::move_tl_object_as<td::td_api::file>(object);
-        std::string path = file_->local_->path_;
+    // a user request for a file queued as background is also queued with user priority
+    ++download.queuedCount;
+    download.userQueued = download.userQueued || isUser;
+  }
 
-        FileInfo fileInfo;
-        fileInfo.fileStatus = FileStatusDownloaded;
-        fileInfo.filePath = path;
-        fileInfo.fileId = p_FileId;
+  // *INDENT-OFF*
+  auto job = [this, tdFileId, tdPriority]() -> int64_t
+  {
+    std::shared_ptr<std::promise<int64_t>> promise = std::make_shared<std::promise<int64_t>>();
+    std::future<int64_t> future = promise->get_future();
+    {
+      std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+      auto it = m_Downloads.find(tdFileId);
+      if (it == m_Downloads.end()) return 0;
+
+      --it->second.queuedCount;
+      if (it->second.started) return 0;
+
+      it->second.started = true;
+      it->second.promise = promise;
+    }
+
+    StartDownload(tdFileId, tdPriority);
+
+    // blocks scheduler thread until download completes or profile is stopped
+    while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+    {
+      if (!m_Running) return 0;
+    }
+
+    return future.get();
+  };
+
+  auto cancelHandler = [this, tdFileId]()
+  {
+    std::vector<DownloadWaiter> waiters;
+    {
+      std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+      auto it = m_Downloads.find(tdFileId);
+      if (it == m_Downloads.end()) return;
+
+      if ((--it->second.queuedCount > 0) || it->second.started) return;
+
+      waiters = std::move(it->second.waiters);
+      m_Downloads.erase(it);
+    }
+
+    // reset file status, allowing download to be requested again
+    for (const auto& waiter : waiters)
+    {
+      FileInfo fileInfo;
+      fileInfo.fileStatus = FileStatusNotDownloaded;
+      fileInfo.fileId = waiter.fileId;
+
+      std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
+        std::make_shared<NewMessageFileNotify>(m_ProfileId);
+      newMessageFileNotify->chatId = waiter.chatId;
+      newMessageFileNotify->msgId = waiter.msgId;
+      newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+      newMessageFileNotify->downloadFileAction = DownloadFileActionNone;
+
+      CallMessageHandler(newMessageFileNotify);
+    }
+  };
+  // *INDENT-ON*
+
+  m_DownloadScheduler.Enqueue(p_ChatId, p_DownloadFilePriority, job, cancelHandler);
+}
+
+void TgChat::Impl::StartDownload(int32_t p_TdFileId, int32_t p_TdPriority)
+{
+  auto download_file = td::td_api::make_object<td::td_api::downloadFile>();
+  download_file->file_id_ = p_TdFileId;
+  download_file->priority_ = p_TdPriority;
+  download_file->synchronous_ = false;
+
+  // *INDENT-OFF*
+  SendQuery(std::move(download_file),
+  [this, p_TdFileId](Object object)
+  {
+    if (object->get_id() == td::td_api::error::ID)
+    {
+      auto error = td::move_tl_object_as<td::td_api::error>(object);
+      LOG_WARNING("download file %d failed %s", p_TdFileId, error->message_.c_str());
+      FinishDownload(p_TdFileId, FileStatusDownloadFailed, "", 0);
+      return;
+    }
+
+    if (object->get_id() != td::td_api::file::ID) return;
+
+    // already downloaded files are returned completed, others are tracked through updateFile
+    auto file_ = td::move_tl_object_as<td::td_api::file>(object);
+    UpdateDownload(*file_);
+  });
+  // *INDENT-ON*
+}
+
+void TgChat::Impl::UpdateDownload(td::td_api::file& p_File)
+{
+  if (!p_File.local_) return;
+
+  const int32_t tdFileId = p_File.id_;
+  const td::td_api::localFile& localFile = *p_File.local_;
+  if (localFile.is_downloading_completed_)
+  {
+    FinishDownload(tdFileId, FileStatusDownloaded, localFile.path_, localFile.downloaded_size_);
+    return;
+  }
+
+  std::vector<DownloadWaiter> waiters;
+  const int64_t totalBytes = (p_File.size_ > 0) ? p_File.size_ : p_File.expected_size_;
+  {
+    std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+    auto it = m_Downloads.find(tdFileId);
+    if ((it == m_Downloads.end()) || !it->second.started) return;
+
+    if (!localFile.is_downloading_active_)
+    {
+      lock.unlock();
+      LOG_WARNING("download file %d stopped", tdFileId);
+      FinishDownload(tdFileId, FileStatusDownloadFailed, "", 0);
+      return;
+    }
 
-        std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
-          std::make_shared<NewMessageFileNotify>(m_ProfileId);
-        newMessageFileNotify->chatId = std::string(p_ChatId);
-        newMessageFileNotify->msgId = std::string(p_MsgId);
-        newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
-        newMessageFileNotify->downloadFileAction = p_DownloadFileAction;
+    // progress is reported on whole percent changes only
+    if (totalBytes <= 0) return;
 
-        CallMessageHandler(newMessageFileNotify);
+    const int percent = (int)std::min<int64_t>((localFile.downloaded_size_ * 100) / totalBytes, 100);
+    if (percent == it->second.lastPercent) return;
+
+    it->second.lastPercent = percent;
+    waiters = it->second.waiters;
+  }
+
+  for (const auto& waiter : waiters)
+  {
+    std::shared_ptr<NewMessageFileProgressNotify> newMessageFileProgressNotify =
+      std::make_shared<NewMessageFileProgressNotify>(m_ProfileId);
+    newMessageFileProgressNotify->chatId = waiter.chatId;
+    newMessageFileProgressNotify->msgId = waiter.msgId;
+    newMessageFileProgressNotify->downloadedBytes = localFile.downloaded_size_;
+    newMessageFileProgressNotify->totalBytes = totalBytes;
+    CallMessageHandler(newMessageFileProgressNotify);
+  }
+}
+
+void TgChat::Impl::FinishDownload(int32_t p_TdFileId, FileStatus p_FileStatus, const std::string& p_Path,
+                                  int64_t p_Size)
+{
+  Download download;
+  {
+    std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+    auto it = m_Downloads.find(p_TdFileId);
+    if ((it == m_Downloads.end()) || !it->second.started) return;
+
+    download = std::move(it->second);
+    m_Downloads.erase(it);
+  }
+
+  for (const auto& waiter : download.waiters)
+  {
+    FileInfo fileInfo;
+    fileInfo.fileStatus = p_FileStatus;
+    fileInfo.filePath = p_Path;
+    fileInfo.fileId = waiter.fileId;
+
+    std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
+      std::make_shared<NewMessageFileNotify>(m_ProfileId);
+    newMessageFileNotify->chatId = waiter.chatId;
+    newMessageFileNotify->msgId = waiter.msgId;
+    newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+    newMessageFileNotify->downloadFileAction =
+      (p_FileStatus == FileStatusDownloaded) ? waiter.downloadFileAction : DownloadFileActionNone;
+
+    CallMessageHandler(newMessageFileNotify);
+  }
+
+  if (download.promise)
+  {
+    download.promise->set_value(p_Size);
+  }
+}
+
+void TgChat::Impl::CancelDownloads()
+{
+  // active downloads are cancelled in tdlib, so they do not continue in the background
+  std::vector<int32_t> tdFileIds;
+  {
+    std::unique_lock<std::mutex> lock(m_DownloadsMutex);
+    for (const auto& download : m_Downloads)
+    {
+      if (download.second.started)
+      {
+        tdFileIds.push_back(download.first);
       }
-    });
+    }
+
+    m_Downloads.clear();
+  }
+
+  for (const auto& tdFileId : tdFileIds)
+  {
+    LOG_DEBUG("cancel download file %d", tdFileId);
+    SendQuery(td::td_api::make_object<td::td_api::cancelDownloadFile>(tdFileId, false), nullptr);
+  }
+}
+
+void TgChat::Impl::UpdateUpload(td::td_api::file& p_File)
+{
+  if (!p_File.remote_) return;
+
+  const int32_t tdFileId = p_File.id_;
+  const int64_t uploadedBytes = p_File.remote_->uploaded_size_;
+  const int64_t totalBytes = (p_File.size_ > 0) ? p_File.size_ : p_File.expected_size_;
+  std::unique_lock<std::mutex> lock(m_UploadsMutex);
+  auto it = m_Uploads.find(tdFileId);
+  if (p_File.remote_->is_uploading_active_)
+  {
+    if (it == m_Uploads.end())
+    {
+      LOG_DEBUG("upload file %d started", tdFileId);
+      Status::Set(Status::FlagUploading);
+      it = m_Uploads.insert(std::make_pair(tdFileId, Upload())).first;
+    }
+
+    Status::AddUploadBytes(uploadedBytes - it->second.uploadedBytes, totalBytes - it->second.totalBytes);
+    it->second.uploadedBytes = uploadedBytes;
+    it->second.totalBytes = totalBytes;
+  }
+  else if (it != m_Uploads.end())
+  {
+    LOG_DEBUG("upload file %d %s", tdFileId, p_File.remote_->is_uploading_completed_ ? "completed" : "stopped");
+    Status::AddUploadBytes(-it->second.uploadedBytes, -it->second.totalBytes);
+    Status::Clear(Status::FlagUploading);
+    m_Uploads.erase(it);
   }
-  catch (...)
+}
+
+void TgChat::Impl::ClearUploads()
+{
+  std::unique_lock<std::mutex> lock(m_UploadsMutex);
+  for (const auto& upload : m_Uploads)
   {
+    Status::AddUploadBytes(-upload.second.uploadedBytes, -upload.second.totalBytes);
+    Status::Clear(Status::FlagUploading);
   }
+
+  m_Uploads.clear();
 }
 
 void TgChat::Impl::RequestSponsoredMessagesIfNeeded()
 {
   if (m_ChatTypes[m_CurrentChat] != ChatSuperGroupChannel) return;
 
-#ifdef SIMULATED_SPONSORED_MESSAGES
-  const int64_t intervalTime = 10 * 1000; // 10 sec
-#else
-  const int64_t intervalTime = 5 * 60 * 1000; // 5 min
-#endif
-  static std::map<int64_t, int64_t> lastTime;
-  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
-
-  if ((nowTime - lastTime[m_CurrentChat]) >= intervalTime)
+  if (m_SponsoredMessagesRequests.TryBegin(m_CurrentChat, TimeUtil::GetCurrentTimeMSec()))
   {
-    lastTime[m_CurrentChat] = nowTime;
     std::shared_ptr<DeferGetSponsoredMessagesRequest> deferGetSponsoredMessagesRequest =
       std::make_shared<DeferGetSponsoredMessagesRequest>();
     deferGetSponsoredMessagesRequest->chatId = StrUtil::NumToHex(m_CurrentChat);
@@ -2449,7 +3526,7 @@ void TgChat::Impl::GetSponsoredMessages(const std::string& p_ChatId)
   std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(m_ProfileId);
   newMessagesNotify->success = true;
   newMessagesNotify->chatId = p_ChatId;
-  newMessagesNotify->chatMessages = chatMessages;
+  newMessagesNotify->chatMessages = std::move(chatMessages);
   newMessagesNotify->fromMsgId = "";
   newMessagesNotify->cached = true; // do not cache sponsored messages
   newMessagesNotify->sequence = false;
@@ -2553,7 +3630,7 @@ void TgChat::Impl::GetSponsoredMessages(const std::string& p_ChatId)
     std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(m_ProfileId);
     newMessagesNotify->success = true;
     newMessagesNotify->chatId = p_ChatId;
-    newMessagesNotify->chatMessages = chatMessages;
+    newMessagesNotify->chatMessages = std::move(chatMessages);
     newMessagesNotify->fromMsgId = "";
     newMessagesNotify->cached = true; // do not cache sponsored messages
     newMessagesNotify->sequence = false;
@@ -2625,51 +3702,533 @@ std::string TgChat::Impl::GetContactName(int64_t p_UserId)
 }
 
 void TgChat::Impl::GetChatHistory(int64_t p_ChatId, int64_t p_FromMsgId, int32_t p_Offset, int32_t p_Limit,
-                                  bool p_Sequence)
+                                  bool p_Sequence, bool p_OnlyLocal)
 {
   // *INDENT-OFF*
   Status::Set(Status::FlagFetching);
   SendQuery(td::td_api::make_object<td::td_api::getChatHistory>(p_ChatId, p_FromMsgId, p_Offset,
-                                                                p_Limit, false),
-  [this, p_ChatId, p_FromMsgId, p_Offset, p_Sequence](Object object)
+                                                                p_Limit, p_OnlyLocal),
+  [this, p_ChatId, p_FromMsgId, p_Offset, p_Limit, p_Sequence, p_OnlyLocal](Object object)
   {
     Status::Clear(Status::FlagFetching);
 
-    if (object->get_id() == td::td_api::error::ID) return;
+    // tdlib database lacks the requested range, fetch it from server, which also stores it locally
+    const bool isError = (object->get_id() == td::td_api::error::ID);
+    if (p_OnlyLocal &&
+        (isError || static_cast<const td::td_api::messages&>(*object).messages_.empty()))
+    {
+      LOG_DEBUG("Get local history miss %lld from %lld", (long long)p_ChatId, (long long)p_FromMsgId);
+      GetChatHistory(p_ChatId, p_FromMsgId, p_Offset, p_Limit, p_Sequence, false /* p_OnlyLocal */);
+      return;
+    }
+
+    if (isError) return;
 
     auto messages = td::move_tl_object_as<td::td_api::messages>(object);
 
     std::vector<ChatMessage> chatMessages;
+    chatMessages.reserve(messages->messages_.size());
     for (auto it = messages->messages_.begin(); it != messages->messages_.end(); ++it)
     {
       auto message = td::move_tl_object_as<td::td_api::message>(*it);
       ChatMessage chatMessage;
       TdMessageConvert(*message, chatMessage);
-      chatMessages.push_back(chatMessage);
+      chatMessages.push_back(std::move(chatMessage));
     }
 
     std::shared_ptr<NewMessagesNotify> newMessagesNotify =
       std::make_shared<NewMessagesNotify>(m_ProfileId);
     newMessagesNotify->success = true;
     newMessagesNotify->chatId = StrUtil::NumToHex(p_ChatId);
-    newMessagesNotify->chatMessages = chatMessages;
+    newMessagesNotify->chatMessages = std::move(chatMessages);
     newMessagesNotify->fromMsgId = ((p_FromMsgId != 0) && (p_Offset == 0)) ? StrUtil::NumToHex(p_FromMsgId) : "";
     newMessagesNotify->sequence = p_Sequence;
-    CallMessageHandler(newMessagesNotify);
+    for (const auto& chunk : ProtocolUtil::SplitMessagesNotify(newMessagesNotify))
+    {
+      CallMessageHandler(chunk);
+    }
+  });
+  // *INDENT-ON*
+}
+
+void TgChat::Impl::GetChatsPage(std::shared_ptr<GetChatsRequest> p_GetChatsRequest, int32_t p_Offset)
+{
+  // chat list is loaded a page at a time, newest first, each page's details notified on their own so
+  // the top of the list is shown while the rest loads. loadChats fails once all chats are loaded.
+  // *INDENT-OFF*
+  SendQuery(td::td_api::make_object<td::td_api::loadChats>(nullptr, s_ChatsPageSize),
+  [this, p_GetChatsRequest, p_Offset](Object loadObject)
+  {
+    const bool isLoadedAll = (loadObject->get_id() == td::td_api::error::ID);
+    SendQuery(td::td_api::make_object<td::td_api::getChats>(nullptr, p_Offset + s_ChatsPageSize),
+    [this, p_GetChatsRequest, p_Offset, isLoadedAll](Object object)
+    {
+      if (object->get_id() == td::td_api::error::ID)
+      {
+        Status::Clear(Status::FlagFetching);
+        return;
+      }
+
+      auto chats = td::move_tl_object_as<td::td_api::chats>(object);
+      const int32_t count = static_cast<int32_t>(chats->chat_ids_.size());
+      LOG_DEBUG("get chats page %d count %d", p_Offset, count);
+
+      const bool noFilter = p_GetChatsRequest->chatIds.empty();
+      std::vector<std::string> chatIds;
+      for (int32_t i = p_Offset; i < count; ++i)
+      {
+        std::string chatIdStr = StrUtil::NumToHex(chats->chat_ids_[i]);
+        if (noFilter || p_GetChatsRequest->chatIds.count(chatIdStr))
+        {
+          chatIds.push_back(chatIdStr);
+        }
+      }
+
+      if (!chatIds.empty())
+      {
+        if (noFilter)
+        {
+          AddBackfillChats(chatIds);
+        }
+
+        std::shared_ptr<DeferGetChatDetailsRequest> deferGetChatDetailsRequest =
+          std::make_shared<DeferGetChatDetailsRequest>();
+        deferGetChatDetailsRequest->chatIds = chatIds;
+        SendRequest(deferGetChatDetailsRequest);
+      }
+
+      // local list may hold more chats than loaded from server in this call, so only stop when
+      // neither source yields more
+      if ((count > p_Offset) || !isLoadedAll)
+      {
+        GetChatsPage(p_GetChatsRequest, std::max(count, p_Offset));
+      }
+      else
+      {
+        Status::Clear(Status::FlagFetching);
+      }
+    });
+  });
+  // *INDENT-ON*
+}
+
+void TgChat::Impl::SearchServerMessages(std::shared_ptr<SearchMessagesRequest> p_SearchMessagesRequest,
+                                        const std::string& p_Offset, int p_Found)
+{
+  // pages are reported as they arrive, next page is requested until limit reached or request cancelled
+  const int32_t limit = std::min(p_SearchMessagesRequest->limit - p_Found, 100);
+  // *INDENT-OFF*
+  SendQuery(td::td_api::make_object<td::td_api::searchMessages>(nullptr, p_SearchMessagesRequest->query,
+                                                                p_Offset, limit, nullptr, 0, 0),
+  [this, p_SearchMessagesRequest, p_Found](Object object)
+  {
+    if (object->get_id() == td::td_api::error::ID)
+    {
+      LOG_WARNING("search server messages failed");
+      return;
+    }
+
+    auto foundMessages = td::move_tl_object_as<td::td_api::foundMessages>(object);
+
+    std::shared_ptr<SearchMessagesNotify> searchMessagesNotify =
+      std::make_shared<SearchMessagesNotify>(m_ProfileId);
+    searchMessagesNotify->success = true;
+    searchMessagesNotify->query = p_SearchMessagesRequest->query;
+    searchMessagesNotify->isServer = true;
+    searchMessagesNotify->requestId = p_SearchMessagesRequest->requestId;
+    searchMessagesNotify->chatMessages.reserve(foundMessages->messages_.size());
+    for (auto it = foundMessages->messages_.begin(); it != foundMessages->messages_.end(); ++it)
+    {
+      auto message = td::move_tl_object_as<td::td_api::message>(*it);
+      if (!message) continue;
+
+      ChatMessage chatMessage;
+      TdMessageConvert(*message, chatMessage);
+      searchMessagesNotify->chatMessages.push_back(std::make_pair(StrUtil::NumToHex(message->chat_id_),
+                                                                  std::move(chatMessage)));
+    }
+
+    const int found = p_Found + static_cast<int>(searchMessagesNotify->chatMessages.size());
+    LOG_DEBUG("search server messages found %d", found);
+    CallMessageHandler(searchMessagesNotify);
+
+    if ((found < p_SearchMessagesRequest->limit) && !foundMessages->next_offset_.empty() &&
+        !searchMessagesNotify->chatMessages.empty() && !p_SearchMessagesRequest->IsCancelled())
+    {
+      SearchServerMessages(p_SearchMessagesRequest, foundMessages->next_offset_, found);
+    }
+  });
+  // *INDENT-ON*
+}
+
+void TgChat::Impl::StartBackfill()
+{
+  if ((m_Config.Get("backfill_enabled") != "1") || !AppConfig::GetBool("cache_enabled")) return;
+
+  if (m_LocalHistory)
+  {
+    LOG_INFO("backfill disabled with local history");
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_BackfillMutex);
+  if (m_BackfillRunning) return;
+
+  m_BackfillConcurrency = (int)std::max(StrUtil::ToInteger(m_Config.Get("backfill_concurrency")), 1L);
+  m_BackfillIntervalMs = std::max(StrUtil::ToInteger(m_Config.Get("backfill_interval_ms")), 0L);
+  m_BackfillWindow = (int32_t)std::min(std::max(StrUtil::ToInteger(m_Config.Get("backfill_window")), 1L), 100L);
+  m_BackfillConfig = Config(m_ProfileDir + std::string("/backfill.conf"), std::map<std::string, std::string>());
+  LOG_DEBUG("backfill start concurrency %d interval %lld window %d", m_BackfillConcurrency,
+            (long long)m_BackfillIntervalMs, m_BackfillWindow);
+
+  m_BackfillRunning = true;
+  m_BackfillThread = std::thread(&TgChat::Impl::ProcessBackfill, this);
+}
+
+void TgChat::Impl::StopBackfill()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_BackfillMutex);
+    if (!m_BackfillRunning) return;
+
+    m_BackfillRunning = false;
+    m_BackfillCondVar.notify_all();
+  }
+
+  if (m_BackfillThread.joinable())
+  {
+    m_BackfillThread.join();
+  }
+
+  std::unique_lock<std::mutex> lock(m_BackfillMutex);
+  m_BackfillConfig.Save();
+  m_BackfillQueue.clear();
+  m_BackfillChats.clear();
+}
+
+void TgChat::Impl::AddBackfillChats(const std::vector<std::string>& p_ChatIds)
+{
+  std::unique_lock<std::mutex> lock(m_BackfillMutex);
+  if (!m_BackfillRunning) return;
+
+  // chats are backfilled round-robin in chat list order, one window at a time
+  for (const auto& chatIdStr : p_ChatIds)
+  {
+    const int64_t chatId = StrUtil::NumFromHex<int64_t>(chatIdStr);
+    if (m_BackfillConfig.Get(chatIdStr) == s_BackfillDone) continue;
+
+    if (m_BackfillChats.insert(chatId).second)
+    {
+      m_BackfillQueue.push_back(chatId);
+    }
+  }
+
+  m_BackfillCondVar.notify_all();
+}
+
+void TgChat::Impl::ProcessBackfill()
+{
+  ThreadRegistry::Register("td-backfill");
+  // requests are issued only when the thread gets cpu, so backfill yields to interactive work
+  BackgroundExecutor::SetThreadClass(BackgroundExecutor::ClassIdle);
+
+  std::unique_lock<std::mutex> lock(m_BackfillMutex);
+  while (m_BackfillRunning)
+  {
+    if (m_BackfillQueue.empty() || (m_BackfillInFlight >= m_BackfillConcurrency))
+    {
+      m_BackfillCondVar.wait(lock);
+      continue;
+    }
+
+    // rate limit requests across all chats
+    const int64_t waitMs = (m_BackfillTime + m_BackfillIntervalMs) - TimeUtil::GetCurrentTimeMSec();
+    if (waitMs > 0)
+    {
+      m_BackfillCondVar.wait_for(lock, std::chrono::milliseconds(waitMs));
+      continue;
+    }
+
+    // hold off while the cache writer is behind, rechecking for stop between waits
+    lock.unlock();
+    const bool hasQueueSpace = MessageCache::WaitQueueSpace(m_ProfileId, s_BackfillQueueWaitMs);
+    lock.lock();
+    if (!hasQueueSpace || !m_BackfillRunning || m_BackfillQueue.empty()) continue;
+
+    const int64_t chatId = m_BackfillQueue.front();
+    m_BackfillQueue.pop_front();
+    const std::string watermark = m_BackfillConfig.Get(StrUtil::NumToHex(chatId));
+    const int64_t fromMsgId = watermark.empty() ? 0 : StrUtil::NumFromHex<int64_t>(watermark);
+    ++m_BackfillInFlight;
+    m_BackfillTime = TimeUtil::GetCurrentTimeMSec();
+
+    lock.unlock();
+    GetBackfillHistory(chatId, fromMsgId);
+    lock.lock();
+  }
+}
+
+void TgChat::Impl::GetBackfillHistory(int64_t p_ChatId, int64_t p_FromMsgId)
+{
+  // *INDENT-OFF*
+  SendQuery(td::td_api::make_object<td::td_api::getChatHistory>(p_ChatId, p_FromMsgId, 0, m_BackfillWindow, false),
+  [this, p_ChatId, p_FromMsgId](Object object)
+  {
+    const std::string chatIdStr = StrUtil::NumToHex(p_ChatId);
+    std::shared_ptr<std::vector<ChatMessage>> chatMessagesPtr = std::make_shared<std::vector<ChatMessage>>();
+    std::vector<ChatMessage>& chatMessages = *chatMessagesPtr;
+    int64_t oldestMsgId = p_FromMsgId;
+    const bool isError = (object->get_id() == td::td_api::error::ID);
+    if (!isError)
+    {
+      auto messages = td::move_tl_object_as<td::td_api::messages>(object);
+      chatMessages.reserve(messages->messages_.size());
+      for (auto it = messages->messages_.begin(); it != messages->messages_.end(); ++it)
+      {
+        auto message = td::move_tl_object_as<td::td_api::message>(*it);
+        if (!message || ((p_FromMsgId != 0) && (message->id_ >= p_FromMsgId))) continue;
+
+        oldestMsgId = (oldestMsgId == 0) ? message->id_ : std::min(oldestMsgId, message->id_);
+        ChatMessage chatMessage;
+        TdMessageConvert(*message, chatMessage);
+        chatMessages.push_back(std::move(chatMessage));
+      }
+    }
+
+    if (!chatMessages.empty())
+    {
+      // stored directly in cache, ui fetches from cache when scrolling back
+      const std::string fromMsgIdStr = (p_FromMsgId != 0) ? StrUtil::NumToHex(p_FromMsgId) : "";
+      MessageCache::AddMessages(m_ProfileId, chatIdStr, fromMsgIdStr, chatMessagesPtr);
+    }
+
+    std::unique_lock<std::mutex> lock(m_BackfillMutex);
+    --m_BackfillInFlight;
+    if (isError)
+    {
+      LOG_WARNING("backfill %s failed", chatIdStr.c_str());
+      m_BackfillChats.erase(p_ChatId); // retried on next chat list refresh
+    }
+    else if (chatMessages.empty())
+    {
+      LOG_DEBUG("backfill %s done", chatIdStr.c_str());
+      m_BackfillConfig.Set(chatIdStr, s_BackfillDone);
+      m_BackfillChats.erase(p_ChatId);
+      ++m_BackfillUnsavedCount;
+    }
+    else
+    {
+      LOG_TRACE("backfill %s count %d", chatIdStr.c_str(), (int)chatMessages.size());
+      m_BackfillConfig.Set(chatIdStr, StrUtil::NumToHex(oldestMsgId));
+      ++m_BackfillUnsavedCount;
+      if (m_BackfillRunning)
+      {
+        m_BackfillQueue.push_back(p_ChatId);
+      }
+    }
+
+    if (m_BackfillUnsavedCount >= s_BackfillSaveInterval)
+    {
+      m_BackfillConfig.Save();
+      m_BackfillUnsavedCount = 0;
+    }
+
+    m_BackfillCondVar.notify_all();
   });
   // *INDENT-ON*
 }
 
+void TgChat::Impl::StartStorageOptimizer()
+{
+  std::vector<StorageBudget> storageBudgets;
+  const std::vector<std::string> entries = StrUtil::Split(m_Config.Get("storage_budget"), ',');
+  for (const auto& entry : entries)
+  {
+    const std::vector<std::string> fields = StrUtil::Split(entry, ':');
+    if (fields.empty() || fields.at(0).empty()) continue;
+
+    StorageBudget storageBudget;
+    storageBudget.fileType = fields.at(0);
+    if ((storageBudget.fileType != "all") && !GetFileType(storageBudget.fileType))
+    {
+      LOG_WARNING("storage budget unknown file type %s", storageBudget.fileType.c_str());
+      continue;
+    }
+
+    // zero or missing limit means unlimited
+    const int64_t maxMb = (fields.size() > 1) ? StrUtil::ToInteger(fields.at(1)) : 0;
+    const int64_t maxDays = (fields.size() > 2) ? StrUtil::ToInteger(fields.at(2)) : 0;
+    storageBudget.maxSize = (maxMb > 0) ? (maxMb * 1024 * 1024) : -1;
+    storageBudget.maxAge = (maxDays > 0) ? (int32_t)(maxDays * 24 * 3600) : -1;
+    if ((storageBudget.maxSize == -1) && (storageBudget.maxAge == -1)) continue;
+
+    storageBudgets.push_back(storageBudget);
+  }
+
+  if (storageBudgets.empty()) return;
+
+  std::unique_lock<std::mutex> lock(m_StorageMutex);
+  if (m_StorageRunning) return;
+
+  m_StorageBudgets = storageBudgets;
+  m_StorageIntervalMs = std::max(StrUtil::ToInteger(m_Config.Get("storage_interval_hours")), 1L) * 3600 * 1000;
+  LOG_DEBUG("storage optimizer start budgets %d interval %lld", (int)m_StorageBudgets.size(),
+            (long long)m_StorageIntervalMs);
+
+  m_StorageRunning = true;
+  m_StorageThread = std::thread(&TgChat::Impl::ProcessStorageOptimizer, this);
+}
+
+void TgChat::Impl::StopStorageOptimizer()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_StorageMutex);
+    if (!m_StorageRunning) return;
+
+    m_StorageRunning = false;
+    m_StorageCondVar.notify_all();
+  }
+
+  if (m_StorageThread.joinable())
+  {
+    m_StorageThread.join();
+  }
+}
+
+void TgChat::Impl::ProcessStorageOptimizer()
+{
+  ThreadRegistry::Register("td-storage");
+  BackgroundExecutor::SetThreadClass(BackgroundExecutor::ClassIdle);
+
+  int64_t dueTime = TimeUtil::GetCurrentTimeMSec() + s_StorageStartDelayMs;
+  std::unique_lock<std::mutex> lock(m_StorageMutex);
+  while (m_StorageRunning)
+  {
+    const int64_t waitMs = dueTime - TimeUtil::GetCurrentTimeMSec();
+    if (waitMs > 0)
+    {
+      m_StorageCondVar.wait_for(lock, std::chrono::milliseconds(waitMs));
+      continue;
+    }
+
+    // low priority, deferred while the user is interacting with nchat
+    if (AppUtil::IsTerminalActive())
+    {
+      dueTime = TimeUtil::GetCurrentTimeMSec() + s_StorageActiveRetryMs;
+      continue;
+    }
+
+    lock.unlock();
+    OptimizeStorage();
+    lock.lock();
+    dueTime = TimeUtil::GetCurrentTimeMSec() + m_StorageIntervalMs;
+  }
+}
+
+bool TgChat::Impl::WaitStorageQuery(td::td_api::object_ptr<td::td_api::Function> p_Function, Object& p_Result)
+{
+  std::shared_ptr<std::promise<Object>> promise = std::make_shared<std::promise<Object>>();
+  std::future<Object> future = promise->get_future();
+
+  // *INDENT-OFF*
+  SendQuery(std::move(p_Function),
+  [promise](Object object)
+  {
+    promise->set_value(std::move(object));
+  });
+  // *INDENT-ON*
+
+  // poll so that logout is not blocked by a long running optimization
+  const int64_t timeoutTime = TimeUtil::GetCurrentTimeMSec() + s_StorageQueryTimeoutMs;
+  while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+  {
+    std::unique_lock<std::mutex> lock(m_StorageMutex);
+    if (!m_StorageRunning || (TimeUtil::GetCurrentTimeMSec() > timeoutTime)) return false;
+  }
+
+  p_Result = future.get();
+  return p_Result && (p_Result->get_id() != td::td_api::error::ID);
+}
+
+void TgChat::Impl::OptimizeStorage()
+{
+  Object object;
+  if (!WaitStorageQuery(td::td_api::make_object<td::td_api::getStorageStatisticsFast>(), object))
+  {
+    LOG_WARNING("storage statistics failed");
+    return;
+  }
+
+  auto statsBefore = td::move_tl_object_as<td::td_api::storageStatisticsFast>(object);
+  LOG_DEBUG("storage files %lld bytes %d count db %lld bytes", (long long)statsBefore->files_size_,
+            statsBefore->file_count_, (long long)statsBefore->database_size_);
+
+  std::vector<StorageBudget> storageBudgets;
+  {
+    std::unique_lock<std::mutex> lock(m_StorageMutex);
+    storageBudgets = m_StorageBudgets;
+  }
+
+  for (const auto& storageBudget : storageBudgets)
+  {
+    // the size budget applies to files of the given type only, with type all to all files
+    std::vector<td::td_api::object_ptr<td::td_api::FileType>> fileTypes;
+    if (storageBudget.fileType != "all")
+    {
+      fileTypes.push_back(GetFileType(storageBudget.fileType));
+    }
+
+    if (!WaitStorageQuery(td::td_api::make_object<td::td_api::optimizeStorage>(storageBudget.maxSize,
+                                                                               storageBudget.maxAge, -1, -1,
+                                                                               std::move(fileTypes),
+                                                                               std::vector<int64_t>(),
+                                                                               std::vector<int64_t>(), false, 0),
+                          object))
+    {
+      LOG_WARNING("storage optimize %s failed", storageBudget.fileType.c_str());
+      return;
+    }
+  }
+
+  if (!WaitStorageQuery(td::td_api::make_object<td::td_api::getStorageStatisticsFast>(), object))
+  {
+    LOG_WARNING("storage statistics failed");
+    return;
+  }
+
+  auto statsAfter = td::move_tl_object_as<td::td_api::storageStatisticsFast>(object);
+  const int64_t reclaimedSize = std::max(statsBefore->files_size_ - statsAfter->files_size_, (int64_t)0);
+  const int32_t reclaimedCount = std::max(statsBefore->file_count_ - statsAfter->file_count_, 0);
+  LOG_INFO("storage optimized reclaimed %lld bytes %d files, now %lld bytes", (long long)reclaimedSize,
+           reclaimedCount, (long long)statsAfter->files_size_);
+}
+
+td::td_api::object_ptr<td::td_api::FileType> TgChat::Impl::GetFileType(const std::string& p_Name)
+{
+  if (p_Name == "animation") return td::td_api::make_object<td::td_api::fileTypeAnimation>();
+  if (p_Name == "audio") return td::td_api::make_object<td::td_api::fileTypeAudio>();
+  if (p_Name == "document") return td::td_api::make_object<td::td_api::fileTypeDocument>();
+  if (p_Name == "photo") return td::td_api::make_object<td::td_api::fileTypePhoto>();
+  if (p_Name == "profile_photo") return td::td_api::make_object<td::td_api::fileTypeProfilePhoto>();
+  if (p_Name == "sticker") return td::td_api::make_object<td::td_api::fileTypeSticker>();
+  if (p_Name == "thumbnail") return td::td_api::make_object<td::td_api::fileTypeThumbnail>();
+  if (p_Name == "video") return td::td_api::make_object<td::td_api::fileTypeVideo>();
+  if (p_Name == "video_note") return td::td_api::make_object<td::td_api::fileTypeVideoNote>();
+  if (p_Name == "voice_note") return td::td_api::make_object<td::td_api::fileTypeVoiceNote>();
+  if (p_Name == "wallpaper") return td::td_api::make_object<td::td_api::fileTypeWallpaper>();
+
+  return nullptr;
+}
+
 td::td_api::object_ptr<td::td_api::formattedText> TgChat::Impl::GetFormattedText(const std::string& p_Text)
 {
   td::td_api::object_ptr<td::td_api::formattedText> formatted_text;
 
   static const bool markdownEnabled = (m_Config.Get("markdown_enabled") == "1");
   static const int32_t markdownVersion = (m_Config.Get("markdown_version") == "1") ? 1 : 2;
-  if (markdownEnabled)
+  const std::string text = markdownEnabled ? StrUtil::EscapeRawUrls(p_Text) : p_Text;
+  if (markdownEnabled && TgMarkdown::HasMarkup(text, markdownVersion))
   {
-    const std::string text = StrUtil::EscapeRawUrls(p_Text);
-
     auto textParseMarkdown =
       td::td_api::make_object<td::td_api::textParseModeMarkdown>(markdownVersion);
     auto parseTextEntities =
@@ -20,6 +20,9 @@ class TgChat : public Protocol
 {
   class Impl;
   std::unique_ptr<Impl> m_Impl;
+  friend class TgChatBench; // dev/tgbench.cpp
+  friend class TdClientManager; // shared by all profiles
+  friend class TdRequestPool; // shared by all profiles
 
 public:
   TgChat();
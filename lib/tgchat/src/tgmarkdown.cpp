@@ -0,0 +1,144 @@
+// tgmarkdown.cpp
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "tgmarkdown.h"
+
+#include <algorithm>
+#include <utility>
+
+bool TgMarkdown::Render(const std::string& p_Text, std::vector<Entity> p_Entities, int p_Version,
+                        std::string& p_Markdown)
+{
+  if (p_Entities.empty())
+  {
+    p_Markdown = p_Text;
+    return true;
+  }
+
+  // outer entities first for same offset
+  // *INDENT-OFF*
+  std::stable_sort(p_Entities.begin(), p_Entities.end(), [](const Entity& p_Lhs, const Entity& p_Rhs)
+  {
+    return (p_Lhs.offset < p_Rhs.offset) || ((p_Lhs.offset == p_Rhs.offset) && (p_Lhs.length > p_Rhs.length));
+  });
+  // *INDENT-ON*
+
+  auto GetOpenMarkup = [p_Version](const Entity& p_Entity) -> std::string
+  {
+    switch (p_Entity.type)
+    {
+      case EntityBold: return (p_Version == 1) ? "*" : "**";
+      case EntityItalic: return (p_Version == 1) ? "_" : "__";
+      case EntityStrikethrough: return (p_Version == 1) ? "~" : "~~";
+      case EntityCode: return "`";
+      case EntityPre: return p_Entity.arg.empty() ? "```" : ("```" + p_Entity.arg + "\n");
+      case EntityTextUrl: return "[";
+      default: return "";
+    }
+  };
+
+  auto GetCloseMarkup = [p_Version](const Entity& p_Entity) -> std::string
+  {
+    switch (p_Entity.type)
+    {
+      case EntityBold: return (p_Version == 1) ? "*" : "**";
+      case EntityItalic: return (p_Version == 1) ? "_" : "__";
+      case EntityStrikethrough: return (p_Version == 1) ? "~" : "~~";
+      case EntityCode: return "`";
+      case EntityPre: return "```";
+      case EntityTextUrl: return "](" + p_Entity.arg + ")";
+      default: return "";
+    }
+  };
+
+  // build markup insertions ordered by position, only properly nested entities are supported
+  std::vector<std::pair<int32_t, std::string>> insertions;
+  insertions.reserve(p_Entities.size() * 2);
+  std::vector<const Entity*> stack;
+  for (const Entity& entity : p_Entities)
+  {
+    if ((entity.offset < 0) || (entity.length <= 0)) return false;
+
+    while (!stack.empty() && ((stack.back()->offset + stack.back()->length) <= entity.offset))
+    {
+      insertions.emplace_back(stack.back()->offset + stack.back()->length, GetCloseMarkup(*stack.back()));
+      stack.pop_back();
+    }
+
+    for (const Entity* parent : stack)
+    {
+      if (parent->type == entity.type) return false;
+    }
+
+    if (!stack.empty())
+    {
+      const Entity& parent = *stack.back();
+      if ((entity.offset + entity.length) > (parent.offset + parent.length)) return false;
+
+      if ((parent.type == EntityCode) || (parent.type == EntityPre)) return false;
+    }
+
+    insertions.emplace_back(entity.offset, GetOpenMarkup(entity));
+    stack.push_back(&entity);
+  }
+
+  while (!stack.empty())
+  {
+    insertions.emplace_back(stack.back()->offset + stack.back()->length, GetCloseMarkup(*stack.back()));
+    stack.pop_back();
+  }
+
+  // walk utf-8 text while tracking utf-16 position
+  std::string markdown;
+  size_t markupSize = 0;
+  for (const auto& insertion : insertions)
+  {
+    markupSize += insertion.second.size();
+  }
+
+  markdown.reserve(p_Text.size() + markupSize);
+  auto insIt = insertions.begin();
+  int32_t pos = 0;
+  for (size_t i = 0; i < p_Text.size(); ++i)
+  {
+    const unsigned char ch = static_cast<unsigned char>(p_Text[i]);
+    const bool isLeadByte = ((ch & 0xC0) != 0x80);
+    if (isLeadByte)
+    {
+      while ((insIt != insertions.end()) && (insIt->first <= pos))
+      {
+        if (insIt->first < pos) return false; // offset inside surrogate pair
+
+        markdown += insIt->second;
+        ++insIt;
+      }
+
+      pos += (ch >= 0xF0) ? 2 : 1;
+    }
+
+    markdown += p_Text[i];
+  }
+
+  while ((insIt != insertions.end()) && (insIt->first == pos))
+  {
+    markdown += insIt->second;
+    ++insIt;
+  }
+
+  if (insIt != insertions.end()) return false; // entity out of range
+
+  p_Markdown = std::move(markdown);
+  return true;
+}
+
+bool TgMarkdown::HasMarkup(const std::string& p_Text, int p_Version)
+{
+  static const std::string markupCharsV1 = "_*`[\\";
+  static const std::string markupCharsV2 = "_*[]()~`>#+-=|{}.!\\";
+  const std::string& markupChars = (p_Version == 1) ? markupCharsV1 : markupCharsV2;
+  return (p_Text.find_first_of(markupChars) != std::string::npos);
+}
@@ -0,0 +1,41 @@
+// tgmarkdown.h
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// native rendering of telegram text entities as markdown, independent of tdlib
+class TgMarkdown
+{
+public:
+  enum EntityType
+  {
+    EntityBold,
+    EntityItalic,
+    EntityStrikethrough,
+    EntityCode,
+    EntityPre,
+    EntityTextUrl,
+  };
+
+  // @note: offset and length are in utf-16 code units, arg is url or pre language
+  struct Entity
+  {
+    int32_t offset = 0;
+    int32_t length = 0;
+    EntityType type = EntityBold;
+    std::string arg;
+  };
+
+  // returns false if entities cannot be represented unambiguously, caller should fall back to tdlib
+  static bool Render(const std::string& p_Text, std::vector<Entity> p_Entities, int p_Version,
+                     std::string& p_Markdown);
+  static bool HasMarkup(const std::string& p_Text, int p_Version);
+};
@@ -9,36 +9,54 @@ package main
 
 // #cgo linux LDFLAGS: -Wl,-unresolved-symbols=ignore-all
 // #cgo darwin LDFLAGS: -Wl,-undefined,dynamic_lookup
-// extern void WmNewContactsNotify(int p_ConnId, char* p_ChatId, char* p_Name, char* p_Phone, int p_IsSelf);
-// extern void WmNewChatsNotify(int p_ConnId, char* p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime);
-// extern void WmNewMessagesNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_SenderId, char* p_Text, int p_FromMe, char* p_QuotedId, char* p_FileId, char* p_FilePath, int p_FileStatus, int p_TimeSent, int p_IsRead);
-// extern void WmNewStatusNotify(int p_ConnId, char* p_ChatId, char* p_UserId, int p_IsOnline, int p_IsTyping, int p_TimeSeen);
-// extern void WmNewMessageStatusNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, int p_IsRead);
-// extern void WmNewMessageFileNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_FilePath, int p_FileStatus, int p_Action);
-// extern void WmDeleteChatNotify(int p_ConnId, char* p_ChatId);
-// extern void WmUpdateMuteNotify(int p_ConnId, char* p_ChatId, int p_IsMuted);
+// /* strings and buffers point into go memory, only valid for the duration of the call */
+// extern void WmNewContactsBatchNotify(int p_ConnId, char* p_Buf, int p_BufLen, int p_Count);
+// extern void WmNewChatsNotify(int p_ConnId, _GoString_ p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime);
+// extern void WmNewMessagesNotify(int p_ConnId, _GoString_ p_ChatId, _GoString_ p_MsgId, _GoString_ p_SenderId, _GoString_ p_Text, int p_FromMe, _GoString_ p_QuotedId, _GoString_ p_FileId, _GoString_ p_FilePath, int p_FileStatus, int p_TimeSent, int p_IsRead);
+// extern void WmNewMessagesBatchNotify(int p_ConnId, _GoString_ p_ChatId, char* p_Buf, int p_BufLen, int p_Count);
+// extern void WmNewStatusNotify(int p_ConnId, _GoString_ p_ChatId, _GoString_ p_UserId, int p_IsOnline, int p_IsTyping, int p_TimeSeen);
+// extern void WmNewMessageStatusNotify(int p_ConnId, _GoString_ p_ChatId, _GoString_ p_MsgId, int p_IsRead);
+// extern void WmNewMessageFileNotify(int p_ConnId, _GoString_ p_ChatId, _GoString_ p_MsgId, _GoString_ p_FilePath, int p_FileStatus, int p_Action);
+// extern void WmNewMessageFileProgressNotify(int p_ConnId, _GoString_ p_ChatId, _GoString_ p_MsgId, long long p_Downloaded, long long p_Total);
+// extern void WmDeleteChatNotify(int p_ConnId, _GoString_ p_ChatId);
+// extern void WmUpdateMuteNotify(int p_ConnId, _GoString_ p_ChatId, int p_IsMuted);
 // extern void WmSetStatus(int p_Flags);
 // extern void WmClearStatus(int p_Flags);
-// extern void WmLogTrace(char* p_Filename, int p_LineNo, char* p_Message);
-// extern void WmLogDebug(char* p_Filename, int p_LineNo, char* p_Message);
-// extern void WmLogInfo(char* p_Filename, int p_LineNo, char* p_Message);
-// extern void WmLogWarning(char* p_Filename, int p_LineNo, char* p_Message);
-// extern void WmLogError(char* p_Filename, int p_LineNo, char* p_Message);
+// extern void WmStoreLatency(int p_Usec);
+// extern int WmLogTraceEnabled();
+// extern int WmLogDebugEnabled();
+// extern void WmLogTrace(_GoString_ p_Filename, int p_LineNo, _GoString_ p_Message);
+// extern void WmLogDebug(_GoString_ p_Filename, int p_LineNo, _GoString_ p_Message);
+// extern void WmLogInfo(_GoString_ p_Filename, int p_LineNo, _GoString_ p_Message);
+// extern void WmLogWarning(_GoString_ p_Filename, int p_LineNo, _GoString_ p_Message);
+// extern void WmLogError(_GoString_ p_Filename, int p_LineNo, _GoString_ p_Message);
 import "C"
 
 import (
+	"fmt"
 	"path/filepath"
 	"runtime"
+	"unsafe"
 )
 
 //export CWmInit
-func CWmInit(path *C.char, proxy *C.char, sendType int) int {
-	return WmInit(C.GoString(path), C.GoString(proxy), sendType)
+func CWmInit(path *C.char, proxy *C.char, storeOptions *C.char, sendType int) int {
+	return WmInit(C.GoString(path), C.GoString(proxy), C.GoString(storeOptions), sendType)
+}
+
+//export CWmSetMemoryLimit
+func CWmSetMemoryLimit(limit int64) {
+	WmSetMemoryLimit(limit)
+}
+
+//export CWmFreeMemory
+func CWmFreeMemory() {
+	WmFreeMemory()
 }
 
 //export CWmLogin
-func CWmLogin(connId int) int {
-	return WmLogin(connId)
+func CWmLogin(connId int, lazyHistory int) int {
+	return WmLogin(connId, lazyHistory)
 }
 
 //export CWmLogout
@@ -76,6 +94,11 @@ func CWmMarkMessageRead(connId int, chatId *C.char, msgId *C.char) int {
 	return WmMarkMessageRead(connId, C.GoString(chatId), C.GoString(msgId))
 }
 
+//export CWmMarkMessagesRead
+func CWmMarkMessagesRead(connId int, chatId *C.char, msgIds *C.char) int {
+	return WmMarkMessagesRead(connId, C.GoString(chatId), C.GoString(msgIds))
+}
+
 //export CWmDeleteMessage
 func CWmDeleteMessage(connId int, chatId *C.char, senderId *C.char, msgId *C.char) int {
 	return WmDeleteMessage(connId, C.GoString(chatId), C.GoString(senderId), C.GoString(msgId))
@@ -96,41 +119,62 @@ func CWmSendStatus(connId int, isOnline int) int {
 	return WmSendStatus(connId, isOnline)
 }
 
+//export CWmReconnect
+func CWmReconnect(connId int) int {
+	return WmReconnect(connId)
+}
+
 //export CWmDownloadFile
 func CWmDownloadFile(connId int, chatId *C.char, msgId *C.char, fileId *C.char, action int) int {
 	return WmDownloadFile(connId, C.GoString(chatId), C.GoString(msgId), C.GoString(fileId), action)
 }
 
-func CWmNewContactsNotify(connId int, chatId string, name string, phone string, isSelf int) {
-	C.WmNewContactsNotify(C.int(connId), C.CString(chatId), C.CString(name), C.CString(phone), C.int(isSelf))
+func BufPtr(buf []byte) *C.char {
+	if len(buf) == 0 {
+		return nil
+	}
+
+	return (*C.char)(unsafe.Pointer(&buf[0]))
+}
+
+func CWmNewContactsBatchNotify(connId int, buf []byte, count int) {
+	C.WmNewContactsBatchNotify(C.int(connId), BufPtr(buf), C.int(len(buf)), C.int(count))
 }
 
 func CWmNewChatsNotify(connId int, chatId string, isUnread int, isMuted int, lastMessageTime int) {
-	C.WmNewChatsNotify(C.int(connId), C.CString(chatId), C.int(isUnread), C.int(isMuted), C.int(lastMessageTime))
+	C.WmNewChatsNotify(C.int(connId), chatId, C.int(isUnread), C.int(isMuted), C.int(lastMessageTime))
 }
 
 func CWmNewMessagesNotify(connId int, chatId string, msgId string, senderId string, text string, fromMe int, quotedId string, fileId string, filePath string, fileStatus int, timeSent int, isRead int) {
-	C.WmNewMessagesNotify(C.int(connId), C.CString(chatId), C.CString(msgId), C.CString(senderId), C.CString(text), C.int(fromMe), C.CString(quotedId), C.CString(fileId), C.CString(filePath), C.int(fileStatus), C.int(timeSent), C.int(isRead))
+	C.WmNewMessagesNotify(C.int(connId), chatId, msgId, senderId, text, C.int(fromMe), quotedId, fileId, filePath, C.int(fileStatus), C.int(timeSent), C.int(isRead))
+}
+
+func CWmNewMessagesBatchNotify(connId int, chatId string, buf []byte, count int) {
+	C.WmNewMessagesBatchNotify(C.int(connId), chatId, BufPtr(buf), C.int(len(buf)), C.int(count))
 }
 
 func CWmNewStatusNotify(connId int, chatId string, userId string, isOnline int, isTyping int, timeSeen int) {
-	C.WmNewStatusNotify(C.int(connId), C.CString(chatId), C.CString(userId), C.int(isOnline), C.int(isTyping), C.int(timeSeen))
+	C.WmNewStatusNotify(C.int(connId), chatId, userId, C.int(isOnline), C.int(isTyping), C.int(timeSeen))
 }
 
 func CWmNewMessageStatusNotify(connId int, chatId string, msgId string, isRead int) {
-	C.WmNewMessageStatusNotify(C.int(connId), C.CString(chatId), C.CString(msgId), C.int(isRead))
+	C.WmNewMessageStatusNotify(C.int(connId), chatId, msgId, C.int(isRead))
 }
 
 func CWmNewMessageFileNotify(connId int, chatId string, msgId string, filePath string, fileStatus int, action int) {
-	C.WmNewMessageFileNotify(C.int(connId), C.CString(chatId), C.CString(msgId), C.CString(filePath), C.int(fileStatus), C.int(action))
+	C.WmNewMessageFileNotify(C.int(connId), chatId, msgId, filePath, C.int(fileStatus), C.int(action))
+}
+
+func CWmNewMessageFileProgressNotify(connId int, chatId string, msgId string, downloaded int64, total int64) {
+	C.WmNewMessageFileProgressNotify(C.int(connId), chatId, msgId, C.longlong(downloaded), C.longlong(total))
 }
 
 func CWmDeleteChatNotify(connId int, chatId string) {
-	C.WmDeleteChatNotify(C.int(connId), C.CString(chatId))
+	C.WmDeleteChatNotify(C.int(connId), chatId)
 }
 
 func CWmUpdateMuteNotify(connId int, chatId string, isMuted int) {
-	C.WmUpdateMuteNotify(C.int(connId), C.CString(chatId), C.int(isMuted))
+	C.WmUpdateMuteNotify(C.int(connId), chatId, C.int(isMuted))
 }
 
 func CWmSetStatus(flags int) {
@@ -141,7 +185,20 @@ func CWmClearStatus(flags int) {
 	C.WmClearStatus(C.int(flags))
 }
 
-func LOG_TRACE(message string) {
+func CWmStoreLatency(usec int) {
+	C.WmStoreLatency(C.int(usec))
+}
+
+func LOG_TRACE(format string, args ...interface{}) {
+	if C.WmLogTraceEnabled() == 0 {
+		return
+	}
+
+	message := format
+	if len(args) > 0 {
+		message = fmt.Sprintf(format, args...)
+	}
+
 	_, filename, lineNo, ok := runtime.Caller(1)
 	if ok {
 		filename = filepath.Base(filename)
@@ -150,10 +207,19 @@ func LOG_TRACE(message string) {
 		lineNo = 0
 	}
 
-	C.WmLogTrace(C.CString(filename), C.int(lineNo), C.CString(message))
+	C.WmLogTrace(filename, C.int(lineNo), message)
 }
 
-func LOG_DEBUG(message string) {
+func LOG_DEBUG(format string, args ...interface{}) {
+	if C.WmLogDebugEnabled() == 0 {
+		return
+	}
+
+	message := format
+	if len(args) > 0 {
+		message = fmt.Sprintf(format, args...)
+	}
+
 	_, filename, lineNo, ok := runtime.Caller(1)
 	if ok {
 		filename = filepath.Base(filename)
@@ -162,7 +228,7 @@ func LOG_DEBUG(message string) {
 		lineNo = 0
 	}
 
-	C.WmLogDebug(C.CString(filename), C.int(lineNo), C.CString(message))
+	C.WmLogDebug(filename, C.int(lineNo), message)
 }
 
 func LOG_INFO(message string) {
@@ -174,7 +240,7 @@ func LOG_INFO(message string) {
 		lineNo = 0
 	}
 
-	C.WmLogInfo(C.CString(filename), C.int(lineNo), C.CString(message))
+	C.WmLogInfo(filename, C.int(lineNo), message)
 }
 
 func LOG_WARNING(message string) {
@@ -186,7 +252,7 @@ func LOG_WARNING(message string) {
 		lineNo = 0
 	}
 
-	C.WmLogWarning(C.CString(filename), C.int(lineNo), C.CString(message))
+	C.WmLogWarning(filename, C.int(lineNo), message)
 }
 
 func LOG_ERROR(message string) {
@@ -198,5 +264,5 @@ func LOG_ERROR(message string) {
 		lineNo = 0
 	}
 
-	C.WmLogError(C.CString(filename), C.int(lineNo), C.CString(message))
+	C.WmLogError(filename, C.int(lineNo), message)
 }
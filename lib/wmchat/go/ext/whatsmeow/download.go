@@ -7,14 +7,19 @@
 package whatsmeow
 
 import (
+	"bytes"
+	"crypto/aes"
+	"crypto/cipher"
 	"crypto/hmac"
 	"crypto/sha256"
 	"encoding/base64"
 	"errors"
 	"fmt"
+	"hash"
 	"io"
 	"net"
 	"net/http"
+	"os"
 	"strings"
 	"time"
 
@@ -348,4 +353,199 @@ type DownloadableMessageWithURL interface {
 	DownloadableMessage
 	GetUrl() string
 }
+
+// DownloadProgressFunc is called as data arrives, with downloaded and total bytes (total -1 if unknown)
+type DownloadProgressFunc func(downloaded int64, total int64)
+
+// downloadChunkSize bounds the memory used per streamed download
+const downloadChunkSize = 64 * 1024
+
+// DownloadMediaToFile downloads and decrypts an attachment directly into file, using url if set
+// and directPath otherwise. The file is truncated before each attempt.
+func (cli *Client) DownloadMediaToFile(url string, directPath string, mediaKey []byte, mediaType MediaType, fileLength int, fileEncSha256 []byte, fileSha256 []byte, file *os.File, progress DownloadProgressFunc) (err error) {
+	if len(url) > 0 {
+		return cli.downloadToFileWithRetries(url, mediaKey, mediaType, fileLength, fileEncSha256, fileSha256, file, progress)
+	} else if len(directPath) == 0 {
+		return ErrNoURLPresent
+	}
+
+	var mediaConn *MediaConn
+	mediaConn, err = cli.refreshMediaConn(false)
+	if err != nil {
+		return fmt.Errorf("failed to refresh media connections: %w", err)
+	}
+	mmsType := mediaTypeToMMSType[mediaType]
+	for i, host := range mediaConn.Hosts {
+		mediaURL := fmt.Sprintf("https://%s%s&hash=%s&mms-type=%s&__wa-mms=", host.Hostname, directPath, base64.URLEncoding.EncodeToString(fileEncSha256), mmsType)
+		err = cli.downloadToFileWithRetries(mediaURL, mediaKey, mediaType, fileLength, fileEncSha256, fileSha256, file, progress)
+		if err == nil {
+			return nil
+		} else if i >= len(mediaConn.Hosts)-1 {
+			return fmt.Errorf("failed to download media from last host: %w", err)
+		}
+		cli.Log.Warnf("Failed to download media: %s, trying with next host...", err)
+	}
+	return
+}
+
+func (cli *Client) downloadToFileWithRetries(url string, mediaKey []byte, mediaType MediaType, fileLength int, fileEncSha256 []byte, fileSha256 []byte, file *os.File, progress DownloadProgressFunc) (err error) {
+	for retryNum := 0; retryNum < 5; retryNum++ {
+		if _, err = file.Seek(0, io.SeekStart); err != nil {
+			return
+		} else if err = file.Truncate(0); err != nil {
+			return
+		}
+		err = cli.downloadToFile(url, mediaKey, mediaType, fileLength, fileEncSha256, fileSha256, file, progress)
+		if err == nil || !shouldRetryMediaDownload(err) {
+			return
+		}
+		retryDuration := time.Duration(retryNum+1) * time.Second
+		var httpErr DownloadHTTPError
+		if errors.As(err, &httpErr) {
+			retryDuration = retryafter.Parse(httpErr.Response.Header.Get("Retry-After"), retryDuration)
+		}
+		cli.Log.Warnf("Failed to download media due to network error: %w, retrying in %s...", err, retryDuration)
+		time.Sleep(retryDuration)
+	}
+	return
+}
+
+func (cli *Client) downloadToFile(url string, mediaKey []byte, mediaType MediaType, fileLength int, fileEncSha256 []byte, fileSha256 []byte, file *os.File, progress DownloadProgressFunc) error {
+	req, err := http.NewRequest(http.MethodGet, url, nil)
+	if err != nil {
+		return fmt.Errorf("failed to prepare request: %w", err)
+	}
+	req.Header.Set("Origin", socket.Origin)
+	req.Header.Set("Referer", socket.Origin+"/")
+	resp, err := cli.http.Do(req)
+	if err != nil {
+		return err
+	}
+	defer resp.Body.Close()
+	if resp.StatusCode != http.StatusOK {
+		return DownloadHTTPError{Response: resp}
+	}
+
+	body := &progressReader{reader: resp.Body, total: resp.ContentLength, progress: progress}
+	if mediaKey == nil && fileEncSha256 == nil {
+		// unencrypted media, store as-is
+		_, err = io.CopyBuffer(file, body, make([]byte, downloadChunkSize))
+		return err
+	}
+
+	iv, cipherKey, macKey, _ := getMediaKeys(mediaKey, mediaType)
+	block, err := aes.NewCipher(cipherKey)
+	if err != nil {
+		return fmt.Errorf("failed to decrypt file: %w", err)
+	}
+	dec := &streamDecrypter{
+		mode:       cipher.NewCBCDecrypter(block, iv),
+		mac:        hmac.New(sha256.New, macKey),
+		encHash:    sha256.New(),
+		plainHash:  sha256.New(),
+		out:        file,
+		pending:    make([]byte, 0, downloadChunkSize+mediaMacSize+2*aes.BlockSize),
+		plainChunk: make([]byte, downloadChunkSize+2*aes.BlockSize),
+	}
+	dec.mac.Write(iv)
+	if _, err = io.CopyBuffer(dec, body, make([]byte, downloadChunkSize)); err != nil {
+		return err
+	}
+	if err = dec.Finish(); err != nil {
+		return err
+	}
+
+	if len(fileEncSha256) == 32 && !bytes.Equal(dec.encHash.Sum(nil), fileEncSha256) {
+		return ErrInvalidMediaEncSHA256
+	} else if fileLength >= 0 && dec.written != int64(fileLength) {
+		return fmt.Errorf("%w: expected %d, got %d", ErrFileLengthMismatch, fileLength, dec.written)
+	} else if len(fileSha256) == 32 && !bytes.Equal(dec.plainHash.Sum(nil), fileSha256) {
+		return ErrInvalidMediaSHA256
+	}
+	return nil
+}
+
+type progressReader struct {
+	reader     io.Reader
+	downloaded int64
+	total      int64
+	progress   DownloadProgressFunc
+}
+
+func (r *progressReader) Read(p []byte) (int, error) {
+	n, err := r.reader.Read(p)
+	if n > 0 && r.progress != nil {
+		r.downloaded += int64(n)
+		r.progress(r.downloaded, r.total)
+	}
+	return n, err
+}
+
+// streamDecrypter decrypts AES-CBC media as it is written, holding back the trailing
+// 10 byte hmac and the final padded block until Finish is called.
+type streamDecrypter struct {
+	mode       cipher.BlockMode
+	mac        hash.Hash
+	encHash    hash.Hash
+	plainHash  hash.Hash
+	out        io.Writer
+	pending    []byte
+	plainChunk []byte
+	written    int64
+}
+
+const mediaMacSize = 10
+
+func (d *streamDecrypter) Write(p []byte) (int, error) {
+	d.encHash.Write(p)
+	d.pending = append(d.pending, p...)
+	n := len(d.pending) - mediaMacSize - aes.BlockSize
+	n -= n % aes.BlockSize
+	if n > 0 {
+		if err := d.decrypt(d.pending[:n]); err != nil {
+			return 0, err
+		}
+		d.pending = d.pending[:copy(d.pending, d.pending[n:])]
+	}
+	return len(p), nil
+}
+
+func (d *streamDecrypter) Finish() error {
+	if len(d.pending) <= mediaMacSize {
+		return ErrTooShortFile
+	}
+	ciphertext, mac := d.pending[:len(d.pending)-mediaMacSize], d.pending[len(d.pending)-mediaMacSize:]
+	if len(ciphertext) != aes.BlockSize {
+		return fmt.Errorf("failed to decrypt file: ciphertext is not a multiple of the block size")
+	}
+	d.mac.Write(ciphertext)
+	if !hmac.Equal(d.mac.Sum(nil)[:mediaMacSize], mac) {
+		return ErrInvalidMediaHMAC
+	}
+	plaintext := d.plainChunk[:len(ciphertext)]
+	d.mode.CryptBlocks(plaintext, ciphertext)
+	padLen := int(plaintext[len(plaintext)-1])
+	if padLen == 0 || padLen > aes.BlockSize || !bytes.Equal(plaintext[len(plaintext)-padLen:], bytes.Repeat([]byte{byte(padLen)}, padLen)) {
+		return fmt.Errorf("failed to decrypt file: invalid padding")
+	}
+	return d.emit(plaintext[:len(plaintext)-padLen])
+}
+
+func (d *streamDecrypter) decrypt(ciphertext []byte) error {
+	d.mac.Write(ciphertext)
+	if len(d.plainChunk) < len(ciphertext) {
+		d.plainChunk = make([]byte, len(ciphertext))
+	}
+	plaintext := d.plainChunk[:len(ciphertext)]
+	d.mode.CryptBlocks(plaintext, ciphertext)
+	return d.emit(plaintext)
+}
+
+func (d *streamDecrypter) emit(plaintext []byte) error {
+	d.plainHash.Write(plaintext)
+	n, err := d.out.Write(plaintext)
+	d.written += int64(n)
+	return err
+}
+
 // nchat additions end
@@ -0,0 +1,24 @@
+// gomemory.go
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+package main
+
+import (
+	"runtime"
+	"runtime/debug"
+)
+
+// called by the nchat memory governor when the process is above its budget
+func WmFreeMemory() {
+	var before runtime.MemStats
+	runtime.ReadMemStats(&before)
+	debug.FreeOSMemory()
+	var after runtime.MemStats
+	runtime.ReadMemStats(&after)
+	LOG_DEBUG("free memory go heap %d kb to %d kb, released %d kb", before.HeapAlloc/1024, after.HeapAlloc/1024,
+		(after.HeapReleased-before.HeapReleased)/1024)
+}
@@ -0,0 +1,21 @@
+// gomemory_limit.go
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+//go:build go1.19
+// +build go1.19
+
+package main
+
+import (
+	"runtime/debug"
+)
+
+// soft memory limit requires go 1.19, older versions only release memory upon reclaim
+func WmSetMemoryLimit(limit int64) {
+	prevLimit := debug.SetMemoryLimit(limit)
+	LOG_DEBUG("go memory limit %d mb (was %d mb)", limit/(1024*1024), prevLimit/(1024*1024))
+}
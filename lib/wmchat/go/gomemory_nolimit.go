@@ -0,0 +1,15 @@
+// gomemory_nolimit.go
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+//go:build !go1.19
+// +build !go1.19
+
+package main
+
+func WmSetMemoryLimit(limit int64) {
+	LOG_DEBUG("go memory limit not supported")
+}
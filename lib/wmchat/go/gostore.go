@@ -0,0 +1,194 @@
+// gostore.go
+//
+// Copyright (c) 2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+package main
+
+import (
+	"context"
+	"database/sql"
+	"database/sql/driver"
+	"fmt"
+	"io"
+	"sync"
+	"time"
+
+	sqlite3 "github.com/mattn/go-sqlite3"
+	"go.mau.fi/whatsmeow/store/sqlstore"
+	waLog "go.mau.fi/whatsmeow/util/log"
+)
+
+// session store driver, sqlite3 with each statement's latency reported to the nchat stats
+const timedDriverName = "sqlite3_timed"
+
+var registerTimedDriver sync.Once
+
+func OpenSessionStore(sessionPath string, storeOptions string, log waLog.Logger) (*sqlstore.Container, error) {
+	registerTimedDriver.Do(func() {
+		sql.Register(timedDriverName, &timedDriver{driver: &sqlite3.SQLiteDriver{}})
+	})
+
+	// options are go-sqlite3 dsn parameters, e.g. wal journal and larger page cache
+	sqlAddress := fmt.Sprintf("file:%s?_foreign_keys=on", sessionPath)
+	if len(storeOptions) > 0 {
+		sqlAddress += "&" + storeOptions
+	}
+
+	db, openErr := sql.Open(timedDriverName, sqlAddress)
+	if openErr != nil {
+		return nil, openErr
+	}
+
+	container := sqlstore.NewWithDB(db, "sqlite3", log)
+	upgradeErr := container.Upgrade()
+	if upgradeErr != nil {
+		db.Close()
+		return nil, upgradeErr
+	}
+
+	return container, nil
+}
+
+func RecordStoreLatency(begin time.Time) {
+	CWmStoreLatency(int(time.Since(begin) / time.Microsecond))
+}
+
+type timedDriver struct {
+	driver driver.Driver
+}
+
+func (d *timedDriver) Open(name string) (driver.Conn, error) {
+	conn, err := d.driver.Open(name)
+	if err != nil {
+		return nil, err
+	}
+
+	return &timedConn{conn: conn}, nil
+}
+
+type timedConn struct {
+	conn driver.Conn
+}
+
+func (c *timedConn) Prepare(query string) (driver.Stmt, error) {
+	begin := time.Now()
+	stmt, err := c.conn.Prepare(query)
+	RecordStoreLatency(begin)
+	if err != nil {
+		return nil, err
+	}
+
+	return &timedStmt{stmt: stmt}, nil
+}
+
+func (c *timedConn) Close() error {
+	return c.conn.Close()
+}
+
+func (c *timedConn) Begin() (driver.Tx, error) {
+	return c.conn.Begin()
+}
+
+func (c *timedConn) BeginTx(ctx context.Context, opts driver.TxOptions) (driver.Tx, error) {
+	return c.conn.(driver.ConnBeginTx).BeginTx(ctx, opts)
+}
+
+func (c *timedConn) ExecContext(ctx context.Context, query string, args []driver.NamedValue) (driver.Result, error) {
+	begin := time.Now()
+	defer RecordStoreLatency(begin)
+	return c.conn.(driver.ExecerContext).ExecContext(ctx, query, args)
+}
+
+func (c *timedConn) QueryContext(ctx context.Context, query string, args []driver.NamedValue) (driver.Rows, error) {
+	begin := time.Now()
+	rows, err := c.conn.(driver.QueryerContext).QueryContext(ctx, query, args)
+	if err != nil {
+		RecordStoreLatency(begin)
+		return nil, err
+	}
+
+	return &timedRows{rows: rows, begin: begin}, nil
+}
+
+type timedStmt struct {
+	stmt driver.Stmt
+}
+
+func (s *timedStmt) Close() error {
+	return s.stmt.Close()
+}
+
+func (s *timedStmt) NumInput() int {
+	return s.stmt.NumInput()
+}
+
+func (s *timedStmt) Exec(args []driver.Value) (driver.Result, error) {
+	begin := time.Now()
+	defer RecordStoreLatency(begin)
+	return s.stmt.Exec(args)
+}
+
+func (s *timedStmt) Query(args []driver.Value) (driver.Rows, error) {
+	begin := time.Now()
+	rows, err := s.stmt.Query(args)
+	if err != nil {
+		RecordStoreLatency(begin)
+		return nil, err
+	}
+
+	return &timedRows{rows: rows, begin: begin}, nil
+}
+
+func (s *timedStmt) ExecContext(ctx context.Context, args []driver.NamedValue) (driver.Result, error) {
+	begin := time.Now()
+	defer RecordStoreLatency(begin)
+	return s.stmt.(driver.StmtExecContext).ExecContext(ctx, args)
+}
+
+func (s *timedStmt) QueryContext(ctx context.Context, args []driver.NamedValue) (driver.Rows, error) {
+	begin := time.Now()
+	rows, err := s.stmt.(driver.StmtQueryContext).QueryContext(ctx, args)
+	if err != nil {
+		RecordStoreLatency(begin)
+		return nil, err
+	}
+
+	return &timedRows{rows: rows, begin: begin}, nil
+}
+
+// sqlite steps rows lazily, so a query is timed until its rows are consumed
+type timedRows struct {
+	rows     driver.Rows
+	begin    time.Time
+	recorded bool
+}
+
+func (r *timedRows) Columns() []string {
+	return r.rows.Columns()
+}
+
+func (r *timedRows) Close() error {
+	r.record()
+	return r.rows.Close()
+}
+
+func (r *timedRows) Next(dest []driver.Value) error {
+	err := r.rows.Next(dest)
+	if err == io.EOF {
+		r.record()
+	}
+
+	return err
+}
+
+func (r *timedRows) record() {
+	if r.recorded {
+		return
+	}
+
+	r.recorded = true
+	RecordStoreLatency(r.begin)
+}
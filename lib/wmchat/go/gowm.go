@@ -19,9 +19,11 @@ import (
 	"os/exec"
 	"path/filepath"
 	"runtime"
+	"sort"
 	"strconv"
 	"strings"
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"google.golang.org/protobuf/proto"
@@ -36,7 +38,6 @@ import (
 	"go.mau.fi/libsignal/logger"
 	"go.mau.fi/whatsmeow"
 	"go.mau.fi/whatsmeow/appstate"
-	"go.mau.fi/whatsmeow/store/sqlstore"
 	"go.mau.fi/whatsmeow/types"
 	"go.mau.fi/whatsmeow/types/events"
 	waLog "go.mau.fi/whatsmeow/util/log"
@@ -61,15 +62,23 @@ const (
 	Disconnected
 )
 
+// per connection state, looked up without locking from a copy-on-write registry
+type Conn struct {
+	client   *whatsmeow.Client
+	path     string
+	sendType int
+	handler  *WmEventHandler
+
+	mx          sync.RWMutex
+	contacts    map[string]string
+	state       State
+	lazyHistory bool
+}
+
 var (
-	mx         sync.Mutex
-	clients    map[int]*whatsmeow.Client = make(map[int]*whatsmeow.Client)
-	paths      map[int]string            = make(map[int]string)
-	contacts   map[int]map[string]string = make(map[int]map[string]string)
-	states     map[int]State             = make(map[int]State)
-	timeUnread map[intString]int         = make(map[intString]int)
-	handlers   map[int]*WmEventHandler   = make(map[int]*WmEventHandler)
-	sendTypes  map[int]int               = make(map[int]int)
+	connsMx    sync.Mutex        // serializes registry updates
+	conns      atomic.Value      // map[int]*Conn, never modified after being stored
+	timeUnread map[intString]int = make(map[intString]int)
 )
 
 // keep in sync with enum FileStatus in protocol.h
@@ -89,82 +98,153 @@ var FlagUpdating = (1 << 4)
 var FlagSyncing = (1 << 5)
 var FlagAway = (1 << 6)
 
-func AddConn(conn *whatsmeow.Client, path string, sendType int) int {
-	mx.Lock()
-	var connId int = len(clients)
-	clients[connId] = conn
-	paths[connId] = path
-	contacts[connId] = make(map[string]string)
-	states[connId] = None
-	handlers[connId] = &WmEventHandler{connId}
-	sendTypes[connId] = sendType
-	mx.Unlock()
+func LoadConns() map[int]*Conn {
+	connsMap, _ := conns.Load().(map[int]*Conn)
+	return connsMap
+}
+
+func GetConn(connId int) *Conn {
+	return LoadConns()[connId]
+}
+
+func AddConn(client *whatsmeow.Client, path string, sendType int) int {
+	connsMx.Lock()
+	defer connsMx.Unlock()
+
+	oldConns := LoadConns()
+	newConns := make(map[int]*Conn, len(oldConns)+1)
+	for id, conn := range oldConns {
+		newConns[id] = conn
+	}
+
+	var connId int = len(oldConns)
+	newConns[connId] = &Conn{
+		client:   client,
+		path:     path,
+		sendType: sendType,
+		handler:  &WmEventHandler{connId: connId},
+		contacts: make(map[string]string),
+		state:    None,
+	}
+	conns.Store(newConns)
 	return connId
 }
 
 func RemoveConn(connId int) {
-	mx.Lock()
-	delete(clients, connId)
-	delete(paths, connId)
-	delete(contacts, connId)
-	delete(states, connId)
-	delete(handlers, connId)
-	mx.Unlock()
+	connsMx.Lock()
+	defer connsMx.Unlock()
+
+	oldConns := LoadConns()
+	newConns := make(map[int]*Conn, len(oldConns))
+	for id, conn := range oldConns {
+		if id != connId {
+			newConns[id] = conn
+		}
+	}
+
+	conns.Store(newConns)
 }
 
 func GetClient(connId int) *whatsmeow.Client {
-	mx.Lock()
-	var client *whatsmeow.Client = clients[connId]
-	mx.Unlock()
-	return client
+	conn := GetConn(connId)
+	if conn == nil {
+		return nil
+	}
+
+	return conn.client
 }
 
 func GetHandler(connId int) *WmEventHandler {
-	mx.Lock()
-	var handler *WmEventHandler = handlers[connId]
-	mx.Unlock()
-	return handler
+	conn := GetConn(connId)
+	if conn == nil {
+		return nil
+	}
+
+	return conn.handler
 }
 
 func GetPath(connId int) string {
-	mx.Lock()
-	var path string = paths[connId]
-	mx.Unlock()
-	return path
+	conn := GetConn(connId)
+	if conn == nil {
+		return ""
+	}
+
+	return conn.path
 }
 
 func GetSendType(connId int) int {
-	mx.Lock()
-	var sendType int = sendTypes[connId]
-	mx.Unlock()
-	return sendType
+	conn := GetConn(connId)
+	if conn == nil {
+		return 0
+	}
+
+	return conn.sendType
 }
 
 func GetState(connId int) State {
-	mx.Lock()
-	var state State = states[connId]
-	mx.Unlock()
-	return state
+	conn := GetConn(connId)
+	if conn == nil {
+		return None
+	}
+
+	conn.mx.RLock()
+	defer conn.mx.RUnlock()
+	return conn.state
 }
 
 func SetState(connId int, status State) {
-	mx.Lock()
-	states[connId] = status
-	mx.Unlock()
+	conn := GetConn(connId)
+	if conn == nil {
+		return
+	}
+
+	conn.mx.Lock()
+	conn.state = status
+	conn.mx.Unlock()
+}
+
+func GetLazyHistory(connId int) bool {
+	conn := GetConn(connId)
+	if conn == nil {
+		return false
+	}
+
+	conn.mx.RLock()
+	defer conn.mx.RUnlock()
+	return conn.lazyHistory
+}
+
+func SetLazyHistory(connId int, lazyHistory bool) {
+	conn := GetConn(connId)
+	if conn == nil {
+		return
+	}
+
+	conn.mx.Lock()
+	conn.lazyHistory = lazyHistory
+	conn.mx.Unlock()
 }
 
 func AddContactName(connId int, id string, name string) {
-	mx.Lock()
-	contacts[connId][id] = name
-	mx.Unlock()
+	conn := GetConn(connId)
+	if conn == nil {
+		return
+	}
+
+	conn.mx.Lock()
+	conn.contacts[id] = name
+	conn.mx.Unlock()
 }
 
 func GetContactName(connId int, id string) string {
 	var name string
 	var ok bool
-	mx.Lock()
-	name, ok = contacts[connId][id]
-	mx.Unlock()
+	conn := GetConn(connId)
+	if conn != nil {
+		conn.mx.RLock()
+		name, ok = conn.contacts[id]
+		conn.mx.RUnlock()
+	}
 	if !ok {
 		name = id
 	}
@@ -213,7 +293,7 @@ func DownloadableMessageToFileId(client *whatsmeow.Client, msg whatsmeow.Downloa
 		return ""
 	}
 
-	LOG_TRACE(fmt.Sprintf("fileInfo %#v", info))
+	LOG_TRACE("fileInfo %#v", info)
 	bytes, err := json.Marshal(info)
 	if err != nil {
 		LOG_WARNING(fmt.Sprintf("json encode failed"))
@@ -221,75 +301,93 @@ func DownloadableMessageToFileId(client *whatsmeow.Client, msg whatsmeow.Downloa
 	}
 
 	str := string(bytes)
-	LOG_TRACE(fmt.Sprintf("fileId %s", str))
+	LOG_TRACE("fileId %s", str)
 
 	return str
 }
 
-func DownloadFromFileId(client *whatsmeow.Client, fileId string) (string, int) {
-	LOG_TRACE(fmt.Sprintf("fileId %s", fileId))
+// min interval between download progress notifications
+var downloadProgressInterval = 500 * time.Millisecond
+
+func DownloadFromFileId(client *whatsmeow.Client, connId int, chatId string, msgId string, fileId string) (string, int, int64) {
+	LOG_TRACE("fileId %s", fileId)
 	var info DownloadInfo
 	json.Unmarshal([]byte(fileId), &info)
 	if info.Version != downloadInfoVersion {
 		LOG_WARNING(fmt.Sprintf("unsupported version %d", info.Version))
-		return "", FileStatusDownloadFailed
+		return "", FileStatusDownloadFailed, 0
 	}
 
-	LOG_TRACE(fmt.Sprintf("fileInfo %#v", info))
+	LOG_TRACE("fileInfo %#v", info)
 
 	targetPath := info.TargetPath
 	filePath := ""
 	fileStatus := FileStatusNone
+	var fileSize int64 = 0
 
 	// download if not yet present
 	if _, statErr := os.Stat(targetPath); os.IsNotExist(statErr) {
-		LOG_TRACE(fmt.Sprintf("download new %#v", targetPath))
+		LOG_TRACE("download new %#v", targetPath)
 		CWmSetStatus(FlagFetching)
 
-		data, err := DownloadFromFileInfo(client, info)
+		// stream into a partial file, only complete files are stored at target path
+		partPath := targetPath + ".part"
+		file, err := os.Create(partPath)
 		if err != nil {
-			LOG_WARNING(fmt.Sprintf("download error %#v", err))
+			LOG_WARNING(fmt.Sprintf("create error %#v", err))
 			fileStatus = FileStatusDownloadFailed
 		} else {
-			file, err := os.Create(targetPath)
-			defer file.Close()
+			var lastProgressTime time.Time
+			progress := func(downloaded int64, total int64) {
+				fileSize = downloaded
+				if (downloaded == total) || (time.Since(lastProgressTime) >= downloadProgressInterval) {
+					lastProgressTime = time.Now()
+					CWmNewMessageFileProgressNotify(connId, chatId, msgId, downloaded, total)
+				}
+			}
+
+			err = DownloadFromFileInfo(client, info, file, progress)
+			closeErr := file.Close()
+			if err == nil {
+				err = closeErr
+			}
+
+			if err == nil {
+				err = os.Rename(partPath, targetPath)
+			}
+
 			if err != nil {
-				LOG_WARNING(fmt.Sprintf("create error %#v", err))
+				LOG_WARNING(fmt.Sprintf("download error %#v", err))
+				os.Remove(partPath)
 				fileStatus = FileStatusDownloadFailed
 			} else {
-				_, err = file.Write(data)
-				if err != nil {
-					LOG_WARNING(fmt.Sprintf("write error %#v", err))
-					fileStatus = FileStatusDownloadFailed
-				} else {
-					LOG_TRACE(fmt.Sprintf("download ok"))
-					filePath = targetPath
-					fileStatus = FileStatusDownloaded
-				}
+				LOG_TRACE("download ok")
+				filePath = targetPath
+				fileStatus = FileStatusDownloaded
 			}
 		}
 		CWmClearStatus(FlagFetching)
 	} else {
-		LOG_TRACE(fmt.Sprintf("download cached %#v", targetPath))
+		LOG_TRACE("download cached %#v", targetPath)
 		filePath = targetPath
 		fileStatus = FileStatusDownloaded
 	}
 
-	return filePath, fileStatus
+	return filePath, fileStatus, fileSize
 }
 
-func DownloadFromFileInfo(client *whatsmeow.Client, info DownloadInfo) ([]byte, error) {
+func DownloadFromFileInfo(client *whatsmeow.Client, info DownloadInfo, file *os.File, progress whatsmeow.DownloadProgressFunc) error {
 
 	if len(info.Url) > 0 {
-		LOG_TRACE(fmt.Sprintf("download url: %s", info.Url))
-		return client.DownloadMediaWithUrl(info.Url, info.MediaKey, info.MediaType, info.Size, info.FileEncSha256, info.FileSha256)
+		LOG_TRACE("download url: %s", info.Url)
 	} else if len(info.DirectPath) > 0 {
-		LOG_TRACE(fmt.Sprintf("download directpath: %s", info.DirectPath))
-		return client.DownloadMediaWithPath(info.DirectPath, info.FileEncSha256, info.FileSha256, info.MediaKey, info.Size, info.MediaType, whatsmeow.GetMMSType(info.MediaType))
+		LOG_TRACE("download directpath: %s", info.DirectPath)
 	} else {
 		LOG_WARNING(fmt.Sprintf("url and path not present"))
-		return nil, whatsmeow.ErrNoURLPresent
+		return whatsmeow.ErrNoURLPresent
 	}
+
+	return client.DownloadMediaToFile(info.Url, info.DirectPath, info.MediaKey, info.MediaType, info.Size, info.FileEncSha256, info.FileSha256, file, progress)
 }
 
 // utils
@@ -310,7 +408,7 @@ func HasGUI() bool {
 	switch runtime.GOOS {
 	case "darwin":
 		LOG_INFO(fmt.Sprintf("has gui"))
-		LOG_DEBUG(fmt.Sprintf("gui check: [darwin default true]"))
+		LOG_DEBUG("gui check: [darwin default true]")
 		return true
 
 	case "linux":
@@ -353,17 +451,17 @@ func HasGUI() bool {
 		cmdout, err := exec.Command(file.Name()).CombinedOutput()
 		if err == nil {
 			LOG_INFO(fmt.Sprintf("has gui"))
-			LOG_DEBUG(fmt.Sprintf("gui check: %s", strings.TrimSuffix(string(cmdout), "\n")))
+			LOG_DEBUG("gui check: %s", strings.TrimSuffix(string(cmdout), "\n"))
 			return true
 		} else {
 			LOG_INFO(fmt.Sprintf("no gui"))
-			LOG_DEBUG(fmt.Sprintf("gui check: %s", strings.TrimSuffix(string(cmdout), "\n")))
+			LOG_DEBUG("gui check: %s", strings.TrimSuffix(string(cmdout), "\n"))
 			return false
 		}
 
 	default:
 		LOG_INFO(fmt.Sprintf("has gui"))
-		LOG_DEBUG(fmt.Sprintf("gui check: [other default true]"))
+		LOG_DEBUG("gui check: [other default true]")
 		return true
 	}
 }
@@ -433,7 +531,7 @@ func ParseWebMessageInfo(selfJid types.JID, chatJid types.JID, webMsg *waProto.W
 type ncLogger struct{}
 
 func (s *ncLogger) Debugf(msg string, args ...interface{}) {
-	LOG_DEBUG(fmt.Sprintf("whatsmeow %s", fmt.Sprintf(msg, args...)))
+	LOG_DEBUG("whatsmeow %s", fmt.Sprintf(msg, args...))
 }
 
 func (s *ncLogger) Infof(msg string, args ...interface{}) {
@@ -460,7 +558,7 @@ func NcLogger() waLog.Logger {
 type ncSignalLogger struct{}
 
 func (s *ncSignalLogger) Debug(caller, msg string) {
-	LOG_DEBUG(fmt.Sprintf("whatsmeow %s", fmt.Sprintf("%s %s", caller, msg)))
+	LOG_DEBUG("whatsmeow %s", fmt.Sprintf("%s %s", caller, msg))
 }
 
 func (s *ncSignalLogger) Info(caller, msg string) {
@@ -480,7 +578,117 @@ func (s *ncSignalLogger) Configure(ss string) {
 
 // event handling
 type WmEventHandler struct {
-	connId int
+	connId      int
+	syncMx      sync.Mutex
+	syncBatches map[string]*PackedBatch
+
+	statusMx       sync.Mutex
+	statusPending  bool
+	statusSeq      int
+	readReceipts   []ReadReceipt
+	readReceiptSet map[ReadReceipt]bool
+	presences      map[PresenceKey]*PresenceState
+}
+
+// status coalescing, bursts of receipts and presences (e.g. replayed upon reconnect) are
+// merged within a short interval, keeping only the latest presence per chat and user
+var statusCoalesceInterval = 100 * time.Millisecond
+
+type ReadReceipt struct {
+	chatId string
+	msgId  string
+}
+
+type PresenceKey struct {
+	chatId string
+	userId string
+}
+
+type PresenceState struct {
+	seq      int
+	isOnline bool
+	isTyping bool
+	timeSeen int
+}
+
+// packed fields for batched cgo calls, keep in sync with ReadBatchInt/ReadBatchString in wmchat.cpp
+// and the corpus packing in dev/wmbench.cpp
+type PackedBatch struct {
+	buf   []byte
+	count int
+}
+
+func (batch *PackedBatch) AppendInt(v int) {
+	u := uint32(int32(v))
+	batch.buf = append(batch.buf, byte(u), byte(u>>8), byte(u>>16), byte(u>>24))
+}
+
+func (batch *PackedBatch) AppendString(v string) {
+	batch.AppendInt(len(v))
+	batch.buf = append(batch.buf, v...)
+}
+
+// lazy history, raw history sync messages are stored per chat until the chat is opened
+func GetHistoryPath(connId int, chatId string) string {
+	return GetPath(connId) + "/history/" + chatId + ".bin"
+}
+
+func StoreHistoryMessages(historyPath string, webMessageInfos []*waProto.WebMessageInfo) error {
+	mkdirErr := os.MkdirAll(filepath.Dir(historyPath), os.ModePerm)
+	if mkdirErr != nil {
+		return mkdirErr
+	}
+
+	// records are appended as length-prefixed protobuf encoded messages
+	var batch PackedBatch
+	for _, webMessageInfo := range webMessageInfos {
+		data, marshalErr := proto.Marshal(webMessageInfo)
+		if marshalErr != nil {
+			return marshalErr
+		}
+
+		batch.AppendString(string(data))
+	}
+
+	file, openErr := os.OpenFile(historyPath, os.O_APPEND|os.O_CREATE|os.O_WRONLY, 0644)
+	if openErr != nil {
+		return openErr
+	}
+
+	_, writeErr := file.Write(batch.buf)
+	closeErr := file.Close()
+	if writeErr != nil {
+		return writeErr
+	}
+
+	return closeErr
+}
+
+func LoadHistoryMessages(historyPath string) ([]*waProto.WebMessageInfo, error) {
+	data, readErr := ioutil.ReadFile(historyPath)
+	if readErr != nil {
+		return nil, readErr
+	}
+
+	var webMessageInfos []*waProto.WebMessageInfo
+	for len(data) >= 4 {
+		size := int(uint32(data[0]) | uint32(data[1])<<8 | uint32(data[2])<<16 | uint32(data[3])<<24)
+		data = data[4:]
+		if size > len(data) {
+			return webMessageInfos, fmt.Errorf("truncated record")
+		}
+
+		webMessageInfo := &waProto.WebMessageInfo{}
+		unmarshalErr := proto.Unmarshal(data[:size], webMessageInfo)
+		if unmarshalErr != nil {
+			return webMessageInfos, unmarshalErr
+		}
+
+		webMessageInfos = append(webMessageInfos, webMessageInfo)
+		data = data[size:]
+	}
+
+	return webMessageInfos, nil
 }
 
 func (handler *WmEventHandler) HandleEvent(rawEvt interface{}) {
@@ -488,7 +696,7 @@ func (handler *WmEventHandler) HandleEvent(rawEvt interface{}) {
 
 	case *events.AppStateSyncComplete:
 		// this happens after initial logon via QR code
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		if evt.Name == appstate.WAPatchCriticalBlock {
 			LOG_TRACE("AppStateSyncComplete WAPatchCriticalBlock")
 			handler.HandleConnected()
@@ -499,16 +707,16 @@ func (handler *WmEventHandler) HandleEvent(rawEvt interface{}) {
 
 	case *events.PushNameSetting:
 		// send presence when the pushname is changed remotely
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleConnected()
 
 	case *events.PushName:
 		// other device changed our friendly name
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.Connected:
 		// connected
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleConnected()
 		SetState(handler.connId, Connected)
 		CWmSetStatus(FlagOnline)
@@ -516,75 +724,75 @@ func (handler *WmEventHandler) HandleEvent(rawEvt interface{}) {
 
 	case *events.Disconnected:
 		// disconnected
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		CWmSetStatus(FlagOffline)
 		CWmClearStatus(FlagOnline)
 
 	case *events.StreamReplaced:
 		// TODO: find out when exactly this happens and how to handle it
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.Message:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleMessage(evt.Info, evt.Message, false)
 
 	case *events.Receipt:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleReceipt(evt)
 
 	case *events.Presence:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandlePresence(evt)
 
 	case *events.ChatPresence:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleChatPresence(evt)
 
 	case *events.HistorySync:
 		// This happens after initial logon via QR code (after AppStateSyncComplete)
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleHistorySync(evt)
 
 	case *events.AppState:
-		LOG_TRACE(fmt.Sprintf("%#v - %#v / %#v", evt, evt.Index, evt.SyncActionValue))
+		LOG_TRACE("%#v - %#v / %#v", evt, evt.Index, evt.SyncActionValue)
 
 	case *events.LoggedOut:
 		// logged out, need re-init?
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.QR:
 		// handled in WmLogin
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.PairSuccess:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.JoinedGroup:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 
 	case *events.OfflineSyncCompleted:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.GetContacts()
 
 	case *events.GroupInfo:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleGroupInfo(evt)
 
 	case *events.DeleteChat:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleDeleteChat(evt)
 
 	case *events.Mute:
-		LOG_TRACE(fmt.Sprintf("%#v", evt))
+		LOG_TRACE("%#v", evt)
 		handler.HandleMute(evt)
 
 	default:
-		LOG_TRACE(fmt.Sprintf("Event type not handled: %#v", rawEvt))
+		LOG_TRACE("Event type not handled: %#v", rawEvt)
 	}
 }
 
 func (handler *WmEventHandler) HandleConnected() {
-	LOG_TRACE(fmt.Sprintf("HandleConnected"))
+	LOG_TRACE("HandleConnected")
 	var client *whatsmeow.Client = GetClient(handler.connId)
 
 	if len(client.Store.PushName) == 0 {
@@ -594,46 +802,113 @@ func (handler *WmEventHandler) HandleConnected() {
 
 func (handler *WmEventHandler) HandleReceipt(receipt *events.Receipt) {
 	if receipt.Type == events.ReceiptTypeRead || receipt.Type == events.ReceiptTypeReadSelf {
-		LOG_TRACE(fmt.Sprintf("%#v was read by %s at %s", receipt.MessageIDs, receipt.SourceString(), receipt.Timestamp))
-		connId := handler.connId
+		LOG_TRACE("%#v was read by %s at %s", receipt.MessageIDs, receipt.SourceString(), receipt.Timestamp)
 		chatId := receipt.MessageSource.Chat.ToNonAD().String()
-		isRead := true
+
+		// read status is sticky, so duplicates (e.g. from multiple group members) are dropped
+		handler.statusMx.Lock()
+		if handler.readReceiptSet == nil {
+			handler.readReceiptSet = make(map[ReadReceipt]bool)
+		}
+
 		for _, msgId := range receipt.MessageIDs {
-			LOG_TRACE(fmt.Sprintf("Call CWmNewMessageStatusNotify"))
-			CWmNewMessageStatusNotify(connId, chatId, msgId, BoolToInt(isRead))
+			readReceipt := ReadReceipt{chatId: chatId, msgId: msgId}
+			if !handler.readReceiptSet[readReceipt] {
+				handler.readReceiptSet[readReceipt] = true
+				handler.readReceipts = append(handler.readReceipts, readReceipt)
+			}
 		}
+
+		handler.ScheduleStatusFlush()
+		handler.statusMx.Unlock()
 	}
 }
 
 func (handler *WmEventHandler) HandlePresence(presence *events.Presence) {
 	if presence.From.Server != types.GroupServer {
-		connId := handler.connId
 		chatId := ""
 		userId := presence.From.ToNonAD().String()
 		isOnline := !presence.Unavailable
 		timeSeen := int(presence.LastSeen.Unix())
 		isTyping := false
-		LOG_TRACE(fmt.Sprintf("Call CWmNewStatusNotify"))
-		CWmNewStatusNotify(connId, chatId, userId, BoolToInt(isOnline), BoolToInt(isTyping), timeSeen)
+		handler.QueuePresence(chatId, userId, isOnline, isTyping, timeSeen)
 	}
 }
 
 func (handler *WmEventHandler) HandleChatPresence(chatPresence *events.ChatPresence) {
-	connId := handler.connId
 	chatId := chatPresence.MessageSource.Chat.ToNonAD().String()
 	userId := chatPresence.MessageSource.Sender.ToNonAD().String()
 	isOnline := true
 	isTyping := (chatPresence.State == types.ChatPresenceComposing)
-	LOG_TRACE(fmt.Sprintf("Call CWmNewStatusNotify"))
-	CWmNewStatusNotify(connId, chatId, userId, BoolToInt(isOnline), BoolToInt(isTyping), -1)
+	handler.QueuePresence(chatId, userId, isOnline, isTyping, -1)
+}
+
+func (handler *WmEventHandler) QueuePresence(chatId string, userId string, isOnline bool, isTyping bool, timeSeen int) {
+	handler.statusMx.Lock()
+	if handler.presences == nil {
+		handler.presences = make(map[PresenceKey]*PresenceState)
+	}
+
+	handler.statusSeq++
+	handler.presences[PresenceKey{chatId: chatId, userId: userId}] =
+		&PresenceState{seq: handler.statusSeq, isOnline: isOnline, isTyping: isTyping, timeSeen: timeSeen}
+	handler.ScheduleStatusFlush()
+	handler.statusMx.Unlock()
+}
+
+// must be called with statusMx held
+func (handler *WmEventHandler) ScheduleStatusFlush() {
+	if !handler.statusPending {
+		handler.statusPending = true
+		time.AfterFunc(statusCoalesceInterval, handler.FlushStatus)
+	}
+}
+
+func (handler *WmEventHandler) FlushStatus() {
+	handler.statusMx.Lock()
+	readReceipts := handler.readReceipts
+	presences := handler.presences
+	handler.readReceipts = nil
+	handler.readReceiptSet = nil
+	handler.presences = nil
+	handler.statusPending = false
+	handler.statusMx.Unlock()
+
+	connId := handler.connId
+	isRead := true
+	for _, readReceipt := range readReceipts {
+		LOG_TRACE("Call CWmNewMessageStatusNotify")
+		CWmNewMessageStatusNotify(connId, readReceipt.chatId, readReceipt.msgId, BoolToInt(isRead))
+	}
+
+	// presences are notified in order of their latest update
+	presenceKeys := make([]PresenceKey, 0, len(presences))
+	for presenceKey := range presences {
+		presenceKeys = append(presenceKeys, presenceKey)
+	}
+
+	sort.Slice(presenceKeys, func(i, j int) bool {
+		return presences[presenceKeys[i]].seq < presences[presenceKeys[j]].seq
+	})
+
+	for _, presenceKey := range presenceKeys {
+		presence := presences[presenceKey]
+		LOG_TRACE("Call CWmNewStatusNotify")
+		CWmNewStatusNotify(connId, presenceKey.chatId, presenceKey.userId, BoolToInt(presence.isOnline),
+			BoolToInt(presence.isTyping), presence.timeSeen)
+	}
 }
 
 func (handler *WmEventHandler) HandleHistorySync(historySync *events.HistorySync) {
+	handler.syncMx.Lock()
+	defer handler.syncMx.Unlock()
+
 	var client *whatsmeow.Client = GetClient(handler.connId)
 	selfJid := *client.Store.ID
+	lazyHistory := GetLazyHistory(handler.connId)
 
-	LOG_TRACE(fmt.Sprintf("HandleHistorySync SyncType %s Progress %d",
-		(*historySync.Data.SyncType).String(), historySync.Data.GetProgress()))
+	LOG_TRACE("HandleHistorySync SyncType %s Progress %d",
+		(*historySync.Data.SyncType).String(), historySync.Data.GetProgress())
 
 	if historySync.Data.GetProgress() < 98 {
 		LOG_TRACE("Set Syncing")
@@ -643,61 +918,139 @@ func (handler *WmEventHandler) HandleHistorySync(historySync *events.HistorySync
 	pushnames := historySync.Data.GetPushnames()
 	for _, pushname := range pushnames {
 		if pushname.Id != nil && pushname.Pushname != nil {
-			LOG_TRACE(fmt.Sprintf("HandleHistorySync Pushname %s %s", *pushname.Id, *pushname.Pushname))
+			LOG_TRACE("HandleHistorySync Pushname %s %s", *pushname.Id, *pushname.Pushname)
 		}
 	}
 
+	// conversations are decoded in parallel, and passed to the ui in order as they complete
 	conversations := historySync.Data.GetConversations()
-	for _, conversation := range conversations {
-		LOG_TRACE(fmt.Sprintf("HandleHistorySync Conversation %#v", *conversation))
+	results := make([]chan *SyncConversation, len(conversations))
+	for i := range results {
+		results[i] = make(chan *SyncConversation, 1)
+	}
+
+	jobs := make(chan int, len(conversations))
+	for i := range conversations {
+		jobs <- i
+	}
+	close(jobs)
+
+	workerCount := runtime.NumCPU()
+	if workerCount > len(conversations) {
+		workerCount = len(conversations)
+	}
 
-		chatJid, _ := types.ParseJID(conversation.GetId())
+	for w := 0; w < workerCount; w++ {
+		go func() {
+			for i := range jobs {
+				results[i] <- DecodeConversation(handler.connId, client, selfJid, lazyHistory, conversations[i])
+			}
+		}()
+	}
+
+	for i := range conversations {
+		result := <-results[i]
+		result.decoder.FlushNewMessages()
+		chatId := JidToStr(result.chatJid)
+		if result.hasMessages {
+			LOG_TRACE("Call CWmNewChatsNotify %s %d %t", chatId, result.messageCount, result.isMuted)
+			CWmNewChatsNotify(handler.connId, chatId, result.isUnread, BoolToInt(result.isMuted), result.lastMessageTime)
+		} else {
+			LOG_TRACE("Skip CWmNewChatsNotify %s %d", chatId, result.messageCount)
+		}
+	}
 
-		isUnread := 0
-		lastMessageTime := 0
+	if (historySync.Data.GetProgress() == 100) &&
+		(historySync.Data.GetSyncType() == waProto.HistorySync_FULL) {
+		LOG_TRACE("Clear Syncing")
+		CWmClearStatus(FlagSyncing)
+	}
+}
+
+// decoded history sync conversation, its messages held in the decoder's batches until flushed
+type SyncConversation struct {
+	chatJid         types.JID
+	decoder         *WmEventHandler
+	hasMessages     bool
+	messageCount    int
+	isUnread        int
+	isMuted         bool
+	lastMessageTime int
+}
 
-		hasMessages := false
-		syncMessages := conversation.GetMessages()
+// run on a history sync worker, the message handlers only batch into the decoder, so a
+// conversation's messages do not cross into c++ until the event goroutine flushes them
+func DecodeConversation(connId int, client *whatsmeow.Client, selfJid types.JID, lazyHistory bool, conversation *waProto.Conversation) *SyncConversation {
+	LOG_TRACE("HandleHistorySync Conversation %#v", *conversation)
+
+	chatJid, _ := types.ParseJID(conversation.GetId())
+	result := &SyncConversation{chatJid: chatJid}
+	result.decoder = &WmEventHandler{connId: connId, syncBatches: make(map[string]*PackedBatch)}
+	syncMessages := conversation.GetMessages()
+	result.messageCount = len(syncMessages)
+
+	// in lazy mode only the latest message is handled, the rest is stored until requested
+	var latestMessage *waProto.WebMessageInfo = nil
+	if lazyHistory {
+		var storeMessages []*waProto.WebMessageInfo
 		for _, syncMessage := range syncMessages {
 			webMessageInfo := syncMessage.Message
-			messageInfo := ParseWebMessageInfo(selfJid, chatJid, webMessageInfo)
-			message := webMessageInfo.GetMessage()
-
-			if (messageInfo == nil) || (message == nil) {
+			if webMessageInfo == nil {
 				continue
 			}
 
-			handler.HandleMessage(*messageInfo, message, true)
-			hasMessages = true
+			if latestMessage == nil {
+				latestMessage = webMessageInfo
+			} else if webMessageInfo.GetMessageTimestamp() > latestMessage.GetMessageTimestamp() {
+				storeMessages = append(storeMessages, latestMessage)
+				latestMessage = webMessageInfo
+			} else {
+				storeMessages = append(storeMessages, webMessageInfo)
+			}
 		}
 
-		if hasMessages {
-			isMuted := false
-			settings, setErr := client.Store.ChatSettings.GetChatSettings(chatJid)
-			if setErr != nil {
-				LOG_WARNING(fmt.Sprintf("Get chat settings failed %#v", setErr))
+		if len(storeMessages) > 0 {
+			storeErr := StoreHistoryMessages(GetHistoryPath(connId, JidToStr(chatJid)), storeMessages)
+			if storeErr != nil {
+				LOG_WARNING(fmt.Sprintf("Store history failed %#v", storeErr))
 			} else {
-				if settings.Found {
-					mutedUntil := settings.MutedUntil.Unix()
-					isMuted = (mutedUntil == -1) || (mutedUntil > time.Now().Unix())
-				} else {
-					LOG_WARNING(fmt.Sprintf("Chat settings not found"))
-				}
+				result.hasMessages = true
 			}
+		}
+	}
 
-			LOG_TRACE(fmt.Sprintf("Call CWmNewChatsNotify %s %d %t", JidToStr(chatJid), len(syncMessages), isMuted))
-			CWmNewChatsNotify(handler.connId, JidToStr(chatJid), isUnread, BoolToInt(isMuted), lastMessageTime)
-		} else {
-			LOG_TRACE(fmt.Sprintf("Skip CWmNewChatsNotify %s %d", JidToStr(chatJid), len(syncMessages)))
+	for _, syncMessage := range syncMessages {
+		webMessageInfo := syncMessage.Message
+		if lazyHistory && (webMessageInfo != latestMessage) {
+			continue
 		}
 
+		messageInfo := ParseWebMessageInfo(selfJid, chatJid, webMessageInfo)
+		message := webMessageInfo.GetMessage()
+
+		if (messageInfo == nil) || (message == nil) {
+			continue
+		}
+
+		result.decoder.HandleMessage(*messageInfo, message, true)
+		result.hasMessages = true
 	}
 
-	if (historySync.Data.GetProgress() == 100) &&
-		(historySync.Data.GetSyncType() == waProto.HistorySync_FULL) {
-		LOG_TRACE("Clear Syncing")
-		CWmClearStatus(FlagSyncing)
+	if result.hasMessages {
+		settings, setErr := client.Store.ChatSettings.GetChatSettings(chatJid)
+		if setErr != nil {
+			LOG_WARNING(fmt.Sprintf("Get chat settings failed %#v", setErr))
+		} else {
+			if settings.Found {
+				mutedUntil := settings.MutedUntil.Unix()
+				result.isMuted = (mutedUntil == -1) || (mutedUntil > time.Now().Unix())
+			} else {
+				LOG_WARNING(fmt.Sprintf("Chat settings not found"))
+			}
+		}
 	}
+
+	return result
 }
 
 func (handler *WmEventHandler) HandleGroupInfo(groupInfo *events.GroupInfo) {
@@ -770,10 +1123,10 @@ func (handler *WmEventHandler) HandleGroupInfo(groupInfo *events.GroupInfo) {
 	}
 
 	if text == "" {
-		LOG_TRACE(fmt.Sprintf("HandleGroupInfo ignore"))
+		LOG_TRACE("HandleGroupInfo ignore")
 		return
 	} else {
-		LOG_TRACE(fmt.Sprintf("HandleGroupInfo notify"))
+		LOG_TRACE("HandleGroupInfo notify")
 	}
 
 	fromMe := (senderJidStr == JidToStr(selfJid))
@@ -786,15 +1139,51 @@ func (handler *WmEventHandler) HandleGroupInfo(groupInfo *events.GroupInfo) {
 
 	msgId := strconv.Itoa(timeSent) // group info updates do not have msg id
 
-	LOG_TRACE(fmt.Sprintf("Call CWmNewMessagesNotify %s: %s", chatId, text))
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	LOG_TRACE("Call CWmNewMessagesNotify %s: %s", chatId, text)
+	handler.NewMessagesNotify(false, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+}
+
+func (handler *WmEventHandler) NewMessagesNotify(isSync bool, connId int, chatId string, msgId string, senderId string, text string, fromMe int, quotedId string, fileId string, filePath string, fileStatus int, timeSent int, isRead int) {
+	// history sync messages are batched per chat and passed in a single call to reduce cgo overhead
+	if !isSync || (handler.syncBatches == nil) {
+		CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, fromMe, quotedId, fileId, filePath, fileStatus, timeSent, isRead)
+		return
+	}
+
+	batch, ok := handler.syncBatches[chatId]
+	if !ok {
+		batch = &PackedBatch{}
+		handler.syncBatches[chatId] = batch
+	}
+
+	batch.AppendString(msgId)
+	batch.AppendString(senderId)
+	batch.AppendString(text)
+	batch.AppendInt(fromMe)
+	batch.AppendString(quotedId)
+	batch.AppendString(fileId)
+	batch.AppendString(filePath)
+	batch.AppendInt(fileStatus)
+	batch.AppendInt(timeSent)
+	batch.AppendInt(isRead)
+	batch.count++
+}
+
+func (handler *WmEventHandler) FlushNewMessages() {
+	for chatId, batch := range handler.syncBatches {
+		LOG_TRACE("Call CWmNewMessagesBatchNotify %s: %d", chatId, batch.count)
+		CWmNewMessagesBatchNotify(handler.connId, chatId, batch.buf, batch.count)
+	}
+
+	handler.syncBatches = nil
 }
 
 func (handler *WmEventHandler) HandleDeleteChat(deleteChat *events.DeleteChat) {
 	connId := handler.connId
 	chatId := deleteChat.JID.ToNonAD().String()
+	os.Remove(GetHistoryPath(connId, chatId))
 
-	LOG_TRACE(fmt.Sprintf("Call CWmDeleteChatNotify %s", chatId))
+	LOG_TRACE("Call CWmDeleteChatNotify %s", chatId)
 	CWmDeleteChatNotify(connId, chatId)
 }
 
@@ -809,7 +1198,7 @@ func (handler *WmEventHandler) HandleMute(mute *events.Mute) {
 
 	isMuted := *muteAction.Muted
 
-	LOG_TRACE(fmt.Sprintf("Call CWmUpdateMuteNotify %s %s", chatId, strconv.FormatBool(isMuted)))
+	LOG_TRACE("Call CWmUpdateMuteNotify %s %s", chatId, strconv.FormatBool(isMuted))
 	CWmUpdateMuteNotify(connId, chatId, BoolToInt(isMuted))
 }
 
@@ -839,33 +1228,42 @@ func PhoneFromUserId(userId string) string {
 		phone = strings.Replace(userId, "@s.whatsapp.net", "", 1)
 	}
 
-	LOG_TRACE(fmt.Sprintf("user %s phone %s", userId, phone))
+	LOG_TRACE("user %s phone %s", userId, phone)
 	return phone
 }
 
 func (handler *WmEventHandler) GetContacts() {
 	var client *whatsmeow.Client = GetClient(handler.connId)
 	connId := handler.connId
-	LOG_TRACE(fmt.Sprintf("GetContacts"))
+	LOG_TRACE("GetContacts")
 
 	CWmSetStatus(FlagFetching)
 
+	// all contacts are notified in a single call
+	batch := &PackedBatch{}
+	addContact := func(userId string, name string, phone string, isSelf bool) {
+		batch.AppendString(userId)
+		batch.AppendString(name)
+		batch.AppendString(phone)
+		batch.AppendInt(BoolToInt(isSelf))
+		batch.count++
+		AddContactName(connId, userId, name)
+	}
+
 	// contacts
 	contacts, contErr := client.Store.Contacts.GetAllContacts()
 	if contErr != nil {
 		LOG_WARNING(fmt.Sprintf("get all contacts failed %#v", contErr))
 	} else {
-		LOG_TRACE(fmt.Sprintf("contacts %#v", contacts))
+		LOG_TRACE("contacts %#v", contacts)
 		for jid, contactInfo := range contacts {
 			name := GetNameFromContactInfo(contactInfo)
 			if len(name) > 0 {
 				userId := JidToStr(jid)
 				phone := PhoneFromUserId(userId)
-				LOG_TRACE(fmt.Sprintf("Call CWmNewContactsNotify %s %s", userId, name))
-				CWmNewContactsNotify(connId, userId, name, phone, BoolToInt(false))
-				AddContactName(connId, userId, name)
+				addContact(userId, name, phone, false)
 			} else {
-				LOG_WARNING(fmt.Sprintf("Skip CWmNewContactsNotify %s %#v", JidToStr(jid), contactInfo))
+				LOG_WARNING(fmt.Sprintf("Skip contact %s %#v", JidToStr(jid), contactInfo))
 			}
 		}
 	}
@@ -874,42 +1272,37 @@ func (handler *WmEventHandler) GetContacts() {
 	selfId := JidToStr(*client.Store.ID)
 	selfName := "" // overridden by ui
 	selfPhone := PhoneFromUserId(selfId)
-	LOG_TRACE(fmt.Sprintf("Call CWmNewContactsNotify %s %s", selfId, selfName))
-	CWmNewContactsNotify(connId, selfId, selfName, selfPhone, BoolToInt(true))
-	AddContactName(connId, selfId, selfName)
+	addContact(selfId, selfName, selfPhone, true)
 
 	// special handling for official whatsapp account
 	whatsappId := "0@s.whatsapp.net"
 	whatsappName := "WhatsApp"
 	whatsappPhone := ""
-	LOG_TRACE(fmt.Sprintf("Call CWmNewContactsNotify %s %s", whatsappId, whatsappName))
-	CWmNewContactsNotify(connId, whatsappId, whatsappName, whatsappPhone, BoolToInt(false))
-	AddContactName(connId, whatsappId, whatsappName)
+	addContact(whatsappId, whatsappName, whatsappPhone, false)
 
 	// special handling for status updates
 	statusId := "status@broadcast"
 	statusName := "Status Updates"
 	statusPhone := ""
-	LOG_TRACE(fmt.Sprintf("Call CWmNewContactsNotify %s %s", statusId, statusName))
-	CWmNewContactsNotify(connId, statusId, statusName, statusPhone, BoolToInt(false))
-	AddContactName(connId, statusId, statusName)
+	addContact(statusId, statusName, statusPhone, false)
 
 	// groups
 	groups, groupErr := client.GetJoinedGroups()
 	if groupErr != nil {
 		LOG_WARNING(fmt.Sprintf("get joined groups failed %#v", groupErr))
 	} else {
-		LOG_TRACE(fmt.Sprintf("groups %#v", groups))
+		LOG_TRACE("groups %#v", groups)
 		for _, group := range groups {
 			groupId := JidToStr(group.JID)
 			groupName := group.GroupName.Name
 			groupPhone := ""
-			LOG_TRACE(fmt.Sprintf("Call CWmNewContactsNotify %s %s", groupId, groupName))
-			CWmNewContactsNotify(connId, groupId, groupName, groupPhone, BoolToInt(false))
-			AddContactName(connId, groupId, groupName)
+			addContact(groupId, groupName, groupPhone, false)
 		}
 	}
 
+	LOG_TRACE("Call CWmNewContactsBatchNotify %d", batch.count)
+	CWmNewContactsBatchNotify(connId, batch.buf, batch.count)
+
 	CWmClearStatus(FlagFetching)
 }
 
@@ -942,7 +1335,7 @@ func (handler *WmEventHandler) HandleMessage(messageInfo types.MessageInfo, msg
 }
 
 func (handler *WmEventHandler) HandleTextMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("TextMessage"))
+	LOG_TRACE("TextMessage")
 
 	connId := handler.connId
 	chatId := GetChatId(messageInfo.Chat, messageInfo.Sender)
@@ -977,12 +1370,12 @@ func (handler *WmEventHandler) HandleTextMessage(messageInfo types.MessageInfo,
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	LOG_TRACE(fmt.Sprintf("Call CWmNewMessagesNotify %s: %s", chatId, text))
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	LOG_TRACE("Call CWmNewMessagesNotify %s: %s", chatId, text)
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleImageMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("ImageMessage"))
+	LOG_TRACE("ImageMessage")
 
 	connId := handler.connId
 	var client *whatsmeow.Client = GetClient(handler.connId)
@@ -1029,11 +1422,11 @@ func (handler *WmEventHandler) HandleImageMessage(messageInfo types.MessageInfo,
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleVideoMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("VideoMessage"))
+	LOG_TRACE("VideoMessage")
 
 	connId := handler.connId
 	var client *whatsmeow.Client = GetClient(handler.connId)
@@ -1080,11 +1473,11 @@ func (handler *WmEventHandler) HandleVideoMessage(messageInfo types.MessageInfo,
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleAudioMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("AudioMessage"))
+	LOG_TRACE("AudioMessage")
 
 	connId := handler.connId
 	var client *whatsmeow.Client = GetClient(handler.connId)
@@ -1131,11 +1524,11 @@ func (handler *WmEventHandler) HandleAudioMessage(messageInfo types.MessageInfo,
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleDocumentMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("DocumentMessage"))
+	LOG_TRACE("DocumentMessage")
 
 	connId := handler.connId
 	var client *whatsmeow.Client = GetClient(handler.connId)
@@ -1175,11 +1568,11 @@ func (handler *WmEventHandler) HandleDocumentMessage(messageInfo types.MessageIn
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleStickerMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("StickerMessage"))
+	LOG_TRACE("StickerMessage")
 
 	connId := handler.connId
 	var client *whatsmeow.Client = GetClient(handler.connId)
@@ -1226,11 +1619,11 @@ func (handler *WmEventHandler) HandleStickerMessage(messageInfo types.MessageInf
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleTemplateMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
-	LOG_TRACE(fmt.Sprintf("TemplateMessage"))
+	LOG_TRACE("TemplateMessage")
 
 	connId := handler.connId
 
@@ -1244,7 +1637,7 @@ func (handler *WmEventHandler) HandleTemplateMessage(messageInfo types.MessageIn
 	// handle hydrated template
 	hydtpl := tpl.GetHydratedTemplate()
 	if hydtpl == nil {
-		LOG_TRACE(fmt.Sprintf("unhandled template type"))
+		LOG_TRACE("unhandled template type")
 		return
 	}
 
@@ -1317,7 +1710,7 @@ func (handler *WmEventHandler) HandleTemplateMessage(messageInfo types.MessageIn
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func (handler *WmEventHandler) HandleUnsupportedMessage(messageInfo types.MessageInfo, msg *waProto.Message, isSync bool) {
@@ -1490,10 +1883,10 @@ func (handler *WmEventHandler) HandleUnsupportedMessage(messageInfo types.Messag
 	}
 
 	if !msgNotify {
-		LOG_TRACE(fmt.Sprintf("%s ignore", msgType))
+		LOG_TRACE("%s ignore", msgType)
 		return
 	} else {
-		LOG_TRACE(fmt.Sprintf("%s notify", msgType))
+		LOG_TRACE("%s notify", msgType)
 	}
 
 	connId := handler.connId
@@ -1515,8 +1908,8 @@ func (handler *WmEventHandler) HandleUnsupportedMessage(messageInfo types.Messag
 
 	UpdateTypingStatus(connId, chatId, senderId, fromMe, isOld)
 
-	LOG_TRACE(fmt.Sprintf("Call CWmNewMessagesNotify %s: %s", chatId, text))
-	CWmNewMessagesNotify(connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
+	LOG_TRACE("Call CWmNewMessagesNotify %s: %s", chatId, text)
+	handler.NewMessagesNotify(isSync, connId, chatId, msgId, senderId, text, BoolToInt(fromMe), quotedId, fileId, filePath, fileStatus, timeSent, BoolToInt(isRead))
 }
 
 func UpdateTypingStatus(connId int, chatId string, userId string, fromMe bool, isOld bool) {
@@ -1532,11 +1925,11 @@ func UpdateTypingStatus(connId int, chatId string, userId string, fromMe bool, i
 	isOnline := true
 	isTyping := false
 
-	LOG_TRACE(fmt.Sprintf("Call CWmNewStatusNotify"))
+	LOG_TRACE("Call CWmNewStatusNotify")
 	CWmNewStatusNotify(connId, chatId, userId, BoolToInt(isOnline), BoolToInt(isTyping), -1)
 }
 
-func WmInit(path string, proxy string, sendType int) int {
+func WmInit(path string, proxy string, storeOptions string, sendType int) int {
 
 	LOG_DEBUG("init " + filepath.Base(path))
 
@@ -1553,8 +1946,7 @@ func WmInit(path string, proxy string, sendType int) int {
 
 	dbLog := NcLogger()
 	sessionPath := path + "/session.db"
-	sqlAddress := fmt.Sprintf("file:%s?_foreign_keys=on", sessionPath)
-	container, sqlErr := sqlstore.New("sqlite3", sqlAddress, dbLog)
+	container, sqlErr := OpenSessionStore(sessionPath, storeOptions, dbLog)
 	if sqlErr != nil {
 		LOG_WARNING(fmt.Sprintf("sqlite error %#v", sqlErr))
 		return -1
@@ -1603,7 +1995,7 @@ func WmInit(path string, proxy string, sendType int) int {
 	return connId
 }
 
-func WmLogin(connId int) int {
+func WmLogin(connId int, lazyHistory int) int {
 
 	LOG_DEBUG("login " + strconv.Itoa(connId) + " whatsmeow " + strconv.Itoa(whatsmeowDate))
 
@@ -1613,6 +2005,8 @@ func WmLogin(connId int) int {
 		return -1
 	}
 
+	SetLazyHistory(connId, (lazyHistory == 1))
+
 	// get path and conn
 	var path string = GetPath(connId)
 	var cli *whatsmeow.Client = GetClient(connId)
@@ -1702,6 +2096,37 @@ func WmLogout(connId int) int {
 	return 0
 }
 
+func WmReconnect(connId int) int {
+
+	LOG_DEBUG("reconnect " + strconv.Itoa(connId))
+
+	// sanity check arg
+	if connId == -1 {
+		LOG_WARNING("invalid connId")
+		return -1
+	}
+
+	// get client
+	client := GetClient(connId)
+	if (client == nil) || (client.Store.ID == nil) {
+		// not logged in, nothing to reconnect
+		return -1
+	}
+
+	// drop the possibly stale socket rather than waiting for keepalive to time out, the
+	// server sends missed messages as offline sync once connected again
+	client.Disconnect()
+	err := client.Connect()
+	if err != nil {
+		LOG_WARNING(fmt.Sprintf("reconnect error %#v", err))
+		return -1
+	}
+
+	LOG_DEBUG("reconnect ok")
+
+	return 0
+}
+
 func WmCleanup(connId int) int {
 
 	LOG_DEBUG("cleanup " + strconv.Itoa(connId))
@@ -1714,8 +2139,42 @@ func WmGetVersion() int {
 }
 
 func WmGetMessages(connId int, chatId string, limit int, fromMsgId string, owner int) int {
-	// not supported in multi-device
-	return -1
+	// fetching from server is not supported in multi-device, only lazily stored history is handled
+	handler := GetHandler(connId)
+	client := GetClient(connId)
+	if (handler == nil) || (client == nil) || (client.Store.ID == nil) {
+		return -1
+	}
+
+	handler.syncMx.Lock()
+	defer handler.syncMx.Unlock()
+
+	historyPath := GetHistoryPath(connId, chatId)
+	webMessageInfos, loadErr := LoadHistoryMessages(historyPath)
+	if os.IsNotExist(loadErr) {
+		return -1
+	} else if loadErr != nil {
+		LOG_WARNING(fmt.Sprintf("Load history failed %s %#v", chatId, loadErr))
+	}
+
+	LOG_TRACE("get messages lazy history %s %d", chatId, len(webMessageInfos))
+	selfJid := *client.Store.ID
+	chatJid, _ := types.ParseJID(chatId)
+	handler.syncBatches = make(map[string]*PackedBatch)
+	for _, webMessageInfo := range webMessageInfos {
+		messageInfo := ParseWebMessageInfo(selfJid, chatJid, webMessageInfo)
+		message := webMessageInfo.GetMessage()
+		if (messageInfo == nil) || (message == nil) {
+			continue
+		}
+
+		handler.HandleMessage(*messageInfo, message, true)
+	}
+
+	handler.FlushNewMessages()
+	os.Remove(historyPath)
+
+	return 0
 }
 
 func WmSendMessage(connId int, chatId string, text string, quotedId string, quotedText string, quotedSender string, filePath string, fileType string, editMsgId string, editMsgSent int) int {
@@ -1920,7 +2379,7 @@ func WmSendMessage(connId int, chatId string, text string, quotedId string, quot
 		LOG_WARNING(fmt.Sprintf("send message error %#v", sendErr))
 		return -1
 	} else {
-		LOG_TRACE(fmt.Sprintf("send message ok"))
+		LOG_TRACE("send message ok")
 
 		// messageInfo
 		var messageInfo types.MessageInfo
@@ -1971,7 +2430,7 @@ func WmGetStatus(connId int, userId string) int {
 		LOG_WARNING(fmt.Sprintf("get user status error %#v", err))
 		return -1
 	} else {
-		LOG_TRACE(fmt.Sprintf("get user status ok"))
+		LOG_TRACE("get user status ok")
 	}
 
 	return 0
@@ -2004,7 +2463,48 @@ func WmMarkMessageRead(connId int, chatId string, msgId string) int {
 		LOG_WARNING(fmt.Sprintf("mark message read error %#v", err))
 		return -1
 	} else {
-		LOG_TRACE(fmt.Sprintf("mark message read ok %#v", msgId))
+		LOG_TRACE("mark message read ok %#v", msgId)
+	}
+
+	return 0
+}
+
+func WmMarkMessagesRead(connId int, chatId string, msgIds string) int {
+
+	LOG_TRACE("mark messages read " + strconv.Itoa(connId) + ", " + chatId + ", " + msgIds)
+
+	// sanity check arg
+	if connId == -1 {
+		LOG_WARNING("invalid connId")
+		return -1
+	}
+
+	// get client
+	client := GetClient(connId)
+
+	// mark read, single receipt for all messages
+	var ids []types.MessageID
+	for _, msgId := range strings.Split(msgIds, ",") {
+		if msgId != "" {
+			ids = append(ids, msgId)
+		}
+	}
+
+	if len(ids) == 0 {
+		return 0
+	}
+
+	timeNow := time.Now()
+	selfJid := *client.Store.ID
+	chatJid, _ := types.ParseJID(chatId)
+	err := client.MarkRead(ids, timeNow, chatJid, selfJid)
+
+	// log any error
+	if err != nil {
+		LOG_WARNING(fmt.Sprintf("mark messages read error %#v", err))
+		return -1
+	} else {
+		LOG_TRACE("mark messages read ok %#v", len(ids))
 	}
 
 	return 0
@@ -2031,8 +2531,8 @@ func WmDeleteMessage(connId int, chatId string, senderId string, msgId string) i
 	isGroup := (chatJid.Server == types.GroupServer)
 	isFromSelf := (senderId == selfId)
 	if !isFromSelf && !isGroup {
-		LOG_TRACE(fmt.Sprintf("delete message isGroup %t isFromSelf %t skip %#v",
-			isGroup, isFromSelf, msgId))
+		LOG_TRACE("delete message isGroup %t isFromSelf %t skip %#v",
+			isGroup, isFromSelf, msgId)
 		return -1
 	}
 
@@ -2045,7 +2545,7 @@ func WmDeleteMessage(connId int, chatId string, senderId string, msgId string) i
 		LOG_WARNING(fmt.Sprintf("delete message error %#v", err))
 		return -1
 	} else {
-		LOG_TRACE(fmt.Sprintf("delete message ok %#v", msgId))
+		LOG_TRACE("delete message ok %#v", msgId)
 	}
 
 	return 0
@@ -2077,7 +2577,7 @@ func WmDeleteChat(connId int, chatId string) int {
 			LOG_WARNING(fmt.Sprintf("leave group error %s %#v", chatId, err))
 			return -1
 		} else {
-			LOG_TRACE(fmt.Sprintf("leave group ok (but not deleted) %s", chatId))
+			LOG_TRACE("leave group ok (but not deleted) %s", chatId)
 		}
 	} else {
 		// if private, log warning (function not supported by underlying library)
@@ -2121,7 +2621,7 @@ func WmSendTyping(connId int, chatId string, isTyping int) int {
 		LOG_WARNING(fmt.Sprintf("send typing error %#v", err))
 		return -1
 	} else {
-		LOG_TRACE(fmt.Sprintf("send typing ok"))
+		LOG_TRACE("send typing ok")
 	}
 
 	return 0
@@ -2181,10 +2681,10 @@ func WmDownloadFile(connId int, chatId string, msgId string, fileId string, acti
 	client := GetClient(connId)
 
 	// download file
-	filePath, fileStatus := DownloadFromFileId(client, fileId)
+	filePath, fileStatus, fileSize := DownloadFromFileId(client, connId, chatId, msgId, fileId)
 
 	// notify result
 	CWmNewMessageFileNotify(connId, chatId, msgId, filePath, fileStatus, action)
 
-	return 0
+	return int(fileSize)
 }
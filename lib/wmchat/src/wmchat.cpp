@@ -7,19 +7,27 @@
 
 #include "wmchat.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include <sys/stat.h>
 
 #include "appconfig.h"
+#include "blobstore.h"
 #include "fileutil.h"
 #include "libcgowm.h"
 #include "log.h"
+#include "memorygovernor.h"
 #include "messagecache.h"
+#include "objectpool.h"
+#include "perfstats.h"
 #include "protocolutil.h"
+#include "startupprofile.h"
 #include "status.h"
 #include "strutil.h"
+#include "threadregistry.h"
 #include "timeutil.h"
+#include "trace.h"
 
 std::mutex WmChat::s_ConnIdMapMutex;
 std::map<int, WmChat*> WmChat::s_ConnIdMap;
@@ -84,7 +92,9 @@ bool WmChat::SetupProfile(const std::string& p_ProfilesDir, std::string& p_Profi
 
   std::string proxyUrl = GetProxyUrl();
   int32_t sendType = AppConfig::GetBool("attachment_send_type") ? 1 : 0;
-  int connId = CWmInit(const_cast<char*>(profileDir.c_str()), const_cast<char*>(proxyUrl.c_str()), sendType);
+  const std::string storeOptions = AppConfig::GetStr("whatsapp_store_options");
+  int connId = CWmInit(const_cast<char*>(profileDir.c_str()), const_cast<char*>(proxyUrl.c_str()),
+                       const_cast<char*>(storeOptions.c_str()), sendType);
   if (connId == -1) return false;
 
   m_ConnId = connId;
@@ -110,7 +120,13 @@ bool WmChat::LoadProfile(const std::string& p_ProfilesDir, const std::string& p_
 
   std::string proxyUrl = GetProxyUrl();
   int32_t sendType = AppConfig::GetBool("attachment_send_type") ? 1 : 0;
-  m_ConnId = CWmInit(const_cast<char*>(m_ProfileDir.c_str()), const_cast<char*>(proxyUrl.c_str()), sendType);
+  const std::string storeOptions = AppConfig::GetStr("whatsapp_store_options");
+  {
+    StartupSpan storeSpan("whatsmeow store load " + m_ProfileId);
+    m_ConnId = CWmInit(const_cast<char*>(m_ProfileDir.c_str()), const_cast<char*>(proxyUrl.c_str()),
+                        const_cast<char*>(storeOptions.c_str()), sendType);
+  }
+
   if (m_ConnId == -1) return false;
 
   AddInstance(m_ConnId, this);
@@ -159,10 +175,68 @@ void WmChat::Init()
 {
   const std::map<std::string, std::string> defaultConfig =
   {
+    { "lazy_history_sync", "0" },
     { "profile_display_name", "" },
+    { "rate_limit_read", "20" },
+    { "rate_limit_send", "5" },
+    { "rate_limit_status", "10" },
   };
   const std::string configPath(m_ProfileDir + std::string("/whatsappmd.conf"));
   m_Config = Config(configPath, defaultConfig);
+  InitRateLimits();
+}
+
+void WmChat::InitRateLimits()
+{
+  // request types not listed are local or otherwise throttled, and not rate limited
+  const std::map<std::string, std::vector<MessageType>> groups =
+  {
+    { "rate_limit_read", { MarkMessageReadRequestType, MarkMessagesReadRequestType } },
+    { "rate_limit_send", { SendMessageRequestType, EditMessageRequestType, DeleteMessageRequestType,
+                           DeleteChatRequestType } },
+    { "rate_limit_status", { GetStatusRequestType, SendTypingRequestType, SetStatusRequestType } },
+  };
+
+  m_RateLimiters.clear();
+  for (const auto& group : groups)
+  {
+    std::shared_ptr<RateLimiter> rateLimiter = std::make_shared<RateLimiter>();
+    rateLimiter->rate = std::max(0.0, (double)StrUtil::ToInteger(m_Config.Get(group.first)));
+    rateLimiter->tokens = rateLimiter->rate;
+    for (const auto& messageType : group.second)
+    {
+      m_RateLimiters[messageType] = rateLimiter;
+    }
+  }
+}
+
+void WmChat::RateLimit(MessageType p_MessageType)
+{
+  auto it = m_RateLimiters.find(p_MessageType);
+  if (it == m_RateLimiters.end()) return;
+
+  RateLimiter& rateLimiter = *it->second;
+  if (rateLimiter.rate <= 0) return;
+
+  // refill, allowing bursts of up to one second worth of requests
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  if (rateLimiter.time != 0)
+  {
+    const double elapsedSec = (double)(nowTime - rateLimiter.time) / 1000.0;
+    rateLimiter.tokens = std::min(rateLimiter.rate, rateLimiter.tokens + (elapsedSec * rateLimiter.rate));
+  }
+
+  rateLimiter.time = nowTime;
+  if (rateLimiter.tokens < 1.0)
+  {
+    const double waitSec = (1.0 - rateLimiter.tokens) / rateLimiter.rate;
+    LOG_TRACE("rate limit %d wait %d ms", (int)p_MessageType, (int)(waitSec * 1000));
+    TimeUtil::Sleep(waitSec);
+    rateLimiter.tokens = 1.0;
+    rateLimiter.time = TimeUtil::GetCurrentTimeMSec();
+  }
+
+  rateLimiter.tokens -= 1.0;
 }
 
 void WmChat::Cleanup()
@@ -177,8 +251,29 @@ bool WmChat::Login()
   {
     m_Running = true;
     m_Thread = std::thread(&WmChat::Process, this);
+    m_NotifyThread = std::thread(&WmChat::ProcessNotify, this);
+    m_DownloadScheduler.Init();
+    m_UploadScheduler.Init();
+
+    // go runtime is shared by all whatsapp profiles, its heap is limited to the process budget
+    const int64_t memoryBudget = MemoryGovernor::GetBudgetBytes();
+    if (memoryBudget > 0)
+    {
+      CWmSetMemoryLimit(memoryBudget);
+    }
+
+    // *INDENT-OFF*
+    m_ReclaimerId = MemoryGovernor::AddReclaimer("whatsapp " + m_ProfileId, []()
+    {
+      CWmFreeMemory();
+    });
+    // *INDENT-ON*
 
-    rv = CWmLogin(m_ConnId);
+    // warm start with last known contacts, until contacts are loaded from the store
+    MessageCache::FetchContacts(m_ProfileId);
+
+    const int32_t lazyHistory = (m_Config.Get("lazy_history_sync") == "1") ? 1 : 0;
+    rv = CWmLogin(m_ConnId, lazyHistory);
     Status::Set(Status::FlagOnline);
 
     {
@@ -186,9 +281,7 @@ bool WmChat::Login()
       connectNotify->success = (rv == 0);
       m_WasOnline = connectNotify->success;
 
-      std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-      deferNotifyRequest->serviceMessage = connectNotify;
-      SendRequest(deferNotifyRequest);
+      SendNotify(connectNotify);
     }
   }
   return (rv == 0);
@@ -199,30 +292,51 @@ bool WmChat::Logout()
   int rv = 0;
   if (m_Running)
   {
+    MemoryGovernor::RemoveReclaimer(m_ReclaimerId);
     rv = CWmLogout(m_ConnId);
     Status::Clear(Status::FlagOnline);
 
-    std::unique_lock<std::mutex> lock(m_ProcessMutex);
-    m_Running = false;
-    m_ProcessCondVar.notify_one();
+    // before stopping the notify thread, so that cancelled uploads are reported
+    m_UploadScheduler.Cleanup();
+
+    {
+      std::unique_lock<std::mutex> lock(m_ProcessMutex);
+      m_Running = false;
+      m_ProcessCondVar.notify_one();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(m_NotifyMutex);
+      m_NotifyCondVar.notify_one();
+    }
   }
 
   if (m_Thread.joinable())
   {
     m_Thread.join();
   }
+
+  if (m_NotifyThread.joinable())
+  {
+    m_NotifyThread.join();
+  }
+
+  m_RequestsQueue.LogStats();
+  m_DownloadScheduler.Cleanup();
   return (rv == 0);
 }
 
 void WmChat::Process()
 {
+  ThreadRegistry::Register("wm-request");
+
   while (m_Running)
   {
     std::shared_ptr<RequestMessage> requestMessage;
 
     {
       std::unique_lock<std::mutex> lock(m_ProcessMutex);
-      while (m_RequestsQueue.empty() && m_Running)
+      while (m_RequestsQueue.Empty() && m_Running)
       {
         m_ProcessCondVar.wait(lock);
       }
@@ -238,8 +352,7 @@ void WmChat::Process()
         continue;
       }
 
-      requestMessage = m_RequestsQueue.front();
-      m_RequestsQueue.pop_front();
+      requestMessage = m_RequestsQueue.Pop();
     }
 
     PerformRequest(requestMessage);
@@ -249,7 +362,7 @@ void WmChat::Process()
 void WmChat::SendRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 {
   std::unique_lock<std::mutex> lock(m_ProcessMutex);
-  m_RequestsQueue.push_back(p_RequestMessage);
+  m_RequestsQueue.Push(p_RequestMessage);
   m_ProcessCondVar.notify_one();
 }
 
@@ -257,6 +370,45 @@ void WmChat::SetMessageHandler(const std::function<void(std::shared_ptr<ServiceM
 {
   m_MessageHandler = p_MessageHandler;
   m_ProcessCondVar.notify_one();
+  m_NotifyCondVar.notify_one();
+}
+
+void WmChat::ProcessNotify()
+{
+  ThreadRegistry::Register("wm-notify");
+
+  while (m_Running)
+  {
+    std::deque<std::shared_ptr<ServiceMessage>> serviceMessages;
+
+    {
+      std::unique_lock<std::mutex> lock(m_NotifyMutex);
+      while ((m_NotifyQueue.empty() || !m_MessageHandler) && m_Running)
+      {
+        m_NotifyCondVar.wait(lock);
+      }
+
+      if (!m_Running)
+      {
+        break;
+      }
+
+      // dispatch all queued notifications per wakeup
+      serviceMessages.swap(m_NotifyQueue);
+    }
+
+    for (auto& serviceMessage : serviceMessages)
+    {
+      CallMessageHandler(serviceMessage);
+    }
+  }
+}
+
+void WmChat::SendNotify(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  std::unique_lock<std::mutex> lock(m_NotifyMutex);
+  m_NotifyQueue.push_back(p_ServiceMessage);
+  m_NotifyCondVar.notify_one();
 }
 
 void WmChat::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
@@ -274,7 +426,14 @@ void WmChat::CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage
 
 void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
 {
-  bool requestIntervalDelay = true;
+  if (p_RequestMessage->IsCancelled())
+  {
+    LOG_DEBUG("skip cancelled request %d", p_RequestMessage->GetMessageType());
+    return;
+  }
+
+  TraceSpan requestSpan("WmChat::PerformRequest", "type", p_RequestMessage->GetMessageType());
+  RateLimit(p_RequestMessage->GetMessageType());
 
   switch (p_RequestMessage->GetMessageType())
   {
@@ -322,6 +481,11 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
         LOG_DEBUG("get messages");
         std::shared_ptr<GetMessagesRequest> getMessagesRequest =
           std::static_pointer_cast<GetMessagesRequest>(p_RequestMessage);
+
+        // blocking, materializes lazily stored history sync messages for the chat, if any
+        CWmGetMessages(m_ConnId, const_cast<char*>(getMessagesRequest->chatId.c_str()),
+                       getMessagesRequest->limit, const_cast<char*>(getMessagesRequest->fromMsgId.c_str()), 0);
+
         MessageCache::FetchMessagesFrom(m_ProfileId, getMessagesRequest->chatId,
                                         getMessagesRequest->fromMsgId,
                                         getMessagesRequest->limit, false /* p_Sync */);
@@ -331,7 +495,6 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
     case SendMessageRequestType:
       {
         LOG_DEBUG("send message");
-        Status::Set(Status::FlagSending);
         std::shared_ptr<SendMessageRequest> sendMessageRequest =
           std::static_pointer_cast<SendMessageRequest>(p_RequestMessage);
         std::string chatId = sendMessageRequest->chatId;
@@ -351,6 +514,38 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
           fileType = fileInfo.fileType;
         }
 
+        if (!filePath.empty())
+        {
+          // file sends block on upload, and are pipelined by the upload scheduler
+          // *INDENT-OFF*
+          const int connId = m_ConnId;
+          auto job = [connId, chatId, text, quotedId, quotedText, quotedSender, filePath, fileType]() -> bool
+          {
+            const std::string noEditMsgId;
+            const std::string mimeType = fileType.empty() ? FileUtil::GetMimeType(filePath) : fileType;
+            int rv =
+              CWmSendMessage(connId, const_cast<char*>(chatId.c_str()), const_cast<char*>(text.c_str()),
+                             const_cast<char*>(quotedId.c_str()), const_cast<char*>(quotedText.c_str()),
+                             const_cast<char*>(quotedSender.c_str()), const_cast<char*>(filePath.c_str()),
+                             const_cast<char*>(mimeType.c_str()), const_cast<char*>(noEditMsgId.c_str()), 0);
+            return (rv == 0);
+          };
+
+          auto doneHandler = [this, sendMessageRequest](bool p_Success)
+          {
+            std::shared_ptr<SendMessageNotify> sendMessageNotify = std::make_shared<SendMessageNotify>(m_ProfileId);
+            sendMessageNotify->success = p_Success;
+            sendMessageNotify->chatId = sendMessageRequest->chatId;
+            sendMessageNotify->chatMessage = sendMessageRequest->chatMessage;
+            SendNotify(sendMessageNotify);
+          };
+          // *INDENT-ON*
+
+          m_UploadScheduler.Enqueue(filePath, job, doneHandler);
+          break;
+        }
+
+        Status::Set(Status::FlagSending);
         int rv =
           CWmSendMessage(m_ConnId, const_cast<char*>(chatId.c_str()), const_cast<char*>(text.c_str()),
                          const_cast<char*>(quotedId.c_str()), const_cast<char*>(quotedText.c_str()),
@@ -419,6 +614,27 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
       }
       break;
 
+    case MarkMessagesReadRequestType:
+      {
+        LOG_DEBUG("mark messages read");
+        std::shared_ptr<MarkMessagesReadRequest> markMessagesReadRequest =
+          std::static_pointer_cast<MarkMessagesReadRequest>(p_RequestMessage);
+        std::string chatId = markMessagesReadRequest->chatId;
+        std::string msgIds = StrUtil::Join(markMessagesReadRequest->msgIds, ",");
+
+        int rv = CWmMarkMessagesRead(m_ConnId, const_cast<char*>(chatId.c_str()),
+                                     const_cast<char*>(msgIds.c_str()));
+
+        std::shared_ptr<MarkMessagesReadNotify> markMessagesReadNotify =
+          std::make_shared<MarkMessagesReadNotify>(m_ProfileId);
+        markMessagesReadNotify->success = (rv == 0);
+        markMessagesReadNotify->chatId = markMessagesReadRequest->chatId;
+        markMessagesReadNotify->msgId = markMessagesReadRequest->msgId;
+        markMessagesReadNotify->msgIds = markMessagesReadRequest->msgIds;
+        CallMessageHandler(markMessagesReadNotify);
+      }
+      break;
+
     case DeleteMessageRequestType:
       {
         LOG_DEBUG("delete message");
@@ -517,13 +733,56 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
         std::string msgId = downloadFileRequest->msgId;
         std::string fileId = downloadFileRequest->fileId;
         DownloadFileAction downloadFileAction = downloadFileRequest->downloadFileAction;
+        DownloadFilePriority downloadFilePriority = downloadFileRequest->downloadFilePriority;
 
-        CWmDownloadFile(m_ConnId,
-                        const_cast<char*>(chatId.c_str()),
-                        const_cast<char*>(msgId.c_str()),
-                        const_cast<char*>(fileId.c_str()),
-                        downloadFileAction
-                        );
+        // *INDENT-OFF*
+        auto job = [this, chatId, msgId, fileId, downloadFileAction]() -> int64_t
+        {
+          // file already downloaded in any chat or profile is linked to the target path, which the
+          // download then treats as cached. sha256 of plaintext is verified on download.
+          const std::string fileSha256 = GetFileIdValue(fileId, "FileSha256_arraybyte");
+          const std::string targetPath = GetFileIdValue(fileId, "TargetPath_string");
+          const std::string blobKey = !fileSha256.empty() ? ("sha256-" + fileSha256) : "";
+          if (!blobKey.empty() && !targetPath.empty())
+          {
+            BlobStore::Link(blobKey, targetPath);
+          }
+
+          // blocking, result is notified via WmNewMessageFileNotify, returns downloaded size
+          const int64_t rv = CWmDownloadFile(m_ConnId,
+                                             const_cast<char*>(chatId.c_str()),
+                                             const_cast<char*>(msgId.c_str()),
+                                             const_cast<char*>(fileId.c_str()),
+                                             downloadFileAction
+                                             );
+
+          if (!blobKey.empty() && !targetPath.empty())
+          {
+            BlobStore::Add(blobKey, targetPath);
+          }
+
+          return std::max<int64_t>(rv, 0);
+        };
+
+        auto cancelHandler = [this, chatId, msgId, fileId]()
+        {
+          // reset file status, allowing download to be requested again
+          FileInfo fileInfo;
+          fileInfo.fileStatus = FileStatusNotDownloaded;
+          fileInfo.fileId = fileId;
+
+          std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
+            std::make_shared<NewMessageFileNotify>(m_ProfileId);
+          newMessageFileNotify->chatId = chatId;
+          newMessageFileNotify->msgId = msgId;
+          newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+          newMessageFileNotify->downloadFileAction = DownloadFileActionNone;
+
+          CallMessageHandler(newMessageFileNotify);
+        };
+        // *INDENT-ON*
+
+        m_DownloadScheduler.Enqueue(chatId, downloadFilePriority, job, cancelHandler);
       }
       break;
 
@@ -532,13 +791,21 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
         std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
           std::static_pointer_cast<DeferNotifyRequest>(p_RequestMessage);
         CallMessageHandler(deferNotifyRequest->serviceMessage);
-        requestIntervalDelay = false;
       }
       break;
 
     case SetCurrentChatRequestType:
       {
-        // No handling needed
+        std::shared_ptr<SetCurrentChatRequest> setCurrentChatRequest =
+          std::static_pointer_cast<SetCurrentChatRequest>(p_RequestMessage);
+        m_DownloadScheduler.SetCurrentChat(setCurrentChatRequest->chatId);
+      }
+      break;
+
+    case ReconnectRequestType:
+      {
+        LOG_DEBUG("reconnect");
+        CWmReconnect(m_ConnId);
       }
       break;
 
@@ -546,11 +813,6 @@ void WmChat::PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage)
       LOG_DEBUG("unknown request %d", p_RequestMessage->GetMessageType());
       break;
   }
-
-  if (requestIntervalDelay)
-  {
-    TimeUtil::Sleep(0.050);
-  }
 }
 
 std::string WmChat::GetProxyUrl() const
@@ -574,6 +836,23 @@ std::string WmChat::GetProxyUrl() const
   return "";
 }
 
+// returns string value of key in json encoded file id, or empty if not present or escaped
+std::string WmChat::GetFileIdValue(const std::string& p_FileId, const std::string& p_Key)
+{
+  const std::string& prefix = "\"" + p_Key + "\":\"";
+  const size_t beginPos = p_FileId.find(prefix);
+  if (beginPos == std::string::npos) return "";
+
+  const size_t valuePos = beginPos + prefix.size();
+  const size_t endPos = p_FileId.find('"', valuePos);
+  if (endPos == std::string::npos) return "";
+
+  const std::string value = p_FileId.substr(valuePos, endPos - valuePos);
+  if (value.find('\\') != std::string::npos) return "";
+
+  return value;
+}
+
 void WmChat::AddInstance(int p_ConnId, WmChat* p_Instance)
 {
   std::unique_lock<std::mutex> lock(s_ConnIdMapMutex);
@@ -593,35 +872,84 @@ WmChat* WmChat::GetInstance(int p_ConnId)
   return (it != s_ConnIdMap.end()) ? it->second : nullptr;
 }
 
-void WmNewContactsNotify(int p_ConnId, char* p_ChatId, char* p_Name, char* p_Phone, int p_IsSelf)
+static std::string ToString(const WmString& p_Str)
 {
-  WmChat* instance = WmChat::GetInstance(p_ConnId);
-  if (instance == nullptr) return;
+  return (p_Str.n > 0) ? std::string(p_Str.p, p_Str.n) : std::string();
+}
 
-  ContactInfo contactInfo;
-  contactInfo.id = std::string(p_ChatId);
-  contactInfo.name = std::string(p_Name);
-  contactInfo.phone = std::string(p_Phone);
-  contactInfo.isSelf = (p_IsSelf == 1) ? true : false;
+// @note: max time a history batch waits for cache queue space before being delivered anyway
+static const int s_HistoryQueueWaitMs = 5000;
 
-  std::shared_ptr<NewContactsNotify> newContactsNotify = std::make_shared<NewContactsNotify>(instance->GetProfileId());
-  newContactsNotify->contactInfos = std::vector<ContactInfo>({ contactInfo });
+// packed little-endian fields, keep in sync with PackedBatch in gowm.go
+static bool ReadBatchInt(const char*& p_Pos, const char* p_End, int& p_Value)
+{
+  if ((p_End - p_Pos) < 4) return false;
 
-  std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-  deferNotifyRequest->serviceMessage = newContactsNotify;
-  instance->SendRequest(deferNotifyRequest);
+  const unsigned char* pos = reinterpret_cast<const unsigned char*>(p_Pos);
+  const uint32_t value = (uint32_t)pos[0] | ((uint32_t)pos[1] << 8) | ((uint32_t)pos[2] << 16) |
+    ((uint32_t)pos[3] << 24);
+  p_Value = (int)(int32_t)value;
+  p_Pos += 4;
+  return true;
+}
+
+static bool ReadBatchString(const char*& p_Pos, const char* p_End, std::string& p_Value)
+{
+  int len = 0;
+  if (!ReadBatchInt(p_Pos, p_End, len) || (len < 0) || ((p_End - p_Pos) < len)) return false;
 
-  free(p_ChatId);
-  free(p_Name);
+  p_Value.assign(p_Pos, len);
+  p_Pos += len;
+  return true;
 }
 
-void WmNewChatsNotify(int p_ConnId, char* p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime)
+void WmNewContactsBatchNotify(int p_ConnId, char* p_Buf, int p_BufLen, int p_Count)
 {
+  TraceSpan notifySpan("WmNewContactsBatchNotify");
+  LOG_DEBUG("WaNewContactsBatchNotify %d", p_Count);
+
+  // go owned buffer, counted while held across the cgo call
+  PerfStats::Add(PerfStats::StatHeapCgoBuffers, p_BufLen);
+
+  WmChat* instance = WmChat::GetInstance(p_ConnId);
+  if (instance != nullptr)
+  {
+    std::vector<ContactInfo> contactInfos;
+    contactInfos.reserve(p_Count);
+    const char* pos = p_Buf;
+    const char* end = p_Buf + p_BufLen;
+    for (int i = 0; i < p_Count; ++i)
+    {
+      ContactInfo contactInfo;
+      int isSelf = 0;
+      if (!ReadBatchString(pos, end, contactInfo.id) || !ReadBatchString(pos, end, contactInfo.name) ||
+          !ReadBatchString(pos, end, contactInfo.phone) || !ReadBatchInt(pos, end, isSelf))
+      {
+        LOG_WARNING("invalid contact batch %d / %d", i, p_Count);
+        break;
+      }
+
+      contactInfo.isSelf = (isSelf == 1);
+      contactInfos.push_back(std::move(contactInfo));
+    }
+
+    std::shared_ptr<NewContactsNotify> newContactsNotify =
+      std::make_shared<NewContactsNotify>(instance->GetProfileId());
+    newContactsNotify->contactInfos = std::move(contactInfos);
+    instance->SendNotify(newContactsNotify);
+  }
+
+  PerfStats::Add(PerfStats::StatHeapCgoBuffers, -p_BufLen);
+}
+
+void WmNewChatsNotify(int p_ConnId, WmString p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime)
+{
+  TraceSpan notifySpan("WmNewChatsNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
   ChatInfo chatInfo;
-  chatInfo.id = std::string(p_ChatId);
+  chatInfo.id = ToString(p_ChatId);
   chatInfo.isUnread = (p_IsUnread == 1);
   chatInfo.isUnreadMention = false; // not supported in wa
   chatInfo.isMuted = (p_IsMuted == 1);
@@ -631,152 +959,218 @@ void WmNewChatsNotify(int p_ConnId, char* p_ChatId, int p_IsUnread, int p_IsMute
   newChatsNotify->success = true;
   newChatsNotify->chatInfos = std::vector<ChatInfo>({ chatInfo });
 
-  std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-  deferNotifyRequest->serviceMessage = newChatsNotify;
-  instance->SendRequest(deferNotifyRequest);
-
-  free(p_ChatId);
+  instance->SendNotify(newChatsNotify);
 }
 
-void WmNewMessagesNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_SenderId, char* p_Text, int p_FromMe,
-                         char* p_QuotedId, char* p_FileId, char* p_FilePath, int p_FileStatus, int p_TimeSent,
-                         int p_IsRead)
+static ChatMessage ToChatMessage(std::string&& p_MsgId, std::string&& p_SenderId, std::string&& p_Text,
+                                 int p_FromMe, std::string&& p_QuotedId, std::string&& p_FileId,
+                                 std::string&& p_FilePath, int p_FileStatus, int p_TimeSent, int p_IsRead)
 {
-  LOG_DEBUG("WaNewMessagesNotify");
-
-  WmChat* instance = WmChat::GetInstance(p_ConnId);
-  if (instance == nullptr) return;
-
   std::string fileInfoStr;
-  std::string fileId = std::string(p_FileId);
-  if (!fileId.empty())
+  if (!p_FileId.empty())
   {
     FileInfo fileInfo;
     fileInfo.fileStatus = (FileStatus)p_FileStatus;
-    fileInfo.fileId = fileId;
-    fileInfo.filePath = std::string(p_FilePath);
+    fileInfo.fileId = std::move(p_FileId);
+    fileInfo.filePath = std::move(p_FilePath);
     fileInfoStr = ProtocolUtil::FileInfoToHex(fileInfo);
   }
 
   ChatMessage chatMessage;
-  chatMessage.id = std::string(p_MsgId);
-  chatMessage.senderId = std::string(p_SenderId);
-  chatMessage.text = std::string(p_Text);
+  chatMessage.id = std::move(p_MsgId);
+  chatMessage.senderId = std::move(p_SenderId);
+  chatMessage.text = std::move(p_Text);
   chatMessage.isOutgoing = (p_FromMe == 1);
-  chatMessage.quotedId = std::string(p_QuotedId);
-  chatMessage.fileInfo = fileInfoStr;
-  chatMessage.timeSent = (((int64_t)p_TimeSent) * 1000) + (std::hash<std::string>{ }(chatMessage.id) % 256);
+  chatMessage.quotedId = std::move(p_QuotedId);
+  chatMessage.fileInfo = std::move(fileInfoStr);
+  chatMessage.timeSent = ((int64_t)p_TimeSent) * 1000; // messages sent within the same second are ordered by id
   chatMessage.isRead = (p_IsRead == 1);
+  return chatMessage;
+}
 
-  std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::make_shared<NewMessagesNotify>(instance->GetProfileId());
+static void SendNewMessagesNotify(WmChat* p_Instance, std::string&& p_ChatId,
+                                  std::vector<ChatMessage>&& p_ChatMessages)
+{
+  std::shared_ptr<NewMessagesNotify> newMessagesNotify =
+    std::make_shared<NewMessagesNotify>(p_Instance->GetProfileId());
   newMessagesNotify->success = true;
-  newMessagesNotify->chatId = std::string(p_ChatId);
-  newMessagesNotify->chatMessages = std::vector<ChatMessage>({ chatMessage });
+  newMessagesNotify->chatId = std::move(p_ChatId);
+  newMessagesNotify->chatMessages = std::move(p_ChatMessages);
   newMessagesNotify->cached = false;
   newMessagesNotify->sequence = true;
 
-  std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-  deferNotifyRequest->serviceMessage = newMessagesNotify;
-  instance->SendRequest(deferNotifyRequest);
+  p_Instance->SendNotify(newMessagesNotify);
+}
 
-  free(p_ChatId);
-  free(p_MsgId);
-  free(p_SenderId);
-  free(p_Text);
-  free(p_QuotedId);
-  free(p_FileId);
+void WmNewMessagesNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, WmString p_SenderId, WmString p_Text,
+                         int p_FromMe, WmString p_QuotedId, WmString p_FileId, WmString p_FilePath, int p_FileStatus,
+                         int p_TimeSent, int p_IsRead)
+{
+  TraceSpan notifySpan("WmNewMessagesNotify");
+  LOG_DEBUG("WaNewMessagesNotify");
+
+  WmChat* instance = WmChat::GetInstance(p_ConnId);
+  if (instance != nullptr)
+  {
+    std::vector<ChatMessage> chatMessages;
+    chatMessages.push_back(ToChatMessage(ToString(p_MsgId), ToString(p_SenderId), ToString(p_Text),
+                                         p_FromMe, ToString(p_QuotedId), ToString(p_FileId),
+                                         ToString(p_FilePath), p_FileStatus, p_TimeSent, p_IsRead));
+    SendNewMessagesNotify(instance, ToString(p_ChatId), std::move(chatMessages));
+  }
+}
+
+void WmNewMessagesBatchNotify(int p_ConnId, WmString p_ChatId, char* p_Buf, int p_BufLen, int p_Count)
+{
+  TraceSpan notifySpan("WmNewMessagesBatchNotify");
+  LOG_DEBUG("WaNewMessagesBatchNotify %d", p_Count);
+
+  // go owned buffer, counted while held across the cgo call
+  PerfStats::Add(PerfStats::StatHeapCgoBuffers, p_BufLen);
+
+  WmChat* instance = WmChat::GetInstance(p_ConnId);
+  if (instance != nullptr)
+  {
+    std::vector<ChatMessage> chatMessages;
+    chatMessages.reserve(p_Count);
+    const char* pos = p_Buf;
+    const char* end = p_Buf + p_BufLen;
+    for (int i = 0; i < p_Count; ++i)
+    {
+      std::string msgId, senderId, text, quotedId, fileId, filePath;
+      int fromMe = 0, fileStatus = 0, timeSent = 0, isRead = 0;
+      if (!ReadBatchString(pos, end, msgId) || !ReadBatchString(pos, end, senderId) ||
+          !ReadBatchString(pos, end, text) || !ReadBatchInt(pos, end, fromMe) ||
+          !ReadBatchString(pos, end, quotedId) || !ReadBatchString(pos, end, fileId) ||
+          !ReadBatchString(pos, end, filePath) || !ReadBatchInt(pos, end, fileStatus) ||
+          !ReadBatchInt(pos, end, timeSent) || !ReadBatchInt(pos, end, isRead))
+      {
+        LOG_WARNING("invalid message batch %d / %d", i, p_Count);
+        break;
+      }
+
+      chatMessages.push_back(ToChatMessage(std::move(msgId), std::move(senderId), std::move(text), fromMe,
+                                           std::move(quotedId), std::move(fileId), std::move(filePath),
+                                           fileStatus, timeSent, isRead));
+    }
+
+    if (!chatMessages.empty())
+    {
+      // batches come from history sync, holding the go callback while the cache writer is behind
+      // slows the sync down, bounded so a stalled cache does not stall the connection
+      MessageCache::WaitQueueSpace(instance->GetProfileId(), s_HistoryQueueWaitMs);
+      SendNewMessagesNotify(instance, ToString(p_ChatId), std::move(chatMessages));
+    }
+  }
+
+  PerfStats::Add(PerfStats::StatHeapCgoBuffers, -p_BufLen);
 }
 
-void WmNewStatusNotify(int p_ConnId, char* p_ChatId, char* p_UserId, int p_IsOnline, int p_IsTyping, int p_TimeSeen)
+void WmNewStatusNotify(int p_ConnId, WmString p_ChatId, WmString p_UserId, int p_IsOnline, int p_IsTyping,
+                       int p_TimeSeen)
 {
+  TraceSpan notifySpan("WmNewStatusNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
-  std::string chatId(p_ChatId);
-  std::string userId(p_UserId);
+  std::string chatId = ToString(p_ChatId);
+  std::string userId = ToString(p_UserId);
 
   {
     std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify =
-      std::make_shared<ReceiveStatusNotify>(instance->GetProfileId());
+      ObjectPool::MakeShared<ReceiveStatusNotify>(instance->GetProfileId());
     receiveStatusNotify->userId = userId;
     receiveStatusNotify->isOnline = (p_IsOnline == 1);
     receiveStatusNotify->timeSeen = (p_TimeSeen > 0) ? (((int64_t)p_TimeSeen) * 1000) : -1;
 
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-      std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = receiveStatusNotify;
-    instance->SendRequest(deferNotifyRequest);
+    instance->SendNotify(receiveStatusNotify);
   }
 
   if (!chatId.empty())
   {
     std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify =
-      std::make_shared<ReceiveTypingNotify>(instance->GetProfileId());
+      ObjectPool::MakeShared<ReceiveTypingNotify>(instance->GetProfileId());
     receiveTypingNotify->chatId = chatId;
     receiveTypingNotify->userId = userId;
     receiveTypingNotify->isTyping = (p_IsTyping == 1);
 
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-      std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = receiveTypingNotify;
-    instance->SendRequest(deferNotifyRequest);
+    instance->SendNotify(receiveTypingNotify);
   }
-
-  free(p_ChatId);
-  free(p_UserId);
 }
 
-void WmNewMessageStatusNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, int p_IsRead)
+void WmNewMessageStatusNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, int p_IsRead)
 {
+  TraceSpan notifySpan("WmNewMessageStatusNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
+  if (p_IsRead == 1)
   {
-    std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
-      std::make_shared<NewMessageStatusNotify>(instance->GetProfileId());
-    newMessageStatusNotify->chatId = std::string(p_ChatId);
-    newMessageStatusNotify->msgId = std::string(p_MsgId);
-    newMessageStatusNotify->isRead = (p_IsRead == 1);
-
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = newMessageStatusNotify;
-    instance->SendRequest(deferNotifyRequest);
+    // read receipts are for sent messages, and imply earlier ones were read too
+    std::shared_ptr<ReadOutboxNotify> readOutboxNotify =
+      ObjectPool::MakeShared<ReadOutboxNotify>(instance->GetProfileId());
+    readOutboxNotify->chatId = ToString(p_ChatId);
+    readOutboxNotify->msgId = ToString(p_MsgId);
+
+    instance->SendNotify(readOutboxNotify);
   }
+  else
+  {
+    std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
+      ObjectPool::MakeShared<NewMessageStatusNotify>(instance->GetProfileId());
+    newMessageStatusNotify->chatId = ToString(p_ChatId);
+    newMessageStatusNotify->msgId = ToString(p_MsgId);
+    newMessageStatusNotify->isRead = false;
 
-  free(p_ChatId);
-  free(p_MsgId);
+    instance->SendNotify(newMessageStatusNotify);
+  }
 }
 
-void WmNewMessageFileNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_FilePath, int p_FileStatus,
+void WmNewMessageFileNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, WmString p_FilePath, int p_FileStatus,
                             int p_Action)
 {
+  TraceSpan notifySpan("WmNewMessageFileNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
   {
     FileInfo fileInfo;
     fileInfo.fileStatus = static_cast<FileStatus>(p_FileStatus);
-    fileInfo.filePath = std::string(p_FilePath);
+    fileInfo.filePath = ToString(p_FilePath);
 
     std::shared_ptr<NewMessageFileNotify> newMessageFileNotify =
       std::make_shared<NewMessageFileNotify>(instance->GetProfileId());
-    newMessageFileNotify->chatId = std::string(p_ChatId);
-    newMessageFileNotify->msgId = std::string(p_MsgId);
+    newMessageFileNotify->chatId = ToString(p_ChatId);
+    newMessageFileNotify->msgId = ToString(p_MsgId);
     newMessageFileNotify->fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
     newMessageFileNotify->downloadFileAction = static_cast<DownloadFileAction>(p_Action);
 
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest = std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = newMessageFileNotify;
-    instance->SendRequest(deferNotifyRequest);
+    instance->SendNotify(newMessageFileNotify);
   }
+}
 
-  free(p_ChatId);
-  free(p_MsgId);
-  free(p_FilePath);
+void WmNewMessageFileProgressNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, long long p_Downloaded,
+                                    long long p_Total)
+{
+  TraceSpan notifySpan("WmNewMessageFileProgressNotify");
+  WmChat* instance = WmChat::GetInstance(p_ConnId);
+  if (instance == nullptr) return;
+
+  {
+    std::shared_ptr<NewMessageFileProgressNotify> newMessageFileProgressNotify =
+      std::make_shared<NewMessageFileProgressNotify>(instance->GetProfileId());
+    newMessageFileProgressNotify->chatId = ToString(p_ChatId);
+    newMessageFileProgressNotify->msgId = ToString(p_MsgId);
+    newMessageFileProgressNotify->downloadedBytes = p_Downloaded;
+    newMessageFileProgressNotify->totalBytes = p_Total;
+
+    instance->SendNotify(newMessageFileProgressNotify);
+  }
 }
 
-void WmDeleteChatNotify(int p_ConnId, char* p_ChatId)
+void WmDeleteChatNotify(int p_ConnId, WmString p_ChatId)
 {
+  TraceSpan notifySpan("WmDeleteChatNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
@@ -784,19 +1178,15 @@ void WmDeleteChatNotify(int p_ConnId, char* p_ChatId)
     std::shared_ptr<DeleteChatNotify> deleteChatNotify =
       std::make_shared<DeleteChatNotify>(instance->GetProfileId());
     deleteChatNotify->success = true;
-    deleteChatNotify->chatId = std::string(p_ChatId);
+    deleteChatNotify->chatId = ToString(p_ChatId);
 
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-      std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = deleteChatNotify;
-    instance->SendRequest(deferNotifyRequest);
+    instance->SendNotify(deleteChatNotify);
   }
-
-  free(p_ChatId);
 }
 
-void WmUpdateMuteNotify(int p_ConnId, char* p_ChatId, int p_IsMuted)
+void WmUpdateMuteNotify(int p_ConnId, WmString p_ChatId, int p_IsMuted)
 {
+  TraceSpan notifySpan("WmUpdateMuteNotify");
   WmChat* instance = WmChat::GetInstance(p_ConnId);
   if (instance == nullptr) return;
 
@@ -804,16 +1194,11 @@ void WmUpdateMuteNotify(int p_ConnId, char* p_ChatId, int p_IsMuted)
     std::shared_ptr<UpdateMuteNotify> updateMuteNotify =
       std::make_shared<UpdateMuteNotify>(instance->GetProfileId());
     updateMuteNotify->success = true;
-    updateMuteNotify->chatId = std::string(p_ChatId);
+    updateMuteNotify->chatId = ToString(p_ChatId);
     updateMuteNotify->isMuted = p_IsMuted;
 
-    std::shared_ptr<DeferNotifyRequest> deferNotifyRequest =
-      std::make_shared<DeferNotifyRequest>();
-    deferNotifyRequest->serviceMessage = updateMuteNotify;
-    instance->SendRequest(deferNotifyRequest);
+    instance->SendNotify(updateMuteNotify);
   }
-
-  free(p_ChatId);
 }
 
 void WmSetStatus(int p_Flags)
@@ -826,27 +1211,42 @@ void WmClearStatus(int p_Flags)
   Status::Clear(p_Flags);
 }
 
-void WmLogTrace(char* p_Filename, int p_LineNo, char* p_Message)
+void WmStoreLatency(int p_Usec)
+{
+  PerfStats::Record(PerfStats::StatWmStoreUs, p_Usec);
+}
+
+int WmLogTraceEnabled()
+{
+  return Log::GetTraceEnabled() ? 1 : 0;
+}
+
+int WmLogDebugEnabled()
+{
+  return Log::GetDebugEnabled() ? 1 : 0;
+}
+
+void WmLogTrace(WmString p_Filename, int p_LineNo, WmString p_Message)
 {
-  Log::Trace(p_Filename, p_LineNo, "%s", p_Message);
+  Log::Trace(ToString(p_Filename).c_str(), p_LineNo, "%.*s", (int)p_Message.n, p_Message.p);
 }
 
-void WmLogDebug(char* p_Filename, int p_LineNo, char* p_Message)
+void WmLogDebug(WmString p_Filename, int p_LineNo, WmString p_Message)
 {
-  Log::Debug(p_Filename, p_LineNo, "%s", p_Message);
+  Log::Debug(ToString(p_Filename).c_str(), p_LineNo, "%.*s", (int)p_Message.n, p_Message.p);
 }
 
-void WmLogInfo(char* p_Filename, int p_LineNo, char* p_Message)
+void WmLogInfo(WmString p_Filename, int p_LineNo, WmString p_Message)
 {
-  Log::Info(p_Filename, p_LineNo, "%s", p_Message);
+  Log::Info(ToString(p_Filename).c_str(), p_LineNo, "%.*s", (int)p_Message.n, p_Message.p);
 }
 
-void WmLogWarning(char* p_Filename, int p_LineNo, char* p_Message)
+void WmLogWarning(WmString p_Filename, int p_LineNo, WmString p_Message)
 {
-  Log::Warning(p_Filename, p_LineNo, "%s", p_Message);
+  Log::Warning(ToString(p_Filename).c_str(), p_LineNo, "%.*s", (int)p_Message.n, p_Message.p);
 }
 
-void WmLogError(char* p_Filename, int p_LineNo, char* p_Message)
+void WmLogError(WmString p_Filename, int p_LineNo, WmString p_Message)
 {
-  Log::Error(p_Filename, p_LineNo, "%s", p_Message);
+  Log::Error(ToString(p_Filename).c_str(), p_LineNo, "%.*s", (int)p_Message.n, p_Message.p);
 }
@@ -8,15 +8,22 @@
 #pragma once
 
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <map>
+#include <memory>
 #include <thread>
 
 #include "config.h"
+#include "downloadscheduler.h"
 #include "protocol.h"
+#include "requestqueue.h"
+#include "uploadscheduler.h"
 
 class WmChat : public Protocol
 {
+  friend class WmChatBench; // dev/wmbench.cpp
+
 public:
   WmChat();
   virtual ~WmChat();
@@ -43,13 +50,19 @@ public:
   static void AddInstance(int p_ConnId, WmChat* p_Instance);
   static void RemoveInstance(int p_ConnId);
   static WmChat* GetInstance(int p_ConnId);
+  // service notifications from the go library, dispatched separately from requests
+  void SendNotify(std::shared_ptr<ServiceMessage> p_ServiceMessage);
 
 private:
   void Init();
   void Cleanup();
   void CallMessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
   void PerformRequest(std::shared_ptr<RequestMessage> p_RequestMessage);
+  void ProcessNotify();
+  void InitRateLimits();
+  void RateLimit(MessageType p_MessageType);
   std::string GetProxyUrl() const;
+  static std::string GetFileIdValue(const std::string& p_FileId, const std::string& p_Key);
 
 private:
   std::string m_ProfileId;
@@ -57,40 +70,71 @@ private:
 
   bool m_Running = false;
   std::thread m_Thread;
-  std::deque<std::shared_ptr<RequestMessage>> m_RequestsQueue;
+  RequestQueue m_RequestsQueue;
   std::mutex m_ProcessMutex;
   std::condition_variable m_ProcessCondVar;
+  std::thread m_NotifyThread;
+  std::deque<std::shared_ptr<ServiceMessage>> m_NotifyQueue;
+  std::mutex m_NotifyMutex;
+  std::condition_variable m_NotifyCondVar;
 
   static std::mutex s_ConnIdMapMutex;
   static std::map<int, WmChat*> s_ConnIdMap;
   int m_ConnId = -1;
   std::string m_ProfileDir;
   Config m_Config;
+  DownloadScheduler m_DownloadScheduler;
+  UploadScheduler m_UploadScheduler;
+  int m_ReclaimerId = 0;
+
+  // token bucket per group of request types
+  struct RateLimiter
+  {
+    double rate = 0; // requests per second, zero for unlimited
+    double tokens = 0;
+    int64_t time = 0;
+  };
+
+  std::map<MessageType, std::shared_ptr<RateLimiter>> m_RateLimiters;
   int m_WhatsmeowDate = 0;
   int m_ProfileDirVersion = 0;
   bool m_WasOnline = false;
   static const int s_CacheDirVersion = 0;
 };
 
+// go string passed by value from cgo, points into go memory only valid for the duration of the call
+#ifndef GO_CGO_GOSTRING_TYPEDEF
+#define GO_CGO_GOSTRING_TYPEDEF
+typedef struct { const char* p; ptrdiff_t n; } _GoString_;
+#endif
+typedef _GoString_ WmString;
+
 extern "C" {
-void WmNewContactsNotify(int p_ConnId, char* p_ChatId, char* p_Name, char* p_Phone, int p_IsSelf);
-void WmNewChatsNotify(int p_ConnId, char* p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime);
-void WmNewMessagesNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_SenderId, char* p_Text, int p_FromMe,
-                         char* p_ReplyId, char* p_FileId, char* p_FilePath, int p_FileStatus, int p_TimeSent,
-                         int p_IsRead);
-void WmNewStatusNotify(int p_ConnId, char* p_ChatId, char* p_UserId, int p_IsOnline, int p_IsTyping, int p_TimeSeen);
-void WmNewMessageStatusNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, int p_IsRead);
-void WmNewMessageFileNotify(int p_ConnId, char* p_ChatId, char* p_MsgId, char* p_FilePath, int p_FileStatus,
+void WmNewContactsBatchNotify(int p_ConnId, char* p_Buf, int p_BufLen, int p_Count);
+void WmNewChatsNotify(int p_ConnId, WmString p_ChatId, int p_IsUnread, int p_IsMuted, int p_LastMessageTime);
+void WmNewMessagesNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, WmString p_SenderId, WmString p_Text,
+                         int p_FromMe, WmString p_ReplyId, WmString p_FileId, WmString p_FilePath, int p_FileStatus,
+                         int p_TimeSent, int p_IsRead);
+void WmNewMessagesBatchNotify(int p_ConnId, WmString p_ChatId, char* p_Buf, int p_BufLen, int p_Count);
+void WmNewStatusNotify(int p_ConnId, WmString p_ChatId, WmString p_UserId, int p_IsOnline, int p_IsTyping,
+                       int p_TimeSeen);
+void WmNewMessageStatusNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, int p_IsRead);
+void WmNewMessageFileNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, WmString p_FilePath, int p_FileStatus,
                             int p_Action);
-void WmDeleteChatNotify(int p_ConnId, char* p_ChatId);
-void WmUpdateMuteNotify(int p_ConnId, char* p_ChatId, int p_IsMuted);
+void WmNewMessageFileProgressNotify(int p_ConnId, WmString p_ChatId, WmString p_MsgId, long long p_Downloaded,
+                                    long long p_Total);
+void WmDeleteChatNotify(int p_ConnId, WmString p_ChatId);
+void WmUpdateMuteNotify(int p_ConnId, WmString p_ChatId, int p_IsMuted);
 void WmSetStatus(int p_Flags);
 void WmClearStatus(int p_Flags);
-void WmLogTrace(char* p_Filename, int p_LineNo, char* p_Message);
-void WmLogDebug(char* p_Filename, int p_LineNo, char* p_Message);
-void WmLogInfo(char* p_Filename, int p_LineNo, char* p_Message);
-void WmLogWarning(char* p_Filename, int p_LineNo, char* p_Message);
-void WmLogError(char* p_Filename, int p_LineNo, char* p_Message);
+void WmStoreLatency(int p_Usec);
+int WmLogTraceEnabled();
+int WmLogDebugEnabled();
+void WmLogTrace(WmString p_Filename, int p_LineNo, WmString p_Message);
+void WmLogDebug(WmString p_Filename, int p_LineNo, WmString p_Message);
+void WmLogInfo(WmString p_Filename, int p_LineNo, WmString p_Message);
+void WmLogWarning(WmString p_Filename, int p_LineNo, WmString p_Message);
+void WmLogError(WmString p_Filename, int p_LineNo, WmString p_Message);
 }
 
 extern "C" WmChat* CreateWmChat();
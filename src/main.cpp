@@ -5,11 +5,17 @@
 //
 // nchat is distributed under the MIT license, see LICENSE for details.
 
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <cassert>
 #include <dlfcn.h>
@@ -18,11 +24,25 @@
 
 #include "appconfig.h"
 #include "apputil.h"
+#include "backgroundexecutor.h"
+#include "coreclient.h"
+#include "corelink.h"
+#include "coreserver.h"
 #include "fileutil.h"
 #include "log.h"
+#include "memorygovernor.h"
 #include "messagecache.h"
+#include "messagerecorder.h"
+#include "offlinechat.h"
+#include "ondemandchat.h"
+#include "previewstore.h"
 #include "profiles.h"
 #include "scopeddirlock.h"
+#include "startupprofile.h"
+#include "status.h"
+#include "threadregistry.h"
+#include "timeutil.h"
+#include "trace.h"
 #include "ui.h"
 
 #ifdef HAS_DUMMY
@@ -38,6 +58,7 @@
 #endif
 
 static void RemoveProfile();
+static void RunConcurrently(const std::vector<std::function<void()>>& p_Jobs);
 static std::shared_ptr<Protocol> SetupProfile();
 static void ShowHelp();
 static void ShowVersion();
@@ -49,6 +70,7 @@ public:
   ProtocolBaseFactory() { }
   virtual ~ProtocolBaseFactory() { }
   virtual std::string GetName() const = 0;
+  virtual void Preload() const = 0;
   virtual std::shared_ptr<Protocol> Create() const = 0;
 };
 
@@ -61,33 +83,19 @@ public:
     return T::GetName();
   }
 
+  virtual void Preload() const
+  {
+#ifdef HAS_DYNAMICLOAD
+    LoadCreateFunc();
+#endif
+  }
+
   virtual std::shared_ptr<Protocol> Create() const
   {
     std::shared_ptr<T> protocol;
 #ifdef HAS_DYNAMICLOAD
-    std::string libPath =
-      FileUtil::DirName(FileUtil::GetSelfPath()) + "/../lib/" + T::GetLibName() + FileUtil::GetLibSuffix();
-    std::string createFunc = T::GetCreateFunc();
-    void* handle = dlopen(libPath.c_str(), RTLD_LAZY);
-    if (handle == nullptr)
-    {
-      LOG_ERROR("failed dlopen %s", libPath.c_str());
-      const char* dlerr = dlerror();
-      if (dlerr != nullptr)
-      {
-        LOG_ERROR("dlerror %s", dlerr);
-      }
-
-      std::cout << "Failed to load " << libPath << ", skipping profile.\n";
-      return protocol;
-    }
-
-    T* (* CreateFunc)() = (T * (*)())dlsym(handle, createFunc.c_str());
-    if (CreateFunc == nullptr)
-    {
-      LOG_ERROR("failed dlsym %s", createFunc.c_str());
-      return protocol;
-    }
+    T* (* CreateFunc)() = LoadCreateFunc();
+    if (CreateFunc == nullptr) return protocol;
 
     protocol.reset(CreateFunc());
 #else
@@ -95,6 +103,45 @@ public:
 #endif
     return protocol;
   }
+
+#ifdef HAS_DYNAMICLOAD
+private:
+  static T* (*LoadCreateFunc())()
+  {
+    // library is loaded once, concurrent callers wait for the first to complete
+    static std::once_flag onceFlag;
+    static T* (* CreateFunc)() = nullptr;
+    // *INDENT-OFF*
+    std::call_once(onceFlag, []()
+    {
+      std::string libPath =
+        FileUtil::DirName(FileUtil::GetSelfPath()) + "/../lib/" + T::GetLibName() + FileUtil::GetLibSuffix();
+      std::string createFunc = T::GetCreateFunc();
+      StartupSpan dlopenSpan("dlopen " + T::GetLibName());
+      // symbols are resolved up front while off the main thread, instead of lazily on first use
+      void* handle = dlopen(libPath.c_str(), RTLD_NOW);
+      if (handle == nullptr)
+      {
+        LOG_ERROR("failed dlopen %s", libPath.c_str());
+        const char* dlerr = dlerror();
+        if (dlerr != nullptr)
+        {
+          LOG_ERROR("dlerror %s", dlerr);
+        }
+
+        return;
+      }
+
+      CreateFunc = (T * (*)())dlsym(handle, createFunc.c_str());
+      if (CreateFunc == nullptr)
+      {
+        LOG_ERROR("failed dlsym %s", createFunc.c_str());
+      }
+    });
+    // *INDENT-ON*
+    return CreateFunc;
+  }
+#endif
 };
 
 static std::vector<ProtocolBaseFactory*> GetProtocolFactorys()
@@ -125,13 +172,27 @@ int main(int argc, char* argv[])
 
   // Argument handling
   std::string exportDir;
+  std::string exportFormat = "txt";
+  bool isExportIncremental = false;
+  bool isAttach = false;
+  bool isCore = false;
+  std::string recordPath;
   bool isKeyDump = false;
+  bool isOffline = false;
   bool isRemove = false;
   bool isSetup = false;
   std::vector<std::string> args(argv + 1, argv + argc);
   for (auto it = args.begin(); it != args.end(); ++it)
   {
-    if (((*it == "-d") || (*it == "--confdir")) && (std::distance(it + 1, args.end()) > 0))
+    if ((*it == "-a") || (*it == "--attach"))
+    {
+      isAttach = true;
+    }
+    else if ((*it == "-c") || (*it == "--core"))
+    {
+      isCore = true;
+    }
+    else if (((*it == "-d") || (*it == "--confdir")) && (std::distance(it + 1, args.end()) > 0))
     {
       ++it;
       FileUtil::SetApplicationDir(*it);
@@ -163,14 +224,27 @@ int main(int argc, char* argv[])
       sleep(5);
       AppUtil::SetDeveloperMode(true);
     }
+    else if ((*it == "-o") || (*it == "--offline"))
+    {
+      isOffline = true;
+    }
     else if ((*it == "-r") || (*it == "--remove"))
     {
       isRemove = true;
     }
+    else if (((*it == "-rc") || (*it == "--record")) && (std::distance(it + 1, args.end()) > 0))
+    {
+      ++it;
+      recordPath = *it;
+    }
     else if ((*it == "-s") || (*it == "--setup"))
     {
       isSetup = true;
     }
+    else if ((*it == "-sp") || (*it == "--startup-profile"))
+    {
+      StartupProfile::SetEnabled(true);
+    }
     else if ((*it == "-v") || (*it == "--version"))
     {
       ShowVersion();
@@ -181,6 +255,16 @@ int main(int argc, char* argv[])
       ++it;
       exportDir = *it;
     }
+    else if (((*it == "-xf") || (*it == "--export-format")) && (std::distance(it + 1, args.end()) > 0) &&
+             MessageCache::IsExportFormat(*(it + 1)))
+    {
+      ++it;
+      exportFormat = *it;
+    }
+    else if ((*it == "-xi") || (*it == "--export-incremental"))
+    {
+      isExportIncremental = true;
+    }
     else
     {
       ShowHelp();
@@ -188,6 +272,18 @@ int main(int argc, char* argv[])
     }
   }
 
+  if (isAttach && (isCore || isRemove || isSetup || !exportDir.empty()))
+  {
+    std::cerr << "error: attach cannot be combined with core, remove, setup or export.\n";
+    return 1;
+  }
+
+  if (isOffline && (isAttach || isCore || isRemove || isSetup))
+  {
+    std::cerr << "error: offline cannot be combined with attach, core, remove or setup.\n";
+    return 1;
+  }
+
   bool isDirInited = false;
   static const int dirVersion = 1;
   if (!apathy::Path(FileUtil::GetApplicationDir()).exists())
@@ -196,8 +292,9 @@ int main(int argc, char* argv[])
     isDirInited = true;
   }
 
+  // an attaching client shares the config dir locked by the core daemon
   ScopedDirLock dirLock(FileUtil::GetApplicationDir());
-  if (!dirLock.IsLocked())
+  if (!dirLock.IsLocked() && !isAttach)
   {
     std::cerr <<
       "error: unable to acquire lock for " << FileUtil::GetApplicationDir() << "\n" <<
@@ -233,7 +330,7 @@ int main(int argc, char* argv[])
   Profiles::Init();
 
   // Init logging
-  const std::string& logPath = FileUtil::GetApplicationDir() + std::string("/log.txt");
+  const std::string& logPath = FileUtil::GetApplicationDir() + std::string(isAttach ? "/attach-log.txt" : "/log.txt");
   Log::Init(logPath);
   std::string appNameVersion = AppUtil::GetAppNameVersion();
   LOG_INFO("starting %s", appNameVersion.c_str());
@@ -249,6 +346,7 @@ int main(int argc, char* argv[])
   }
 
   // Init app config
+  std::unique_ptr<StartupSpan> initSpan(new StartupSpan("app init"));
   AppConfig::Init();
   FileUtil::SetDownloadsDir(AppConfig::GetStr("downloads_dir"));
 
@@ -263,8 +361,33 @@ int main(int argc, char* argv[])
 #endif
   }
 
+  // Init tracing
+  Trace::Init();
+  ThreadRegistry::Register(isCore ? "core" : "ui");
+
+  // Init memory budget
+  MemoryGovernor::Init();
+
   // Init message cache
+  if (isOffline && !AppConfig::GetBool("cache_enabled"))
+  {
+    std::cerr << "error: offline mode requires cache_enabled=1.\n";
+    MemoryGovernor::Cleanup();
+    AppConfig::Cleanup();
+    return 1;
+  }
+
+  BackgroundExecutor::Init();
+  MessageCache::SetReadOnly(isOffline);
   MessageCache::Init();
+  PreviewStore::Init();
+  initSpan.reset();
+
+  // Init service message recording
+  if (!recordPath.empty())
+  {
+    MessageRecorder::Open(recordPath);
+  }
 
   // Run setup if required
   std::shared_ptr<Protocol> setupProtocol;
@@ -273,23 +396,62 @@ int main(int argc, char* argv[])
     setupProtocol = SetupProfile();
     if (!setupProtocol)
     {
+      PreviewStore::Cleanup();
+      MemoryGovernor::Cleanup();
       MessageCache::Cleanup();
+      BackgroundExecutor::Cleanup();
       AppConfig::Cleanup();
       return 1;
     }
   }
 
-  // Init ui
-  std::shared_ptr<Ui> ui = std::make_shared<Ui>();
+  // Attach to core daemon, which owns the profiles
+  std::shared_ptr<CoreClient> coreClient;
+  if (isAttach)
+  {
+    coreClient = std::make_shared<CoreClient>();
+    if (!coreClient->Connect(CoreLink::GetSocketPath()))
+    {
+      std::cerr << "error: unable to attach to nchat core at " << CoreLink::GetSocketPath() << "\n";
+      PreviewStore::Cleanup();
+      MemoryGovernor::Cleanup();
+      MessageCache::Cleanup();
+      BackgroundExecutor::Cleanup();
+      AppConfig::Cleanup();
+      return 1;
+    }
+  }
+
+  // Init ui, or core server when running headless
+  std::shared_ptr<Ui> ui;
+  std::shared_ptr<CoreServer> coreServer;
+  std::function<void(std::shared_ptr<ServiceMessage>)> messageHandler;
+  if (isCore)
+  {
+    coreServer = std::make_shared<CoreServer>();
+    messageHandler = std::bind(&CoreServer::MessageHandler, std::ref(*coreServer), std::placeholders::_1);
+  }
+  else
+  {
+    ui = std::make_shared<Ui>();
+    messageHandler = std::bind(&Ui::MessageHandler, std::ref(*ui), std::placeholders::_1);
+  }
 
   // Set message cache message handler
-  std::function<void(std::shared_ptr<ServiceMessage>)> messageHandler =
-    std::bind(&Ui::MessageHandler, std::ref(*ui), std::placeholders::_1);
   MessageCache::SetMessageHandler(messageHandler);
 
-  // Load profile(s)
+  // Load profile(s), existing profiles are loaded concurrently and added in listing order
+  std::unique_ptr<StartupSpan> loadSpan(new StartupSpan("load profiles"));
+  std::vector<std::shared_ptr<Protocol>> loadProtocols;
+  std::vector<std::function<void()>> preloadJobs;
+  std::vector<std::function<void()>> loadJobs;
+  std::set<std::string> preloadNames;
+  std::mutex loadErrorsMutex;
+  std::vector<std::string> loadErrors;
   std::string profilesDir = FileUtil::GetApplicationDir() + "/profiles";
-  const std::vector<apathy::Path>& profilePaths = apathy::Path::listdir(profilesDir);
+  // attached clients use the profiles of the core daemon
+  const std::vector<apathy::Path> profilePaths =
+    isAttach ? std::vector<apathy::Path>() : apathy::Path::listdir(profilesDir);
   for (auto& profilePath : profilePaths)
   {
     std::string profileId = profilePath.filename();
@@ -304,17 +466,33 @@ int main(int argc, char* argv[])
     }
 
 #ifndef HAS_MULTIPROTOCOL
-    if (!ui->GetProtocols().empty())
+    if (!loadProtocols.empty())
     {
       LOG_WARNING("multiple profile support not enabled, skipping %s", profileId.c_str());
       continue;
     }
 #endif
 
-    if (setupProtocol && (setupProtocol->GetProfileId() == profileId))
+    if (isOffline)
+    {
+      // served from message cache only, protocol libraries are not loaded
+      const size_t index = loadProtocols.size();
+      loadProtocols.push_back(nullptr);
+      // *INDENT-OFF*
+      loadJobs.push_back([&loadProtocols, index, profilesDir, profileId]()
+      {
+        LOG_DEBUG("loading offline profile %s", profileId.c_str());
+        StartupSpan profileSpan("load " + profileId);
+        std::shared_ptr<Protocol> protocol = std::make_shared<OfflineChat>(profileId);
+        protocol->LoadProfile(profilesDir, profileId);
+        loadProtocols[index] = protocol;
+      });
+      // *INDENT-ON*
+    }
+    else if (setupProtocol && (setupProtocol->GetProfileId() == profileId))
     {
       LOG_DEBUG("adding new profile %s", profileId.c_str());
-      ui->AddProtocol(setupProtocol);
+      loadProtocols.push_back(setupProtocol);
       setupProtocol.reset();
     }
     else
@@ -325,14 +503,47 @@ int main(int argc, char* argv[])
       {
         if (protocolFactory->GetName() == protocolName)
         {
-          LOG_DEBUG("loading existing profile %s", profileId.c_str());
-          std::shared_ptr<Protocol> protocol = protocolFactory->Create();
-          if (protocol)
+          const size_t index = loadProtocols.size();
+          loadProtocols.push_back(nullptr);
+          // *INDENT-OFF*
+          if (preloadNames.insert(protocolName).second)
           {
-            protocol->LoadProfile(profilesDir, profileId);
-            ui->AddProtocol(protocol);
-            found = true;
+            preloadJobs.push_back([protocolFactory]()
+            {
+              protocolFactory->Preload();
+            });
           }
+
+          loadJobs.push_back([&loadProtocols, &loadErrorsMutex, &loadErrors, index, protocolFactory, profilesDir,
+                              profileId, protocolName]()
+          {
+            LOG_DEBUG("loading existing profile %s", profileId.c_str());
+            StartupSpan profileSpan("load " + profileId);
+            std::shared_ptr<Protocol> protocol = protocolFactory->Create();
+            if (protocol)
+            {
+              protocol->LoadProfile(profilesDir, profileId);
+              // dormant profiles are served from message cache until connected
+              int syncIntervalMin = 0;
+              const OnDemandChat::ConnectPolicy connectPolicy =
+                OnDemandChat::GetConnectPolicy(profileId, syncIntervalMin);
+              if ((connectPolicy != OnDemandChat::ConnectAlways) && AppConfig::GetBool("cache_enabled"))
+              {
+                protocol = std::make_shared<OnDemandChat>(protocol, connectPolicy, syncIntervalMin);
+              }
+
+              loadProtocols[index] = protocol;
+            }
+            else
+            {
+              LOG_WARNING("protocol %s not supported", protocolName.c_str());
+              std::unique_lock<std::mutex> lock(loadErrorsMutex);
+              loadErrors.push_back("Failed to load " + protocolName + " library, skipping profile " + profileId + ".");
+            }
+          });
+          // *INDENT-ON*
+          found = true;
+          break;
         }
       }
 
@@ -343,42 +554,151 @@ int main(int argc, char* argv[])
     }
   }
 
+  // Protocol libraries are loaded in parallel first, overlapping with terminal and ui config init
+  std::vector<std::function<void()>> jobs = preloadJobs;
+  jobs.insert(jobs.end(), loadJobs.begin(), loadJobs.end());
+  std::thread loadThread(&RunConcurrently, jobs);
+
+  if (ui)
+  {
+    StartupSpan uiInitScreenSpan("ui init screen");
+    ui->InitScreen();
+  }
+
+  loadThread.join();
+  if (coreClient)
+  {
+    const std::vector<std::shared_ptr<RemoteProtocol>> remoteProtocols = coreClient->GetProtocols();
+    loadProtocols.insert(loadProtocols.end(), remoteProtocols.begin(), remoteProtocols.end());
+  }
+
+  for (auto& protocol : loadProtocols)
+  {
+    if (!protocol) continue;
+
+    if (coreServer)
+    {
+      coreServer->AddProtocol(protocol);
+    }
+    else
+    {
+      ui->AddProtocol(protocol);
+    }
+  }
+
+  loadSpan.reset();
+
   // Start protocol(s) and ui
-  ui->Init();
-  std::unordered_map<std::string, std::shared_ptr<Protocol>>& protocols = ui->GetProtocols();
+  if (ui)
+  {
+    StartupSpan uiInitSpan("ui init");
+    ui->Init();
+  }
+
+  std::unordered_map<std::string, std::shared_ptr<Protocol>>& protocols =
+    coreServer ? coreServer->GetProtocols() : ui->GetProtocols();
   bool hasProtocols = !protocols.empty();
   if (hasProtocols && exportDir.empty())
   {
-    // Login
+    // Login concurrently in background, the ui is started without waiting for it
+    std::vector<std::function<void()>> loginJobs;
     for (auto& protocol : protocols)
     {
       protocol.second->SetMessageHandler(messageHandler);
-      protocol.second->Login();
+      std::shared_ptr<Protocol> loginProtocol = protocol.second;
+      Status::Set(Status::FlagConnecting);
+      // *INDENT-OFF*
+      loginJobs.push_back([loginProtocol]()
+      {
+        StartupSpan loginSpan("login " + loginProtocol->GetProfileId());
+        loginProtocol->Login();
+        Status::Clear(Status::FlagConnecting);
+      });
+      // *INDENT-ON*
+    }
+
+    std::thread loginThread(&RunConcurrently, loginJobs);
+
+    if (coreServer)
+    {
+      // Serve attached clients until terminated
+      if (coreServer->Start(CoreLink::GetSocketPath()))
+      {
+        coreServer->Run();
+        coreServer->Stop();
+      }
+      else
+      {
+        std::cerr << "error: unable to listen on " << CoreLink::GetSocketPath() << "\n";
+      }
+    }
+    else
+    {
+      // Ui main loop
+      ui->Run();
     }
 
-    // Ui main loop
-    ui->Run();
+    // Wait for login to complete before logging out
+    loginThread.join();
 
-    // Logout
+    // Logout concurrently, shutdown takes as long as the slowest profile
+    const int64_t logoutTime = TimeUtil::GetCurrentTimeMSec();
+    std::vector<std::function<void()>> logoutJobs;
     for (auto& protocol : protocols)
     {
-      protocol.second->Logout();
-      protocol.second->CloseProfile();
+      std::shared_ptr<Protocol> logoutProtocol = protocol.second;
+      // *INDENT-OFF*
+      logoutJobs.push_back([logoutProtocol]()
+      {
+        logoutProtocol->Logout();
+        logoutProtocol->CloseProfile();
+      });
+      // *INDENT-ON*
     }
+
+    RunConcurrently(logoutJobs);
+    LOG_INFO("logout %d profiles in %d ms", protocols.size(), TimeUtil::GetCurrentTimeMSec() - logoutTime);
+  }
+
+  // Detach before ui cleanup, as the client delivers to the ui
+  if (coreClient)
+  {
+    coreClient->Disconnect();
   }
 
   // Cleanup ui
-  ui->Cleanup();
-  ui.reset();
+  if (ui)
+  {
+    ui->Cleanup();
+    ui.reset();
+  }
+
+  coreServer.reset();
+
+  // Report profiles that failed to load, deferred as load overlaps with terminal init
+  for (const auto& loadError : loadErrors)
+  {
+    std::cout << loadError << "\n";
+  }
+
+  // Report startup timing if requested
+  StartupProfile::Report();
 
   // Perform export if requested
   if (!exportDir.empty())
   {
-    MessageCache::Export(exportDir);
+    MessageCache::Export(exportDir, exportFormat, isExportIncremental);
   }
 
   // Cleanup
+  MessageRecorder::Close();
+  PreviewStore::Cleanup();
+  MemoryGovernor::Cleanup();
+  const int64_t cleanupTime = TimeUtil::GetCurrentTimeMSec();
   MessageCache::Cleanup();
+  LOG_INFO("cache cleanup in %d ms", TimeUtil::GetCurrentTimeMSec() - cleanupTime);
+  BackgroundExecutor::Cleanup();
+  Trace::Cleanup();
   AppConfig::Cleanup();
   Profiles::Cleanup();
 
@@ -451,6 +771,37 @@ void RemoveProfile()
   FileUtil::RmDir(profilePath);
 }
 
+void RunConcurrently(const std::vector<std::function<void()>>& p_Jobs)
+{
+  // @note: small fixed pool, profile load and login are mostly blocked on disk and network
+  static const size_t maxThreads = 4;
+  std::atomic<size_t> nextJob(0);
+  // *INDENT-OFF*
+  auto worker = [&]()
+  {
+    size_t job = 0;
+    while ((job = nextJob++) < p_Jobs.size())
+    {
+      p_Jobs[job]();
+    }
+  };
+  // *INDENT-ON*
+
+  std::vector<std::thread> threads;
+  const size_t threadCount = std::min(p_Jobs.size(), maxThreads);
+  for (size_t i = 1; i < threadCount; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
 std::shared_ptr<Protocol> SetupProfile()
 {
   std::shared_ptr<Protocol> rv;
@@ -520,16 +871,28 @@ void ShowHelp()
     "Usage: nchat [OPTION]\n"
     "\n"
     "Command-line Options:\n"
+    "    -a, --attach           attach ui to running core daemon\n"
+    "    -c, --core             run headless core daemon for attached ui clients\n"
     "    -d, --confdir <DIR>    use a different directory than ~/.nchat\n"
     "    -e, --verbose          enable verbose logging\n"
     "    -ee, --extra-verbose   enable extra verbose logging\n"
     "    -h, --help             display this help and exit\n"
     "    -k, --keydump          key code dump mode\n"
     "    -m, --devmode          developer mode\n"
+    "    -o, --offline          browse cached history without connecting\n"
     "    -r, --remove           remove chat protocol account\n"
+    "    -rc, --record <FILE>   record received events to file, for replay\n"
+    "                           benchmark\n"
     "    -s, --setup            set up chat protocol account\n"
+    "    -sp, --startup-profile\n"
+    "                           print startup phase timing on exit\n"
     "    -v, --version          output version information and exit\n"
     "    -x, --export <DIR>     export message cache to specified dir\n"
+    "    -xf, --export-format <FMT>\n"
+    "                           export format txt (default), jsonl, txt.tgz or\n"
+    "                           jsonl.tgz\n"
+    "    -xi, --export-incremental\n"
+    "                           export only messages newer than previous export\n"
     "\n"
     "Interactive Commands:\n"
     "    PageDn      history next page\n"
@@ -549,6 +912,7 @@ void ShowHelp()
     "    KeyUp       select message\n"
     "    Alt-,       decrease contact list width\n"
     "    Alt-.       increase contact list width\n"
+    "    Alt-/       search message history\n"
     "    Alt-e       external editor compose\n"
     "    Alt-s       external spell check\n"
     "    Alt-t       external telephone call\n"
@@ -10,11 +10,16 @@
 #include <locale.h>
 #include <unistd.h>
 
+#include <thread>
+
 #include <ncurses.h>
 
+#include "appconfig.h"
 #include "emojilist.h"
 #include "log.h"
 #include "messagecache.h"
+#include "messagerecorder.h"
+#include "startupprofile.h"
 #include "uicolorconfig.h"
 #include "uiconfig.h"
 #include "uicontroller.h"
@@ -38,7 +43,8 @@ Ui::~Ui()
   UiConfig::Cleanup();
 }
 
-void Ui::Init()
+// terminal and config setup, independent of protocols, may run while profiles are loading
+void Ui::InitScreen()
 {
   m_TerminalTitle = UiConfig::GetStr("terminal_title");
   if (!m_TerminalTitle.empty())
@@ -47,6 +53,15 @@ void Ui::Init()
   }
 
   printf("\033[?1004h"); // enable terminal focus in/out event
+  printf("\033[?2004h"); // enable terminal bracketed paste
+
+  {
+    // parse key and color config concurrently before curses init, leaving only curses setup below
+    StartupSpan loadSpan("ui load key and color config");
+    std::thread colorThread(&UiColorConfig::Load);
+    UiKeyConfig::Load();
+    colorThread.join();
+  }
 
   setlocale(LC_ALL, "");
   initscr();
@@ -56,11 +71,33 @@ void Ui::Init()
   keypad(stdscr, TRUE);
   curs_set(0);
   timeout(0);
-  EmojiList::Init();
-  UiKeyConfig::Init();
-  UiColorConfig::Init();
-  m_Model->Init();
-  m_Controller->Init();
+  {
+    StartupSpan emojiSpan("ui init emoji list");
+    EmojiList::Init();
+  }
+
+  {
+    StartupSpan configSpan("ui init key codes and colors");
+    UiKeyConfig::Init();
+    UiColorConfig::Init();
+  }
+}
+
+void Ui::Init()
+{
+  {
+    StartupSpan modelSpan("ui init model");
+    m_Model->Init();
+    m_Controller->Init();
+  }
+
+  // show cached chats, contacts and recent messages until receiving latest from chat service
+  StartupSpan snapshotSpan("ui init cache snapshot");
+  const int startupChats = AppConfig::GetNum("cache_startup_chats");
+  for (auto& protocol : m_Model->GetProtocols())
+  {
+    MessageCache::FetchSnapshot(protocol.first, startupChats, LINES);
+  }
 }
 
 void Ui::Cleanup()
@@ -74,6 +111,7 @@ void Ui::Cleanup()
   wclear(stdscr);
   endwin();
 
+  printf("\033[?2004l"); // disable terminal bracketed paste
   printf("\033[?1004l"); // disable terminal focus in/out event
 
   if (!m_TerminalTitle.empty())
@@ -86,33 +124,47 @@ void Ui::Run()
 {
   std::unordered_map<std::string, std::shared_ptr<Protocol>>& protocols = m_Model->GetProtocols();
 
-  // retrieve cached contacts for use until receiving latest from chat service
-  for (auto& protocol : protocols)
-  {
-    MessageCache::FetchContacts(protocol.first);
-  }
-
   LOG_INFO("entering ui loop");
 
+  static wint_t keyTerminalPasteBegin = UiKeyConfig::GetKey("terminal_paste_begin");
+  static wint_t keyTerminalPasteEnd = UiKeyConfig::GetKey("terminal_paste_end");
+  static const int maxKeyBatch = 1024;
+
   curs_set(1);
   while (m_Model->Process())
   {
-    wint_t key = UiController::GetKey(50);
-    if (key != 0)
+    // drain pending input before next Process(), so views are redrawn once per batch of keys
+    wint_t key = UiController::GetKey(m_Model->GetKeyTimeout());
+    int count = 0;
+    while (key != 0)
     {
-      m_Model->KeyHandler(key);
+      if (key == keyTerminalPasteBegin)
+      {
+        m_Model->InsertText(UiController::GetPasteText(keyTerminalPasteEnd));
+      }
+      else
+      {
+        m_Model->KeyHandler(key);
+      }
+
+      if (++count >= maxKeyBatch) break;
+
+      key = UiController::GetPendingKey();
     }
   }
 
   LOG_INFO("exiting ui loop");
 
-  // set as offline before logging off
-  for (auto& protocol : protocols)
+  // set as offline before logging off, brief wait only when a status was actually sent
+  if (UiConfig::GetParams().onlineStatusShare && !protocols.empty())
   {
-    m_Model->SetStatusOnline(protocol.first, false);
-  }
+    for (auto& protocol : protocols)
+    {
+      m_Model->SetStatusOnline(protocol.first, false);
+    }
 
-  usleep(100000);
+    usleep(100000);
+  }
 }
 
 void Ui::AddProtocol(std::shared_ptr<Protocol> p_Protocol)
@@ -127,6 +179,12 @@ std::unordered_map<std::string, std::shared_ptr<Protocol>>& Ui::GetProtocols()
 
 void Ui::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
 {
+  // recorded before handing over, as the model moves data out of messages
+  if (MessageRecorder::IsOpen())
+  {
+    MessageRecorder::Write(p_ServiceMessage);
+  }
+
   m_Model->MessageHandler(p_ServiceMessage);
 }
 
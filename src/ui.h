@@ -22,6 +22,7 @@ public:
   Ui();
   virtual ~Ui();
 
+  void InitScreen();
   void Init();
   void Cleanup();
 
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
 
 #include <ncurses.h>
 
@@ -20,17 +21,14 @@
 const static std::string userColor = "usercolor";
 static int colorPairId = 0;
 
-void UiColorConfig::Init()
+// parses color.conf and usercolor.conf, independent of curses so it may run before initscr.
+// gray defaults resolve to terminal default color on terminals with only eight colors.
+void UiColorConfig::Load()
 {
-  if (has_colors())
-  {
-    start_color();
-  }
-
-  const std::string defaultSentColor = (COLORS > 8) ? "gray" : "";
-  const std::string defaultShadedColor = (COLORS > 8) ? "gray" : "";
-  const std::string defaultQuotedColor = (COLORS > 8) ? "gray" : "";
-  const std::string defaultAttachmentColor = (COLORS > 8) ? "gray" : "";
+  const std::string defaultSentColor = "gray";
+  const std::string defaultShadedColor = "gray";
+  const std::string defaultQuotedColor = "gray";
+  const std::string defaultAttachmentColor = "gray";
   const std::map<std::string, std::string> defaultConfig =
   {
     { "top_attr", "reverse" },
@@ -55,6 +53,7 @@ void UiColorConfig::Init()
 
     { "history_text_attr", "" },
     { "history_text_attr_selected", "reverse" },
+    { "history_text_attr_find", "reverse" },
     { "history_text_sent_color_bg", "" },
     { "history_text_sent_color_fg", defaultSentColor },
     { "history_text_recv_color_bg", "" },
@@ -89,8 +88,49 @@ void UiColorConfig::Init()
   const std::string configPath(FileUtil::GetApplicationDir() + std::string("/color.conf"));
   m_Config = Config(configPath, defaultConfig);
 
+  // palette is a subset of: https://lospec.com/palette-list/st-64-natural
+  static const std::vector<std::string> defaultUserColors =
+  {
+    "0x313199", "0x543fe0", "0x8463e0", "0xb896eb", "0xd9baf5", "0xf3e3e3",
+    "0xf5d7f3", "0xf5c4f2", "0xe48deb", "0xe063d8", "0xb842a0", "0x8f3370",
+    "0x991f2f", "0xe53737", "0xf56d58", "0xf59f7f", "0xf5ccb0", "0xfae7d2",
+    "0xf5db93", "0xf5be6c", "0xeb9b54", "0xcc7041", "0x8f4a39", "0x855d30",
+    "0xb88c33", "0xe0c03f", "0xebdf42", "0xecf56c", "0xf7fac8", "0xcbf558",
+    "0x45e02d", "0x2cb82c", "0x227a2e", "0x338f49", "0x42b86d", "0x51e099",
+    "0x7ff5ca", "0xbaf5ef", "0x7ff1f5", "0x42ceeb", "0x258cb8", "0x28628f",
+    "0x33408f", "0x496ccc", "0x5897f5", "0x7fbef5",
+  };
+
+  const std::string userColorPath = FileUtil::GetApplicationDir() + std::string("/usercolor.conf");
+  std::string data = FileUtil::ReadFile(userColorPath);
+  if (!data.empty())
+  {
+    m_UserColors = StrUtil::Split(data, '\n');
+    m_UserColors.erase(std::remove_if(m_UserColors.begin(), m_UserColors.end(),
+                                      [](const std::string& line) { return line.empty(); }),
+                       m_UserColors.end());
+  }
+  else
+  {
+    data = StrUtil::Join(defaultUserColors, "\n");
+    FileUtil::WriteFile(userColorPath, data);
+    m_UserColors = defaultUserColors;
+  }
+
+  m_Loaded = true;
+}
+
+void UiColorConfig::Init()
+{
+  if (!m_Loaded)
+  {
+    Load();
+  }
+
   if (has_colors())
   {
+    start_color();
+
     const int bg = GetColorId(m_Config.Get("default_color_bg"));
     const int fg = GetColorId(m_Config.Get("default_color_fg"));
     assume_default_colors(fg, bg);
@@ -127,52 +167,20 @@ int UiColorConfig::GetUserColorPair(const std::string& p_Param, const std::strin
 {
   if (!has_colors()) return 0;
 
-  // palette is a subset of: https://lospec.com/palette-list/st-64-natural
-  static std::vector<std::string> defaultUserColors =
-  {
-    "0x313199", "0x543fe0", "0x8463e0", "0xb896eb", "0xd9baf5", "0xf3e3e3",
-    "0xf5d7f3", "0xf5c4f2", "0xe48deb", "0xe063d8", "0xb842a0", "0x8f3370",
-    "0x991f2f", "0xe53737", "0xf56d58", "0xf59f7f", "0xf5ccb0", "0xfae7d2",
-    "0xf5db93", "0xf5be6c", "0xeb9b54", "0xcc7041", "0x8f4a39", "0x855d30",
-    "0xb88c33", "0xe0c03f", "0xebdf42", "0xecf56c", "0xf7fac8", "0xcbf558",
-    "0x45e02d", "0x2cb82c", "0x227a2e", "0x338f49", "0x42b86d", "0x51e099",
-    "0x7ff5ca", "0xbaf5ef", "0x7ff1f5", "0x42ceeb", "0x258cb8", "0x28628f",
-    "0x33408f", "0x496ccc", "0x5897f5", "0x7fbef5",
-  };
-
-  static std::vector<std::string> userColors = [&]()
-  {
-    static std::string path = FileUtil::GetApplicationDir() + std::string("/usercolor.conf");
-    std::string data = FileUtil::ReadFile(path);
-    if (!data.empty())
-    {
-      std::vector<std::string> lines = StrUtil::Split(data, '\n');
-      lines.erase(std::remove_if(lines.begin(), lines.end(),
-                                 [](const std::string& line) { return line.empty(); }),
-                  lines.end());
-      return lines;
-    }
-    else
-    {
-      data = StrUtil::Join(defaultUserColors, "\n");
-      FileUtil::WriteFile(path, data);
-      return defaultUserColors;
-    }
-  }();
-
-  static size_t userColorCount = userColors.size();
+  const size_t userColorCount = m_UserColors.size();
   if (userColorCount == 0) return 0;
 
   std::size_t userIdColor = CalcChecksum(p_UserId) % userColorCount;
 
-  static std::map<int, int> colorPairs;
+  // color pairs indexed directly by user color, allocated on first use
+  static std::vector<int> colorPairs(userColorCount, -1);
 
-  auto colorPair = colorPairs.find(userIdColor);
-  if (colorPair != colorPairs.end()) return colorPair->second;
+  const int colorPair = colorPairs[userIdColor];
+  if (colorPair != -1) return colorPair;
 
   ++colorPairId;
   const int id = colorPairId;
-  const int fg = GetColorId(userColors.at(userIdColor));
+  const int fg = GetColorId(m_UserColors.at(userIdColor));
   const int bg = GetColorId(m_Config.Get(p_Param + "_bg"));
   init_pair(id, fg, bg);
 
@@ -240,6 +248,10 @@ int UiColorConfig::GetColorId(const std::string& p_Str)
       };
       colors.insert(extendedColors.begin(), extendedColors.end());
     }
+    else
+    {
+      colors.insert({ "gray", -1 }); // terminal default color
+    }
 
     return colors;
   }();
@@ -313,3 +325,5 @@ size_t UiColorConfig::CalcChecksum(const std::string& p_Str)
 }
 
 Config UiColorConfig::m_Config;
+std::vector<std::string> UiColorConfig::m_UserColors;
+bool UiColorConfig::m_Loaded = false;
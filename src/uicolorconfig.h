@@ -9,12 +9,14 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "config.h"
 
 class UiColorConfig
 {
 public:
+  static void Load();
   static void Init();
   static void Cleanup();
   static int GetColorPair(const std::string& p_Param); // ex: "top_color"
@@ -29,4 +31,6 @@ private:
 
 private:
   static Config m_Config;
+  static std::vector<std::string> m_UserColors;
+  static bool m_Loaded;
 };
@@ -13,6 +13,9 @@
 #include "strutil.h"
 
 Config UiConfig::m_Config;
+std::string UiConfig::m_ConfigPath;
+UiConfig::Params UiConfig::m_Params;
+std::vector<std::function<void()>> UiConfig::m_ChangeHandlers;
 
 void UiConfig::Init()
 {
@@ -20,12 +23,16 @@ void UiConfig::Init()
   {
     { "attachment_indicator", "\xF0\x9F\x93\x8E" },
     { "attachment_open_command", "" },
+    { "attachment_prefetch_distance", "20" },
+    { "attachment_prefetch_types", "" },
+    { "attachment_preview_command", "" },
     { "away_status_indication", "0" },
     { "call_command", "" },
     { "confirm_deletion", "1" },
     { "desktop_notify_active", "0" },
     { "desktop_notify_inactive", "0" },
     { "desktop_notify_command", "" },
+    { "desktop_notify_min_interval", "5000" },
     { "downloadable_indicator", "+" },
     { "emoji_enabled", "1" },
     { "entry_height", "4" },
@@ -38,6 +45,8 @@ void UiConfig::Init()
     { "list_width", "14" },
     { "mark_read_on_view", "1" },
     { "mark_read_when_inactive", "0" },
+    { "max_frame_rate", "60" },
+    { "max_messages_in_memory", "0" },
     { "message_open_command", "" },
     { "muted_indicate_unread", "1" },
     { "muted_notify_unread", "0" },
@@ -45,24 +54,47 @@ void UiConfig::Init()
     { "online_status_share", "1" },
     { "online_status_dynamic", "1" },
     { "phone_number_indicator", "" },
+    { "power_save_interval", "0" },
+    { "prefetch_chat_count", "4" },
     { "proxy_indicator", "\xF0\x9F\x94\x92" },
     { "read_indicator", "\xe2\x9c\x93" },
     { "spell_check_command", "" },
+    { "split_view_enabled", "0" },
+    { "split_view_panes", "2" },
     { "syncing_indicator", "\xe2\x87\x84" },
     { "terminal_bell_active", "0" },
     { "terminal_bell_inactive", "1" },
     { "terminal_title", "" },
     { "top_enabled", "1" },
+    { "typing_idle_timeout", "3000" },
+    { "typing_min_interval", "500" },
     { "typing_status_share", "1" },
   };
 
-  const std::string configPath(FileUtil::GetApplicationDir() + std::string("/ui.conf"));
-  m_Config = Config(configPath, defaultConfig);
+  m_ConfigPath = FileUtil::GetApplicationDir() + std::string("/ui.conf");
+  m_Config = Config(m_ConfigPath, defaultConfig);
+  UpdateParams();
 }
 
 void UiConfig::Cleanup()
 {
   m_Config.Save();
+  m_ChangeHandlers.clear();
+}
+
+void UiConfig::Reload()
+{
+  m_Config.Load(m_ConfigPath);
+  UpdateParams();
+  for (auto& changeHandler : m_ChangeHandlers)
+  {
+    changeHandler();
+  }
+}
+
+void UiConfig::AddChangeHandler(const std::function<void()>& p_ChangeHandler)
+{
+  m_ChangeHandlers.push_back(p_ChangeHandler);
 }
 
 bool UiConfig::GetBool(const std::string& p_Param)
@@ -92,3 +124,30 @@ void UiConfig::SetNum(const std::string& p_Param, const int& p_Value)
 {
   m_Config.Set(p_Param, std::to_string(p_Value));
 }
+
+void UiConfig::UpdateParams()
+{
+  m_Params.attachmentPrefetchDistance = GetNum("attachment_prefetch_distance");
+  m_Params.awayStatusIndication = GetBool("away_status_indication");
+  m_Params.confirmDeletion = GetBool("confirm_deletion");
+  m_Params.desktopNotifyActive = GetBool("desktop_notify_active");
+  m_Params.desktopNotifyInactive = GetBool("desktop_notify_inactive");
+  m_Params.desktopNotifyMinInterval = GetNum("desktop_notify_min_interval");
+  m_Params.homeFetchAll = GetBool("home_fetch_all");
+  m_Params.markReadOnView = GetBool("mark_read_on_view");
+  m_Params.markReadWhenInactive = GetBool("mark_read_when_inactive");
+  m_Params.maxFrameRate = GetNum("max_frame_rate");
+  m_Params.maxMessagesInMemory = GetNum("max_messages_in_memory");
+  m_Params.mutedIndicateUnread = GetBool("muted_indicate_unread");
+  m_Params.mutedNotifyUnread = GetBool("muted_notify_unread");
+  m_Params.mutedPositionByTimestamp = GetBool("muted_position_by_timestamp");
+  m_Params.onlineStatusDynamic = GetBool("online_status_dynamic");
+  m_Params.onlineStatusShare = GetBool("online_status_share");
+  m_Params.powerSaveInterval = GetNum("power_save_interval");
+  m_Params.prefetchChatCount = GetNum("prefetch_chat_count");
+  m_Params.terminalBellActive = GetBool("terminal_bell_active");
+  m_Params.terminalBellInactive = GetBool("terminal_bell_inactive");
+  m_Params.typingIdleTimeout = GetNum("typing_idle_timeout");
+  m_Params.typingMinInterval = GetNum("typing_min_interval");
+  m_Params.typingStatusShare = GetBool("typing_status_share");
+}
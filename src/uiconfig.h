@@ -7,21 +7,60 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "config.h"
 
 class UiConfig
 {
 public:
+  // pre-parsed values of params read in hot paths
+  struct Params
+  {
+    int attachmentPrefetchDistance = 0;
+    bool awayStatusIndication = false;
+    bool confirmDeletion = false;
+    bool desktopNotifyActive = false;
+    bool desktopNotifyInactive = false;
+    int desktopNotifyMinInterval = 0;
+    bool homeFetchAll = false;
+    bool markReadOnView = false;
+    bool markReadWhenInactive = false;
+    int maxFrameRate = 0;
+    int maxMessagesInMemory = 0;
+    bool mutedIndicateUnread = false;
+    bool mutedNotifyUnread = false;
+    bool mutedPositionByTimestamp = false;
+    bool onlineStatusDynamic = false;
+    bool onlineStatusShare = false;
+    int powerSaveInterval = 0;
+    int prefetchChatCount = 0;
+    bool terminalBellActive = false;
+    bool terminalBellInactive = false;
+    int typingIdleTimeout = 0;
+    int typingMinInterval = 0;
+    bool typingStatusShare = false;
+  };
+
   static void Init();
   static void Cleanup();
+  static void Reload(); // must not be called with ui model lock held
+  static inline const Params& GetParams() { return m_Params; }
+  static void AddChangeHandler(const std::function<void()>& p_ChangeHandler);
   static bool GetBool(const std::string& p_Param);
   static void SetBool(const std::string& p_Param, const bool& p_Value);
   static std::string GetStr(const std::string& p_Param);
   static int GetNum(const std::string& p_Param);
   static void SetNum(const std::string& p_Param, const int& p_Value);
 
+private:
+  static void UpdateParams();
+
 private:
   static Config m_Config;
+  static std::string m_ConfigPath;
+  static Params m_Params;
+  static std::vector<std::function<void()>> m_ChangeHandlers;
 };
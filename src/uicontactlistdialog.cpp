@@ -7,8 +7,6 @@
 
 #include "uicontactlistdialog.h"
 
-#include <algorithm>
-
 #include "log.h"
 #include "uimodel.h"
 #include "strutil.h"
@@ -39,7 +37,7 @@ void UiContactListDialog::OnSelect()
 {
   if (m_ContactInfosVec.empty()) return;
 
-  m_SelectedContact = m_ContactInfosVec[m_Index];
+  m_SelectedContact = std::make_pair(m_ContactInfosVec[m_Index].first, *m_ContactInfosVec[m_Index].second);
   m_Result = true;
   m_Running = false;
 }
@@ -51,7 +49,7 @@ void UiContactListDialog::OnBack()
 bool UiContactListDialog::OnTimer()
 {
   int64_t modelContactInfosUpdateTime = m_Model->GetContactInfosUpdateTime();
-  if (m_DialogContactInfosUpdateTime != modelContactInfosUpdateTime)
+  if (!m_ContactSnapshot || (m_ContactSnapshot->updateTime != modelContactInfosUpdateTime))
   {
     UpdateList();
     return true;
@@ -62,45 +60,33 @@ bool UiContactListDialog::OnTimer()
 
 void UiContactListDialog::UpdateList()
 {
-  int64_t modelContactInfosUpdateTime = m_Model->GetContactInfosUpdateTime();
-  if (m_DialogContactInfosUpdateTime != modelContactInfosUpdateTime)
+  std::shared_ptr<const UiModel::ContactSnapshot> contactSnapshot = m_Model->GetContactSnapshot();
+  if (contactSnapshot != m_ContactSnapshot)
   {
-    m_DialogContactInfosUpdateTime = modelContactInfosUpdateTime;
-    m_DialogContactInfos = m_Model->GetContactInfos();
+    m_ContactSnapshot = contactSnapshot;
+    std::vector<std::string> names;
+    names.reserve(m_ContactSnapshot->nameIndex.size());
+    for (const auto& contactInfo : m_ContactSnapshot->nameIndex)
+    {
+      names.push_back(contactInfo.second->name);
+    }
+
+    m_ListFilter.SetKeys(names);
   }
 
+  m_ListFilter.SetFilter(StrUtil::ToString(m_FilterStr));
+
   m_Index = 0;
   m_Items.clear();
   m_ContactInfosVec.clear();
 
-  std::vector<std::pair<std::string, ContactInfo>> contactInfosVec;
-  for (const auto& profileContactInfos : m_DialogContactInfos)
-  {
-    for (const auto& contactInfo : profileContactInfos.second)
-    {
-      contactInfosVec.push_back(std::make_pair(profileContactInfos.first, contactInfo.second));
-    }
-  }
-
-  std::sort(contactInfosVec.begin(), contactInfosVec.end(),
-            [&](const std::pair<std::string, ContactInfo>& lhs, const std::pair<std::string, ContactInfo>& rhs) -> bool
-  {
-    return lhs.second.name < rhs.second.name;
-  });
-
-  for (const auto& contactInfo : contactInfosVec)
+  static const bool isMultipleProfiles = m_Model->IsMultipleProfiles();
+  for (const size_t index : m_ListFilter.GetMatches())
   {
-    std::string name = contactInfo.second.name;
-    if (name.empty()) continue;
-
-    if (m_FilterStr.empty() ||
-        (StrUtil::ToLower(name).find(StrUtil::ToLower(StrUtil::ToString(m_FilterStr))) != std::string::npos))
-    {
-      static const bool isMultipleProfiles = m_Model->IsMultipleProfiles();
-      std::string displayName = name +
-        (isMultipleProfiles ? " @ " + m_Model->GetProfileDisplayName(contactInfo.first) : "");
-      m_Items.push_back(StrUtil::TrimPadWString(StrUtil::ToWString(displayName), m_W));
-      m_ContactInfosVec.push_back(std::make_pair(contactInfo.first, contactInfo.second));
-    }
+    const std::pair<std::string, const ContactInfo*>& contactInfo = m_ContactSnapshot->nameIndex.at(index);
+    std::string displayName = contactInfo.second->name +
+      (isMultipleProfiles ? " @ " + m_Model->GetProfileDisplayName(contactInfo.first) : "");
+    m_Items.push_back(StrUtil::TrimPadWString(StrUtil::ToWString(displayName), m_W));
+    m_ContactInfosVec.push_back(contactInfo);
   }
 }
@@ -13,6 +13,7 @@
 
 #include "protocol.h"
 #include "uilistdialog.h"
+#include "uimodel.h"
 
 class UiContactListDialog : public UiListDialog
 {
@@ -30,8 +31,7 @@ protected:
   void UpdateList();
 
 private:
-  std::unordered_map<std::string, std::unordered_map<std::string, ContactInfo>> m_DialogContactInfos;
-  int64_t m_DialogContactInfosUpdateTime = 0;
-  std::vector<std::pair<std::string, ContactInfo>> m_ContactInfosVec;
+  std::shared_ptr<const UiModel::ContactSnapshot> m_ContactSnapshot;
+  std::vector<std::pair<std::string, const ContactInfo*>> m_ContactInfosVec; // points into m_ContactSnapshot
   std::pair<std::string, ContactInfo> m_SelectedContact;
 };
@@ -7,11 +7,21 @@
 
 #include "uicontroller.h"
 
+#include <algorithm>
+
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/select.h>
 
+#include "log.h"
+#include "perfstats.h"
+#include "status.h"
 #include "uikeyinput.h"
 
+std::atomic<int> UiController::s_WakeupReadFd(-1);
+std::atomic<int> UiController::s_WakeupWriteFd(-1);
+int64_t UiController::s_KeyTimeUSec = 0;
+
 UiController::UiController()
 {
 }
@@ -22,25 +32,157 @@ UiController::~UiController()
 
 void UiController::Init()
 {
+  if (s_WakeupReadFd != -1) return;
+
+  int fds[2] = { -1, -1 };
+  if (pipe(fds) != 0)
+  {
+    LOG_WARNING("failed to create wakeup pipe, falling back to polling");
+    return;
+  }
+
+  for (int fd : fds)
+  {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+
+  s_WakeupReadFd = fds[0];
+  s_WakeupWriteFd = fds[1];
+
+  // redraw status bar on change
+  Status::SetChangeHandler(&UiController::Wakeup);
 }
 
 void UiController::Cleanup()
 {
+  Status::SetChangeHandler(nullptr);
+  int writeFd = s_WakeupWriteFd.exchange(-1);
+  int readFd = s_WakeupReadFd.exchange(-1);
+  if (writeFd != -1)
+  {
+    close(writeFd);
+  }
+
+  if (readFd != -1)
+  {
+    close(readFd);
+  }
 }
 
 wint_t UiController::GetKey(int p_TimeOutMs)
 {
+  const int wakeupFd = s_WakeupReadFd;
+  if ((p_TimeOutMs < 0) && (wakeupFd == -1))
+  {
+    p_TimeOutMs = 50; // no wakeup pipe, poll for updates
+  }
+
   fd_set fds;
   FD_ZERO(&fds);
   FD_SET(STDIN_FILENO, &fds);
   int maxfd = STDIN_FILENO;
+  if (wakeupFd != -1)
+  {
+    FD_SET(wakeupFd, &fds);
+    maxfd = std::max(maxfd, wakeupFd);
+  }
+
   struct timeval tv = {(p_TimeOutMs / 1000), (p_TimeOutMs % 1000) * 1000};
   wint_t key = 0;
-  select(maxfd + 1, &fds, NULL, NULL, &tv); // ignore select() rv to get resize events
+  select(maxfd + 1, &fds, NULL, NULL, (p_TimeOutMs < 0) ? NULL : &tv); // ignore select() rv to get resize events
+  if ((wakeupFd != -1) && FD_ISSET(wakeupFd, &fds))
+  {
+    char buf[64];
+    while (read(wakeupFd, buf, sizeof(buf)) > 0)
+    {
+    }
+  }
+
   if (FD_ISSET(STDIN_FILENO, &fds))
   {
     UiKeyInput::GetWch(&key);
+    if (key != 0)
+    {
+      s_KeyTimeUSec = PerfStats::GetTimeUSec();
+    }
+  }
+
+  return key;
+}
+
+wint_t UiController::GetPendingKey()
+{
+  // relies on timeout(0) set by Ui::InitScreen()
+  wint_t key = 0;
+  if (UiKeyInput::GetWch(&key) == ERR)
+  {
+    key = 0;
+  }
+  else
+  {
+    s_KeyTimeUSec = PerfStats::GetTimeUSec();
   }
 
   return key;
 }
+
+std::wstring UiController::GetPasteText(wint_t p_EndKey)
+{
+  static const int pasteTimeoutMs = 100;
+  std::wstring text;
+  while (true)
+  {
+    wint_t key = 0;
+    int rv = UiKeyInput::GetWch(&key);
+    if (rv == ERR)
+    {
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(STDIN_FILENO, &fds);
+      struct timeval tv = {0, pasteTimeoutMs * 1000};
+      if (select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0)
+      {
+        LOG_WARNING("paste end not received");
+        break;
+      }
+
+      continue;
+    }
+
+    if (rv == KEY_CODE_YES)
+    {
+      if (key == p_EndKey) break;
+
+      continue; // ignore function keys in pasted text
+    }
+
+    if (key == '\r')
+    {
+      key = '\n';
+    }
+
+    if ((key >= 0x20) || (key == '\n') || (key == '\t'))
+    {
+      text.push_back((wchar_t)key);
+    }
+  }
+
+  return text;
+}
+
+void UiController::Wakeup()
+{
+  const int wakeupFd = s_WakeupWriteFd;
+  if (wakeupFd == -1) return;
+
+  // a full pipe already guarantees a pending wakeup
+  const char c = 0;
+  ssize_t rv = write(wakeupFd, &c, 1);
+  (void)rv;
+}
+
+int64_t UiController::GetKeyTimeUSec()
+{
+  return s_KeyTimeUSec;
+}
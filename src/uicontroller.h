@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <string>
+
 #include <ncurses.h>
 
 class UiController
@@ -18,7 +22,19 @@ public:
   void Init();
   void Cleanup();
 
+  // negative timeout waits until key, resize or wakeup
   static wint_t GetKey(int p_TimeOutMs);
+  // non-blocking, returns 0 when no more input is pending
+  static wint_t GetPendingKey();
+  // reads bracketed paste text until end key, waiting briefly for text arriving in parts
+  static std::wstring GetPasteText(wint_t p_EndKey);
+  static void Wakeup();
+  // read time of last key returned, for input latency stats, 0 if none
+  static int64_t GetKeyTimeUSec();
 
 private:
+  // @note: self-pipe used by other threads to wake up a blocking GetKey()
+  static std::atomic<int> s_WakeupReadFd;
+  static std::atomic<int> s_WakeupWriteFd;
+  static int64_t s_KeyTimeUSec;
 };
@@ -14,6 +14,16 @@
 UiEmojiListDialog::UiEmojiListDialog(const UiDialogParams& p_Params)
   : UiListDialog(p_Params, true /*p_ShadeHidden*/)
 {
+  // full list in usage order, narrowed by the list filter
+  m_AllTextEmojis = EmojiList::Get("");
+  std::vector<std::string> names;
+  names.reserve(m_AllTextEmojis.size());
+  for (const auto& textEmoji : m_AllTextEmojis)
+  {
+    names.push_back(textEmoji.first);
+  }
+
+  m_ListFilter.SetKeys(names);
   UpdateList();
 }
 
@@ -59,9 +69,10 @@ void UiEmojiListDialog::UpdateList()
   m_Index = 0;
   m_Items.clear();
   m_TextEmojis.clear();
-  std::vector<std::pair<std::string, std::string>> textEmojis = EmojiList::Get(StrUtil::ToString(m_FilterStr));
-  for (auto& textEmoji : textEmojis)
+  m_ListFilter.SetFilter(StrUtil::ToString(m_FilterStr));
+  for (const size_t index : m_ListFilter.GetMatches())
   {
+    const std::pair<std::string, std::string>& textEmoji = m_AllTextEmojis.at(index);
     std::wstring desc = StrUtil::ToWString(textEmoji.first);
     std::wstring item = StrUtil::ToWString(textEmoji.second);
     if (StrUtil::WStringWidth(item) <= 0) continue; // mainly for mac
@@ -25,6 +25,7 @@ protected:
   void UpdateList();
 
 private:
+  std::vector<std::pair<std::string, std::string>> m_AllTextEmojis;
   std::vector<std::pair<std::string, std::string>> m_TextEmojis;
   std::wstring m_SelectedEmoji;
 };
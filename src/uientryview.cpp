@@ -25,7 +25,7 @@ void UiEntryView::Draw()
   if (!m_Dirty)
   {
     wmove(m_Win, m_CursY, m_CursX);
-    wrefresh(m_Win);
+    wnoutrefresh(m_Win);
     return;
   }
 
@@ -33,13 +33,14 @@ void UiEntryView::Draw()
 
   curs_set(0);
 
-  std::wstring input = m_Model->GetEntryStr();
-  const int inputPos = m_Model->GetEntryPos();
-  std::wstring line;
-  std::vector<std::wstring> lines;
+  // find query is edited in place of entry text, with cursor at its end
+  const bool findActive = m_Model->GetFindActive();
+  const std::wstring findStr = findActive ? m_Model->GetFindEntryStr() : std::wstring();
+  const std::wstring& input = findActive ? findStr : m_Model->GetEntryStr();
+  const int inputPos = findActive ? (int)findStr.size() : m_Model->GetEntryPos();
   int cx = 0;
   int cy = 0;
-  lines = StrUtil::WordWrap(input, m_W, false, false, false, 2, inputPos, cy, cx);
+  Layout(input, inputPos, cy, cx);
 
   static int colorPair = UiColorConfig::GetColorPair("entry_color");
   static int attribute = UiColorConfig::GetAttribute("entry_attr");
@@ -50,14 +51,30 @@ void UiEntryView::Draw()
 
   int yoffs = (cy < (m_H - 1)) ? 0 : (cy - (m_H - 1));
 
-  for (int i = 0; i < m_H; ++i)
+  // only visible lines are drawn
+  std::wstring line;
+  int lineIndex = 0;
+  for (const std::vector<std::wstring>& paragraphLines : m_ParagraphLines)
   {
-    if ((i + yoffs) < (int)lines.size())
+    if ((lineIndex + (int)paragraphLines.size()) <= yoffs)
+    {
+      lineIndex += paragraphLines.size();
+      continue;
+    }
+
+    for (const std::wstring& paragraphLine : paragraphLines)
     {
-      line = lines.at(i + yoffs).c_str();
+      const int y = lineIndex++ - yoffs;
+      if (y < 0) continue;
+
+      if (y >= m_H) break;
+
+      line = paragraphLine;
       line.erase(std::remove(line.begin(), line.end(), EMOJI_PAD), line.end());
-      mvwaddwstr(m_Win, i, 0, line.c_str());
+      mvwaddwstr(m_Win, y, 0, line.c_str());
     }
+
+    if ((lineIndex - yoffs) >= m_H) break;
   }
 
   wattroff(m_Win, attribute | colorPair);
@@ -66,5 +83,97 @@ void UiEntryView::Draw()
   m_CursY = (cy - yoffs);
 
   wmove(m_Win, m_CursY, m_CursX);
-  wrefresh(m_Win);
+  wnoutrefresh(m_Win);
+}
+
+void UiEntryView::Resize(const UiViewParams& p_Params)
+{
+  if (p_Params.w != m_W)
+  {
+    m_Paragraphs.clear();
+    m_ParagraphLines.clear();
+  }
+
+  UiViewBase::Resize(p_Params);
+}
+
+void UiEntryView::Layout(const std::wstring& p_Input, int p_Pos, int& p_WrapLine, int& p_WrapPos)
+{
+  // same lines as StrUtil::WordWrap(p_Input, m_W, false, false, false, 2, ...), but only paragraphs
+  // between the unchanged leading and trailing ones are re-wrapped
+  std::vector<std::pair<size_t, size_t>> ranges; // start and length of each paragraph
+  size_t lineStart = 0;
+  while (lineStart < p_Input.size())
+  {
+    size_t lineEnd = p_Input.find(L'\n', lineStart);
+    if (lineEnd == std::wstring::npos)
+    {
+      lineEnd = p_Input.size();
+    }
+
+    ranges.emplace_back(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+  }
+
+  const size_t oldCount = m_Paragraphs.size();
+  const size_t newCount = ranges.size();
+  auto IsUnchanged = [&](size_t p_NewIndex, size_t p_OldIndex)
+  {
+    // first paragraph is wrapped differently, so it may not move to or from index zero
+    return ((p_NewIndex == 0) == (p_OldIndex == 0)) &&
+           (m_Paragraphs[p_OldIndex].compare(0, std::wstring::npos, p_Input, ranges[p_NewIndex].first,
+                                             ranges[p_NewIndex].second) == 0);
+  };
+
+  size_t prefix = 0;
+  while ((prefix < oldCount) && (prefix < newCount) && IsUnchanged(prefix, prefix))
+  {
+    ++prefix;
+  }
+
+  size_t suffix = 0;
+  while (((prefix + suffix) < oldCount) && ((prefix + suffix) < newCount) &&
+         IsUnchanged(newCount - 1 - suffix, oldCount - 1 - suffix))
+  {
+    ++suffix;
+  }
+
+  std::vector<std::wstring> paragraphs;
+  std::vector<std::vector<std::wstring>> paragraphLines;
+  for (size_t i = prefix; i < (newCount - suffix); ++i)
+  {
+    paragraphs.push_back(p_Input.substr(ranges[i].first, ranges[i].second));
+    paragraphLines.emplace_back();
+    StrUtil::WordWrapLine(paragraphs.back(), m_W, false, false, 2, (i == 0), paragraphLines.back());
+  }
+
+  m_Paragraphs.erase(m_Paragraphs.begin() + prefix, m_Paragraphs.begin() + (oldCount - suffix));
+  m_Paragraphs.insert(m_Paragraphs.begin() + prefix, std::make_move_iterator(paragraphs.begin()),
+                      std::make_move_iterator(paragraphs.end()));
+  m_ParagraphLines.erase(m_ParagraphLines.begin() + prefix, m_ParagraphLines.begin() + (oldCount - suffix));
+  m_ParagraphLines.insert(m_ParagraphLines.begin() + prefix, std::make_move_iterator(paragraphLines.begin()),
+                          std::make_move_iterator(paragraphLines.end()));
+
+  // same cursor position as StrUtil::WordWrapPos() over all lines
+  p_WrapLine = 0;
+  p_WrapPos = 0;
+  for (const std::vector<std::wstring>& lines : m_ParagraphLines)
+  {
+    for (const std::wstring& line : lines)
+    {
+      if (p_Pos <= 0) return;
+
+      const int lineLength = std::min((int)line.size() + 1, m_W);
+      if (lineLength <= p_Pos)
+      {
+        p_Pos -= lineLength;
+        ++p_WrapLine;
+      }
+      else
+      {
+        p_WrapPos = p_Pos;
+        return;
+      }
+    }
+  }
 }
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "uiviewbase.h"
 
 class UiEntryView : public UiViewBase
@@ -15,8 +18,16 @@ public:
   UiEntryView(const UiViewParams& p_Params);
 
   virtual void Draw();
+  virtual void Resize(const UiViewParams& p_Params);
+
+private:
+  void Layout(const std::wstring& p_Input, int p_Pos, int& p_WrapLine, int& p_WrapPos);
 
 private:
   int m_CursX = 0;
   int m_CursY = 0;
+
+  // @note: wrapped lines per input paragraph, only edited paragraphs are re-wrapped
+  std::vector<std::wstring> m_Paragraphs;
+  std::vector<std::vector<std::wstring>> m_ParagraphLines;
 };
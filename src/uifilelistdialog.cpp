@@ -7,14 +7,17 @@
 
 #include "uifilelistdialog.h"
 
+#include <algorithm>
+
 #include "fileutil.h"
+#include "numutil.h"
 #include "strutil.h"
 
 UiFileListDialog::UiFileListDialog(const UiDialogParams& p_Params)
   : UiListDialog(p_Params, true /*p_ShadeHidden*/)
 {
   m_CurrentDir = FileUtil::GetCurrentWorkingDir();
-  m_DirEntrys = FileUtil::ListPaths(m_CurrentDir);
+  ReadDir();
   UpdateList();
 }
 
@@ -33,11 +36,11 @@ void UiFileListDialog::OnSelect()
 
   if (m_Index < (int)m_CurrentDirEntrys.size())
   {
-    const DirEntry& dirEntry = *std::next(m_CurrentDirEntrys.begin(), m_Index);
+    const DirEntry& dirEntry = m_CurrentDirEntrys.at(m_Index);
     if (dirEntry.IsDir())
     {
       m_CurrentDir = FileUtil::AbsolutePath(m_CurrentDir + "/" + dirEntry.name);
-      m_DirEntrys = FileUtil::ListPaths(m_CurrentDir);
+      ReadDir();
       m_FilterStr.clear();
       UpdateList();
     }
@@ -53,7 +56,7 @@ void UiFileListDialog::OnSelect()
 void UiFileListDialog::OnBack()
 {
   m_CurrentDir = FileUtil::AbsolutePath(m_CurrentDir + "/..");
-  m_DirEntrys = FileUtil::ListPaths(m_CurrentDir);
+  ReadDir();
   m_FilterStr.clear();
   UpdateList();
 }
@@ -63,22 +66,51 @@ bool UiFileListDialog::OnTimer()
   return false;
 }
 
-void UiFileListDialog::UpdateList()
+bool UiFileListDialog::OnPoll()
 {
-  if (m_FilterStr.empty())
+  if (!m_Listing) return false;
+
+  // merge entries listed so far, keeping the selection while the listing progresses
+  const size_t prevCount = m_DirEntrys.size();
+  bool isDone = false;
+  if (!m_DirLister.Poll(m_DirEntrys, isDone)) return false;
+
+  m_Listing = !isDone;
+  std::sort(std::next(m_DirEntrys.begin(), prevCount), m_DirEntrys.end(), DirEntryCompare());
+  std::inplace_merge(m_DirEntrys.begin(), std::next(m_DirEntrys.begin(), prevCount), m_DirEntrys.end(),
+                     DirEntryCompare());
+
+  std::vector<std::string> names;
+  names.reserve(m_DirEntrys.size());
+  for (const auto& dirEntry : m_DirEntrys)
   {
-    m_CurrentDirEntrys = m_DirEntrys;
+    names.push_back(dirEntry.name);
   }
-  else
+
+  m_ListFilter.SetKeys(names);
+
+  const int index = m_Index;
+  UpdateList();
+  m_Index = NumUtil::Bound(0, index, std::max((int)m_Items.size() - 1, 0));
+  return true;
+}
+
+void UiFileListDialog::ReadDir()
+{
+  m_DirEntrys.clear();
+  m_ListFilter.SetKeys(std::vector<std::string>());
+  m_DirLister.Start(m_CurrentDir);
+  m_Listing = true;
+  OnPoll();
+}
+
+void UiFileListDialog::UpdateList()
+{
+  m_ListFilter.SetFilter(StrUtil::ToString(m_FilterStr));
+  m_CurrentDirEntrys.clear();
+  for (const size_t index : m_ListFilter.GetMatches())
   {
-    m_CurrentDirEntrys.clear();
-    for (const auto& dirEntry : m_DirEntrys)
-    {
-      if (StrUtil::ToLower(dirEntry.name).find(StrUtil::ToLower(StrUtil::ToString(m_FilterStr))) != std::string::npos)
-      {
-        m_CurrentDirEntrys.insert(dirEntry);
-      }
-    }
+    m_CurrentDirEntrys.push_back(m_DirEntrys.at(index));
   }
 
   int maxNameLen = m_W - 9;
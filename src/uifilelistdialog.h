@@ -8,9 +8,11 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
-#include "uilistdialog.h"
+#include "dirlister.h"
 #include "fileutil.h"
+#include "uilistdialog.h"
 
 class UiFileListDialog : public UiListDialog
 {
@@ -24,12 +26,18 @@ protected:
   virtual void OnSelect();
   virtual void OnBack();
   virtual bool OnTimer();
+  virtual bool OnPoll();
 
   void UpdateList();
 
+private:
+  void ReadDir();
+
 private:
   std::string m_CurrentDir;
-  std::set<DirEntry, DirEntryCompare> m_DirEntrys;
-  std::set<DirEntry, DirEntryCompare> m_CurrentDirEntrys;
+  std::vector<DirEntry> m_DirEntrys; // in DirEntryCompare order
+  std::vector<DirEntry> m_CurrentDirEntrys;
+  DirLister m_DirLister;
+  bool m_Listing = false;
   std::string m_SelectedPath;
 };
@@ -15,6 +15,13 @@
 UiHelpView::UiHelpView(const UiViewParams& p_Params)
   : UiViewBase(p_Params)
 {
+  InitHelpViews();
+}
+
+void UiHelpView::Resize(const UiViewParams& p_Params)
+{
+  UiViewBase::Resize(p_Params);
+  InitHelpViews();
 }
 
 void UiHelpView::Draw()
@@ -22,16 +29,68 @@ void UiHelpView::Draw()
   if (!m_Enabled || !m_Dirty) return;
   m_Dirty = false;
 
+  HelpMode helpMode = HelpModeDefault;
+  if (m_Model->GetListDialogActive())
+  {
+    helpMode = HelpModeListDialog;
+  }
+  else if (m_Model->GetMessageDialogActive())
+  {
+    helpMode = HelpModeMessageDialog;
+  }
+  else if (m_Model->GetEditMessageActive())
+  {
+    helpMode = HelpModeEditMessage;
+  }
+  else if (m_Model->GetFindActive())
+  {
+    helpMode = HelpModeFind;
+  }
+  else if (m_Model->GetSelectMessageActive())
+  {
+    helpMode = HelpModeSelect;
+  }
+
+  const std::vector<std::wstring>& helpViews = m_HelpViews[helpMode];
+  const std::wstring* helpView = &helpViews.at(m_Model->GetHelpOffset() % helpViews.size());
+  if (helpView == m_DrawnHelpView)
+  {
+    touchwin(m_Win); // unchanged, only restage window
+    wnoutrefresh(m_Win);
+    return;
+  }
+
+  m_DrawnHelpView = helpView;
+
   curs_set(0);
 
-  static std::wstring otherHelpItem = []()
+  static int colorPair = UiColorConfig::GetColorPair("help_color");
+  static int attribute = UiColorConfig::GetAttribute("help_attr");
+
+  werase(m_Win);
+  wbkgd(m_Win, attribute | colorPair | ' ');
+  wattron(m_Win, attribute | colorPair);
+
+  mvwaddnwstr(m_Win, 0, 0, helpView->c_str(), std::min((int)helpView->size(), m_W));
+
+  wattroff(m_Win, attribute | colorPair);
+  wnoutrefresh(m_Win);
+}
+
+void UiHelpView::InitHelpViews()
+{
+  // help lines per mode are composed once for current key config and width, and drawn as is
+  m_DrawnHelpView = nullptr;
+  if (!m_Enabled) return;
+
+  const std::wstring otherHelpItem = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("other_commands_help"), "OtherCmd", helpItems);
     return !helpItems.empty() ? L" | " + helpItems.at(0) : std::wstring();
   }();
 
-  static std::vector<std::wstring> listDialogHelpItems = []()
+  const std::vector<std::wstring> listDialogHelpItems = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("return"), "Select", helpItems);
@@ -41,7 +100,7 @@ void UiHelpView::Draw()
     return helpItems;
   }();
 
-  static std::vector<std::wstring> messageDialogHelpItems = []()
+  const std::vector<std::wstring> messageDialogHelpItems = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("return"), "OK", helpItems);
@@ -49,7 +108,7 @@ void UiHelpView::Draw()
     return helpItems;
   }();
 
-  static std::vector<std::wstring> editMessageHelpItems = []()
+  const std::vector<std::wstring> editMessageHelpItems = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("send_msg"), "Save", helpItems);
@@ -57,7 +116,17 @@ void UiHelpView::Draw()
     return helpItems;
   }();
 
-  static std::vector<std::wstring> selectHelpItems = []()
+  const std::vector<std::wstring> findHelpItems = []()
+  {
+    std::vector<std::wstring> helpItems;
+    AppendHelpItem(UiKeyConfig::GetKey("up"), "PrevMtch", helpItems);
+    AppendHelpItem(UiKeyConfig::GetKey("down"), "NextMtch", helpItems);
+    AppendHelpItem(UiKeyConfig::GetKey("backspace"), "DelChar", helpItems);
+    AppendHelpItem(UiKeyConfig::GetKey("cancel"), "Cancel", helpItems);
+    return helpItems;
+  }();
+
+  const std::vector<std::wstring> selectHelpItems = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("send_msg"), "ReplyMsg", helpItems);
@@ -85,7 +154,7 @@ void UiHelpView::Draw()
     return helpItems;
   }();
 
-  static std::vector<std::wstring> defaultHelpItems = []()
+  const std::vector<std::wstring> defaultHelpItems = []()
   {
     std::vector<std::wstring> helpItems;
     AppendHelpItem(UiKeyConfig::GetKey("send_msg"), "SendMsg", helpItems);
@@ -106,59 +175,25 @@ void UiHelpView::Draw()
     return helpItems;
   }();
 
-  static std::vector<std::wstring> listDialogHelpViews;
-  static std::vector<std::wstring> messageDialogHelpViews;
-  static std::vector<std::wstring> editMessageHelpViews;
-  static std::vector<std::wstring> selectHelpViews;
-  static std::vector<std::wstring> defaultHelpViews;
-
-  static int prevW = 0;
-  if (m_W != prevW)
+  const int maxW = m_W - 2;
+  m_HelpViews[HelpModeListDialog] = GetHelpViews(maxW, listDialogHelpItems, otherHelpItem);
+  m_HelpViews[HelpModeMessageDialog] = GetHelpViews(maxW, messageDialogHelpItems, otherHelpItem);
+  m_HelpViews[HelpModeEditMessage] = GetHelpViews(maxW, editMessageHelpItems, otherHelpItem);
+  m_HelpViews[HelpModeSelect] = GetHelpViews(maxW, selectHelpItems, otherHelpItem);
+  m_HelpViews[HelpModeFind] = GetHelpViews(maxW, findHelpItems, otherHelpItem);
+  m_HelpViews[HelpModeDefault] = GetHelpViews(maxW, defaultHelpItems, otherHelpItem);
+  for (std::vector<std::wstring>& helpViews : m_HelpViews)
   {
-    prevW = m_W;
-
-    const int maxW = m_W - 2;
-    listDialogHelpViews = GetHelpViews(maxW, listDialogHelpItems, otherHelpItem);
-    messageDialogHelpViews = GetHelpViews(maxW, messageDialogHelpItems, otherHelpItem);
-    editMessageHelpViews = GetHelpViews(maxW, editMessageHelpItems, otherHelpItem);
-    selectHelpViews = GetHelpViews(maxW, selectHelpItems, otherHelpItem);
-    defaultHelpViews = GetHelpViews(maxW, defaultHelpItems, otherHelpItem);
-  }
-
-  static int colorPair = UiColorConfig::GetColorPair("help_color");
-  static int attribute = UiColorConfig::GetAttribute("help_attr");
-
-  werase(m_Win);
-  wbkgd(m_Win, attribute | colorPair | ' ');
-  wattron(m_Win, attribute | colorPair);
+    if (helpViews.empty())
+    {
+      helpViews.push_back(std::wstring());
+    }
 
-  std::wstring wstr;
-  if (m_Model->GetListDialogActive())
-  {
-    wstr = listDialogHelpViews.at(m_Model->GetHelpOffset() % listDialogHelpViews.size());
-  }
-  else if (m_Model->GetMessageDialogActive())
-  {
-    wstr = messageDialogHelpViews.at(m_Model->GetHelpOffset() % messageDialogHelpViews.size());
-  }
-  else if (m_Model->GetEditMessageActive())
-  {
-    wstr = editMessageHelpViews.at(m_Model->GetHelpOffset() % editMessageHelpViews.size());
-  }
-  else if (m_Model->GetSelectMessageActive())
-  {
-    wstr = selectHelpViews.at(m_Model->GetHelpOffset() % selectHelpViews.size());
-  }
-  else
-  {
-    wstr = defaultHelpViews.at(m_Model->GetHelpOffset() % defaultHelpViews.size());
+    for (std::wstring& helpView : helpViews)
+    {
+      helpView = L" " + helpView + std::wstring(std::max(m_W - (int)helpView.size(), 0), L' ');
+    }
   }
-
-  wstr = L" " + wstr + std::wstring(std::max(m_W - (int)wstr.size(), 0), L' ');
-  mvwaddnwstr(m_Win, 0, 0, wstr.c_str(), std::min((int)wstr.size(), m_W));
-
-  wattroff(m_Win, attribute | colorPair);
-  wrefresh(m_Win);
 }
 
 std::vector<std::wstring> UiHelpView::GetHelpViews(const int p_MaxW, const std::vector<std::wstring>& p_HelpItems,
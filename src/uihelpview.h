@@ -18,10 +18,27 @@ public:
   UiHelpView(const UiViewParams& p_Params);
 
   virtual void Draw();
+  virtual void Resize(const UiViewParams& p_Params);
 
 private:
+  enum HelpMode
+  {
+    HelpModeDefault = 0,
+    HelpModeSelect,
+    HelpModeFind,
+    HelpModeEditMessage,
+    HelpModeMessageDialog,
+    HelpModeListDialog,
+    HelpModeCount,
+  };
+
+  void InitHelpViews();
   static std::vector<std::wstring> GetHelpViews(const int p_MaxW, const std::vector<std::wstring>& p_HelpItems,
                                                 const std::wstring& p_OtherHelpItem);
   static void AppendHelpItem(const int p_Key, const std::string& p_Desc, std::vector<std::wstring>& p_HelpItems);
   static std::string GetKeyDisplay(int p_Key);
+
+private:
+  std::vector<std::wstring> m_HelpViews[HelpModeCount]; // padded help lines per mode
+  const std::wstring* m_DrawnHelpView = nullptr;
 };
@@ -7,18 +7,54 @@
 
 #include "uihistoryview.h"
 
-#include "appconfig.h"
 #include "apputil.h"
 #include "fileutil.h"
-#include "protocolutil.h"
+#include "heapsize.h"
 #include "strutil.h"
 #include "timeutil.h"
 #include "uicolorconfig.h"
 #include "uiconfig.h"
 #include "uimodel.h"
 
+const int UiHistoryView::s_PrefetchPages = 2;
+
 UiHistoryView::UiHistoryView(const UiViewParams& p_Params)
   : UiViewBase(p_Params)
+  , m_FrameCache(8) // chats
+  , m_LayoutWorker(4096) // lines
+  , m_QuoteLayoutCache(1024) // quotes
+  , m_TimeLayoutCache(1024) // time strings
+  , m_TimeFormatter(false /* p_IsExport */)
+{
+  InitPaddedWin();
+}
+
+UiHistoryView::~UiHistoryView()
+{
+  if (m_PaddedWin != nullptr)
+  {
+    delwin(m_PaddedWin);
+    m_PaddedWin = nullptr;
+  }
+}
+
+void UiHistoryView::Resize(const UiViewParams& p_Params)
+{
+  if (m_PaddedWin != nullptr)
+  {
+    delwin(m_PaddedWin);
+    m_PaddedWin = nullptr;
+  }
+
+  m_DrawnRows.clear();
+  m_FrameCache.Clear();
+  m_Title.clear();
+
+  UiViewBase::Resize(p_Params);
+  InitPaddedWin();
+}
+
+void UiHistoryView::InitPaddedWin()
 {
   if (m_Enabled)
   {
@@ -38,15 +74,6 @@ UiHistoryView::UiHistoryView(const UiViewParams& p_Params)
   }
 }
 
-UiHistoryView::~UiHistoryView()
-{
-  if (m_PaddedWin != nullptr)
-  {
-    delwin(m_PaddedWin);
-    m_PaddedWin = nullptr;
-  }
-}
-
 void UiHistoryView::Draw()
 {
   std::unique_lock<std::mutex> lock(m_ViewMutex);
@@ -62,6 +89,7 @@ void UiHistoryView::Draw()
   static int colorPairTextAttachment = UiColorConfig::GetColorPair("history_text_attachment_color");
   static int attributeTextNormal = UiColorConfig::GetAttribute("history_text_attr");
   static int attributeTextSelected = UiColorConfig::GetAttribute("history_text_attr_selected");
+  static int attributeTextFind = UiColorConfig::GetAttribute("history_text_attr_find");
 
   static int colorPairNameSent = UiColorConfig::GetColorPair("history_name_sent_color");
   static int colorPairNameRecv = UiColorConfig::GetColorPair("history_name_recv_color");
@@ -72,261 +100,485 @@ void UiHistoryView::Draw()
     StrUtil::ToWString(UiConfig::GetStr("attachment_indicator") + " ");
   static std::wstring quoteIndicator = L"> ";
 
-  std::pair<std::string, std::string>& currentChat = m_Model->GetCurrentChat();
+  // other split view panes show recent chats with newest messages, read-only and not marked read
+  const bool isCurrentChatPane = (m_PaneIndex == 0);
+  const UiModel::ChatKey currentChat =
+    isCurrentChatPane ? m_Model->GetCurrentChat() : m_Model->GetHistoryPaneChat(m_PaneIndex);
   const bool emojiEnabled = m_Model->GetEmojiEnabled();
+  const int64_t contactInfosUpdateTime = m_Model->GetContactInfosUpdateTimeNoLock();
+  if ((m_SenderNamesUpdateTime != contactInfosUpdateTime) || (m_SenderNamesEmojiEnabled != emojiEnabled))
+  {
+    m_SenderNames.clear();
+    m_SenderNamesUpdateTime = contactInfosUpdateTime;
+    m_SenderNamesEmojiEnabled = emojiEnabled;
+  }
 
-  std::vector<std::string>& messageVec =
-    m_Model->GetMessageVec(currentChat.first, currentChat.second);
-  std::unordered_map<std::string, ChatMessage>& messages =
-    m_Model->GetMessages(currentChat.first, currentChat.second);
-  int& messageOffset = m_Model->GetMessageOffset(currentChat.first, currentChat.second);
-
-  werase(m_PaddedWin);
-  wbkgd(m_PaddedWin, attributeTextNormal | colorPairTextRecv | ' ');
+  if (m_PaneCount > 1)
+  {
+    std::string name = currentChat.second.empty() ? "" :
+      m_Model->GetContactListName(currentChat.first, currentChat.second);
+    if (!emojiEnabled)
+    {
+      name = StrUtil::Textize(name);
+    }
 
-  m_HistoryShowCount = 0;
+    std::wstring title = StrUtil::TrimPadWString(L" " + StrUtil::ToWString(name), m_W);
+    if (title != m_Title)
+    {
+      m_Title = title;
+      wattron(m_Win, attributeNameNormal | colorPairNameRecv);
+      mvwaddnwstr(m_Win, 0, 0, m_Title.c_str(), std::min((int)m_Title.size(), m_W));
+      wattroff(m_Win, attributeNameNormal | colorPairNameRecv);
+      wnoutrefresh(m_Win);
+      touchwin(m_PaddedWin); // keep padded window on top of parent
+    }
+  }
 
-  bool firstMessage = true;
-  int y = m_PaddedH - 1;
-  for (auto it = std::next(messageVec.begin(), messageOffset); it != messageVec.end(); ++it)
+  static UiModel::ChatState emptyChatState;
+  UiModel::ChatState& chatState = currentChat.second.empty() ? emptyChatState :
+    m_Model->PeekChatState(currentChat.first, currentChat.second);
+  std::vector<std::string>& messageVec = chatState.messageVec;
+  std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  const int messageOffset = isCurrentChatPane ? chatState.messageOffset : 0;
+  const std::wstring findHighlight = isCurrentChatPane ? m_Model->GetFindHighlight() : std::wstring();
+
+  // render into rows first, only rows differing from previous draw are written to window
+  std::vector<Row> rows;
+  std::vector<bool> textRows; // message text, where find matches are highlighted
+
+  // chat unchanged since its rows were rendered, e.g. when returning to it, is patched from its frame
+  const bool selectMessageActive = isCurrentChatPane && m_Model->GetSelectMessageActive();
+  Frame frame;
+  const bool isFrameHit = !currentChat.second.empty() && m_FrameCache.Get(currentChat, frame) &&
+    (frame.historyVersion == chatState.historyVersion) && (frame.contactInfosUpdateTime == contactInfosUpdateTime) &&
+    (frame.emojiEnabled == emojiEnabled) && (frame.selectMessageActive == selectMessageActive) &&
+    (time(NULL) < frame.validUntil);
+  if (isFrameHit)
+  {
+    rows.swap(frame.rows);
+    textRows.swap(frame.textRows);
+    m_HistoryShowCount = frame.historyShowCount;
+  }
+  else
   {
-    bool isSelectedMessage = firstMessage && m_Model->GetSelectMessageActive();
-    firstMessage = false;
+    rows.assign(m_PaddedH, Row(0, L""));
+    textRows.assign(m_PaddedH, false);
+    m_RowsValidUntil = std::numeric_limits<int64_t>::max();
+    bool hasUnread = false; // not marked read, frame not kept so marking is retried
 
-    ChatMessage& msg = messages[*it];
+    m_HistoryShowCount = 0;
 
-    int attributeText = isSelectedMessage ? attributeTextSelected : attributeTextNormal;
-    int colorPairText = [&]()
+    bool firstMessage = true;
+    int y = m_PaddedH - 1;
+    for (auto it = std::next(messageVec.begin(), messageOffset); it != messageVec.end(); ++it)
     {
-      if (msg.isOutgoing) return colorPairTextSent;
+      bool isSelectedMessage = firstMessage && selectMessageActive;
+      firstMessage = false;
 
-      if (msg.senderId == currentChat.second) return colorPairTextRecv;
+      CompactMessage& msg = messages[*it];
 
-      static bool isUserColor = UiColorConfig::IsUserColor("history_text_recv_group_color");
-      if (!isUserColor)
+      int attributeText = isSelectedMessage ? attributeTextSelected : attributeTextNormal;
+      int colorPairText = [&]()
       {
-        static int colorPairGroup = UiColorConfig::GetColorPair("history_text_recv_group_color");
-        return colorPairGroup;
-      }
+        if (msg.isOutgoing) return colorPairTextSent;
 
-      int colorPairGroup = UiColorConfig::GetUserColorPair("history_text_recv_group_color",
-                                                           msg.senderId);
-      return colorPairGroup;
-    }();
+        if (msg.senderId == currentChat.second) return colorPairTextRecv;
 
-    std::vector<std::wstring> wlines;
-    if (!msg.text.empty())
-    {
-      std::string text = msg.text;
-      if (!emojiEnabled)
+        static bool isUserColor = UiColorConfig::IsUserColor("history_text_recv_group_color");
+        if (!isUserColor)
+        {
+          static int colorPairGroup = UiColorConfig::GetColorPair("history_text_recv_group_color");
+          return colorPairGroup;
+        }
+
+        int colorPairGroup = UiColorConfig::GetUserColorPair("history_text_recv_group_color",
+                                                             msg.senderId);
+        return colorPairGroup;
+      }();
+
+      std::vector<std::wstring> wlines;
+      if (!msg.text.empty())
       {
-        text = StrUtil::Textize(text);
+        wlines = m_LayoutWorker.GetLines(msg.id, msg.text, m_PaddedW, emojiEnabled);
       }
 
-      wlines = StrUtil::WordWrap(StrUtil::ToWString(text), m_PaddedW, false, false, false, 2);
-    }
-
-    if (!msg.quotedId.empty())
-    {
-      std::string quotedText;
-      auto quotedIt = messages.find(msg.quotedId);
-      if (quotedIt != messages.end())
+      if (!msg.quotedId.empty())
       {
-        if (!quotedIt->second.text.empty())
+        std::wstring quote;
+        auto quotedIt = messages.find(msg.quotedId);
+        if (quotedIt != messages.end())
         {
-          quotedText = StrUtil::Split(quotedIt->second.text, '\n').at(0);
-          if (!emojiEnabled)
+          if (!quotedIt->second.text.empty())
+          {
+            quote = GetQuoteLine(msg.quotedId, quotedIt->second.text, emojiEnabled);
+          }
+          else if (!quotedIt->second.fileInfo.empty())
           {
-            quotedText = StrUtil::Textize(quotedText);
+            const FileInfo& fileInfo = UiModel::GetAttachmentInfo(chatState, quotedIt->second).fileInfo;
+            quote = GetQuoteLine(msg.quotedId, FileUtil::BaseName(fileInfo.filePath), true /* p_EmojiEnabled */);
+          }
+          else
+          {
+            quote = GetQuoteLine(msg.quotedId, "", true /* p_EmojiEnabled */);
           }
         }
-        else if (!quotedIt->second.fileInfo.empty())
+        else
         {
-          FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(quotedIt->second.fileInfo);
-          quotedText = FileUtil::BaseName(fileInfo.filePath);
+          m_Model->FetchCachedMessage(currentChat.first, currentChat.second, msg.quotedId);
+          quote = GetQuoteLine(msg.quotedId, "", true /* p_EmojiEnabled */);
         }
+
+        wlines.insert(wlines.begin(), quote);
       }
-      else
+
+      if (!msg.fileInfo.empty())
       {
-        m_Model->FetchCachedMessage(currentChat.first, currentChat.second, msg.quotedId);
-        quotedText = "";
+        // downloads are initiated by the model's prefetch policy, rendering only reflects their status
+        const FileInfo& fileInfo = UiModel::GetAttachmentInfo(chatState, msg).fileInfo;
+
+        std::string fileName = FileUtil::BaseName(fileInfo.filePath);
+        std::string fileStatus;
+        if (fileInfo.fileStatus == FileStatusNone)
+        {
+          // should not happen
+          static const std::string statusNone = " -";
+          fileStatus = statusNone;
+        }
+        else if (fileInfo.fileStatus == FileStatusNotDownloaded)
+        {
+          static const std::string statusNotDownloaded = " " + UiConfig::GetStr("downloadable_indicator");
+          fileStatus = statusNotDownloaded;
+        }
+        else if (fileInfo.fileStatus == FileStatusDownloaded)
+        {
+          static const std::string statusDownloaded = "";
+          fileStatus = statusDownloaded;
+        }
+        else if (fileInfo.fileStatus == FileStatusDownloading)
+        {
+          static const std::string statusDownloading = " " + UiConfig::GetStr("syncing_indicator");
+          fileStatus = statusDownloading;
+          auto pit = chatState.downloadProgress.find(*it);
+          if (pit != chatState.downloadProgress.end())
+          {
+            fileStatus += " " + std::to_string(pit->second) + "%";
+          }
+        }
+        else if (fileInfo.fileStatus == FileStatusDownloadFailed)
+        {
+          static const std::string statusDownloadFailed = " " + UiConfig::GetStr("failed_indicator");
+          fileStatus = statusDownloadFailed;
+        }
+
+        std::wstring fileStr = attachmentIndicator + StrUtil::ToWString(fileName + fileStatus);
+        wlines.insert(wlines.begin(), StrUtil::TrimPadWString(fileStr, m_PaddedW));
       }
 
-      int maxQuoteLen = m_PaddedW - 3;
-      std::wstring quote = quoteIndicator + StrUtil::ToWString(quotedText);
-      if (StrUtil::WStringWidth(quote) > maxQuoteLen)
+      const int maxMessageLines = (m_PaddedH - 1);
+      if ((int)wlines.size() > maxMessageLines)
       {
-        quote = StrUtil::TrimPadWString(quote, maxQuoteLen) + L"...";
+        wlines.resize(maxMessageLines - 1);
+        wlines.push_back(StrUtil::TrimPadWString(L"[...]", m_PaddedW));
       }
 
-      wlines.insert(wlines.begin(), quote);
-    }
-
-    if (!msg.fileInfo.empty())
-    {
-      FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(msg.fileInfo);
-
-      // special case handling selection-triggered download, and handling cache's old setting
-      static const bool isAttachmentPrefetchAll =
-        (AppConfig::GetNum("attachment_prefetch") == AttachmentPrefetchAll);
-      static const bool isAttachmentPrefetchSelected =
-        (AppConfig::GetNum("attachment_prefetch") == AttachmentPrefetchSelected);
-      if (isAttachmentPrefetchAll || (isSelectedMessage && isAttachmentPrefetchSelected))
+      for (auto wline = wlines.rbegin(); wline != wlines.rend(); ++wline)
       {
-        if (!UiModel::IsAttachmentDownloaded(fileInfo) && UiModel::IsAttachmentDownloadable(fileInfo))
+        // lines are padded to width when laid out
+        const std::wstring& wdisp = *wline;
+
+        bool isAttachment = (wdisp.rfind(attachmentIndicator, 0) == 0);
+        bool isQuote = (wdisp.rfind(quoteIndicator, 0) == 0);
+
+        if (isAttachment)
+        {
+          rows[y] = Row(attributeText | colorPairTextAttachment, wdisp);
+        }
+        else if (isQuote)
         {
-          m_Model->DownloadAttachment(currentChat.first, currentChat.second, *it,
-                                      fileInfo.fileId, DownloadFileActionNone);
-          fileInfo = ProtocolUtil::FileInfoFromHex(msg.fileInfo);
+          rows[y] = Row(attributeText | colorPairTextQuoted, wdisp);
         }
+        else
+        {
+          rows[y] = Row(attributeText | colorPairText, wdisp);
+          textRows[y] = true;
+        }
+
+        if (--y < 0) break;
       }
 
-      std::string fileName = FileUtil::BaseName(fileInfo.filePath);
-      std::string fileStatus;
-      if (fileInfo.fileStatus == FileStatusNone)
+      if (y < 0) break;
+
+      int attributeName = isSelectedMessage ? attributeNameSelected : attributeNameNormal;
+      int colorPairName = [&]()
       {
-        // should not happen
-        static const std::string statusNone = " -";
-        fileStatus = statusNone;
-      }
-      else if (fileInfo.fileStatus == FileStatusNotDownloaded)
+        if (msg.isOutgoing) return colorPairNameSent;
+
+        if (msg.senderId == currentChat.second) return colorPairNameRecv;
+
+        static bool isUserColor = UiColorConfig::IsUserColor("history_name_recv_group_color");
+        if (!isUserColor)
+        {
+          static int colorPairGroup = UiColorConfig::GetColorPair("history_name_recv_group_color");
+          return colorPairGroup;
+        }
+
+        int colorPairGroup = UiColorConfig::GetUserColorPair("history_name_recv_group_color",
+                                                             msg.senderId);
+        return colorPairGroup;
+      }();
+
+      const std::wstring& wsender = GetSenderName(currentChat.first, msg.senderId, emojiEnabled);
+      std::wstring wtime;
+      if (msg.timeSent != std::numeric_limits<int64_t>::max())
       {
-        static const std::string statusNotDownloaded = " " + UiConfig::GetStr("downloadable_indicator");
-        fileStatus = statusNotDownloaded;
+        wtime = GetTimeString(msg.id, msg.timeSent);
       }
-      else if (fileInfo.fileStatus == FileStatusDownloaded)
+
+      if (!msg.isOutgoing && !msg.isRead && isCurrentChatPane)
       {
-        static const std::string statusDownloaded = "";
-        fileStatus = statusDownloaded;
+        m_Model->MarkRead(currentChat.first, currentChat.second, *it);
       }
-      else if (fileInfo.fileStatus == FileStatusDownloading)
+
+      hasUnread = hasUnread || (!msg.isOutgoing && !msg.isRead && isCurrentChatPane);
+
+      static const std::string readIndicator = " " + UiConfig::GetStr("read_indicator");
+      static const std::string pendingIndicator = " " + UiConfig::GetStr("syncing_indicator");
+      static const std::string failedIndicator = " " + UiConfig::GetStr("failed_indicator");
+      std::wstring wreceipt = StrUtil::ToWString(msg.isRead ? readIndicator : "");
+      auto outboxIt = chatState.outboxFailed.find(*it);
+      if (outboxIt != chatState.outboxFailed.end())
       {
-        static const std::string statusDownloading = " " + UiConfig::GetStr("syncing_indicator");
-        fileStatus = statusDownloading;
+        // outgoing message not yet sent
+        wreceipt = StrUtil::ToWString(outboxIt->second ? failedIndicator : pendingIndicator);
       }
-      else if (fileInfo.fileStatus == FileStatusDownloadFailed)
+
+      std::wstring wheader = wsender + wtime + wreceipt;
+
+      static const bool developerMode = AppUtil::GetDeveloperMode();
+      if (developerMode)
       {
-        static const std::string statusDownloadFailed = " " + UiConfig::GetStr("failed_indicator");
-        fileStatus = statusDownloadFailed;
+        wheader = wheader +
+          L" msg " + StrUtil::ToWString(msg.id) +
+          L" user " + StrUtil::ToWString(msg.senderId);
       }
 
-      std::wstring fileStr = attachmentIndicator + StrUtil::ToWString(fileName + fileStatus);
-      wlines.insert(wlines.begin(), fileStr);
+      std::wstring wdisp = StrUtil::TrimPadWString(wheader, m_PaddedW);
+      rows[y] = Row(attributeName | colorPairName, wdisp);
+
+      ++m_HistoryShowCount;
+
+      if (--y < 0) break;
+
+      if (--y < 0) break;
     }
 
-    const int maxMessageLines = (m_PaddedH - 1);
-    if ((int)wlines.size() > maxMessageLines)
+    if (isCurrentChatPane)
     {
-      wlines.resize(maxMessageLines - 1);
-      wlines.push_back(L"[...]");
+      m_Model->FlushMarkRead(currentChat.first, currentChat.second);
     }
 
-    for (auto wline = wlines.rbegin(); wline != wlines.rend(); ++wline)
+    // lay out pages around the visible messages ahead on the worker, older first as paging up is
+    // the common direction
+    const PrefetchKey prefetchKey(currentChat, messageOffset, messageVec.size(), m_PaddedW, emojiEnabled);
+    if (!currentChat.second.empty() && (prefetchKey != m_PrefetchKey))
     {
-      std::wstring wdisp = StrUtil::TrimPadWString(*wline, m_PaddedW);
-
-      bool isAttachment = (wdisp.rfind(attachmentIndicator, 0) == 0);
-      bool isQuote = (wdisp.rfind(quoteIndicator, 0) == 0);
-
-      if (isAttachment)
-      {
-        wattron(m_PaddedWin, attributeText | colorPairTextAttachment);
-      }
-      else if (isQuote)
-      {
-        wattron(m_PaddedWin, attributeText | colorPairTextQuoted);
-      }
-      else
+      m_PrefetchKey = prefetchKey;
+      const int count = messageVec.size();
+      const int pageCount = std::max(m_HistoryShowCount, 1);
+      std::vector<int> indexes;
+      for (int i = messageOffset + m_HistoryShowCount; i < std::min(count, messageOffset + m_HistoryShowCount +
+                                                                    (s_PrefetchPages * pageCount)); ++i)
       {
-        wattron(m_PaddedWin, attributeText | colorPairText);
+        indexes.push_back(i);
       }
 
-      mvwaddnwstr(m_PaddedWin, y, 0, wdisp.c_str(), std::min((int)wdisp.size(), m_PaddedW));
-
-      if (isAttachment)
-      {
-        wattroff(m_PaddedWin, attributeText | colorPairTextAttachment);
-      }
-      else if (isQuote)
+      for (int i = std::min(count, messageOffset) - 1; i >= std::max(0, messageOffset - pageCount); --i)
       {
-        wattroff(m_PaddedWin, attributeText | colorPairTextQuoted);
+        indexes.push_back(i);
       }
-      else
+
+      std::vector<LayoutWorker::Job> jobs;
+      for (const int index : indexes)
       {
-        wattroff(m_PaddedWin, attributeText | colorPairText);
+        auto msgIt = messages.find(messageVec[index]);
+        if ((msgIt == messages.end()) || msgIt->second.text.empty()) continue;
+
+        jobs.push_back(LayoutWorker::Job{ msgIt->first, msgIt->second.text });
       }
 
-      if (--y < 0) break;
+      m_LayoutWorker.Prefetch(std::move(jobs), m_PaddedW, emojiEnabled);
     }
 
-    if (y < 0) break;
-
-    int attributeName = isSelectedMessage ? attributeNameSelected : attributeNameNormal;
-    int colorPairName = [&]()
+    if (!currentChat.second.empty() && !hasUnread)
     {
-      if (msg.isOutgoing) return colorPairNameSent;
+      frame.historyVersion = chatState.historyVersion; // after marking messages read
+      frame.contactInfosUpdateTime = contactInfosUpdateTime;
+      frame.emojiEnabled = emojiEnabled;
+      frame.selectMessageActive = selectMessageActive;
+      frame.validUntil = m_RowsValidUntil;
+      frame.rows = rows;
+      frame.textRows = textRows;
+      frame.historyShowCount = m_HistoryShowCount;
+      m_FrameCache.Put(currentChat, frame, 1);
+    }
+    else
+    {
+      m_FrameCache.Remove(currentChat);
+    }
+  }
 
-      if (msg.senderId == currentChat.second) return colorPairNameRecv;
+  if ((int)m_DrawnRows.size() != m_PaddedH)
+  {
+    werase(m_PaddedWin);
+    wbkgd(m_PaddedWin, attributeTextNormal | colorPairTextRecv | ' ');
+    m_DrawnRows.assign(m_PaddedH, Row(-1, L""));
+  }
+  else if (findHighlight != m_DrawnFindHighlight)
+  {
+    m_DrawnRows.assign(m_PaddedH, Row(-1, L""));
+  }
 
-      static bool isUserColor = UiColorConfig::IsUserColor("history_name_recv_group_color");
-      if (!isUserColor)
-      {
-        static int colorPairGroup = UiColorConfig::GetColorPair("history_name_recv_group_color");
-        return colorPairGroup;
-      }
+  m_DrawnFindHighlight = findHighlight;
 
-      int colorPairGroup = UiColorConfig::GetUserColorPair("history_name_recv_group_color",
-                                                           msg.senderId);
-      return colorPairGroup;
-    }();
+  for (int row = 0; row < m_PaddedH; ++row)
+  {
+    if (rows[row] == m_DrawnRows[row]) continue;
 
-    wattron(m_PaddedWin, attributeName | colorPairName);
-    std::string name = m_Model->GetContactName(currentChat.first, msg.senderId);
-    if (!emojiEnabled)
+    const int attr = rows[row].first;
+    const std::wstring& wdisp = rows[row].second;
+    wmove(m_PaddedWin, row, 0);
+    wclrtoeol(m_PaddedWin);
+    if (!wdisp.empty())
     {
-      name = StrUtil::Textize(name);
+      wattron(m_PaddedWin, attr);
+      mvwaddnwstr(m_PaddedWin, row, 0, wdisp.c_str(), std::min((int)wdisp.size(), m_PaddedW));
+      wattroff(m_PaddedWin, attr);
+      if (textRows[row] && !findHighlight.empty())
+      {
+        DrawFindHighlight(row, attr ^ attributeTextFind, wdisp, findHighlight);
+      }
     }
+  }
 
-    std::wstring wsender = StrUtil::ToWString(name);
-    std::wstring wtime;
-    if (msg.timeSent != std::numeric_limits<int64_t>::max())
-    {
-      wtime = L" (" + StrUtil::ToWString(TimeUtil::GetTimeString(msg.timeSent, false /* p_IsExport */)) + L")";
-    }
+  m_DrawnRows.swap(rows);
+  wnoutrefresh(m_PaddedWin);
+}
 
-    if (!msg.isOutgoing && !msg.isRead)
-    {
-      m_Model->MarkRead(currentChat.first, currentChat.second, *it);
-    }
+std::wstring UiHistoryView::GetTimeString(const std::string& p_MsgId, int64_t p_TimeSent)
+{
+  // relative time strings (today, weekday) expire, so entries carry their validity
+  const TimeKey timeKey(p_MsgId, p_TimeSent);
+  TimeValue timeValue;
+  if (!m_TimeLayoutCache.Get(timeKey, timeValue) || (time(NULL) >= timeValue.second))
+  {
+    const std::string timeStr = m_TimeFormatter.GetTimeString(p_TimeSent, &timeValue.second);
+    timeValue.first = L" (" + StrUtil::ToWString(timeStr) + L")";
+    m_TimeLayoutCache.Put(timeKey, timeValue, 1);
+  }
 
-    static const std::string readIndicator = " " + UiConfig::GetStr("read_indicator");
-    std::wstring wreceipt = StrUtil::ToWString(msg.isRead ? readIndicator : "");
-    std::wstring wheader = wsender + wtime + wreceipt;
+  m_RowsValidUntil = std::min(m_RowsValidUntil, timeValue.second);
+  return timeValue.first;
+}
 
-    static const bool developerMode = AppUtil::GetDeveloperMode();
-    if (developerMode)
-    {
-      wheader = wheader +
-        L" msg " + StrUtil::ToWString(msg.id) +
-        L" user " + StrUtil::ToWString(msg.senderId);
-    }
+const std::wstring& UiHistoryView::GetSenderName(const std::string& p_ProfileId, const InternedStr& p_SenderId,
+                                                 bool p_EmojiEnabled)
+{
+  std::unordered_map<InternedStr, std::wstring>& senderNames = m_SenderNames[p_ProfileId];
+  auto it = senderNames.find(p_SenderId);
+  if (it != senderNames.end()) return it->second;
 
-    std::wstring wdisp = StrUtil::TrimPadWString(wheader, m_PaddedW);
-    mvwaddnwstr(m_PaddedWin, y, 0, wdisp.c_str(), std::min((int)wdisp.size(), m_PaddedW));
+  std::string name = m_Model->GetContactName(p_ProfileId, p_SenderId);
+  if (!p_EmojiEnabled)
+  {
+    name = StrUtil::Textize(name);
+  }
 
-    wattroff(m_PaddedWin, attributeName | colorPairName);
+  return senderNames.emplace(p_SenderId, StrUtil::ToWString(name)).first->second;
+}
 
-    ++m_HistoryShowCount;
+std::wstring UiHistoryView::GetQuoteLine(const std::string& p_QuotedId, const std::string& p_QuotedText,
+                                         bool p_EmojiEnabled)
+{
+  static std::wstring quoteIndicator = L"> ";
+  const LayoutKey layoutKey(p_QuotedId, std::hash<std::string>{ }(p_QuotedText), m_PaddedW, p_EmojiEnabled);
+  std::wstring quote;
+  if (m_QuoteLayoutCache.Get(layoutKey, quote)) return quote;
 
-    if (--y < 0) break;
+  std::string quotedText = StrUtil::SplitFirst(p_QuotedText, '\n');
+  if (!p_EmojiEnabled)
+  {
+    quotedText = StrUtil::Textize(quotedText);
+  }
 
-    if (--y < 0) break;
+  int maxQuoteLen = m_PaddedW - 3;
+  quote = quoteIndicator + StrUtil::ToWString(quotedText);
+  if (StrUtil::WStringWidth(quote) > maxQuoteLen)
+  {
+    quote = StrUtil::TrimPadWString(quote, maxQuoteLen) + L"...";
   }
 
-  wrefresh(m_PaddedWin);
+  quote = StrUtil::TrimPadWString(quote, m_PaddedW);
+
+  m_QuoteLayoutCache.Put(layoutKey, quote, 1);
+  return quote;
+}
+
+void UiHistoryView::DrawFindHighlight(int p_Row, int p_Attr, const std::wstring& p_Line,
+                                      const std::wstring& p_LowerQuery)
+{
+  // matches split over wrapped lines are not highlighted
+  size_t pos = 0;
+  while ((pos = StrUtil::FindIgnoreCase(p_Line, p_LowerQuery, pos)) != std::wstring::npos)
+  {
+    const int x = StrUtil::WStringWidth(p_Line.substr(0, pos));
+    if (x >= m_PaddedW) break;
+
+    const int w = StrUtil::WStringWidth(p_Line.substr(pos, p_LowerQuery.size()));
+    mvwchgat(m_PaddedWin, p_Row, x, std::min(w, m_PaddedW - x), p_Attr & ~A_COLOR, PAIR_NUMBER(p_Attr), nullptr);
+    pos += p_LowerQuery.size();
+  }
 }
 
 int UiHistoryView::GetHistoryShowCount()
 {
   return m_HistoryShowCount;
 }
+
+size_t UiHistoryView::GetLayoutCacheHeapSize()
+{
+  size_t size = m_LayoutWorker.GetCacheHeapSize();
+  size += m_QuoteLayoutCache.GetNodesHeapSize() + m_TimeLayoutCache.GetNodesHeapSize();
+  size += m_FrameCache.GetNodesHeapSize();
+  // *INDENT-OFF*
+  m_QuoteLayoutCache.ForEach([&](const LayoutKey& p_Key, const std::wstring& p_Quote)
+  {
+    size += HeapSize::Of(std::get<0>(p_Key)) + HeapSize::Of(p_Quote);
+  });
+  m_TimeLayoutCache.ForEach([&](const TimeKey& p_Key, const TimeValue& p_Value)
+  {
+    size += HeapSize::Of(p_Key.first) + HeapSize::Of(p_Value.first);
+  });
+  m_FrameCache.ForEach([&](const std::pair<std::string, std::string>& p_Key, const Frame& p_Frame)
+  {
+    size += HeapSize::Of(p_Key.first) + HeapSize::Of(p_Key.second) + HeapSize::Of(p_Frame.rows);
+    for (const auto& row : p_Frame.rows)
+    {
+      size += HeapSize::Of(row.second);
+    }
+  });
+  // *INDENT-ON*
+
+  return size;
+}
+
+void UiHistoryView::SetPane(int p_PaneIndex, int p_PaneCount)
+{
+  if ((p_PaneIndex != m_PaneIndex) || (p_PaneCount != m_PaneCount))
+  {
+    m_PaneIndex = p_PaneIndex;
+    m_PaneCount = p_PaneCount;
+    m_FrameCache.Clear();
+    m_Title.clear();
+    m_Dirty = true;
+  }
+}
@@ -8,7 +8,15 @@
 #pragma once
 
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "internedstr.h"
+#include "layoutworker.h"
+#include "lrucache.h"
+#include "timeutil.h"
 #include "uiviewbase.h"
 
 class UiHistoryView : public UiViewBase
@@ -18,14 +26,65 @@ public:
   virtual ~UiHistoryView();
 
   virtual void Draw();
+  virtual void Resize(const UiViewParams& p_Params);
   int GetHistoryShowCount();
+  size_t GetLayoutCacheHeapSize();
+  void SetPane(int p_PaneIndex, int p_PaneCount);
 
 private:
-  std::string GetTimeString(int64_t p_TimeSent);
+  void InitPaddedWin();
+  std::wstring GetTimeString(const std::string& p_MsgId, int64_t p_TimeSent);
+  const std::wstring& GetSenderName(const std::string& p_ProfileId, const InternedStr& p_SenderId,
+                                    bool p_EmojiEnabled);
+  std::wstring GetQuoteLine(const std::string& p_QuotedId, const std::string& p_QuotedText, bool p_EmojiEnabled);
+  void DrawFindHighlight(int p_Row, int p_Attr, const std::wstring& p_Line, const std::wstring& p_LowerQuery);
 
 private:
+  typedef std::pair<int, std::wstring> Row; // attributes and text
+  std::vector<Row> m_DrawnRows;
+  std::wstring m_DrawnFindHighlight; // find query highlighted in drawn rows
+
+  // rendered rows of recently drawn chats, reused when a chat is drawn again without changes since,
+  // e.g. when returning to it. only valid for the current window size, cleared on resize.
+  class Frame
+  {
+  public:
+    uint64_t historyVersion = 0; // chat state version rows were rendered at
+    int64_t contactInfosUpdateTime = 0;
+    bool emojiEnabled = false;
+    bool selectMessageActive = false;
+    int64_t validUntil = 0; // sec, expiry of relative time strings in rows
+    std::vector<Row> rows;
+    std::vector<bool> textRows;
+    int historyShowCount = 0;
+  };
+  LruCache<std::pair<std::string, std::string>, Frame> m_FrameCache; // by chat
+  int64_t m_RowsValidUntil = 0;
+
+  LayoutWorker m_LayoutWorker; // wrapped text lines
+  typedef std::tuple<std::string, size_t, int, bool> LayoutKey; // msg id, text hash, width and emoji enabled
+  LruCache<LayoutKey, std::wstring> m_QuoteLayoutCache;
+
+  // chat, offset, message count, width and emoji enabled of last layout prefetch
+  typedef std::tuple<std::pair<std::string, std::string>, int, size_t, int, bool> PrefetchKey;
+  PrefetchKey m_PrefetchKey;
+  static const int s_PrefetchPages;
+
+  typedef std::pair<std::string, int64_t> TimeKey; // msg id and time sent
+  typedef std::pair<std::wstring, int64_t> TimeValue; // time string and valid until (sec)
+  LruCache<TimeKey, TimeValue> m_TimeLayoutCache;
+  TimeFormatter m_TimeFormatter;
+
+  // @note: sender display names by profile, cleared when contact infos or emoji setting changes
+  std::unordered_map<std::string, std::unordered_map<InternedStr, std::wstring>> m_SenderNames;
+  int64_t m_SenderNamesUpdateTime = -1;
+  bool m_SenderNamesEmojiEnabled = false;
+
   WINDOW* m_PaddedWin = nullptr;
   int m_PaddedH = 0;
   int m_PaddedW = 0;
   int m_HistoryShowCount = 0;
+  int m_PaneIndex = 0; // split view pane, zero is current chat
+  int m_PaneCount = 1;
+  std::wstring m_Title; // chat name drawn above pane in split view
 };
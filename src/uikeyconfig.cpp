@@ -16,11 +16,12 @@
 #include "strutil.h"
 
 Config UiKeyConfig::m_Config;
-std::map<std::string, int> UiKeyConfig::m_KeyCodes;
+std::unordered_map<std::string, int> UiKeyConfig::m_KeyCodes;
+bool UiKeyConfig::m_Loaded = false;
 
 void UiKeyConfig::InitKeyCodes()
 {
-  m_KeyCodes = std::map<std::string, int>({
+  m_KeyCodes = std::unordered_map<std::string, int>({
     // additional keys
     { "KEY_TAB", KEY_TAB },
     { "KEY_RETURN", KEY_RETURN },
@@ -165,10 +166,13 @@ void UiKeyConfig::InitKeyCodes()
     { "KEY_RESIZE", KEY_RESIZE },
     { "KEY_FOCUS_IN", GetVirtualKeyCodeFromOct("\\033\\133\\111") }, // 033[I
     { "KEY_FOCUS_OUT", GetVirtualKeyCodeFromOct("\\033\\133\\117") }, // 033[O
+    { "KEY_PASTE_BEGIN", GetVirtualKeyCodeFromOct("\\033\\133\\062\\060\\060\\176") }, // 033[200~
+    { "KEY_PASTE_END", GetVirtualKeyCodeFromOct("\\033\\133\\062\\060\\061\\176") }, // 033[201~
   });
 }
 
-void UiKeyConfig::Init()
+// parses key.conf, independent of curses so it may run before initscr
+void UiKeyConfig::Load()
 {
   const std::map<std::string, std::string> defaultConfig =
   {
@@ -212,6 +216,7 @@ void UiKeyConfig::Init()
     { "toggle_help", "KEY_CTRLG" },
     { "toggle_list", "KEY_CTRLL" },
     { "toggle_top", "KEY_CTRLP" },
+    { "toggle_split_view", "KEY_NONE" },
     { "next_chat", "KEY_TAB" },
     { "prev_chat", "KEY_BTAB" },
     { "unread_chat", "KEY_CTRLF" },
@@ -225,16 +230,33 @@ void UiKeyConfig::Init()
     { "transfer", "KEY_CTRLT" },
     { "select_emoji", "KEY_CTRLS" },
     { "select_contact", "KEY_CTRLN" },
+    { "search_msg", "\\33\\57" }, // alt/opt-/
     { "other_commands_help", "KEY_CTRLO" },
     { "decrease_list_width", "\\33\\54" }, // alt/opt-,
     { "increase_list_width", "\\33\\56" }, // alt/opt-.
     { "terminal_focus_in", "KEY_FOCUS_IN" },
     { "terminal_focus_out", "KEY_FOCUS_OUT" },
+    { "terminal_paste_begin", "KEY_PASTE_BEGIN" },
+    { "terminal_paste_end", "KEY_PASTE_END" },
     { "terminal_resize", "KEY_RESIZE" },
+    { "dump_trace", "KEY_NONE" },
+    { "export", "KEY_NONE" },
+    { "backfill_chat", "KEY_NONE" },
+    { "filter_profile", "KEY_NONE" },
+    { "find_msg", "KEY_NONE" },
   };
 
   const std::string configPath(FileUtil::GetApplicationDir() + std::string("/key.conf"));
   m_Config = Config(configPath, defaultConfig);
+  m_Loaded = true;
+}
+
+void UiKeyConfig::Init()
+{
+  if (!m_Loaded)
+  {
+    Load();
+  }
 
   InitKeyCodes();
 }
@@ -292,7 +314,7 @@ int UiKeyConfig::GetOffsettedKeyCode(int p_KeyCode)
 int UiKeyConfig::GetKeyCode(const std::string& p_KeyName)
 {
   int keyCode = -1;
-  std::map<std::string, int>::iterator it = m_KeyCodes.find(p_KeyName);
+  std::unordered_map<std::string, int>::iterator it = m_KeyCodes.find(p_KeyName);
   if (it != m_KeyCodes.end())
   {
     keyCode = GetOffsettedKeyCode(it->second);
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 
 #include "config.h"
 
@@ -19,6 +20,7 @@
 class UiKeyConfig
 {
 public:
+  static void Load();
   static void Init();
   static void Cleanup();
   static int GetKey(const std::string& p_Param);
@@ -36,5 +38,6 @@ private:
 
 private:
   static Config m_Config;
-  static std::map<std::string, int> m_KeyCodes;
+  static std::unordered_map<std::string, int> m_KeyCodes;
+  static bool m_Loaded;
 };
@@ -42,6 +42,21 @@ bool UiListDialog::Run()
       KeyHandler(key);
     }
 
+    // dialog blocks the ui loop, so apply model updates for dialogs depending on them
+    m_Model->ProcessServiceMessages();
+
+    // large lists are filtered in background, refresh once results are available
+    if (m_ListFilter.PollCompleted())
+    {
+      UpdateList();
+      Draw();
+    }
+
+    if (OnPoll())
+    {
+      Draw();
+    }
+
     int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
     if ((nowTime - lastTimerEvent) > 1000)
     {
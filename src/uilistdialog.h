@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "listfilter.h"
 #include "uidialog.h"
 
 class UiListDialog : public UiDialog
@@ -26,6 +27,7 @@ protected:
   virtual void OnBack() = 0;
   virtual bool OnTimer() = 0;
   virtual void UpdateList() = 0;
+  virtual bool OnPoll() { return false; }
 
 private:
   void Draw();
@@ -35,6 +37,7 @@ protected:
   bool m_Running = true;
   bool m_Result = false;
   std::wstring m_FilterStr;
+  ListFilter m_ListFilter;
   std::vector<std::wstring> m_Items;
   int m_Index = 0;
   int m_MaxW = 0;
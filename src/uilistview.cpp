@@ -13,6 +13,32 @@
 
 UiListView::UiListView(const UiViewParams& p_Params)
   : UiViewBase(p_Params)
+{
+  InitPaddedWin();
+}
+
+UiListView::~UiListView()
+{
+  if (m_PaddedWin != nullptr)
+  {
+    delwin(m_PaddedWin);
+    m_PaddedWin = nullptr;
+  }
+}
+
+void UiListView::Resize(const UiViewParams& p_Params)
+{
+  if (m_PaddedWin != nullptr)
+  {
+    delwin(m_PaddedWin);
+    m_PaddedWin = nullptr;
+  }
+
+  UiViewBase::Resize(p_Params);
+  InitPaddedWin();
+}
+
+void UiListView::InitPaddedWin()
 {
   if (m_Enabled)
   {
@@ -31,15 +57,6 @@ UiListView::UiListView(const UiViewParams& p_Params)
   }
 }
 
-UiListView::~UiListView()
-{
-  if (m_PaddedWin != nullptr)
-  {
-    delwin(m_PaddedWin);
-    m_PaddedWin = nullptr;
-  }
-}
-
 void UiListView::Draw()
 {
   std::unique_lock<std::mutex> lock(m_ViewMutex);
@@ -54,27 +71,25 @@ void UiListView::Draw()
   static int attributeSelected = UiColorConfig::GetAttribute("list_attr_selected");
 
   int index = std::max(0, m_Model->GetCurrentChatIndex());
-  const std::vector<std::pair<std::string, std::string>>& p_ChatVec = m_Model->GetChatVec();
+  const std::vector<UiModel::ChatKey>& p_ChatVec = m_Model->GetChatVec();
 
   const bool emojiEnabled = m_Model->GetEmojiEnabled();
-  std::vector<std::string> names;
-  std::vector<bool> unreads;
-  for (auto& chatPair : p_ChatVec)
+  const int64_t contactInfosUpdateTime = m_Model->GetContactInfosUpdateTimeNoLock();
+  if ((m_DisplayNamesUpdateTime != contactInfosUpdateTime) || (m_DisplayNamesEmojiEnabled != emojiEnabled))
   {
-    const std::string& name = m_Model->GetContactListName(chatPair.first, chatPair.second);
-    bool isUnread = m_Model->GetChatIsUnread(chatPair.first, chatPair.second);
-    names.push_back(name);
-    unreads.push_back(isUnread);
+    m_DisplayNames.clear();
+    m_DisplayNamesUpdateTime = contactInfosUpdateTime;
+    m_DisplayNamesEmojiEnabled = emojiEnabled;
   }
 
   werase(m_PaddedWin);
   wbkgd(m_PaddedWin, attribute | colorPair | ' ');
   wattron(m_PaddedWin, attribute | colorPair);
 
-  if (!names.empty())
+  if (!p_ChatVec.empty())
   {
     int height = m_PaddedH;
-    int count = names.size();
+    int count = p_ChatVec.size();
     int offset = std::min(std::max(0, index - ((height - 1) / 2)), std::max(0, count - height));
     int last = std::min((height + offset), count);
     for (int i = offset; i < last; ++i)
@@ -86,20 +101,16 @@ void UiListView::Draw()
       }
 
       int y = i - offset;
-      std::string name = names[i];
-      if (!emojiEnabled)
-      {
-        name = StrUtil::Textize(name);
-      }
-
-      std::wstring wname = StrUtil::ToWString(name).substr(0, m_PaddedW);
-      wname = StrUtil::TrimPadWString(wname, m_PaddedW);
-
+      const UiModel::ChatKey& chat = p_ChatVec[i];
+      const std::wstring& wname = GetDisplayName(chat, emojiEnabled);
       mvwaddnwstr(m_PaddedWin, y, 0, wname.c_str(), wname.size());
 
-      if (unreads[i])
+      if (m_Model->GetChatIsUnread(chat.first, chat.second))
       {
-        mvwprintw(m_PaddedWin, y, (m_PaddedW - 2), " *");
+        // unread count when known from cache, otherwise only marked
+        const int32_t unreadCount = m_Model->GetChatUnreadCount(chat.first, chat.second);
+        const std::string badge = (unreadCount > 0) ? (" " + std::to_string(unreadCount)) : " *";
+        mvwprintw(m_PaddedWin, y, std::max(0, m_PaddedW - (int)badge.size()), "%s", badge.c_str());
       }
 
       if (i == index)
@@ -111,5 +122,21 @@ void UiListView::Draw()
   }
 
   wattroff(m_PaddedWin, attribute | colorPair);
-  wrefresh(m_PaddedWin);
+  wnoutrefresh(m_PaddedWin);
+}
+
+const std::wstring& UiListView::GetDisplayName(const UiModel::ChatKey& p_Chat, bool p_EmojiEnabled)
+{
+  auto it = m_DisplayNames.find(p_Chat);
+  if (it != m_DisplayNames.end()) return it->second;
+
+  std::string name = m_Model->GetContactListName(p_Chat.first, p_Chat.second);
+  if (!p_EmojiEnabled)
+  {
+    name = StrUtil::Textize(name);
+  }
+
+  std::wstring wname = StrUtil::ToWString(name).substr(0, m_PaddedW);
+  wname = StrUtil::TrimPadWString(wname, m_PaddedW);
+  return m_DisplayNames.emplace(p_Chat, wname).first->second;
 }
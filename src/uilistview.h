@@ -7,8 +7,12 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+
 #include <ncurses.h>
 
+#include "uimodel.h"
 #include "uiviewbase.h"
 
 class UiListView : public UiViewBase
@@ -18,9 +22,19 @@ public:
   virtual ~UiListView();
 
   virtual void Draw();
+  virtual void Resize(const UiViewParams& p_Params);
+
+private:
+  void InitPaddedWin();
+  const std::wstring& GetDisplayName(const UiModel::ChatKey& p_Chat, bool p_EmojiEnabled);
 
 private:
   WINDOW* m_PaddedWin = nullptr;
   int m_PaddedH = 0;
   int m_PaddedW = 0;
+
+  // @note: padded display names, cleared when contact infos or emoji setting changes
+  std::map<UiModel::ChatKey, std::wstring> m_DisplayNames;
+  int64_t m_DisplayNamesUpdateTime = -1;
+  bool m_DisplayNamesEmojiEnabled = false;
 };
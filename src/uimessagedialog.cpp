@@ -113,12 +113,10 @@ void UiMessageDialog::Draw()
   wbkgd(m_Win, colorPair | ' ');
   wattron(m_Win, attribute | colorPair);
 
-  std::vector<std::wstring> wlines;
-  wlines = StrUtil::WordWrap(StrUtil::ToWString(m_Message), m_W, false, false, false, 2);
-
-  for (int i = 0; i < std::min(m_H - 1, (int)wlines.size()); ++i)
+  WrapLines(m_H - 1);
+  for (int i = 0; i < std::min(m_H - 1, (int)m_Lines.size()); ++i)
   {
-    const std::wstring& wdisp = wlines.at(i);
+    const std::wstring& wdisp = m_Lines.at(i);
     int w = std::min((int)wdisp.size(), m_W);
     int x = std::max(0, ((m_W - w) / 2));
     mvwaddnwstr(m_Win, i + 1, x, wdisp.c_str(), w);
@@ -127,3 +125,41 @@ void UiMessageDialog::Draw()
   wattroff(m_Win, attribute | colorPair);
   wrefresh(m_Win);
 }
+
+void UiMessageDialog::WrapLines(int p_Count)
+{
+  // text is converted and wrapped only as far as needed to fill the dialog, so that very large
+  // messages do not stall the ui, and kept between draws until the width changes
+  if (m_LinesW != m_W)
+  {
+    m_Lines.clear();
+    m_LinesW = m_W;
+    m_MessagePos = 0;
+  }
+
+  // a long line is wrapped in chunks, each holding enough chars to fill the dialog
+  const size_t maxChunkSize = std::max(p_Count, 1) * std::max(m_W, 1) * 4;
+  while (((int)m_Lines.size() < p_Count) && (m_MessagePos < m_Message.size()))
+  {
+    size_t lineEnd = m_Message.find('\n', m_MessagePos);
+    size_t nextPos = (lineEnd == std::string::npos) ? m_Message.size() : (lineEnd + 1);
+    lineEnd = (lineEnd == std::string::npos) ? m_Message.size() : lineEnd;
+    if ((lineEnd - m_MessagePos) > maxChunkSize)
+    {
+      const size_t chunkEnd = m_MessagePos + maxChunkSize;
+      lineEnd = chunkEnd;
+      while ((lineEnd > m_MessagePos) && ((m_Message[lineEnd] & 0xC0) == 0x80))
+      {
+        --lineEnd; // utf-8 continuation byte
+      }
+
+      lineEnd = (lineEnd > m_MessagePos) ? lineEnd : chunkEnd;
+      nextPos = lineEnd;
+    }
+
+    StrUtil::WordWrapLine(StrUtil::ToWString(m_Message.substr(m_MessagePos, lineEnd - m_MessagePos)), m_W,
+                          false /*p_OutputFormatFlowed*/, false /*p_QuoteWrap*/, 2 /*p_ExpandTabSize*/,
+                          (m_MessagePos == 0) /*p_IsFirstLine*/, m_Lines);
+    m_MessagePos = nextPos;
+  }
+}
@@ -23,9 +23,13 @@ public:
 
 private:
   void Draw();
+  void WrapLines(int p_Count);
 
 protected:
   bool m_Running = true;
   bool m_Result = false;
   std::string m_Message;
+  std::vector<std::wstring> m_Lines; // wrapped so far, at width m_LinesW
+  int m_LinesW = -1;
+  size_t m_MessagePos = 0; // start of text not yet wrapped
 };
@@ -8,19 +8,29 @@
 #include "uimodel.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 
 #include <ncurses.h>
 
 #include "appconfig.h"
-#include "clipboard.h"
+#include "apputil.h"
+#include "emojilist.h"
 #include "fileutil.h"
+#include "heapsize.h"
 #include "log.h"
+#include "memorygovernor.h"
+#include "messagecache.h"
 #include "numutil.h"
+#include "perfstats.h"
+#include "previewstore.h"
 #include "protocolutil.h"
 #include "sethelp.h"
+#include "startupprofile.h"
 #include "status.h"
 #include "strutil.h"
 #include "timeutil.h"
+#include "trace.h"
 #include "uidialog.h"
 #include "uiconfig.h"
 #include "uicontactlistdialog.h"
@@ -30,13 +40,38 @@
 #include "uikeyconfig.h"
 #include "uikeyinput.h"
 #include "uimessagedialog.h"
+#include "uisearchlistdialog.h"
 #include "uiview.h"
 
-const std::pair<std::string, std::string> UiModel::s_ChatNone;
+const int64_t UiModel::s_PrefetchIntervalMs = 1000;
+const int64_t UiModel::s_PerfStatsIntervalMs = 1000;
+const int64_t UiModel::s_ResizeDebounceMs = 100;
+const size_t UiModel::s_PasteChunkSize = 16 * 1024;
+const int64_t UiModel::s_UserStatusTtlMs = 5 * 60 * 1000;
+const int64_t UiModel::s_UsersTypingExpiryMs = 30 * 1000;
+const int UiModel::s_BackfillBatchSize = 1000;
+const size_t UiModel::s_FetchedMessageIdsMax = 10000;
+const int64_t UiModel::s_FetchedMessageRetryMs = 10 * 60 * 1000;
+const int64_t UiModel::s_OutboxSendTimeoutMs = 10 * 60 * 1000;
+const int64_t UiModel::s_OutboxRetryMaxMs = 5 * 60 * 1000;
+const int UiModel::s_OutboxMaxAttempts = 5;
+const int UiModel::s_OutboxBatchSize = 16;
+const int UiModel::s_MemoryPressureMaxMessages = 100;
+const int64_t UiModel::s_PageScreenLatencyUs = 200 * 1000;
+const int UiModel::s_PageMaxScreens = 4;
+const int UiModel::s_PageMaxMessages = 100;
+const int64_t UiModel::s_ResumeMinSuspendMs = 10 * 1000;
+const int UiModel::s_ResumeMaxCatchUpChats = 16;
+const int64_t UiModel::s_InputLatencyMaxUs = 10 * 1000 * 1000;
+const UiModel::ChatKey UiModel::s_ChatNone;
 
 UiModel::UiModel()
+  : m_FetchedMessageIds(s_FetchedMessageIdsMax, s_FetchedMessageRetryMs)
+  , m_StatusTimeFormatter(false /* p_IsExport */)
 {
   m_View = std::make_shared<UiView>(this);
+  AppUtil::SetTerminalActive(m_TerminalActive);
+  m_ClockOffset = TimeUtil::GetCurrentTimeMSec() - TimeUtil::GetSteadyTimeMSec();
 }
 
 UiModel::~UiModel()
@@ -46,101 +81,100 @@ UiModel::~UiModel()
 void UiModel::Init()
 {
   m_View->Init();
+  InitKeyBindings();
+
+  // muted chat position may have changed
+  // *INDENT-OFF*
+  UiConfig::AddChangeHandler([this]()
+  {
+    std::unique_lock<std::mutex> lock(m_ModelMutex);
+    SortChats();
+    UpdateList();
+  });
+
+  // called from memory governor thread, the model is trimmed by ui thread
+  m_ReclaimerId = MemoryGovernor::AddReclaimer("ui model", [this]()
+  {
+    m_MemoryPressure = true;
+    UiController::Wakeup();
+  });
+  // *INDENT-ON*
 }
 
 void UiModel::Cleanup()
 {
+  MemoryGovernor::RemoveReclaimer(m_ReclaimerId);
 }
 
 void UiModel::KeyHandler(wint_t p_Key)
 {
+  m_PrefetchPending = true;
+
+  // keys from the ui loop are stamped when read, others (e.g. scripted) when handled
+  const int64_t keyTimeUSec = UiController::GetKeyTimeUSec();
+  m_KeyTimeUSec = (keyTimeUSec != 0) ? keyTimeUSec : PerfStats::GetTimeUSec();
+
   if (m_HomeFetchAll)
   {
     LOG_TRACE("home fetch stopped");
     m_HomeFetchAll = false;
   }
 
-  static wint_t keyPrevPage = UiKeyConfig::GetKey("prev_page");
-  static wint_t keyNextPage = UiKeyConfig::GetKey("next_page");
-  static wint_t keyEnd = UiKeyConfig::GetKey("end");
-  static wint_t keyHome = UiKeyConfig::GetKey("home");
-
-  static wint_t keySendMsg = UiKeyConfig::GetKey("send_msg");
-  static wint_t keyNextChat = UiKeyConfig::GetKey("next_chat");
-  static wint_t keyPrevChat = UiKeyConfig::GetKey("prev_chat");
-  static wint_t keyUnreadChat = UiKeyConfig::GetKey("unread_chat");
-
-  static wint_t keyQuit = UiKeyConfig::GetKey("quit");
-  static wint_t keySelectEmoji = UiKeyConfig::GetKey("select_emoji");
-  static wint_t keySelectContact = UiKeyConfig::GetKey("select_contact");
-  static wint_t keyTransfer = UiKeyConfig::GetKey("transfer");
-  static wint_t keyDeleteMsg = UiKeyConfig::GetKey("delete_msg");
-  static wint_t keyDeleteChat = UiKeyConfig::GetKey("delete_chat");
-  static wint_t keyEditMsg = UiKeyConfig::GetKey("edit_msg");
-  static wint_t keyCancel = UiKeyConfig::GetKey("cancel");
-
-  static wint_t keyOpen = UiKeyConfig::GetKey("open");
-  static wint_t keyOpenLink = UiKeyConfig::GetKey("open_link");
-  static wint_t keyOpenMsg = UiKeyConfig::GetKey("open_msg");
-  static wint_t keySave = UiKeyConfig::GetKey("save");
-
-  static wint_t keyCut = UiKeyConfig::GetKey("cut");
-  static wint_t keyCopy = UiKeyConfig::GetKey("copy");
-  static wint_t keyPaste = UiKeyConfig::GetKey("paste");
-
-  static wint_t keySpell = UiKeyConfig::GetKey("spell");
-
-  static wint_t keyToggleList = UiKeyConfig::GetKey("toggle_list");
-  static wint_t keyToggleTop = UiKeyConfig::GetKey("toggle_top");
-  static wint_t keyToggleHelp = UiKeyConfig::GetKey("toggle_help");
-  static wint_t keyToggleEmoji = UiKeyConfig::GetKey("toggle_emoji");
-
-  static wint_t keyDecreaseListWidth = UiKeyConfig::GetKey("decrease_list_width");
-  static wint_t keyIncreaseListWidth = UiKeyConfig::GetKey("increase_list_width");
-
-  static wint_t keyExtEdit = UiKeyConfig::GetKey("ext_edit");
-  static wint_t keyExtCall = UiKeyConfig::GetKey("ext_call");
-
-  static wint_t keyOtherCommandsHelp = UiKeyConfig::GetKey("other_commands_help");
-  static wint_t keyTerminalFocusIn = UiKeyConfig::GetKey("terminal_focus_in");
-  static wint_t keyTerminalFocusOut = UiKeyConfig::GetKey("terminal_focus_out");
-  static wint_t keyTerminalResize = UiKeyConfig::GetKey("terminal_resize");
-
-  if (p_Key == keyTerminalResize)
+  if (m_FindActive && FindKeyHandler(p_Key))
   {
-    SetHelpOffset(0);
-    ReinitView();
+    m_KeyTimeUSec = 0;
     return;
   }
-  else if (p_Key == keyTerminalFocusIn)
+
+  std::unordered_map<wint_t, KeyBinding>::const_iterator it = m_KeyBindings.find(p_Key);
+  if (it == m_KeyBindings.end())
   {
-    SetTerminalActive(true);
+    SetCurrentChatIndexIfNotSet(); // set current chat upon any user interaction
+    EntryKeyHandler(p_Key);
+    StartInputLatency(PerfStats::StatInputTypingUs);
+    m_KeyTimeUSec = 0;
     return;
   }
-  else if (p_Key == keyTerminalFocusOut)
+
+  if (it->second.isInteraction)
   {
-    SetTerminalActive(false);
-    return;
+    SetCurrentChatIndexIfNotSet(); // set current chat upon any user interaction
   }
 
-  SetCurrentChatIndexIfNotSet(); // set current chat upon any user interaction
+  it->second.handler();
+  m_KeyTimeUSec = 0;
+}
 
-  if (p_Key == keyToggleHelp)
-  {
-    m_View->SetHelpEnabled(!m_View->GetHelpEnabled());
-    ReinitView();
-  }
-  else if (p_Key == keyToggleList)
-  {
-    m_View->SetListEnabled(!m_View->GetListEnabled());
-    ReinitView();
-  }
-  else if (p_Key == keyToggleTop)
-  {
-    m_View->SetTopEnabled(!m_View->GetTopEnabled());
+void UiModel::InitKeyBindings()
+{
+  // earlier bindings take precedence when several actions are mapped to the same key
+  m_KeyBindings.clear();
+  // *INDENT-OFF*
+  auto Bind = [this](const std::string& p_Param, bool p_IsInteraction, const std::function<void()>& p_Handler)
+  {
+    const int key = UiKeyConfig::GetKey(p_Param);
+    if (key < 0) return;
+
+    m_KeyBindings.emplace((wint_t)key, KeyBinding{ p_Handler, p_IsInteraction });
+  };
+
+  Bind("terminal_resize", false, [this]() { m_ResizeTime = TimeUtil::GetCurrentTimeMSec(); m_ResizePending = true; });
+  Bind("terminal_focus_in", false, [this]() { SetTerminalActive(true); });
+  Bind("terminal_focus_out", false, [this]() { SetTerminalActive(false); });
+  Bind("dump_trace", false, []() { Trace::Dump(); });
+  Bind("export", false, [this]() { StartExport(); });
+  Bind("backfill_chat", true, [this]() { BackfillChat(); });
+  Bind("filter_profile", true, [this]() { FilterProfile(); });
+
+  Bind("toggle_help", true, [this]() { m_View->SetHelpEnabled(!m_View->GetHelpEnabled()); ReinitView(); });
+  Bind("toggle_list", true, [this]() { m_View->SetListEnabled(!m_View->GetListEnabled()); ReinitView(); });
+  Bind("toggle_top", true, [this]() { m_View->SetTopEnabled(!m_View->GetTopEnabled()); ReinitView(); });
+  Bind("toggle_split_view", true, [this]()
+  {
+    m_View->SetSplitViewEnabled(!m_View->GetSplitViewEnabled());
     ReinitView();
-  }
-  else if (p_Key == keyToggleEmoji)
+  });
+  Bind("toggle_emoji", true, [this]()
   {
     m_View->SetEmojiEnabled(!m_View->GetEmojiEnabled());
     EntryConvertEmojiEnabled();
@@ -148,40 +182,16 @@ void UiModel::KeyHandler(wint_t p_Key)
     UpdateStatus();
     UpdateHistory();
     UpdateEntry();
-  }
-  else if (p_Key == keyNextChat)
-  {
-    NextChat();
-  }
-  else if (p_Key == keyPrevChat)
-  {
-    PrevChat();
-  }
-  else if (p_Key == keyUnreadChat)
-  {
-    UnreadChat();
-  }
-  else if (p_Key == keyPrevPage)
-  {
-    PrevPage();
-  }
-  else if (p_Key == keyNextPage)
-  {
-    NextPage();
-  }
-  else if (p_Key == keyHome)
-  {
-    Home();
-  }
-  else if (p_Key == keyEnd)
-  {
-    End();
-  }
-  else if (p_Key == keyQuit)
-  {
-    Quit();
-  }
-  else if (p_Key == keySendMsg)
+  });
+  Bind("next_chat", true, [this]() { NextChat(); });
+  Bind("prev_chat", true, [this]() { PrevChat(); });
+  Bind("unread_chat", true, [this]() { UnreadChat(); });
+  Bind("prev_page", true, [this]() { PrevPage(); });
+  Bind("next_page", true, [this]() { NextPage(); });
+  Bind("home", true, [this]() { Home(); });
+  Bind("end", true, [this]() { End(); });
+  Bind("quit", true, [this]() { Quit(); });
+  Bind("send_msg", true, [this]()
   {
     if (GetEditMessageActive())
     {
@@ -191,94 +201,43 @@ void UiModel::KeyHandler(wint_t p_Key)
     {
       SendMessage();
     }
-  }
-  else if (p_Key == keyExtEdit)
-  {
-    ExternalEdit();
-  }
-  else if (p_Key == keyDeleteMsg)
-  {
-    DeleteMessage();
-  }
-  else if (p_Key == keyDeleteChat)
-  {
-    DeleteChat();
-  }
-  else if (p_Key == keyOpen)
-  {
-    OpenMessageAttachment();
-  }
-  else if (p_Key == keyOpenLink)
-  {
-    OpenMessageLink();
-  }
-  else if (p_Key == keySave)
-  {
-    SaveMessageAttachment();
-  }
-  else if (p_Key == keyTransfer)
-  {
-    TransferFile();
-  }
-  else if (p_Key == keySelectEmoji)
-  {
-    InsertEmoji();
-  }
-  else if (p_Key == keySelectContact)
-  {
-    SearchContact();
-  }
-  else if (p_Key == keyOtherCommandsHelp)
-  {
-    SetHelpOffset(GetHelpOffset() + 1);
-    m_View->Draw();
-  }
-  else if (p_Key == keyCut)
-  {
-    Cut();
-  }
-  else if (p_Key == keyCopy)
-  {
-    Copy();
-  }
-  else if (p_Key == keyPaste)
-  {
-    Paste();
-  }
-  else if (p_Key == keySpell)
-  {
-    ExternalSpell();
-  }
-  else if (p_Key == keyEditMsg)
-  {
-    EditMessage();
-  }
-  else if ((p_Key == keyCancel) && GetEditMessageActive())
-  {
-    CancelEditMessage();
-  }
-  else if (p_Key == keyDecreaseListWidth)
-  {
-    m_View->DecreaseListWidth();
-    ReinitView();
-  }
-  else if (p_Key == keyIncreaseListWidth)
-  {
-    m_View->IncreaseListWidth();
-    ReinitView();
-  }
-  else if (p_Key == keyOpenMsg)
-  {
-    OpenMessage();
-  }
-  else if (p_Key == keyExtCall)
-  {
-    ExternalCall();
-  }
-  else
+  });
+  Bind("ext_edit", true, [this]() { ExternalEdit(); });
+  Bind("delete_msg", true, [this]() { DeleteMessage(); });
+  Bind("delete_chat", true, [this]() { DeleteChat(); });
+  Bind("open", true, [this]() { OpenMessageAttachment(); });
+  Bind("open_link", true, [this]() { OpenMessageLink(); });
+  Bind("save", true, [this]() { SaveMessageAttachment(); });
+  Bind("transfer", true, [this]() { TransferFile(); });
+  Bind("select_emoji", true, [this]() { InsertEmoji(); });
+  Bind("select_contact", true, [this]() { SearchContact(); });
+  Bind("search_msg", true, [this]() { SearchMessage(); });
+  Bind("find_msg", true, [this]() { FindMessage(); });
+  Bind("other_commands_help", true, [this]() { SetHelpOffset(GetHelpOffset() + 1); m_View->Draw(); });
+  Bind("cut", true, [this]() { Cut(); });
+  Bind("copy", true, [this]() { Copy(); });
+  Bind("paste", true, [this]() { Paste(); });
+  Bind("spell", true, [this]() { ExternalSpell(); });
+  Bind("edit_msg", true, [this]() { EditMessage(); });
+  const wint_t keyCancel = UiKeyConfig::GetKey("cancel");
+  Bind("cancel", true, [this, keyCancel]()
   {
-    EntryKeyHandler(p_Key);
-  }
+    if (GetEditMessageActive())
+    {
+      CancelEditMessage();
+    }
+    else
+    {
+      EntryKeyHandler(keyCancel);
+    }
+  });
+  Bind("decrease_list_width", true, [this]() { m_View->DecreaseListWidth(); ReinitView(); });
+  Bind("increase_list_width", true, [this]() { m_View->IncreaseListWidth(); ReinitView(); });
+  Bind("open_msg", true, [this]() { OpenMessage(); });
+  Bind("ext_call", true, [this]() { ExternalCall(); });
+  // *INDENT-ON*
+
+  InitEntryKeyBindings();
 }
 
 void UiModel::SendMessage()
@@ -287,8 +246,9 @@ void UiModel::SendMessage()
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
-  int& entryPos = m_EntryPos[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  std::wstring& entryStr = chatState.entryStr;
+  int& entryPos = chatState.entryPos;
 
   if (entryStr.empty()) return;
 
@@ -298,9 +258,9 @@ void UiModel::SendMessage()
 
   if (GetSelectMessageActive())
   {
-    const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-    const int messageOffset = m_MessageOffset[profileId][chatId];
-    const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+    const std::vector<std::string>& messageVec = chatState.messageVec;
+    const int messageOffset = chatState.messageOffset;
+    const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
 
     auto it = std::next(messageVec.begin(), messageOffset);
     if (it == messageVec.end())
@@ -316,14 +276,18 @@ void UiModel::SendMessage()
       return;
     }
 
-    sendMessageRequest->chatMessage.quotedId = msg->second.id;
-    sendMessageRequest->chatMessage.quotedText = msg->second.text;
-    sendMessageRequest->chatMessage.quotedSender = msg->second.senderId;
+    // messages not yet sent have no protocol id to quote
+    if (!IsOutboxMsgId(msg->second.id))
+    {
+      sendMessageRequest->chatMessage.quotedId = msg->second.id;
+      sendMessageRequest->chatMessage.quotedText = msg->second.text;
+      sendMessageRequest->chatMessage.quotedSender = msg->second.senderId;
+    }
 
     SetSelectMessageActive(false);
   }
 
-  SendProtocolRequest(profileId, sendMessageRequest);
+  QueueOutbox(profileId, chatId, sendMessageRequest->chatMessage);
 
   entryStr.clear();
   entryPos = 0;
@@ -337,313 +301,639 @@ void UiModel::EntryKeyHandler(wint_t p_Key)
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
 
-  static wint_t keyDown = UiKeyConfig::GetKey("down");
-  static wint_t keyUp = UiKeyConfig::GetKey("up");
-  static wint_t keyLeft = UiKeyConfig::GetKey("left");
-  static wint_t keyRight = UiKeyConfig::GetKey("right");
-  static wint_t keyBackspace = UiKeyConfig::GetKey("backspace");
-  static wint_t keyBackspaceAlt = UiKeyConfig::GetKey("backspace_alt");
-  static wint_t keyDelete = UiKeyConfig::GetKey("delete");
-  static wint_t keyDeleteLineAfterCursor = UiKeyConfig::GetKey("delete_line_after_cursor");
-  static wint_t keyDeleteLineBeforeCursor = UiKeyConfig::GetKey("delete_line_before_cursor");
-  static wint_t keyBeginLine = UiKeyConfig::GetKey("begin_line");
-  static wint_t keyEndLine = UiKeyConfig::GetKey("end_line");
-  static wint_t keyBackwardWord = UiKeyConfig::GetKey("backward_word");
-  static wint_t keyForwardWord = UiKeyConfig::GetKey("forward_word");
-  static wint_t keyBackwardKillWord = UiKeyConfig::GetKey("backward_kill_word");
-  static wint_t keyKillWord = UiKeyConfig::GetKey("kill_word");
-  static wint_t keyClear = UiKeyConfig::GetKey("clear");
-
-  std::string profileId = m_CurrentChat.first;
-  std::string chatId = m_CurrentChat.second;
-  int& entryPos = m_EntryPos[profileId][chatId];
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
-
-  const int messageCount = m_Messages[profileId][chatId].size();
-  int& messageOffset = m_MessageOffset[profileId][chatId];
+  const std::string profileId = m_CurrentChat.first;
+  const std::string chatId = m_CurrentChat.second;
+  ChatState& chatState = PeekChatState(profileId, chatId); // entry only, history is touched by up / down
 
-  if (p_Key == keyUp)
+  std::unordered_map<wint_t, EntryKeyBinding>::const_iterator it = m_EntryKeyBindings.find(p_Key);
+  if (it != m_EntryKeyBindings.end())
   {
-    if (GetSelectMessageActive() && !GetEditMessageActive())
-    {
-      messageOffset = std::min(messageOffset + 1, messageCount - 1);
-      RequestMessagesCurrentChat();
-    }
-    else
+    it->second(profileId, chatId, chatState);
+  }
+  else if (StrUtil::IsValidTextKey(p_Key))
+  {
+    int& entryPos = chatState.entryPos;
+    std::wstring& entryStr = chatState.entryStr;
+    entryStr.insert(entryPos++, 1, p_Key);
+    if (p_Key > 0xff)
     {
-      if ((entryPos == 0) && (messageCount > 0) && !GetEditMessageActive())
-      {
-        SetSelectMessageActive(true);
-      }
-      else
+      if (StrUtil::WStringWidth(std::wstring(1, p_Key)) > 1)
       {
-        int cx = 0;
-        int cy = 0;
-        int width = m_View->GetEntryWidth();
-        std::vector<std::wstring> lines =
-          StrUtil::WordWrap(entryStr, width, false, false, false, 2, entryPos, cy, cx);
-        if (cy > 0)
-        {
-          int stepsBack = 0;
-          int prevLineLen = lines.at(cy - 1).size();
-          if (prevLineLen > cx)
-          {
-            stepsBack = prevLineLen + 1;
-          }
-          else
-          {
-            stepsBack = cx + 1;
-          }
-
-          stepsBack = std::min(stepsBack, width);
-          entryPos = NumUtil::Bound(0, entryPos - stepsBack, (int)entryStr.size());
-
-          if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
-          {
-            entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
-          }
-        }
-        else
-        {
-          entryPos = 0;
-        }
+        entryStr.insert(entryPos++, std::wstring(1, (wchar_t)EMOJI_PAD));
       }
     }
 
-    UpdateHistory();
+    SetTyping(profileId, chatId, true);
+  }
+  else
+  {
+    return;
   }
-  else if (p_Key == keyDown)
+
+  UpdateEntry();
+}
+
+void UiModel::InitEntryKeyBindings()
+{
+  m_EntryKeyBindings.clear();
+  // *INDENT-OFF*
+  auto Bind = [this](const std::string& p_Param, const EntryKeyBinding& p_Handler)
   {
-    if (GetSelectMessageActive() && !GetEditMessageActive())
+    const int key = UiKeyConfig::GetKey(p_Param);
+    if (key < 0) return;
+
+    m_EntryKeyBindings.emplace((wint_t)key, p_Handler);
+  };
+
+  // edit handlers return whether entry text changed, marking user as typing
+  auto BindEdit = [this, Bind](const std::string& p_Param, const std::function<bool(std::wstring&, int&)>& p_Edit)
+  {
+    Bind(p_Param, [this, p_Edit](const std::string& p_ProfileId, const std::string& p_ChatId, ChatState& p_ChatState)
     {
-      if (messageOffset > 0)
-      {
-        messageOffset = messageOffset - 1;
-      }
-      else
+      if (p_Edit(p_ChatState.entryStr, p_ChatState.entryPos))
       {
-        SetSelectMessageActive(false);
+        SetTyping(p_ProfileId, p_ChatId, true);
       }
-    }
-    else
-    {
-      if (entryPos < (int)entryStr.size())
-      {
-        int cx = 0;
-        int cy = 0;
-        int width = m_View->GetEntryWidth();
-        std::vector<std::wstring> lines =
-          StrUtil::WordWrap(entryStr, width, false, false, false, 2, entryPos, cy, cx);
-
-        int stepsForward = (int)lines.at(cy).size() - cx + 1;
-        if ((cy + 1) < (int)lines.size())
-        {
-          if ((int)lines.at(cy + 1).size() > cx)
-          {
-            stepsForward += cx;
-          }
-          else
-          {
-            stepsForward += lines.at(cy + 1).size();
-          }
-        }
-
-        stepsForward = std::min(stepsForward, width);
-        entryPos = NumUtil::Bound(0, entryPos + stepsForward, (int)entryStr.size());
+    });
+  };
 
-        if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
-        {
-          entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
-        }
-      }
-    }
+  auto BindMove = [Bind](const std::string& p_Param, const std::function<void(std::wstring&, int&)>& p_Move)
+  {
+    Bind(p_Param, [p_Move](const std::string&, const std::string&, ChatState& p_ChatState)
+    {
+      p_Move(p_ChatState.entryStr, p_ChatState.entryPos);
+    });
+  };
 
-    UpdateHistory();
-  }
-  else if (p_Key == keyLeft)
+  Bind("up", [this](const std::string&, const std::string&, ChatState& p_ChatState) { EntryKeyUp(p_ChatState); });
+  Bind("down", [this](const std::string&, const std::string&, ChatState& p_ChatState) { EntryKeyDown(p_ChatState); });
+  BindMove("left", [](std::wstring& entryStr, int& entryPos)
   {
     entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
     if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
     {
       entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
     }
-  }
-  else if (p_Key == keyRight)
+  });
+  BindMove("right", [](std::wstring& entryStr, int& entryPos)
   {
     entryPos = NumUtil::Bound(0, entryPos + 1, (int)entryStr.size());
     if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
     {
       entryPos = NumUtil::Bound(0, entryPos + 1, (int)entryStr.size());
     }
-  }
-  else if ((p_Key == keyBackspace) || (p_Key == keyBackspaceAlt))
+  });
+  auto Backspace = [](std::wstring& entryStr, int& entryPos)
   {
-    if (entryPos > 0)
+    if (entryPos == 0) return false;
+
+    bool wasPad = (entryStr.at(entryPos - 1) == (wchar_t)EMOJI_PAD);
+    entryStr.erase(--entryPos, 1);
+    if (wasPad)
     {
-      bool wasPad = (entryStr.at(entryPos - 1) == (wchar_t)EMOJI_PAD);
       entryStr.erase(--entryPos, 1);
-      if (wasPad)
-      {
-        entryStr.erase(--entryPos, 1);
-      }
-      SetTyping(profileId, chatId, true);
     }
-  }
-  else if (p_Key == keyDelete)
+
+    return true;
+  };
+  BindEdit("backspace", Backspace);
+  BindEdit("backspace_alt", Backspace);
+  BindEdit("delete", [](std::wstring& entryStr, int& entryPos)
   {
-    if (entryPos < (int)entryStr.size())
+    if (entryPos >= (int)entryStr.size()) return false;
+
+    entryStr.erase(entryPos, 1);
+    if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
     {
       entryStr.erase(entryPos, 1);
-      if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
-      {
-        entryStr.erase(entryPos, 1);
-      }
-      SetTyping(profileId, chatId, true);
     }
-  }
-  else if (p_Key == keyDeleteLineAfterCursor)
+
+    return true;
+  });
+  BindEdit("delete_line_after_cursor", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::DeleteToNextMatch(entryStr, entryPos, 0, L"\n");
-    SetTyping(profileId, chatId, true);
-  }
-  else if (p_Key == keyDeleteLineBeforeCursor)
+    return true;
+  });
+  BindEdit("delete_line_before_cursor", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::DeleteToPrevMatch(entryStr, entryPos, -1, L"\n");
-    SetTyping(profileId, chatId, true);
-  }
-  else if (p_Key == keyBeginLine)
+    return true;
+  });
+  BindMove("begin_line", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::JumpToPrevMatch(entryStr, entryPos, -1, L"\n");
-  }
-  else if (p_Key == keyEndLine)
+  });
+  BindMove("end_line", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::JumpToNextMatch(entryStr, entryPos, 0, L"\n");
-  }
-  else if (p_Key == keyBackwardWord)
+  });
+  BindMove("backward_word", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::JumpToPrevMatch(entryStr, entryPos, -2, L" \n");
-  }
-  else if (p_Key == keyForwardWord)
+  });
+  BindMove("forward_word", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::JumpToNextMatch(entryStr, entryPos, 1, L" \n");
-  }
-  else if (p_Key == keyBackwardKillWord)
+  });
+  BindEdit("backward_kill_word", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::DeleteToPrevMatch(entryStr, entryPos, -1, L" \n");
-    SetTyping(profileId, chatId, true);
-  }
-  else if (p_Key == keyKillWord)
+    return true;
+  });
+  BindEdit("kill_word", [](std::wstring& entryStr, int& entryPos)
   {
     StrUtil::DeleteToNextMatch(entryStr, entryPos, 0, L" \n");
-    SetTyping(profileId, chatId, true);
-  }
-  else if (p_Key == keyClear)
+    return true;
+  });
+  BindEdit("clear", [](std::wstring& entryStr, int& entryPos)
   {
     entryStr.clear();
     entryPos = 0;
-    SetTyping(profileId, chatId, true);
-  }
-  else if (StrUtil::IsValidTextKey(p_Key))
-  {
-    entryStr.insert(entryPos++, 1, p_Key);
-    if (p_Key > 0xff)
-    {
-      if (StrUtil::WStringWidth(std::wstring(1, p_Key)) > 1)
-      {
-        entryStr.insert(entryPos++, std::wstring(1, (wchar_t)EMOJI_PAD));
-      }
-    }
-
-    SetTyping(profileId, chatId, true);
-  }
-  else
-  {
-    return;
-  }
-
-  UpdateEntry();
+    return true;
+  });
+  // *INDENT-ON*
 }
 
-void UiModel::SetTyping(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsTyping)
+void UiModel::EntryKeyUp(ChatState& p_ChatState)
 {
-  static const bool typingStatusShare = UiConfig::GetBool("typing_status_share");
-  if (!typingStatusShare) return;
-
-  static std::string lastProfileId;
-  static std::string lastChatId;
-  static bool lastIsTyping = false;
-  static int64_t lastTypeTime = 0;
-  static int64_t lastSendTime = 0;
+  TouchHistory(p_ChatState);
+  const int messageCount = p_ChatState.messages.size();
+  int& messageOffset = p_ChatState.messageOffset;
+  int& entryPos = p_ChatState.entryPos;
+  std::wstring& entryStr = p_ChatState.entryStr;
 
-  if (!p_IsTyping && !lastIsTyping)
+  if (GetSelectMessageActive() && !GetEditMessageActive())
   {
-    return;
+    messageOffset = std::min(messageOffset + 1, messageCount - 1);
+    RequestMessagesCurrentChat();
   }
+  else
+  {
+    if ((entryPos == 0) && (messageCount > 0) && !GetEditMessageActive())
+    {
+      SetSelectMessageActive(true);
+    }
+    else
+    {
+      int cx = 0;
+      int cy = 0;
+      int width = m_View->GetEntryWidth();
+      std::vector<std::wstring> lines =
+        StrUtil::WordWrap(entryStr, width, false, false, false, 2, entryPos, cy, cx);
+      if (cy > 0)
+      {
+        int stepsBack = 0;
+        int prevLineLen = lines.at(cy - 1).size();
+        if (prevLineLen > cx)
+        {
+          stepsBack = prevLineLen + 1;
+        }
+        else
+        {
+          stepsBack = cx + 1;
+        }
 
-  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
-  if (((nowTime - lastTypeTime) > 3000) && !p_IsTyping && lastIsTyping)
+        stepsBack = std::min(stepsBack, width);
+        entryPos = NumUtil::Bound(0, entryPos - stepsBack, (int)entryStr.size());
+
+        if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
+        {
+          entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
+        }
+      }
+      else
+      {
+        entryPos = 0;
+      }
+    }
+  }
+
+  UpdateHistory();
+}
+
+void UiModel::EntryKeyDown(ChatState& p_ChatState)
+{
+  TouchHistory(p_ChatState);
+  int& messageOffset = p_ChatState.messageOffset;
+  int& entryPos = p_ChatState.entryPos;
+  std::wstring& entryStr = p_ChatState.entryStr;
+
+  if (GetSelectMessageActive() && !GetEditMessageActive())
+  {
+    if (messageOffset > 0)
+    {
+      messageOffset = messageOffset - 1;
+    }
+    else
+    {
+      SetSelectMessageActive(false);
+    }
+  }
+  else
   {
-    LOG_TRACE("send stop typing %s", lastChatId.c_str());
+    if (entryPos < (int)entryStr.size())
+    {
+      int cx = 0;
+      int cy = 0;
+      int width = m_View->GetEntryWidth();
+      std::vector<std::wstring> lines =
+        StrUtil::WordWrap(entryStr, width, false, false, false, 2, entryPos, cy, cx);
+
+      int stepsForward = (int)lines.at(cy).size() - cx + 1;
+      if ((cy + 1) < (int)lines.size())
+      {
+        if ((int)lines.at(cy + 1).size() > cx)
+        {
+          stepsForward += cx;
+        }
+        else
+        {
+          stepsForward += lines.at(cy + 1).size();
+        }
+      }
 
-    std::shared_ptr<SendTypingRequest> sendTypingRequest = std::make_shared<SendTypingRequest>();
-    sendTypingRequest->chatId = lastChatId;
-    sendTypingRequest->isTyping = false;
-    SendProtocolRequest(lastProfileId, sendTypingRequest);
+      stepsForward = std::min(stepsForward, width);
+      entryPos = NumUtil::Bound(0, entryPos + stepsForward, (int)entryStr.size());
 
-    lastProfileId = "";
-    lastChatId = "";
-    lastIsTyping = false;
-    return;
+      if ((entryPos < (int)entryStr.size()) && (entryStr.at(entryPos) == (wchar_t)EMOJI_PAD))
+      {
+        entryPos = NumUtil::Bound(0, entryPos - 1, (int)entryStr.size());
+      }
+    }
   }
 
+  UpdateHistory();
+}
+
+void UiModel::SetTyping(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsTyping)
+{
+  const bool typingStatusShare = UiConfig::GetParams().typingStatusShare;
+  if (!typingStatusShare) return;
+
   if (p_IsTyping)
   {
-    if ((p_ProfileId == lastProfileId) && (p_ChatId == lastChatId) && (p_IsTyping == lastIsTyping))
+    // user types in one chat at a time, so typing elsewhere implies stopped
+    const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+    for (auto& profileTypingStates : m_TypingStates)
+    {
+      for (auto& typingState : profileTypingStates.second)
+      {
+        typingState.second.isTyping = false;
+      }
+    }
+
+    TypingState& typingState = m_TypingStates[p_ProfileId][p_ChatId];
+    typingState.isTyping = true;
+    typingState.typeTime = nowTime;
+  }
+
+  ProcessTyping();
+}
+
+void UiModel::ProcessTyping()
+{
+  // must be called with lock held
+  m_TypingTimeoutTime = 0;
+  if (m_TypingStates.empty()) return;
+
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  const int64_t idleTimeout = std::max(UiConfig::GetParams().typingIdleTimeout, 0);
+  const int64_t minInterval = std::max(UiConfig::GetParams().typingMinInterval, 0);
+  static const int64_t refreshInterval = 2500;
+  std::vector<int64_t> dueTimes;
+  for (auto pit = m_TypingStates.begin(); pit != m_TypingStates.end(); /* incremented in loop */)
+  {
+    const std::string& profileId = pit->first;
+    const bool hasTypingTimeout = HasProtocolFeature(profileId, FeatureTypingTimeout);
+    for (auto cit = pit->second.begin(); cit != pit->second.end(); /* incremented in loop */)
     {
-      if (HasProtocolFeature(p_ProfileId, FeatureTypingTimeout) && ((nowTime - lastSendTime) > 2500))
+      const std::string& chatId = cit->first;
+      TypingState& typingState = cit->second;
+      if (typingState.isTyping && ((nowTime - typingState.typeTime) > idleTimeout))
+      {
+        typingState.isTyping = false;
+      }
+
+      // at most one request is pending per chat, a start superseded by a stop before being sent is dropped
+      int64_t sendDueTime = typingState.sendTime + minInterval;
+      const bool isRefresh = typingState.isTyping && typingState.isTypingSent && hasTypingTimeout &&
+        ((nowTime - typingState.sendTime) > refreshInterval);
+      if ((typingState.isTyping != typingState.isTypingSent) || isRefresh)
+      {
+        if (nowTime >= sendDueTime)
+        {
+          LOG_TRACE("send typing %s %d%s", chatId.c_str(), typingState.isTyping, isRefresh ? " refresh" : "");
+
+          std::shared_ptr<SendTypingRequest> sendTypingRequest = std::make_shared<SendTypingRequest>();
+          sendTypingRequest->chatId = chatId;
+          sendTypingRequest->isTyping = typingState.isTyping;
+          SendProtocolRequest(profileId, sendTypingRequest);
+          typingState.isTypingSent = typingState.isTyping;
+          typingState.sendTime = nowTime;
+          sendDueTime = nowTime + minInterval;
+        }
+        else
+        {
+          dueTimes.push_back(sendDueTime);
+        }
+      }
+
+      // idle state is kept until the interval passed, so a following start is also limited
+      if (!typingState.isTyping && !typingState.isTypingSent && (nowTime >= sendDueTime))
       {
-        LOG_TRACE("send typing %s refresh", p_ChatId.c_str());
+        cit = pit->second.erase(cit);
+        continue;
+      }
 
-        std::shared_ptr<SendTypingRequest> sendTypingRequest = std::make_shared<SendTypingRequest>();
-        sendTypingRequest->chatId = p_ChatId;
-        sendTypingRequest->isTyping = true;
-        SendProtocolRequest(p_ProfileId, sendTypingRequest);
-        lastSendTime = nowTime;
+      if (!typingState.isTyping && !typingState.isTypingSent)
+      {
+        dueTimes.push_back(sendDueTime);
       }
-      else
+      else if (typingState.isTyping)
       {
-        LOG_TRACE("no typing update");
+        dueTimes.push_back(typingState.typeTime + idleTimeout + 1);
+        if (hasTypingTimeout)
+        {
+          dueTimes.push_back(typingState.sendTime + refreshInterval + 1);
+        }
       }
+
+      ++cit;
     }
-    else
+
+    pit = pit->second.empty() ? m_TypingStates.erase(pit) : std::next(pit);
+  }
+
+  if (!dueTimes.empty())
+  {
+    m_TypingTimeoutTime = *std::min_element(dueTimes.begin(), dueTimes.end()); // checked by Process()
+  }
+}
+
+void UiModel::QueueOutbox(const std::string& p_ProfileId, const std::string& p_ChatId,
+                          const ChatMessage& p_ChatMessage)
+{
+  // must be called with lock held
+  MessageCache::OutboxEntry outboxEntry;
+  outboxEntry.key = std::max(TimeUtil::GetCurrentTimeMSec() * 1000, m_OutboxLastKey + 1);
+  outboxEntry.chatId = p_ChatId;
+  outboxEntry.chatMessage = p_ChatMessage;
+  m_OutboxLastKey = outboxEntry.key;
+  if (!MessageCache::AddOutbox(p_ProfileId, outboxEntry))
+  {
+    LOG_DEBUG("outbox %s not persisted", p_ChatId.c_str());
+  }
+
+  m_OutboxStates[ChatKey(p_ProfileId, p_ChatId)].entries.push_back(outboxEntry);
+  AddOutboxMessage(p_ProfileId, outboxEntry);
+  ProcessOutbox();
+}
+
+void UiModel::LoadOutbox(const std::string& p_ProfileId)
+{
+  // must be called with lock held
+  if (!m_OutboxLoaded.insert(p_ProfileId).second)
+  {
+    // reconnected, drain all pending messages of the profile, also those given up on
+    for (auto& outboxState : m_OutboxStates)
     {
-      if (!lastProfileId.empty() && !lastChatId.empty() && lastIsTyping)
+      if (outboxState.first.first != p_ProfileId) continue;
+
+      outboxState.second.retryTime = 0;
+      ChatState& chatState = GetChatState(p_ProfileId, outboxState.first.second);
+      for (auto& outboxEntry : outboxState.second.entries)
       {
-        LOG_TRACE("send stop typing %s", lastChatId.c_str());
+        if (!outboxEntry.failed) continue;
+
+        outboxEntry.failed = false;
+        outboxEntry.attempts = 0;
+        MessageCache::UpdateOutbox(p_ProfileId, outboxEntry);
+        chatState.outboxFailed[GetOutboxMsgId(outboxEntry.key)] = false;
+      }
+    }
+  }
+  else
+  {
+    // messages left from previous run are resent
+    std::vector<MessageCache::OutboxEntry> outboxEntries = MessageCache::FetchOutbox(p_ProfileId);
+    for (auto& outboxEntry : outboxEntries)
+    {
+      outboxEntry.failed = false;
+      m_OutboxLastKey = std::max(m_OutboxLastKey, outboxEntry.key);
+      m_OutboxStates[ChatKey(p_ProfileId, outboxEntry.chatId)].entries.push_back(outboxEntry);
+      AddOutboxMessage(p_ProfileId, outboxEntry);
+    }
+
+    if (!outboxEntries.empty())
+    {
+      LOG_INFO("outbox %s resend %d", p_ProfileId.c_str(), (int)outboxEntries.size());
+    }
+  }
+
+  ProcessOutbox();
+}
+
+void UiModel::ProcessOutbox()
+{
+  // must be called with lock held, sends the oldest message per chat, so chats are sent in order
+  m_OutboxTimeoutTime = 0;
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  std::map<std::string, int> inFlightCounts;
+  for (const auto& outboxState : m_OutboxStates)
+  {
+    inFlightCounts[outboxState.first.first] += outboxState.second.inFlight ? 1 : 0;
+  }
 
-        std::shared_ptr<SendTypingRequest> sendTypingRequest = std::make_shared<SendTypingRequest>();
-        sendTypingRequest->chatId = lastChatId;
-        sendTypingRequest->isTyping = false;
-        SendProtocolRequest(lastProfileId, sendTypingRequest);
+  std::vector<int64_t> dueTimes;
+  for (auto it = m_OutboxStates.begin(); it != m_OutboxStates.end(); /* incremented in loop */)
+  {
+    const std::string& profileId = it->first.first;
+    const std::string& chatId = it->first.second;
+    OutboxState& outboxState = it->second;
+    if (outboxState.inFlight && ((nowTime - outboxState.sendTime) >= s_OutboxSendTimeoutMs))
+    {
+      LOG_WARNING("outbox %s send timeout", chatId.c_str());
+      CompleteOutbox(profileId, chatId, false);
+      --inFlightCounts[profileId];
+    }
+
+    if (outboxState.entries.empty())
+    {
+      it = m_OutboxStates.erase(it);
+      continue;
+    }
+
+    if (outboxState.inFlight)
+    {
+      dueTimes.push_back(outboxState.sendTime + s_OutboxSendTimeoutMs);
+    }
+    else if (!outboxState.entries.front().failed)
+    {
+      // a profile drains at most a batch of chats at a time, the next are sent as replies arrive
+      if (nowTime < outboxState.retryTime)
+      {
+        dueTimes.push_back(outboxState.retryTime);
+      }
+      else if (inFlightCounts[profileId] < s_OutboxBatchSize)
+      {
+        const MessageCache::OutboxEntry& outboxEntry = outboxState.entries.front();
+        LOG_TRACE("outbox %s send %lld attempt %d", chatId.c_str(), (long long)outboxEntry.key,
+                  outboxEntry.attempts);
+        std::shared_ptr<SendMessageRequest> sendMessageRequest = std::make_shared<SendMessageRequest>();
+        sendMessageRequest->chatId = chatId;
+        sendMessageRequest->chatMessage = outboxEntry.chatMessage;
+        SendProtocolRequest(profileId, sendMessageRequest);
+        outboxState.inFlight = true;
+        outboxState.sendTime = nowTime;
+        ++inFlightCounts[profileId];
+        dueTimes.push_back(outboxState.sendTime + s_OutboxSendTimeoutMs);
       }
+    }
+
+    ++it;
+  }
+
+  if (!dueTimes.empty())
+  {
+    m_OutboxTimeoutTime = *std::min_element(dueTimes.begin(), dueTimes.end()); // checked by Process()
+  }
+}
+
+void UiModel::CompleteOutbox(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_Success)
+{
+  // must be called with lock held, protocols reply to sends of a chat in order
+  auto it = m_OutboxStates.find(ChatKey(p_ProfileId, p_ChatId));
+  if ((it == m_OutboxStates.end()) || !it->second.inFlight || it->second.entries.empty()) return;
+
+  OutboxState& outboxState = it->second;
+  outboxState.inFlight = false;
+  MessageCache::OutboxEntry& outboxEntry = outboxState.entries.front();
+  const std::string msgId = GetOutboxMsgId(outboxEntry.key);
+  ChatState& chatState = GetChatState(p_ProfileId, p_ChatId);
+  if (p_Success)
+  {
+    // placeholder is replaced by the sent message, received from the protocol
+    MessageCache::RemoveOutbox(p_ProfileId, outboxEntry.key);
+    outboxState.entries.pop_front();
+    outboxState.retryTime = 0;
+    chatState.outboxFailed.erase(msgId);
+    DeleteMessages(p_ProfileId, p_ChatId, std::vector<std::string>({ msgId }));
+  }
+  else
+  {
+    // exponential backoff, given up on after max attempts until next reconnect
+    ++outboxEntry.attempts;
+    outboxEntry.failed = (outboxEntry.attempts >= s_OutboxMaxAttempts);
+    const int64_t retryMs = std::min<int64_t>(1000LL << std::min(outboxEntry.attempts, 16), s_OutboxRetryMaxMs);
+    outboxState.retryTime = TimeUtil::GetCurrentTimeMSec() + retryMs;
+    MessageCache::UpdateOutbox(p_ProfileId, outboxEntry);
+    chatState.outboxFailed[msgId] = outboxEntry.failed;
+    LOG_WARNING("outbox %s send failed attempt %d%s", p_ChatId.c_str(), outboxEntry.attempts,
+                outboxEntry.failed ? ", giving up" : "");
+  }
+
+  if ((p_ProfileId == m_CurrentChat.first) && (p_ChatId == m_CurrentChat.second))
+  {
+    UpdateHistory();
+  }
+  else if (IsHistoryPaneChat(p_ProfileId, p_ChatId))
+  {
+    m_View->SetHistoryDirty(true);
+  }
+}
+
+bool UiModel::CancelOutbox(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId)
+{
+  // must be called with lock held, returns true if message is an outbox message
+  if (!IsOutboxMsgId(p_MsgId)) return false;
+
+  auto it = m_OutboxStates.find(ChatKey(p_ProfileId, p_ChatId));
+  if (it == m_OutboxStates.end()) return true;
+
+  OutboxState& outboxState = it->second;
+  for (auto entryIt = outboxState.entries.begin(); entryIt != outboxState.entries.end(); ++entryIt)
+  {
+    if (GetOutboxMsgId(entryIt->key) != p_MsgId) continue;
+
+    if (outboxState.inFlight && (entryIt == outboxState.entries.begin()))
+    {
+      LOG_DEBUG("outbox %s cannot cancel in flight", p_ChatId.c_str());
+      return true;
+    }
 
-      LOG_TRACE("send typing %s", p_ChatId.c_str());
+    MessageCache::RemoveOutbox(p_ProfileId, entryIt->key);
+    outboxState.entries.erase(entryIt);
+    GetChatState(p_ProfileId, p_ChatId).outboxFailed.erase(p_MsgId);
+    DeleteMessages(p_ProfileId, p_ChatId, std::vector<std::string>({ p_MsgId }));
+    UpdateHistory();
+    ProcessOutbox();
+    break;
+  }
 
-      std::shared_ptr<SendTypingRequest> sendTypingRequest = std::make_shared<SendTypingRequest>();
-      sendTypingRequest->chatId = p_ChatId;
-      sendTypingRequest->isTyping = true;
-      SendProtocolRequest(p_ProfileId, sendTypingRequest);
-      lastSendTime = nowTime;
+  return true;
+}
 
-      lastProfileId = p_ProfileId;
-      lastChatId = p_ChatId;
-      lastIsTyping = p_IsTyping;
+void UiModel::AddOutboxMessage(const std::string& p_ProfileId, const MessageCache::OutboxEntry& p_OutboxEntry)
+{
+  // must be called with lock held, shows message as newest in chat until sent
+  const std::string& chatId = p_OutboxEntry.chatId;
+  ChatState& chatState = GetChatState(p_ProfileId, chatId);
+  std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  std::vector<std::string>& messageVec = chatState.messageVec;
+  ChatMessage chatMessage = p_OutboxEntry.chatMessage;
+  chatMessage.id = GetOutboxMsgId(p_OutboxEntry.key);
+  if (messages.count(chatMessage.id)) return;
+
+  for (const auto& contactInfo : m_ContactInfos[p_ProfileId])
+  {
+    if (contactInfo.second.isSelf)
+    {
+      chatMessage.senderId = contactInfo.first;
+      break;
     }
+  }
+
+  chatMessage.timeSent = std::numeric_limits<int64_t>::max();
+  chatMessage.sequence = p_OutboxEntry.key;
+  chatMessage.isOutgoing = true;
+  if (!chatMessage.fileInfo.empty())
+  {
+    // local file being sent
+    FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(chatMessage.fileInfo);
+    fileInfo.fileStatus = FileStatusDownloaded;
+    chatMessage.fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+  }
 
-    lastTypeTime = nowTime;
+  auto msgIt = messages.insert({ chatMessage.id, CompactMessage(chatMessage) }).first;
+  auto vecIt = messageVec.insert(FindMessageVecPos(messageVec, messages, msgIt->second), chatMessage.id);
+  int& messageOffset = chatState.messageOffset;
+  if ((messageOffset > 0) && ((vecIt - messageVec.begin()) <= messageOffset))
+  {
+    ++messageOffset; // keep viewed message in place
+  }
+
+  chatState.outboxFailed[chatMessage.id] = p_OutboxEntry.failed;
+  if ((p_ProfileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+  {
+    UpdateHistory();
+  }
+  else if (IsHistoryPaneChat(p_ProfileId, chatId))
+  {
+    m_View->SetHistoryDirty(true);
   }
 }
 
+std::string UiModel::GetOutboxMsgId(int64_t p_Key)
+{
+  return "outbox:" + std::to_string(p_Key);
+}
+
+bool UiModel::IsOutboxMsgId(const std::string& p_MsgId)
+{
+  return (p_MsgId.rfind("outbox:", 0) == 0);
+}
+
 void UiModel::NextChat()
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
@@ -690,43 +980,40 @@ void UiModel::UnreadChat()
 
   if (m_ChatVec.empty()) return;
 
-  std::vector<int> unreadVec;
+  // go to first unread chat in list order, or the one after current if it is unread
+  int firstUnreadIndex = -1;
+  int nextUnreadIndex = -1;
   bool unreadIsSelected = false;
-
-  for (size_t i = 0; i < m_ChatVec.size(); ++i)
+  for (const auto& chat : m_UnreadChats)
   {
-    const std::pair<std::string, std::string>& chat = m_ChatVec.at(i);
-    const ChatInfo& chatInfo = m_ChatInfos[chat.first][chat.second];
-    if (chatInfo.isUnread)
+    const int index = FindChatIndex(chat);
+    if (index == -1) continue;
+
+    if ((firstUnreadIndex == -1) || (index < firstUnreadIndex))
     {
-      unreadVec.push_back(i);
-      if (m_CurrentChatIndex == (int)i)
-      {
-        unreadIsSelected = true;
-      }
+      firstUnreadIndex = index;
+    }
+
+    if ((index > m_CurrentChatIndex) && ((nextUnreadIndex == -1) || (index < nextUnreadIndex)))
+    {
+      nextUnreadIndex = index;
+    }
+
+    if (index == m_CurrentChatIndex)
+    {
+      unreadIsSelected = true;
     }
   }
 
-  if (!unreadVec.empty())
+  if (firstUnreadIndex != -1)
   {
-    if (!unreadIsSelected)
+    if (!unreadIsSelected || (nextUnreadIndex == -1))
     {
-      m_CurrentChatIndex = unreadVec.at(0);
+      m_CurrentChatIndex = firstUnreadIndex;
     }
-    else if (unreadVec.size() > 1)
+    else
     {
-      auto it = std::find(unreadVec.begin(), unreadVec.end(), m_CurrentChatIndex);
-      if (it != unreadVec.end())
-      {
-        size_t idx = std::distance(unreadVec.begin(), it);
-        ++idx;
-        if (idx >= unreadVec.size())
-        {
-          idx = 0;
-        }
-
-        m_CurrentChatIndex = unreadVec.at(idx);
-      }
+      m_CurrentChatIndex = nextUnreadIndex;
     }
 
     m_CurrentChat = m_ChatVec.at(m_CurrentChatIndex);
@@ -745,16 +1032,16 @@ void UiModel::PrevPage()
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
 
-  const int messageCount = m_Messages[profileId][chatId].size();
-  int& messageOffset = m_MessageOffset[profileId][chatId];
-  std::stack<int>& messageOffsetStack = m_MessageOffsetStack[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const int messageCount = chatState.messages.size();
+  const int messageOffset = chatState.messageOffset;
 
   int addOffset = std::min(historyShowCount, std::max(messageCount - messageOffset - 1, 0));
   LOG_TRACE("count %d offset %d addoffset %d", messageCount, messageOffset, addOffset);
   if (addOffset > 0)
   {
-    messageOffsetStack.push(addOffset);
-    messageOffset += addOffset;
+    AddMessageOffset(chatState, addOffset, addOffset);
+    StartInputLatency(PerfStats::StatInputPageUpUs);
     RequestMessagesCurrentChat();
     UpdateHistory();
   }
@@ -771,23 +1058,26 @@ void UiModel::NextPage()
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
 
-  int& messageOffset = m_MessageOffset[profileId][chatId];
-  std::stack<int>& messageOffsetStack = m_MessageOffsetStack[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  int& messageOffset = chatState.messageOffset;
+  std::stack<std::string>& messageOffsetStack = chatState.messageOffsetStack;
 
-  int decOffset = 0;
-  if (!messageOffsetStack.empty())
+  // return to newest previous page anchor still loaded, or bottom if none remains
+  int newOffset = 0;
+  while (!messageOffsetStack.empty())
   {
-    decOffset = messageOffsetStack.top();
+    const int index = FindMessageIndex(chatState, messageOffsetStack.top());
     messageOffsetStack.pop();
-  }
-  else if (messageOffset > 0)
-  {
-    decOffset = messageOffset;
+    if ((index != -1) && (index < messageOffset))
+    {
+      newOffset = index;
+      break;
+    }
   }
 
-  if (decOffset > 0)
+  if (messageOffset > 0)
   {
-    messageOffset -= decOffset;
+    messageOffset = newOffset;
     UpdateHistory();
   }
   else
@@ -804,7 +1094,7 @@ void UiModel::Home()
 
   if (GetEditMessageActive()) return;
 
-  static const bool homeFetchAll = UiConfig::GetBool("home_fetch_all");
+  const bool homeFetchAll = UiConfig::GetParams().homeFetchAll;
   if (homeFetchAll)
   {
     m_HomeFetchAll = true;
@@ -814,7 +1104,8 @@ void UiModel::Home()
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
 
-  bool& fetchedAllCache = m_FetchedAllCache[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  bool& fetchedAllCache = chatState.fetchedAllCache;
   if (!fetchedAllCache)
   {
     fetchedAllCache = true;
@@ -830,23 +1121,18 @@ void UiModel::Home()
     SendProtocolRequest(m_CurrentChat.first, getMessagesRequest);
     TimeUtil::Sleep(0.2); // @todo: wait for request completion, with timeout
     lock.lock();
+    HandleServiceMessages();
     fetchedAllCache = true;
   }
 
-  const int messageCount = m_Messages[profileId][chatId].size();
-  int& messageOffset = m_MessageOffset[profileId][chatId];
-  std::stack<int>& messageOffsetStack = m_MessageOffsetStack[profileId][chatId];
+  const int messageCount = chatState.messages.size();
+  const int messageOffset = chatState.messageOffset;
 
   int addOffset = std::max(messageCount - messageOffset - 1, 0);
   LOG_TRACE("count %d offset %d addoffset %d", messageCount, messageOffset, addOffset);
   if (addOffset > 0)
   {
-    for (int i = 0; i < addOffset; ++i)
-    {
-      messageOffsetStack.push(1); // @todo: consider building a nicer stack for page down from home
-    }
-
-    messageOffset += addOffset;
+    AddMessageOffset(chatState, addOffset, m_View->GetHistoryShowCount());
     RequestMessagesCurrentChat();
     UpdateHistory();
   }
@@ -862,9 +1148,9 @@ void UiModel::HomeFetchNext(const std::string& p_ProfileId, const std::string& p
     {
       if (p_MsgCount > 0)
       {
-        const int messageCount = m_Messages[p_ProfileId][p_ChatId].size();
-        int& messageOffset = m_MessageOffset[p_ProfileId][p_ChatId];
-        std::stack<int>& messageOffsetStack = m_MessageOffsetStack[p_ProfileId][p_ChatId];
+        ChatState& chatState = GetChatState(p_ProfileId, p_ChatId);
+        const int messageCount = chatState.messages.size();
+        const int& messageOffset = chatState.messageOffset;
 
         if ((p_MsgCount == 1) && ((messageCount % 8) != 0))
         {
@@ -875,12 +1161,7 @@ void UiModel::HomeFetchNext(const std::string& p_ProfileId, const std::string& p
         int addOffset = std::max(messageCount - messageOffset - 1, 0);
         if (addOffset > 0)
         {
-          for (int i = 0; i < addOffset; ++i)
-          {
-            messageOffsetStack.push(1);
-          }
-
-          messageOffset += addOffset;
+          AddMessageOffset(chatState, addOffset, m_View->GetHistoryShowCount());
         }
 
         LOG_TRACE("home fetch offset + %d = %d", addOffset, messageOffset);
@@ -914,8 +1195,9 @@ void UiModel::ResetMessageOffset()
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
 
-  int& messageOffset = m_MessageOffset[profileId][chatId];
-  std::stack<int>& messageOffsetStack = m_MessageOffsetStack[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  int& messageOffset = chatState.messageOffset;
+  std::stack<std::string>& messageOffsetStack = chatState.messageOffsetStack;
 
   messageOffset = 0;
   while (!messageOffsetStack.empty())
@@ -928,24 +1210,36 @@ void UiModel::ResetMessageOffset()
 
 void UiModel::MarkRead(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId)
 {
-  static const bool markReadOnView = UiConfig::GetBool("mark_read_on_view");
+  const bool markReadOnView = UiConfig::GetParams().markReadOnView;
   if (!markReadOnView && !m_HistoryInteraction) return;
 
-  static const bool markReadWhenInactive = UiConfig::GetBool("mark_read_when_inactive");
+  const bool markReadWhenInactive = UiConfig::GetParams().markReadWhenInactive;
   if (!(m_TerminalActive || markReadWhenInactive)) return;
 
-  std::shared_ptr<MarkMessageReadRequest> markMessageReadRequest = std::make_shared<MarkMessageReadRequest>();
-  markMessageReadRequest->chatId = p_ChatId;
-  markMessageReadRequest->msgId = p_MsgId;
-  SendProtocolRequest(p_ProfileId, markMessageReadRequest);
-
-  std::unordered_map<std::string, ChatMessage>& messages = m_Messages[p_ProfileId][p_ChatId];
+  // marked read locally right away, the protocol request is sent by FlushMarkRead
+  ChatState& chatState = GetChatState(p_ProfileId, p_ChatId);
+  std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
   auto mit = messages.find(p_MsgId);
   if (mit != messages.end())
   {
     mit->second.isRead = true;
   }
 
+  chatState.markReadMsgIds.push_back(p_MsgId);
+}
+
+void UiModel::FlushMarkRead(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  std::vector<std::string>& markReadMsgIds = PeekChatState(p_ProfileId, p_ChatId).markReadMsgIds;
+  if (markReadMsgIds.empty()) return;
+
+  // one request marks all visible messages, with the newest as high-watermark
+  std::shared_ptr<MarkMessagesReadRequest> markMessagesReadRequest = std::make_shared<MarkMessagesReadRequest>();
+  markMessagesReadRequest->chatId = p_ChatId;
+  markMessagesReadRequest->msgId = markReadMsgIds.front();
+  markMessagesReadRequest->msgIds.swap(markReadMsgIds);
+  SendProtocolRequest(p_ProfileId, markMessagesReadRequest);
+
   UpdateChatInfoIsUnread(p_ProfileId, p_ChatId);
 
   UpdateList();
@@ -953,7 +1247,8 @@ void UiModel::MarkRead(const std::string& p_ProfileId, const std::string& p_Chat
 
 void UiModel::DownloadAttachment(const std::string& p_ProfileId, const std::string& p_ChatId,
                                  const std::string& p_MsgId, const std::string& p_FileId,
-                                 DownloadFileAction p_DownloadFileAction)
+                                 DownloadFileAction p_DownloadFileAction,
+                                 DownloadFilePriority p_DownloadFilePriority)
 {
   // must be called with lock held
   std::shared_ptr<DownloadFileRequest> downloadFileRequest = std::make_shared<DownloadFileRequest>();
@@ -961,10 +1256,11 @@ void UiModel::DownloadAttachment(const std::string& p_ProfileId, const std::stri
   downloadFileRequest->msgId = p_MsgId;
   downloadFileRequest->fileId = p_FileId;
   downloadFileRequest->downloadFileAction = p_DownloadFileAction;
+  downloadFileRequest->downloadFilePriority = p_DownloadFilePriority;
 
   SendProtocolRequest(p_ProfileId, downloadFileRequest);
 
-  std::unordered_map<std::string, ChatMessage>& messages = m_Messages[p_ProfileId][p_ChatId];
+  std::unordered_map<std::string, CompactMessage>& messages = GetChatState(p_ProfileId, p_ChatId).messages;
   auto mit = messages.find(p_MsgId);
   if (mit == messages.end()) return;
 
@@ -985,7 +1281,7 @@ void UiModel::DeleteMessage()
 
   if (!GetSelectMessageActive() || GetEditMessageActive()) return;
 
-  static const bool confirmDeletion = UiConfig::GetBool("confirm_deletion");
+  const bool confirmDeletion = UiConfig::GetParams().confirmDeletion;
   if (confirmDeletion)
   {
     if (!MessageDialog("Confirmation", "Confirm message deletion?", 0.5, 5))
@@ -996,8 +1292,9 @@ void UiModel::DeleteMessage()
 
   const std::string& profileId = m_CurrentChat.first;
   const std::string& chatId = m_CurrentChat.second;
-  const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-  int& messageOffset = m_MessageOffset[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  int& messageOffset = chatState.messageOffset;
 
   auto it = std::next(messageVec.begin(), messageOffset);
   if (it == messageVec.end())
@@ -1008,7 +1305,9 @@ void UiModel::DeleteMessage()
 
   std::string senderId;
   const std::string msgId = *it;
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+  if (CancelOutbox(profileId, chatId, msgId)) return;
+
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
   auto mit = messages.find(msgId);
   if (mit != messages.end())
   {
@@ -1032,7 +1331,7 @@ void UiModel::DeleteChat()
 
   if (GetEditMessageActive()) return;
 
-  static const bool confirmDeletion = UiConfig::GetBool("confirm_deletion");
+  const bool confirmDeletion = UiConfig::GetParams().confirmDeletion;
   if (confirmDeletion)
   {
     if (!MessageDialog("Confirmation", "Confirm chat deletion?", 0.5, 5))
@@ -1068,14 +1367,15 @@ void UiModel::OpenMessage()
 
   const std::string profileId = m_CurrentChat.first;
   const std::string chatId = m_CurrentChat.second;
-  const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-  const int messageOffset = m_MessageOffset[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int messageOffset = chatState.messageOffset;
   auto it = std::next(messageVec.begin(), messageOffset);
   if (it == messageVec.end()) return;
 
   const std::string messageId = *it;
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
-  const ChatMessage& chatMessage = messages.at(messageId);
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  const CompactMessage& chatMessage = messages.at(messageId);
 
   endwin();
   std::string tempPath = FileUtil::GetApplicationDir() + "/tmpview.txt";
@@ -1102,7 +1402,8 @@ void UiModel::OpenMessage()
   }
 }
 
-bool UiModel::GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileAction p_DownloadFileAction)
+bool UiModel::GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileAction p_DownloadFileAction,
+                                       std::string* p_PreviewPath /*= nullptr*/)
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
 
@@ -1110,9 +1411,10 @@ bool UiModel::GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileActi
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-  const int messageOffset = m_MessageOffset[profileId][chatId];
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int messageOffset = chatState.messageOffset;
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
 
   auto it = std::next(messageVec.begin(), messageOffset);
   if (it == messageVec.end())
@@ -1138,14 +1440,19 @@ bool UiModel::GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileActi
   FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(mit->second.fileInfo);
   if (UiModel::IsAttachmentDownloaded(fileInfo))
   {
+    MessageCache::AccessAttachment(profileId, chatId, fileInfo.filePath);
     p_FilePath = fileInfo.filePath;
     return true;
   }
   else if (UiModel::IsAttachmentDownloadable(fileInfo))
   {
-    DownloadAttachment(profileId, chatId, msgId, fileInfo.fileId, p_DownloadFileAction);
+    DownloadAttachment(profileId, chatId, msgId, fileInfo.fileId, p_DownloadFileAction, DownloadFilePriorityUser);
     UpdateHistory();
     LOG_DEBUG("message attachment %s download started", fileInfo.fileId.c_str());
+    if (p_PreviewPath != nullptr)
+    {
+      *p_PreviewPath = PreviewStore::GetPath(profileId, fileInfo.fileId);
+    }
   }
 
   return false;
@@ -1155,8 +1462,17 @@ void UiModel::OpenMessageAttachment(std::string p_FilePath /*= std::string()*/)
 {
   if (p_FilePath.empty())
   {
-    // user-triggered call
-    if (!GetMessageAttachmentPath(p_FilePath, DownloadFileActionOpen)) return;
+    // user-triggered call, preview is shown if available while the full file downloads
+    std::string previewPath;
+    if (!GetMessageAttachmentPath(p_FilePath, DownloadFileActionOpen, &previewPath))
+    {
+      if (!previewPath.empty())
+      {
+        OpenAttachmentPreview(previewPath);
+      }
+
+      return;
+    }
   }
   else
   {
@@ -1213,15 +1529,29 @@ void UiModel::OpenAttachment(const std::string& p_Path)
   RunCommand(cmd);
 }
 
+void UiModel::OpenAttachmentPreview(const std::string& p_Path)
+{
+  static const std::string cmdTemplate = UiConfig::GetStr("attachment_preview_command");
+  if (cmdTemplate.empty()) return;
+
+  std::string cmd = cmdTemplate;
+  StrUtil::ReplaceString(cmd, "%1", p_Path);
+
+  RunCommand(cmd);
+}
+
 void UiModel::RunCommand(const std::string& p_Cmd)
 {
   bool isBackground = (p_Cmd.back() == '&');
-
-  if (!isBackground)
+  if (isBackground)
   {
-    endwin();
+    // background commands are run by the launcher, so the caller does not wait for the shell
+    m_ProcessLauncher.Launch(p_Cmd);
+    return;
   }
 
+  endwin();
+
   // run command
   LOG_TRACE("cmd \"%s\" start", p_Cmd.c_str());
   int rv = system(p_Cmd.c_str());
@@ -1230,14 +1560,11 @@ void UiModel::RunCommand(const std::string& p_Cmd)
     LOG_WARNING("cmd \"%s\" failed (%d)", p_Cmd.c_str(), rv);
   }
 
-  if (!isBackground)
+  refresh();
+  wint_t key = 0;
+  while (UiKeyInput::GetWch(&key) != ERR)
   {
-    refresh();
-    wint_t key = 0;
-    while (UiKeyInput::GetWch(&key) != ERR)
-    {
-      // Discard any remaining input
-    }
+    // Discard any remaining input
   }
 }
 
@@ -1249,9 +1576,10 @@ void UiModel::OpenMessageLink()
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-  const int messageOffset = m_MessageOffset[profileId][chatId];
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int messageOffset = chatState.messageOffset;
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
 
   auto it = std::next(messageVec.begin(), messageOffset);
   if (it == messageVec.end())
@@ -1393,16 +1721,13 @@ void UiModel::TransferFile()
 
     for (const auto& filePath : filePaths)
     {
+      // mime type is left to the protocol, which detects it off the ui thread when sending
       FileInfo fileInfo;
       fileInfo.filePath = filePath;
-      fileInfo.fileType = FileUtil::GetMimeType(filePath);
 
-      std::shared_ptr<SendMessageRequest> sendMessageRequest =
-        std::make_shared<SendMessageRequest>();
-      sendMessageRequest->chatId = chatId;
-      sendMessageRequest->chatMessage.fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
-
-      SendProtocolRequest(profileId, sendMessageRequest);
+      ChatMessage chatMessage;
+      chatMessage.fileInfo = ProtocolUtil::FileInfoToHex(fileInfo);
+      QueueOutbox(profileId, chatId, chatMessage);
     }
   }
 
@@ -1424,8 +1749,9 @@ void UiModel::InsertEmoji()
 
     std::string profileId = m_CurrentChat.first;
     std::string chatId = m_CurrentChat.second;
-    int& entryPos = m_EntryPos[profileId][chatId];
-    std::wstring& entryStr = m_EntryStr[profileId][chatId];
+    ChatState& chatState = GetChatState(profileId, chatId);
+    int& entryPos = chatState.entryPos;
+    std::wstring& entryStr = chatState.entryStr;
 
     entryStr.insert(entryPos, emoji);
     entryPos += emoji.size();
@@ -1464,10 +1790,10 @@ void UiModel::SearchContact()
     std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[profileId];
     if (profileChatInfos.count(userId))
     {
-      m_CurrentChatIndex = 0;
+      ListChatVecProfile(profileId);
       m_CurrentChat.first = profileId;
       m_CurrentChat.second = userId;
-      SortChats();
+      m_CurrentChatIndex = std::max(FindChatIndex(m_CurrentChat), 0);
       OnCurrentChatChanged();
       SetSelectMessageActive(false);
     }
@@ -1483,39 +1809,345 @@ void UiModel::SearchContact()
   ReinitView();
 }
 
-void UiModel::FetchCachedMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
-                                 const std::string& p_MsgId)
+void UiModel::SearchMessage()
 {
-  // must be called with lock held
-  static std::map<std::string, std::map<std::string, std::set<std::string>>> fetchedCache;
-  std::set<std::string>& msgIdFetchedCache = fetchedCache[p_ProfileId][p_ChatId];
-  if (msgIdFetchedCache.find(p_MsgId) != msgIdFetchedCache.end())
   {
-    return;
+    std::unique_lock<std::mutex> lock(m_ModelMutex);
+    if (GetEditMessageActive()) return;
+  }
+
+  UiDialogParams params(m_View.get(), this, "Search Messages", 0.75, 0.65);
+  UiSearchListDialog dialog(params);
+  if (dialog.Run())
+  {
+    std::pair<std::string, std::pair<std::string, ChatMessage>> selectedMessage = dialog.GetSelectedMessage();
+    std::string profileId = selectedMessage.first;
+    std::string chatId = selectedMessage.second.first;
+
+    LOG_INFO("selected %s message %s in %s", profileId.c_str(), selectedMessage.second.second.id.c_str(),
+             chatId.c_str());
+
+    std::unique_lock<std::mutex> lock(m_ModelMutex);
+    std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[profileId];
+    if (profileChatInfos.count(chatId))
+    {
+      ListChatVecProfile(profileId);
+      m_CurrentChat.first = profileId;
+      m_CurrentChat.second = chatId;
+      m_CurrentChatIndex = std::max(FindChatIndex(m_CurrentChat), 0);
+      OnCurrentChatChanged();
+      SetSelectMessageActive(false);
+    }
+    else
+    {
+      LOG_WARNING("chat %s not found", chatId.c_str());
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_ModelMutex);
+    m_SearchQuery.clear();
+    m_SearchResults.clear();
+    CancelSearchRequests();
+  }
+
+  ReinitView();
+}
+
+void UiModel::FindMessage()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+
+  if (GetEditMessageActive() || m_CurrentChat.second.empty()) return;
+
+  const ChatState& chatState = GetChatState(m_CurrentChat.first, m_CurrentChat.second);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int messageOffset = chatState.messageOffset;
+  m_FindActive = true;
+  m_FindChat = m_CurrentChat;
+  m_FindOriginId = (messageOffset < (int)messageVec.size()) ? messageVec[messageOffset] : "";
+  SetHelpOffset(0);
+  UpdateEntry();
+}
+
+bool UiModel::FindKeyHandler(wint_t p_Key)
+{
+  // find takes query and match navigation keys, any other key ends it and is then handled as usual
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+
+  if ((p_Key == (wint_t)UiKeyConfig::GetKey("find_msg")) || (p_Key == (wint_t)UiKeyConfig::GetKey("up")) ||
+      (p_Key == (wint_t)UiKeyConfig::GetKey("return")))
+  {
+    FindNext(true /* p_Older */);
+  }
+  else if (p_Key == (wint_t)UiKeyConfig::GetKey("down"))
+  {
+    FindNext(false /* p_Older */);
+  }
+  else if ((p_Key == (wint_t)UiKeyConfig::GetKey("backspace")) ||
+           (p_Key == (wint_t)UiKeyConfig::GetKey("backspace_alt")))
+  {
+    if (!m_FindQuery.empty())
+    {
+      SetFindQuery(m_FindQuery.substr(0, m_FindQuery.size() - 1));
+    }
+  }
+  else if (p_Key == (wint_t)UiKeyConfig::GetKey("cancel"))
+  {
+    StopFind();
+  }
+  else if ((p_Key != 0xA) && StrUtil::IsValidTextKey(p_Key) && !m_KeyBindings.count(p_Key) &&
+           !m_EntryKeyBindings.count(p_Key))
+  {
+    SetFindQuery(m_FindQuery + std::wstring(1, p_Key));
+  }
+  else
+  {
+    StopFind();
+    return false;
+  }
+
+  return true;
+}
+
+void UiModel::SetFindQuery(const std::wstring& p_Query)
+{
+  std::string lowerQuery = StrUtil::ToString(p_Query);
+  StrUtil::ToLowerInPlace(lowerQuery);
+
+  // a grown query only narrows the matches of the previous one, so only those are checked again
+  const bool isRefine = !m_FindLowerQuery.empty() &&
+    (lowerQuery.compare(0, m_FindLowerQuery.size(), m_FindLowerQuery) == 0);
+  m_FindQuery = p_Query;
+  m_FindLowerQuery = lowerQuery;
+  m_FindOlderPending = false;
+
+  ChatState& chatState = GetChatState(m_FindChat.first, m_FindChat.second);
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  if (isRefine)
+  {
+    for (auto it = m_FindMatchIds.begin(); it != m_FindMatchIds.end(); /* incremented in loop */)
+    {
+      auto msgIt = messages.find(*it);
+      if ((msgIt == messages.end()) || !IsFindMatch(msgIt->second))
+      {
+        it = m_FindMatchIds.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+  else
+  {
+    m_FindMatchIds.clear();
+    if (!m_FindLowerQuery.empty())
+    {
+      for (const auto& message : messages)
+      {
+        if (IsFindMatch(message.second))
+        {
+          m_FindMatchIds.insert(message.first);
+        }
+      }
+    }
+  }
+
+  // show nearest match at or above the message in view when find started, or that message if none
+  const int originIndex = std::max(FindMessageIndex(chatState, m_FindOriginId), 0);
+  chatState.messageOffset = originIndex;
+  if (!m_FindLowerQuery.empty())
+  {
+    FindFrom(originIndex, true /* p_Older */);
+  }
+
+  UpdateEntry();
+  UpdateHistory();
+}
+
+bool UiModel::IsFindMatch(const CompactMessage& p_ChatMessage)
+{
+  return !m_FindLowerQuery.empty() &&
+         (StrUtil::FindIgnoreCase(p_ChatMessage.text, m_FindLowerQuery) != std::string::npos);
+}
+
+void UiModel::UpdateFindMatch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                              const CompactMessage& p_ChatMessage)
+{
+  if (!m_FindActive || (p_ProfileId != m_FindChat.first) || (p_ChatId != m_FindChat.second)) return;
+
+  if (IsFindMatch(p_ChatMessage))
+  {
+    m_FindMatchIds.insert(p_ChatMessage.id);
   }
   else
   {
-    std::shared_ptr<GetMessageRequest> getMessageRequest = std::make_shared<GetMessageRequest>();
-    getMessageRequest->chatId = p_ChatId;
-    getMessageRequest->msgId = p_MsgId;
-    getMessageRequest->cached = true;
-    LOG_TRACE("request message %s in %s", p_MsgId.c_str(), p_ChatId.c_str());
-    SendProtocolRequest(p_ProfileId, getMessageRequest);
+    m_FindMatchIds.erase(p_ChatMessage.id);
+  }
+}
+
+void UiModel::FindNext(bool p_Older)
+{
+  if (m_FindLowerQuery.empty()) return;
+
+  const ChatState& chatState = GetChatState(m_FindChat.first, m_FindChat.second);
+  FindFrom(chatState.messageOffset + (p_Older ? 1 : -1), p_Older);
+}
+
+bool UiModel::FindFrom(int p_Index, bool p_Older)
+{
+  ChatState& chatState = GetChatState(m_FindChat.first, m_FindChat.second);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int step = p_Older ? 1 : -1;
+  for (int index = p_Index; (index >= 0) && (index < (int)messageVec.size()); index += step)
+  {
+    if (!m_FindMatchIds.count(messageVec[index])) continue;
+
+    chatState.messageOffset = index;
+    m_FindOlderPending = false;
+    SetSelectMessageActive(true);
+    UpdateHistory();
+    return true;
+  }
+
+  if (p_Older)
+  {
+    // older history is loaded in the background, and the find continues as its pages arrive
+    m_FindOlderPending = true;
+    const int loadedOlderCount = std::max((int)messageVec.size() - chatState.messageOffset, 0);
+    RequestMessages(m_FindChat.first, m_FindChat.second, loadedOlderCount);
+    UpdateEntry();
+  }
+
+  return false;
+}
+
+void UiModel::StopFind()
+{
+  if (!m_FindActive) return;
+
+  m_FindActive = false;
+  m_FindChat = s_ChatNone;
+  m_FindQuery.clear();
+  m_FindLowerQuery.clear();
+  m_FindMatchIds.clear();
+  m_FindOriginId.clear();
+  m_FindOlderPending = false;
+  SetHelpOffset(0);
+  UpdateEntry();
+  UpdateHistory();
+}
+
+void UiModel::FetchCachedMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                 const std::string& p_MsgId)
+{
+  // must be called with lock held, fetches are batched per chat and issued after draw. messages not
+  // found, e.g. quotes of deleted messages, are requested again at most once per retry interval
+  const std::tuple<std::string, std::string, std::string> key(p_ProfileId, p_ChatId, p_MsgId);
+  if (!m_FetchedMessageIds.TryBegin(key, TimeUtil::GetCurrentTimeMSec())) return;
+
+  m_PendingMessageFetches[ChatKey(p_ProfileId, p_ChatId)].push_back(p_MsgId);
+}
+
+void UiModel::FlushCachedMessageFetches()
+{
+  // must be called with lock held, resolves cached messages in one query and fetches only misses from protocol
+  for (const auto& pendingMessageFetch : m_PendingMessageFetches)
+  {
+    const std::string& profileId = pendingMessageFetch.first.first;
+    const std::string& chatId = pendingMessageFetch.first.second;
+    const std::vector<std::string>& msgIds = pendingMessageFetch.second;
 
-    msgIdFetchedCache.insert(p_MsgId);
+    std::vector<std::string> missingMsgIds;
+    const bool cacheChecked = MessageCache::FetchMessages(profileId, chatId, msgIds, missingMsgIds);
+    for (const auto& msgId : (cacheChecked ? missingMsgIds : msgIds))
+    {
+      std::shared_ptr<GetMessageRequest> getMessageRequest = std::make_shared<GetMessageRequest>();
+      getMessageRequest->chatId = chatId;
+      getMessageRequest->msgId = msgId;
+      getMessageRequest->cached = !cacheChecked;
+      LOG_TRACE("request message %s in %s", msgId.c_str(), chatId.c_str());
+      SendProtocolRequest(profileId, getMessageRequest);
+    }
   }
+
+  m_PendingMessageFetches.clear();
 }
 
 void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
+{
+  bool wasEmpty = false;
+  {
+    std::unique_lock<std::mutex> lock(m_ServiceMessageMutex);
+    wasEmpty = m_ServiceMessageQueue.empty();
+    m_ServiceMessageQueue.push_back(p_ServiceMessage);
+  }
+
+  // in power save queued messages are applied on next interval, only the first one wakes up ui thread
+  if (!m_PowerSave || wasEmpty)
+  {
+    UiController::Wakeup();
+  }
+}
+
+void UiModel::ProcessServiceMessages()
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
-  const std::string profileId = p_ServiceMessage->profileId;
-  switch (p_ServiceMessage->GetMessageType())
+  HandleServiceMessages();
+}
+
+bool UiModel::HandleServiceMessages(bool p_YieldOnChunk)
+{
+  // must be called with m_ModelMutex held, applies all queued messages as one batch, or when yielding
+  // on chunk, up to a history chunk with more to follow, so its first screen is drawn before the rest
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  if (m_PowerSave && ((nowTime - m_ServiceMessagesTime) < UiConfig::GetParams().powerSaveInterval)) return false;
+
+  std::deque<std::shared_ptr<ServiceMessage>> serviceMessages;
+  {
+    std::unique_lock<std::mutex> lock(m_ServiceMessageMutex);
+    serviceMessages.swap(m_ServiceMessageQueue);
+  }
+
+  if (serviceMessages.empty()) return false;
+
+  m_ServiceMessagesTime = nowTime;
+  LOG_TRACE("handle service messages %d", serviceMessages.size());
+  TraceSpan batchSpan("UiModel::HandleServiceMessages");
+  Trace::AddCounter("ui service messages", serviceMessages.size());
+  const bool yieldOnChunk = p_YieldOnChunk && !m_PowerSave;
+  for (auto it = serviceMessages.begin(); it != serviceMessages.end(); ++it)
+  {
+    const ServiceMessage& serviceMessage = **it;
+    {
+      TraceSpan messageSpan("UiModel::HandleServiceMessage", "type", serviceMessage.GetMessageType());
+      HandleServiceMessage(serviceMessage);
+    }
+
+    if (yieldOnChunk && (serviceMessage.GetMessageType() == NewMessagesNotifyType) &&
+        static_cast<const NewMessagesNotify&>(serviceMessage).more && (std::next(it) != serviceMessages.end()))
+    {
+      std::unique_lock<std::mutex> lock(m_ServiceMessageMutex);
+      m_ServiceMessageQueue.insert(m_ServiceMessageQueue.begin(), std::next(it), serviceMessages.end());
+      UiController::Wakeup();
+      break;
+    }
+  }
+
+  return true;
+}
+
+void UiModel::HandleServiceMessage(const ServiceMessage& p_ServiceMessage)
+{
+  // @note: notifies are accessed by reference, to not copy the shared_ptr per message
+  const std::string profileId = p_ServiceMessage.profileId;
+  switch (p_ServiceMessage.GetMessageType())
   {
     case ConnectNotifyType:
       {
-        std::shared_ptr<ConnectNotify> connectNotify = std::static_pointer_cast<ConnectNotify>(p_ServiceMessage);
-        if (connectNotify->success)
+        const ConnectNotify& connectNotify = static_cast<const ConnectNotify&>(p_ServiceMessage);
+        if (connectNotify.success)
         {
           LOG_TRACE("connected");
           if (!HasProtocolFeature(profileId, FeatureAutoGetChatsOnLogin))
@@ -1526,22 +2158,33 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
           }
 
           SetStatusOnline(profileId, true);
+          LoadOutbox(profileId);
         }
       }
       break;
 
     case NewContactsNotifyType:
       {
-        std::shared_ptr<NewContactsNotify> newContactsNotify = std::static_pointer_cast<NewContactsNotify>(
-          p_ServiceMessage);
-        const std::vector<ContactInfo>& contactInfos = newContactsNotify->contactInfos;
+        const NewContactsNotify& newContactsNotify = static_cast<const NewContactsNotify&>(p_ServiceMessage);
+        const std::vector<ContactInfo>& contactInfos = newContactsNotify.contactInfos;
+        std::unordered_map<std::string, ContactInfo>& profileContactInfos = m_ContactInfos[profileId];
+        size_t changedCount = 0;
         for (auto& contactInfo : contactInfos)
         {
-          LOG_TRACE("NewContacts");
-          m_ContactInfos[profileId][contactInfo.id] = contactInfo;
+          // protocols resend full contact lists on login, only changed contacts invalidate views
+          auto contactIt = profileContactInfos.find(contactInfo.id);
+          if ((contactIt != profileContactInfos.end()) &&
+              ProtocolUtil::IsContactInfoEqual(contactIt->second, contactInfo)) continue;
+
+          profileContactInfos[contactInfo.id] = contactInfo;
+          ++changedCount;
         }
 
-        m_ContactInfosUpdateTime = TimeUtil::GetCurrentTimeMSec();
+        LOG_TRACE("new contacts %d changed %d", contactInfos.size(), changedCount);
+        if (changedCount == 0) break;
+
+        // strictly increasing, as views use it to invalidate cached contact names
+        m_ContactInfosUpdateTime = std::max(TimeUtil::GetCurrentTimeMSec(), m_ContactInfosUpdateTime + 1);
 
         UpdateList();
         UpdateStatus();
@@ -1551,25 +2194,60 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
 
     case NewChatsNotifyType:
       {
-        std::shared_ptr<NewChatsNotify> newChatsNotify = std::static_pointer_cast<NewChatsNotify>(p_ServiceMessage);
-        if (newChatsNotify->success)
+        const NewChatsNotify& newChatsNotify = static_cast<const NewChatsNotify&>(p_ServiceMessage);
+        if (newChatsNotify.success)
         {
-          LOG_TRACE("new chats %d", newChatsNotify->chatInfos.size());
-          for (auto& chatInfo : newChatsNotify->chatInfos)
+          LOG_TRACE("new chats %d", newChatsNotify.chatInfos.size());
+          if (!newChatsNotify.chatInfos.empty())
+          {
+            StartupProfile::Mark("first chat list " + profileId);
+          }
+
+          // bulk updates, like the initial chat list, are cheaper to sort in full
+          const bool fullSort = (newChatsNotify.chatInfos.size() > 16);
+          std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[profileId];
+          std::unordered_map<std::string, int64_t>& profileChatVecTimes = m_ChatVecTimes[profileId];
+          std::vector<std::string> changedChatIds;
+          for (auto& chatInfo : newChatsNotify.chatInfos)
           {
-            m_ChatInfos[profileId][chatInfo.id] = chatInfo;
+            // protocols resend full chat lists on login, unchanged listed chats need no update
+            auto chatIt = profileChatInfos.find(chatInfo.id);
+            if ((chatIt != profileChatInfos.end()) && ProtocolUtil::IsChatInfoEqual(chatIt->second, chatInfo) &&
+                profileChatVecTimes.count(chatInfo.id)) continue;
+
+            changedChatIds.push_back(chatInfo.id);
+            profileChatInfos[chatInfo.id] = chatInfo;
+            SetChatInfoIsUnread(profileId, chatInfo.id, chatInfo.isUnread);
             HandleChatInfoMutedUpdate(profileId, chatInfo.id);
+            UpdateChatInfoLastMessageTime(profileId, chatInfo.id);
+            UpdateChatInfoIsUnread(profileId, chatInfo.id);
 
-            if (m_ChatSet[profileId].insert(chatInfo.id).second)
+            if (fullSort)
             {
-              m_ChatVec.push_back(std::make_pair(profileId, chatInfo.id));
+              if (!profileChatVecTimes.count(chatInfo.id))
+              {
+                profileChatVecTimes[chatInfo.id] = 0;
+                m_ProfileChatVecs[profileId].push_back(std::make_pair(profileId, chatInfo.id));
+              }
+            }
+            else
+            {
+              AddChat(profileId, chatInfo.id);
+              UpdateChatPosition(profileId, chatInfo.id);
             }
+          }
 
-            UpdateChatInfoLastMessageTime(profileId, chatInfo.id);
-            UpdateChatInfoIsUnread(profileId, chatInfo.id);
+          LOG_TRACE("changed chats %d", changedChatIds.size());
+          if (changedChatIds.empty()) break;
+
+          if (fullSort)
+          {
+            SortChats(profileId);
           }
 
-          SortChats();
+          // unread state of chats without loaded history, and unread counts, are taken from cache
+          MessageCache::FetchChatUnreads(profileId, changedChatIds);
+
           UpdateList();
           UpdateStatus();
         }
@@ -1578,18 +2256,29 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
 
     case NewMessagesNotifyType:
       {
-        std::shared_ptr<NewMessagesNotify> newMessagesNotify = std::static_pointer_cast<NewMessagesNotify>(
-          p_ServiceMessage);
-        if (newMessagesNotify->success)
+        const NewMessagesNotify& newMessagesNotify = static_cast<const NewMessagesNotify&>(p_ServiceMessage);
+        if (HandleBackfillMessages(profileId, newMessagesNotify)) break;
+
+        if (HandleCacheOnlyMessages(profileId, newMessagesNotify)) break;
+
+        CompleteMessagesRequest(profileId, newMessagesNotify);
+        if (newMessagesNotify.sequence)
         {
-          bool hasNewMessage = false;
-          const std::string& chatId = newMessagesNotify->chatId;
-          std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
-          std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-          const std::vector<ChatMessage>& chatMessages = newMessagesNotify->chatMessages;
-          const std::string& fromMsgId = newMessagesNotify->fromMsgId;
+          GetChatState(profileId, newMessagesNotify.chatId).moreMessagesPending = newMessagesNotify.more;
+        }
 
-          if (!newMessagesNotify->cached)
+        if (newMessagesNotify.success)
+        {
+          bool hasNewMessage = false;
+          const std::string& chatId = newMessagesNotify.chatId;
+          ChatState& chatState = GetChatState(profileId, chatId);
+          std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+          std::vector<std::string>& messageVec = chatState.messageVec;
+          // @note: notify messages may be shared with a pending cache write, so they are read-only here
+          const std::vector<ChatMessage>& chatMessages = newMessagesNotify.chatMessages;
+          const std::string& fromMsgId = newMessagesNotify.fromMsgId;
+
+          if (!newMessagesNotify.cached)
           {
             LOG_TRACE("new messages %s count %d from %s", chatId.c_str(), chatMessages.size(), fromMsgId.c_str());
           }
@@ -1599,22 +2288,62 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
                       fromMsgId.c_str());
           }
 
-          std::string& oldestMessageId = m_OldestMessageId[profileId][chatId];
-          int64_t& oldestMessageTime = m_OldestMessageTime[profileId][chatId];
+          std::string& oldestMessageId = chatState.oldestMessageId;
+          int64_t& oldestMessageTime = chatState.oldestMessageTime;
+
+          // selected or scrolled to message stays in view, as insertions may shift its offset
+          std::string currentMessageId;
+          int& messageOffset = chatState.messageOffset;
+          if ((profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+          {
+            if ((GetSelectMessageActive() || (messageOffset > 0)) && (messageOffset < (int)messageVec.size()))
+            {
+              currentMessageId = messageVec[messageOffset];
+            }
+          }
 
-          for (auto& chatMessage : chatMessages)
+          bool resetLastMessageId = false;
+          for (const auto& newChatMessage : chatMessages)
           {
-            hasNewMessage = true;
-            if (messages.insert({ chatMessage.id, chatMessage }).second)
+            // exact duplicates, e.g. a page delivered by both cache and network, leave views as is
+            auto msgIt = messages.find(newChatMessage.id);
+            if (msgIt == messages.end())
+            {
+              hasNewMessage = true;
+              const std::string msgId = newChatMessage.id;
+              msgIt = messages.insert({ msgId, CompactMessage(newChatMessage) }).first;
+              messageVec.insert(FindMessageVecPos(messageVec, messages, msgIt->second), msgId);
+            }
+            else if (msgIt->second.IsEqual(newChatMessage))
             {
-              messageVec.push_back(chatMessage.id);
+              // unchanged
+            }
+            else if ((msgIt->second.timeSent != newChatMessage.timeSent) ||
+                     (msgIt->second.sequence != newChatMessage.sequence))
+            {
+              resetLastMessageId = resetLastMessageId || (msgIt->first == chatState.lastMessageId);
+              auto vecIt = FindMessageVecPos(messageVec, messages, msgIt->second);
+              if ((vecIt != messageVec.end()) && (*vecIt == msgIt->first))
+              {
+                messageVec.erase(vecIt);
+              }
+
+              hasNewMessage = true;
+              msgIt->second = newChatMessage;
+              messageVec.insert(FindMessageVecPos(messageVec, messages, msgIt->second), msgIt->first);
             }
             else
             {
-              messages[chatMessage.id] = chatMessage;
+              // field changes keep position, views re-layout only content that differs
+              hasNewMessage = true;
+              msgIt->second = newChatMessage;
             }
 
-            if (newMessagesNotify->sequence)
+            const CompactMessage& chatMessage = msgIt->second;
+            UpdateLastMessageId(chatState, chatMessage);
+            UpdateFindMatch(profileId, chatId, chatMessage);
+
+            if (newMessagesNotify.sequence)
             {
               int64_t messageTime = chatMessage.timeSent;
               if ((messageTime < oldestMessageTime) || (oldestMessageTime == 0))
@@ -1626,52 +2355,48 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
             }
           }
 
-          if (hasNewMessage)
+          if (resetLastMessageId)
+          {
+            ResetLastMessageId(chatState);
+          }
+
+          const bool isCurrentChat = (profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second);
+          if (isCurrentChat && !chatMessages.empty())
           {
-            std::string currentMessageId;
-            int& messageOffset = m_MessageOffset[profileId][chatId];
-            if ((profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+            if (hasNewMessage)
             {
-              if (GetSelectMessageActive() && (messageOffset < (int)messageVec.size()))
+              const int currentMessageIndex = FindMessageIndex(chatState, currentMessageId);
+              if (currentMessageIndex != -1)
               {
-                currentMessageId = messageVec[messageOffset];
+                messageOffset = currentMessageIndex;
               }
             }
 
-            // *INDENT-OFF*
-            std::sort(messageVec.begin(), messageVec.end(),
-                      [&](const std::string& lhs, const std::string& rhs) -> bool
+            // also for unchanged pages, as the view may need the next one
+            if (!newMessagesNotify.cached && !newMessagesNotify.more)
             {
-              return messages.at(lhs).timeSent > messages.at(rhs).timeSent;
-            });
-            // *INDENT-ON*
+              RequestMessagesCurrentChat();
+            }
+          }
 
-            if ((profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+          if (hasNewMessage)
+          {
+            if (isCurrentChat)
             {
-              if (!currentMessageId.empty())
-              {
-                auto it = std::find(messageVec.begin(), messageVec.end(), currentMessageId);
-                if (it != messageVec.end())
-                {
-                  messageOffset = it - messageVec.begin();
-                }
-              }
-
-              if (!newMessagesNotify->cached)
-              {
-                RequestMessagesCurrentChat();
-              }
-
               UpdateHistory();
             }
+            else if (IsHistoryPaneChat(profileId, chatId))
+            {
+              m_View->SetHistoryDirty(true);
+            }
 
             SetHistoryInteraction(false);
           }
 
-          const std::pair<std::string, std::string>& nextChat = GetNextChat();
+          const ChatKey& nextChat = GetNextChat();
           if ((profileId == nextChat.first) && (chatId == nextChat.second))
           {
-            if (!newMessagesNotify->cached)
+            if (!newMessagesNotify.cached && !newMessagesNotify.more)
             {
               RequestMessagesNextChat();
             }
@@ -1686,96 +2411,119 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
             SendProtocolRequest(profileId, getChatsRequest);
           }
 
-          UpdateChatInfoLastMessageTime(profileId, chatId);
-          UpdateChatInfoIsUnread(profileId, chatId);
-          SortChats();
-          UpdateList();
-          HomeFetchNext(profileId, chatId, (int)chatMessages.size());
+          if (hasNewMessage)
+          {
+            UpdateChatInfoLastMessageTime(profileId, chatId);
+            UpdateChatInfoIsUnread(profileId, chatId);
+            UpdateChatPosition(profileId, chatId);
+            UpdateList();
+
+            // new messages are queued to cache before notified, so the unreads fetch queued after them
+            // includes them once committed
+            if (!newMessagesNotify.cached && GetChatIsUnread(profileId, chatId))
+            {
+              MessageCache::FetchChatUnreads(profileId, std::vector<std::string>({ chatId }));
+            }
+          }
+
+          if (!newMessagesNotify.more)
+          {
+            HomeFetchNext(profileId, chatId, (int)chatMessages.size());
+          }
+
+          // history page for a find past the loaded messages, an empty page means none older remain
+          if (m_FindOlderPending && newMessagesNotify.sequence && !newMessagesNotify.more &&
+              (profileId == m_FindChat.first) && (chatId == m_FindChat.second))
+          {
+            if (chatMessages.empty())
+            {
+              m_FindOlderPending = false;
+              UpdateEntry();
+            }
+            else
+            {
+              FindNext(true /* p_Older */);
+            }
+          }
+
+          if (hasNewMessage)
+          {
+            TrimChatMessages(profileId, chatId);
+          }
         }
       }
       break;
 
     case SendMessageNotifyType:
       {
-        std::shared_ptr<SendMessageNotify> sendMessageNotify = std::static_pointer_cast<SendMessageNotify>(
-          p_ServiceMessage);
-        LOG_TRACE(sendMessageNotify->success ? "send ok" : "send failed");
+        const SendMessageNotify& sendMessageNotify = static_cast<const SendMessageNotify&>(p_ServiceMessage);
+        LOG_TRACE(sendMessageNotify.success ? "send ok" : "send failed");
+        CompleteOutbox(profileId, sendMessageNotify.chatId, sendMessageNotify.success);
+        ProcessOutbox();
       }
       break;
 
     case MarkMessageReadNotifyType:
       {
-        std::shared_ptr<MarkMessageReadNotify> markMessageReadNotify = std::static_pointer_cast<MarkMessageReadNotify>(
-          p_ServiceMessage);
-        LOG_TRACE(markMessageReadNotify->success ? "mark read ok" : "mark read failed");
+        const MarkMessageReadNotify& markMessageReadNotify =
+          static_cast<const MarkMessageReadNotify&>(p_ServiceMessage);
+        LOG_TRACE(markMessageReadNotify.success ? "mark read ok" : "mark read failed");
+      }
+      break;
+
+    case MarkMessagesReadNotifyType:
+      {
+        const MarkMessagesReadNotify& markMessagesReadNotify =
+          static_cast<const MarkMessagesReadNotify&>(p_ServiceMessage);
+        LOG_TRACE(markMessagesReadNotify.success ? "mark read ok" : "mark read failed");
       }
       break;
 
     case DeleteMessageNotifyType:
       {
-        std::shared_ptr<DeleteMessageNotify> deleteMessageNotify = std::static_pointer_cast<DeleteMessageNotify>(
-          p_ServiceMessage);
-        LOG_TRACE(deleteMessageNotify->success ? "delete ok" : "delete failed");
-        if (deleteMessageNotify->success)
+        const DeleteMessageNotify& deleteMessageNotify = static_cast<const DeleteMessageNotify&>(p_ServiceMessage);
+        LOG_TRACE(deleteMessageNotify.success ? "delete ok" : "delete failed");
+        if (deleteMessageNotify.success)
         {
-          std::string chatId = deleteMessageNotify->chatId;
-          std::string msgId = deleteMessageNotify->msgId;
-
-          std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-          messageVec.erase(std::remove(messageVec.begin(), messageVec.end(), msgId), messageVec.end());
+          DeleteMessages(profileId, deleteMessageNotify.chatId, std::vector<std::string>({ deleteMessageNotify.msgId }));
+        }
+      }
+      break;
 
-          std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
-          messages.erase(msgId);
-
-          if (GetSelectMessageActive())
-          {
-            int& messageOffset = m_MessageOffset[profileId][chatId];
-            if (messageVec.empty())
-            {
-              messageOffset = 0;
-              SetSelectMessageActive(false);
-            }
-            else
-            {
-              if ((messageOffset + 1) > (int)messageVec.size())
-              {
-                messageOffset = (int)messageVec.size() - 1;
-              }
-            }
-          }
-
-          UpdateChatInfoLastMessageTime(profileId, chatId);
-          SortChats();
-          UpdateList();
-          UpdateHistory();
-        }
-      }
-      break;
+    case DeleteMessagesNotifyType:
+      {
+        const DeleteMessagesNotify& deleteMessagesNotify = static_cast<const DeleteMessagesNotify&>(p_ServiceMessage);
+        LOG_TRACE("delete messages %d", deleteMessagesNotify.msgIds.size());
+        if (deleteMessagesNotify.success)
+        {
+          DeleteMessages(profileId, deleteMessagesNotify.chatId, deleteMessagesNotify.msgIds);
+        }
+      }
+      break;
 
     case SendTypingNotifyType:
       {
-        std::shared_ptr<SendTypingNotify> sendTypingNotify =
-          std::static_pointer_cast<SendTypingNotify>(p_ServiceMessage);
-        LOG_TRACE(sendTypingNotify->success ? "send typing ok" : "send typing failed");
+        const SendTypingNotify& sendTypingNotify = static_cast<const SendTypingNotify&>(p_ServiceMessage);
+        LOG_TRACE(sendTypingNotify.success ? "send typing ok" : "send typing failed");
       }
       break;
 
     case SetStatusNotifyType:
       {
-        std::shared_ptr<SetStatusNotify> setStatusNotify = std::static_pointer_cast<SetStatusNotify>(p_ServiceMessage);
-        LOG_TRACE(setStatusNotify->success ? "set status ok" : "set status failed");
+        const SetStatusNotify& setStatusNotify = static_cast<const SetStatusNotify&>(p_ServiceMessage);
+        LOG_TRACE(setStatusNotify.success ? "set status ok" : "set status failed");
       }
       break;
 
     case NewMessageStatusNotifyType:
       {
-        std::shared_ptr<NewMessageStatusNotify> newMessageStatusNotify =
-          std::static_pointer_cast<NewMessageStatusNotify>(p_ServiceMessage);
-        std::string chatId = newMessageStatusNotify->chatId;
-        std::string msgId = newMessageStatusNotify->msgId;
-        bool isRead = newMessageStatusNotify->isRead;
+        const NewMessageStatusNotify& newMessageStatusNotify =
+          static_cast<const NewMessageStatusNotify&>(p_ServiceMessage);
+        std::string chatId = newMessageStatusNotify.chatId;
+        std::string msgId = newMessageStatusNotify.msgId;
+        bool isRead = newMessageStatusNotify.isRead;
         LOG_TRACE("new read status %s is %s", msgId.c_str(), (isRead ? "read" : "unread"));
-        std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+        std::unordered_map<std::string, CompactMessage>& messages = GetChatState(profileId, chatId).messages;
         auto mit = messages.find(msgId);
         if (mit != messages.end())
         {
@@ -1788,22 +2536,59 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
       }
       break;
 
+    case ReadOutboxNotifyType:
+      {
+        const ReadOutboxNotify& readOutboxNotify = static_cast<const ReadOutboxNotify&>(p_ServiceMessage);
+        const std::string& chatId = readOutboxNotify.chatId;
+        LOG_TRACE("read outbox %s up to %s", chatId.c_str(), readOutboxNotify.msgId.c_str());
+        std::unordered_map<std::string, CompactMessage>& messages = GetChatState(profileId, chatId).messages;
+        auto lastReadIt = messages.find(readOutboxNotify.msgId);
+        if (lastReadIt == messages.end()) break;
+
+        // single pass for a receipt update, outgoing messages do not affect chat unread state
+        const int64_t lastReadTime = lastReadIt->second.timeSent;
+        bool isChanged = false;
+        for (auto& message : messages)
+        {
+          if (message.second.isOutgoing && !message.second.isRead && (message.second.timeSent <= lastReadTime))
+          {
+            message.second.isRead = true;
+            isChanged = true;
+          }
+        }
+
+        if (!isChanged) break;
+
+        if ((profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+        {
+          UpdateHistory();
+        }
+        else if (IsHistoryPaneChat(profileId, chatId))
+        {
+          m_View->SetHistoryDirty(true);
+        }
+      }
+      break;
+
     case NewMessageFileNotifyType:
       {
-        std::shared_ptr<NewMessageFileNotify> newMessageFileNotify = std::static_pointer_cast<NewMessageFileNotify>(
-          p_ServiceMessage);
-        std::string chatId = newMessageFileNotify->chatId;
-        std::string msgId = newMessageFileNotify->msgId;
-        std::string fileInfoStr = newMessageFileNotify->fileInfo;
-        DownloadFileAction downloadFileAction = newMessageFileNotify->downloadFileAction;
+        const NewMessageFileNotify& newMessageFileNotify = static_cast<const NewMessageFileNotify&>(p_ServiceMessage);
+        std::string chatId = newMessageFileNotify.chatId;
+        std::string msgId = newMessageFileNotify.msgId;
+        std::string fileInfoStr = newMessageFileNotify.fileInfo;
+        DownloadFileAction downloadFileAction = newMessageFileNotify.downloadFileAction;
         LOG_TRACE("new file info for %s is %s", msgId.c_str(), fileInfoStr.c_str());
-        std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+        std::unordered_map<std::string, CompactMessage>& messages = GetChatState(profileId, chatId).messages;
         auto mit = messages.find(msgId);
         if (mit != messages.end())
         {
           mit->second.fileInfo = fileInfoStr;
         }
 
+        // file is re-checked on next use, also if info is unchanged
+        GetChatState(profileId, chatId).attachmentInfos.erase(msgId);
+        GetChatState(profileId, chatId).downloadProgress.erase(msgId);
+
         if (downloadFileAction == DownloadFileActionOpen)
         {
           FileInfo fileInfo = ProtocolUtil::FileInfoFromHex(fileInfoStr);
@@ -1825,62 +2610,130 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
       }
       break;
 
+    case NewMessageFileProgressNotifyType:
+      {
+        const NewMessageFileProgressNotify& newMessageFileProgressNotify =
+          static_cast<const NewMessageFileProgressNotify&>(p_ServiceMessage);
+        const int64_t totalBytes = newMessageFileProgressNotify.totalBytes;
+        if (totalBytes <= 0) break;
+
+        const std::string& chatId = newMessageFileProgressNotify.chatId;
+        const std::string& msgId = newMessageFileProgressNotify.msgId;
+        const int percent =
+          (int)std::min<int64_t>((newMessageFileProgressNotify.downloadedBytes * 100) / totalBytes, 100);
+        int& downloadProgress = GetChatState(profileId, chatId).downloadProgress[msgId];
+        if (downloadProgress != percent)
+        {
+          downloadProgress = percent;
+          if ((profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second))
+          {
+            UpdateHistory();
+          }
+        }
+      }
+      break;
+
     case ReceiveTypingNotifyType:
       {
-        std::shared_ptr<ReceiveTypingNotify> receiveTypingNotify = std::static_pointer_cast<ReceiveTypingNotify>(
-          p_ServiceMessage);
-        bool isTyping = receiveTypingNotify->isTyping;
-        std::string chatId = receiveTypingNotify->chatId;
-        std::string userId = receiveTypingNotify->userId;
+        const ReceiveTypingNotify& receiveTypingNotify = static_cast<const ReceiveTypingNotify&>(p_ServiceMessage);
+        bool isTyping = receiveTypingNotify.isTyping;
+        std::string chatId = receiveTypingNotify.chatId;
+        std::string userId = receiveTypingNotify.userId;
         LOG_TRACE("received user %s in chat %s is %s", userId.c_str(), chatId.c_str(), (isTyping ? "typing" : "idle"));
+        // typing is only shown for current chat, in power save other chats' typing starts are dropped,
+        // while stops still apply to not leave stale state
+        const bool isCurrentChat = (profileId == m_CurrentChat.first) && (chatId == m_CurrentChat.second);
+        if (isTyping && m_PowerSave && !isCurrentChat) break;
+
+        // repeated typing starts only extend expiry, status is only redrawn when typing users change
+        ChatState& chatState = GetChatState(profileId, chatId);
+        std::vector<TypingUser>& usersTyping = chatState.usersTyping;
+        const InternedStr userKey(userId);
+        // *INDENT-OFF*
+        auto it = std::find_if(usersTyping.begin(), usersTyping.end(),
+                               [&](const TypingUser& p_TypingUser) { return p_TypingUser.userId == userKey; });
+        // *INDENT-ON*
+        bool isChanged = false;
         if (isTyping)
         {
-          m_UsersTyping[profileId][chatId].insert(userId);
+          const int64_t expiryTime = TimeUtil::GetCurrentTimeMSec() + s_UsersTypingExpiryMs;
+          if (it == usersTyping.end())
+          {
+            usersTyping.push_back(TypingUser{ userKey, expiryTime });
+            isChanged = true;
+          }
+          else
+          {
+            it->expiryTime = expiryTime;
+          }
+
+          if (m_UsersTypingExpiryTime == 0)
+          {
+            m_UsersTypingExpiryTime = expiryTime;
+          }
         }
-        else
+        else if (it != usersTyping.end())
         {
-          m_UsersTyping[profileId][chatId].erase(userId);
+          usersTyping.erase(it);
+          isChanged = true;
+        }
+
+        if (isChanged)
+        {
+          chatState.chatStatusVersion = 0;
+          if (isCurrentChat)
+          {
+            UpdateStatus();
+          }
         }
-        UpdateStatus();
       }
       break;
 
     case ReceiveStatusNotifyType:
       {
-        std::shared_ptr<ReceiveStatusNotify> receiveStatusNotify = std::static_pointer_cast<ReceiveStatusNotify>(
-          p_ServiceMessage);
-        std::string userId = receiveStatusNotify->userId;
-        bool isOnline = receiveStatusNotify->isOnline;
-        int64_t timeSeen = receiveStatusNotify->timeSeen;
+        const ReceiveStatusNotify& receiveStatusNotify = static_cast<const ReceiveStatusNotify&>(p_ServiceMessage);
+        std::string userId = receiveStatusNotify.userId;
+        bool isOnline = receiveStatusNotify.isOnline;
+        int64_t timeSeen = receiveStatusNotify.timeSeen;
         LOG_TRACE("received user %s is %s seen %lld", userId.c_str(),
                   (isOnline ? "online" : "away"), timeSeen);
-        m_UserOnline[profileId][userId] = isOnline;
+
+        // pushed updates keep the status fresh, deferring any new request for it
+        m_UserStatusTimes[ChatKey(profileId, userId)] = TimeUtil::GetCurrentTimeMSec();
+
+        // only users on screen trigger redraw, others are coalesced and applied once displayed
+        UserStatus& pendingUserStatus = m_PendingUserStatuses[profileId][userId];
+        pendingUserStatus.isOnline = isOnline;
         if (timeSeen != -1)
         {
-          m_UserTimeSeen[profileId][userId] = timeSeen;
+          pendingUserStatus.timeSeen = timeSeen;
+        }
+
+        if (IsUserStatusVisible(profileId, userId))
+        {
+          ApplyPendingUserStatus(profileId, userId);
+          UpdateStatus();
         }
-        UpdateStatus();
       }
       break;
 
     case CreateChatNotifyType:
       {
-        std::shared_ptr<CreateChatNotify> createChatNotify =
-          std::static_pointer_cast<CreateChatNotify>(p_ServiceMessage);
-        if (createChatNotify->success)
+        const CreateChatNotify& createChatNotify = static_cast<const CreateChatNotify&>(p_ServiceMessage);
+        if (createChatNotify.success)
         {
-          const ChatInfo& chatInfo = createChatNotify->chatInfo;
+          const ChatInfo& chatInfo = createChatNotify.chatInfo;
           LOG_TRACE("chat created %s", chatInfo.id.c_str());
           m_ChatInfos[profileId][chatInfo.id] = chatInfo;
-          if (m_ChatSet[profileId].insert(chatInfo.id).second)
-          {
-            m_ChatVec.push_back(std::make_pair(profileId, chatInfo.id));
-          }
-
+          SetChatInfoIsUnread(profileId, chatInfo.id, chatInfo.isUnread);
+          ListChatVecProfile(profileId);
           m_CurrentChatIndex = 0;
+          AddChat(profileId, chatInfo.id);
+          UpdateChatPosition(profileId, chatInfo.id);
+
           m_CurrentChat.first = profileId;
           m_CurrentChat.second = chatInfo.id;
-          SortChats();
+          m_CurrentChatIndex = std::max(FindChatIndex(m_CurrentChat), 0);
           OnCurrentChatChanged();
           SetSelectMessageActive(false);
         }
@@ -1889,62 +2742,146 @@ void UiModel::MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage)
 
     case DeleteChatNotifyType:
       {
-        std::shared_ptr<DeleteChatNotify> deleteChatNotify = std::static_pointer_cast<DeleteChatNotify>(
-          p_ServiceMessage);
-        if (deleteChatNotify->success)
+        const DeleteChatNotify& deleteChatNotify = static_cast<const DeleteChatNotify&>(p_ServiceMessage);
+        if (deleteChatNotify.success)
         {
-          std::string chatId = deleteChatNotify->chatId;
+          std::string chatId = deleteChatNotify.chatId;
           LOG_TRACE("chat deleted %s", chatId.c_str());
 
-          for (auto it = m_ChatVec.begin(); it != m_ChatVec.end(); /* incremented in loop */)
+          RemoveChat(profileId, chatId);
+          m_UnreadChats.erase(ChatKey(profileId, chatId));
+          m_ChatUnreadCounts.erase(ChatKey(profileId, chatId));
+          m_ChatInfos[profileId].erase(chatId);
+
+          if ((m_CurrentChat.first == profileId) && (m_CurrentChat.second == chatId))
           {
-            if ((it->first == profileId) && (it->second == chatId))
+            m_CurrentChatIndex = NumUtil::Bound(0, m_CurrentChatIndex, ((int)m_ChatVec.size() - 1));
+            m_CurrentChat = m_ChatVec.at(m_CurrentChatIndex);
+            OnCurrentChatChanged();
+            SetSelectMessageActive(false);
+          }
+          else
+          {
+            OnCurrentChatChanged();
+          }
+
+          // messages are released at once, the cache purges its copy in the background
+          std::unordered_map<std::string, ChatState>& chatStates = m_ChatStates[profileId];
+          auto chatIt = chatStates.find(chatId);
+          if (chatIt != chatStates.end())
+          {
+            for (auto& msgFromRequest : chatIt->second.msgFromRequests)
             {
-              m_ChatSet[profileId].erase(it->second);
-              it = m_ChatVec.erase(it);
+              if (msgFromRequest.second)
+              {
+                msgFromRequest.second->Cancel();
+              }
             }
-            else
+
+            chatStates.erase(chatIt);
+          }
+
+          // ids of a chat sort between its empty id and the next possible chat id
+          m_FetchedMessageIds.RemoveRange(std::make_tuple(profileId, chatId, std::string()),
+                                          std::make_tuple(profileId, chatId + '\0', std::string()));
+          m_PendingMessageFetches.erase(ChatKey(profileId, chatId));
+        }
+      }
+      break;
+
+    case SearchMessagesNotifyType:
+      {
+        const SearchMessagesNotify& searchMessagesNotify = static_cast<const SearchMessagesNotify&>(p_ServiceMessage);
+        if (!searchMessagesNotify.success || (searchMessagesNotify.query != m_SearchQuery)) break;
+
+        LOG_TRACE("search notify %d %d", searchMessagesNotify.isServer, searchMessagesNotify.chatMessages.size());
+        std::vector<std::pair<std::string, ChatMessage>>& searchResults = m_SearchResults[profileId];
+        std::vector<std::pair<std::string, ChatMessage>> mergedResults;
+        std::set<std::pair<std::string, std::string>> resultKeys;
+        // local results are ranked first, server pages follow in arrival order, duplicates dropped
+        const std::vector<std::pair<std::string, ChatMessage>>& firstResults =
+          searchMessagesNotify.isServer ? searchResults : searchMessagesNotify.chatMessages;
+        const std::vector<std::pair<std::string, ChatMessage>>& nextResults =
+          searchMessagesNotify.isServer ? searchMessagesNotify.chatMessages : searchResults;
+        for (const auto& results : { &firstResults, &nextResults })
+        {
+          for (const auto& result : *results)
+          {
+            if (resultKeys.insert(std::make_pair(result.first, result.second.id)).second)
             {
-              ++it;
+              mergedResults.push_back(result);
             }
           }
+        }
 
-          m_ChatInfos[profileId].erase(chatId);
+        searchResults.swap(mergedResults);
+        m_SearchResultsUpdateTime = TimeUtil::GetCurrentTimeMSec();
+      }
+      break;
 
-          if ((m_CurrentChat.first == profileId) && (m_CurrentChat.second == chatId))
+    case ChatUnreadNotifyType:
+      {
+        const ChatUnreadNotify& chatUnreadNotify = static_cast<const ChatUnreadNotify&>(p_ServiceMessage);
+        LOG_TRACE("chat unreads %d", chatUnreadNotify.chatUnreadInfos.size());
+        const bool mutedIndicateUnread = UiConfig::GetParams().mutedIndicateUnread;
+        const bool mutedPositionByTimestamp = UiConfig::GetParams().mutedPositionByTimestamp;
+        std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[profileId];
+        for (const auto& chatUnreadInfo : chatUnreadNotify.chatUnreadInfos)
+        {
+          const std::string& chatId = chatUnreadInfo.id;
+          auto chatIt = profileChatInfos.find(chatId);
+          if (chatIt == profileChatInfos.end()) continue;
+
+          // loaded messages are at least as recent as cache, and decide unread state once present
+          ChatInfo& chatInfo = chatIt->second;
+          if (GetLastMessageId(profileId, chatId).empty())
           {
-            m_CurrentChat = m_ChatVec.at(NumUtil::Bound(0, m_CurrentChatIndex, ((int)m_ChatVec.size() - 1)));
-            SortChats();
-            OnCurrentChatChanged();
-            SetSelectMessageActive(false);
+            if (chatUnreadInfo.isUnread && !chatInfo.isUnread &&
+                (mutedIndicateUnread || !chatInfo.isMuted || chatUnreadInfo.hasUnreadMention))
+            {
+              chatInfo.isUnreadMention = chatUnreadInfo.hasUnreadMention;
+              SetChatInfoIsUnread(profileId, chatId, true);
+            }
+
+            if ((chatUnreadInfo.lastMessageTime > chatInfo.lastMessageTime) &&
+                (mutedPositionByTimestamp || !chatInfo.isMuted))
+            {
+              chatInfo.lastMessageTime = chatUnreadInfo.lastMessageTime;
+              UpdateChatPosition(profileId, chatId);
+            }
+          }
+
+          if (chatInfo.isUnread && (chatUnreadInfo.unreadCount > 0))
+          {
+            m_ChatUnreadCounts[ChatKey(profileId, chatId)] = chatUnreadInfo.unreadCount;
           }
           else
           {
-            SortChats();
-            OnCurrentChatChanged();
+            m_ChatUnreadCounts.erase(ChatKey(profileId, chatId));
           }
         }
+
+        UpdateList();
       }
       break;
 
     case UpdateMuteNotifyType:
       {
-        std::shared_ptr<UpdateMuteNotify> updateMuteNotify = std::static_pointer_cast<UpdateMuteNotify>(
-          p_ServiceMessage);
-        bool isMuted = updateMuteNotify->isMuted;
-        std::string chatId = updateMuteNotify->chatId;
+        const UpdateMuteNotify& updateMuteNotify = static_cast<const UpdateMuteNotify&>(p_ServiceMessage);
+        bool isMuted = updateMuteNotify.isMuted;
+        std::string chatId = updateMuteNotify.chatId;
         LOG_TRACE("mute notify %s is %s", chatId.c_str(), (isMuted ? "muted" : "unmuted"));
         m_ChatInfos[profileId][chatId].isMuted = isMuted;
         HandleChatInfoMutedUpdate(profileId, chatId);
         UpdateChatInfoLastMessageTime(profileId, chatId);
-        SortChats();
+        UpdateChatPosition(profileId, chatId);
         UpdateList();
         UpdateStatus();
       }
       break;
 
     default:
-      LOG_DEBUG("unknown service message %d", p_ServiceMessage->GetMessageType());
+      LOG_DEBUG("unknown service message %d", p_ServiceMessage.GetMessageType());
       break;
   }
 }
@@ -1964,79 +2901,736 @@ std::unordered_map<std::string, std::shared_ptr<Protocol>>& UiModel::GetProtocol
 bool UiModel::Process()
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
+  PerfTimer lockTimer(PerfStats::StatModelLockUs);
+  if (HandleServiceMessages(true /* p_YieldOnChunk */))
+  {
+    m_PrefetchPending = true;
+  }
+  else if (!m_PowerSave)
+  {
+    Prefetch();
+  }
+
   if (m_TriggerTerminalBell)
   {
     m_TriggerTerminalBell = false;
     m_View->TerminalBell();
   }
 
-  SetTyping("", "", false);
-  m_View->Draw();
+  if (AppUtil::HandleDumpRequest())
+  {
+    UpdateHeapStats();
+    const std::string report = PerfStats::GetReport();
+    LOG_INFO("%s", report.c_str());
+    if (Trace::IsEnabled())
+    {
+      Trace::Dump();
+    }
+  }
+
+  // suspend is noticed on the first tick after resume, woken by protocol events or terminal focus
+  CheckResume();
+
+  // developer mode performance overlay in status view is refreshed periodically
+  static const bool developerMode = AppUtil::GetDeveloperMode();
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  if (developerMode && ((nowTime - m_PerfStatsTime) >= s_PerfStatsIntervalMs))
+  {
+    m_PerfStatsTime = nowTime;
+    m_View->SetStatusDirty(true);
+  }
+
+  // resize events are debounced, views are only resized once a burst of events has ended
+  if (m_ResizePending && ((nowTime - m_ResizeTime) >= s_ResizeDebounceMs))
+  {
+    m_ResizePending = false;
+    SetHelpOffset(0);
+    ReinitView();
+  }
+
+  ProcessTyping();
+  if ((m_UsersTypingExpiryTime != 0) && (nowTime >= m_UsersTypingExpiryTime))
+  {
+    ExpireUsersTyping();
+  }
+
+  if (m_MemoryPressure.exchange(false))
+  {
+    ReleaseMemory();
+  }
+
+  if ((m_OutboxTimeoutTime != 0) && (nowTime >= m_OutboxTimeoutTime))
+  {
+    ProcessOutbox();
+  }
+
+  ProcessDesktopNotify();
+  ProcessPaste();
+  PrefetchAttachments();
+
+  // limit redraw rate, so bursts of updates are collapsed into a single frame
+  if ((nowTime - m_DrawTime) >= GetFrameIntervalMs())
+  {
+    m_DrawTime = nowTime;
+    m_DrawPending = false;
+    if (m_PowerSave)
+    {
+      m_View->DrawStatus();
+    }
+    else
+    {
+      m_View->Draw();
+      CompleteInputLatencies();
+      FlushCachedMessageFetches();
+      StartupProfile::Mark("first frame");
+      EmojiList::StartLoad(); // background load once, ahead of first emoji picker use
+    }
+  }
+  else
+  {
+    m_DrawPending = true;
+  }
+
   return m_Running;
 }
 
+int UiModel::GetKeyTimeout()
+{
+  // time until next scheduled ui task, or -1 to wait for key input or service messages only
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+  std::vector<int64_t> dueTimes;
+  if (m_DrawPending)
+  {
+    dueTimes.push_back(m_DrawTime + GetFrameIntervalMs());
+  }
+
+  if (m_PowerSave)
+  {
+    std::unique_lock<std::mutex> serviceMessageLock(m_ServiceMessageMutex);
+    if (!m_ServiceMessageQueue.empty())
+    {
+      dueTimes.push_back(m_ServiceMessagesTime + UiConfig::GetParams().powerSaveInterval);
+    }
+  }
+
+  if (m_TypingTimeoutTime != 0)
+  {
+    dueTimes.push_back(m_TypingTimeoutTime);
+  }
+
+  if (m_OutboxTimeoutTime != 0)
+  {
+    dueTimes.push_back(m_OutboxTimeoutTime);
+  }
+
+  if (m_UsersTypingExpiryTime != 0)
+  {
+    dueTimes.push_back(m_UsersTypingExpiryTime);
+  }
+
+  if (m_Paste)
+  {
+    dueTimes.push_back(0); // continue paste on next tick
+  }
+
+  if (m_ResizePending)
+  {
+    dueTimes.push_back(m_ResizeTime + s_ResizeDebounceMs);
+  }
+
+  if (m_PrefetchPending && !m_PowerSave)
+  {
+    dueTimes.push_back(m_PrefetchTime + s_PrefetchIntervalMs);
+  }
+
+  static const bool developerMode = AppUtil::GetDeveloperMode();
+  if (developerMode)
+  {
+    dueTimes.push_back(m_PerfStatsTime + s_PerfStatsIntervalMs);
+  }
+
+  if (dueTimes.empty()) return -1;
+
+  static const int64_t maxTimeoutMs = 1000;
+  const int64_t remainMs = *std::min_element(dueTimes.begin(), dueTimes.end()) - TimeUtil::GetCurrentTimeMSec();
+  return (int)std::max<int64_t>(0, std::min<int64_t>(remainMs, maxTimeoutMs));
+}
+
+bool UiModel::GetInputLatencyPending()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+  return !m_InputLatencyStarts.empty();
+}
+
+void UiModel::StartInputLatency(PerfStats::Stat p_Stat)
+{
+  // only actions of keys being handled are measured, typing from the earliest key not yet painted,
+  // history actions from the latest, as repeated next chat or page up keys supersede earlier ones
+  if (m_KeyTimeUSec == 0) return;
+
+  if (p_Stat == PerfStats::StatInputTypingUs)
+  {
+    m_InputLatencyStarts.emplace(p_Stat, m_KeyTimeUSec);
+  }
+  else
+  {
+    m_InputLatencyStarts[p_Stat] = m_KeyTimeUSec;
+  }
+}
+
+void UiModel::CompleteInputLatencies()
+{
+  // called after each full draw, typing completes on the first one, history actions once the pane
+  // is populated, those never completing (e.g. offline) are dropped rather than recorded
+  if (m_InputLatencyStarts.empty()) return;
+
+  const int64_t nowUSec = PerfStats::GetTimeUSec();
+  const bool historyPopulated = IsCurrentHistoryPopulated();
+  for (auto it = m_InputLatencyStarts.begin(); it != m_InputLatencyStarts.end(); /* incremented in loop */)
+  {
+    const int64_t latencyUSec = nowUSec - it->second;
+    if ((it->first == PerfStats::StatInputTypingUs) || historyPopulated)
+    {
+      PerfStats::Record(it->first, latencyUSec);
+      Trace::AddSpan("input", it->second, nowUSec, "stat", it->first);
+      it = m_InputLatencyStarts.erase(it);
+    }
+    else if (latencyUSec > s_InputLatencyMaxUs)
+    {
+      it = m_InputLatencyStarts.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+bool UiModel::IsCurrentHistoryPopulated()
+{
+  if (m_CurrentChat == s_ChatNone) return true;
+
+  // completed page requests are kept with their handle reset, pending ones hold it
+  const ChatState& chatState = PeekChatState(m_CurrentChat.first, m_CurrentChat.second);
+  for (const auto& msgFromRequest : chatState.msgFromRequests)
+  {
+    if (msgFromRequest.second) return false;
+  }
+
+  return !chatState.moreMessagesPending;
+}
+
+int64_t UiModel::GetFrameIntervalMs()
+{
+  if (m_PowerSave) return UiConfig::GetParams().powerSaveInterval;
+
+  const int maxFrameRate = UiConfig::GetParams().maxFrameRate;
+  return (maxFrameRate > 0) ? (1000 / maxFrameRate) : 0;
+}
+
 void UiModel::SortChats()
 {
-  std::sort(m_ChatVec.begin(), m_ChatVec.end(),
-            [&](const std::pair<std::string, std::string>& lhs, const std::pair<std::string, std::string>& rhs) -> bool
+  for (const auto& profileChatVec : m_ProfileChatVecs)
   {
-    return m_ChatInfos[lhs.first][lhs.second].lastMessageTime > m_ChatInfos[rhs.first][rhs.second].lastMessageTime;
+    SortProfileChatVec(profileChatVec.first);
+  }
+
+  MergeChatVecs();
+}
+
+void UiModel::SortChats(const std::string& p_ProfileId)
+{
+  // other profiles' lists keep their order, only the merge is redone
+  SortProfileChatVec(p_ProfileId);
+  MergeChatVecs();
+}
+
+void UiModel::SortProfileChatVec(const std::string& p_ProfileId)
+{
+  // full re-sort, only used for bulk updates, otherwise chats are positioned one by one
+  std::vector<ChatKey>& profileChatVec = m_ProfileChatVecs[p_ProfileId];
+  std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[p_ProfileId];
+  std::unordered_map<std::string, int64_t>& profileChatVecTimes = m_ChatVecTimes[p_ProfileId];
+  std::vector<std::pair<int64_t, ChatKey>> sortVec;
+  sortVec.reserve(profileChatVec.size());
+  for (auto& chat : profileChatVec)
+  {
+    const int64_t lastMessageTime = profileChatInfos[chat.second].lastMessageTime;
+    profileChatVecTimes[chat.second] = lastMessageTime;
+    sortVec.push_back(std::make_pair(lastMessageTime, std::move(chat)));
+  }
+
+  std::sort(sortVec.begin(), sortVec.end(),
+            [&](const std::pair<int64_t, ChatKey>& lhs,
+                const std::pair<int64_t, ChatKey>& rhs) -> bool
+  {
+    return IsChatVecBefore(lhs.first, lhs.second, rhs.first, rhs.second);
   });
 
-  if (!m_ChatVec.empty())
+  for (size_t i = 0; i < sortVec.size(); ++i)
+  {
+    profileChatVec[i] = std::move(sortVec[i].second);
+  }
+}
+
+void UiModel::MergeChatVecs()
+{
+  m_ChatVec.clear();
+  if (!m_ChatVecProfileFilter.empty())
+  {
+    auto profileIt = m_ProfileChatVecs.find(m_ChatVecProfileFilter);
+    if (profileIt != m_ProfileChatVecs.end())
+    {
+      m_ChatVec = profileIt->second;
+    }
+  }
+  else
+  {
+    // k-way merge of the sorted profile lists, heap front is the range whose first chat is listed first
+    typedef std::pair<std::vector<ChatKey>::const_iterator, std::vector<ChatKey>::const_iterator> Range;
+    std::vector<Range> ranges;
+    size_t count = 0;
+    for (const auto& profileChatVec : m_ProfileChatVecs)
+    {
+      if (profileChatVec.second.empty()) continue;
+
+      ranges.push_back(Range(profileChatVec.second.begin(), profileChatVec.second.end()));
+      count += profileChatVec.second.size();
+    }
+
+    // *INDENT-OFF*
+    auto isAfter = [&](const Range& lhs, const Range& rhs) -> bool
+    {
+      const ChatKey& lhsChat = *lhs.first;
+      const ChatKey& rhsChat = *rhs.first;
+      return IsChatVecBefore(m_ChatVecTimes.at(rhsChat.first).at(rhsChat.second), rhsChat,
+                             m_ChatVecTimes.at(lhsChat.first).at(lhsChat.second), lhsChat);
+    };
+    // *INDENT-ON*
+
+    m_ChatVec.reserve(count);
+    std::make_heap(ranges.begin(), ranges.end(), isAfter);
+    while (!ranges.empty())
+    {
+      std::pop_heap(ranges.begin(), ranges.end(), isAfter);
+      Range& range = ranges.back();
+      m_ChatVec.push_back(*range.first);
+      if (++range.first == range.second)
+      {
+        ranges.pop_back();
+      }
+      else
+      {
+        std::push_heap(ranges.begin(), ranges.end(), isAfter);
+      }
+    }
+  }
+
+  if (m_CurrentChatIndex != -1)
   {
-    if (m_CurrentChatIndex == -1)
+    const int currentChatIndex = FindChatIndex(m_CurrentChat);
+    if (currentChatIndex != -1)
     {
-      m_CurrentChat = m_ChatVec.at(0);
+      m_CurrentChatIndex = currentChatIndex;
+    }
+    else if (!IsChatVecListed(m_CurrentChat.first) && !m_ChatVec.empty())
+    {
+      m_CurrentChatIndex = 0;
+      m_CurrentChat = m_ChatVec.at(m_CurrentChatIndex);
       OnCurrentChatChanged();
+      SetSelectMessageActive(false);
     }
-    else
+  }
+
+  UpdateCurrentChatIfNotSet();
+}
+
+bool UiModel::IsChatVecListed(const std::string& p_ProfileId) const
+{
+  return m_ChatVecProfileFilter.empty() || (m_ChatVecProfileFilter == p_ProfileId);
+}
+
+void UiModel::ListChatVecProfile(const std::string& p_ProfileId)
+{
+  // chats explicitly selected from another profile clear the profile filter
+  if (IsChatVecListed(p_ProfileId)) return;
+
+  LOG_INFO("profile filter cleared");
+  m_ChatVecProfileFilter.clear();
+  MergeChatVecs();
+  UpdateList();
+}
+
+void UiModel::AddChat(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  std::unordered_map<std::string, int64_t>& profileChatVecTimes = m_ChatVecTimes[p_ProfileId];
+  if (profileChatVecTimes.count(p_ChatId)) return;
+
+  const ChatKey chat(p_ProfileId, p_ChatId);
+  const int64_t lastMessageTime = m_ChatInfos[p_ProfileId][p_ChatId].lastMessageTime;
+  std::vector<ChatKey>& profileChatVec = m_ProfileChatVecs[p_ProfileId];
+  profileChatVec.insert(FindChatVecPos(profileChatVec.begin(), profileChatVec.end(), chat, lastMessageTime), chat);
+  if (IsChatVecListed(p_ProfileId))
+  {
+    auto it = FindChatVecPos(m_ChatVec.begin(), m_ChatVec.end(), chat, lastMessageTime);
+    const int index = it - m_ChatVec.begin();
+    m_ChatVec.insert(it, chat);
+    if (m_CurrentChatIndex >= index)
+    {
+      ++m_CurrentChatIndex;
+    }
+  }
+
+  profileChatVecTimes[p_ChatId] = lastMessageTime;
+  UpdateCurrentChatIfNotSet();
+}
+
+void UiModel::RemoveChat(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  std::unordered_map<std::string, int64_t>& profileChatVecTimes = m_ChatVecTimes[p_ProfileId];
+  auto timeIt = profileChatVecTimes.find(p_ChatId);
+  if (timeIt == profileChatVecTimes.end()) return;
+
+  const ChatKey chat(p_ProfileId, p_ChatId);
+  std::vector<ChatKey>& profileChatVec = m_ProfileChatVecs[p_ProfileId];
+  auto profileIt = FindChatVecPos(profileChatVec.begin(), profileChatVec.end(), chat, timeIt->second);
+  if ((profileIt != profileChatVec.end()) && (*profileIt == chat))
+  {
+    profileChatVec.erase(profileIt);
+  }
+
+  auto it = FindChatVecPos(m_ChatVec.begin(), m_ChatVec.end(), chat, timeIt->second);
+  if ((it != m_ChatVec.end()) && (*it == chat))
+  {
+    const int index = it - m_ChatVec.begin();
+    m_ChatVec.erase(it);
+    if (m_CurrentChatIndex > index)
     {
-      for (size_t i = 0; i < m_ChatVec.size(); ++i)
+      --m_CurrentChatIndex;
+    }
+  }
+
+  profileChatVecTimes.erase(timeIt);
+}
+
+void UiModel::UpdateChatPosition(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  std::unordered_map<std::string, int64_t>& profileChatVecTimes = m_ChatVecTimes[p_ProfileId];
+  auto timeIt = profileChatVecTimes.find(p_ChatId);
+  if (timeIt == profileChatVecTimes.end()) return;
+
+  const int64_t prevTime = timeIt->second;
+  const int64_t lastMessageTime = m_ChatInfos[p_ProfileId][p_ChatId].lastMessageTime;
+  if (lastMessageTime == prevTime) return;
+
+  const ChatKey chat(p_ProfileId, p_ChatId);
+  std::vector<ChatKey>& profileChatVec = m_ProfileChatVecs[p_ProfileId];
+  auto profileFromIt = FindChatVecPos(profileChatVec.begin(), profileChatVec.end(), chat, prevTime);
+  const bool isListed = IsChatVecListed(p_ProfileId);
+  auto fromIt = isListed ? FindChatVecPos(m_ChatVec.begin(), m_ChatVec.end(), chat, prevTime) : m_ChatVec.end();
+  if ((profileFromIt == profileChatVec.end()) || (*profileFromIt != chat) ||
+      (isListed && ((fromIt == m_ChatVec.end()) || (*fromIt != chat))))
+  {
+    LOG_WARNING("chat %s not found in chat vec", p_ChatId.c_str());
+    return;
+  }
+
+  // an update repositions the chat within its profile list, and within the merged list if listed
+  timeIt->second = lastMessageTime;
+  MoveChatVecPos(profileChatVec, profileFromIt, prevTime, lastMessageTime);
+  if (!isListed) return;
+
+  const int fromIndex = fromIt - m_ChatVec.begin();
+  const int toIndex = MoveChatVecPos(m_ChatVec, fromIt, prevTime, lastMessageTime);
+  if (m_CurrentChatIndex == fromIndex)
+  {
+    m_CurrentChatIndex = toIndex;
+  }
+  else if ((toIndex <= m_CurrentChatIndex) && (m_CurrentChatIndex < fromIndex))
+  {
+    ++m_CurrentChatIndex;
+  }
+  else if ((fromIndex < m_CurrentChatIndex) && (m_CurrentChatIndex <= toIndex))
+  {
+    --m_CurrentChatIndex;
+  }
+
+  UpdateCurrentChatIfNotSet();
+}
+
+int UiModel::MoveChatVecPos(std::vector<ChatKey>& p_ChatVec, std::vector<ChatKey>::iterator p_FromIt,
+                            int64_t p_PrevTime, int64_t p_Time)
+{
+  // chat time must already be updated, only the range between old and new position is shifted, which
+  // excludes the chat itself. returns new index.
+  const ChatKey chat = *p_FromIt;
+  const int fromIndex = p_FromIt - p_ChatVec.begin();
+  int toIndex = fromIndex;
+  if (p_Time > p_PrevTime)
+  {
+    auto toIt = FindChatVecPos(p_ChatVec.begin(), p_FromIt, chat, p_Time);
+    toIndex = toIt - p_ChatVec.begin();
+    std::rotate(toIt, p_FromIt, p_FromIt + 1);
+  }
+  else
+  {
+    auto toIt = FindChatVecPos(p_FromIt + 1, p_ChatVec.end(), chat, p_Time);
+    toIndex = (toIt - p_ChatVec.begin()) - 1;
+    std::rotate(p_FromIt, p_FromIt + 1, toIt);
+  }
+
+  return toIndex;
+}
+
+int UiModel::FindChatIndex(const ChatKey& p_Chat)
+{
+  auto profileIt = m_ChatVecTimes.find(p_Chat.first);
+  if (profileIt == m_ChatVecTimes.end()) return -1;
+
+  auto timeIt = profileIt->second.find(p_Chat.second);
+  if (timeIt == profileIt->second.end()) return -1;
+
+  auto it = FindChatVecPos(m_ChatVec.begin(), m_ChatVec.end(), p_Chat, timeIt->second);
+  if ((it == m_ChatVec.end()) || (*it != p_Chat)) return -1;
+
+  return it - m_ChatVec.begin();
+}
+
+std::vector<UiModel::ChatKey>::iterator UiModel::FindChatVecPos(
+  std::vector<ChatKey>::iterator p_First,
+  std::vector<ChatKey>::iterator p_Last,
+  const ChatKey& p_Chat, int64_t p_Time)
+{
+  // chat vec is ordered newest first by (time, chat), returns position of or for p_Chat at p_Time
+  // *INDENT-OFF*
+  return std::lower_bound(p_First, p_Last, p_Chat,
+                          [&](const ChatKey& lhs,
+                              const ChatKey& rhs) -> bool
+  {
+    return IsChatVecBefore(m_ChatVecTimes.at(lhs.first).at(lhs.second), lhs, p_Time, rhs);
+  });
+  // *INDENT-ON*
+}
+
+bool UiModel::IsChatVecBefore(int64_t p_LhsTime, const ChatKey& p_Lhs,
+                              int64_t p_RhsTime, const ChatKey& p_Rhs)
+{
+  // newest first, ties broken by chat content (not handle) for a strict and stable ordering
+  if (p_LhsTime != p_RhsTime) return p_LhsTime > p_RhsTime;
+
+  if (p_Lhs.first != p_Rhs.first) return p_Lhs.first.Str() < p_Rhs.first.Str();
+
+  return p_Lhs.second.Str() < p_Rhs.second.Str();
+}
+
+void UiModel::UpdateCurrentChatIfNotSet()
+{
+  // until a chat is selected the current chat follows the top of the list
+  if ((m_CurrentChatIndex != -1) || m_ChatVec.empty()) return;
+
+  if (m_CurrentChat == m_ChatVec.at(0)) return;
+
+  m_CurrentChat = m_ChatVec.at(0);
+  OnCurrentChatChanged();
+}
+
+std::vector<std::string>::iterator UiModel::FindMessageVecPos(std::vector<std::string>& p_MessageVec,
+                                                               const std::unordered_map<std::string,
+                                                                                        CompactMessage>& p_Messages,
+                                                               const CompactMessage& p_ChatMessage)
+{
+  // message vec is ordered newest first by (timeSent, sequence, id), returns position of or for p_ChatMessage
+  // *INDENT-OFF*
+  return std::lower_bound(p_MessageVec.begin(), p_MessageVec.end(), p_ChatMessage,
+                          [&](const std::string& lhs, const CompactMessage& rhs) -> bool
+  {
+    return ProtocolUtil::IsMessageOlder(rhs, p_Messages.at(lhs));
+  });
+  // *INDENT-ON*
+}
+
+int UiModel::FindMessageIndex(ChatState& p_ChatState, const std::string& p_MsgId)
+{
+  auto msgIt = p_ChatState.messages.find(p_MsgId);
+  if (msgIt == p_ChatState.messages.end()) return -1;
+
+  std::vector<std::string>& messageVec = p_ChatState.messageVec;
+  auto vecIt = FindMessageVecPos(messageVec, p_ChatState.messages, msgIt->second);
+  if ((vecIt == messageVec.end()) || (*vecIt != p_MsgId)) return -1;
+
+  return vecIt - messageVec.begin();
+}
+
+void UiModel::DeleteMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                             const std::vector<std::string>& p_MsgIds)
+{
+  // must be called under lock
+  ChatState& chatState = GetChatState(p_ProfileId, p_ChatId);
+  std::vector<std::string>& messageVec = chatState.messageVec;
+  std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  int& messageOffset = chatState.messageOffset;
+
+  // positions are found by binary search, and removed in a single pass for batches
+  std::vector<int> msgIndexes;
+  msgIndexes.reserve(p_MsgIds.size());
+  for (const auto& msgId : p_MsgIds)
+  {
+    const int msgIndex = FindMessageIndex(chatState, msgId);
+    if (msgIndex != -1)
+    {
+      msgIndexes.push_back(msgIndex);
+    }
+  }
+
+  std::sort(msgIndexes.begin(), msgIndexes.end());
+  msgIndexes.erase(std::unique(msgIndexes.begin(), msgIndexes.end()), msgIndexes.end());
+
+  // keep viewed message in place
+  messageOffset -= std::lower_bound(msgIndexes.begin(), msgIndexes.end(), messageOffset) - msgIndexes.begin();
+
+  if (msgIndexes.size() == 1)
+  {
+    messageVec.erase(messageVec.begin() + msgIndexes.front());
+  }
+  else if (!msgIndexes.empty())
+  {
+    auto indexIt = msgIndexes.begin();
+    int dst = msgIndexes.front();
+    for (int src = dst; src < (int)messageVec.size(); ++src)
+    {
+      if ((indexIt != msgIndexes.end()) && (*indexIt == src))
       {
-        if (m_ChatVec.at(i) == m_CurrentChat)
-        {
-          m_CurrentChatIndex = i;
-        }
+        ++indexIt;
+        continue;
       }
+
+      messageVec[dst++] = std::move(messageVec[src]);
+    }
+
+    messageVec.resize(dst);
+  }
+
+  const bool isFindChat = m_FindActive && (p_ProfileId == m_FindChat.first) && (p_ChatId == m_FindChat.second);
+  bool resetLastMessageId = false;
+  for (const auto& msgId : p_MsgIds)
+  {
+    messages.erase(msgId);
+    chatState.attachmentInfos.erase(msgId);
+    if (isFindChat)
+    {
+      m_FindMatchIds.erase(msgId);
+    }
+
+    resetLastMessageId = resetLastMessageId || (msgId == chatState.lastMessageId);
+  }
+
+  if (resetLastMessageId)
+  {
+    ResetLastMessageId(chatState);
+  }
+
+  if (messageVec.empty())
+  {
+    messageOffset = 0;
+    if (GetSelectMessageActive())
+    {
+      SetSelectMessageActive(false);
     }
   }
+  else if ((messageOffset + 1) > (int)messageVec.size())
+  {
+    messageOffset = (int)messageVec.size() - 1;
+  }
+
+  UpdateChatInfoLastMessageTime(p_ProfileId, p_ChatId);
+  UpdateChatPosition(p_ProfileId, p_ChatId);
+  UpdateList();
+  UpdateHistory();
+}
+
+void UiModel::AddMessageOffset(ChatState& p_ChatState, int p_AddOffset, int p_PageSize)
+{
+  // page anchors are message ids, so paging back down is unaffected by messages inserted meanwhile
+  const int newOffset = std::min(p_ChatState.messageOffset + p_AddOffset, (int)p_ChatState.messageVec.size() - 1);
+  for (int offset = p_ChatState.messageOffset; offset < newOffset; offset += std::max(p_PageSize, 1))
+  {
+    p_ChatState.messageOffsetStack.push(p_ChatState.messageVec.at(offset));
+  }
+
+  p_ChatState.messageOffset = std::max(newOffset, p_ChatState.messageOffset);
 }
 
 std::string UiModel::GetLastMessageId(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[p_ProfileId][p_ChatId];
-  const std::vector<std::string>& messageVec = m_MessageVec[p_ProfileId][p_ChatId];
-  if (messageVec.empty()) return std::string();
+  return PeekChatState(p_ProfileId, p_ChatId).lastMessageId;
+}
+
+void UiModel::UpdateLastMessageId(ChatState& p_ChatState, const CompactMessage& p_ChatMessage)
+{
+  if (p_ChatMessage.timeSent == std::numeric_limits<int64_t>::max()) return; // skip sponsored messages
+
+  std::string& lastMessageId = p_ChatState.lastMessageId;
+  if (!lastMessageId.empty())
+  {
+    auto msgIt = p_ChatState.messages.find(lastMessageId);
+    if (msgIt != p_ChatState.messages.end())
+    {
+      const CompactMessage& lastMessage = msgIt->second;
+      if (!ProtocolUtil::IsMessageOlder(lastMessage, p_ChatMessage))
+      {
+        return;
+      }
+    }
+  }
+
+  lastMessageId = p_ChatMessage.id;
+}
 
-  std::string lastMessageId;
-  for (const auto& messageId : messageVec)
+void UiModel::ResetLastMessageId(ChatState& p_ChatState)
+{
+  // sponsored messages sort first, so this normally stops at the front
+  p_ChatState.lastMessageId.clear();
+  for (const auto& messageId : p_ChatState.messageVec)
   {
-    auto messageIt = messages.find(messageId);
-    if (messageIt == messages.end()) continue;
+    auto msgIt = p_ChatState.messages.find(messageId);
+    if (msgIt == p_ChatState.messages.end()) continue;
 
-    const ChatMessage& lastChatMessage = messageIt->second;
-    if (lastChatMessage.timeSent != std::numeric_limits<int64_t>::max()) // skip sponsored messages
+    if (msgIt->second.timeSent != std::numeric_limits<int64_t>::max()) // skip sponsored messages
     {
-      lastMessageId = messageId;
+      p_ChatState.lastMessageId = messageId;
       break;
     }
   }
-
-  return lastMessageId;
 }
 
 void UiModel::UpdateChatInfoLastMessageTime(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[p_ProfileId][p_ChatId];
+  const std::unordered_map<std::string, CompactMessage>& messages = PeekChatState(p_ProfileId, p_ChatId).messages;
   const std::string lastMessageId = GetLastMessageId(p_ProfileId, p_ChatId);
-  if (lastMessageId.empty()) return;
+  if (lastMessageId.empty())
+  {
+    // chats with messages only in cache are positioned by the newest message received for them
+    auto timeIt = m_CacheOnlyLastMessageTimes.find(ChatKey(p_ProfileId, p_ChatId));
+    if ((timeIt != m_CacheOnlyLastMessageTimes.end()) &&
+        (timeIt->second > m_ChatInfos[p_ProfileId][p_ChatId].lastMessageTime))
+    {
+      UpdateChatInfoLastMessageTime(p_ProfileId, p_ChatId, timeIt->second);
+    }
 
-  const int64_t lastMessageTimeSent = messages.at(lastMessageId).timeSent;
+    return;
+  }
+
+  UpdateChatInfoLastMessageTime(p_ProfileId, p_ChatId, messages.at(lastMessageId).timeSent);
+}
+
+void UiModel::UpdateChatInfoLastMessageTime(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                            int64_t p_LastMessageTime)
+{
+  const int64_t lastMessageTimeSent = p_LastMessageTime;
   std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[p_ProfileId];
   if (profileChatInfos.count(p_ChatId))
   {
-    static const bool mutedPositionByTimestamp = UiConfig::GetBool("muted_position_by_timestamp");
+    const bool mutedPositionByTimestamp = UiConfig::GetParams().mutedPositionByTimestamp;
     if (mutedPositionByTimestamp || !profileChatInfos[p_ChatId].isMuted)
     {
       profileChatInfos[p_ChatId].lastMessageTime = lastMessageTimeSent;
@@ -2046,12 +3640,18 @@ void UiModel::UpdateChatInfoLastMessageTime(const std::string& p_ProfileId, cons
 
 void UiModel::UpdateChatInfoIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[p_ProfileId][p_ChatId];
+  const std::unordered_map<std::string, CompactMessage>& messages = PeekChatState(p_ProfileId, p_ChatId).messages;
   const std::string lastMessageId = GetLastMessageId(p_ProfileId, p_ChatId);
   if (lastMessageId.empty()) return;
 
+  UpdateChatInfoIsUnread(p_ProfileId, p_ChatId, messages.at(lastMessageId));
+}
+
+void UiModel::UpdateChatInfoIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                     const CompactMessage& p_LastMessage)
+{
   bool isRead = true;
-  const ChatMessage& chatMessage = messages.at(lastMessageId);
+  const CompactMessage& chatMessage = p_LastMessage;
   isRead = chatMessage.isOutgoing ? true : chatMessage.isRead;
 
   bool isUnread = !isRead;
@@ -2059,44 +3659,70 @@ void UiModel::UpdateChatInfoIsUnread(const std::string& p_ProfileId, const std::
   std::unordered_map<std::string, ChatInfo>& profileChatInfos = m_ChatInfos[p_ProfileId];
   if (profileChatInfos.count(p_ChatId))
   {
-    static const bool mutedNotifyUnread = UiConfig::GetBool("muted_notify_unread");
+    const bool mutedNotifyUnread = UiConfig::GetParams().mutedNotifyUnread;
     if (mutedNotifyUnread || !profileChatInfos[p_ChatId].isMuted || hasMention)
     {
       if (!profileChatInfos[p_ChatId].isUnread && isUnread)
       {
-        static const bool terminalBellActive = UiConfig::GetBool("terminal_bell_active");
-        static const bool terminalBellInactive = UiConfig::GetBool("terminal_bell_inactive");
+        const bool terminalBellActive = UiConfig::GetParams().terminalBellActive;
+        const bool terminalBellInactive = UiConfig::GetParams().terminalBellInactive;
         bool terminalBell = m_TerminalActive ? terminalBellActive : terminalBellInactive;
         if (terminalBell)
         {
           m_TriggerTerminalBell = true;
         }
 
-        static const bool desktopNotifyActive = UiConfig::GetBool("desktop_notify_active");
-        static const bool desktopNotifyInactive = UiConfig::GetBool("desktop_notify_inactive");
+        const bool desktopNotifyActive = UiConfig::GetParams().desktopNotifyActive;
+        const bool desktopNotifyInactive = UiConfig::GetParams().desktopNotifyInactive;
         bool desktopNotify = m_TerminalActive ? desktopNotifyActive : desktopNotifyInactive;
         if (desktopNotify)
         {
-          DesktopNotifyUnread(GetContactName(p_ProfileId, chatMessage.senderId), chatMessage.text);
+          DesktopNotifyUnread(p_ProfileId, p_ChatId, GetContactName(p_ProfileId, chatMessage.senderId),
+                              chatMessage.text);
         }
       }
     }
 
-    static const bool mutedIndicateUnread = UiConfig::GetBool("muted_indicate_unread");
+    const bool mutedIndicateUnread = UiConfig::GetParams().mutedIndicateUnread;
     if (mutedIndicateUnread || !profileChatInfos[p_ChatId].isMuted || hasMention)
     {
-      profileChatInfos[p_ChatId].isUnread = isUnread;
+      SetChatInfoIsUnread(p_ProfileId, p_ChatId, isUnread);
     }
     else
     {
-      profileChatInfos[p_ChatId].isUnread = false;
+      SetChatInfoIsUnread(p_ProfileId, p_ChatId, false);
     }
   }
 }
 
+void UiModel::SetChatInfoIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsUnread)
+{
+  m_ChatInfos[p_ProfileId][p_ChatId].isUnread = p_IsUnread;
+  if (p_IsUnread)
+  {
+    m_UnreadChats.insert(ChatKey(p_ProfileId, p_ChatId));
+  }
+  else
+  {
+    m_UnreadChats.erase(ChatKey(p_ProfileId, p_ChatId));
+    m_ChatUnreadCounts.erase(ChatKey(p_ProfileId, p_ChatId));
+  }
+}
+
+// lookup without inserting, unknown senders must not add empty entries to contact list
+const ContactInfo& UiModel::GetContactInfo(const std::string& p_ProfileId, const std::string& p_ContactId)
+{
+  static const ContactInfo emptyContactInfo;
+  auto profileIt = m_ContactInfos.find(p_ProfileId);
+  if (profileIt == m_ContactInfos.end()) return emptyContactInfo;
+
+  auto contactIt = profileIt->second.find(p_ContactId);
+  return (contactIt != profileIt->second.end()) ? contactIt->second : emptyContactInfo;
+}
+
 std::string UiModel::GetContactName(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const ContactInfo& contactInfo = m_ContactInfos[p_ProfileId][p_ChatId];
+  const ContactInfo& contactInfo = GetContactInfo(p_ProfileId, p_ChatId);
   const std::string& chatName = contactInfo.name;
   if (contactInfo.isSelf)
   {
@@ -2112,7 +3738,7 @@ std::string UiModel::GetContactName(const std::string& p_ProfileId, const std::s
 
 std::string UiModel::GetContactListName(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const ContactInfo& contactInfo = m_ContactInfos[p_ProfileId][p_ChatId];
+  const ContactInfo& contactInfo = GetContactInfo(p_ProfileId, p_ChatId);
   const std::string& chatName = contactInfo.name;
   if (contactInfo.isSelf)
   {
@@ -2128,7 +3754,7 @@ std::string UiModel::GetContactListName(const std::string& p_ProfileId, const st
 
 std::string UiModel::GetContactPhone(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  const ContactInfo& contactInfo = m_ContactInfos[p_ProfileId][p_ChatId];
+  const ContactInfo& contactInfo = GetContactInfo(p_ProfileId, p_ChatId);
   return contactInfo.phone.empty() ? "" : "+" + contactInfo.phone;
 }
 
@@ -2138,30 +3764,42 @@ bool UiModel::GetChatIsUnread(const std::string& p_ProfileId, const std::string&
   return chatInfo.isUnread; // @todo: handle isUnreadMention, isMuted
 }
 
+int32_t UiModel::GetChatUnreadCount(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  auto countIt = m_ChatUnreadCounts.find(ChatKey(p_ProfileId, p_ChatId));
+  return (countIt != m_ChatUnreadCounts.end()) ? countIt->second : 0;
+}
+
 std::string UiModel::GetChatStatus(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
+  // rendered status is cached per chat, as all its inputs bump m_StatusVersion or contact update time
+  const bool isApplied = ApplyPendingUserStatus(p_ProfileId, p_ChatId);
+  ChatState& chatState = PeekChatState(p_ProfileId, p_ChatId);
+  if (!isApplied && (chatState.chatStatusVersion == m_StatusVersion) &&
+      (chatState.chatStatusContactsTime == m_ContactInfosUpdateTime))
+  {
+    return chatState.chatStatus;
+  }
+
   std::string chatStatus;
-  const std::set<std::string>& usersTyping = m_UsersTyping[p_ProfileId][p_ChatId];
-  const ContactInfo& contactInfo = m_ContactInfos[p_ProfileId][p_ChatId];
+  const std::vector<TypingUser>& usersTyping = chatState.usersTyping;
+  const ContactInfo& contactInfo = GetContactInfo(p_ProfileId, p_ChatId);
   const ChatInfo& chatInfo = m_ChatInfos[p_ProfileId][p_ChatId];
 
   if (!usersTyping.empty())
   {
     if (usersTyping.size() > 1)
     {
-      std::vector<std::string> userIds = ToVector(usersTyping);
-      std::vector<std::string> userNames;
-      for (auto& userId : userIds)
+      for (const auto& typingUser : usersTyping)
       {
-        userNames.push_back(GetContactListName(p_ProfileId, userId));
+        chatStatus += (chatStatus.empty() ? "" : ", ") + GetContactListName(p_ProfileId, typingUser.userId);
       }
 
-      std::string userNamesJoined = StrUtil::Join(userNames, ", ");
-      chatStatus = userNamesJoined + " are typing";
+      chatStatus += " are typing";
     }
     else
     {
-      std::string userId = *usersTyping.begin();
+      const std::string& userId = usersTyping.front().userId;
       if (userId == p_ChatId)
       {
         chatStatus = "typing";
@@ -2173,39 +3811,40 @@ std::string UiModel::GetChatStatus(const std::string& p_ProfileId, const std::st
       }
     }
   }
-  else if (m_UserOnline[p_ProfileId].count(p_ChatId) && !contactInfo.isSelf)
+  else if (!contactInfo.isSelf)
   {
-    if (m_UserOnline[p_ProfileId][p_ChatId])
-    {
-      chatStatus = "online";
-    }
-    else
+    const std::unordered_map<std::string, UserStatus>& userStatuses = m_UserStatuses[p_ProfileId];
+    auto it = userStatuses.find(p_ChatId);
+    if (it != userStatuses.end())
     {
-      int64_t timeSeen = m_UserTimeSeen[p_ProfileId].count(p_ChatId) ? m_UserTimeSeen[p_ProfileId][p_ChatId] : -1;
-      switch (timeSeen)
+      const UserStatus& userStatus = it->second;
+      if (userStatus.isOnline)
       {
-        case TimeSeenNone:
-          chatStatus = "away";
-          break;
+        chatStatus = "online";
+      }
+      else
+      {
+        switch (userStatus.timeSeen)
+        {
+          case TimeSeenNone:
+            chatStatus = "away";
+            break;
 
-        case TimeSeenLastMonth:
-          chatStatus = "seen last month";
-          break;
+          case TimeSeenLastMonth:
+            chatStatus = "seen last month";
+            break;
 
-        case TimeSeenLastWeek:
-          chatStatus = "seen last week";
-          break;
+          case TimeSeenLastWeek:
+            chatStatus = "seen last week";
+            break;
 
-        default:
-          chatStatus = "seen " + TimeUtil::GetTimeString(timeSeen, false /* p_IsExport */);
-          break;
+          default:
+            chatStatus = "seen " + m_StatusTimeFormatter.GetTimeString(userStatus.timeSeen);
+            break;
+        }
       }
     }
   }
-  else
-  {
-    chatStatus = "";
-  }
 
   if (chatInfo.isMuted)
   {
@@ -2219,19 +3858,34 @@ std::string UiModel::GetChatStatus(const std::string& p_ProfileId, const std::st
     }
   }
 
-  if (chatStatus.empty())
-  {
-    return "";
-  }
-  else
-  {
-    return " (" + chatStatus + ")";
-  }
+  chatState.chatStatus = chatStatus.empty() ? "" : (" (" + chatStatus + ")");
+  chatState.chatStatusVersion = m_StatusVersion;
+  chatState.chatStatusContactsTime = m_ContactInfosUpdateTime;
+  return chatState.chatStatus;
 }
 
 void UiModel::OnCurrentChatChanged()
 {
   LOG_TRACE("current chat %s %s", m_CurrentChat.first.c_str(), m_CurrentChat.second.c_str());
+  if (m_PrevCurrentChat != m_CurrentChat)
+  {
+    StartInputLatency(PerfStats::StatInputChatSwitchUs);
+    const ChatKey prevCurrentChat = m_PrevCurrentChat;
+    m_PrevCurrentChat = m_CurrentChat;
+    CancelMessagesRequests(prevCurrentChat.first, prevCurrentChat.second);
+    TrimChatMessages(prevCurrentChat.first, prevCurrentChat.second);
+    StopFind();
+
+    static const size_t maxRecentChats = 16;
+    m_RecentChats.erase(std::remove(m_RecentChats.begin(), m_RecentChats.end(), m_CurrentChat),
+                        m_RecentChats.end());
+    m_RecentChats.push_front(m_CurrentChat);
+    if (m_RecentChats.size() > maxRecentChats)
+    {
+      m_RecentChats.pop_back();
+    }
+  }
+
   SetHistoryInteraction(false);
   UpdateList();
   UpdateStatus();
@@ -2245,6 +3899,153 @@ void UiModel::OnCurrentChatChanged()
   ProtocolSetCurrentChat();
 }
 
+void UiModel::ReleaseMemory()
+{
+  // must be called with lock held, trims chats not in view to a page, refetched from cache when opened
+  int trimCount = 0;
+  for (const auto& profileChatStates : m_ChatStates)
+  {
+    for (const auto& chatState : profileChatStates.second)
+    {
+      if ((int)chatState.second.messageVec.size() <= s_MemoryPressureMaxMessages) continue;
+
+      if (IsHistoryPaneChat(profileChatStates.first, chatState.first)) continue;
+
+      TrimChatMessages(profileChatStates.first, chatState.first, s_MemoryPressureMaxMessages);
+      ++trimCount;
+    }
+  }
+
+  LOG_INFO("memory reclaim trimmed %d chats", trimCount);
+}
+
+void UiModel::UpdateHeapStats()
+{
+  // must be called with lock held, walks all loaded messages so only done for the stats report
+  size_t messagesSize = 0;
+  for (const auto& profileChatStates : m_ChatStates)
+  {
+    for (const auto& chatState : profileChatStates.second)
+    {
+      const std::vector<std::string>& messageVec = chatState.second.messageVec;
+      const std::unordered_map<std::string, CompactMessage>& messages = chatState.second.messages;
+      messagesSize += HeapSize::Of(messageVec) + HeapSize::Nodes(messages) + HeapSize::Buckets(messages);
+      for (const auto& msgId : messageVec)
+      {
+        messagesSize += HeapSize::Of(msgId);
+      }
+
+      for (const auto& message : messages)
+      {
+        messagesSize += HeapSize::Of(message.first) + message.second.GetHeapSize();
+      }
+    }
+  }
+
+  size_t contactsSize = 0;
+  for (const auto& profileContactInfos : m_ContactInfos)
+  {
+    const std::unordered_map<std::string, ContactInfo>& contactInfos = profileContactInfos.second;
+    contactsSize += HeapSize::Nodes(contactInfos) + HeapSize::Buckets(contactInfos);
+    for (const auto& contactInfo : contactInfos)
+    {
+      contactsSize += HeapSize::Of(contactInfo.first) + HeapSize::Of(contactInfo.second.id) +
+        HeapSize::Of(contactInfo.second.name) + HeapSize::Of(contactInfo.second.phone);
+    }
+  }
+
+  size_t trackingSize = m_FetchedMessageIds.GetNodesHeapSize();
+  // *INDENT-OFF*
+  m_FetchedMessageIds.ForEach([&](const std::tuple<std::string, std::string, std::string>& p_Key, int64_t)
+  {
+    trackingSize += HeapSize::Of(std::get<0>(p_Key)) + HeapSize::Of(std::get<1>(p_Key)) +
+      HeapSize::Of(std::get<2>(p_Key));
+  });
+  // *INDENT-ON*
+
+  messagesSize += trackingSize;
+  PerfStats::Set(PerfStats::StatHeapUiMessages, messagesSize);
+  PerfStats::Set(PerfStats::StatHeapUiContacts, contactsSize);
+  PerfStats::Set(PerfStats::StatHeapLayoutCache, m_View->GetLayoutCacheHeapSize());
+  PerfStats::Set(PerfStats::StatHeapCacheMemory, MessageCache::GetMemoryHeapSize());
+}
+
+void UiModel::TrimChatMessages(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  const int maxMessagesInMemory = UiConfig::GetParams().maxMessagesInMemory;
+  if (maxMessagesInMemory <= 0) return;
+
+  TrimChatMessages(p_ProfileId, p_ChatId, maxMessagesInMemory);
+}
+
+void UiModel::TrimChatMessages(const std::string& p_ProfileId, const std::string& p_ChatId, int p_MaxMessages)
+{
+  const int maxMessagesInMemory = p_MaxMessages;
+  if ((p_ProfileId == m_CurrentChat.first) && (p_ChatId == m_CurrentChat.second)) return;
+
+  auto profileIt = m_ChatStates.find(p_ProfileId);
+  if (profileIt == m_ChatStates.end()) return;
+
+  auto chatIt = profileIt->second.find(p_ChatId);
+  if (chatIt == profileIt->second.end()) return;
+
+  ChatState& chatState = chatIt->second;
+  std::vector<std::string>& messageVec = chatState.messageVec;
+  if ((int)messageVec.size() <= maxMessagesInMemory) return;
+
+  TouchHistory(chatState);
+
+  // keep the viewed window plus a page margin, unless scrolled back beyond the limit
+  const int windowCount = chatState.messageOffset + (2 * GetHistoryLines());
+  if (windowCount > maxMessagesInMemory)
+  {
+    chatState.messageOffset = 0;
+    chatState.messageOffsetStack = std::stack<std::string>();
+  }
+
+  const int keepCount = std::max(std::min(windowCount, maxMessagesInMemory), 1);
+  if ((int)messageVec.size() <= keepCount) return;
+
+  std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+  for (auto it = messageVec.begin() + keepCount; it != messageVec.end(); ++it)
+  {
+    messages.erase(*it);
+    chatState.attachmentInfos.erase(*it);
+  }
+
+  messageVec.erase(messageVec.begin() + keepCount, messageVec.end());
+  if (!messages.count(chatState.lastMessageId))
+  {
+    ResetLastMessageId(chatState);
+  }
+
+  // older messages are refetched from cache when needed, starting from the new oldest
+  const CompactMessage& oldestMessage = messages.at(messageVec.back());
+  chatState.oldestMessageId = oldestMessage.id;
+  chatState.oldestMessageTime = oldestMessage.timeSent;
+  chatState.fetchedAllCache = false;
+
+  std::unordered_map<std::string, std::shared_ptr<RequestHandle>>& msgFromRequests = chatState.msgFromRequests;
+  for (auto it = msgFromRequests.begin(); it != msgFromRequests.end(); /* incremented in loop */)
+  {
+    if (!it->first.empty() && ((it->first == oldestMessage.id) || !messages.count(it->first)))
+    {
+      if (it->second)
+      {
+        it->second->Cancel();
+      }
+
+      it = msgFromRequests.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  LOG_TRACE("trimmed %s to %d messages", p_ChatId.c_str(), keepCount);
+}
+
 void UiModel::RequestMessagesCurrentChat()
 {
   if (m_CurrentChat == s_ChatNone) return;
@@ -2256,7 +4057,7 @@ void UiModel::RequestMessagesCurrentChat()
 
 void UiModel::RequestMessagesNextChat()
 {
-  const std::pair<std::string, std::string>& nextChat = GetNextChat();
+  const ChatKey& nextChat = GetNextChat();
   if (nextChat == s_ChatNone) return;
 
   const std::string& profileId = nextChat.first;
@@ -2264,16 +4065,17 @@ void UiModel::RequestMessagesNextChat()
   RequestMessages(profileId, chatId);
 }
 
-void UiModel::RequestMessages(const std::string& p_ProfileId, const std::string& p_ChatId)
+void UiModel::RequestMessages(const std::string& p_ProfileId, const std::string& p_ChatId, int p_PrefetchCount)
 {
-  std::unordered_set<std::string>& msgFromIdsRequested = m_MsgFromIdsRequested[p_ProfileId][p_ChatId];
-  const std::string& oldestMessageId = m_OldestMessageId[p_ProfileId][p_ChatId];
-  std::string fromId = (msgFromIdsRequested.empty() || oldestMessageId.empty()) ? "" : oldestMessageId;
+  ChatState& chatState = PeekChatState(p_ProfileId, p_ChatId);
+  std::unordered_map<std::string, std::shared_ptr<RequestHandle>>& msgFromRequests = chatState.msgFromRequests;
+  const std::string& oldestMessageId = chatState.oldestMessageId;
+  std::string fromId = (msgFromRequests.empty() || oldestMessageId.empty()) ? "" : oldestMessageId;
 
   int historySize = 0;
   if (!oldestMessageId.empty())
   {
-    const std::vector<std::string>& messageVec = m_MessageVec[p_ProfileId][p_ChatId];
+    const std::vector<std::string>& messageVec = chatState.messageVec;
     historySize = messageVec.size();
     for (auto msgIt = messageVec.rbegin(); msgIt != messageVec.rend(); ++msgIt)
     {
@@ -2286,9 +4088,9 @@ void UiModel::RequestMessages(const std::string& p_ProfileId, const std::string&
     }
   }
 
-  int messageOffset = m_MessageOffset[p_ProfileId][p_ChatId];
-  const int maxHistory = m_HomeFetchAll ? 8 : (((GetHistoryLines() * 2) / 3) + 1);
-  const int limit = std::max(0, (messageOffset + 1 + maxHistory - historySize));
+  int messageOffset = chatState.messageOffset;
+  const int maxHistory = m_HomeFetchAll ? 8 : GetHistoryPageSize(p_ProfileId, p_ChatId);
+  const int limit = std::max(0, (messageOffset + 1 + maxHistory + p_PrefetchCount - historySize));
   if (limit == 0)
   {
     LOG_TRACE("no message to request %d + %d - %d >= %d",
@@ -2296,14 +4098,16 @@ void UiModel::RequestMessages(const std::string& p_ProfileId, const std::string&
     return;
   }
 
-  if (msgFromIdsRequested.find(fromId) != msgFromIdsRequested.end())
+  if (msgFromRequests.find(fromId) != msgFromRequests.end())
   {
     LOG_TRACE("get messages from %s already requested", fromId.c_str());
     return;
   }
-  else
+
+  if (chatState.moreMessagesPending)
   {
-    msgFromIdsRequested.insert(fromId);
+    LOG_TRACE("get messages from %s pending more chunks", fromId.c_str());
+    return;
   }
 
   const int minLimit = 12; // hack: up to 10 tgchat messages may share same timestamp
@@ -2312,7 +4116,320 @@ void UiModel::RequestMessages(const std::string& p_ProfileId, const std::string&
   getMessagesRequest->fromMsgId = fromId;
   getMessagesRequest->limit = std::max(limit, minLimit);
   LOG_TRACE("request messages in %s from %s limit %d", p_ChatId.c_str(), fromId.c_str(), getMessagesRequest->limit);
-  SendProtocolRequest(p_ProfileId, getMessagesRequest);
+  msgFromRequests[fromId] = SendProtocolAsyncRequest(p_ProfileId, getMessagesRequest);
+}
+
+void UiModel::CompleteMessagesRequest(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify)
+{
+  ChatState& chatState = GetChatState(p_ProfileId, p_NewMessagesNotify.chatId);
+  auto requestIt = chatState.msgFromRequests.find(p_NewMessagesNotify.fromMsgId);
+  if ((requestIt == chatState.msgFromRequests.end()) || !requestIt->second) return;
+
+  // replies from protocols not echoing the request id are matched on chat and from id of history pages
+  if (p_NewMessagesNotify.more) return;
+
+  std::shared_ptr<RequestHandle>& requestHandle = requestIt->second;
+  const int64_t requestId = p_NewMessagesNotify.requestId;
+  if ((requestId != 0) ? (requestId != requestHandle->GetRequestId()) : !p_NewMessagesNotify.sequence) return;
+
+  // entry is kept, deduplicating further requests for the page
+  const int64_t elapsedUSec = requestHandle->GetElapsedUSec();
+  PerfStats::Record(PerfStats::StatHistoryFetchUs, elapsedUSec);
+  LOG_TRACE("get messages %lld in %s from %s done in %lld us", requestHandle->GetRequestId(),
+            p_NewMessagesNotify.chatId.c_str(), p_NewMessagesNotify.fromMsgId.c_str(), elapsedUSec);
+  requestHandle->Complete();
+  requestHandle.reset();
+
+  PageSizer& pageSizer = m_PageSizers[p_ProfileId];
+  pageSizer.latencyUs = (pageSizer.latencyUs == 0) ? elapsedUSec : (((7 * pageSizer.latencyUs) + elapsedUSec) / 8);
+}
+
+int UiModel::GetHistoryPageSize(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  // one screen per round trip for fast (cache) fetches, one more per s_PageScreenLatencyUs of latency
+  PageSizer& pageSizer = m_PageSizers[p_ProfileId];
+  const int historyLines = std::max(GetHistoryLines(), 1);
+  if ((p_ProfileId == m_CurrentChat.first) && (p_ChatId == m_CurrentChat.second))
+  {
+    // message height is sampled from panes filled with messages, older ones remaining above
+    const ChatState& chatState = PeekChatState(p_ProfileId, p_ChatId);
+    const int showCount = m_View->GetHistoryShowCount();
+    if ((showCount > 0) && ((chatState.messageOffset + showCount) < (int)chatState.messageVec.size()))
+    {
+      const double linesPerMessage = (double)historyLines / showCount;
+      pageSizer.linesPerMessage = (pageSizer.linesPerMessage == 0) ? linesPerMessage
+                                  : (((7 * pageSizer.linesPerMessage) + linesPerMessage) / 8);
+    }
+  }
+
+  static const double defaultLinesPerMessage = 1.5;
+  const double linesPerMessage = (pageSizer.linesPerMessage > 0) ? pageSizer.linesPerMessage : defaultLinesPerMessage;
+  const int screens = 1 + (int)std::min<int64_t>(pageSizer.latencyUs / s_PageScreenLatencyUs, s_PageMaxScreens - 1);
+  const int pageSize = (int)((historyLines * screens) / linesPerMessage) + 1;
+  return std::min(pageSize, s_PageMaxMessages);
+}
+
+void UiModel::CancelMessagesRequests(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  auto profileIt = m_ChatStates.find(p_ProfileId);
+  if (profileIt == m_ChatStates.end()) return;
+
+  auto chatIt = profileIt->second.find(p_ChatId);
+  if (chatIt == profileIt->second.end()) return;
+
+  // older pages of a chat left are stale, its first page is kept like for prefetched chats
+  std::unordered_map<std::string, std::shared_ptr<RequestHandle>>& msgFromRequests = chatIt->second.msgFromRequests;
+  for (auto it = msgFromRequests.begin(); it != msgFromRequests.end(); /* incremented in loop */)
+  {
+    if (!it->first.empty() && it->second)
+    {
+      LOG_TRACE("cancel get messages %lld in %s from %s", it->second->GetRequestId(), p_ChatId.c_str(),
+                it->first.c_str());
+      it->second->Cancel();
+      PerfStats::Add(PerfStats::StatRequestsCancelled, 1);
+      it = msgFromRequests.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void UiModel::Prefetch()
+{
+  // low priority background requests, issued on idle ui ticks at most once per interval
+  if (!m_PrefetchPending) return;
+
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  if ((nowTime - m_PrefetchTime) < s_PrefetchIntervalMs) return;
+
+  // re-armed by the next service message or key press, so the ui loop may sleep when idle
+  m_PrefetchPending = false;
+  m_PrefetchTime = nowTime;
+  if (m_CurrentChat == s_ChatNone) return;
+
+  // next older page of current chat, for instant page up
+  RequestMessages(m_CurrentChat.first, m_CurrentChat.second, m_View->GetHistoryShowCount());
+
+  // first page of one likely next chat not yet requested
+  const int prefetchChatCount = UiConfig::GetParams().prefetchChatCount;
+  const std::vector<ChatKey> prefetchChats = GetPrefetchChats(prefetchChatCount);
+  for (const auto& chat : prefetchChats)
+  {
+    const ChatState& chatState = PeekChatState(chat.first, chat.second);
+    if (!chatState.messageVec.empty() || !chatState.msgFromRequests.empty()) continue;
+
+    LOG_TRACE("prefetch %s", chat.second.c_str());
+    RequestMessages(chat.first, chat.second);
+    RequestUserStatus(chat);
+    break;
+  }
+}
+
+void UiModel::CheckResume()
+{
+  // wall clock keeps running while system is suspended, steady clock does not, so a jump in their
+  // difference is time spent suspended (or a wall clock adjustment, for which reconnect is harmless)
+  const int64_t clockOffset = TimeUtil::GetCurrentTimeMSec() - TimeUtil::GetSteadyTimeMSec();
+  const int64_t suspendMs = clockOffset - m_ClockOffset;
+  m_ClockOffset = clockOffset;
+  if (suspendMs < s_ResumeMinSuspendMs) return;
+
+  LOG_INFO("resume after %lld ms suspend", (long long)suspendMs);
+  HandleResume();
+}
+
+void UiModel::HandleResume()
+{
+  // connections are likely dead after suspend, reconnect rather than wait for keepalive timeouts
+  for (auto& protocol : m_Protocols)
+  {
+    SendProtocolRequest(protocol.first, std::make_shared<ReconnectRequest>());
+  }
+
+  // newest messages of current and unread chats are refetched, queued after the reconnect of each
+  // protocol, with requests to all protocols in flight at once
+  int catchUpCount = 0;
+  if (m_CurrentChat != s_ChatNone)
+  {
+    RequestLatestMessages(m_CurrentChat);
+    ++catchUpCount;
+  }
+
+  for (const auto& chat : m_ChatVec)
+  {
+    if (catchUpCount >= s_ResumeMaxCatchUpChats) break;
+
+    if ((chat == m_CurrentChat) || !GetChatIsUnread(chat.first, chat.second)) continue;
+
+    RequestLatestMessages(chat);
+    ++catchUpCount;
+  }
+
+  LOG_DEBUG("resume catch-up of %d chats", catchUpCount);
+}
+
+void UiModel::RequestLatestMessages(const ChatKey& p_Chat)
+{
+  // the first page entry is kept once completed, and only replaced when not in flight
+  ChatState& chatState = PeekChatState(p_Chat.first, p_Chat.second);
+  std::shared_ptr<RequestHandle>& requestHandle = chatState.msgFromRequests[""];
+  if (requestHandle) return;
+
+  std::shared_ptr<GetMessagesRequest> getMessagesRequest = std::make_shared<GetMessagesRequest>();
+  getMessagesRequest->chatId = p_Chat.second;
+  getMessagesRequest->fromMsgId = "";
+  getMessagesRequest->limit = GetHistoryPageSize(p_Chat.first, p_Chat.second);
+  LOG_TRACE("request latest messages in %s limit %d", p_Chat.second.c_str(), getMessagesRequest->limit);
+  requestHandle = SendProtocolAsyncRequest(p_Chat.first, getMessagesRequest);
+}
+
+void UiModel::PrefetchAttachments()
+{
+  // attachment downloads are initiated here, based on viewport of last draw, never by the history view
+  const int showCount = m_View->GetHistoryShowCount();
+  if (!m_AttachmentPrefetchPending && (showCount == m_AttachmentPrefetchShowCount)) return;
+
+  m_AttachmentPrefetchPending = false;
+  m_AttachmentPrefetchShowCount = showCount;
+  if (m_CurrentChat == s_ChatNone) return;
+
+  static const int attachmentPrefetch = AppConfig::GetNum("attachment_prefetch");
+  if (attachmentPrefetch == AttachmentPrefetchNone) return;
+
+  std::set<std::string> mediaTypes;
+  for (const auto& mediaType : StrUtil::Split(UiConfig::GetStr("attachment_prefetch_types"), ','))
+  {
+    if (!mediaType.empty())
+    {
+      mediaTypes.insert(mediaType);
+    }
+  }
+
+  const int offset = PeekChatState(m_CurrentChat.first, m_CurrentChat.second).messageOffset;
+  bool started = false;
+  if (attachmentPrefetch == AttachmentPrefetchSelected)
+  {
+    if (GetSelectMessageActive())
+    {
+      started = PrefetchChatAttachments(m_CurrentChat, offset, offset + 1, DownloadFilePriorityVisible,
+                                        std::set<std::string>());
+    }
+  }
+  else if (attachmentPrefetch == AttachmentPrefetchAll)
+  {
+    // visible messages first, then nearest older and newer, then first screen of likely next chats
+    const int distance = UiConfig::GetParams().attachmentPrefetchDistance;
+    const int viewEnd = offset + std::max(showCount, 1);
+    started |= PrefetchChatAttachments(m_CurrentChat, offset, viewEnd, DownloadFilePriorityVisible, mediaTypes);
+    started |= PrefetchChatAttachments(m_CurrentChat, viewEnd, viewEnd + distance, DownloadFilePriorityPrefetch,
+                                       mediaTypes);
+    started |= PrefetchChatAttachments(m_CurrentChat, offset - distance, offset, DownloadFilePriorityPrefetch,
+                                       mediaTypes);
+
+    const std::vector<ChatKey> prefetchChats = GetPrefetchChats(UiConfig::GetParams().prefetchChatCount);
+    for (const auto& chat : prefetchChats)
+    {
+      started |= PrefetchChatAttachments(chat, 0, showCount, DownloadFilePriorityPrefetch, mediaTypes);
+    }
+  }
+
+  if (started)
+  {
+    // show downloading status, without triggering another prefetch pass
+    m_View->SetHistoryDirty(true);
+  }
+}
+
+bool UiModel::PrefetchChatAttachments(const ChatKey& p_Chat, int p_Begin, int p_End,
+                                      DownloadFilePriority p_Priority, const std::set<std::string>& p_MediaTypes)
+{
+  // must be called with lock held, messages are newest first
+  ChatState& chatState = PeekChatState(p_Chat.first, p_Chat.second);
+  const int end = std::min<int>(p_End, chatState.messageVec.size());
+  bool started = false;
+  for (int i = std::max(p_Begin, 0); i < end; ++i)
+  {
+    const std::string& msgId = chatState.messageVec.at(i);
+    auto mit = chatState.messages.find(msgId);
+    if ((mit == chatState.messages.end()) || mit->second.fileInfo.empty()) continue;
+
+    const AttachmentInfo& attachmentInfo = GetAttachmentInfo(chatState, mit->second);
+    if ((attachmentInfo.fileInfo.fileStatus != FileStatusNotDownloaded) || attachmentInfo.isDownloaded) continue;
+
+    if (!p_MediaTypes.empty() && (p_MediaTypes.count(GetAttachmentMediaType(attachmentInfo.fileInfo)) == 0)) continue;
+
+    if (!IsAttachmentDownloadable(attachmentInfo.fileInfo)) continue;
+
+    const std::string fileId = attachmentInfo.fileInfo.fileId;
+    DownloadAttachment(p_Chat.first, p_Chat.second, msgId, fileId, DownloadFileActionNone, p_Priority);
+    started = true;
+  }
+
+  return started;
+}
+
+std::string UiModel::GetAttachmentMediaType(const FileInfo& p_FileInfo)
+{
+  // mime type if known, otherwise guessed from file extension or protocol placeholder name
+  const std::string mimeType = p_FileInfo.fileType.substr(0, p_FileInfo.fileType.find('/'));
+  if ((mimeType == "image") || (mimeType == "video") || (mimeType == "audio")) return mimeType;
+
+  static const std::map<std::string, std::string> nameTypes =
+  {
+    { "[Photo]", "image" }, { "[Sticker]", "image" }, { "[Video]", "video" }, { "[VideoNote]", "video" },
+    { "[VoiceNote]", "audio" }, { ".jpg", "image" }, { ".jpeg", "image" }, { ".png", "image" },
+    { ".gif", "image" }, { ".webp", "image" }, { ".heic", "image" }, { ".mp4", "video" }, { ".mov", "video" },
+    { ".mkv", "video" }, { ".webm", "video" }, { ".ogg", "audio" }, { ".oga", "audio" }, { ".opus", "audio" },
+    { ".mp3", "audio" }, { ".m4a", "audio" }, { ".wav", "audio" },
+  };
+
+  auto it = nameTypes.find(p_FileInfo.filePath);
+  if (it == nameTypes.end())
+  {
+    it = nameTypes.find(StrUtil::ToLower(FileUtil::GetFileExt(p_FileInfo.filePath)));
+  }
+
+  return (it != nameTypes.end()) ? it->second : "document";
+}
+
+std::vector<UiModel::ChatKey> UiModel::GetPrefetchChats(int p_MaxCount)
+{
+  // recently viewed chats first, then unread chats and finally the top of chat list
+  std::vector<ChatKey> chats;
+  if (p_MaxCount <= 0) return chats;
+
+  std::set<ChatKey> addedChats;
+  addedChats.insert(m_CurrentChat);
+  // *INDENT-OFF*
+  auto addChat = [&](const ChatKey& p_Chat) -> bool
+  {
+    if ((FindChatIndex(p_Chat) != -1) && addedChats.insert(p_Chat).second)
+    {
+      chats.push_back(p_Chat);
+    }
+
+    return ((int)chats.size() < p_MaxCount);
+  };
+  // *INDENT-ON*
+
+  for (const auto& chat : m_RecentChats)
+  {
+    if (!addChat(chat)) return chats;
+  }
+
+  for (const auto& chat : m_UnreadChats)
+  {
+    if (!addChat(chat)) return chats;
+  }
+
+  for (const auto& chat : m_ChatVec)
+  {
+    if (!addChat(chat)) return chats;
+  }
+
+  return chats;
 }
 
 void UiModel::RequestUserStatusCurrentChat()
@@ -2324,18 +4441,20 @@ void UiModel::RequestUserStatusCurrentChat()
 
 void UiModel::RequestUserStatusNextChat()
 {
-  const std::pair<std::string, std::string>& nextChat = GetNextChat();
+  const ChatKey& nextChat = GetNextChat();
   if (nextChat == s_ChatNone) return;
 
   RequestUserStatus(nextChat);
 }
 
-void UiModel::RequestUserStatus(const std::pair<std::string, std::string>& p_Chat)
+void UiModel::RequestUserStatus(const ChatKey& p_Chat)
 {
-  static std::set<std::pair<std::string, std::string>> requestedStatuses;
-  if (requestedStatuses.count(p_Chat)) return;
+  // skip users with a status requested or received within ttl
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  auto it = m_UserStatusTimes.find(p_Chat);
+  if ((it != m_UserStatusTimes.end()) && ((nowTime - it->second) < s_UserStatusTtlMs)) return;
 
-  requestedStatuses.insert(p_Chat);
+  m_UserStatusTimes[p_Chat] = nowTime;
 
   const std::string& profileId = p_Chat.first;
   const std::string& chatId = p_Chat.second;
@@ -2346,9 +4465,79 @@ void UiModel::RequestUserStatus(const std::pair<std::string, std::string>& p_Cha
   SendProtocolRequest(profileId, getStatusRequest);
 }
 
+bool UiModel::IsUserStatusVisible(const std::string& p_ProfileId, const std::string& p_UserId)
+{
+  // status view shows presence of the current chat user only
+  return (p_ProfileId == m_CurrentChat.first) && (p_UserId == m_CurrentChat.second);
+}
+
+void UiModel::ApplyUserStatus(const std::string& p_ProfileId, const std::string& p_UserId,
+                              const UserStatus& p_UserStatus)
+{
+  UserStatus& userStatus = m_UserStatuses[p_ProfileId][p_UserId];
+  userStatus.isOnline = p_UserStatus.isOnline;
+  if (p_UserStatus.timeSeen != -1)
+  {
+    userStatus.timeSeen = p_UserStatus.timeSeen;
+  }
+}
+
+bool UiModel::ApplyPendingUserStatus(const std::string& p_ProfileId, const std::string& p_UserId)
+{
+  auto pit = m_PendingUserStatuses.find(p_ProfileId);
+  if (pit == m_PendingUserStatuses.end()) return false;
+
+  auto uit = pit->second.find(p_UserId);
+  if (uit == pit->second.end()) return false;
+
+  ApplyUserStatus(p_ProfileId, p_UserId, uit->second);
+  pit->second.erase(uit);
+  return true;
+}
+
+void UiModel::ExpireUsersTyping()
+{
+  // typing stops may be missed, e.g. when a remote client goes offline
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  m_UsersTypingExpiryTime = 0;
+  for (auto& profileChatStates : m_ChatStates)
+  {
+    for (auto& chatStatePair : profileChatStates.second)
+    {
+      std::vector<TypingUser>& usersTyping = chatStatePair.second.usersTyping;
+      if (usersTyping.empty()) continue;
+
+      const size_t count = usersTyping.size();
+      // *INDENT-OFF*
+      usersTyping.erase(std::remove_if(usersTyping.begin(), usersTyping.end(),
+                                       [&](const TypingUser& p_TypingUser)
+                                       {
+                                         return p_TypingUser.expiryTime <= nowTime;
+                                       }), usersTyping.end());
+      // *INDENT-ON*
+      for (const auto& typingUser : usersTyping)
+      {
+        if ((m_UsersTypingExpiryTime == 0) || (typingUser.expiryTime < m_UsersTypingExpiryTime))
+        {
+          m_UsersTypingExpiryTime = typingUser.expiryTime;
+        }
+      }
+
+      if (usersTyping.size() == count) continue;
+
+      LOG_TRACE("expired users typing in %s", chatStatePair.first.c_str());
+      chatStatePair.second.chatStatusVersion = 0;
+      if ((profileChatStates.first == m_CurrentChat.first) && (chatStatePair.first == m_CurrentChat.second))
+      {
+        UpdateStatus();
+      }
+    }
+  }
+}
+
 void UiModel::ProtocolSetCurrentChat()
 {
-  static std::pair<std::string, std::string> lastCurrentChat;
+  static ChatKey lastCurrentChat;
   if (lastCurrentChat != m_CurrentChat)
   {
     lastCurrentChat = m_CurrentChat;
@@ -2364,7 +4553,7 @@ void UiModel::ProtocolSetCurrentChat()
 
 void UiModel::SetStatusOnline(const std::string& p_ProfileId, bool p_IsOnline)
 {
-  static const bool onlineStatusShare = UiConfig::GetBool("online_status_share");
+  const bool onlineStatusShare = UiConfig::GetParams().onlineStatusShare;
   if (!onlineStatusShare) return;
 
   std::shared_ptr<SetStatusRequest> setStatusRequest = std::make_shared<SetStatusRequest>();
@@ -2388,6 +4577,48 @@ void UiModel::RequestContacts()
   }
 }
 
+void UiModel::RequestSearchMessages(const std::string& p_Query)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_ModelMutex);
+    m_SearchQuery = p_Query;
+    m_SearchResults.clear();
+    m_SearchResultsUpdateTime = TimeUtil::GetCurrentTimeMSec();
+    CancelSearchRequests();
+  }
+
+  // server search runs in parallel with local search, its pages are merged in as they arrive
+  static const int searchLimit = 100;
+  static const size_t serverSearchMinLength = 3; // avoid server queries for each of the first keystrokes
+  const bool serverSearch = (StrUtil::ToWString(p_Query).size() >= serverSearchMinLength);
+  for (auto& protocol : m_Protocols)
+  {
+    if (serverSearch && protocol.second->HasFeature(FeatureServerSearch))
+    {
+      LOG_TRACE("search server messages %s", protocol.first.c_str());
+      std::shared_ptr<SearchMessagesRequest> searchMessagesRequest = std::make_shared<SearchMessagesRequest>();
+      searchMessagesRequest->query = p_Query;
+      searchMessagesRequest->limit = searchLimit;
+      std::shared_ptr<RequestHandle> requestHandle = protocol.second->SendAsyncRequest(searchMessagesRequest);
+      std::unique_lock<std::mutex> lock(m_ModelMutex);
+      m_SearchRequests[protocol.first] = requestHandle;
+    }
+
+    LOG_TRACE("search messages %s", protocol.first.c_str());
+    MessageCache::Search(protocol.first, p_Query, searchLimit, true /*p_Sync*/);
+  }
+}
+
+void UiModel::CancelSearchRequests()
+{
+  for (auto& searchRequest : m_SearchRequests)
+  {
+    searchRequest.second->Cancel();
+  }
+
+  m_SearchRequests.clear();
+}
+
 void UiModel::SetRunning(bool p_Running)
 {
   m_Running = p_Running;
@@ -2406,6 +4637,7 @@ void UiModel::UpdateList()
 
 void UiModel::UpdateStatus()
 {
+  ++m_StatusVersion;
   m_View->SetStatusDirty(true);
   m_View->SetEntryDirty(true);
 }
@@ -2414,6 +4646,7 @@ void UiModel::UpdateHistory()
 {
   m_View->SetHistoryDirty(true);
   m_View->SetEntryDirty(true);
+  m_AttachmentPrefetchPending = true;
 }
 
 void UiModel::UpdateHelp()
@@ -2429,23 +4662,48 @@ void UiModel::UpdateEntry()
 
 std::wstring& UiModel::GetEntryStr()
 {
-  return m_EntryStr[m_CurrentChat.first][m_CurrentChat.second];
+  return PeekChatState(m_CurrentChat.first, m_CurrentChat.second).entryStr;
 }
 
 int& UiModel::GetEntryPos()
 {
-  return m_EntryPos[m_CurrentChat.first][m_CurrentChat.second];
+  return PeekChatState(m_CurrentChat.first, m_CurrentChat.second).entryPos;
 }
 
-std::vector<std::pair<std::string, std::string>>& UiModel::GetChatVec()
+std::vector<UiModel::ChatKey>& UiModel::GetChatVec()
 {
   return m_ChatVec;
 }
 
-std::unordered_map<std::string, std::unordered_map<std::string, ContactInfo>> UiModel::GetContactInfos()
+std::shared_ptr<const UiModel::ContactSnapshot> UiModel::GetContactSnapshot()
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
-  return m_ContactInfos;
+  if (m_ContactSnapshot && (m_ContactSnapshot->updateTime == m_ContactInfosUpdateTime)) return m_ContactSnapshot;
+
+  std::shared_ptr<ContactSnapshot> contactSnapshot = std::make_shared<ContactSnapshot>();
+  contactSnapshot->updateTime = m_ContactInfosUpdateTime;
+  contactSnapshot->contactInfos = m_ContactInfos;
+
+  // index points into the snapshot's own map, which is never modified once published
+  for (const auto& profileContactInfos : contactSnapshot->contactInfos)
+  {
+    for (const auto& contactInfo : profileContactInfos.second)
+    {
+      if (contactInfo.second.name.empty()) continue;
+
+      contactSnapshot->nameIndex.push_back(std::make_pair(profileContactInfos.first, &contactInfo.second));
+    }
+  }
+
+  std::sort(contactSnapshot->nameIndex.begin(), contactSnapshot->nameIndex.end(),
+            [&](const std::pair<std::string, const ContactInfo*>& lhs,
+                const std::pair<std::string, const ContactInfo*>& rhs) -> bool
+  {
+    return lhs.second->name < rhs.second->name;
+  });
+
+  m_ContactSnapshot = contactSnapshot;
+  return m_ContactSnapshot;
 }
 
 int64_t UiModel::GetContactInfosUpdateTime()
@@ -2454,30 +4712,82 @@ int64_t UiModel::GetContactInfosUpdateTime()
   return m_ContactInfosUpdateTime;
 }
 
-std::pair<std::string, std::string>& UiModel::GetCurrentChat()
+int64_t UiModel::GetContactInfosUpdateTimeNoLock()
+{
+  return m_ContactInfosUpdateTime;
+}
+
+uint64_t UiModel::GetStatusVersionNoLock()
+{
+  return m_StatusVersion;
+}
+
+std::unordered_map<std::string, std::vector<std::pair<std::string, ChatMessage>>> UiModel::GetSearchResults()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+  return m_SearchResults;
+}
+
+int64_t UiModel::GetSearchResultsUpdateTime()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+  return m_SearchResultsUpdateTime;
+}
+
+UiModel::ChatKey& UiModel::GetCurrentChat()
 {
   return m_CurrentChat;
 }
 
+UiModel::ChatKey UiModel::GetHistoryPaneChat(int p_PaneIndex)
+{
+  // pane zero is current chat, following panes show most recently viewed other chats
+  if (p_PaneIndex == 0) return m_CurrentChat;
+
+  int paneIndex = 0;
+  for (const auto& chat : m_RecentChats)
+  {
+    if ((chat == m_CurrentChat) || (FindChatIndex(chat) == -1)) continue;
+
+    if (++paneIndex == p_PaneIndex) return chat;
+  }
+
+  return s_ChatNone;
+}
+
+bool UiModel::IsHistoryPaneChat(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  const int paneCount = m_View->GetHistoryPaneCount();
+  for (int paneIndex = 0; paneIndex < paneCount; ++paneIndex)
+  {
+    const ChatKey chat = GetHistoryPaneChat(paneIndex);
+    if ((chat.first == p_ProfileId) && (chat.second == p_ChatId)) return true;
+  }
+
+  return false;
+}
+
 int& UiModel::GetCurrentChatIndex()
 {
   return m_CurrentChatIndex;
 }
 
-std::unordered_map<std::string, ChatMessage>& UiModel::GetMessages(const std::string& p_ProfileId,
-                                                                   const std::string& p_ChatId)
+UiModel::ChatState& UiModel::GetChatState(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  return m_Messages[p_ProfileId][p_ChatId];
+  // any mutable access is assumed to change the history shown, invalidating rendered frames of it
+  ChatState& chatState = m_ChatStates[p_ProfileId][p_ChatId];
+  TouchHistory(chatState);
+  return chatState;
 }
 
-std::vector<std::string>& UiModel::GetMessageVec(const std::string& p_ProfileId, const std::string& p_ChatId)
+UiModel::ChatState& UiModel::PeekChatState(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  return m_MessageVec[p_ProfileId][p_ChatId];
+  return m_ChatStates[p_ProfileId][p_ChatId];
 }
 
-int& UiModel::GetMessageOffset(const std::string& p_ProfileId, const std::string& p_ChatId)
+void UiModel::TouchHistory(ChatState& p_ChatState)
 {
-  return m_MessageOffset[p_ProfileId][p_ChatId];
+  p_ChatState.historyVersion = ++m_HistoryVersion;
 }
 
 bool UiModel::GetSelectMessageActive()
@@ -2533,6 +4843,24 @@ void UiModel::SetEditMessageActive(bool p_EditMessageActive)
   UpdateHelp();
 }
 
+bool UiModel::GetFindActive()
+{
+  return m_FindActive;
+}
+
+std::wstring UiModel::GetFindEntryStr()
+{
+  const std::string matchCount = std::to_string(m_FindMatchIds.size()) + (m_FindOlderPending ? "..." : "");
+  return StrUtil::ToWString("Find (" + matchCount + "): ") + m_FindQuery;
+}
+
+std::wstring UiModel::GetFindHighlight()
+{
+  if (!m_FindActive || (m_FindChat != m_CurrentChat)) return std::wstring();
+
+  return StrUtil::ToWString(m_FindLowerQuery);
+}
+
 void UiModel::SetHelpOffset(int p_HelpOffset)
 {
   m_HelpOffset = p_HelpOffset;
@@ -2563,9 +4891,11 @@ void UiModel::SetTerminalActive(bool p_TerminalActive)
   if (p_TerminalActive != m_TerminalActive)
   {
     m_TerminalActive = p_TerminalActive;
-    LOG_TRACE("set terminal active %d", m_TerminalActive);
+    AppUtil::SetTerminalActive(m_TerminalActive);
+    m_PowerSave = !m_TerminalActive && (UiConfig::GetParams().powerSaveInterval > 0);
+    LOG_TRACE("set terminal active %d power save %d", m_TerminalActive, (bool)m_PowerSave);
 
-    static const bool onlineStatusDynamic = UiConfig::GetBool("online_status_dynamic");
+    const bool onlineStatusDynamic = UiConfig::GetParams().onlineStatusDynamic;
     if (onlineStatusDynamic)
     {
       for (auto& protocol : m_Protocols)
@@ -2577,12 +4907,289 @@ void UiModel::SetTerminalActive(bool p_TerminalActive)
 
     if (m_TerminalActive)
     {
+      CheckResume(); // terminal focus is often the first event after lid open
       UpdateHistory(); // refresh history as we may need to mark messages as read
     }
   }
 }
 
-void UiModel::DesktopNotifyUnread(const std::string& p_Name, const std::string& p_Text)
+void UiModel::StartExport()
+{
+  // export runs in the background, progress is shown in top bar
+  std::string exportDir = AppConfig::GetStr("cache_export_dir");
+  if (exportDir.empty())
+  {
+    exportDir = FileUtil::GetApplicationDir() + "/export";
+  }
+
+  const std::string exportFormat = AppConfig::GetStr("cache_export_format");
+  if (!MessageCache::IsExportFormat(exportFormat))
+  {
+    LOG_WARNING("export not started, unsupported format %s", exportFormat.c_str());
+    return;
+  }
+
+  FileUtil::MkDir(exportDir);
+  if (MessageCache::StartExport(exportDir, exportFormat, true /* p_Incremental */))
+  {
+    LOG_INFO("export started to %s", exportDir.c_str());
+  }
+}
+
+void UiModel::BackfillChat()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+
+  if (m_CurrentChat == s_ChatNone) return;
+
+  // toggle full history load of current chat, it proceeds in the background
+  auto backfillIt = m_BackfillStates.find(m_CurrentChat);
+  if (backfillIt != m_BackfillStates.end())
+  {
+    LOG_INFO("backfill stopped %s after %lld", m_CurrentChat.second.c_str(), backfillIt->second.count);
+    m_BackfillStates.erase(backfillIt);
+    UpdateBackfillStatus();
+    return;
+  }
+
+  // start from oldest loaded message, older messages already cached are then read from cache
+  const ChatState& chatState = GetChatState(m_CurrentChat.first, m_CurrentChat.second);
+  BackfillState& backfillState = m_BackfillStates[m_CurrentChat];
+  backfillState.fromMsgId = chatState.messageVec.empty() ? "" : chatState.messageVec.back();
+  LOG_INFO("backfill started %s", m_CurrentChat.second.c_str());
+  RequestBackfill(m_CurrentChat, backfillState);
+  UpdateBackfillStatus();
+}
+
+void UiModel::FilterProfile()
+{
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
+
+  if (GetEditMessageActive()) return;
+
+  // cycle chat list between all profiles and each single profile, no re-sort as profile lists are ordered
+  std::vector<std::string> profileIds;
+  for (const auto& profileChatVec : m_ProfileChatVecs)
+  {
+    profileIds.push_back(profileChatVec.first);
+  }
+
+  if ((profileIds.size() < 2) && m_ChatVecProfileFilter.empty()) return;
+
+  std::sort(profileIds.begin(), profileIds.end());
+  auto it = std::upper_bound(profileIds.begin(), profileIds.end(), m_ChatVecProfileFilter);
+  m_ChatVecProfileFilter = (it != profileIds.end()) ? *it : "";
+  LOG_INFO("profile filter \"%s\"", m_ChatVecProfileFilter.c_str());
+
+  MergeChatVecs();
+  UpdateList();
+}
+
+bool UiModel::HandleBackfillMessages(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify)
+{
+  // must be called under lock, returns true if messages were consumed by backfill only
+  if (m_BackfillStates.empty() || !p_NewMessagesNotify.sequence) return false;
+
+  const ChatKey chat(p_ProfileId, p_NewMessagesNotify.chatId);
+  auto backfillIt = m_BackfillStates.find(chat);
+  if (backfillIt == m_BackfillStates.end()) return false;
+
+  BackfillState& backfillState = backfillIt->second;
+  if (p_NewMessagesNotify.fromMsgId != backfillState.fromMsgId) return false;
+
+  const std::vector<ChatMessage>& chatMessages = p_NewMessagesNotify.chatMessages;
+  backfillState.count += chatMessages.size();
+  if (p_NewMessagesNotify.more)
+  {
+    // chunks are sent newest first, so the final one holds the oldest message of the page
+    UpdateBackfillStatus();
+    const ChatState& chatState = GetChatState(chat.first, chat.second);
+    return !chatState.msgFromRequests.count(p_NewMessagesNotify.fromMsgId);
+  }
+
+  // *INDENT-OFF*
+  auto oldestIt = std::min_element(chatMessages.begin(), chatMessages.end(),
+                                   [](const ChatMessage& lhs, const ChatMessage& rhs)
+  {
+    return ProtocolUtil::IsMessageOlder(lhs, rhs);
+  });
+  // *INDENT-ON*
+
+  if (!p_NewMessagesNotify.success || (oldestIt == chatMessages.end()) ||
+      (oldestIt->id == backfillState.fromMsgId))
+  {
+    LOG_INFO("backfill complete %s count %lld", chat.second.c_str(), backfillState.count);
+    m_BackfillStates.erase(backfillIt);
+  }
+  else
+  {
+    backfillState.fromMsgId = oldestIt->id;
+    RequestBackfill(chat, backfillState);
+  }
+
+  UpdateBackfillStatus();
+
+  // a page also requested by the chat view is handled as usual
+  const ChatState& chatState = GetChatState(chat.first, chat.second);
+  return !chatState.msgFromRequests.count(p_NewMessagesNotify.fromMsgId);
+}
+
+bool UiModel::HandleCacheOnlyMessages(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify)
+{
+  // must be called under lock, returns true if messages were left to message cache only. chats not
+  // resident in the model only track their newest message for list position and unread state, and
+  // their messages are loaded from cache when first viewed.
+  const std::string& chatId = p_NewMessagesNotify.chatId;
+  if (!p_NewMessagesNotify.success || IsChatResident(p_ProfileId, chatId)) return false;
+
+  std::unordered_map<std::string, ChatInfo>& chatInfos = m_ChatInfos[p_ProfileId];
+  auto chatIt = chatInfos.find(chatId);
+  if (chatIt == chatInfos.end())
+  {
+    LOG_TRACE("new message in unknown chat, get chat %s", chatId.c_str());
+    std::shared_ptr<GetChatsRequest> getChatsRequest = std::make_shared<GetChatsRequest>();
+    getChatsRequest->chatIds.insert(chatId);
+    SendProtocolRequest(p_ProfileId, getChatsRequest);
+    return true;
+  }
+
+  const ChatMessage* newestMessage = nullptr;
+  for (const auto& chatMessage : p_NewMessagesNotify.chatMessages)
+  {
+    if (chatMessage.timeSent == std::numeric_limits<int64_t>::max()) continue; // skip sponsored messages
+
+    if ((newestMessage == nullptr) || ProtocolUtil::IsMessageOlder(*newestMessage, chatMessage))
+    {
+      newestMessage = &chatMessage;
+    }
+  }
+
+  if (newestMessage == nullptr) return true;
+
+  // equal time is a change of the newest message, e.g. its read status
+  const ChatKey chat(p_ProfileId, chatId);
+  auto timeIt = m_CacheOnlyLastMessageTimes.find(chat);
+  if ((timeIt != m_CacheOnlyLastMessageTimes.end()) && (newestMessage->timeSent < timeIt->second)) return true;
+
+  m_CacheOnlyLastMessageTimes[chat] = newestMessage->timeSent;
+  if (newestMessage->timeSent > chatIt->second.lastMessageTime)
+  {
+    UpdateChatInfoLastMessageTime(p_ProfileId, chatId, newestMessage->timeSent);
+  }
+
+  UpdateChatInfoIsUnread(p_ProfileId, chatId, CompactMessage(*newestMessage));
+  UpdateChatPosition(p_ProfileId, chatId);
+  UpdateList();
+
+  // new messages are queued to cache before notified, not committed. the unreads fetch queued after
+  // them, and history fetches when the chat is opened, are performed after their commit.
+  if (!p_NewMessagesNotify.cached && GetChatIsUnread(p_ProfileId, chatId))
+  {
+    MessageCache::FetchChatUnreads(p_ProfileId, std::vector<std::string>({ chatId }));
+  }
+
+  return true;
+}
+
+bool UiModel::IsChatResident(const std::string& p_ProfileId, const std::string& p_ChatId)
+{
+  // without cache for the profile, the model is the only place messages are kept
+  if (!MessageCache::HasProfile(p_ProfileId)) return true;
+
+  if ((p_ProfileId == m_CurrentChat.first) && (p_ChatId == m_CurrentChat.second)) return true;
+
+  if (IsHistoryPaneChat(p_ProfileId, p_ChatId)) return true;
+
+  // chats become resident once their messages are requested, e.g. when viewed or prefetched
+  auto profileIt = m_ChatStates.find(p_ProfileId);
+  if (profileIt == m_ChatStates.end()) return false;
+
+  auto chatIt = profileIt->second.find(p_ChatId);
+  if (chatIt == profileIt->second.end()) return false;
+
+  const ChatState& chatState = chatIt->second;
+  return !chatState.messages.empty() || !chatState.msgFromRequests.empty();
+}
+
+void UiModel::RequestBackfill(const ChatKey& p_Chat, BackfillState& p_BackfillState)
+{
+  std::shared_ptr<GetMessagesRequest> getMessagesRequest = std::make_shared<GetMessagesRequest>();
+  getMessagesRequest->chatId = p_Chat.second;
+  getMessagesRequest->fromMsgId = p_BackfillState.fromMsgId;
+  getMessagesRequest->limit = s_BackfillBatchSize;
+  LOG_TRACE("backfill request in %s from %s", p_Chat.second.c_str(), p_BackfillState.fromMsgId.c_str());
+  SendProtocolRequest(p_Chat.first, getMessagesRequest);
+}
+
+void UiModel::UpdateBackfillStatus()
+{
+  int64_t count = 0;
+  for (const auto& backfillState : m_BackfillStates)
+  {
+    count += backfillState.second.count;
+  }
+
+  Status::SetBackfillCount(count);
+  if (m_BackfillStates.empty())
+  {
+    Status::Clear(Status::FlagBackfilling);
+  }
+  else
+  {
+    Status::Set(Status::FlagBackfilling);
+  }
+}
+
+void UiModel::DesktopNotifyUnread(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                  const std::string& p_Name, const std::string& p_Text)
+{
+  // notify at once if the chat was not notified recently, otherwise count it for a combined notification
+  const int64_t minInterval = std::max(UiConfig::GetParams().desktopNotifyMinInterval, 0);
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  DesktopNotifyState& desktopNotifyState = m_DesktopNotifyStates[ChatKey(p_ProfileId, p_ChatId)];
+  if ((desktopNotifyState.notifyTime != 0) && ((nowTime - desktopNotifyState.notifyTime) < minInterval))
+  {
+    ++desktopNotifyState.pendingCount;
+    desktopNotifyState.name = p_Name;
+    return;
+  }
+
+  desktopNotifyState.notifyTime = nowTime;
+  desktopNotifyState.pendingCount = 0;
+  DesktopNotify(p_Name, p_Text);
+}
+
+void UiModel::ProcessDesktopNotify()
+{
+  if (m_DesktopNotifyStates.empty()) return;
+
+  const int64_t minInterval = std::max(UiConfig::GetParams().desktopNotifyMinInterval, 0);
+  const int64_t nowTime = TimeUtil::GetCurrentTimeMSec();
+  for (auto it = m_DesktopNotifyStates.begin(); it != m_DesktopNotifyStates.end(); /* incremented in loop */)
+  {
+    DesktopNotifyState& desktopNotifyState = it->second;
+    if ((nowTime - desktopNotifyState.notifyTime) < minInterval)
+    {
+      ++it;
+      continue;
+    }
+
+    if (desktopNotifyState.pendingCount > 0)
+    {
+      const int count = desktopNotifyState.pendingCount;
+      desktopNotifyState.notifyTime = nowTime;
+      desktopNotifyState.pendingCount = 0;
+      DesktopNotify(desktopNotifyState.name, std::to_string(count) + ((count == 1) ? " new message" : " new messages"));
+      ++it;
+    }
+    else
+    {
+      it = m_DesktopNotifyStates.erase(it);
+    }
+  }
+}
+
+void UiModel::DesktopNotify(const std::string& p_Name, const std::string& p_Text)
 {
   static const std::string cmdTemplate = []()
   {
@@ -2614,18 +5221,13 @@ void UiModel::DesktopNotifyUnread(const std::string& p_Name, const std::string&
   StrUtil::ReplaceString(cmd, "%1", name);
   StrUtil::ReplaceString(cmd, "%2", text);
 
-  // run command
-  LOG_TRACE("cmd \"%s\" start", cmd.c_str());
-  int rv = system(cmd.c_str());
-  if (rv != 0)
-  {
-    LOG_WARNING("cmd \"%s\" failed (%d)", cmd.c_str(), rv);
-  }
+  // run command in background, as notifiers may be slow and this is called with model lock held
+  m_ProcessLauncher.Launch(cmd);
 }
 
 void UiModel::SetHistoryInteraction(bool p_HistoryInteraction)
 {
-  static const bool markReadOnView = UiConfig::GetBool("mark_read_on_view");
+  const bool markReadOnView = UiConfig::GetParams().markReadOnView;
   if (!markReadOnView && !m_HistoryInteraction && p_HistoryInteraction)
   {
     UpdateHistory();
@@ -2685,6 +5287,27 @@ bool UiModel::IsAttachmentDownloaded(const FileInfo& p_FileInfo)
   return false;
 }
 
+const UiModel::AttachmentInfo& UiModel::GetAttachmentInfo(ChatState& p_ChatState, const CompactMessage& p_ChatMessage)
+{
+  // decoded info and download state, refreshed only when message file info or attachment index changes
+  AttachmentInfo& attachmentInfo = p_ChatState.attachmentInfos[p_ChatMessage.id];
+  const uint64_t attachmentGeneration = MessageCache::GetAttachmentGeneration();
+  if ((attachmentInfo.fileInfoHex != p_ChatMessage.fileInfo) ||
+      (attachmentInfo.attachmentGeneration != attachmentGeneration))
+  {
+    attachmentInfo.fileInfoHex = p_ChatMessage.fileInfo;
+    attachmentInfo.fileInfo = ProtocolUtil::FileInfoFromHex(p_ChatMessage.fileInfo);
+    attachmentInfo.attachmentGeneration = attachmentGeneration;
+    // indexed attachments are known to exist, avoiding a file stat
+    const FileInfo& fileInfo = attachmentInfo.fileInfo;
+    attachmentInfo.isDownloaded =
+      ((fileInfo.fileStatus == FileStatusDownloaded) && MessageCache::IsAttachmentIndexed(fileInfo.filePath)) ||
+      IsAttachmentDownloaded(fileInfo);
+  }
+
+  return attachmentInfo;
+}
+
 bool UiModel::IsAttachmentDownloadable(const FileInfo& p_FileInfo)
 {
   const bool hasFileId = !p_FileInfo.fileId.empty();
@@ -2744,9 +5367,10 @@ std::string UiModel::GetSelectedMessageText()
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-  const int messageOffset = m_MessageOffset[profileId][chatId];
-  const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::vector<std::string>& messageVec = chatState.messageVec;
+  const int messageOffset = chatState.messageOffset;
+  const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
 
   auto it = std::next(messageVec.begin(), messageOffset);
   if (it == messageVec.end())
@@ -2773,11 +5397,12 @@ void UiModel::Cut()
   {
     std::string profileId = m_CurrentChat.first;
     std::string chatId = m_CurrentChat.second;
-    int& entryPos = m_EntryPos[profileId][chatId];
-    std::wstring& entryStr = m_EntryStr[profileId][chatId];
+    ChatState& chatState = GetChatState(profileId, chatId);
+    int& entryPos = chatState.entryPos;
+    std::wstring& entryStr = chatState.entryStr;
 
     std::string text = StrUtil::ToString(entryStr);
-    Clipboard::SetText(text);
+    m_ClipboardWorker.SetText(text);
 
     entryStr.clear();
     entryPos = 0;
@@ -2794,16 +5419,16 @@ void UiModel::Copy()
   if (GetSelectMessageActive())
   {
     std::string text = UiModel::GetSelectedMessageText();
-    Clipboard::SetText(text);
+    m_ClipboardWorker.SetText(text);
   }
   else
   {
     std::string profileId = m_CurrentChat.first;
     std::string chatId = m_CurrentChat.second;
-    std::wstring& entryStr = m_EntryStr[profileId][chatId];
+    std::wstring& entryStr = GetChatState(profileId, chatId).entryStr;
 
     std::string text = StrUtil::ToString(entryStr);
-    Clipboard::SetText(text);
+    m_ClipboardWorker.SetText(text);
   }
 }
 
@@ -2811,23 +5436,82 @@ void UiModel::Paste()
 {
   std::unique_lock<std::mutex> lock(m_ModelMutex);
 
-  std::string profileId = m_CurrentChat.first;
-  std::string chatId = m_CurrentChat.second;
-  int& entryPos = m_EntryPos[profileId][chatId];
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
+  // text is read and converted by the clipboard worker, and inserted by ProcessPaste
+  const std::string profileId = m_CurrentChat.first;
+  const std::string chatId = m_CurrentChat.second;
+  const bool emojiEnabled = m_View->GetEmojiEnabled();
+  // *INDENT-OFF*
+  m_ClipboardWorker.GetText([this, profileId, chatId, emojiEnabled](std::string&& p_Text)
+  {
+    std::string text = StrUtil::Textize(p_Text);
+    if (emojiEnabled)
+    {
+      text = StrUtil::Emojize(text, true /*p_Pad*/);
+    }
+
+    std::unique_ptr<PasteState> pasteState(new PasteState());
+    pasteState->profileId = profileId;
+    pasteState->chatId = chatId;
+    pasteState->text = StrUtil::ToWString(text);
+    {
+      std::unique_lock<std::mutex> pasteLock(m_PasteMutex);
+      m_ReceivedPaste = std::move(pasteState);
+    }
+
+    UiController::Wakeup();
+  });
+  // *INDENT-ON*
+}
+
+void UiModel::InsertText(const std::wstring& p_Text)
+{
+  // terminal (bracketed) paste, inserted into entry as one operation
+  if (p_Text.empty()) return;
+
+  std::unique_lock<std::mutex> lock(m_ModelMutex);
 
-  std::string text = Clipboard::GetText();
-  text = StrUtil::Textize(text);
+  std::string text = StrUtil::Textize(StrUtil::ToString(p_Text));
   if (m_View->GetEmojiEnabled())
   {
     text = StrUtil::Emojize(text, true /*p_Pad*/);
   }
 
-  std::wstring wtext = StrUtil::ToWString(text);
-  entryStr.insert(entryPos, wtext);
-  entryPos += wtext.size();
-
+  const std::string profileId = m_CurrentChat.first;
+  const std::string chatId = m_CurrentChat.second;
+  ChatState& chatState = GetChatState(profileId, chatId);
+  const std::wstring wtext = StrUtil::ToWString(text);
+  chatState.entryStr.insert(chatState.entryPos, wtext);
+  chatState.entryPos += wtext.size();
   SetTyping(profileId, chatId, true);
+
+  UpdateEntry();
+}
+
+void UiModel::ProcessPaste()
+{
+  // must be called with lock held, inserts a bounded chunk per call so large pastes do not stall the ui
+  if (!m_Paste)
+  {
+    std::unique_lock<std::mutex> pasteLock(m_PasteMutex);
+    if (!m_ReceivedPaste) return;
+
+    m_Paste = std::move(m_ReceivedPaste);
+  }
+
+  ChatState& chatState = GetChatState(m_Paste->profileId, m_Paste->chatId);
+  int& entryPos = chatState.entryPos;
+  std::wstring& entryStr = chatState.entryStr;
+
+  const size_t count = std::min(s_PasteChunkSize, m_Paste->text.size() - m_Paste->pos);
+  entryStr.insert(entryPos, m_Paste->text, m_Paste->pos, count);
+  entryPos += count;
+  m_Paste->pos += count;
+  if (m_Paste->pos >= m_Paste->text.size())
+  {
+    SetTyping(m_Paste->profileId, m_Paste->chatId, true);
+    m_Paste.reset();
+  }
+
   UpdateEntry();
 }
 
@@ -2837,8 +5521,9 @@ void UiModel::Clear()
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  int& entryPos = m_EntryPos[profileId][chatId];
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  int& entryPos = chatState.entryPos;
+  std::wstring& entryStr = chatState.entryStr;
   entryStr.clear();
   entryPos = 0;
 
@@ -2861,20 +5546,27 @@ void UiModel::EditMessage()
     }
 
     std::string chatId = m_CurrentChat.second;
-    const std::vector<std::string>& messageVec = m_MessageVec[profileId][chatId];
-    const int messageOffset = m_MessageOffset[profileId][chatId];
+    ChatState& chatState = GetChatState(profileId, chatId);
+    const std::vector<std::string>& messageVec = chatState.messageVec;
+    const int messageOffset = chatState.messageOffset;
     auto it = std::next(messageVec.begin(), messageOffset);
     if (it == messageVec.end()) return;
 
     const std::string messageId = *it;
-    const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
-    const ChatMessage& chatMessage = messages.at(messageId);
+    const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+    const CompactMessage& chatMessage = messages.at(messageId);
     if (!chatMessage.isOutgoing)
     {
       MessageDialog("Warning", "Received messages cannot be edited.", 0.7, 5);
       return;
     }
 
+    if (IsOutboxMsgId(messageId))
+    {
+      MessageDialog("Warning", "Messages not yet sent cannot be edited.", 0.7, 5);
+      return;
+    }
+
     const time_t timeNow = time(NULL);
     const time_t timeSent = (time_t)(chatMessage.timeSent / 1000);
     const time_t messageAgeSec = timeNow - timeSent;
@@ -2912,9 +5604,10 @@ void UiModel::SaveEditMessage()
 
     std::string profileId = m_CurrentChat.first;
     std::string chatId = m_CurrentChat.second;
-    std::wstring& entryStr = m_EntryStr[profileId][chatId];
-    const std::unordered_map<std::string, ChatMessage>& messages = m_Messages[profileId][chatId];
-    const ChatMessage& chatMessage = messages.at(m_EditMessageId);
+    ChatState& chatState = GetChatState(profileId, chatId);
+    std::wstring& entryStr = chatState.entryStr;
+    const std::unordered_map<std::string, CompactMessage>& messages = chatState.messages;
+    const CompactMessage& chatMessage = messages.at(m_EditMessageId);
 
     if (entryStr.empty()) return;
 
@@ -2947,20 +5640,15 @@ void UiModel::CancelEditMessage()
 
 std::string UiModel::EntryStrToSendStr(const std::wstring& p_EntryStr)
 {
-  std::string str;
-  if (m_View->GetEmojiEnabled())
-  {
-    std::wstring wstr = p_EntryStr;
-    wstr.erase(std::remove(wstr.begin(), wstr.end(), EMOJI_PAD), wstr.end());
-    str = StrUtil::ToString(wstr);
-  }
-  else
-  {
-    std::wstring wstr = p_EntryStr;
-    str = StrUtil::Emojize(StrUtil::ToString(wstr));
-  }
+  // converted in one pass, emoji pads are stripped when emoji enabled
+  if (!m_View->GetEmojiEnabled()) return StrUtil::Emojize(StrUtil::ToString(p_EntryStr));
+
+  if (p_EntryStr.find((wchar_t)EMOJI_PAD) == std::wstring::npos) return StrUtil::ToString(p_EntryStr);
 
-  return str;
+  std::wstring wstr;
+  wstr.reserve(p_EntryStr.size());
+  std::remove_copy(p_EntryStr.begin(), p_EntryStr.end(), std::back_inserter(wstr), (wchar_t)EMOJI_PAD);
+  return StrUtil::ToString(wstr);
 }
 
 bool UiModel::MessageDialog(const std::string& p_Title, const std::string& p_Text, float p_WReq, float p_HReq)
@@ -3024,8 +5712,9 @@ void UiModel::CallExternalEdit(const std::string& p_EditorCmd)
 
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
-  int& entryPos = m_EntryPos[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  std::wstring& entryStr = chatState.entryStr;
+  int& entryPos = chatState.entryPos;
 
   endwin();
   std::string tempPath = FileUtil::GetApplicationDir() + "/tmpcompose.txt";
@@ -3064,7 +5753,7 @@ void UiModel::CallExternalEdit(const std::string& p_EditorCmd)
   UpdateEntry();
 }
 
-const std::pair<std::string, std::string>& UiModel::GetNextChat()
+const UiModel::ChatKey& UiModel::GetNextChat()
 {
   if (m_ChatVec.empty()) return s_ChatNone;
 
@@ -3075,7 +5764,7 @@ const std::pair<std::string, std::string>& UiModel::GetNextChat()
     nextChatIndex = 0;
   }
 
-  const std::pair<std::string, std::string>& nextChat = m_ChatVec.at(nextChatIndex);
+  const ChatKey& nextChat = m_ChatVec.at(nextChatIndex);
   return nextChat;
 }
 
@@ -3111,7 +5800,7 @@ void UiModel::ExternalCall()
 
 void UiModel::HandleChatInfoMutedUpdate(const std::string& p_ProfileId, const std::string& p_ChatId)
 {
-  static const bool mutedPositionByTimestamp = UiConfig::GetBool("muted_position_by_timestamp");
+  const bool mutedPositionByTimestamp = UiConfig::GetParams().mutedPositionByTimestamp;
   if (!mutedPositionByTimestamp && m_ChatInfos[p_ProfileId][p_ChatId].isMuted)
   {
     // deterministic fake time near epoch
@@ -3131,6 +5820,18 @@ void UiModel::SendProtocolRequest(const std::string& p_ProfileId, std::shared_pt
   m_Protocols[p_ProfileId]->SendRequest(p_Request);
 }
 
+std::shared_ptr<RequestHandle> UiModel::SendProtocolAsyncRequest(const std::string& p_ProfileId,
+                                                                 std::shared_ptr<RequestMessage> p_Request)
+{
+  if (!m_Protocols.count(p_ProfileId))
+  {
+    LOG_WARNING("no profile \"%s\"", p_ProfileId.c_str());
+    return nullptr;
+  }
+
+  return m_Protocols[p_ProfileId]->SendAsyncRequest(p_Request);
+}
+
 bool UiModel::HasProtocolFeature(const std::string& p_ProfileId, ProtocolFeature p_ProtocolFeature)
 {
   if (!m_Protocols.count(p_ProfileId))
@@ -3204,8 +5905,9 @@ void UiModel::EntryConvertEmojiEnabled()
   const bool emojiEnabled = GetEmojiEnabled();
   std::string profileId = m_CurrentChat.first;
   std::string chatId = m_CurrentChat.second;
-  int& entryPos = m_EntryPos[profileId][chatId];
-  std::wstring& entryStr = m_EntryStr[profileId][chatId];
+  ChatState& chatState = GetChatState(profileId, chatId);
+  int& entryPos = chatState.entryPos;
+  std::wstring& entryStr = chatState.entryStr;
 
   if (!entryStr.empty())
   {
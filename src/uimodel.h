@@ -7,19 +7,164 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <stack>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "clipboardworker.h"
+#include "compactmessage.h"
+#include "internedstr.h"
+#include "messagecache.h"
+#include "perfstats.h"
+#include "processlauncher.h"
 #include "protocol.h"
+#include "requesttracker.h"
+#include "timeutil.h"
 
 class UiView;
 
 class UiModel
 {
+public:
+  // per-chat ui state, reached through a single chat lookup
+  class AttachmentInfo
+  {
+  public:
+    std::string fileInfoHex; // source of decoded fields below
+    FileInfo fileInfo;
+    bool isDownloaded = false;
+    uint64_t attachmentGeneration = 0; // cache attachment index state isDownloaded was based on
+  };
+
+  // remote user typing in a chat, dropped at expiry if the typing stop was missed
+  class TypingUser
+  {
+  public:
+    InternedStr userId;
+    int64_t expiryTime = 0;
+  };
+
+  class ChatState
+  {
+  public:
+    std::vector<std::string> messageVec; // newest first
+    std::unordered_map<std::string, CompactMessage> messages;
+    std::string lastMessageId; // newest non-sponsored message
+    int messageOffset = 0; // index in messageVec of bottom, or selected, message
+    std::stack<std::string> messageOffsetStack; // ids of previous page bottom messages
+    std::unordered_map<std::string, std::shared_ptr<RequestHandle>> msgFromRequests; // by from id, null once replied
+    bool moreMessagesPending = false; // history reply chunks still to arrive
+    bool fetchedAllCache = false;
+    std::string oldestMessageId;
+    int64_t oldestMessageTime = 0;
+    std::wstring entryStr;
+    int entryPos = 0;
+    std::vector<TypingUser> usersTyping; // few, in typing start order
+    std::string chatStatus; // rendered by GetChatStatus
+    uint64_t chatStatusVersion = 0; // m_StatusVersion chatStatus was rendered at, 0 if none
+    int64_t chatStatusContactsTime = 0; // m_ContactInfosUpdateTime chatStatus was rendered at
+    std::unordered_map<std::string, AttachmentInfo> attachmentInfos; // by message id
+    std::unordered_map<std::string, int> downloadProgress; // percent by message id
+    std::vector<std::string> markReadMsgIds; // newest first, pending FlushMarkRead
+    std::unordered_map<std::string, bool> outboxFailed; // by outbox message id, shown pending or failed
+    uint64_t historyVersion = 0; // m_HistoryVersion at last access which may have changed history shown
+  };
+
+  // immutable contacts snapshot shared with dialogs, rebuilt only when contacts change
+  class ContactSnapshot
+  {
+  public:
+    int64_t updateTime = 0; // version, matches GetContactInfosUpdateTime when current
+    std::unordered_map<std::string, std::unordered_map<std::string, ContactInfo>> contactInfos;
+    std::vector<std::pair<std::string, const ContactInfo*>> nameIndex; // named contacts sorted by name
+  };
+
+  // presence of a user, received ones not on screen are kept pending and applied when next displayed
+  class UserStatus
+  {
+  public:
+    bool isOnline = false;
+    int64_t timeSeen = -1;
+  };
+
+  // history page sizing of a profile, adapted to observed message height and fetch latency
+  class PageSizer
+  {
+  public:
+    double linesPerMessage = 0; // moving average, 0 until a full history pane is observed
+    int64_t latencyUs = 0; // moving average of history fetch round trips
+  };
+
+  // desktop notifications of a chat, coalesced into one per desktop_notify_min_interval
+  class DesktopNotifyState
+  {
+  public:
+    int64_t notifyTime = 0;
+    int pendingCount = 0; // unread notifications coalesced since notifyTime
+    std::string name;
+  };
+
+  // clipboard text being pasted into entry of a chat, inserted in chunks on ui ticks
+  class PasteState
+  {
+  public:
+    std::string profileId;
+    std::string chatId;
+    std::wstring text;
+    size_t pos = 0; // inserted so far
+  };
+
+  // action bound to a key, interaction actions also set current chat if not set
+  class KeyBinding
+  {
+  public:
+    std::function<void()> handler;
+    bool isInteraction = true;
+  };
+
+  typedef std::function<void(const std::string& p_ProfileId, const std::string& p_ChatId,
+                             ChatState& p_ChatState)> EntryKeyBinding;
+
+  // full history load of a chat, streamed into message cache without merging into chat state
+  class BackfillState
+  {
+  public:
+    std::string fromMsgId; // of pending request
+    int64_t count = 0; // messages received
+  };
+
+  // outgoing messages of a chat in send order, the first one is in flight while sending
+  class OutboxState
+  {
+  public:
+    std::deque<MessageCache::OutboxEntry> entries;
+    bool inFlight = false;
+    int64_t sendTime = 0; // of in flight entry
+    int64_t retryTime = 0; // earliest next send after a failure
+  };
+
+  // typing status shared in a chat, isTyping is the local state and isTypingSent the last one sent
+  class TypingState
+  {
+  public:
+    bool isTyping = false;
+    bool isTypingSent = false;
+    int64_t typeTime = 0;
+    int64_t sendTime = 0;
+  };
+
+public:
+  typedef std::pair<InternedStr, InternedStr> ChatKey; // profile and chat id
+
 public:
   UiModel();
   virtual ~UiModel();
@@ -28,9 +173,20 @@ public:
   void Cleanup();
 
   void KeyHandler(wint_t p_Key);
+  void InitKeyBindings();
   void SendMessage();
   void EntryKeyHandler(wint_t p_Key);
+  void InsertText(const std::wstring& p_Text);
   void SetTyping(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsTyping);
+  void ProcessTyping();
+  void QueueOutbox(const std::string& p_ProfileId, const std::string& p_ChatId, const ChatMessage& p_ChatMessage);
+  void LoadOutbox(const std::string& p_ProfileId);
+  void ProcessOutbox();
+  void CompleteOutbox(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_Success);
+  bool CancelOutbox(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId);
+  void AddOutboxMessage(const std::string& p_ProfileId, const MessageCache::OutboxEntry& p_OutboxEntry);
+  static std::string GetOutboxMsgId(int64_t p_Key);
+  static bool IsOutboxMsgId(const std::string& p_MsgId);
 
   void NextChat();
   void PrevChat();
@@ -41,15 +197,19 @@ public:
   void HomeFetchNext(const std::string& p_ProfileId, const std::string& p_ChatId, int p_MsgCount);
   void End();
   void MarkRead(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId);
+  void FlushMarkRead(const std::string& p_ProfileId, const std::string& p_ChatId);
   void DownloadAttachment(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_MsgId,
-                          const std::string& p_FileId, DownloadFileAction p_DownloadFileAction);
+                          const std::string& p_FileId, DownloadFileAction p_DownloadFileAction,
+                          DownloadFilePriority p_DownloadFilePriority);
   void DeleteMessage();
   void DeleteChat();
   void OpenMessage();
-  bool GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileAction p_DownloadFileAction);
+  bool GetMessageAttachmentPath(std::string& p_FilePath, DownloadFileAction p_DownloadFileAction,
+                                std::string* p_PreviewPath = nullptr);
   void OpenMessageAttachment(std::string p_FilePath = std::string());
   void OpenLink(const std::string& p_Url);
   void OpenAttachment(const std::string& p_Path);
+  void OpenAttachmentPreview(const std::string& p_Path);
   void RunCommand(const std::string& p_Cmd);
   void OpenMessageLink();
   void SaveMessageAttachment(std::string p_FilePath = std::string());
@@ -57,13 +217,18 @@ public:
   void TransferFile();
   void InsertEmoji();
   void SearchContact();
+  void SearchMessage();
+  void FindMessage();
   void FetchCachedMessage(const std::string& p_ProfileId, const std::string& p_ChatId,
                           const std::string& p_MsgId);
 
   void MessageHandler(std::shared_ptr<ServiceMessage> p_ServiceMessage);
+  void ProcessServiceMessages();
   void AddProtocol(std::shared_ptr<Protocol> p_Protocol);
   std::unordered_map<std::string, std::shared_ptr<Protocol>>& GetProtocols();
   bool Process();
+  int GetKeyTimeout();
+  bool GetInputLatencyPending();
 
   std::string GetLastMessageId(const std::string& p_ProfileId, const std::string& p_ChatId);
   void UpdateChatInfoLastMessageTime(const std::string& p_ProfileId, const std::string& p_ChatId);
@@ -72,24 +237,30 @@ public:
   std::string GetContactListName(const std::string& p_ProfileId, const std::string& p_ChatId);
   std::string GetContactPhone(const std::string& p_ProfileId, const std::string& p_ChatId);
   bool GetChatIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId);
+  int32_t GetChatUnreadCount(const std::string& p_ProfileId, const std::string& p_ChatId);
   std::string GetChatStatus(const std::string& p_ProfileId, const std::string& p_ChatId);
 
   std::wstring& GetEntryStr();
   int& GetEntryPos();
 
-  std::vector<std::pair<std::string, std::string>>& GetChatVec();
-  std::unordered_map<std::string, std::unordered_map<std::string, ContactInfo>> GetContactInfos();
+  std::vector<ChatKey>& GetChatVec();
+  std::shared_ptr<const ContactSnapshot> GetContactSnapshot();
   int64_t GetContactInfosUpdateTime();
-  std::pair<std::string, std::string>& GetCurrentChat();
+  int64_t GetContactInfosUpdateTimeNoLock();
+  uint64_t GetStatusVersionNoLock();
+  std::unordered_map<std::string, std::vector<std::pair<std::string, ChatMessage>>> GetSearchResults();
+  int64_t GetSearchResultsUpdateTime();
+  ChatKey& GetCurrentChat();
+  ChatKey GetHistoryPaneChat(int p_PaneIndex);
   int& GetCurrentChatIndex();
 
-  std::unordered_map<std::string, ChatMessage>& GetMessages(const std::string& p_ProfileId,
-                                                            const std::string& p_ChatId);
-  std::vector<std::string>& GetMessageVec(const std::string& p_ProfileId, const std::string& p_ChatId);
-  int& GetMessageOffset(const std::string& p_ProfileId, const std::string& p_ChatId);
+  ChatState& GetChatState(const std::string& p_ProfileId, const std::string& p_ChatId);
+  // for access not changing the messages, offset or attachment status shown, keeps history version
+  ChatState& PeekChatState(const std::string& p_ProfileId, const std::string& p_ChatId);
 
   void SetStatusOnline(const std::string& p_ProfileId, bool p_IsOnline);
   void RequestContacts();
+  void RequestSearchMessages(const std::string& p_Query);
   void SetRunning(bool p_Running);
 
   void SetSelectMessageActive(bool p_SelectMessageActive);
@@ -104,29 +275,104 @@ public:
   bool GetEditMessageActive();
   void SetEditMessageActive(bool p_EditMessageActive);
 
+  bool GetFindActive();
+  std::wstring GetFindEntryStr();
+  std::wstring GetFindHighlight();
+
   void SetHelpOffset(int p_HelpOffset);
   int GetHelpOffset();
 
   bool GetEmojiEnabled();
   void SetTerminalActive(bool p_TerminalActive);
+  void StartExport();
+  void BackfillChat();
+  void FilterProfile();
 
   bool IsMultipleProfiles();
   std::string GetProfileDisplayName(const std::string& p_ProfileId);
 
   static bool IsAttachmentDownloaded(const FileInfo& p_FileInfo);
   static bool IsAttachmentDownloadable(const FileInfo& p_FileInfo);
+  static const AttachmentInfo& GetAttachmentInfo(ChatState& p_ChatState, const CompactMessage& p_ChatMessage);
 
 private:
+  bool HandleServiceMessages(bool p_YieldOnChunk = false);
+  void HandleServiceMessage(const ServiceMessage& p_ServiceMessage);
   void SortChats();
+  void SortChats(const std::string& p_ProfileId);
+  void SortProfileChatVec(const std::string& p_ProfileId);
+  void MergeChatVecs();
+  bool IsChatVecListed(const std::string& p_ProfileId) const;
+  void ListChatVecProfile(const std::string& p_ProfileId);
+  void AddChat(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void RemoveChat(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void UpdateChatPosition(const std::string& p_ProfileId, const std::string& p_ChatId);
+  int MoveChatVecPos(std::vector<ChatKey>& p_ChatVec, std::vector<ChatKey>::iterator p_FromIt,
+                     int64_t p_PrevTime, int64_t p_Time);
+  int FindChatIndex(const ChatKey& p_Chat);
+  std::vector<ChatKey>::iterator FindChatVecPos(
+    std::vector<ChatKey>::iterator p_First,
+    std::vector<ChatKey>::iterator p_Last,
+    const ChatKey& p_Chat, int64_t p_Time);
+  static bool IsChatVecBefore(int64_t p_LhsTime, const ChatKey& p_Lhs,
+                              int64_t p_RhsTime, const ChatKey& p_Rhs);
+  void UpdateCurrentChatIfNotSet();
+  static std::vector<std::string>::iterator FindMessageVecPos(std::vector<std::string>& p_MessageVec,
+                                                              const std::unordered_map<std::string,
+                                                                                       CompactMessage>& p_Messages,
+                                                              const CompactMessage& p_ChatMessage);
+  static int FindMessageIndex(ChatState& p_ChatState, const std::string& p_MsgId);
+  static void AddMessageOffset(ChatState& p_ChatState, int p_AddOffset, int p_PageSize);
+  void DeleteMessages(const std::string& p_ProfileId, const std::string& p_ChatId,
+                      const std::vector<std::string>& p_MsgIds);
+  static void UpdateLastMessageId(ChatState& p_ChatState, const CompactMessage& p_ChatMessage);
+  static void ResetLastMessageId(ChatState& p_ChatState);
   void OnCurrentChatChanged();
+  void TrimChatMessages(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void TrimChatMessages(const std::string& p_ProfileId, const std::string& p_ChatId, int p_MaxMessages);
+  void ReleaseMemory();
+  void UpdateHeapStats();
   void RequestMessagesCurrentChat();
   void RequestMessagesNextChat();
-  void RequestMessages(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void RequestMessages(const std::string& p_ProfileId, const std::string& p_ChatId, int p_PrefetchCount = 0);
+  void CompleteMessagesRequest(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify);
+  int GetHistoryPageSize(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void CancelMessagesRequests(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void CancelSearchRequests();
+  bool HandleBackfillMessages(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify);
+  bool HandleCacheOnlyMessages(const std::string& p_ProfileId, const NewMessagesNotify& p_NewMessagesNotify);
+  bool IsChatResident(const std::string& p_ProfileId, const std::string& p_ChatId);
+  void UpdateChatInfoLastMessageTime(const std::string& p_ProfileId, const std::string& p_ChatId,
+                                     int64_t p_LastMessageTime);
+  void UpdateChatInfoIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId,
+                              const CompactMessage& p_LastMessage);
+  void RequestBackfill(const ChatKey& p_Chat, BackfillState& p_BackfillState);
+  void FlushCachedMessageFetches();
+  int64_t GetFrameIntervalMs();
+  const ContactInfo& GetContactInfo(const std::string& p_ProfileId, const std::string& p_ContactId);
+  void UpdateBackfillStatus();
+  void Prefetch();
+  void StartInputLatency(PerfStats::Stat p_Stat);
+  void CompleteInputLatencies();
+  bool IsCurrentHistoryPopulated();
+  void CheckResume();
+  void HandleResume();
+  void RequestLatestMessages(const ChatKey& p_Chat);
+  std::vector<ChatKey> GetPrefetchChats(int p_MaxCount);
+  void PrefetchAttachments();
+  bool PrefetchChatAttachments(const ChatKey& p_Chat, int p_Begin, int p_End, DownloadFilePriority p_Priority,
+                               const std::set<std::string>& p_MediaTypes);
+  static std::string GetAttachmentMediaType(const FileInfo& p_FileInfo);
   void RequestUserStatusCurrentChat();
   void RequestUserStatusNextChat();
-  void RequestUserStatus(const std::pair<std::string, std::string>& p_Chat);
+  void RequestUserStatus(const ChatKey& p_Chat);
+  bool IsUserStatusVisible(const std::string& p_ProfileId, const std::string& p_UserId);
+  void ApplyUserStatus(const std::string& p_ProfileId, const std::string& p_UserId, const UserStatus& p_UserStatus);
+  bool ApplyPendingUserStatus(const std::string& p_ProfileId, const std::string& p_UserId);
+  void ExpireUsersTyping();
   void ProtocolSetCurrentChat();
   int GetHistoryLines();
+  bool IsHistoryPaneChat(const std::string& p_ProfileId, const std::string& p_ChatId);
   void ReinitView();
   void UpdateList();
   void UpdateStatus();
@@ -135,7 +381,15 @@ private:
   void UpdateEntry();
   void ResetMessageOffset();
   void SetCurrentChatIndexIfNotSet();
-  void DesktopNotifyUnread(const std::string& p_Name, const std::string& p_Text);
+  void DesktopNotifyUnread(const std::string& p_ProfileId, const std::string& p_ChatId, const std::string& p_Name,
+                           const std::string& p_Text);
+  void DesktopNotify(const std::string& p_Name, const std::string& p_Text);
+  void ProcessDesktopNotify();
+  void ProcessPaste();
+  void InitEntryKeyBindings();
+  void TouchHistory(ChatState& p_ChatState);
+  void EntryKeyUp(ChatState& p_ChatState);
+  void EntryKeyDown(ChatState& p_ChatState);
   void SetHistoryInteraction(bool p_HistoryInteraction);
   std::string GetSelectedMessageText();
   void Cut();
@@ -145,15 +399,26 @@ private:
   void EditMessage();
   void SaveEditMessage();
   void CancelEditMessage();
+  bool FindKeyHandler(wint_t p_Key);
+  void SetFindQuery(const std::wstring& p_Query);
+  bool IsFindMatch(const CompactMessage& p_ChatMessage);
+  void UpdateFindMatch(const std::string& p_ProfileId, const std::string& p_ChatId,
+                       const CompactMessage& p_ChatMessage);
+  void FindNext(bool p_Older);
+  bool FindFrom(int p_Index, bool p_Older);
+  void StopFind();
   std::string EntryStrToSendStr(const std::wstring& p_EntryStr);
   bool MessageDialog(const std::string& p_Title, const std::string& p_Text, float p_WReq, float p_HReq);
   void ExternalSpell();
   void ExternalEdit();
   void CallExternalEdit(const std::string& p_EditorCmd);
-  const std::pair<std::string, std::string>& GetNextChat();
+  const ChatKey& GetNextChat();
   void ExternalCall();
+  void SetChatInfoIsUnread(const std::string& p_ProfileId, const std::string& p_ChatId, bool p_IsUnread);
   void HandleChatInfoMutedUpdate(const std::string& p_ProfileId, const std::string& p_ChatId);
   void SendProtocolRequest(const std::string& p_ProfileId, std::shared_ptr<RequestMessage> p_Request);
+  std::shared_ptr<RequestHandle> SendProtocolAsyncRequest(const std::string& p_ProfileId,
+                                                          std::shared_ptr<RequestMessage> p_Request);
   bool HasProtocolFeature(const std::string& p_ProfileId, ProtocolFeature p_ProtocolFeature);
   void Quit();
   void EntryConvertEmojiEnabled();
@@ -162,39 +427,120 @@ private:
   bool m_Running = true;
   std::shared_ptr<UiView> m_View;
 
+  // @note: m_ModelMutex is only taken by the ui thread (key handling, dialogs, drawing and
+  // applying queued service messages), protocol and cache threads never wait for it.
   std::mutex m_ModelMutex;
+
+  // @note: protocol threads only hold m_ServiceMessageMutex, the queue is applied by ui thread
+  std::mutex m_ServiceMessageMutex;
+  std::deque<std::shared_ptr<ServiceMessage>> m_ServiceMessageQueue;
   std::unordered_map<std::string, std::shared_ptr<Protocol>> m_Protocols;
 
-  std::unordered_map<std::string, std::unordered_set<std::string>> m_ChatSet;
-  std::vector<std::pair<std::string, std::string>> m_ChatVec;
+  // @note: m_ProfileChatVecs are kept ordered by m_ChatVecTimes, the lastMessageTime each chat was last
+  // positioned by. m_ChatVec is their k-way merge, or a copy of one of them when filtered by profile.
+  std::vector<ChatKey> m_ChatVec;
+  std::unordered_map<std::string, std::vector<ChatKey>> m_ProfileChatVecs;
+  std::string m_ChatVecProfileFilter; // only chats of this profile are listed, empty for all
+  std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> m_ChatVecTimes;
   std::unordered_map<std::string, std::unordered_map<std::string, ChatInfo>> m_ChatInfos;
+  std::set<ChatKey> m_UnreadChats;
+  std::map<ChatKey, int32_t> m_ChatUnreadCounts; // from cache, of unread chats only, 0 if not known
   std::unordered_map<std::string, std::unordered_map<std::string, ContactInfo>> m_ContactInfos;
   int64_t m_ContactInfosUpdateTime = 0;
-
-  std::pair<std::string, std::string> m_CurrentChat;
+  uint64_t m_StatusVersion = 0; // incremented by UpdateStatus() on any status view input change
+  uint64_t m_HistoryVersion = 0; // incremented by TouchHistory(), unique across chats
+  std::shared_ptr<const ContactSnapshot> m_ContactSnapshot;
+  std::string m_SearchQuery;
+  std::unordered_map<std::string, std::vector<std::pair<std::string, ChatMessage>>> m_SearchResults;
+  int64_t m_SearchResultsUpdateTime = 0;
+  std::unordered_map<std::string, std::shared_ptr<RequestHandle>> m_SearchRequests; // server search by profile
+
+  ChatKey m_CurrentChat;
   int m_CurrentChatIndex = -1;
-  static const std::pair<std::string, std::string> s_ChatNone;
+  ChatKey m_PrevCurrentChat;
+  std::deque<ChatKey> m_RecentChats; // most recently viewed first
+  int64_t m_PrefetchTime = 0;
+  bool m_PrefetchPending = true;
+  static const int64_t s_PrefetchIntervalMs;
+  bool m_AttachmentPrefetchPending = false;
+  int m_AttachmentPrefetchShowCount = 0; // history show count at last attachment prefetch
+  int64_t m_DrawTime = 0;
+  bool m_DrawPending = false;
+  std::atomic<bool> m_PowerSave{ false }; // terminal inactive with power_save_interval set, read by protocols
+  int64_t m_ServiceMessagesTime = 0; // last applied batch
+  int64_t m_PerfStatsTime = 0;
+  static const int64_t s_PerfStatsIntervalMs;
+  bool m_ResizePending = false;
+  int64_t m_ResizeTime = 0; // last terminal resize event
+  static const int64_t s_ResizeDebounceMs;
+  int64_t m_TypingTimeoutTime = 0;
+  int64_t m_UsersTypingExpiryTime = 0; // earliest remote typing expiry, 0 if none
+  static const int64_t s_UsersTypingExpiryMs;
+  std::map<ChatKey, OutboxState> m_OutboxStates;
+  std::set<std::string> m_OutboxLoaded; // profile ids
+  int64_t m_OutboxTimeoutTime = 0;
+  int64_t m_OutboxLastKey = 0;
+  std::atomic<bool> m_MemoryPressure{ false }; // set by memory governor thread
+  int m_ReclaimerId = 0;
+  static const int64_t s_OutboxSendTimeoutMs;
+  static const int64_t s_OutboxRetryMaxMs;
+  static const int s_OutboxMaxAttempts;
+  static const int s_OutboxBatchSize;
+  static const int s_MemoryPressureMaxMessages;
+  std::unordered_map<std::string, std::unordered_map<std::string, TypingState>> m_TypingStates; // by profile and chat
+  std::map<ChatKey, DesktopNotifyState> m_DesktopNotifyStates;
+  std::map<ChatKey, BackfillState> m_BackfillStates;
+  std::map<ChatKey, int64_t> m_CacheOnlyLastMessageTimes; // newest message received of chats not resident
+  std::map<ChatKey, std::vector<std::string>> m_PendingMessageFetches; // quoted messages to fetch after draw
+  RequestTracker<std::tuple<std::string, std::string, std::string>> m_FetchedMessageIds; // requested, bounded
+  static const size_t s_FetchedMessageIdsMax;
+  static const int64_t s_FetchedMessageRetryMs;
+  static const int s_BackfillBatchSize;
+  TimeFormatter m_StatusTimeFormatter; // seen times in chat status
+  ProcessLauncher m_ProcessLauncher;
+  std::mutex m_PasteMutex;
+  std::unique_ptr<PasteState> m_ReceivedPaste; // from clipboard worker, guarded by m_PasteMutex
+  std::unique_ptr<PasteState> m_Paste; // being inserted
+  static const size_t s_PasteChunkSize;
+  ClipboardWorker m_ClipboardWorker; // declared after paste state used by its handler
+  static const ChatKey s_ChatNone;
 
   std::string m_EditMessageId;
 
-  std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> m_MessageVec;
-  std::unordered_map<std::string,
-                     std::unordered_map<std::string, std::unordered_map<std::string, ChatMessage>>> m_Messages;
-  std::unordered_map<std::string, std::unordered_map<std::string, int>> m_MessageOffset;
-  std::unordered_map<std::string, std::unordered_map<std::string, std::stack<int>>> m_MessageOffsetStack;
-  std::unordered_map<std::string,
-                     std::unordered_map<std::string, std::unordered_set<std::string>>> m_MsgFromIdsRequested;
-  std::unordered_map<std::string, std::unordered_map<std::string, bool>> m_FetchedAllCache;
-
-  std::unordered_map<std::string, std::unordered_map<std::string, std::string>> m_OldestMessageId;
-  std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> m_OldestMessageTime;
-
-  std::unordered_map<std::string, std::unordered_map<std::string, std::wstring>> m_EntryStr;
-  std::unordered_map<std::string, std::unordered_map<std::string, int>> m_EntryPos;
-
-  std::unordered_map<std::string, std::unordered_map<std::string, std::set<std::string>>> m_UsersTyping;
-  std::unordered_map<std::string, std::unordered_map<std::string, bool>> m_UserOnline;
-  std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> m_UserTimeSeen;
+  // @note: in-chat find state is only used by ui thread, matches are kept for loaded messages only
+  bool m_FindActive = false;
+  ChatKey m_FindChat;
+  std::wstring m_FindQuery; // as typed
+  std::string m_FindLowerQuery; // utf-8 with A-Z lowered, as StrUtil::FindIgnoreCase() needle
+  std::unordered_set<std::string> m_FindMatchIds; // loaded messages of find chat with text matching query
+  std::string m_FindOriginId; // message in view when find started, query changes search from it
+  bool m_FindOlderPending = false; // no older loaded match, next one awaits older history
+
+  // @note: key binding tables are built from key config and only used by ui thread
+  std::unordered_map<wint_t, KeyBinding> m_KeyBindings;
+  std::unordered_map<wint_t, EntryKeyBinding> m_EntryKeyBindings;
+
+  // @note: input latency state is only used by ui thread
+  int64_t m_KeyTimeUSec = 0; // read time of key being handled, 0 outside key handler
+  std::map<PerfStats::Stat, int64_t> m_InputLatencyStarts; // key read times of actions not yet painted
+  static const int64_t s_InputLatencyMaxUs;
+
+  // @note: references remain valid as unordered_map never moves its elements
+  std::unordered_map<std::string, std::unordered_map<std::string, ChatState>> m_ChatStates;
+
+  std::unordered_map<std::string, std::unordered_map<std::string, UserStatus>> m_UserStatuses; // applied
+  std::unordered_map<std::string, std::unordered_map<std::string, UserStatus>> m_PendingUserStatuses;
+  std::map<ChatKey, int64_t> m_UserStatusTimes; // last status request or update
+  static const int64_t s_UserStatusTtlMs;
+
+  std::unordered_map<std::string, PageSizer> m_PageSizers; // by profile
+  static const int64_t s_PageScreenLatencyUs;
+  static const int s_PageMaxScreens;
+  static const int s_PageMaxMessages;
+
+  int64_t m_ClockOffset = 0; // wall clock minus steady clock, grows by time suspended
+  static const int64_t s_ResumeMinSuspendMs;
+  static const int s_ResumeMaxCatchUpChats;
 
   bool m_SelectMessageActive = false;
   bool m_ListDialogActive = false;
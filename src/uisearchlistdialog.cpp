@@ -0,0 +1,116 @@
+// uisearchlistdialog.cpp
+//
+// Copyright (c) 2019-2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#include "uisearchlistdialog.h"
+
+#include <algorithm>
+
+#include "log.h"
+#include "uimodel.h"
+#include "strutil.h"
+
+UiSearchListDialog::UiSearchListDialog(const UiDialogParams& p_Params)
+  : UiListDialog(p_Params, true /*p_ShadeHidden*/)
+{
+  UpdateList();
+}
+
+UiSearchListDialog::~UiSearchListDialog()
+{
+}
+
+std::pair<std::string, std::pair<std::string, ChatMessage>> UiSearchListDialog::GetSelectedMessage()
+{
+  return m_SelectedMessage;
+}
+
+void UiSearchListDialog::OnSelect()
+{
+  if (m_SearchResultsVec.empty()) return;
+
+  m_SelectedMessage = m_SearchResultsVec[m_Index];
+  m_Result = true;
+  m_Running = false;
+}
+
+void UiSearchListDialog::OnBack()
+{
+}
+
+bool UiSearchListDialog::OnTimer()
+{
+  int64_t modelSearchResultsUpdateTime = m_Model->GetSearchResultsUpdateTime();
+  int64_t modelContactInfosUpdateTime = m_Model->GetContactInfosUpdateTime();
+  if ((m_DialogSearchResultsUpdateTime != modelSearchResultsUpdateTime) ||
+      !m_ContactSnapshot || (m_ContactSnapshot->updateTime != modelContactInfosUpdateTime))
+  {
+    UpdateList();
+    return true;
+  }
+
+  return false;
+}
+
+void UiSearchListDialog::UpdateList()
+{
+  // only query cache when search string changed, not on every list refresh
+  if (m_SearchStr != m_FilterStr)
+  {
+    m_SearchStr = m_FilterStr;
+    m_Model->RequestSearchMessages(StrUtil::ToString(m_SearchStr));
+  }
+
+  m_ContactSnapshot = m_Model->GetContactSnapshot();
+
+  m_DialogSearchResultsUpdateTime = m_Model->GetSearchResultsUpdateTime();
+  std::unordered_map<std::string, std::vector<std::pair<std::string, ChatMessage>>> searchResults =
+    m_Model->GetSearchResults();
+
+  m_Index = 0;
+  m_Items.clear();
+  m_SearchResultsVec.clear();
+
+  // results are ordered by rank within each profile
+  for (const auto& profileSearchResults : searchResults)
+  {
+    for (const auto& searchResult : profileSearchResults.second)
+    {
+      m_SearchResultsVec.push_back(std::make_pair(profileSearchResults.first, searchResult));
+    }
+  }
+
+  static const bool isMultipleProfiles = m_Model->IsMultipleProfiles();
+  for (const auto& searchResult : m_SearchResultsVec)
+  {
+    const std::string& profileId = searchResult.first;
+    const std::string& chatId = searchResult.second.first;
+    const ChatMessage& chatMessage = searchResult.second.second;
+
+    std::string name;
+    auto pit = m_ContactSnapshot->contactInfos.find(profileId);
+    if (pit != m_ContactSnapshot->contactInfos.end())
+    {
+      auto cit = pit->second.find(chatId);
+      if (cit != pit->second.end())
+      {
+        name = cit->second.name;
+      }
+    }
+
+    if (name.empty())
+    {
+      name = chatId;
+    }
+
+    std::string text = chatMessage.text;
+    std::replace(text.begin(), text.end(), '\n', ' ');
+
+    std::string displayText = name +
+      (isMultipleProfiles ? " @ " + m_Model->GetProfileDisplayName(profileId) : "") + ": " + text;
+    m_Items.push_back(StrUtil::TrimPadWString(StrUtil::ToWString(displayText), m_W));
+  }
+}
@@ -0,0 +1,39 @@
+// uisearchlistdialog.h
+//
+// Copyright (c) 2019-2024 Kristofer Berggren
+// All rights reserved.
+//
+// nchat is distributed under the MIT license, see LICENSE for details.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "protocol.h"
+#include "uilistdialog.h"
+#include "uimodel.h"
+
+class UiSearchListDialog : public UiListDialog
+{
+public:
+  UiSearchListDialog(const UiDialogParams& p_Params);
+  virtual ~UiSearchListDialog();
+
+  std::pair<std::string, std::pair<std::string, ChatMessage>> GetSelectedMessage();
+
+protected:
+  virtual void OnSelect();
+  virtual void OnBack();
+  virtual bool OnTimer();
+
+  void UpdateList();
+
+private:
+  std::shared_ptr<const UiModel::ContactSnapshot> m_ContactSnapshot;
+  int64_t m_DialogSearchResultsUpdateTime = 0;
+  std::wstring m_SearchStr;
+  std::vector<std::pair<std::string, std::pair<std::string, ChatMessage>>> m_SearchResultsVec;
+  std::pair<std::string, std::pair<std::string, ChatMessage>> m_SelectedMessage;
+};
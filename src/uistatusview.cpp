@@ -7,7 +7,10 @@
 
 #include "uistatusview.h"
 
+#include <algorithm>
+
 #include "apputil.h"
+#include "perfstats.h"
 #include "strutil.h"
 #include "uicolorconfig.h"
 #include "uiconfig.h"
@@ -27,13 +30,6 @@ void UiStatusView::Draw()
 
   curs_set(0);
 
-  std::pair<std::string, std::string>& currentChat = m_Model->GetCurrentChat();
-  std::string name = m_Model->GetContactListName(currentChat.first, currentChat.second);
-  if (!m_Model->GetEmojiEnabled())
-  {
-    name = StrUtil::Textize(name);
-  }
-
   int statusVPad = 1;
   static int colorPair = UiColorConfig::GetColorPair("status_color");
   static int attribute = UiColorConfig::GetAttribute("status_attr");
@@ -42,6 +38,43 @@ void UiStatusView::Draw()
   wbkgd(m_Win, attribute | colorPair | ' ');
   wattron(m_Win, attribute | colorPair);
 
+  std::wstring wstatus = GetStatusLine();
+
+  static const bool developerMode = AppUtil::GetDeveloperMode();
+  if (developerMode)
+  {
+    UiModel::ChatKey& currentChat = m_Model->GetCurrentChat();
+    wstatus = wstatus + L" " + StrUtil::ToWString(currentChat.second);
+
+    // performance overlay right-aligned, chat status is truncated to fit
+    const std::wstring perfStats = StrUtil::ToWString(PerfStats::ToString()) + std::wstring(statusVPad, ' ');
+    const int statusLen = std::max(0, m_W - (int)perfStats.size() - 1);
+    wstatus = StrUtil::TrimPadWString(wstatus, statusLen) + L" " + perfStats;
+  }
+
+  wstatus = StrUtil::TrimPadWString(wstatus, m_W);
+
+  mvwaddnwstr(m_Win, 0, 0, wstatus.c_str(), wstatus.size());
+
+  wattroff(m_Win, attribute | colorPair);
+  wnoutrefresh(m_Win);
+}
+
+std::wstring UiStatusView::GetStatusLine()
+{
+  // composed line is cached, and only recomputed when one of its inputs changed
+  UiModel::ChatKey& currentChat = m_Model->GetCurrentChat();
+  const StatusKey statusKey(m_Model->GetStatusVersionNoLock(), m_Model->GetContactInfosUpdateTimeNoLock(),
+                            currentChat, m_Model->GetEmojiEnabled(), m_W);
+  if (m_HasStatusLine && (statusKey == m_StatusKey)) return m_StatusLine;
+
+  std::string name = m_Model->GetContactListName(currentChat.first, currentChat.second);
+  if (!m_Model->GetEmojiEnabled())
+  {
+    name = StrUtil::Textize(name);
+  }
+
+  int statusVPad = 1;
   static bool isMultipleProfiles = m_Model->IsMultipleProfiles();
   std::string profileDisplayName = isMultipleProfiles ? " @ " + m_Model->GetProfileDisplayName(currentChat.first) : "";
 
@@ -69,16 +102,8 @@ void UiStatusView::Draw()
     }
   }
 
-  static const bool developerMode = AppUtil::GetDeveloperMode();
-  if (developerMode)
-  {
-    wstatus = wstatus + L" " + StrUtil::ToWString(currentChat.second);
-  }
-
-  wstatus = StrUtil::TrimPadWString(wstatus, m_W);
-
-  mvwaddnwstr(m_Win, 0, 0, wstatus.c_str(), wstatus.size());
-
-  wattroff(m_Win, attribute | colorPair);
-  wrefresh(m_Win);
+  m_StatusKey = statusKey;
+  m_HasStatusLine = true;
+  m_StatusLine = wstatus;
+  return m_StatusLine;
 }
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+#include "uimodel.h"
 #include "uiviewbase.h"
 
 class UiStatusView : public UiViewBase
@@ -15,4 +20,14 @@ public:
   UiStatusView(const UiViewParams& p_Params);
 
   virtual void Draw();
+
+private:
+  std::wstring GetStatusLine();
+
+private:
+  // status version, contacts update time, current chat, emoji enabled and width
+  typedef std::tuple<uint64_t, int64_t, UiModel::ChatKey, bool, int> StatusKey;
+  StatusKey m_StatusKey;
+  bool m_HasStatusLine = false;
+  std::wstring m_StatusLine;
 };
@@ -22,9 +22,16 @@ UiTopView::UiTopView(const UiViewParams& p_Params)
 void UiTopView::Draw()
 {
   static uint32_t lastStatus = 0;
+  static int32_t lastExportProgress = 0;
+  static int64_t lastBackfillCount = 0;
   uint32_t status = Status::Get(); // @todo: get masked flags
-  m_Dirty |= (status != lastStatus);
+  int32_t exportProgress = Status::GetExportProgress();
+  int64_t backfillCount = Status::GetBackfillCount();
+  m_Dirty |= (status != lastStatus) || (exportProgress != lastExportProgress) ||
+             (backfillCount != lastBackfillCount);
   lastStatus = status;
+  lastExportProgress = exportProgress;
+  lastBackfillCount = backfillCount;
 
   if (!m_Enabled || !m_Dirty) return;
   m_Dirty = false;
@@ -55,9 +62,9 @@ void UiTopView::Draw()
     return std::string("");
   }();
 
-  static const bool awayStatusIndication = UiConfig::GetBool("away_status_indication");
+  const bool awayStatusIndication = UiConfig::GetParams().awayStatusIndication;
   static const uint32_t fullMask = ~static_cast<uint32_t>(0);
-  static const uint32_t statusMask = fullMask & (awayStatusIndication ? fullMask : ~Status::FlagAway);
+  const uint32_t statusMask = fullMask & (awayStatusIndication ? fullMask : ~Status::FlagAway);
 
   const std::string statusStr = Status::ToString(statusMask) + statusSuffixStr;
   static const std::string appNameVersion = AppUtil::GetAppNameVersion();
@@ -70,5 +77,5 @@ void UiTopView::Draw()
   mvwaddnwstr(m_Win, 0, 0, topWStr.c_str(), topWStr.size());
 
   wattroff(m_Win, attribute | colorPair);
-  wrefresh(m_Win);
+  wnoutrefresh(m_Win);
 }
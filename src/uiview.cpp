@@ -7,7 +7,11 @@
 
 #include "uiview.h"
 
+#include <algorithm>
+
 #include "log.h"
+#include "perfstats.h"
+#include "trace.h"
 #include "uiconfig.h"
 #include "uientryview.h"
 #include "uihelpview.h"
@@ -29,6 +33,8 @@ UiView::UiView(UiModel* p_UiModel)
   m_TopEnabled = UiConfig::GetBool("top_enabled");
   m_ListWidth = UiConfig::GetNum("list_width");
   m_EntryHeight = std::max(1, UiConfig::GetNum("entry_height"));
+  m_SplitViewEnabled = UiConfig::GetBool("split_view_enabled");
+  m_SplitViewPanes = std::max(1, UiConfig::GetNum("split_view_panes"));
 }
 
 UiView::~UiView()
@@ -38,6 +44,21 @@ UiView::~UiView()
   UiConfig::SetBool("list_enabled", m_ListEnabled);
   UiConfig::SetBool("top_enabled", m_TopEnabled);
   UiConfig::SetNum("list_width", m_ListWidth);
+  UiConfig::SetBool("split_view_enabled", m_SplitViewEnabled);
+}
+
+// views are created once and then resized in place, keeping their state
+template<typename T>
+static void InitView(std::shared_ptr<T>& p_View, const UiViewParams& p_Params)
+{
+  if (p_View)
+  {
+    p_View->Resize(p_Params);
+  }
+  else
+  {
+    p_View = std::make_shared<T>(p_Params);
+  }
 }
 
 void UiView::Init()
@@ -50,7 +71,7 @@ void UiView::Init()
     int x = 0;
     int y = 0;
     UiViewParams params(x, y, w, h, m_TopEnabled, m_UiModel);
-    m_UiTopView = std::make_shared<UiTopView>(params);
+    InitView(m_UiTopView, params);
   }
 
   {
@@ -59,7 +80,7 @@ void UiView::Init()
     int x = 0;
     int y = m_UiScreen->H() - h;
     UiViewParams params(x, y, w, h, m_HelpEnabled, m_UiModel);
-    m_UiHelpView = std::make_shared<UiHelpView>(params);
+    InitView(m_UiHelpView, params);
   }
 
   {
@@ -68,7 +89,7 @@ void UiView::Init()
     int x = 0;
     int y = m_UiScreen->H() - m_UiHelpView->H() - h;
     UiViewParams params(x, y, w, h, m_EntryEnabled, m_UiModel);
-    m_UiEntryView = std::make_shared<UiEntryView>(params);
+    InitView(m_UiEntryView, params);
   }
 
   {
@@ -77,7 +98,7 @@ void UiView::Init()
     int x = 0;
     int y = m_UiScreen->H() - m_UiHelpView->H() - m_UiEntryView->H() - h;
     UiViewParams params(x, y, w, h, m_StatusEnabled, m_UiModel);
-    m_UiStatusView = std::make_shared<UiStatusView>(params);
+    InitView(m_UiStatusView, params);
   }
 
   {
@@ -87,7 +108,7 @@ void UiView::Init()
     int x = 0;
     int y = m_UiTopView->H();
     UiViewParams params(x, y, w, h, m_ListEnabled, m_UiModel);
-    m_UiListView = std::make_shared<UiListView>(params);
+    InitView(m_UiListView, params);
   }
 
   {
@@ -97,7 +118,7 @@ void UiView::Init()
     int x = m_UiListView->X() + m_UiListView->W();
     int y = m_UiTopView->H();
     UiViewParams params(x, y, w, h, m_ListEnabled && (m_ListWidth > 0), m_UiModel);
-    m_UiListBorderView = std::make_shared<UiListBorderView>(params);
+    InitView(m_UiListBorderView, params);
   }
 
   {
@@ -106,21 +127,90 @@ void UiView::Init()
     int h = m_UiScreen->H() - m_UiTopView->H() - m_UiHelpView->H() -
       m_UiEntryView->H() - m_UiStatusView->H();
     int y = m_UiTopView->H();
-    UiViewParams params(x, y, w, h, m_HistoryEnabled, m_UiModel);
-    m_UiHistoryView = std::make_shared<UiHistoryView>(params);
+
+    // split view panes share history width, each pane keeps its own layout cache
+    static const int minPaneWidth = 20;
+    const int panes = m_SplitViewEnabled ? std::max(1, std::min(m_SplitViewPanes, w / minPaneWidth)) : 1;
+    const int paneW = w / panes;
+    UiViewParams params(x, y, (panes > 1) ? paneW : w, h, m_HistoryEnabled, m_UiModel);
+    InitView(m_UiHistoryView, params);
+    m_UiHistoryView->SetPane(0, panes);
+
+    m_UiHistoryPaneViews.resize(panes - 1);
+    for (int pane = 1; pane < panes; ++pane)
+    {
+      const int paneX = x + (pane * paneW);
+      const int paneWidth = (pane == (panes - 1)) ? (w - (pane * paneW)) : paneW;
+      UiViewParams paneParams(paneX, y, paneWidth, h, m_HistoryEnabled, m_UiModel);
+      InitView(m_UiHistoryPaneViews[pane - 1], paneParams);
+      m_UiHistoryPaneViews[pane - 1]->SetPane(pane, panes);
+    }
   }
 }
 
 void UiView::Draw()
 {
+  TraceSpan drawSpan("UiView::Draw");
+  PerfStats::Add(PerfStats::StatRedraws, 1);
+  {
+    TraceSpan viewSpan("UiTopView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawTopUs);
+    m_UiTopView->Draw();
+  }
+
+  {
+    TraceSpan viewSpan("UiHelpView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawHelpUs);
+    m_UiHelpView->Draw();
+  }
+
+  {
+    TraceSpan viewSpan("UiStatusView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawStatusUs);
+    m_UiStatusView->Draw();
+  }
+
+  {
+    TraceSpan viewSpan("UiListView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawListUs);
+    m_UiListView->Draw();
+    m_UiListBorderView->Draw();
+  }
+
+  {
+    TraceSpan viewSpan("UiHistoryView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawHistoryUs);
+    m_UiHistoryView->Draw();
+    for (auto& historyPaneView : m_UiHistoryPaneViews)
+    {
+      historyPaneView->Draw();
+    }
+  }
+
+  {
+    TraceSpan viewSpan("UiEntryView::Draw");
+    PerfTimer viewTimer(PerfStats::StatDrawEntryUs);
+    m_UiEntryView->Draw();
+  }
+
+  curs_set(1);
+
+  // views only stage their windows, flush all changes to the terminal at once
+  TraceSpan updateSpan("doupdate");
+  doupdate();
+}
+
+void UiView::DrawStatus()
+{
+  // power-save redraw, other views stay dirty until next full draw
+  TraceSpan drawSpan("UiView::DrawStatus");
+  PerfStats::Add(PerfStats::StatRedraws, 1);
   m_UiTopView->Draw();
-  m_UiHelpView->Draw();
   m_UiStatusView->Draw();
-  m_UiListView->Draw();
-  m_UiListBorderView->Draw();
-  m_UiHistoryView->Draw();
-  m_UiEntryView->Draw();
+  m_UiEntryView->Draw(); // restores cursor position
+
   curs_set(1);
+  doupdate();
 }
 
 void UiView::TerminalBell()
@@ -169,6 +259,16 @@ bool UiView::GetListEnabled()
   return m_ListEnabled;
 }
 
+void UiView::SetSplitViewEnabled(bool p_Enabled)
+{
+  m_SplitViewEnabled = p_Enabled;
+}
+
+bool UiView::GetSplitViewEnabled()
+{
+  return m_SplitViewEnabled;
+}
+
 void UiView::SetListDirty(bool p_Dirty)
 {
   m_UiListView->SetDirty(p_Dirty);
@@ -182,6 +282,10 @@ void UiView::SetStatusDirty(bool p_Dirty)
 void UiView::SetHistoryDirty(bool p_Dirty)
 {
   m_UiHistoryView->SetDirty(p_Dirty);
+  for (auto& historyPaneView : m_UiHistoryPaneViews)
+  {
+    historyPaneView->SetDirty(p_Dirty);
+  }
 }
 
 void UiView::SetHelpDirty(bool p_Dirty)
@@ -204,6 +308,22 @@ int UiView::GetHistoryLines()
   return m_UiHistoryView->H();
 }
 
+int UiView::GetHistoryPaneCount()
+{
+  return 1 + m_UiHistoryPaneViews.size();
+}
+
+size_t UiView::GetLayoutCacheHeapSize()
+{
+  size_t size = m_UiHistoryView ? m_UiHistoryView->GetLayoutCacheHeapSize() : 0;
+  for (const auto& paneView : m_UiHistoryPaneViews)
+  {
+    size += paneView->GetLayoutCacheHeapSize();
+  }
+
+  return size;
+}
+
 int UiView::GetEntryWidth()
 {
   return m_UiEntryView->W();
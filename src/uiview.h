@@ -8,6 +8,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 class UiEntryView;
 class UiHelpView;
@@ -27,6 +28,7 @@ public:
 
   void Init();
   void Draw();
+  void DrawStatus();
   void TerminalBell();
   void SetEmojiEnabled(bool p_Enabled);
   bool GetEmojiEnabled();
@@ -36,6 +38,8 @@ public:
   bool GetHelpEnabled();
   void SetListEnabled(bool p_Enabled);
   bool GetListEnabled();
+  void SetSplitViewEnabled(bool p_Enabled);
+  bool GetSplitViewEnabled();
   void SetListDirty(bool p_Dirty);
   void SetStatusDirty(bool p_Dirty);
   void SetHistoryDirty(bool p_Dirty);
@@ -43,6 +47,8 @@ public:
   void SetEntryDirty(bool p_Dirty);
   int GetHistoryShowCount();
   int GetHistoryLines();
+  int GetHistoryPaneCount();
+  size_t GetLayoutCacheHeapSize();
   int GetEntryWidth();
   int GetScreenWidth();
   int GetScreenHeight();
@@ -61,6 +67,7 @@ private:
   std::shared_ptr<UiListView> m_UiListView;
   std::shared_ptr<UiListBorderView> m_UiListBorderView;
   std::shared_ptr<UiHistoryView> m_UiHistoryView;
+  std::vector<std::shared_ptr<UiHistoryView>> m_UiHistoryPaneViews; // split view panes right of main history
 
   bool m_EmojiEnabled = true;
   bool m_TopEnabled = true;
@@ -70,5 +77,7 @@ private:
   bool m_ListEnabled = true;
   const bool m_HistoryEnabled = true;
   int m_ListWidth = 14;
+  bool m_SplitViewEnabled = false;
+  int m_SplitViewPanes = 2;
   int m_EntryHeight = 4;
 };
@@ -49,6 +49,36 @@ int UiViewBase::Y()
   return m_Enabled ? m_Y : 0;
 }
 
+void UiViewBase::Resize(const UiViewParams& p_Params)
+{
+  // window is resized and moved in place, so view state like layout caches is kept
+  if (m_Enabled && p_Params.enabled)
+  {
+    wresize(m_Win, p_Params.h, p_Params.w);
+    if (mvwin(m_Win, p_Params.y, p_Params.x) == ERR)
+    {
+      delwin(m_Win);
+      m_Win = newwin(p_Params.h, p_Params.w, p_Params.y, p_Params.x);
+    }
+  }
+  else if (m_Enabled)
+  {
+    delwin(m_Win);
+    m_Win = nullptr;
+  }
+  else if (p_Params.enabled)
+  {
+    m_Win = newwin(p_Params.h, p_Params.w, p_Params.y, p_Params.x);
+  }
+
+  m_X = p_Params.x;
+  m_Y = p_Params.y;
+  m_W = p_Params.w;
+  m_H = p_Params.h;
+  m_Enabled = p_Params.enabled;
+  m_Dirty = true;
+}
+
 void UiViewBase::SetDirty(bool p_Dirty)
 {
   m_Dirty = p_Dirty;
@@ -40,6 +40,7 @@ public:
   virtual ~UiViewBase();
 
   virtual void Draw() = 0;
+  virtual void Resize(const UiViewParams& p_Params);
 
   int W();
   int H();